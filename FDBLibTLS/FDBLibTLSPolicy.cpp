@@ -37,8 +37,28 @@
 #include <string.h>
 #include <limits.h>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// Whether the CPU can run AES in hardware, in which case AES-GCM outperforms
+// ChaCha20-Poly1305; without it the ordering is reversed.
+static bool platform_has_aes_hardware() {
+#if defined(__x86_64__) || defined(__i386__)
+	uint32_t eax, ebx, ecx, edx;
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return (ecx & (1 << 25)) != 0;
+#endif
+	return false;
+}
+
 FDBLibTLSPolicy::FDBLibTLSPolicy(Reference<FDBLibTLSPlugin> plugin):
-	plugin(plugin), tls_cfg(NULL), roots(NULL), session_created(false), ca_data_set(false),
+	plugin(plugin), tls_cfg(NULL), roots(NULL), session_fd(-1), session_created(false), ca_data_set(false),
 	cert_data_set(false), key_data_set(false), verify_peers_set(false) {
 
 	if ((tls_cfg = tls_config_new()) == NULL) {
@@ -48,11 +68,49 @@ FDBLibTLSPolicy::FDBLibTLSPolicy(Reference<FDBLibTLSPlugin> plugin):
 
 	// Require client certificates for authentication.
 	tls_config_verify_client(tls_cfg);
+
+	// Restrict to AEAD cipher suites, ordered for the hardware at hand - a
+	// reconnect storm otherwise spends most of its CPU in the bulk cipher.
+	const char* ciphers = platform_has_aes_hardware() ?
+		"ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384:"
+		"ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+		"ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305" :
+		"ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305:"
+		"ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384:"
+		"ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256";
+	if (tls_config_set_ciphers(tls_cfg, ciphers) == -1)
+		TraceEvent(SevWarnAlways, "FDBLibTLSCipherError").detail("LibTLSErrorMessage", tls_config_error(tls_cfg));
+	tls_config_prefer_ciphers_server(tls_cfg);
+
+	// Issue session tickets so that a reconnecting peer can resume with an
+	// abbreviated handshake instead of a full key exchange.  The ticket keys
+	// are per-policy and rotate with the session lifetime.
+	if (tls_config_set_session_lifetime(tls_cfg, 7200) == -1)
+		TraceEvent(SevWarnAlways, "FDBLibTLSSessionLifetimeError").detail("LibTLSErrorMessage", tls_config_error(tls_cfg));
+
+#ifndef _WIN32
+	// Clients need somewhere to keep session state between connections in
+	// order to attempt resumption; use an unlinked temporary file so it
+	// remains private to this process.
+	char session_path[] = "/tmp/fdb-tls-session-XXXXXX";
+	if ((session_fd = mkstemp(session_path)) != -1) {
+		unlink(session_path);
+		if (tls_config_set_session_fd(tls_cfg, session_fd) == -1) {
+			TraceEvent(SevWarnAlways, "FDBLibTLSSessionFdError").detail("LibTLSErrorMessage", tls_config_error(tls_cfg));
+			close(session_fd);
+			session_fd = -1;
+		}
+	}
+#endif
 }
 
 FDBLibTLSPolicy::~FDBLibTLSPolicy() {
 	sk_X509_pop_free(roots, X509_free);
 	tls_config_free(tls_cfg);
+#ifndef _WIN32
+	if (session_fd != -1)
+		close(session_fd);
+#endif
 }
 
 ITLSSession* FDBLibTLSPolicy::create_session(bool is_client, const char* servername, TLSSendCallbackFunc send_func, void* send_ctx, TLSRecvCallbackFunc recv_func, void* recv_ctx, void* uid) {
@@ -54,6 +54,8 @@ struct FDBLibTLSPolicy: ITLSPolicy, ReferenceCounted<FDBLibTLSPolicy> {
 
 	struct tls_config* tls_cfg;
 
+	int session_fd;
+
 	bool session_created;
 
 	bool ca_data_set;
@@ -362,6 +362,8 @@ int FDBLibTLSSession::handshake() {
 	case 0:
 		if (!verify_peer())
 			return FAILED;
+		if (tls_conn_session_resumed(tls_ctx))
+			TraceEvent("FDBLibTLSSessionResumed", uid).suppressFor(1.0);
 		handshake_completed = true;
 		return SUCCESS;
 	case TLS_WANT_POLLIN:
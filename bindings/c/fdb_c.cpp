@@ -583,6 +583,56 @@ FDBFuture* fdb_transaction_get_versionstamp( FDBTransaction* tr )
 	return (FDBFuture*)(TXN(tr)->getVersionstamp().extractPtr());
 }
 
+extern "C" DLLEXPORT
+FDBFuture* fdb_transaction_get_approximate_size( FDBTransaction* tr )
+{
+	return (FDBFuture*)(TXN(tr)->getApproximateSize().extractPtr());
+}
+
+extern "C" DLLEXPORT
+FDBFuture* fdb_transaction_get_range_row_count(
+	FDBTransaction* tr, uint8_t const* begin_key_name, int begin_key_name_length,
+	uint8_t const* end_key_name, int end_key_name_length )
+{
+	// Constructing the KeyRangeRef throws inverted_range for a backwards range; surface
+	// that through the returned future rather than unwinding through the C boundary
+	try {
+		return (FDBFuture*)(TXN(tr)->getRangeRowCount(
+								KeyRangeRef( KeyRef( begin_key_name, begin_key_name_length ),
+											 KeyRef( end_key_name, end_key_name_length ) ) ).extractPtr());
+	} catch( Error& e ) {
+		return (FDBFuture*)(ThreadFuture<int64_t>( e ).extractPtr());
+	}
+}
+
+extern "C" DLLEXPORT
+FDBFuture* fdb_transaction_get_range_byte_sum(
+	FDBTransaction* tr, uint8_t const* begin_key_name, int begin_key_name_length,
+	uint8_t const* end_key_name, int end_key_name_length )
+{
+	try {
+		return (FDBFuture*)(TXN(tr)->getRangeByteSum(
+								KeyRangeRef( KeyRef( begin_key_name, begin_key_name_length ),
+											 KeyRef( end_key_name, end_key_name_length ) ) ).extractPtr());
+	} catch( Error& e ) {
+		return (FDBFuture*)(ThreadFuture<int64_t>( e ).extractPtr());
+	}
+}
+
+extern "C" DLLEXPORT
+FDBFuture* fdb_transaction_get_estimated_range_size_bytes(
+	FDBTransaction* tr, uint8_t const* begin_key_name, int begin_key_name_length,
+	uint8_t const* end_key_name, int end_key_name_length )
+{
+	try {
+		return (FDBFuture*)(TXN(tr)->getEstimatedRangeSizeBytes(
+								KeyRangeRef( KeyRef( begin_key_name, begin_key_name_length ),
+											 KeyRef( end_key_name, end_key_name_length ) ) ).extractPtr());
+	} catch( Error& e ) {
+		return (FDBFuture*)(ThreadFuture<int64_t>( e ).extractPtr());
+	}
+}
+
 extern "C"
 fdb_error_t fdb_transaction_set_option_impl( FDBTransaction* tr,
 								 FDBTransactionOption option,
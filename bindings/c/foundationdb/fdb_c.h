@@ -243,6 +243,34 @@ extern "C" {
 
     DLLEXPORT WARN_UNUSED_RESULT FDBFuture* fdb_transaction_get_versionstamp( FDBTransaction* tr );
 
+    /* The future returned holds an int64 estimate of the size of the commit
+       request this transaction will send, readable with fdb_future_get_version. */
+    DLLEXPORT WARN_UNUSED_RESULT FDBFuture*
+    fdb_transaction_get_approximate_size( FDBTransaction* tr );
+
+    /* The futures returned hold an int64 count of the rows in the range, or the sum of
+       the key and value bytes of those rows, computed on the storage servers without
+       transferring the rows to the client.  Readable with fdb_future_get_version.
+       These are snapshot reads: no read conflict range is added. */
+    DLLEXPORT WARN_UNUSED_RESULT FDBFuture* fdb_transaction_get_range_row_count(
+        FDBTransaction* tr, uint8_t const* begin_key_name,
+        int begin_key_name_length, uint8_t const* end_key_name,
+        int end_key_name_length );
+
+    DLLEXPORT WARN_UNUSED_RESULT FDBFuture* fdb_transaction_get_range_byte_sum(
+        FDBTransaction* tr, uint8_t const* begin_key_name,
+        int begin_key_name_length, uint8_t const* end_key_name,
+        int end_key_name_length );
+
+    /* The future returned holds an int64 estimate of the byte size of the range,
+       answered from the storage servers' byte samples rather than by scanning, so it
+       is cheap even for very large ranges.  Readable with fdb_future_get_version.
+       This is a snapshot read: no read conflict range is added. */
+    DLLEXPORT WARN_UNUSED_RESULT FDBFuture* fdb_transaction_get_estimated_range_size_bytes(
+        FDBTransaction* tr, uint8_t const* begin_key_name,
+        int begin_key_name_length, uint8_t const* end_key_name,
+        int end_key_name_length );
+
     DLLEXPORT WARN_UNUSED_RESULT FDBFuture*
     fdb_transaction_on_error( FDBTransaction* tr, fdb_error_t error );
 
@@ -511,6 +511,10 @@ void initHelp() {
 		"writemode <on|off>",
 		"enables or disables sets and clears",
 		"Setting or clearing keys from the CLI is not recommended.");
+	helpMap["batchmode"] = CommandHelp(
+		"batchmode <on|off>",
+		"enables or disables batched writes",
+		"When batch mode is on (and writemode is on), `set', `clear' and `clearrange' commands outside of a `begin'/`commit' block are grouped into large transactions that commit in the background, starting a new transaction whenever the current one reaches a size threshold. Any other command first waits for all outstanding batches to commit. This makes bulk writes through piped scripts dramatically faster than one commit per command. The writes in a batch that fails to commit are discarded and the failure is reported.");
 	helpMap["kill"] = CommandHelp(
 		"kill all|list|<ADDRESS>*",
 		"attempts to kill one or more processes in the cluster",
@@ -1493,6 +1497,49 @@ ACTOR Future<Void> commitTransaction( Reference<ReadYourWritesTransaction> tr )
 	return Void();
 }
 
+//In batch mode, writes are grouped into transactions of about this size before being committed
+//in the background.  Kept well under the transaction size limit so a batch always fits.
+const int64_t BATCH_TRANSACTION_BYTES = 1e6;
+
+//At most this many batch transactions may be committing in the background at once
+const int MAX_BATCHES_IN_FLIGHT = 10;
+
+//Bytes streamed per chunk by getrange before printing, roughly one storage server reply
+const int RANGE_CHUNK_BYTES = 100000;
+
+//Commits one transaction's worth of writes accumulated in batch mode.  Batches commit in the
+//background; a failure is printed immediately and reported again when the batch is flushed.
+//The writes in a failed batch are discarded, since they cannot be replayed after the error.
+ACTOR Future<bool> commitBatch( Reference<ReadYourWritesTransaction> tr, int64_t mutations, int64_t bytes ) {
+	try {
+		wait( tr->commit() );
+		return true;
+	} catch (Error& e) {
+		fprintf(stderr, "ERROR: %s (%d) committing a batch of %" PRId64 " writes (%" PRId64 " bytes); those writes were not applied\n", e.what(), e.code(), mutations, bytes);
+		return false;
+	}
+}
+
+//Commits any partially filled batch and waits for all outstanding batch commits.  Returns false
+//if any batch failed to commit.
+ACTOR Future<bool> flushBatchedWrites( Reference<ReadYourWritesTransaction>* batchTr, int64_t* batchedMutations, int64_t* batchedBytes, std::vector<Future<bool>>* batchCommits ) {
+	if (*batchedMutations > 0) {
+		batchCommits->push_back( commitBatch( *batchTr, *batchedMutations, *batchedBytes ) );
+		*batchTr = Reference<ReadYourWritesTransaction>();
+		*batchedMutations = 0;
+		*batchedBytes = 0;
+	}
+	state bool ok = true;
+	if (batchCommits->size()) {
+		wait( waitForAll( *batchCommits ) );
+		for (int i = 0; i < batchCommits->size(); i++)
+			if (!(*batchCommits)[i].get())
+				ok = false;
+		batchCommits->clear();
+	}
+	return ok;
+}
+
 ACTOR Future<bool> configure( Database db, std::vector<StringRef> tokens, Reference<ClusterConnectionFile> ccf, LineNoise* linenoise, Future<Void> warn ) {
 	state ConfigurationResult::Type result;
 	state int startToken = 1;
@@ -2360,6 +2407,13 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 
 	state bool writeMode = false;
 
+	//Batch mode state: writes accumulate in batchTr and commit in the background (see `batchmode')
+	state bool batchMode = false;
+	state Reference<ReadYourWritesTransaction> batchTr;
+	state int64_t batchedMutations = 0;
+	state int64_t batchedBytes = 0;
+	state std::vector<Future<bool>> batchCommits;
+
 	state std::string clusterConnectString;
 	state std::map<Key,Value> address_interface;
 
@@ -2431,8 +2485,10 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 		} else {
 			Optional<std::string> rawline = wait( linenoise.read("fdb> ") );
 			if (!rawline.present()) {
+				//Don't lose writes that were batched but not yet committed when input ends
+				bool flushed = wait( flushBatchedWrites( &batchTr, &batchedMutations, &batchedBytes, &batchCommits ) );
 				printf("\n");
-				return 0;
+				return flushed ? 0 : 1;
 			}
 			line = rawline.get();
 
@@ -2502,6 +2558,21 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 					continue;
 				}
 
+				//Any command other than another batched write flushes pending batches first, so
+				//their effects are visible to whatever runs next
+				if (batchedMutations > 0 || batchCommits.size()) {
+					bool batchedWrite = batchMode && writeMode && !intrans &&
+						(tokencmp(tokens[0], "set") || tokencmp(tokens[0], "clear") || tokencmp(tokens[0], "clearrange"));
+					if (!batchedWrite) {
+						bool flushed = wait( makeInterruptable( flushBatchedWrites( &batchTr, &batchedMutations, &batchedBytes, &batchCommits ) ) );
+						if (!flushed) {
+							printf("ERROR: One or more batches of writes failed to commit\n");
+							is_error = true;
+							continue;
+						}
+					}
+				}
+
 				if (tokencmp(tokens[0], "exit") || tokencmp(tokens[0], "quit")) {
 					return 0;
 				}
@@ -2877,7 +2948,7 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 					}
 					if (tokencmp(tokens[1], "flow")) {
 						if (tokens.size() == 2) {
-							printf("ERROR: Usage: profile flow <run>\n");
+							printf("ERROR: Usage: profile flow <run|dump>\n");
 							is_error = true;
 							continue;
 						}
@@ -2949,6 +3020,68 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 							all_profiler_responses.clear();
 							continue;
 						}
+						if (tokencmp(tokens[2], "dump")) {
+							// Ask the (already running) flow profiler on each host to write out its aggregated stacks
+							if (tokens.size() < 5) {
+								printf("ERROR: Usage: profile flow dump <filename> <hosts>\n");
+								is_error = true;
+								continue;
+							}
+							getTransaction(db, tr, options, intrans);
+							Standalone<RangeResultRef> kvs = wait(makeInterruptable(
+							    tr->getRange(KeyRangeRef(LiteralStringRef("\xff\xff/worker_interfaces"),
+							                             LiteralStringRef("\xff\xff\xff")),
+							                 1)));
+							state std::vector<Key> dump_profiler_addresses;
+							state std::vector<Future<ErrorOr<Void>>> dump_profiler_responses;
+							std::map<Key, ClientWorkerInterface> interfaces;
+							for (const auto& pair : kvs) {
+								auto ip_port = pair.key.endsWith(LiteralStringRef(":tls")) ? pair.key.removeSuffix(LiteralStringRef(":tls")) : pair.key;
+								interfaces.emplace(ip_port, BinaryReader::fromStringRef<ClientWorkerInterface>(pair.value, IncludeVersion()));
+							}
+							if (tokens.size() == 5 && tokencmp(tokens[4], "all")) {
+								for (const auto& pair : interfaces) {
+									ProfilerRequest profileRequest;
+									profileRequest.type = ProfilerRequest::Type::FLOW_DUMP;
+									profileRequest.action = ProfilerRequest::Action::ENABLE;
+									profileRequest.duration = 0;
+									profileRequest.outputFile = tokens[3];
+									dump_profiler_addresses.push_back(pair.first);
+									dump_profiler_responses.push_back(pair.second.profiler.tryGetReply(profileRequest));
+								}
+							} else {
+								for (int tokenidx = 4; tokenidx < tokens.size(); tokenidx++) {
+									auto element = interfaces.find(tokens[tokenidx]);
+									if (element == interfaces.end()) {
+										printf("ERROR: process '%s' not recognized.\n", printable(tokens[tokenidx]).c_str());
+										is_error = true;
+									}
+								}
+								if (!is_error) {
+									for (int tokenidx = 4; tokenidx < tokens.size(); tokenidx++) {
+										ProfilerRequest profileRequest;
+										profileRequest.type = ProfilerRequest::Type::FLOW_DUMP;
+										profileRequest.action = ProfilerRequest::Action::ENABLE;
+										profileRequest.duration = 0;
+										profileRequest.outputFile = tokens[3];
+										dump_profiler_addresses.push_back(tokens[tokenidx]);
+										dump_profiler_responses.push_back(interfaces[tokens[tokenidx]].profiler.tryGetReply(profileRequest));
+									}
+								}
+							}
+							if (!is_error) {
+								wait(waitForAll(dump_profiler_responses));
+								for (int i = 0; i < dump_profiler_responses.size(); i++) {
+									const ErrorOr<Void>& err = dump_profiler_responses[i].get();
+									if (err.isError()) {
+										printf("ERROR: %s: %s: %s\n", printable(dump_profiler_addresses[i]).c_str(), err.getError().name(), err.getError().what());
+									}
+								}
+							}
+							dump_profiler_addresses.clear();
+							dump_profiler_responses.clear();
+							continue;
+						}
 					}
 					printf("ERROR: Unknown type: %s\n", printable(tokens[1]).c_str());
 					is_error = true;
@@ -3041,7 +3174,7 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 							limit = 25;
 						}
 
-						Standalone<StringRef> endKey;
+						state Standalone<StringRef> endKey;
 						if (tokens.size() >= 3) {
 							endKey = tokens[2];
 						}
@@ -3058,16 +3191,31 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 							endKey = strinc(tokens[1]);
 						}
 
-						Standalone<RangeResultRef> kvs = wait( makeInterruptable( getTransaction(db, tr, options, intrans)->getRange(KeyRangeRef(tokens[1], endKey), limit) ) );
+						//Stream the range in bounded chunks within one transaction, printing rows
+						//as each chunk arrives instead of buffering the entire result
+						state Standalone<StringRef> rangeBegin = tokens[1];
+						state bool keysOnly = tokencmp(tokens[0], "getrangekeys");
+						state int remaining = limit;
+						state Reference<ReadYourWritesTransaction> rangeTr = getTransaction(db, tr, options, intrans);
 
 						printf("\nRange limited to %d keys\n", limit);
-						for (auto iter = kvs.begin(); iter < kvs.end(); iter++) {
-							if (tokencmp(tokens[0], "getrangekeys"))
-								printf("`%s'\n", printable((*iter).key).c_str());
-							else
-								printf("`%s' is `%s'\n",
-									printable((*iter).key).c_str(),
-									printable((*iter).value).c_str());
+						loop {
+							Standalone<RangeResultRef> kvs = wait( makeInterruptable( rangeTr->getRange(KeyRangeRef(rangeBegin, endKey), GetRangeLimits(remaining, RANGE_CHUNK_BYTES)) ) );
+
+							for (auto iter = kvs.begin(); iter < kvs.end(); iter++) {
+								if (keysOnly)
+									printf("`%s'\n", printable((*iter).key).c_str());
+								else
+									printf("`%s' is `%s'\n",
+										printable((*iter).key).c_str(),
+										printable((*iter).value).c_str());
+							}
+							fflush(stdout);
+
+							remaining -= kvs.size();
+							if (remaining <= 0 || !kvs.more || !kvs.size())
+								break;
+							rangeBegin = keyAfter(kvs.end()[-1].key);
 						}
 						printf("\n");
 					}
@@ -3091,6 +3239,24 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 					continue;
 				}
 
+				if (tokencmp(tokens[0], "batchmode")) {
+					if (tokens.size() != 2) {
+						printUsage(tokens[0]);
+						is_error = true;
+					} else {
+						if(tokencmp(tokens[1], "on")) {
+							batchMode = true;
+						} else if(tokencmp(tokens[1], "off")) {
+							//Pending batches were already flushed above, before this command ran
+							batchMode = false;
+						} else {
+							printUsage(tokens[0]);
+							is_error = true;
+						}
+					}
+					continue;
+				}
+
 				if (tokencmp(tokens[0], "set")) {
 					if(!writeMode) {
 						printf("ERROR: writemode must be enabled to set or clear keys in the database.\n");
@@ -3101,6 +3267,28 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 					if (tokens.size() != 3) {
 						printUsage(tokens[0]);
 						is_error = true;
+					} else if (batchMode && !intrans) {
+						if (!batchTr) {
+							batchTr = Reference<ReadYourWritesTransaction>( new ReadYourWritesTransaction(db) );
+							options->apply(batchTr);
+						}
+						batchTr->set(tokens[1], tokens[2]);
+						++batchedMutations;
+						batchedBytes += tokens[1].size() + tokens[2].size() + 24;
+						if (batchedBytes >= BATCH_TRANSACTION_BYTES) {
+							batchCommits.push_back( commitBatch( batchTr, batchedMutations, batchedBytes ) );
+							batchTr = Reference<ReadYourWritesTransaction>();
+							batchedMutations = 0;
+							batchedBytes = 0;
+							//Bound the number of batches committing in the background
+							if (batchCommits.size() >= MAX_BATCHES_IN_FLIGHT) {
+								bool flushed = wait( makeInterruptable( flushBatchedWrites( &batchTr, &batchedMutations, &batchedBytes, &batchCommits ) ) );
+								if (!flushed) {
+									printf("ERROR: One or more batches of writes failed to commit\n");
+									is_error = true;
+								}
+							}
+						}
 					} else {
 						getTransaction(db, tr, options, intrans);
 						tr->set(tokens[1], tokens[2]);
@@ -3122,6 +3310,27 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 					if (tokens.size() != 2) {
 						printUsage(tokens[0]);
 						is_error = true;
+					} else if (batchMode && !intrans) {
+						if (!batchTr) {
+							batchTr = Reference<ReadYourWritesTransaction>( new ReadYourWritesTransaction(db) );
+							options->apply(batchTr);
+						}
+						batchTr->clear(tokens[1]);
+						++batchedMutations;
+						batchedBytes += tokens[1].size() + 24;
+						if (batchedBytes >= BATCH_TRANSACTION_BYTES) {
+							batchCommits.push_back( commitBatch( batchTr, batchedMutations, batchedBytes ) );
+							batchTr = Reference<ReadYourWritesTransaction>();
+							batchedMutations = 0;
+							batchedBytes = 0;
+							if (batchCommits.size() >= MAX_BATCHES_IN_FLIGHT) {
+								bool flushed = wait( makeInterruptable( flushBatchedWrites( &batchTr, &batchedMutations, &batchedBytes, &batchCommits ) ) );
+								if (!flushed) {
+									printf("ERROR: One or more batches of writes failed to commit\n");
+									is_error = true;
+								}
+							}
+						}
 					} else {
 						getTransaction(db, tr, options, intrans);
 						tr->clear(tokens[1]);
@@ -3143,6 +3352,27 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 					if (tokens.size() != 3) {
 						printUsage(tokens[0]);
 						is_error = true;
+					} else if (batchMode && !intrans) {
+						if (!batchTr) {
+							batchTr = Reference<ReadYourWritesTransaction>( new ReadYourWritesTransaction(db) );
+							options->apply(batchTr);
+						}
+						batchTr->clear(KeyRangeRef(tokens[1], tokens[2]));
+						++batchedMutations;
+						batchedBytes += tokens[1].size() + tokens[2].size() + 24;
+						if (batchedBytes >= BATCH_TRANSACTION_BYTES) {
+							batchCommits.push_back( commitBatch( batchTr, batchedMutations, batchedBytes ) );
+							batchTr = Reference<ReadYourWritesTransaction>();
+							batchedMutations = 0;
+							batchedBytes = 0;
+							if (batchCommits.size() >= MAX_BATCHES_IN_FLIGHT) {
+								bool flushed = wait( makeInterruptable( flushBatchedWrites( &batchTr, &batchedMutations, &batchedBytes, &batchCommits ) ) );
+								if (!flushed) {
+									printf("ERROR: One or more batches of writes failed to commit\n");
+									is_error = true;
+								}
+							}
+						}
 					} else {
 						getTransaction(db, tr, options, intrans);
 						tr->clear(KeyRangeRef(tokens[1], tokens[2]));
@@ -3248,7 +3478,8 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 		}
 
 		if (opt.exec.present()) {
-			return is_error ? 1 : 0;
+			bool flushed = wait( flushBatchedWrites( &batchTr, &batchedMutations, &batchedBytes, &batchCommits ) );
+			return (is_error || !flushed) ? 1 : 0;
 		}
 	}
 }
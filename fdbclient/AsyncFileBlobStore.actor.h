@@ -96,10 +96,10 @@ public:
 
 	ACTOR static Future<Void> write_impl(Reference<AsyncFileBlobStoreWrite> f, const uint8_t *data, int length) {
 		state Part *p = f->m_parts.back().getPtr();
-		// If this write will cause the part to cross the min part size boundary then write to the boundary and start a new part.
-		while(p->length + length >= f->m_bstore->knobs.multipart_min_part_size) {
+		// If this write will cause the part to cross the target part size boundary then write to the boundary and start a new part.
+		while(p->length + length >= f->m_partSize) {
 			// Finish off this part
-			int finishlen = f->m_bstore->knobs.multipart_min_part_size - p->length;
+			int finishlen = f->m_partSize - p->length;
 			p->write((const uint8_t *)data, finishlen);
 
 			// Adjust source buffer args
@@ -214,6 +214,7 @@ private:
 	std::vector<Reference<Part>> m_parts;
 	Promise<Void> m_error;
 	FlowLock m_concurrentUploads;
+	int m_partSize;  // Size at which the current part will be ended, sampled from the endpoint's adaptive target at part start
 
 	// End the current part and start uploading it, but also wait for a part to finish if too many are in transit.
 	ACTOR static Future<Void> endCurrentPart(AsyncFileBlobStoreWrite *f, bool startNew = false) {
@@ -229,9 +230,11 @@ private:
 									joinErrorGroup(doPartUpload(f, f->m_parts.back().getPtr()), f->m_error)
 								  );
 
-		// Make a new part to write to
-		if(startNew)
+		// Make a new part to write to, at whatever size the endpoint is currently targeting
+		if(startNew) {
 			f->m_parts.push_back(Reference<Part>(new Part(f->m_parts.size() + 1)));
+			f->m_partSize = f->m_bstore->getTargetPartSize();
+		}
 
 		return Void();
 	}
@@ -244,7 +247,8 @@ private:
 
 public:
 	AsyncFileBlobStoreWrite(Reference<BlobStoreEndpoint> bstore, std::string bucket, std::string object)
-		: m_bstore(bstore), m_bucket(bucket), m_object(object), m_cursor(0), m_concurrentUploads(bstore->knobs.concurrent_writes_per_file) {
+		: m_bstore(bstore), m_bucket(bucket), m_object(object), m_cursor(0), m_concurrentUploads(bstore->knobs.concurrent_writes_per_file),
+		  m_partSize(bstore->getTargetPartSize()) {
 
 		// Add first part
 		m_parts.push_back(Reference<Part>(new Part(1)));
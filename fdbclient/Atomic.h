@@ -28,12 +28,24 @@ static ValueRef doLittleEndianAdd(const Optional<ValueRef>& existingValueOptiona
 	const ValueRef& existingValue = existingValueOptional.present() ? existingValueOptional.get() : StringRef();
 	if(!existingValue.size()) return otherOperand;
 	if(!otherOperand.size()) return otherOperand;
-	
+
 	uint8_t* buf = new (ar) uint8_t [otherOperand.size()];
 	int i = 0;
 	int carry = 0;
-		
-	for(i = 0; i<std::min(existingValue.size(), otherOperand.size()); i++) {
+	int common = std::min(existingValue.size(), otherOperand.size());
+
+	// Little endian addition can be done 8 bytes at a time on a little endian host (which flow
+	// requires), propagating one carry per word instead of one per byte.  Most operands are 8 byte
+	// counters, which are finished in a single iteration here.
+	for(; i+8 <= common; i += 8) {
+		uint64_t a, b;
+		memcpy(&a, existingValue.begin() + i, 8);
+		memcpy(&b, otherOperand.begin() + i, 8);
+		uint64_t sum = a + b + carry;
+		memcpy(buf + i, &sum, 8);
+		carry = (sum < a) || (carry && sum == a);
+	}
+	for(; i<common; i++) {
 		int sum = existingValue[i] + otherOperand[i] + carry;
 		buf[i] = sum;
 		carry = sum >> 8;
@@ -44,22 +56,29 @@ static ValueRef doLittleEndianAdd(const Optional<ValueRef>& existingValueOptiona
 		carry = sum >> 8;
 	}
 
-	return StringRef(buf, i);	
+	return StringRef(buf, i);
 }
 
 static ValueRef doAnd(const Optional<ValueRef>& existingValueOptional, const ValueRef& otherOperand, Arena& ar) {
 	const ValueRef& existingValue = existingValueOptional.present() ? existingValueOptional.get() : StringRef();
 	if(!otherOperand.size()) return otherOperand;
-	
+
 	uint8_t* buf = new (ar) uint8_t [otherOperand.size()];
 	int i = 0;
-	
-	for(i = 0; i<std::min(existingValue.size(), otherOperand.size()); i++)
+	int common = std::min(existingValue.size(), otherOperand.size());
+
+	for(; i+8 <= common; i += 8) {
+		uint64_t a, b;
+		memcpy(&a, existingValue.begin() + i, 8);
+		memcpy(&b, otherOperand.begin() + i, 8);
+		uint64_t r = a & b;
+		memcpy(buf + i, &r, 8);
+	}
+	for(; i<common; i++)
 		buf[i] = existingValue[i] & otherOperand[i];
-	for(; i<otherOperand.size(); i++)
-		buf[i] = 0x0;
+	memset(buf + i, 0x0, otherOperand.size() - i);
 
-	return StringRef(buf, i);
+	return StringRef(buf, otherOperand.size());
 }
 
 static ValueRef doAndV2(const Optional<ValueRef>& existingValueOptional, const ValueRef& otherOperand, Arena& ar) {
@@ -76,13 +95,20 @@ static ValueRef doOr(const Optional<ValueRef>& existingValueOptional, const Valu
 
 	uint8_t* buf = new (ar) uint8_t [otherOperand.size()];
 	int i = 0;
-	
-	for(i = 0; i<std::min(existingValue.size(), otherOperand.size()); i++)
+	int common = std::min(existingValue.size(), otherOperand.size());
+
+	for(; i+8 <= common; i += 8) {
+		uint64_t a, b;
+		memcpy(&a, existingValue.begin() + i, 8);
+		memcpy(&b, otherOperand.begin() + i, 8);
+		uint64_t r = a | b;
+		memcpy(buf + i, &r, 8);
+	}
+	for(; i<common; i++)
 		buf[i] = existingValue[i] | otherOperand[i];
-	for(; i<otherOperand.size(); i++)
-		buf[i] = otherOperand[i];
+	memcpy(buf + i, otherOperand.begin() + i, otherOperand.size() - i);
 
-	return StringRef(buf, i);
+	return StringRef(buf, otherOperand.size());
 }
 
 static ValueRef doXor(const Optional<ValueRef>& existingValueOptional, const ValueRef& otherOperand, Arena& ar) {
@@ -92,14 +118,20 @@ static ValueRef doXor(const Optional<ValueRef>& existingValueOptional, const Val
 	
 	uint8_t* buf = new (ar) uint8_t [otherOperand.size()];
 	int i = 0;
-	
-	for(i = 0; i<std::min(existingValue.size(), otherOperand.size()); i++)
+	int common = std::min(existingValue.size(), otherOperand.size());
+
+	for(; i+8 <= common; i += 8) {
+		uint64_t a, b;
+		memcpy(&a, existingValue.begin() + i, 8);
+		memcpy(&b, otherOperand.begin() + i, 8);
+		uint64_t r = a ^ b;
+		memcpy(buf + i, &r, 8);
+	}
+	for(; i<common; i++)
 		buf[i] = existingValue[i] ^ otherOperand[i];
+	memcpy(buf + i, otherOperand.begin() + i, otherOperand.size() - i);
 
-	for(; i<otherOperand.size(); i++)
-		buf[i] = otherOperand[i];
-
-	return StringRef(buf, i);
+	return StringRef(buf, otherOperand.size());
 }
 
 static ValueRef doAppendIfFits(const Optional<ValueRef>& existingValueOptional, const ValueRef& otherOperand, Arena& ar) {
@@ -112,15 +144,11 @@ static ValueRef doAppendIfFits(const Optional<ValueRef>& existingValueOptional,
 	}
 
 	uint8_t* buf = new (ar) uint8_t [existingValue.size() + otherOperand.size()];
-	int i,j;
-
-	for(i = 0; i<existingValue.size(); i++)
-		buf[i] = existingValue[i];
 
-	for(j = 0; j<otherOperand.size(); j++)
-		buf[i+j] = otherOperand[j];
+	memcpy(buf, existingValue.begin(), existingValue.size());
+	memcpy(buf + existingValue.size(), otherOperand.begin(), otherOperand.size());
 
-	return StringRef(buf, i+j);
+	return StringRef(buf, existingValue.size() + otherOperand.size());
 }
 
 static ValueRef doMax(const Optional<ValueRef>& existingValueOptional, const ValueRef& otherOperand, Arena& ar) {
@@ -128,7 +156,7 @@ static ValueRef doMax(const Optional<ValueRef>& existingValueOptional, const Val
 	if (!existingValue.size()) return otherOperand;
 	if (!otherOperand.size()) return otherOperand;
 
-	int i,j;
+	int i;
 
 	for (i = otherOperand.size() - 1; i >= existingValue.size(); i--) {
 		if (otherOperand[i] != 0) {
@@ -142,13 +170,10 @@ static ValueRef doMax(const Optional<ValueRef>& existingValueOptional, const Val
 		}
 		else if (otherOperand[i] < existingValue[i]) {
 			uint8_t* buf = new (ar) uint8_t [otherOperand.size()];
-			for (j = 0; j < std::min(existingValue.size(), otherOperand.size()); j++) {
-				buf[j] = existingValue[j];
-			}
-			for (; j < otherOperand.size(); j++) {
-				buf[j] = 0x0;
-			}
-			return StringRef(buf, j);
+			int common = std::min(existingValue.size(), otherOperand.size());
+			memcpy(buf, existingValue.begin(), common);
+			memset(buf + common, 0x0, otherOperand.size() - common);
+			return StringRef(buf, otherOperand.size());
 		}
 	}
 
@@ -169,31 +194,25 @@ static ValueRef doMin(const Optional<ValueRef>& existingValueOptional, const Val
 	if (!otherOperand.size()) return otherOperand;
 
 	const ValueRef& existingValue = existingValueOptional.present() ? existingValueOptional.get() : StringRef();
-	int i,j;
+	int i;
 
 	for (i = otherOperand.size() - 1; i >= existingValue.size(); i--) {
 		if (otherOperand[i] != 0) {
 			uint8_t* buf = new (ar)uint8_t[otherOperand.size()];
-			for (j = 0; j < std::min(existingValue.size(), otherOperand.size()); j++) {
-				buf[j] = existingValue[j];
-			}
-			for (; j < otherOperand.size(); j++) {
-				buf[j] = 0x0;
-			}
-			return StringRef(buf, j);
+			int common = std::min(existingValue.size(), otherOperand.size());
+			memcpy(buf, existingValue.begin(), common);
+			memset(buf + common, 0x0, otherOperand.size() - common);
+			return StringRef(buf, otherOperand.size());
 		}
 	}
 
 	for (; i >= 0; i--) {
 		if (otherOperand[i] > existingValue[i]) {
 			uint8_t* buf = new (ar)uint8_t[otherOperand.size()];
-			for (j = 0; j < std::min(existingValue.size(), otherOperand.size()); j++) {
-				buf[j] = existingValue[j];
-			}
-			for (; j < otherOperand.size(); j++) {
-				buf[j] = 0x0;
-			}
-			return StringRef(buf, j);
+			int common = std::min(existingValue.size(), otherOperand.size());
+			memcpy(buf, existingValue.begin(), common);
+			memset(buf + common, 0x0, otherOperand.size() - common);
+			return StringRef(buf, otherOperand.size());
 		}
 		else if (otherOperand[i] < existingValue[i]) {
 			return otherOperand;
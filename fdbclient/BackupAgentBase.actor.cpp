@@ -344,6 +344,9 @@ ACTOR Future<Void> readCommitted(Database cx, PromiseStream<RangeResultWithVersi
 				tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
 			if (lockAware)
 				tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			// Backup scans should queue behind client traffic at the proxies rather than compete with it
+			if (CLIENT_KNOBS->BACKUP_USE_BATCH_PRIORITY)
+				tr.setOption(FDBTransactionOptions::PRIORITY_BATCH);
 
 			//add lock
 			releaser.release();
@@ -403,6 +406,9 @@ ACTOR Future<Void> readCommitted(Database cx, PromiseStream<RCGroup> results, Fu
 				tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
 			if (lockAware)
 				tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			// Backup scans should queue behind client traffic at the proxies rather than compete with it
+			if (CLIENT_KNOBS->BACKUP_USE_BATCH_PRIORITY)
+				tr.setOption(FDBTransactionOptions::PRIORITY_BATCH);
 
 			state Standalone<RangeResultRef> rangevalue = wait(tr.getRange(nextKey, end, limits));
 
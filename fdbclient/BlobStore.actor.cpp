@@ -37,6 +37,8 @@ json_spirit::mObject BlobStoreEndpoint::Stats::getJSON() {
 	o["requests_failed"] = requests_failed;
 	o["requests_successful"] = requests_successful;
 	o["bytes_sent"] = bytes_sent;
+	o["connections_opened"] = connections_opened;
+	o["connections_reused"] = connections_reused;
 
 	return o;
 }
@@ -46,6 +48,8 @@ BlobStoreEndpoint::Stats BlobStoreEndpoint::Stats::operator-(const Stats &rhs) {
 	r.requests_failed = requests_failed - rhs.requests_failed;
 	r.requests_successful = requests_successful - rhs.requests_successful;
 	r.bytes_sent = bytes_sent - rhs.bytes_sent;
+	r.connections_opened = connections_opened - rhs.connections_opened;
+	r.connections_reused = connections_reused - rhs.connections_reused;
 	return r;
 }
 
@@ -56,6 +60,7 @@ BlobStoreEndpoint::BlobKnobs::BlobKnobs() {
 	connect_tries = CLIENT_KNOBS->BLOBSTORE_CONNECT_TRIES;
 	connect_timeout = CLIENT_KNOBS->BLOBSTORE_CONNECT_TIMEOUT;
 	max_connection_life = CLIENT_KNOBS->BLOBSTORE_MAX_CONNECTION_LIFE;
+	max_connection_idle = CLIENT_KNOBS->BLOBSTORE_MAX_CONNECTION_IDLE;
 	request_tries = CLIENT_KNOBS->BLOBSTORE_REQUEST_TRIES;
 	request_timeout = CLIENT_KNOBS->BLOBSTORE_REQUEST_TIMEOUT;
 	requests_per_second = CLIENT_KNOBS->BLOBSTORE_REQUESTS_PER_SECOND;
@@ -83,6 +88,7 @@ bool BlobStoreEndpoint::BlobKnobs::set(StringRef name, int value) {
 	TRY_PARAM(connect_tries, ct);
 	TRY_PARAM(connect_timeout, cto);
 	TRY_PARAM(max_connection_life, mcl);
+	TRY_PARAM(max_connection_idle, mci);
 	TRY_PARAM(request_tries, rt);
 	TRY_PARAM(request_timeout, rto);
 	TRY_PARAM(requests_per_second, rps);
@@ -115,6 +121,7 @@ std::string BlobStoreEndpoint::BlobKnobs::getURLParameters() const {
 	_CHECK_PARAM(connect_tries, ct);
 	_CHECK_PARAM(connect_timeout, cto);
 	_CHECK_PARAM(max_connection_life, mcl);
+	_CHECK_PARAM(max_connection_idle, mci);
 	_CHECK_PARAM(request_tries, rt);
 	_CHECK_PARAM(request_timeout, rto);
 	_CHECK_PARAM(requests_per_second, rps);
@@ -437,16 +444,19 @@ Future<Void> BlobStoreEndpoint::updateSecret() {
 }
 
 ACTOR Future<BlobStoreEndpoint::ReusableConnection> connect_impl(Reference<BlobStoreEndpoint> b) {
-	// First try to get a connection from the pool
+	// First try to get a connection from the pool.  The front of the pool is the most recently used
+	// connection, and if it has been idle long enough for the server to have closed it then so has
+	// everything behind it.
 	while(!b->connectionPool.empty()) {
 		BlobStoreEndpoint::ReusableConnection rconn = b->connectionPool.front();
-		b->connectionPool.pop();
-
-		// If the connection expires in the future then return it
-		if(rconn.expirationTime > now()) {
-		TraceEvent("BlobStoreEndpointReusingConnected").suppressFor(60)
-			.detail("RemoteEndpoint", rconn.conn->getPeerAddress())
-			.detail("ExpiresIn", rconn.expirationTime - now());
+		b->connectionPool.pop_front();
+
+		// If the connection expires in the future and was used recently then return it
+		if(rconn.expirationTime > now() && now() - rconn.lastUseTime < b->knobs.max_connection_idle) {
+			++BlobStoreEndpoint::s_stats.connections_reused;
+			TraceEvent("BlobStoreEndpointReusingConnected").suppressFor(60)
+				.detail("RemoteEndpoint", rconn.conn->getPeerAddress())
+				.detail("ExpiresIn", rconn.expirationTime - now());
 			return rconn;
 		}
 	}
@@ -462,7 +472,8 @@ ACTOR Future<BlobStoreEndpoint::ReusableConnection> connect_impl(Reference<BlobS
 	if(b->lookupSecret)
 		wait(b->updateSecret());
 
-	return BlobStoreEndpoint::ReusableConnection({conn, now() + b->knobs.max_connection_life});
+	++BlobStoreEndpoint::s_stats.connections_opened;
+	return BlobStoreEndpoint::ReusableConnection({conn, now() + b->knobs.max_connection_life, now()});
 }
 
 Future<BlobStoreEndpoint::ReusableConnection> BlobStoreEndpoint::connect() {
@@ -470,9 +481,12 @@ Future<BlobStoreEndpoint::ReusableConnection> BlobStoreEndpoint::connect() {
 }
 
 void BlobStoreEndpoint::returnConnection(ReusableConnection &rconn) {
-	// If it expires in the future then add it to the pool in the front
-	if(rconn.expirationTime > now())
-		connectionPool.push(rconn);
+	// If it expires in the future then add it to the front of the pool so it is reused first.  The
+	// pool never needs to hold more connections than can be used at once.
+	if(rconn.expirationTime > now() && (int)connectionPool.size() < knobs.concurrent_requests) {
+		rconn.lastUseTime = now();
+		connectionPool.push_front(rconn);
+	}
 	rconn.conn = Reference<IConnection>();
 }
 
@@ -1006,7 +1020,9 @@ ACTOR Future<std::string> uploadPart_impl(Reference<BlobStoreEndpoint> bstore, s
 	HTTP::Headers headers;
 	// Send MD5 sum for content so blobstore can verify it
 	headers["Content-MD5"] = contentMD5;
+	state double startTime = now();
 	state Reference<HTTP::Response> r = wait(bstore->doRequest("PUT", resource, headers, pContent, contentLen, {200}));
+	bstore->updatePartUploadLatency(now() - startTime);
 	// TODO:  In the event that the client times out just before the request completes (so the client is unaware) then the next retry
 	// will see error 400.  That could be detected and handled gracefully by retrieving the etag for the successful request.
 
@@ -1026,6 +1042,18 @@ Future<std::string> BlobStoreEndpoint::uploadPart(std::string const &bucket, std
 	return uploadPart_impl(Reference<BlobStoreEndpoint>::addRef(this), bucket, object, uploadID, partNumber, pContent, contentLen, contentMD5);
 }
 
+void BlobStoreEndpoint::updatePartUploadLatency(double seconds) {
+	partUploadLatency = (partUploadLatency == 0) ? seconds : partUploadLatency * 0.9 + seconds * 0.1;
+
+	// Parts finishing well under the request timeout mean the endpoint can absorb larger parts,
+	// which cuts per-request overhead.  Parts approaching the timeout risk resending an entire
+	// part's worth of data on retry, so back off toward the minimum.
+	if(partUploadLatency < knobs.request_timeout * 0.25)
+		targetPartSize = std::min<int64_t>(int64_t(targetPartSize) * 2, knobs.multipart_max_part_size);
+	else if(partUploadLatency > knobs.request_timeout * 0.5)
+		targetPartSize = std::max(targetPartSize / 2, knobs.multipart_min_part_size);
+}
+
 ACTOR Future<Void> finishMultiPartUpload_impl(Reference<BlobStoreEndpoint> bstore, std::string bucket, std::string object, std::string uploadID, BlobStoreEndpoint::MultiPartSetT parts) {
 	state UnsentPacketQueue part_list();  // NonCopyable state var so must be declared at top of actor
 	wait(bstore->requestRateWrite->getAllowance(1));
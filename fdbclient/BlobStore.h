@@ -21,6 +21,7 @@
 #pragma once
 
 #include <map>
+#include <deque>
 #include <functional>
 #include "flow/flow.h"
 #include "flow/Net2Packet.h"
@@ -34,7 +35,7 @@
 class BlobStoreEndpoint : public ReferenceCounted<BlobStoreEndpoint> {
 public:
 	struct Stats {
-		Stats() : requests_successful(0), requests_failed(0), bytes_sent(0) {}
+		Stats() : requests_successful(0), requests_failed(0), bytes_sent(0), connections_opened(0), connections_reused(0) {}
 		Stats operator-(const Stats &rhs);
 		void clear() { memset(this, sizeof(*this), 0); }
 		json_spirit::mObject getJSON();
@@ -42,6 +43,8 @@ public:
 		int64_t requests_successful;
 		int64_t requests_failed;
 		int64_t bytes_sent;
+		int64_t connections_opened;
+		int64_t connections_reused;
 	};
 
 	static Stats s_stats;
@@ -52,6 +55,7 @@ public:
 			connect_tries,
 			connect_timeout,
 			max_connection_life,
+			max_connection_idle,
 			request_tries,
 			request_timeout,
 			requests_per_second,
@@ -79,6 +83,7 @@ public:
 				"connect_tries (or ct)                 Number of times to try to connect for each request.",
 				"connect_timeout (or cto)              Number of seconds to wait for a connect request to succeed.",
 				"max_connection_life (or mcl)          Maximum number of seconds to use a single TCP connection.",
+				"max_connection_idle (or mci)          Maximum number of seconds a pooled connection can be idle before it is discarded instead of reused.",
 				"request_tries (or rt)                 Number of times to try each request until a parseable HTTP response other than 429 is received.",
 				"request_timeout (or rto)              Number of seconds to wait for a request to succeed after a connection is established.",
 				"requests_per_second (or rps)          Max number of requests to start per second.",
@@ -113,7 +118,9 @@ public:
 		recvRate(new SpeedLimit(knobs.max_recv_bytes_per_second, 1)),
 		concurrentRequests(knobs.concurrent_requests),
 		concurrentUploads(knobs.concurrent_uploads),
-		concurrentLists(knobs.concurrent_lists) {
+		concurrentLists(knobs.concurrent_lists),
+		targetPartSize(knobs.multipart_min_part_size),
+		partUploadLatency(0) {
 
 		if(host.empty())
 			throw connection_string_invalid();
@@ -139,8 +146,10 @@ public:
 	struct ReusableConnection {
 		Reference<IConnection> conn;
 		double expirationTime;
+		double lastUseTime;
 	};
-	std::queue<ReusableConnection> connectionPool;
+	// Most recently used connections are reused first so that idle connections age out of the pool
+	std::deque<ReusableConnection> connectionPool;
 	Future<ReusableConnection> connect();
 	void returnConnection(ReusableConnection &conn);
 
@@ -163,6 +172,17 @@ public:
 	FlowLock concurrentUploads;
 	FlowLock concurrentLists;
 
+	// Target size for multipart upload parts, adapted between the multipart min and max part size
+	// knobs based on observed per-part upload latency.
+	int targetPartSize;
+	double partUploadLatency;
+
+	// Returns the part size that new multipart upload parts should aim for.
+	int getTargetPartSize() const { return targetPartSize; }
+
+	// Feeds an observed per-part upload time into the adaptive part size above.
+	void updatePartUploadLatency(double seconds);
+
 	Future<Void> updateSecret();
 
 	// Calculates the authentication string from the secret key
@@ -32,6 +32,7 @@
 struct ClientWorkerInterface {
 	RequestStream< struct RebootRequest > reboot;
 	RequestStream< struct ProfilerRequest > profiler;
+	RequestStream< struct MemSampleDumpRequest > memSampleDump;
 
 	bool operator == (ClientWorkerInterface const& r) const { return id() == r.id(); }
 	bool operator != (ClientWorkerInterface const& r) const { return id() != r.id(); }
@@ -40,7 +41,7 @@ struct ClientWorkerInterface {
 
 	template <class Ar>
 	void serialize( Ar& ar ) {
-		ar & reboot & profiler;
+		ar & reboot & profiler & memSampleDump;
 	}
 };
 
@@ -61,7 +62,8 @@ struct ProfilerRequest {
 
 	enum class Type : std::int8_t {
 		GPROF = 1,
-		FLOW = 2
+		FLOW = 2,
+		FLOW_DUMP = 3   // Dump the running flow profiler's aggregated stacks to outputFile
 	};
 
 	enum class Action : std::int8_t {
@@ -83,4 +85,29 @@ struct ProfilerRequest {
 BINARY_SERIALIZABLE( ProfilerRequest::Type );
 BINARY_SERIALIZABLE( ProfilerRequest::Action );
 
+struct MemSampleDumpReply {
+	bool instrumented;   // false if the worker's binary was built without ALLOC_INSTRUMENTATION
+	int64_t backTraces;  // number of sampled allocation backtraces dumped to the worker's trace log
+
+	MemSampleDumpReply() : instrumented(false), backTraces(0) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & instrumented & backTraces;
+	}
+};
+
+// Asks a worker to dump its sampled allocation backtraces and per-size-class totals to its trace
+// log immediately (as MemSampleDump and MemSampleSizeClass events), so memory growth can be
+// attributed to allocation sites without waiting for the system monitor or restarting with a heap
+// profiler
+struct MemSampleDumpRequest {
+	ReplyPromise< struct MemSampleDumpReply > reply;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & reply;
+	}
+};
+
 #endif
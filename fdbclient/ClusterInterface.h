@@ -178,11 +178,16 @@ struct FailureMonitoringReply {
 };
 
 struct StatusRequest {
+	// The (name, hash) of each top level section of the last status document the requester
+	// received, in document order (see splitJsonObjectText() in Status.h).  If present, the
+	// cluster controller may reply with a delta instead of the full document text, omitting
+	// the text of sections whose hashes match.
+	std::vector<std::pair<std::string, uint64_t>> knownSections;
 	ReplyPromise< struct StatusReply > reply;
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & reply;
+		ar & knownSections & reply;
 	}
 };
 
@@ -190,14 +195,22 @@ struct StatusReply {
 	StatusObject statusObj;
 	std::string statusStr;
 
-	StatusReply() {}
-	explicit StatusReply(StatusObject obj) : statusObj(obj), statusStr(json_spirit::write_string(json_spirit::mValue(obj))) {}
-	explicit StatusReply(std::string &&text) : statusStr(text) {}
+	// If delta is true then statusStr and statusObj are empty; sectionHashes lists every top level
+	// section of the current document in document order and changedSections holds the text of just
+	// those sections not matched by the request's knownSections.  The requester reassembles the
+	// document from changedSections and its own copies of the unchanged sections.
+	bool delta;
+	std::vector<std::pair<std::string, uint64_t>> sectionHashes;
+	std::vector<std::pair<std::string, std::string>> changedSections;
+
+	StatusReply() : delta(false) {}
+	explicit StatusReply(StatusObject obj) : statusObj(obj), statusStr(json_spirit::write_string(json_spirit::mValue(obj))), delta(false) {}
+	explicit StatusReply(std::string &&text) : statusStr(text), delta(false) {}
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & statusStr;
-		if( ar.isDeserializing ) {
+		ar & statusStr & delta & sectionHashes & changedSections;
+		if( ar.isDeserializing && !delta ) {
 			json_spirit::mValue mv;
 			if(g_network->isSimulated()) {
 				mv = readJSONStrictly(statusStr);
@@ -61,6 +61,57 @@ struct MutationRef {
 	};
 };
 
+// Mutation vectors get the same flat wire framing as VectorRef<KeyValueRef> (see FDBTypes.h):
+// types and parameter lengths up front, parameter bytes contiguous at the end, so an ArenaReader
+// exposes a CommitTransactionRequest's mutations directly out of the received packet's arena.
+template <class Archive>
+inline void load( Archive& ar, VectorRef<MutationRef>& value ) {
+	if (ar.protocolVersion() < 0x0FDB00B061030001LL) {
+		uint32_t length;
+		ar >> length;
+		UNSTOPPABLE_ASSERT( length*sizeof(MutationRef) < (100<<20) );
+		value.resize(ar.arena(), length);
+		for(uint32_t i=0; i<length; i++)
+			ar >> value[i];
+		return;
+	}
+
+	uint32_t length;
+	ar >> length;
+	UNSTOPPABLE_ASSERT( length*sizeof(MutationRef) < (100<<20) );
+	value.resize(ar.arena(), length);
+	for(uint32_t i=0; i<length; i++)
+		ar >> value[i].type;
+	const uint32_t* lengths = (const uint32_t*)ar.readBytes( length * 2 * sizeof(uint32_t) );
+	for(uint32_t i=0; i<length; i++) {
+		uint32_t len1 = lengths[2*i], len2 = lengths[2*i+1];
+		value[i].param1 = StringRef( ar.arenaRead(len1), len1 );
+		value[i].param2 = StringRef( ar.arenaRead(len2), len2 );
+	}
+}
+template <class Archive>
+inline void save( Archive& ar, const VectorRef<MutationRef>& value ) {
+	uint32_t length = value.size();
+	ar << length;
+	if (ar.protocolVersion() < 0x0FDB00B061030001LL) {
+		for(uint32_t i=0; i<length; i++)
+			ar << value[i];
+		return;
+	}
+
+	for(uint32_t i=0; i<length; i++)
+		ar << value[i].type;
+	for(uint32_t i=0; i<length; i++) {
+		uint32_t len1 = value[i].param1.size(), len2 = value[i].param2.size();
+		ar.serializeBinaryItem( len1 );
+		ar.serializeBinaryItem( len2 );
+	}
+	for(uint32_t i=0; i<length; i++) {
+		ar.serializeBytes( value[i].param1.begin(), value[i].param1.size() );
+		ar.serializeBytes( value[i].param2.begin(), value[i].param2.size() );
+	}
+}
+
 // A 'single key mutation' is one which affects exactly the value of the key specified by its param1
 static inline bool isSingleKeyMutation(MutationRef::Type type) {
 	return (MutationRef::SINGLE_KEY_MASK & (1<<type)) != 0;
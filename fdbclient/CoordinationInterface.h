@@ -36,12 +36,28 @@ struct ClientLeaderRegInterface {
 	ClientLeaderRegInterface( INetwork* local );
 };
 
+// A coordinator given by name rather than address, resolved through
+// INetworkConnections::resolveTCPEndpoint whenever leader monitoring (re)connects
+struct ClusterConnectionHostname {
+	std::string host;
+	std::string service;  // the port
+	bool isTLS;
+
+	ClusterConnectionHostname() : isTLS(false) {}
+	ClusterConnectionHostname( std::string host, std::string service, bool isTLS ) : host(host), service(service), isTLS(isTLS) {}
+
+	std::string toString() const { return host + ":" + service + (isTLS ? ":tls" : ""); }
+	bool operator < (ClusterConnectionHostname const& r) const { return std::make_pair(host, service) < std::make_pair(r.host, r.service); }
+	bool operator == (ClusterConnectionHostname const& r) const { return host == r.host && service == r.service && isTLS == r.isTLS; }
+};
+
 class ClusterConnectionString {
 public:
 	ClusterConnectionString() {}
 	ClusterConnectionString( std::string const& connectionString );
 	ClusterConnectionString( vector<NetworkAddress>, Key );
 	vector<NetworkAddress> const& coordinators() const { return coord; }
+	vector<ClusterConnectionHostname> const& hostnames() const { return hosts; }
 	Key clusterKey() const { return key; }
 	Key clusterKeyName() const { return keyDesc; }  // Returns the "name" or "description" part of the clusterKey (the part before the ':')
 	std::string toString() const;
@@ -50,9 +66,15 @@ private:
 	void parseKey( std::string const& key );
 
 	vector<NetworkAddress> coord;
+	vector<ClusterConnectionHostname> hosts;
 	Key key, keyDesc;
 };
 
+// A copy of cs with its hostname coordinators resolved to addresses.  Names which cannot be
+// resolved are dropped with a warning unless nothing at all resolves, in which case
+// lookup_failed is thrown.
+Future<ClusterConnectionString> resolveHostnames( ClusterConnectionString const& cs );
+
 class ClusterConnectionFile : NonCopyable, public ReferenceCounted<ClusterConnectionFile> {
 public:
 	ClusterConnectionFile() {}
@@ -527,15 +527,55 @@ namespace dbBackup {
 		Future<Void> execute(Database cx, Reference<TaskBucket> tb, Reference<FutureBucket> fb, Reference<Task> task) { return _execute(cx, tb, fb, task); };
 		Future<Void> finish(Reference<ReadYourWritesTransaction> tr, Reference<TaskBucket> tb, Reference<FutureBucket> fb, Reference<Task> task) { return _finish(tr, tb, fb, task); };
 
-		ACTOR static Future<Void> dumpData(Database cx, Reference<Task> task, PromiseStream<RCGroup> results, FlowLock* lock, Reference<TaskBucket> tb) {
+		// Writes one batch of mutation log data to the destination, holding a permit on applyLock
+		// (taken by the caller) until the commit is durable.  Batches hold disjoint key sets, so
+		// commits of different batches never conflict and may complete in any order; the copied
+		// range only becomes visible to the apply stage once the whole task finishes.
+		ACTOR static Future<Void> applyBatch(Database cx, Reference<Task> task, std::vector<Standalone<RangeResultRef>> mutations, FlowLock* applyLock) {
+			state FlowLock::Releaser releaser(*applyLock, 1);
+			state Transaction tr(cx);
+
+			loop{
+				try {
+					tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+					tr.options.customTransactionSizeLimit = 2 * CLIENT_KNOBS->TRANSACTION_SIZE_LIMIT;
+					wait(checkDatabaseLock(&tr, BinaryReader::fromStringRef<UID>(task->params[BackupAgentBase::keyConfigLogUid], Unversioned())));
+					state int64_t bytesSet = 0;
+
+					bool first = true;
+					for(auto m : mutations) {
+						for(auto kv : m) {
+							if(first) {
+								tr.addReadConflictRange(singleKeyRange(kv.key));
+								first = false;
+							}
+							tr.set(kv.key.removePrefix(backupLogKeys.begin).removePrefix(task->params[BackupAgentBase::destUid]).withPrefix(task->params[BackupAgentBase::keyConfigLogUid]).withPrefix(applyLogKeys.begin), kv.value);
+							bytesSet += kv.expectedSize() - backupLogKeys.begin.expectedSize() + applyLogKeys.begin.expectedSize();
+						}
+					}
+
+					wait(tr.commit());
+					Params.bytesWritten().set(task, Params.bytesWritten().getOrDefault(task) + bytesSet);
+					return Void();
+				}
+				catch (Error &e) {
+					wait(tr.onError(e));
+				}
+			}
+		}
+
+		ACTOR static Future<Void> dumpData(Database cx, Reference<Task> task, PromiseStream<RCGroup> results, FlowLock* lock, FlowLock* applyLock, Reference<TaskBucket> tb) {
 			state bool endOfStream = false;
 			state Subspace conf = Subspace(databaseBackupPrefixRange.begin).get(BackupAgentBase::keyConfig).get(task->params[BackupAgentBase::keyConfigLogUid]);
 
 			state std::vector<Standalone<RangeResultRef>> nextMutations;
+			state std::vector<Future<Void>> batchApplies;
 			state int64_t nextMutationSize = 0;
 			loop{
 				try {
 					if (endOfStream && !nextMutationSize) {
+						// Source reads have finished; wait for the pipelined destination commits
+						wait(waitForAll(batchApplies));
 						return Void();
 					}
 
@@ -573,35 +613,14 @@ namespace dbBackup {
 						}
 					}
 
-					state Transaction tr(cx);
-
-					loop{
-						try {
-							tr.setOption(FDBTransactionOptions::LOCK_AWARE);
-							tr.options.customTransactionSizeLimit = 2 * CLIENT_KNOBS->TRANSACTION_SIZE_LIMIT;
-							wait(checkDatabaseLock(&tr, BinaryReader::fromStringRef<UID>(task->params[BackupAgentBase::keyConfigLogUid], Unversioned())));
-							state int64_t bytesSet = 0;
-
-							bool first = true;
-							for(auto m : mutations) {
-								for(auto kv : m) {
-									if(first) {
-										tr.addReadConflictRange(singleKeyRange(kv.key));
-										first = false;
-									}
-									tr.set(kv.key.removePrefix(backupLogKeys.begin).removePrefix(task->params[BackupAgentBase::destUid]).withPrefix(task->params[BackupAgentBase::keyConfigLogUid]).withPrefix(applyLogKeys.begin), kv.value);
-									bytesSet += kv.expectedSize() - backupLogKeys.begin.expectedSize() + applyLogKeys.begin.expectedSize();
-								}
-							}
-
-							wait(tr.commit());
-							Params.bytesWritten().set(task, Params.bytesWritten().getOrDefault(task) + bytesSet);
-							break;
-						}
-						catch (Error &e) {
-							wait(tr.onError(e));
-						}
+					// Apply this batch while the next ones are read from the source; the permit
+					// bounds both apply concurrency and the batches buffered beyond the read lock
+					wait(applyLock->take());
+					for(auto &f : batchApplies) {
+						if (f.isError())
+							throw f.getError();
 					}
+					batchApplies.push_back( applyBatch(cx, task, std::move(mutations), applyLock) );
 				}
 				catch (Error &e) {
 					if (e.code() == error_code_actor_cancelled || e.code() == error_code_backup_error)
@@ -617,6 +636,7 @@ namespace dbBackup {
 
 		ACTOR static Future<Void> _execute(Database cx, Reference<TaskBucket> taskBucket, Reference<FutureBucket> futureBucket, Reference<Task> task) {
 			state Reference<FlowLock> lock(new FlowLock(CLIENT_KNOBS->BACKUP_LOCK_BYTES));
+			state Reference<FlowLock> applyLock(new FlowLock(CLIENT_KNOBS->BACKUP_LOG_APPLY_PARALLELISM));
 
 			wait(checkTaskVersion(cx, task, CopyLogRangeTaskFunc::name, CopyLogRangeTaskFunc::version));
 
@@ -632,7 +652,7 @@ namespace dbBackup {
 			for (int i = 0; i < ranges.size(); ++i) {
 				results.push_back(PromiseStream<RCGroup>());
 				rc.push_back(readCommitted(taskBucket->src, results[i], Future<Void>(Void()), lock, ranges[i], decodeBKMutationLogKey, true, true, true));
-				dump.push_back(dumpData(cx, task, results[i], lock.getPtr(), taskBucket));
+				dump.push_back(dumpData(cx, task, results[i], lock.getPtr(), applyLock.getPtr(), taskBucket));
 			}
 
 			wait(waitForAll(dump));
@@ -2240,12 +2260,22 @@ public:
 				state Optional<Value> backupUid = wait(tr->get(backupAgent->states.get(BinaryWriter::toValue(logUid, Unversioned())).pack(DatabaseBackupAgent::keyFolderId)));
 				if(backupUid.present()) {
 					Optional<Value> v = wait(tr->get(BinaryWriter::toValue(logUid, Unversioned()).withPrefix(applyMutationsBeginRange.begin)));
+					state Optional<Value> copiedValue = wait(tr->get(BinaryWriter::toValue(logUid, Unversioned()).withPrefix(applyMutationsEndRange.begin)));
 
 					if (v.present()) {
 						state Version destApplyBegin = BinaryReader::fromStringRef<Version>(v.get(), Unversioned());
 						Version sourceVersion = wait(srcReadVersion);
 						double secondsBehind = ((double)(sourceVersion - destApplyBegin))/CLIENT_KNOBS->CORE_VERSIONSPERSECOND;
 						statusText += format("\nThe DR is %.6f seconds behind.\n", secondsBehind);
+
+						// Break the lag into its two stages so it is visible whether copying from
+						// the source or applying on the destination is the limit
+						if (copiedValue.present()) {
+							Version destCopied = BinaryReader::fromStringRef<Version>(copiedValue.get(), Unversioned());
+							statusText += format("Mutation log copy from the source is %.6f seconds behind; apply on the destination is %.6f seconds behind the copy.\n",
+								((double)(sourceVersion - destCopied))/CLIENT_KNOBS->CORE_VERSIONSPERSECOND,
+								((double)(destCopied - destApplyBegin))/CLIENT_KNOBS->CORE_VERSIONSPERSECOND);
+						}
 					}
 				}
 
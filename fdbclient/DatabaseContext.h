@@ -31,6 +31,25 @@
 #include "flow/TDMetric.actor.h"
 #include "fdbclient/EventTypes.actor.h"
 #include "fdbrpc/ContinuousSample.h"
+#include <tuple>
+
+// Watches on the same key and value share one outstanding watchValue request, so the number of
+// watches does not multiply request and actor overhead on the client or the storage servers
+struct WatchInfo : public ReferenceCounted<WatchInfo> {
+	Future<Void> watch;
+	int watchers;
+
+	WatchInfo() : watchers(0) {}
+};
+
+// Concurrent get()s of the same key at the same read version share one outstanding getValue
+// request, so a hot key polled by many transactions costs the storage servers a single read
+struct ReadInfo : public ReferenceCounted<ReadInfo> {
+	Future<Optional<Value>> value;
+	int readers;
+
+	ReadInfo() : readers(0) {}
+};
 
 class StorageServerInfo : public ReferencedInterface<StorageServerInterface> {
 public:
@@ -62,10 +81,21 @@ public:
 	void invalidateCache( const KeyRef&, bool isBackward = false );
 	void invalidateCache( const KeyRangeRef& );
 
+	// Identifies a range read exactly: both selectors (orEqual already removed), the limits, and the
+	// direction.  Only an identical repeat read may be served from the range read cache.
+	typedef std::tuple<Key, int, Key, int, int, int, int, bool> RangeReadCacheKey;  // begin key and offset, end key and offset, rows, minRows, bytes, reverse
+	Optional<Standalone<RangeResultRef>> getCachedRangeRead( const RangeReadCacheKey& key );
+	void setCachedRangeRead( const RangeReadCacheKey& key, const KeyRangeRef& keys, Standalone<RangeResultRef> const& result );
+
 	Reference<ProxyInfo> getMasterProxies();
 	Future<Reference<ProxyInfo>> getMasterProxiesFuture();
 	Future<Void> onMasterProxiesChanged();
 
+	// A single proxy chosen from the full proxy list and periodically rotated, to which this client
+	// pins its read version requests (see CLIENT_KNOBS->GRV_PROXY_AFFINITY)
+	Reference<ProxyInfo> getGrvProxyAffinity();
+	void invalidateGrvProxyAffinity() { grvAffinityProxy.clear(); }
+
 	// Update the watch counter for the database
 	void addWatch();
 	void removeWatch();
@@ -96,6 +126,9 @@ public:
 	Future<Void> monitorMasterProxiesInfoChange;
 	Reference<ProxyInfo> masterProxies;
 	UID masterProxiesLastChange;
+	Reference<ProxyInfo> grvAffinityProxy;
+	UID grvAffinityLastChange;
+	double grvAffinityChosenTime;
 	LocalityData clientLocality;
 	QueueModel queueModel;
 	bool enableLocalityLoadBalance;
@@ -107,6 +140,26 @@ public:
 	};
 	std::map<uint32_t, VersionBatcher> versionBatcher;
 
+	// Cached read version for transactions with the USE_GRV_CACHE option.  Refreshed in the
+	// background while recently used, so hot read paths can skip the GRV round trip as long as the
+	// cache is within CLIENT_KNOBS->GRV_CACHE_MAX_STALENESS of real time.
+	Version cachedReadVersion;
+	double lastGrvTime;
+	double lastGrvCacheUse;
+	Future<Void> grvUpdateHandler;
+
+	// Cache of recent range read results for transactions with the USE_RANGE_READ_CACHE option, so
+	// read-mostly ranges polled by many transactions cost the storage servers one read per
+	// RANGE_CACHE_MAX_STALENESS interval per client instead of one read per transaction.  Entries
+	// are dropped when they reach the staleness bound or when invalidateCache observes a shard
+	// boundary change or failure in the range they cover.
+	struct RangeReadCacheEntry {
+		Standalone<RangeResultRef> result;
+		KeyRange keys;    // the key range the read actually covered, for invalidation
+		double readTime;
+	};
+	std::map<RangeReadCacheKey, RangeReadCacheEntry> rangeReadCache;
+
 	// Client status updater
 	struct ClientStatusUpdater {
 		std::vector<BinaryWriter> inStatusQ;
@@ -130,6 +183,7 @@ public:
 	int64_t transactionCommittedMutationBytes;
 	int64_t transactionsCommitStarted;
 	int64_t transactionsCommitCompleted;
+	int64_t transactionsCommitElided;
 	int64_t transactionsTooOld;
 	int64_t transactionsFutureVersions;
 	int64_t transactionsNotCommitted;
@@ -139,6 +193,8 @@ public:
 
 	int outstandingWatches;
 	int maxOutstandingWatches;
+	std::map<std::pair<Key, Optional<Value>>, Reference<WatchInfo>> watchMap;
+	std::map<std::pair<Version, Key>, Reference<ReadInfo>> getValueMap;  // One in-flight getValue per (read version, key); see sharedGetValue
 
 	Future<Void> logger;
 
@@ -50,16 +50,12 @@ struct Tag {
 	std::string toString() const {
 		return format("%d:%d", locality, id);
 	}
-
-	template <class Ar>
-	force_inline void serialize_unversioned(Ar& ar) { 
-		ar & locality & id;
-	}
 };
 #pragma pack(pop)
 
-template <class Ar> void load( Ar& ar, Tag& tag ) { tag.serialize_unversioned(ar); }
-template <class Ar> void save( Ar& ar, Tag const& tag ) { const_cast<Tag&>(tag).serialize_unversioned(ar); }
+// Tags are written once per mutation per tlog location on the commit path; pack(1) above makes the
+// single copy byte-identical to serializing locality then id
+FIXED_LAYOUT_BINARY_SERIALIZABLE( Tag, sizeof(int8_t) + sizeof(uint16_t) );
 
 static const Tag invalidTag {tagLocalitySpecial, 0};
 static const Tag txsTag {tagLocalitySpecial, 1};
@@ -258,13 +254,67 @@ struct KeyValueRef {
 	};
 };
 
+// Vectors of key-value pairs are framed flat on the wire as of protocol version 0x0FDB00B061030001:
+// a count, a table of key/value lengths, and then all string bytes contiguously.  With ArenaReader
+// (the FlowTransport receive path) the byte region is exposed directly out of the received packet's
+// arena, so a large GetKeyValuesReply or CommitTransactionRequest is not memcpy'd element by
+// element during deserialization.  Readers of pre-flat data (or writers targeting it) fall back to
+// the element-wise format.
+template <class Archive>
+inline void load( Archive& ar, VectorRef<KeyValueRef>& value ) {
+	if (ar.protocolVersion() < 0x0FDB00B061030001LL) {
+		uint32_t length;
+		ar >> length;
+		UNSTOPPABLE_ASSERT( length*sizeof(KeyValueRef) < (100<<20) );
+		value.resize(ar.arena(), length);
+		for(uint32_t i=0; i<length; i++)
+			ar >> value[i];
+		return;
+	}
+
+	uint32_t length;
+	ar >> length;
+	UNSTOPPABLE_ASSERT( length*sizeof(KeyValueRef) < (100<<20) );
+	value.resize(ar.arena(), length);
+	const uint32_t* lengths = (const uint32_t*)ar.readBytes( length * 2 * sizeof(uint32_t) );
+	for(uint32_t i=0; i<length; i++) {
+		uint32_t keyLength = lengths[2*i], valueLength = lengths[2*i+1];
+		value[i].key = KeyRef( ar.arenaRead(keyLength), keyLength );
+		value[i].value = ValueRef( ar.arenaRead(valueLength), valueLength );
+	}
+}
+template <class Archive>
+inline void save( Archive& ar, const VectorRef<KeyValueRef>& value ) {
+	uint32_t length = value.size();
+	ar << length;
+	if (ar.protocolVersion() < 0x0FDB00B061030001LL) {
+		for(uint32_t i=0; i<length; i++)
+			ar << value[i];
+		return;
+	}
+
+	for(uint32_t i=0; i<length; i++) {
+		uint32_t keyLength = value[i].key.size(), valueLength = value[i].value.size();
+		ar.serializeBinaryItem( keyLength );
+		ar.serializeBinaryItem( valueLength );
+	}
+	for(uint32_t i=0; i<length; i++) {
+		ar.serializeBytes( value[i].key.begin(), value[i].key.size() );
+		ar.serializeBytes( value[i].value.begin(), value[i].value.size() );
+	}
+}
+
 typedef Standalone<KeyRef> Key;
 typedef Standalone<ValueRef> Value;
 typedef Standalone<KeyRangeRef> KeyRange;
 typedef Standalone<KeyValueRef> KeyValue;
 typedef Standalone<struct KeySelectorRef> KeySelector; 
 
-enum { invalidVersion = -1, latestVersion = -2 };
+// Reads at the latestVersion sentinel are answered at whatever version the serving storage
+// replica has reached, and reads at replicaDurableVersion at the oldest version it still
+// guarantees readable (at least what it has made durable); neither ever waits for the replica
+// to catch up, and the version actually used is stamped in the reply.
+enum { invalidVersion = -1, latestVersion = -2, replicaDurableVersion = -3 };
 
 inline Key keyAfter( const KeyRef& key ) {
 	if(key == LiteralStringRef("\xff\xff"))
@@ -474,6 +524,15 @@ struct RangeResultRef : VectorRef<KeyValueRef> {
 	}
 };
 
+// Result of an aggregate-only range scan: the totals are computed on the storage servers and only
+// these integers are shipped to the client.
+struct RangeAggregate {
+	int64_t rows;
+	int64_t bytes;  // sum of key and value sizes of the rows in the range
+
+	RangeAggregate() : rows(0), bytes(0) {}
+};
+
 struct KeyValueStoreType {
 	// These enumerated values are stored in the database configuration, so can NEVER be changed.  Only add new ones just before END.
 	enum StoreType {
@@ -28,6 +28,7 @@
 #include <ctime>
 #include <climits>
 #include "fdbrpc/IAsyncFile.h"
+#include "fdbrpc/zlib/zlib.h"
 #include "flow/genericactors.actor.h"
 #include "flow/Hash3.h"
 #include <numeric>
@@ -409,6 +410,89 @@ namespace fileBackup {
 	// may not be initialized yet a conservative constant is being used.
 	std::string paddingFFs(128 * 1024, 0xFF);
 
+	// Compresses one block's payload through a deflate stream so a writer can keep appending
+	// records until the compressed size approaches the physical block size, then finish() completes
+	// the stream and returns the entire physical block:  the file version, the uncompressed and
+	// compressed payload lengths (network byte order), and the compressed bytes.  The caller pads
+	// the block out to the block boundary as usual, so compressed files keep the same physical
+	// block grid as uncompressed files and remain readable starting at any block boundary.
+	struct BlockCompressor : ReferenceCounted<BlockCompressor>, NonCopyable {
+		BlockCompressor() : open(false), rawLen(0) {}
+		~BlockCompressor() { reset(); }
+
+		void reset() {
+			if(open) {
+				deflateEnd(&z);
+				open = false;
+			}
+		}
+
+		// Begin a new block, reserving space in the output buffer for the block header
+		void start() {
+			reset();
+			memset(&z, 0, sizeof(z));
+			if(deflateInit(&z, Z_DEFAULT_COMPRESSION) != Z_OK)
+				throw internal_error();
+			open = true;
+			rawLen = 0;
+			buffer.assign(3 * sizeof(uint32_t), 0);
+		}
+
+		void append(const void *data, int len) {
+			ASSERT(open);
+			z.next_in = (Bytef *)data;
+			z.avail_in = len;
+			while(z.avail_in > 0)
+				deflateChunk(Z_NO_FLUSH);
+			rawLen += len;
+		}
+
+		// Append a string prefixed with its length in network byte order, the same encoding that
+		// IBackupFile::appendStringRefWithLen produces
+		void appendStringRefWithLen(StringRef s) {
+			uint32_t lenBE = bigEndian32((uint32_t)s.size());
+			append(&lenBE, sizeof(lenBE));
+			append(s.begin(), s.size());
+		}
+
+		// Conservative upper bound on the physical size of this block if bytesNeeded more payload
+		// bytes were appended and the block then finished.  The slack covers data deflate may still
+		// be holding in its window plus the final block overhead.
+		int64_t pendingSize(int bytesNeeded) const {
+			return (int64_t)buffer.size() + bytesNeeded + (bytesNeeded >> 10) + 64 * 1024;
+		}
+
+		// Complete the compressed stream and fill in the block header.  The returned StringRef is
+		// valid until the next start().
+		StringRef finish(uint32_t fileVersion) {
+			ASSERT(open);
+			while(deflateChunk(Z_FINISH) != Z_STREAM_END);
+			uint32_t header[3] = { fileVersion, bigEndian32((uint32_t)rawLen), bigEndian32((uint32_t)(buffer.size() - sizeof(header))) };
+			memcpy(&buffer[0], header, sizeof(header));
+			reset();
+			return StringRef((const uint8_t *)buffer.data(), buffer.size());
+		}
+
+		bool open;
+		int64_t rawLen;
+
+	private:
+		int deflateChunk(int flush) {
+			size_t used = buffer.size();
+			buffer.resize(used + 16384);
+			z.next_out = (Bytef *)&buffer[used];
+			z.avail_out = 16384;
+			int r = deflate(&z, flush);
+			if(r == Z_STREAM_ERROR)
+				throw internal_error();
+			buffer.resize(buffer.size() - z.avail_out);
+			return r;
+		}
+
+		z_stream z;
+		std::string buffer;
+	};
+
 	// File Format handlers.
 	// Both Range and Log formats are designed to be readable starting at any 1MB boundary
 	// so they can be read in parallel.
@@ -442,10 +526,28 @@ namespace fileBackup {
 	//   then the space after the final key to the next 1MB boundary would
 	//   just be padding anyway.
 	struct RangeFileWriter {
-		RangeFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(), int blockSize = 0) : file(file), blockSize(blockSize), blockEnd(0), fileVersion(1001) {}
+		RangeFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(), int blockSize = 0)
+		  : file(file), blockSize(blockSize), blockEnd(0), compress(CLIENT_KNOBS->BACKUP_COMPRESS_BLOCKS != 0), fileVersion(CLIENT_KNOBS->BACKUP_COMPRESS_BLOCKS ? 1002 : 1001) {
+			if(compress)
+				compressor = Reference<BlockCompressor>(new BlockCompressor());
+		}
+
+		// Write the current compressed block, which must fit within the current block boundary
+		ACTOR static Future<Void> flushCompressedBlock(RangeFileWriter *self) {
+			StringRef block = self->compressor->finish(self->fileVersion);
+			if(self->file->size() + block.size() > self->blockEnd)
+				throw backup_bad_block_size();
+			wait(self->file->append(block.begin(), block.size()));
+			return Void();
+		}
 
 		// Handles the first block and internal blocks.  Ends current block if needed.
 		ACTOR static Future<Void> newBlock(RangeFileWriter *self, int bytesNeeded) {
+			// If compressing, write the finished block before padding
+			if(self->compress && self->compressor->open) {
+				wait(flushCompressedBlock(self));
+			}
+
 			// Write padding to finish current block if needed
 			int bytesLeft = self->blockEnd - self->file->size();
 			if(bytesLeft > 0) {
@@ -455,36 +557,66 @@ namespace fileBackup {
 			// Set new blockEnd
 			self->blockEnd += self->blockSize;
 
-			// write Header
-			wait(self->file->append((uint8_t *)&self->fileVersion, sizeof(self->fileVersion)));
+			if(self->compress) {
+				self->compressor->start();
+			}
+			else {
+				// write Header
+				wait(self->file->append((uint8_t *)&self->fileVersion, sizeof(self->fileVersion)));
+			}
 
 			// If this is NOT the first block then write duplicate stuff needed from last block
 			if(self->blockEnd > self->blockSize) {
-				wait(self->file->appendStringRefWithLen(self->lastKey));
-				wait(self->file->appendStringRefWithLen(self->lastKey));
-				wait(self->file->appendStringRefWithLen(self->lastValue));
+				wait(self->appendStringRefWithLen(self->lastKey));
+				wait(self->appendStringRefWithLen(self->lastKey));
+				wait(self->appendStringRefWithLen(self->lastValue));
 			}
 
 			// There must now be room in the current block for bytesNeeded or the block size is too small
-			if(self->file->size() + bytesNeeded > self->blockEnd)
+			if(self->blockFull(bytesNeeded))
 				throw backup_bad_block_size();
 
 			return Void();
 		}
 
+		// Returns whether the current block cannot hold bytesNeeded more payload bytes.  When
+		// compressing, the limit is applied to a conservative bound on the compressed size so a
+		// block can hold more than blockSize of payload when the data compresses.
+		bool blockFull(int bytesNeeded) const {
+			if(compress)
+				return !compressor->open || compressor->pendingSize(bytesNeeded) > blockSize;
+			return file->size() + bytesNeeded > blockEnd;
+		}
+
 		// Ends the current block if necessary based on bytesNeeded.
 		Future<Void> newBlockIfNeeded(int bytesNeeded) {
-			if(file->size() + bytesNeeded > blockEnd)
+			if(blockFull(bytesNeeded))
 				return newBlock(this, bytesNeeded);
 			return Void();
 		}
 
+		// Appends a length prefixed string to the current block
+		Future<Void> appendStringRefWithLen(StringRef s) {
+			if(compress) {
+				compressor->appendStringRefWithLen(s);
+				return Void();
+			}
+			return file->appendStringRefWithLen(s);
+		}
+
+		// Write the final compressed block, if any.  Must be called after the last writeKey().
+		Future<Void> finish() {
+			if(compress && compressor->open)
+				return flushCompressedBlock(this);
+			return Void();
+		}
+
 		// Start a new block if needed, then write the key and value
 		ACTOR static Future<Void> writeKV_impl(RangeFileWriter *self, Key k, Value v) {
 			int toWrite = sizeof(int32_t) + k.size() + sizeof(int32_t) + v.size();
 			wait(self->newBlockIfNeeded(toWrite));
-			wait(self->file->appendStringRefWithLen(k));
-			wait(self->file->appendStringRefWithLen(v));
+			wait(self->appendStringRefWithLen(k));
+			wait(self->appendStringRefWithLen(v));
 			self->lastKey = k;
 			self->lastValue = v;
 			return Void();
@@ -496,7 +628,7 @@ namespace fileBackup {
 		ACTOR static Future<Void> writeKey_impl(RangeFileWriter *self, Key k) {
 			int toWrite = sizeof(uint32_t) + k.size();
 			wait(self->newBlockIfNeeded(toWrite));
-			wait(self->file->appendStringRefWithLen(k));
+			wait(self->appendStringRefWithLen(k));
 			return Void();
 		}
 
@@ -507,7 +639,9 @@ namespace fileBackup {
 
 	private:
 		int64_t blockEnd;
+		bool compress;
 		uint32_t fileVersion;
+		Reference<BlockCompressor> compressor;
 		Key lastKey;
 		Key lastValue;
 	};
@@ -548,20 +682,57 @@ namespace fileBackup {
 		Error failure_error;
 	};
 
+	// Reads the uncompressed and compressed payload lengths of a compressed block from reader, then
+	// inflates the compressed payload that follows into a new buffer.
+	Standalone<StringRef> decompressBlockPayload(StringRefReader *reader) {
+		uint32_t rawLen = reader->consumeNetworkUInt32();
+		uint32_t compLen = reader->consumeNetworkUInt32();
+		const uint8_t *comp = reader->consume(compLen);
+
+		Standalone<StringRef> raw = makeString(rawLen);
+		z_stream z;
+		memset(&z, 0, sizeof(z));
+		if(inflateInit(&z) != Z_OK)
+			throw internal_error();
+		z.next_in = (Bytef *)comp;
+		z.avail_in = compLen;
+		z.next_out = mutateString(raw);
+		z.avail_out = rawLen;
+		int r = inflate(&z, Z_FINISH);
+		bool valid = (r == Z_STREAM_END && z.avail_in == 0 && z.avail_out == 0);
+		inflateEnd(&z);
+		if(!valid)
+			throw reader->failure_error;
+		return raw;
+	}
+
 	ACTOR Future<Standalone<VectorRef<KeyValueRef>>> decodeRangeFileBlock(Reference<IAsyncFile> file, int64_t offset, int len) {
 		state Standalone<StringRef> buf = makeString(len);
 		int rLen = wait(file->read(mutateString(buf), len, offset));
 		if(rLen != len)
 			throw restore_bad_read();
 
-		Standalone<VectorRef<KeyValueRef>> results({}, buf.arena());
 		state StringRefReader reader(buf, restore_corrupted_data());
 
 		try {
-			// Read header, currently only decoding version 1001
-			if(reader.consume<int32_t>() != 1001)
+			// Read header, currently decoding versions 1001 (raw) and 1002 (deflate compressed)
+			int32_t fileVersion = reader.consume<int32_t>();
+			if(fileVersion != 1001 && fileVersion != 1002)
 				throw restore_unsupported_file_version();
 
+			// For a compressed block, inflate the payload and then parse it in place of the raw
+			// block contents.  The physical remainder of the block must be all 0xFF padding.
+			if(fileVersion == 1002) {
+				Standalone<StringRef> raw = decompressBlockPayload(&reader);
+				for(auto b : reader.remainder())
+					if(b != 0xFF)
+						throw restore_corrupted_data_padding();
+				buf = raw;
+				reader = StringRefReader(buf, restore_corrupted_data());
+			}
+
+			Standalone<VectorRef<KeyValueRef>> results({}, buf.arena());
+
 			// Read begin key, if this fails then block was invalid.
 			uint32_t kLen = reader.consumeNetworkUInt32();
 			const uint8_t *k = reader.consume(kLen);
@@ -614,13 +785,56 @@ namespace fileBackup {
 	struct LogFileWriter {
 		static const std::string &FFs;
 
-		LogFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(), int blockSize = 0) : file(file), blockSize(blockSize), blockEnd(0), fileVersion(2001) {}
+		LogFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(), int blockSize = 0)
+		  : file(file), blockSize(blockSize), blockEnd(0), compress(CLIENT_KNOBS->BACKUP_COMPRESS_BLOCKS != 0), fileVersion(CLIENT_KNOBS->BACKUP_COMPRESS_BLOCKS ? 2002 : 2001) {
+			if(compress)
+				compressor = Reference<BlockCompressor>(new BlockCompressor());
+		}
+
+		// Write the current compressed block, which must fit within the current block boundary
+		ACTOR static Future<Void> flushCompressedBlock(LogFileWriter *self) {
+			StringRef block = self->compressor->finish(self->fileVersion);
+			if(self->file->size() + block.size() > self->blockEnd)
+				throw backup_bad_block_size();
+			wait(self->file->append(block.begin(), block.size()));
+			return Void();
+		}
+
+		// Returns whether the current block cannot hold bytesNeeded more payload bytes.  When
+		// compressing, the limit is applied to a conservative bound on the compressed size so a
+		// block can hold more than blockSize of payload when the data compresses.
+		bool blockFull(int bytesNeeded) const {
+			if(compress)
+				return !compressor->open || compressor->pendingSize(bytesNeeded) > blockSize;
+			return file->size() + bytesNeeded > blockEnd;
+		}
+
+		// Appends a length prefixed string to the current block
+		Future<Void> appendStringRefWithLen(StringRef s) {
+			if(compress) {
+				compressor->appendStringRefWithLen(s);
+				return Void();
+			}
+			return file->appendStringRefWithLen(s);
+		}
+
+		// Write the final compressed block, if any.  Must be called after the last writeKV().
+		Future<Void> finish() {
+			if(compress && compressor->open)
+				return flushCompressedBlock(this);
+			return Void();
+		}
 
 		// Start a new block if needed, then write the key and value
 		ACTOR static Future<Void> writeKV_impl(LogFileWriter *self, Key k, Value v) {
 			// If key and value do not fit in this block, end it and start a new one
 			int toWrite = sizeof(int32_t) + k.size() + sizeof(int32_t) + v.size();
-			if(self->file->size() + toWrite > self->blockEnd) {
+			if(self->blockFull(toWrite)) {
+				// If compressing, write the finished block before padding
+				if(self->compress && self->compressor->open) {
+					wait(flushCompressedBlock(self));
+				}
+
 				// Write padding if needed
 				int bytesLeft = self->blockEnd - self->file->size();
 				if(bytesLeft > 0) {
@@ -630,15 +844,20 @@ namespace fileBackup {
 				// Set new blockEnd
 				self->blockEnd += self->blockSize;
 
-				// write Header
-				wait(self->file->append((uint8_t *)&self->fileVersion, sizeof(self->fileVersion)));
+				if(self->compress) {
+					self->compressor->start();
+				}
+				else {
+					// write Header
+					wait(self->file->append((uint8_t *)&self->fileVersion, sizeof(self->fileVersion)));
+				}
 			}
 
-			wait(self->file->appendStringRefWithLen(k));
-			wait(self->file->appendStringRefWithLen(v));
+			wait(self->appendStringRefWithLen(k));
+			wait(self->appendStringRefWithLen(v));
 
 			// At this point we should be in whatever the current block is or the block size is too small
-			if(self->file->size() > self->blockEnd)
+			if(!self->compress && self->file->size() > self->blockEnd)
 				throw backup_bad_block_size();
 
 			return Void();
@@ -651,7 +870,9 @@ namespace fileBackup {
 
 	private:
 		int64_t blockEnd;
+		bool compress;
 		uint32_t fileVersion;
+		Reference<BlockCompressor> compressor;
 	};
 
 	ACTOR Future<Standalone<VectorRef<KeyValueRef>>> decodeLogFileBlock(Reference<IAsyncFile> file, int64_t offset, int len) {
@@ -660,14 +881,27 @@ namespace fileBackup {
 		if(rLen != len)
 			throw restore_bad_read();
 
-		Standalone<VectorRef<KeyValueRef>> results({}, buf.arena());
 		state StringRefReader reader(buf, restore_corrupted_data());
 
 		try {
-			// Read header, currently only decoding version 2001
-			if(reader.consume<int32_t>() != 2001)
+			// Read header, currently decoding versions 2001 (raw) and 2002 (deflate compressed)
+			int32_t fileVersion = reader.consume<int32_t>();
+			if(fileVersion != 2001 && fileVersion != 2002)
 				throw restore_unsupported_file_version();
 
+			// For a compressed block, inflate the payload and then parse it in place of the raw
+			// block contents.  The physical remainder of the block must be all 0xFF padding.
+			if(fileVersion == 2002) {
+				Standalone<StringRef> raw = decompressBlockPayload(&reader);
+				for(auto b : reader.remainder())
+					if(b != 0xFF)
+						throw restore_corrupted_data_padding();
+				buf = raw;
+				reader = StringRefReader(buf, restore_corrupted_data());
+			}
+
+			Standalone<VectorRef<KeyValueRef>> results({}, buf.arena());
+
 			// Read k/v pairs.  Block ends either at end of last value exactly or with 0xFF as first key len byte.
 			while(1) {
 				// If eof reached or first key len bytes is 0xFF then end of block was reached.
@@ -1111,6 +1345,7 @@ namespace fileBackup {
 						TEST(outVersion != invalidVersion); // Backup range task wrote multiple versions
 						state Key nextKey = done ? endKey : keyAfter(lastKey);
 						wait(rangeFile.writeKey(nextKey));
+						wait(rangeFile.finish());
 
 						bool usedFile = wait(finishRangeFile(outFile, cx, task, taskBucket, KeyRangeRef(beginKey, nextKey), outVersion));
 						TraceEvent("FileBackupWroteRangeFile")
@@ -1833,6 +2068,7 @@ namespace fileBackup {
 			// Make sure this task is still alive, if it's not then the data read above could be incomplete.
 			wait(taskBucket->keepRunning(cx, task));
 
+			wait(logFile.finish());
 			wait(outFile->finish());
 
 			TraceEvent("FileBackupWroteLogFile")
@@ -2452,6 +2688,87 @@ namespace fileBackup {
 			return RestoreFileTaskFuncBase::toString(task) + format(" originalFileRange '%s'", printable(Params.originalFileRange().get(task)).c_str());
 		}
 
+		// Writes one contiguous slice of a range file block.  Slices of a block cover disjoint
+		// key ranges, so several slice writers can run concurrently without their transactions
+		// conflicting.  blockData is passed only to keep the arena the data slice points into
+		// alive for the life of this actor.
+		ACTOR static Future<Void> writeBlockSlice(Database cx, Reference<TaskBucket> taskBucket, Reference<Task> task, RestoreConfig restore,
+				RestoreFile rangeFile, int64_t readOffset, int64_t readLen, Standalone<VectorRef<KeyValueRef>> blockData, VectorRef<KeyValueRef> data,
+				int start, int end, Key sliceBegin, Key sliceEnd, Key addPrefix, Key removePrefix, int dataSizeLimit) {
+			state int sliceStart = start;
+			state Reference<ReadYourWritesTransaction> tr( new ReadYourWritesTransaction(cx) );
+
+			loop {
+				try {
+					tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+					tr->setOption(FDBTransactionOptions::LOCK_AWARE);
+
+					state int i = start;
+					state int txBytes = 0;
+					state int iend = start;
+
+					// find iend that results in the desired transaction size
+					for(; iend < end && txBytes < dataSizeLimit; ++iend) {
+						txBytes += data[iend].key.expectedSize();
+						txBytes += data[iend].value.expectedSize();
+					}
+
+					// Clear the range we are about to set.
+					// If starting the slice then use its begin boundary for the start of the range, else data[start]
+					// If iend == end then use the slice's end boundary, else data[iend]
+					state KeyRange trRange = KeyRangeRef((i    == sliceStart) ? sliceBegin : data[i   ].key.removePrefix(removePrefix).withPrefix(addPrefix)
+													   , (iend == end       ) ? sliceEnd   : data[iend].key.removePrefix(removePrefix).withPrefix(addPrefix));
+
+					tr->clear(trRange);
+
+					for(; i < iend; ++i) {
+						tr->setOption(FDBTransactionOptions::NEXT_WRITE_NO_WRITE_CONFLICT_RANGE);
+						tr->set(data[i].key.removePrefix(removePrefix).withPrefix(addPrefix), data[i].value);
+					}
+
+					// Add to bytes written count
+					restore.bytesWritten().atomicOp(tr, txBytes, MutationRef::Type::AddValue);
+
+					state Future<Void> checkLock = checkDatabaseLock(tr, restore.getUid());
+
+					wait(taskBucket->keepRunning(tr, task));
+
+					wait( checkLock );
+
+					wait(tr->commit());
+
+					TraceEvent("FileRestoreCommittedRange")
+						.suppressFor(60)
+						.detail("RestoreUID", restore.getUid())
+						.detail("FileName", rangeFile.fileName)
+						.detail("FileVersion", rangeFile.version)
+						.detail("FileSize", rangeFile.fileSize)
+						.detail("ReadOffset", readOffset)
+						.detail("ReadLen", readLen)
+						.detail("CommitVersion", tr->getCommittedVersion())
+						.detail("BeginRange", printable(trRange.begin))
+						.detail("EndRange", printable(trRange.end))
+						.detail("StartIndex", start)
+						.detail("EndIndex", i)
+						.detail("DataSize", data.size())
+						.detail("Bytes", txBytes)
+						.detail("TaskInstance", (uint64_t)this);
+
+					// Commit succeeded, so advance starting point
+					start = i;
+
+					if(start == end)
+						return Void();
+					tr->reset();
+				} catch(Error &e) {
+					if(e.code() == error_code_transaction_too_large)
+						dataSizeLimit /= 2;
+					else
+						wait(tr->onError(e));
+				}
+			}
+		}
+
 		ACTOR static Future<Void> _execute(Database cx, Reference<TaskBucket> taskBucket, Reference<FutureBucket> futureBucket, Reference<Task> task) {
 			state RestoreConfig restore(task);
 
@@ -2536,77 +2853,35 @@ namespace fileBackup {
 			state int end = data.size();
 			state int dataSizeLimit = BUGGIFY ? g_random->randomInt(256 * 1024, 10e6) : CLIENT_KNOBS->RESTORE_WRITE_TX_SIZE;
 
-			tr->reset();
-			loop {
-				try {
-					tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
-					tr->setOption(FDBTransactionOptions::LOCK_AWARE);
-
-					state int i = start;
-					state int txBytes = 0;
-					state int iend = start;
-
-					// find iend that results in the desired transaction size
-					for(; iend < end && txBytes < dataSizeLimit; ++iend) {
-						txBytes += data[iend].key.expectedSize();
-						txBytes += data[iend].value.expectedSize();
-					}
-
-					// Clear the range we are about to set.
-					// If start == 0 then use fileBegin for the start of the range, else data[start]
-					// If iend == end then use fileEnd for the end of the range, else data[iend]
-					state KeyRange trRange = KeyRangeRef((start == 0 ) ? fileRange.begin : data[start].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get())
-													   , (iend == end) ? fileRange.end   : data[iend ].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get()));
-
-					tr->clear(trRange);
-
-					for(; i < iend; ++i) {
-						tr->setOption(FDBTransactionOptions::NEXT_WRITE_NO_WRITE_CONFLICT_RANGE);
-						tr->set(data[i].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get()), data[i].value);
-					}
-
-					// Add to bytes written count
-					restore.bytesWritten().atomicOp(tr, txBytes, MutationRef::Type::AddValue);
-
-					state Future<Void> checkLock = checkDatabaseLock(tr, restore.getUid());
-
-					wait(taskBucket->keepRunning(tr, task));
-
-					wait( checkLock );
-
-					wait(tr->commit());
-
-					TraceEvent("FileRestoreCommittedRange")
-						.suppressFor(60)
-						.detail("RestoreUID", restore.getUid())
-						.detail("FileName", rangeFile.fileName)
-						.detail("FileVersion", rangeFile.version)
-						.detail("FileSize", rangeFile.fileSize)
-						.detail("ReadOffset", readOffset)
-						.detail("ReadLen", readLen)
-						.detail("CommitVersion", tr->getCommittedVersion())
-						.detail("BeginRange", printable(trRange.begin))
-						.detail("EndRange", printable(trRange.end))
-						.detail("StartIndex", start)
-						.detail("EndIndex", i)
-						.detail("DataSize", data.size())
-						.detail("Bytes", txBytes)
-						.detail("OriginalFileRange", printable(originalFileRange))
-						.detail("TaskInstance", (uint64_t)this);
-
-					// Commit succeeded, so advance starting point
-					start = i;
-
-					if(start == end)
-						return Void();
-					tr->reset();
-				} catch(Error &e) {
-					if(e.code() == error_code_transaction_too_large)
-						dataSizeLimit /= 2;
-					else
-						wait(tr->onError(e));
+			// Split the block into contiguous slices of disjoint key ranges and write the slices
+			// concurrently.  Slice writers cannot conflict with each other, so this applies non
+			// overlapping parts of the block in parallel instead of one transaction at a time.
+			int64_t totalBytes = 0;
+			for(int j = start; j < end; ++j)
+				totalBytes += data[j].key.expectedSize() + data[j].value.expectedSize();
+
+			// Don't create slices smaller than one transaction's worth of data
+			int slices = std::max<int64_t>(1, std::min<int64_t>(CLIENT_KNOBS->RESTORE_WRITE_PARALLELISM, totalBytes / dataSizeLimit));
+			int64_t bytesPerSlice = totalBytes / slices + 1;
+
+			state std::vector<Future<Void>> writes;
+			int sliceStart = start;
+			int64_t sliceBytes = 0;
+			Key sliceBegin = fileRange.begin;
+			for(int j = start; j < end; ++j) {
+				sliceBytes += data[j].key.expectedSize() + data[j].value.expectedSize();
+				if(sliceBytes >= bytesPerSlice && j + 1 < end) {
+					Key next = data[j + 1].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get());
+					writes.push_back(writeBlockSlice(cx, taskBucket, task, restore, rangeFile, readOffset, readLen, blockData, data, sliceStart, j + 1, sliceBegin, next, addPrefix.get(), removePrefix.get(), dataSizeLimit));
+					sliceStart = j + 1;
+					sliceBegin = next;
+					sliceBytes = 0;
 				}
 			}
+			writes.push_back(writeBlockSlice(cx, taskBucket, task, restore, rangeFile, readOffset, readLen, blockData, data, sliceStart, end, sliceBegin, fileRange.end, addPrefix.get(), removePrefix.get(), dataSizeLimit));
+
+			wait(waitForAll(writes));
+			return Void();
 		}
 
 		ACTOR static Future<Void> _finish(Reference<ReadYourWritesTransaction> tr, Reference<TaskBucket> taskBucket, Reference<FutureBucket> futureBucket, Reference<Task> task) {
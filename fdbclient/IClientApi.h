@@ -46,6 +46,9 @@ public:
 	virtual ThreadFuture<Standalone<RangeResultRef>> getRange( const KeyRangeRef& keys, GetRangeLimits limits, bool snapshot=false, bool reverse=false) = 0;
 	virtual ThreadFuture<Standalone<VectorRef<const char*>>> getAddressesForKey(const KeyRef& key) = 0;
 	virtual ThreadFuture<Standalone<StringRef>> getVersionstamp() = 0;
+	virtual ThreadFuture<int64_t> getRangeRowCount(const KeyRangeRef& keys) = 0;
+	virtual ThreadFuture<int64_t> getRangeByteSum(const KeyRangeRef& keys) = 0;
+	virtual ThreadFuture<int64_t> getEstimatedRangeSizeBytes(const KeyRangeRef& keys) = 0;
 
 	virtual void addReadConflictRange(const KeyRangeRef& keys) = 0;
 
@@ -61,6 +64,7 @@ public:
 
 	virtual ThreadFuture<Void> commit() = 0;
 	virtual Version getCommittedVersion() = 0;
+	virtual ThreadFuture<int64_t> getApproximateSize() = 0;
 
 	virtual void setOption(FDBTransactionOptions::Option option, Optional<StringRef> value=Optional<StringRef>()) = 0;
 
@@ -23,6 +23,7 @@
 #include "fdbclient/CommitTransaction.h"
 #include "fdbclient/FDBTypes.h"
 #include "fdbclient/ReadYourWrites.h"
+#include "flow/UnitTest.h"
 
 void KeyRangeActorMap::getRangesAffectedByInsertion( const KeyRangeRef& keys, vector< KeyRange >& affectedRanges ) {
 	auto s = map.rangeContaining( keys.begin );
@@ -215,3 +216,41 @@ ACTOR Future<Void> krmSetRangeCoalescing( Transaction *tr, Key mapPrefix, KeyRan
 
 	return Void();
 }
+
+static Key randomTestKey() {
+	int len = g_random->randomInt(1, 4);
+	std::string s;
+	for(int i = 0; i < len; i++)
+		s += (char)g_random->randomInt('a', 'f');
+	return Key(StringRef(s));
+}
+
+TEST_CASE("/fdbclient/KeyRangeMap/flat random ops") {
+	// FlatKeyRangeMap and CoalescedKeyRangeMap both maintain the invariant that adjacent ranges
+	// have unequal values, so after the same inserts they must agree on every probe's range and value
+	for(int t = 0; t < 100; t++) {
+		CoalescedKeyRangeMap<int> reference;
+		FlatKeyRangeMap<int> flat;
+		for(int op = 0; op < 50; op++) {
+			Key begin = randomTestKey();
+			Key end = randomTestKey();
+			if( begin > end )
+				std::swap( begin, end );
+			if( begin == end )
+				continue;
+			int value = g_random->randomInt(0, 4);
+			reference.insert( KeyRangeRef(begin, end), value );
+			flat.insert( KeyRangeRef(begin, end), value );
+
+			for(int probe = 0; probe < 20; probe++) {
+				Key k = randomTestKey();
+				auto r = reference.rangeContaining(k);
+				auto f = flat.rangeContaining(k);
+				ASSERT( r.value() == f.value() );
+				ASSERT( r.begin() == f.begin() );
+				ASSERT( r.end() == f.end() );
+			}
+		}
+	}
+	return Void();
+}
@@ -83,6 +83,93 @@ public:
 	Key mapEnd;
 };
 
+// A read-optimized alternative to CoalescedKeyRangeMap for read-mostly maps: the boundaries live
+// in one sorted flat vector, so a range probe is a binary search over contiguous memory instead of
+// a pointer chase through IndexedSet nodes.  An insert copies the boundary vector into a fresh
+// snapshot (coalescing adjacent equal-valued ranges as it goes) and atomically replaces the old
+// one, so entries returned by rangeContaining() pin their snapshot and stay valid across later
+// inserts and waits.  Only suitable when reads greatly outnumber writes; Val must be equality
+// comparable.
+template <class Val>
+class FlatKeyRangeMap : NonCopyable {
+public:
+	struct Snapshot : ReferenceCounted<Snapshot> {
+		std::vector<std::pair<Key, Val>> boundaries; // sorted by key; the last entry is the map end sentinel
+	};
+
+	// Pins the snapshot it points into, so the referenced range and value outlive later inserts
+	struct Entry {
+		Entry( Reference<Snapshot> snap, int index ) : snap(snap), index(index) {}
+		KeyRangeRef range() const { return KeyRangeRef( begin(), end() ); }
+		KeyRef begin() const { return snap->boundaries[index].first; }
+		KeyRef end() const { return snap->boundaries[index+1].first; }
+		Val const& value() const { return snap->boundaries[index].second; }
+	private:
+		Reference<Snapshot> snap;
+		int index;
+	};
+
+	explicit FlatKeyRangeMap( Val v = Val(), Key endKey = allKeys.end ) : mapEnd(endKey), snap(new Snapshot()) {
+		snap->boundaries.push_back( std::make_pair( Key(), v ) );
+		snap->boundaries.push_back( std::make_pair( endKey, Val() ) );
+	}
+
+	Entry rangeContaining( KeyRef key ) const {
+		ASSERT( key < mapEnd );
+		return Entry( snap, indexContaining( key ) );
+	}
+
+	// The returned reference is only valid until the next insert; use rangeContaining() to hold a value across waits
+	Val const& operator[]( KeyRef key ) const {
+		ASSERT( key < mapEnd );
+		return snap->boundaries[ indexContaining( key ) ].second;
+	}
+
+	int size() const { return snap->boundaries.size() - 1; } // number of ranges
+
+	Reference<Snapshot> getSnapshot() const { return snap; }
+
+	void insert( const KeyRangeRef& keys, const Val& value ) {
+		ASSERT( keys.end <= mapEnd );
+		if( keys.empty() )
+			return;
+
+		auto const& b = snap->boundaries;
+		Reference<Snapshot> next( new Snapshot() );
+		next->boundaries.reserve( b.size() + 2 );
+		auto emit = [&next]( Key const& k, Val const& v ) {
+			if( !next->boundaries.empty() && next->boundaries.back().second == v )
+				return; // coalesce with the preceding range
+			next->boundaries.push_back( std::make_pair( k, v ) );
+		};
+
+		int i = 0;
+		for(; i+1 < b.size() && b[i].first < keys.begin; i++)
+			emit( b[i].first, b[i].second );
+		emit( Key(keys.begin), value );
+		if( keys.end < mapEnd )
+			emit( Key(keys.end), b[ indexContaining( keys.end ) ].second );
+		for(; i+1 < b.size(); i++)
+			if( b[i].first > keys.end )
+				emit( b[i].first, b[i].second );
+		next->boundaries.push_back( std::make_pair( mapEnd, Val() ) );
+
+		snap = next;
+	}
+	void insert( const KeyRef& key, const Val& value ) { insert( singleKeyRange(key), value ); }
+
+	Key mapEnd;
+
+private:
+	Reference<Snapshot> snap;
+
+	int indexContaining( KeyRef key ) const {
+		auto const& b = snap->boundaries;
+		return std::upper_bound( b.begin(), b.end(), key,
+			[]( KeyRef const& k, std::pair<Key, Val> const& p ) { return k < p.first; } ) - b.begin() - 1;
+	}
+};
+
 class KeyRangeActorMap {
 public:
 	void getRangesAffectedByInsertion( const KeyRangeRef& keys, vector< KeyRange >& affectedRanges );
@@ -45,6 +45,8 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	// wrong_shard_server sometimes comes from the only nonfailed server, so we need to avoid a fast spin
 
 	init( WRONG_SHARD_SERVER_DELAY,                .01 ); if( randomize && BUGGIFY ) WRONG_SHARD_SERVER_DELAY = g_random->random01(); // FLOW_KNOBS->PREVENT_FAST_SPIN_DELAY; // SOMEDAY: This delay can limit performance of retrieving data when the cache is mostly wrong (e.g. dumping the database after a test)
+	init( GET_KEY_SPECULATIVE_SHARDS,                2 ); if( randomize && BUGGIFY ) GET_KEY_SPECULATIVE_SHARDS = g_random->randomInt(0, 5);
+	init( COORDINATOR_HOSTNAME_REFRESH_INTERVAL,  60.0 ); if( randomize && BUGGIFY ) COORDINATOR_HOSTNAME_REFRESH_INTERVAL = 5.0;
 	init( FUTURE_VERSION_RETRY_DELAY,              .01 ); if( randomize && BUGGIFY ) FUTURE_VERSION_RETRY_DELAY = g_random->random01();// FLOW_KNOBS->PREVENT_FAST_SPIN_DELAY;
 	init( REPLY_BYTE_LIMIT,                      80000 );
 	init( DEFAULT_BACKOFF,                         .01 ); if( randomize && BUGGIFY ) DEFAULT_BACKOFF = g_random->random01();
@@ -61,12 +63,26 @@ ClientKnobs::ClientKnobs(bool randomize) {
 
 	init( MAX_BATCH_SIZE,                           20 ); if( randomize && BUGGIFY ) MAX_BATCH_SIZE = 1; // Note that SERVER_KNOBS->START_TRANSACTION_MAX_BUDGET_SIZE is set to match this value
 	init( GRV_BATCH_TIMEOUT,                     0.005 ); if( randomize && BUGGIFY ) GRV_BATCH_TIMEOUT = 0.1;
+	init( GRV_CACHE_MAX_STALENESS,               0.020 ); if( randomize && BUGGIFY ) GRV_CACHE_MAX_STALENESS = 0.5;
+	init( GRV_CACHE_IDLE_TIMEOUT,                  1.0 );
+	init( GRV_PROXY_AFFINITY,                        1 ); if( randomize && BUGGIFY ) GRV_PROXY_AFFINITY = 0;
+	init( GRV_PROXY_AFFINITY_ROTATION_INTERVAL,  120.0 ); if( randomize && BUGGIFY ) GRV_PROXY_AFFINITY_ROTATION_INTERVAL = 5.0;
+	init( GRV_PROXY_AFFINITY_TIMEOUT,              5.0 ); if( randomize && BUGGIFY ) GRV_PROXY_AFFINITY_TIMEOUT = 0.5;
 
 	init( LOCATION_CACHE_EVICTION_SIZE,         300000 );
 	init( LOCATION_CACHE_EVICTION_SIZE_SIM,         10 ); if( randomize && BUGGIFY ) LOCATION_CACHE_EVICTION_SIZE_SIM = 3;
 
 	init( GET_RANGE_SHARD_LIMIT,                     2 );
 	init( WARM_RANGE_SHARD_LIMIT,                  100 );
+	init( RANGE_READ_PARALLELISM,                    5 ); if( randomize && BUGGIFY ) RANGE_READ_PARALLELISM = 1;
+	init( RANGE_READ_PARALLEL_SHARD_LIMIT,         100 ); if( randomize && BUGGIFY ) RANGE_READ_PARALLEL_SHARD_LIMIT = 2;
+	init( RANGE_READ_PARALLEL_BYTE_LIMIT,          8e7 );
+	init( RANGE_PREFIX_COMPRESSION,                  0 ); if( randomize && BUGGIFY ) RANGE_PREFIX_COMPRESSION = 1;
+	init( RANGE_AGGREGATE_ROW_LIMIT,               1e4 ); if( randomize && BUGGIFY ) RANGE_AGGREGATE_ROW_LIMIT = 10;
+	init( RANGE_AGGREGATE_BYTE_LIMIT,              1e6 ); if( randomize && BUGGIFY ) RANGE_AGGREGATE_BYTE_LIMIT = 1000;
+	init( RANGE_CACHE_MAX_STALENESS,               2.0 ); if( randomize && BUGGIFY ) RANGE_CACHE_MAX_STALENESS = 0.001;
+	init( RANGE_CACHE_EVICTION_SIZE,               100 ); if( randomize && BUGGIFY ) RANGE_CACHE_EVICTION_SIZE = 2;
+	init( COALESCE_IDENTICAL_GETS,                   1 ); if( randomize && BUGGIFY ) COALESCE_IDENTICAL_GETS = 0;
 	init( STORAGE_METRICS_SHARD_LIMIT,             100 ); if( randomize && BUGGIFY ) STORAGE_METRICS_SHARD_LIMIT = 3;
 	init( STORAGE_METRICS_UNFAIR_SPLIT_LIMIT,  2.0/3.0 );
 	init( STORAGE_METRICS_TOO_MANY_SHARDS_DELAY,  15.0 );
@@ -87,6 +103,18 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	init( LOG_RANGE_BLOCK_SIZE,                    1e6 ); //Dependent on CORE_VERSIONSPERSECOND
 	init( MUTATION_BLOCK_SIZE,	            	  10000 );
 
+	// ManagedScan
+	init( MANAGED_SCAN_SHARD_PARALLELISM,            4 ); if( randomize && BUGGIFY ) MANAGED_SCAN_SHARD_PARALLELISM = 1;
+	init( MANAGED_SCAN_MAX_CHUNKS,                 100 ); if( randomize && BUGGIFY ) MANAGED_SCAN_MAX_CHUNKS = 2;
+	init( MANAGED_SCAN_ROW_LIMIT,                10000 ); if( randomize && BUGGIFY ) MANAGED_SCAN_ROW_LIMIT = 10;
+	init( MANAGED_SCAN_BYTE_LIMIT,                 1e6 ); if( randomize && BUGGIFY ) MANAGED_SCAN_BYTE_LIMIT = 1e3;
+	init( MANAGED_SCAN_TRANSACTION_DELAY,          0.1 ); if( randomize && BUGGIFY ) MANAGED_SCAN_TRANSACTION_DELAY = 1.0;
+
+	// ShardedCounter
+	init( SHARDED_COUNTER_MAX_SHARDS,               64 ); if( randomize && BUGGIFY ) SHARDED_COUNTER_MAX_SHARDS = 2;
+	init( SHARDED_COUNTER_ADDS_PER_SHARD,        100.0 ); if( randomize && BUGGIFY ) SHARDED_COUNTER_ADDS_PER_SHARD = 1.0;
+	init( SHARDED_COUNTER_ADAPT_INTERVAL,          5.0 ); if( randomize && BUGGIFY ) SHARDED_COUNTER_ADAPT_INTERVAL = 0.5;
+
 	// TaskBucket
 	init( TASKBUCKET_MAX_PRIORITY,                   1 );
 	init( TASKBUCKET_CHECK_TIMEOUT_CHANCE,        0.02 ); if( randomize && BUGGIFY ) TASKBUCKET_CHECK_TIMEOUT_CHANCE = 1.0;
@@ -101,6 +129,7 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	init( BACKUP_CONCURRENT_DELETES,               100 );
 	init( BACKUP_SIMULATED_LIMIT_BYTES,		       1e6 ); if( randomize && BUGGIFY ) BACKUP_SIMULATED_LIMIT_BYTES = 1000;
 	init( BACKUP_GET_RANGE_LIMIT_BYTES,		       1e6 );
+	init( BACKUP_USE_BATCH_PRIORITY,                 1 ); if( randomize && BUGGIFY ) BACKUP_USE_BATCH_PRIORITY = 0;
 	init( BACKUP_LOCK_BYTES,                       1e8 );
 	init( BACKUP_RANGE_TIMEOUT,   TASKBUCKET_TIMEOUT_VERSIONS/CORE_VERSIONSPERSECOND/2.0 );
 	init( BACKUP_RANGE_MINWAIT,   std::max(1.0, BACKUP_RANGE_TIMEOUT/2.0));
@@ -110,6 +139,7 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	init( BACKUP_AGGREGATE_POLL_RATE_UPDATE_INTERVAL, 60);
 	init( BACKUP_AGGREGATE_POLL_RATE,              2.0 ); // polls per second target for all agents on the cluster
 	init( BACKUP_LOG_WRITE_BATCH_MAX_SIZE,         1e6 ); //Must be much smaller than TRANSACTION_SIZE_LIMIT
+	init( BACKUP_LOG_APPLY_PARALLELISM,              4 ); if( randomize && BUGGIFY ) BACKUP_LOG_APPLY_PARALLELISM = 1;
 	init( BACKUP_LOG_ATOMIC_OPS_SIZE,			  1000 );
 	init( BACKUP_OPERATION_COST_OVERHEAD,		    50 );
 	init( BACKUP_MAX_LOG_RANGES,                    21 ); if( randomize && BUGGIFY ) BACKUP_MAX_LOG_RANGES = 4;
@@ -124,10 +154,12 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	init( SIM_BACKUP_TASKS_PER_AGENT,               10 );
 	init( BACKUP_RANGEFILE_BLOCK_SIZE,      1024 * 1024);
 	init( BACKUP_LOGFILE_BLOCK_SIZE,        1024 * 1024);
+	init( BACKUP_COMPRESS_BLOCKS,                    0 );
 	init( BACKUP_DISPATCH_ADDTASK_SIZE,             50 );
 	init( RESTORE_DISPATCH_ADDTASK_SIZE,           150 );
 	init( RESTORE_DISPATCH_BATCH_SIZE,           30000 ); if( randomize && BUGGIFY ) RESTORE_DISPATCH_BATCH_SIZE = 20;
 	init( RESTORE_WRITE_TX_SIZE,            256 * 1024 );
+	init( RESTORE_WRITE_PARALLELISM,                 4 ); if( randomize && BUGGIFY ) RESTORE_WRITE_PARALLELISM = 1;
 	init( APPLY_MAX_LOCK_BYTES,                    1e9 );
 	init( APPLY_MIN_LOCK_BYTES,                   11e6 ); //Must be bigger than TRANSACTION_SIZE_LIMIT
 	init( APPLY_BLOCK_SIZE,     LOG_RANGE_BLOCK_SIZE/5 );
@@ -151,6 +183,7 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	init( BLOBSTORE_CONNECT_TRIES,                  10 );
 	init( BLOBSTORE_CONNECT_TIMEOUT,                10 );
 	init( BLOBSTORE_MAX_CONNECTION_LIFE,           120 );
+	init( BLOBSTORE_MAX_CONNECTION_IDLE,            15 );
 	init( BLOBSTORE_REQUEST_TRIES,                  10 );
 	init( BLOBSTORE_REQUEST_TIMEOUT,                60 );
 
@@ -43,6 +43,8 @@ public:
 
 	// wrong_shard_server sometimes comes from the only nonfailed server, so we need to avoid a fast spin
 	double WRONG_SHARD_SERVER_DELAY; // SOMEDAY: This delay can limit performance of retrieving data when the cache is mostly wrong (e.g. dumping the database after a test)
+	int GET_KEY_SPECULATIVE_SHARDS; // Shards past the current one to speculatively query when resolving a key selector whose offset may cross shards; 0 disables speculation
+	double COORDINATOR_HOSTNAME_REFRESH_INTERVAL; // How often coordinator hostnames in the connection string are re-resolved to detect address changes
 	double FUTURE_VERSION_RETRY_DELAY;
 	int REPLY_BYTE_LIMIT;
 	double DEFAULT_BACKOFF;
@@ -59,6 +61,11 @@ public:
 
 	int MAX_BATCH_SIZE;
 	double GRV_BATCH_TIMEOUT;
+	double GRV_CACHE_MAX_STALENESS;
+	double GRV_CACHE_IDLE_TIMEOUT;
+	int GRV_PROXY_AFFINITY; // if nonzero, each client pins its read version requests to a single proxy, rotated periodically
+	double GRV_PROXY_AFFINITY_ROTATION_INTERVAL; // how long a client keeps one proxy as its read version target
+	double GRV_PROXY_AFFINITY_TIMEOUT; // a read version request unanswered for this long abandons the pinned proxy and repicks
 
 	// When locationCache in DatabaseContext gets to be this size, items will be evicted
 	int LOCATION_CACHE_EVICTION_SIZE;
@@ -66,6 +73,15 @@ public:
 
 	int GET_RANGE_SHARD_LIMIT;
 	int WARM_RANGE_SHARD_LIMIT;
+	int RANGE_READ_PARALLELISM;
+	int RANGE_READ_PARALLEL_SHARD_LIMIT;
+	int64_t RANGE_READ_PARALLEL_BYTE_LIMIT;
+	int RANGE_PREFIX_COMPRESSION; // if nonzero, range read replies ship prefix compressed keys
+	int RANGE_AGGREGATE_ROW_LIMIT; // rows per server-side batch of an aggregate-only range scan
+	int RANGE_AGGREGATE_BYTE_LIMIT; // bytes per server-side batch of an aggregate-only range scan
+	double RANGE_CACHE_MAX_STALENESS; // how long a cached result may be served to USE_RANGE_READ_CACHE transactions
+	int RANGE_CACHE_EVICTION_SIZE; // when the range read cache gets to be this size, the oldest entry is evicted
+	int COALESCE_IDENTICAL_GETS; // if nonzero, concurrent get()s of the same key at the same read version share one storage request
 	int STORAGE_METRICS_SHARD_LIMIT;
 	double STORAGE_METRICS_UNFAIR_SPLIT_LIMIT;
 	double STORAGE_METRICS_TOO_MANY_SHARDS_DELAY;
@@ -89,6 +105,18 @@ public:
 	int LOG_RANGE_BLOCK_SIZE;
 	int MUTATION_BLOCK_SIZE;
 
+	// ManagedScan
+	int MANAGED_SCAN_SHARD_PARALLELISM;
+	int MANAGED_SCAN_MAX_CHUNKS;
+	int MANAGED_SCAN_ROW_LIMIT;
+	int MANAGED_SCAN_BYTE_LIMIT;
+	double MANAGED_SCAN_TRANSACTION_DELAY;
+
+	// ShardedCounter
+	int SHARDED_COUNTER_MAX_SHARDS; // upper bound on the sub-keys a counter's adds fan out over
+	double SHARDED_COUNTER_ADDS_PER_SHARD; // add rate (per second, per client) one sub-key is expected to absorb
+	double SHARDED_COUNTER_ADAPT_INTERVAL; // how often a client retargets its fan-out from its observed add rate
+
 	// Taskbucket
 	int TASKBUCKET_MAX_PRIORITY;
 	double TASKBUCKET_CHECK_TIMEOUT_CHANCE;
@@ -103,6 +131,7 @@ public:
 	int BACKUP_CONCURRENT_DELETES;
 	int BACKUP_SIMULATED_LIMIT_BYTES;
 	int BACKUP_GET_RANGE_LIMIT_BYTES;
+	int BACKUP_USE_BATCH_PRIORITY;
 	int BACKUP_LOCK_BYTES;
 	double BACKUP_RANGE_TIMEOUT;
 	double BACKUP_RANGE_MINWAIT;
@@ -112,6 +141,7 @@ public:
 	double BACKUP_AGGREGATE_POLL_RATE;
 	double BACKUP_AGGREGATE_POLL_RATE_UPDATE_INTERVAL;
 	int BACKUP_LOG_WRITE_BATCH_MAX_SIZE;
+	int BACKUP_LOG_APPLY_PARALLELISM;
 	int BACKUP_LOG_ATOMIC_OPS_SIZE;
 	int BACKUP_MAX_LOG_RANGES;
 	int BACKUP_SIM_COPY_LOG_RANGES;
@@ -126,10 +156,12 @@ public:
 	int SIM_BACKUP_TASKS_PER_AGENT;
 	int BACKUP_RANGEFILE_BLOCK_SIZE;
 	int BACKUP_LOGFILE_BLOCK_SIZE;
+	int BACKUP_COMPRESS_BLOCKS; // Deflate compress backup file blocks.  Files written with this enabled cannot be read by older restore tools.
 	int BACKUP_DISPATCH_ADDTASK_SIZE;
 	int RESTORE_DISPATCH_ADDTASK_SIZE;
 	int RESTORE_DISPATCH_BATCH_SIZE;
 	int RESTORE_WRITE_TX_SIZE;
+	int RESTORE_WRITE_PARALLELISM;
 	int APPLY_MAX_LOCK_BYTES;
 	int APPLY_MIN_LOCK_BYTES;
 	int APPLY_BLOCK_SIZE;
@@ -155,6 +187,7 @@ public:
 	int BLOBSTORE_CONNECT_TRIES;
 	int BLOBSTORE_CONNECT_TIMEOUT;
 	int BLOBSTORE_MAX_CONNECTION_LIFE;
+	int BLOBSTORE_MAX_CONNECTION_IDLE;
 	int BLOBSTORE_REQUEST_TRIES;
 	int BLOBSTORE_REQUEST_TIMEOUT;
 	int BLOBSTORE_REQUESTS_PER_SECOND;
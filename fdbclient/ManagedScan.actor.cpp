@@ -0,0 +1,184 @@
+/*
+ * ManagedScan.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbclient/ManagedScan.h"
+#include "fdbclient/KeyBackedTypes.h"
+#include "fdbclient/RunTransaction.actor.h"
+#include "fdbclient/SystemData.h"
+#include "fdbclient/Knobs.h"
+#include "flow/actorcompiler.h"  // This must be the last #include.
+
+// Layout of the progress records under the caller's prefix
+struct ManagedScanProgress {
+	Subspace space;
+	explicit ManagedScanProgress(Key const& prefix) : space(prefix) {}
+
+	// The range the scan was started with, so a resumed call can be checked against it
+	KeyBackedProperty<KeyRange> range() { return space.pack(LiteralStringRef("range")); }
+
+	// Chunk id -> the part of that chunk not yet scanned.  Entries are erased as chunks finish, so
+	// the scan is complete when this map is empty.
+	KeyBackedMap<int64_t, KeyRange> chunks() { return space.pack(LiteralStringRef("chunks")); }
+
+	// Running row count, updated atomically so parallel chunk scanners don't conflict
+	Key rowsScannedKey() { return space.pack(LiteralStringRef("rows")); }
+};
+
+// Creates the progress records for a new scan, or loads them if the prefix already holds a
+// compatible in-progress scan.  Returns the ids of the chunks that still need scanning.
+ACTOR static Future<std::vector<int64_t>> initManagedScan( Database cx, KeyRange range, Key progressPrefix ) {
+	state ManagedScanProgress progress(progressPrefix);
+	state Reference<ReadYourWritesTransaction> tr( new ReadYourWritesTransaction(cx) );
+	loop {
+		try {
+			state Optional<KeyRange> stored = wait( progress.range().get( tr ) );
+			if( stored.present() ) {
+				if( stored.get() != range ) {
+					TraceEvent(SevError, "ManagedScanRangeMismatch")
+						.detail("Requested", printable(range))
+						.detail("Stored", printable(stored.get()))
+						.detail("ProgressPrefix", printable(progressPrefix));
+					throw client_invalid_operation();
+				}
+
+				TEST(true); // Managed scan resumed from stored progress
+				state std::vector<std::pair<int64_t, KeyRange>> storedChunks = wait( progress.chunks().getRange( tr, 0, Optional<int64_t>(), CLIENT_KNOBS->MANAGED_SCAN_MAX_CHUNKS + 1 ) );
+
+				std::vector<int64_t> resumed;
+				for(auto const& c : storedChunks)
+					resumed.push_back( c.first );
+				TraceEvent("ManagedScanResume")
+					.detail("Range", printable(range))
+					.detail("RemainingChunks", resumed.size());
+				return resumed;
+			}
+
+			// Split the range on shard boundaries so the chunk scanners spread over different
+			// storage teams.  The boundary read is capped at MANAGED_SCAN_MAX_CHUNKS, so a very
+			// large range simply gets a final chunk spanning the rest; it is still scanned in
+			// bounded batches, just without further parallelism.
+			tr->setOption( FDBTransactionOptions::ACCESS_SYSTEM_KEYS );
+			Standalone<RangeResultRef> shards = wait( tr->getRange( KeyRangeRef( keyServersKey(range.begin), keyServersKey(range.end) ), CLIENT_KNOBS->MANAGED_SCAN_MAX_CHUNKS, true ) );
+
+			std::vector<Key> boundaries;
+			boundaries.push_back( range.begin );
+			for(int i=0; i<shards.size(); i++) {
+				Key b = shards[i].key.removePrefix( keyServersPrefix );
+				if( b > boundaries.back() && b < range.end )
+					boundaries.push_back( b );
+			}
+			boundaries.push_back( range.end );
+
+			progress.range().set( tr, range );
+			state std::vector<int64_t> created;
+			for(int i=0; i<boundaries.size()-1; i++) {
+				progress.chunks().set( tr, i, KeyRangeRef( boundaries[i], boundaries[i+1] ) );
+				created.push_back( i );
+			}
+
+			wait( tr->commit() );
+			TraceEvent("ManagedScanStart")
+				.detail("Range", printable(range))
+				.detail("Chunks", created.size());
+			return created;
+		} catch( Error& e ) {
+			wait( tr->onError(e) );
+		}
+	}
+}
+
+// Scans one chunk to completion in a series of batch-priority snapshot transactions, advancing the
+// chunk's progress record in the same transaction that carries the processor's writes
+ACTOR static Future<Void> scanManagedChunk( Database cx, Key progressPrefix, int64_t chunk, ManagedScanProcessor processor, FlowLock* lock ) {
+	wait( lock->take() );
+	state FlowLock::Releaser releaser( *lock );
+	state ManagedScanProgress progress(progressPrefix);
+	state Reference<ReadYourWritesTransaction> tr( new ReadYourWritesTransaction(cx) );
+	loop {
+		try {
+			tr->setOption( FDBTransactionOptions::PRIORITY_BATCH );
+
+			state Optional<KeyRange> remaining = wait( progress.chunks().get( tr, chunk ) );
+			if( !remaining.present() ) {
+				TEST(true); // Managed scan chunk already finished
+				return Void();
+			}
+
+			state Standalone<RangeResultRef> rows = wait( tr->getRange( remaining.get(), GetRangeLimits( CLIENT_KNOBS->MANAGED_SCAN_ROW_LIMIT, CLIENT_KNOBS->MANAGED_SCAN_BYTE_LIMIT ), true ) );
+			wait( processor( tr, rows ) );
+
+			state bool more = rows.more && rows.size() > 0;
+			if( more ) {
+				progress.chunks().set( tr, chunk, KeyRangeRef( keyAfter(rows.back().key), remaining.get().end ) );
+			} else {
+				progress.chunks().erase( tr, chunk );
+			}
+			if( rows.size() ) {
+				int64_t count = rows.size();
+				tr->atomicOp( progress.rowsScannedKey(), StringRef( (const uint8_t*)&count, sizeof(count) ), MutationRef::AddValue );
+			}
+
+			wait( tr->commit() );
+			if( !more ) {
+				TEST(true); // Managed scan chunk completed
+				return Void();
+			}
+
+			tr->reset();
+			wait( delay( CLIENT_KNOBS->MANAGED_SCAN_TRANSACTION_DELAY ) );
+		} catch( Error& e ) {
+			wait( tr->onError(e) );
+		}
+	}
+}
+
+ACTOR static Future<Void> managedScanActor( Database cx, KeyRange range, Key progressPrefix, ManagedScanProcessor processor ) {
+	state std::vector<int64_t> chunks = wait( initManagedScan( cx, range, progressPrefix ) );
+
+	state FlowLock lock( CLIENT_KNOBS->MANAGED_SCAN_SHARD_PARALLELISM );
+	std::vector<Future<Void>> scanners;
+	for(int i=0; i<chunks.size(); i++)
+		scanners.push_back( scanManagedChunk( cx, progressPrefix, chunks[i], processor, &lock ) );
+	wait( waitForAll( scanners ) );
+
+	// Report the total and clear the progress records so the prefix can be reused
+	state ManagedScanProgress progress(progressPrefix);
+	state Reference<ReadYourWritesTransaction> tr( new ReadYourWritesTransaction(cx) );
+	loop {
+		try {
+			Optional<Value> rows = wait( tr->get( progress.rowsScannedKey() ) );
+			int64_t rowsScanned = 0;
+			if( rows.present() && rows.get().size() == sizeof(rowsScanned) )
+				memcpy( &rowsScanned, rows.get().begin(), sizeof(rowsScanned) );
+			tr->clear( progress.space.range() );
+			wait( tr->commit() );
+			TraceEvent("ManagedScanComplete")
+				.detail("Range", printable(range))
+				.detail("RowsScanned", rowsScanned);
+			return Void();
+		} catch( Error& e ) {
+			wait( tr->onError(e) );
+		}
+	}
+}
+
+Future<Void> managedScan( Database const& cx, KeyRange const& range, Key const& progressPrefix, ManagedScanProcessor const& processor ) {
+	return managedScanActor( cx, range, progressPrefix, processor );
+}
@@ -0,0 +1,43 @@
+/*
+ * ManagedScan.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBCLIENT_MANAGEDSCAN_H
+#define FDBCLIENT_MANAGEDSCAN_H
+#pragma once
+
+#include "fdbclient/NativeAPI.h"
+#include "fdbclient/ReadYourWrites.h"
+#include <functional>
+
+// Called once per batch of scanned rows, inside the scan's transaction and before it commits.
+// Writes made through tr (e.g. index entries derived from rows) commit atomically with the scan's
+// progress record, so after any failure or restart each row is processed exactly once.
+typedef std::function< Future<Void>(Reference<ReadYourWritesTransaction> tr, Standalone<RangeResultRef> rows) > ManagedScanProcessor;
+
+// Scans every row of range and passes it to processor, in many small batch-priority transactions
+// so the scan stays under the transaction duration limit and ratekeeper can throttle it behind
+// normal traffic.  The range is split on shard boundaries and up to
+// MANAGED_SCAN_SHARD_PARALLELISM pieces are scanned concurrently, each against a different shard.
+// Progress is checkpointed under progressPrefix: calling managedScan again with the same
+// arguments resumes an interrupted scan where it left off.  The progress records are cleared when
+// the scan completes, so a subsequent call starts a fresh scan.
+Future<Void> managedScan( Database const& cx, KeyRange const& range, Key const& progressPrefix, ManagedScanProcessor const& processor );
+
+#endif
@@ -133,18 +133,19 @@ struct GetReadVersionRequest {
 
 	uint32_t transactionCount;
 	uint32_t flags;
+	Version minVersion;  // if set, the reply version must be at least this large; lets the proxy reply from its committed version without a full GRV batch
 	Optional<UID> debugID;
 	ReplyPromise<GetReadVersionReply> reply;
 
-	GetReadVersionRequest() : transactionCount( 1 ), flags( PRIORITY_DEFAULT ) {}
-	GetReadVersionRequest( uint32_t transactionCount, uint32_t flags, Optional<UID> debugID = Optional<UID>() ) : transactionCount( transactionCount ), flags( flags ), debugID( debugID ) {}
-	
+	GetReadVersionRequest() : transactionCount( 1 ), flags( PRIORITY_DEFAULT ), minVersion( invalidVersion ) {}
+	GetReadVersionRequest( uint32_t transactionCount, uint32_t flags, Optional<UID> debugID = Optional<UID>(), Version minVersion = invalidVersion ) : transactionCount( transactionCount ), flags( flags ), debugID( debugID ), minVersion( minVersion ) {}
+
 	int priority() const { return flags & FLAG_PRIORITY_MASK; }
 	bool operator < (GetReadVersionRequest const& rhs) const { return priority() < rhs.priority(); }
 
-	template <class Ar> 
-	void serialize(Ar& ar) { 
-		ar & transactionCount & flags & debugID & reply;
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & transactionCount & flags & minVersion & debugID & reply;
 	}
 };
 
@@ -219,11 +220,12 @@ struct TxnStateRequest {
 	VectorRef<KeyValueRef> data;
 	Sequence sequence;
 	bool last;
+	std::vector<RequestStream<struct TxnStateRequest>> forward; // proxies this batch should be relayed to, in chain order; the reply means every proxy in the chain has the batch
 	ReplyPromise<Void> reply;
 
-	template <class Ar> 
-	void serialize(Ar& ar) { 
-		ar & data & sequence & last & reply & arena;
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & data & sequence & last & forward & reply & arena;
 	}
 };
 
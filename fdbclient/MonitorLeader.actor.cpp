@@ -20,6 +20,7 @@
 
 #include "fdbclient/MonitorLeader.h"
 #include "fdbclient/CoordinationInterface.h"
+#include "fdbclient/Knobs.h"
 #include "flow/ActorCollection.h"
 #include "flow/UnitTest.h"
 #include "fdbrpc/genericactors.actor.h"
@@ -160,6 +161,27 @@ std::string trim( std::string const& connectionString ) {
 	return trimmed;
 }
 
+static ClusterConnectionHostname parseHostname( std::string const& s ) {
+	bool isTLS = false;
+	std::string f = s;
+	if( f.size() > 4 && f.compare(f.size() - 4, 4, ":tls") == 0 ) {
+		isTLS = true;
+		f = f.substr(0, f.size() - 4);
+	}
+	auto colon = f.find_last_of(':');
+	if (colon == f.npos || colon == 0 || colon == f.size()-1)
+		throw connection_string_invalid();
+	std::string host = f.substr(0, colon);
+	std::string service = f.substr(colon+1);
+	for (auto c : host)
+		if (!isalnum(c) && c != '.' && c != '-' && c != '_')
+			throw connection_string_invalid();
+	for (auto c : service)
+		if (!isdigit(c))
+			throw connection_string_invalid();
+	return ClusterConnectionHostname(host, service, isTLS);
+}
+
 ClusterConnectionString::ClusterConnectionString( std::string const& connectionString ) {
 	auto trimmed = trim(connectionString);
 
@@ -172,19 +194,41 @@ ClusterConnectionString::ClusterConnectionString( std::string const& connectionS
 
 	parseKey(key);
 
-	coord = NetworkAddress::parseList(addrs);
-	ASSERT( coord.size() > 0 );  // parseList() always returns at least one address if it doesn't throw
+	// Split on ',' into addresses; an entry which does not parse as an address is taken as a
+	// hostname to be resolved when leader monitoring connects
+	for(int p = 0; p <= addrs.size(); ) {
+		int pComma = addrs.find_first_of(',', p);
+		if (pComma == addrs.npos) pComma = addrs.size();
+		std::string addr = addrs.substr(p, pComma-p);
+		try {
+			coord.push_back( NetworkAddress::parse(addr) );
+		} catch (Error& e) {
+			if (e.code() != error_code_connection_string_invalid)
+				throw;
+			hosts.push_back( parseHostname(addr) );
+		}
+		p = pComma + 1;
+	}
+	if (!coord.size() && !hosts.size())
+		throw connection_string_invalid();
 
-	bool isTLS = coord[0].isTLS();
+	bool isTLS = coord.size() ? coord[0].isTLS() : hosts[0].isTLS;
 	for( auto const& server : coord ) {
 		if( server.isTLS() != isTLS )
 			throw connection_string_invalid();
 	}
+	for( auto const& host : hosts ) {
+		if( host.isTLS != isTLS )
+			throw connection_string_invalid();
+	}
 
 	std::sort( coord.begin(), coord.end() );
-	// Check that there are no duplicate addresses
+	std::sort( hosts.begin(), hosts.end() );
+	// Check that there are no duplicate addresses or hostnames
 	if ( std::unique( coord.begin(), coord.end() ) != coord.end() )
 		throw connection_string_invalid();
+	if ( std::unique( hosts.begin(), hosts.end() ) != hosts.end() )
+		throw connection_string_invalid();
 }
 
 TEST_CASE("/fdbclient/MonitorLeader/parseConnectionString/basic") {
@@ -216,6 +260,39 @@ TEST_CASE("/fdbclient/MonitorLeader/parseConnectionString/basic") {
 	return Void();
 }
 
+TEST_CASE("/fdbclient/MonitorLeader/parseConnectionString/hostnames") {
+	std::string input;
+
+	{
+		input = "asdf:2345@1.1.1.1:345,one.example.com:1234,two.example.com:1234";
+		ClusterConnectionString cs(input);
+		ASSERT( cs.coordinators().size() == 1 );
+		ASSERT( cs.hostnames().size() == 2 );
+		ASSERT( input == cs.toString() );
+	}
+
+	{
+		input = "asdf:2345@one.example.com:1234:tls";
+		ClusterConnectionString cs(input);
+		ASSERT( cs.coordinators().size() == 0 );
+		ASSERT( cs.hostnames().size() == 1 );
+		ASSERT( cs.hostnames()[0].isTLS );
+		ASSERT( input == cs.toString() );
+	}
+
+	{
+		// Mixing TLS and non-TLS coordinators is not allowed
+		try {
+			ClusterConnectionString cs("asdf:2345@1.1.1.1:345,one.example.com:1234:tls");
+			ASSERT( false );
+		} catch (Error& e) {
+			ASSERT( e.code() == error_code_connection_string_invalid );
+		}
+	}
+
+	return Void();
+}
+
 TEST_CASE("/fdbclient/MonitorLeader/parseConnectionString/fuzz") {
 	// For a static connection string, add in fuzzed comments and whitespace
 	// SOMEDAY: create a series of random connection strings, rather than the one we started with
@@ -284,9 +361,43 @@ std::string ClusterConnectionString::toString() const {
 		if (i) s += ',';
 		s += coord[i].toString();
 	}
+	for(int i=0; i<hosts.size(); i++) {
+		if (i || coord.size()) s += ',';
+		s += hosts[i].toString();
+	}
 	return s;
 }
 
+ACTOR static Future<ClusterConnectionString> resolveHostnamesImpl( ClusterConnectionString cs ) {
+	state vector<NetworkAddress> addrs = cs.coordinators();
+	state vector<ClusterConnectionHostname> hosts = cs.hostnames();
+	state int i;
+	for(i = 0; i < hosts.size(); i++) {
+		try {
+			std::vector<NetworkAddress> resolved = wait( INetworkConnections::net()->resolveTCPEndpoint( hosts[i].host, hosts[i].service ) );
+			for(auto& a : resolved)
+				addrs.push_back( NetworkAddress( a.ip, a.port, true, hosts[i].isTLS ) );
+		} catch (Error& e) {
+			if (e.code() != error_code_lookup_failed)
+				throw;
+			// An unresolvable coordinator behaves like an unreachable one as long as something
+			// else resolves
+			TraceEvent(SevWarn, "CoordinatorHostnameLookupFailed").suppressFor(60).detail("Host", hosts[i].host);
+		}
+	}
+	if (!addrs.size())
+		throw lookup_failed();
+	std::sort( addrs.begin(), addrs.end() );
+	addrs.resize( std::unique( addrs.begin(), addrs.end() ) - addrs.begin() );
+	return ClusterConnectionString( addrs, cs.clusterKey() );
+}
+
+Future<ClusterConnectionString> resolveHostnames( ClusterConnectionString const& cs ) {
+	if (!cs.hostnames().size())
+		return cs;
+	return resolveHostnamesImpl(cs);
+}
+
 ClientCoordinators::ClientCoordinators( Reference<ClusterConnectionFile> ccf )
 	: ccf(ccf)
 {
@@ -375,6 +486,24 @@ Optional<std::pair<LeaderInfo, bool>> getLeader( const vector<Optional<LeaderInf
 	return std::pair<LeaderInfo, bool>(bestNominee, majority);
 }
 
+// Completes when re-resolving the connection string's hostnames yields a different address set
+// than the one currently being monitored
+ACTOR Future<Void> monitorCoordinatorHostnames( ClusterConnectionString cs, vector<NetworkAddress> current ) {
+	loop {
+		wait( delay( CLIENT_KNOBS->COORDINATOR_HOSTNAME_REFRESH_INTERVAL ) );
+		try {
+			ClusterConnectionString resolved = wait( resolveHostnames( cs ) );
+			if (resolved.coordinators() != current) {
+				TraceEvent("CoordinatorAddressesChanged").detail("ConnStr", cs.toString());
+				return Void();
+			}
+		} catch (Error& e) {
+			if (e.code() != error_code_lookup_failed)
+				throw;
+		}
+	}
+}
+
 struct MonitorLeaderInfo {
 	bool hasConnected;
 	Reference<ClusterConnectionFile> intermediateConnFile;
@@ -385,7 +514,28 @@ struct MonitorLeaderInfo {
 };
 
 ACTOR Future<MonitorLeaderInfo> monitorLeaderOneGeneration( Reference<ClusterConnectionFile> connFile, Reference<AsyncVar<Value>> outSerializedLeaderInfo, MonitorLeaderInfo info ) {
-	state ClientCoordinators coordinators( info.intermediateConnFile );
+	state Reference<ClusterConnectionFile> resolvedConnFile = info.intermediateConnFile;
+	state Future<Void> coordinatorsChanged = Never();
+
+	// Hostname coordinators are resolved once per generation; the resolved addresses are used only
+	// in memory, so the connection string in the cluster file keeps its hostnames
+	if (info.intermediateConnFile->getConnectionString().hostnames().size()) {
+		loop {
+			try {
+				ClusterConnectionString resolved = wait( resolveHostnames( info.intermediateConnFile->getConnectionString() ) );
+				resolvedConnFile = Reference<ClusterConnectionFile>( new ClusterConnectionFile( resolved ) );
+				coordinatorsChanged = monitorCoordinatorHostnames( info.intermediateConnFile->getConnectionString(), resolved.coordinators() );
+				break;
+			} catch (Error& e) {
+				if (e.code() != error_code_lookup_failed)
+					throw;
+				TraceEvent(SevWarn, "MonitorLeaderCoordinatorsUnresolved").detail("ConnStr", info.intermediateConnFile->getConnectionString().toString());
+				wait( delay( CLIENT_KNOBS->COORDINATOR_HOSTNAME_REFRESH_INTERVAL ) );
+			}
+		}
+	}
+
+	state ClientCoordinators coordinators( resolvedConnFile );
 	state AsyncTrigger nomineeChange;
 	state std::vector<Optional<LeaderInfo>> nominees;
 	state Future<Void> allActors;
@@ -421,7 +571,11 @@ ACTOR Future<MonitorLeaderInfo> monitorLeaderOneGeneration( Reference<ClusterCon
 
 			outSerializedLeaderInfo->set( leader.get().first.serializedInfo );
 		}
-		wait( nomineeChange.onTrigger() || allActors );
+		wait( nomineeChange.onTrigger() || allActors || coordinatorsChanged );
+		if (coordinatorsChanged.isReady()) {
+			// End the generation so the next one resolves and monitors the new addresses
+			return info;
+		}
 	}
 }
 
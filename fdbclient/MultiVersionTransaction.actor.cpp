@@ -145,6 +145,54 @@ ThreadFuture<Standalone<StringRef>> DLTransaction::getVersionstamp() {
 	});
 }
 
+ThreadFuture<int64_t> DLTransaction::getRangeRowCount(const KeyRangeRef& keys) {
+	if(!api->transactionGetRangeRowCount) {
+		return unsupported_operation();
+	}
+
+	FdbCApi::FDBFuture *f = api->transactionGetRangeRowCount(tr, keys.begin.begin(), keys.begin.size(), keys.end.begin(), keys.end.size());
+
+	return toThreadFuture<int64_t>(api, f, [](FdbCApi::FDBFuture *f, FdbCApi *api) {
+		int64_t count;
+		FdbCApi::fdb_error_t error = api->futureGetVersion(f, &count);
+		ASSERT(!error);
+
+		return count;
+	});
+}
+
+ThreadFuture<int64_t> DLTransaction::getRangeByteSum(const KeyRangeRef& keys) {
+	if(!api->transactionGetRangeByteSum) {
+		return unsupported_operation();
+	}
+
+	FdbCApi::FDBFuture *f = api->transactionGetRangeByteSum(tr, keys.begin.begin(), keys.begin.size(), keys.end.begin(), keys.end.size());
+
+	return toThreadFuture<int64_t>(api, f, [](FdbCApi::FDBFuture *f, FdbCApi *api) {
+		int64_t bytes;
+		FdbCApi::fdb_error_t error = api->futureGetVersion(f, &bytes);
+		ASSERT(!error);
+
+		return bytes;
+	});
+}
+
+ThreadFuture<int64_t> DLTransaction::getEstimatedRangeSizeBytes(const KeyRangeRef& keys) {
+	if(!api->transactionGetEstimatedRangeSizeBytes) {
+		return unsupported_operation();
+	}
+
+	FdbCApi::FDBFuture *f = api->transactionGetEstimatedRangeSizeBytes(tr, keys.begin.begin(), keys.begin.size(), keys.end.begin(), keys.end.size());
+
+	return toThreadFuture<int64_t>(api, f, [](FdbCApi::FDBFuture *f, FdbCApi *api) {
+		int64_t size;
+		FdbCApi::fdb_error_t error = api->futureGetVersion(f, &size);
+		ASSERT(!error);
+
+		return size;
+	});
+}
+
 void DLTransaction::addReadConflictRange(const KeyRangeRef& keys) {
 	throwIfError(api->transactionAddConflictRange(tr, keys.begin.begin(), keys.begin.size(), keys.end.begin(), keys.end.size(), FDBConflictRangeTypes::READ));
 }
@@ -195,6 +243,22 @@ Version DLTransaction::getCommittedVersion() {
 	return version;
 }
 
+ThreadFuture<int64_t> DLTransaction::getApproximateSize() {
+	if(!api->transactionGetApproximateSize) {
+		return unsupported_operation();
+	}
+
+	FdbCApi::FDBFuture *f = api->transactionGetApproximateSize(tr);
+
+	return toThreadFuture<int64_t>(api, f, [](FdbCApi::FDBFuture *f, FdbCApi *api) {
+		int64_t size;
+		FdbCApi::fdb_error_t error = api->futureGetVersion(f, &size);
+		ASSERT(!error);
+
+		return size;
+	});
+}
+
 void DLTransaction::setOption(FDBTransactionOptions::Option option, Optional<StringRef> value) {
 	throwIfError(api->transactionSetOption(tr, option, value.present() ? value.get().begin() : NULL, value.present() ? value.get().size() : 0));
 }
@@ -276,6 +340,10 @@ void DLApi::init() {
 	loadClientFunction(&api->transactionAtomicOp, lib, fdbCPath, "fdb_transaction_atomic_op");
 	loadClientFunction(&api->transactionCommit, lib, fdbCPath, "fdb_transaction_commit");
 	loadClientFunction(&api->transactionGetCommittedVersion, lib, fdbCPath, "fdb_transaction_get_committed_version");
+	loadClientFunction(&api->transactionGetApproximateSize, lib, fdbCPath, "fdb_transaction_get_approximate_size", false); // older external clients don't expose this
+	loadClientFunction(&api->transactionGetRangeRowCount, lib, fdbCPath, "fdb_transaction_get_range_row_count", false); // older external clients don't expose this
+	loadClientFunction(&api->transactionGetRangeByteSum, lib, fdbCPath, "fdb_transaction_get_range_byte_sum", false); // older external clients don't expose this
+	loadClientFunction(&api->transactionGetEstimatedRangeSizeBytes, lib, fdbCPath, "fdb_transaction_get_estimated_range_size_bytes", false); // older external clients don't expose this
 	loadClientFunction(&api->transactionWatch, lib, fdbCPath, "fdb_transaction_watch");
 	loadClientFunction(&api->transactionOnError, lib, fdbCPath, "fdb_transaction_on_error");
 	loadClientFunction(&api->transactionReset, lib, fdbCPath, "fdb_transaction_reset");
@@ -475,6 +543,24 @@ ThreadFuture<Standalone<VectorRef<const char*>>> MultiVersionTransaction::getAdd
 	return abortableFuture(f, tr.onChange);
 }
 
+ThreadFuture<int64_t> MultiVersionTransaction::getRangeRowCount(const KeyRangeRef& keys) {
+	auto tr = getTransaction();
+	auto f = tr.transaction ? tr.transaction->getRangeRowCount(keys) : ThreadFuture<int64_t>(Never());
+	return abortableFuture(f, tr.onChange);
+}
+
+ThreadFuture<int64_t> MultiVersionTransaction::getRangeByteSum(const KeyRangeRef& keys) {
+	auto tr = getTransaction();
+	auto f = tr.transaction ? tr.transaction->getRangeByteSum(keys) : ThreadFuture<int64_t>(Never());
+	return abortableFuture(f, tr.onChange);
+}
+
+ThreadFuture<int64_t> MultiVersionTransaction::getEstimatedRangeSizeBytes(const KeyRangeRef& keys) {
+	auto tr = getTransaction();
+	auto f = tr.transaction ? tr.transaction->getEstimatedRangeSizeBytes(keys) : ThreadFuture<int64_t>(Never());
+	return abortableFuture(f, tr.onChange);
+}
+
 void MultiVersionTransaction::addReadConflictRange(const KeyRangeRef& keys) {
 	auto tr = getTransaction();
 	if(tr.transaction) {
@@ -545,6 +631,12 @@ Version MultiVersionTransaction::getCommittedVersion() {
 	return invalidVersion;
 }
 
+ThreadFuture<int64_t> MultiVersionTransaction::getApproximateSize() {
+	auto tr = getTransaction();
+	auto f = tr.transaction ? tr.transaction->getApproximateSize() : ThreadFuture<int64_t>(Never());
+	return abortableFuture(f, tr.onChange);
+}
+
 void MultiVersionTransaction::setOption(FDBTransactionOptions::Option option, Optional<StringRef> value) {
 	auto tr = getTransaction();
 	if(tr.transaction) {
@@ -907,6 +999,15 @@ void MultiVersionApi::disableLocalClient() {
 	localClientDisabled = true;
 }
 
+void MultiVersionApi::shareDatabasePerClusterFile() {
+	MutexHolder holder(lock);
+	if(networkStartSetup) {
+		throw invalid_option();
+	}
+
+	shareDatabases = true;
+}
+
 void MultiVersionApi::setSupportedClientVersions(Standalone<StringRef> versions) {
 	MutexHolder holder(lock);
 	ASSERT(networkSetup);
@@ -961,6 +1062,10 @@ void MultiVersionApi::setNetworkOptionInternal(FDBNetworkOptions::Option option,
 		validateOption(value, false, true);
 		disableLocalClient();
 	}
+	else if(option == FDBNetworkOptions::SHARE_DATABASE_PER_CLUSTER_FILE) {
+		validateOption(value, false, true);
+		shareDatabasePerClusterFile();
+	}
 	else if(option == FDBNetworkOptions::SUPPORTED_CLIENT_VERSIONS) {
 		ASSERT(value.present());
 		setSupportedClientVersions(value.get());
@@ -1122,11 +1227,55 @@ ThreadFuture<Reference<IDatabase>> MultiVersionApi::createDatabase(const char *c
 	lock.leave();
 
 	std::string clusterFile(clusterFilePath);
+
+	if(!shareDatabases) {
+		return createDatabaseInternal(clusterFile);
+	}
+
+	// All databases created for the same cluster file share one underlying database and its
+	// connections, so many client instances in one process do not multiply connection counts and
+	// proxy-side endpoint state
+	{
+		MutexHolder holder(lock);
+		auto itr = sharedDatabases.find(clusterFile);
+		if(itr != sharedDatabases.end()) {
+			// A shared database that failed to be created is not kept, so the next attempt can
+			// try again
+			if(itr->second.isReady() && itr->second.isError()) {
+				sharedDatabases.erase(itr);
+			}
+			else {
+				return itr->second;
+			}
+		}
+	}
+
+	ThreadFuture<Reference<IDatabase>> dbFuture = mapThreadFuture<Reference<IDatabase>, Reference<IDatabase>>(createDatabaseInternal(clusterFile), [this, clusterFile](ErrorOr<Reference<IDatabase>> database) {
+		if(database.isError()) {
+			MutexHolder holder(lock);
+			sharedDatabases.erase(clusterFile);
+		}
+		return database;
+	});
+
+	MutexHolder holder(lock);
+	if(!(dbFuture.isReady() && dbFuture.isError())) {
+		auto itr = sharedDatabases.find(clusterFile);
+		if(itr != sharedDatabases.end()) {
+			// Another thread created the database concurrently, so use that one
+			return itr->second;
+		}
+		sharedDatabases[clusterFile] = dbFuture;
+	}
+	return dbFuture;
+}
+
+ThreadFuture<Reference<IDatabase>> MultiVersionApi::createDatabaseInternal(std::string const& clusterFile) {
 	if(localClientDisabled) {
 		return Reference<IDatabase>(new MultiVersionDatabase(this, clusterFile, Reference<IDatabase>()));
 	}
 
-	auto databaseFuture = localClient->api->createDatabase(clusterFilePath);
+	auto databaseFuture = localClient->api->createDatabase(clusterFile.c_str());
 	if(bypassMultiClientApi) {
 		return databaseFuture;
 	}
@@ -1244,7 +1393,7 @@ void MultiVersionApi::loadEnvironmentVariableNetworkOptions() {
 	envOptionsLoaded = true;
 }
 
-MultiVersionApi::MultiVersionApi() : bypassMultiClientApi(false), networkStartSetup(false), networkSetup(false), callbackOnMainThread(true), externalClient(false), localClientDisabled(false), apiVersion(0), envOptionsLoaded(false) {}
+MultiVersionApi::MultiVersionApi() : bypassMultiClientApi(false), networkStartSetup(false), networkSetup(false), callbackOnMainThread(true), externalClient(false), localClientDisabled(false), shareDatabases(false), apiVersion(0), envOptionsLoaded(false) {}
 
 MultiVersionApi* MultiVersionApi::api = new MultiVersionApi();
 
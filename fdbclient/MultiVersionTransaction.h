@@ -81,6 +81,10 @@ struct FdbCApi : public ThreadSafeReferenceCounted<FdbCApi> {
 										uint8_t const *endKeyName, int endKeyNameLength, fdb_bool_t endOrEqual, int endOffset, int limit, int targetBytes,
 										FDBStreamingModes::Option mode, int iteration, fdb_bool_t snapshot, fdb_bool_t reverse);
 	FDBFuture* (*transactionGetVersionstamp)(FDBTransaction* tr);
+	FDBFuture* (*transactionGetApproximateSize)(FDBTransaction *tr);
+	FDBFuture* (*transactionGetRangeRowCount)(FDBTransaction *tr, uint8_t const *beginKeyName, int beginKeyNameLength, uint8_t const *endKeyName, int endKeyNameLength);
+	FDBFuture* (*transactionGetRangeByteSum)(FDBTransaction *tr, uint8_t const *beginKeyName, int beginKeyNameLength, uint8_t const *endKeyName, int endKeyNameLength);
+	FDBFuture* (*transactionGetEstimatedRangeSizeBytes)(FDBTransaction *tr, uint8_t const *beginKeyName, int beginKeyNameLength, uint8_t const *endKeyName, int endKeyNameLength);
 
 	void (*transactionSet)(FDBTransaction *tr, uint8_t const *keyName, int keyNameLength, uint8_t const *value, int valueLength);
 	void (*transactionClear)(FDBTransaction *tr, uint8_t const *keyName, int keyNameLength);
@@ -128,7 +132,10 @@ public:
 	ThreadFuture<Standalone<RangeResultRef>> getRange( const KeyRangeRef& keys, GetRangeLimits limits, bool snapshot=false, bool reverse=false);
 	ThreadFuture<Standalone<VectorRef<const char*>>> getAddressesForKey(const KeyRef& key);
 	ThreadFuture<Standalone<StringRef>> getVersionstamp();
- 
+	ThreadFuture<int64_t> getRangeRowCount(const KeyRangeRef& keys);
+	ThreadFuture<int64_t> getRangeByteSum(const KeyRangeRef& keys);
+	ThreadFuture<int64_t> getEstimatedRangeSizeBytes(const KeyRangeRef& keys);
+
 	void addReadConflictRange(const KeyRangeRef& keys);
 
 	void atomicOp(const KeyRef& key, const ValueRef& value, uint32_t operationType);
@@ -143,6 +150,7 @@ public:
 
 	ThreadFuture<Void> commit();
 	Version getCommittedVersion();
+	ThreadFuture<int64_t> getApproximateSize();
 
 	void setOption(FDBTransactionOptions::Option option, Optional<StringRef> value=Optional<StringRef>());
 
@@ -219,7 +227,10 @@ public:
 	ThreadFuture<Standalone<RangeResultRef>> getRange( const KeyRangeRef& keys, GetRangeLimits limits, bool snapshot=false, bool reverse=false);
 	ThreadFuture<Standalone<VectorRef<const char*>>> getAddressesForKey(const KeyRef& key);
 	ThreadFuture<Standalone<StringRef>> getVersionstamp();
- 
+	ThreadFuture<int64_t> getRangeRowCount(const KeyRangeRef& keys);
+	ThreadFuture<int64_t> getRangeByteSum(const KeyRangeRef& keys);
+	ThreadFuture<int64_t> getEstimatedRangeSizeBytes(const KeyRangeRef& keys);
+
 	void addReadConflictRange(const KeyRangeRef& keys);
 
 	void atomicOp(const KeyRef& key, const ValueRef& value, uint32_t operationType);
@@ -234,6 +245,7 @@ public:
 
 	ThreadFuture<Void> commit();
 	Version getCommittedVersion();
+	ThreadFuture<int64_t> getApproximateSize();
 
 	void setOption(FDBTransactionOptions::Option option, Optional<StringRef> value=Optional<StringRef>());
 
@@ -376,8 +388,11 @@ private:
 	void addExternalLibrary(std::string path);
 	void addExternalLibraryDirectory(std::string path);
 	void disableLocalClient();
+	void shareDatabasePerClusterFile();
 	void setSupportedClientVersions(Standalone<StringRef> versions);
 
+	ThreadFuture<Reference<IDatabase>> createDatabaseInternal(std::string const& clusterFile);
+
 	void setNetworkOptionInternal(FDBNetworkOptions::Option option, Optional<StringRef> value);
 
 	Reference<ClientInfo> localClient;
@@ -387,8 +402,13 @@ private:
 	volatile bool networkSetup;
 	volatile bool bypassMultiClientApi;
 	volatile bool externalClient;
+	volatile bool shareDatabases;
 	int apiVersion;
 
+	// Databases shared between createDatabase calls for the same cluster file, used when the
+	// SHARE_DATABASE_PER_CLUSTER_FILE network option is set.  Protected by lock.
+	std::map<std::string, ThreadFuture<Reference<IDatabase>>> sharedDatabases;
+
 	Mutex lock;
 	std::vector<std::pair<FDBNetworkOptions::Option, Optional<Standalone<StringRef>>>> options;
 	std::map<FDBNetworkOptions::Option, std::set<Standalone<StringRef>>> setEnvOptions;
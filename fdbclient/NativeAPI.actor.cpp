@@ -191,7 +191,7 @@ void validateVersion(Version version) {
 		throw client_invalid_operation();
 	}
 
-	ASSERT(version > 0 || version == latestVersion);
+	ASSERT(version > 0 || version == latestVersion || version == replicaDurableVersion);
 }
 
 void validateOptionValue(Optional<StringRef> value, bool shouldBePresent) {
@@ -227,6 +227,7 @@ ACTOR Future<Void> databaseLogger( DatabaseContext *cx ) {
 			.detail("CommittedMutationBytes", cx->transactionCommittedMutationBytes)
 			.detail("CommitStarted", cx->transactionsCommitStarted)
 			.detail("CommitCompleted", cx->transactionsCommitCompleted)
+			.detail("CommitElided", cx->transactionsCommitElided)
 			.detail("TooOld", cx->transactionsTooOld)
 			.detail("FutureVersions", cx->transactionsFutureVersions)
 			.detail("NotCommitted", cx->transactionsNotCommitted)
@@ -480,8 +481,9 @@ DatabaseContext::DatabaseContext(
 	: cluster(cluster), clientInfo(clientInfo), clientInfoMonitor(clientInfoMonitor), dbId(dbId), taskID(taskID), clientLocality(clientLocality), enableLocalityLoadBalance(enableLocalityLoadBalance),
 	lockAware(lockAware), apiVersion(apiVersion),
 	transactionReadVersions(0), transactionLogicalReads(0), transactionPhysicalReads(0), transactionCommittedMutations(0), transactionCommittedMutationBytes(0), 
-	transactionsCommitStarted(0), transactionsCommitCompleted(0), transactionsTooOld(0), transactionsFutureVersions(0), transactionsNotCommitted(0), 
+	transactionsCommitStarted(0), transactionsCommitCompleted(0), transactionsCommitElided(0), transactionsTooOld(0), transactionsFutureVersions(0), transactionsNotCommitted(0),
 	transactionsMaybeCommitted(0), transactionsResourceConstrained(0), outstandingWatches(0),
+	cachedReadVersion(0), lastGrvTime(0.0), lastGrvCacheUse(0.0), grvAffinityChosenTime(0.0),
 	latencies(1000), readLatencies(1000), commitLatencies(1000), GRVLatencies(1000), mutationsPerCommit(1000), bytesPerCommit(1000)
 {
 	maxOutstandingWatches = CLIENT_KNOBS->DEFAULT_MAX_OUTSTANDING_WATCHES;
@@ -631,12 +633,52 @@ void DatabaseContext::invalidateCache( const KeyRef& key, bool isBackward ) {
 		locationCache.rangeContainingKeyBefore(key)->value() = Reference<LocationInfo>();
 	else
 		locationCache.rangeContaining(key)->value() = Reference<LocationInfo>();
+
+	for(auto r = rangeReadCache.begin(); r != rangeReadCache.end();) {
+		if( isBackward ? (r->second.keys.begin < key && key <= r->second.keys.end) : r->second.keys.contains(key) )
+			r = rangeReadCache.erase(r);
+		else
+			++r;
+	}
 }
 
 void DatabaseContext::invalidateCache( const KeyRangeRef& keys ) {
 	auto rs = locationCache.intersectingRanges(keys);
 	Key begin = rs.begin().begin(), end = rs.end().begin();  // insert invalidates rs, so can't be passed a mere reference into it
 	locationCache.insert( KeyRangeRef(begin, end), Reference<LocationInfo>() );
+
+	for(auto r = rangeReadCache.begin(); r != rangeReadCache.end();) {
+		if( r->second.keys.intersects( keys ) )
+			r = rangeReadCache.erase(r);
+		else
+			++r;
+	}
+}
+
+Optional<Standalone<RangeResultRef>> DatabaseContext::getCachedRangeRead( const RangeReadCacheKey& key ) {
+	auto r = rangeReadCache.find( key );
+	if( r == rangeReadCache.end() )
+		return Optional<Standalone<RangeResultRef>>();
+	if( now() - r->second.readTime > CLIENT_KNOBS->RANGE_CACHE_MAX_STALENESS ) {
+		rangeReadCache.erase( r );
+		return Optional<Standalone<RangeResultRef>>();
+	}
+	return r->second.result;
+}
+
+void DatabaseContext::setCachedRangeRead( const RangeReadCacheKey& key, const KeyRangeRef& keys, Standalone<RangeResultRef> const& result ) {
+	if( rangeReadCache.size() >= CLIENT_KNOBS->RANGE_CACHE_EVICTION_SIZE && !rangeReadCache.count( key ) ) {
+		TEST( true ); // NativeAPI range read cache entry evicted
+		auto oldest = rangeReadCache.begin();
+		for(auto r = rangeReadCache.begin(); r != rangeReadCache.end(); ++r)
+			if( r->second.readTime < oldest->second.readTime )
+				oldest = r;
+		rangeReadCache.erase( oldest );
+	}
+	RangeReadCacheEntry& entry = rangeReadCache[key];
+	entry.result = result;
+	entry.keys = KeyRange(keys);
+	entry.readTime = now();
 }
 
 Future<Void> DatabaseContext::onMasterProxiesChanged() {
@@ -674,6 +716,7 @@ void DatabaseContext::setOption( FDBDatabaseOptions::Option option, Optional<Str
 			clientLocality = LocalityData( clientLocality.processId(), value.present() ? Standalone<StringRef>(value.get()) : Optional<Standalone<StringRef>>(), clientLocality.machineId(), clientLocality.dcId() );
 			if( clientInfo->get().proxies.size() )
 				masterProxies = Reference<ProxyInfo>( new ProxyInfo( clientInfo->get().proxies, clientLocality ) );
+			invalidateGrvProxyAffinity();
 			server_interf.clear();
 			locationCache.insert( allKeys, Reference<LocationInfo>() );
 			break;
@@ -684,6 +727,7 @@ void DatabaseContext::setOption( FDBDatabaseOptions::Option option, Optional<Str
 			clientLocality = LocalityData(clientLocality.processId(), clientLocality.zoneId(), clientLocality.machineId(), value.present() ? Standalone<StringRef>(value.get()) : Optional<Standalone<StringRef>>());
 			if( clientInfo->get().proxies.size() )
 				masterProxies = Reference<ProxyInfo>( new ProxyInfo( clientInfo->get().proxies, clientLocality ));
+			invalidateGrvProxyAffinity();
 			server_interf.clear();
 			locationCache.insert( allKeys, Reference<LocationInfo>() );
 			break;
@@ -964,6 +1008,25 @@ Reference<ProxyInfo> DatabaseContext::getMasterProxies() {
 	return masterProxies;
 }
 
+// Returns a ProxyInfo holding a single proxy chosen at random from the full proxy list.  Pinning a
+// client's read version requests to one proxy lets that proxy fold them into its GRV batching
+// windows, so the fan-out of liveness confirmations across the cluster scales with the number of
+// clients rather than clients * proxies.  The choice is rotated every
+// GRV_PROXY_AFFINITY_ROTATION_INTERVAL so a long-lived client population stays spread evenly over
+// the proxies as they come and go.
+Reference<ProxyInfo> DatabaseContext::getGrvProxyAffinity() {
+	Reference<ProxyInfo> proxies = getMasterProxies();
+	if( !proxies )
+		return proxies;
+	if( !grvAffinityProxy || grvAffinityLastChange != masterProxiesLastChange || now() - grvAffinityChosenTime > CLIENT_KNOBS->GRV_PROXY_AFFINITY_ROTATION_INTERVAL ) {
+		grvAffinityLastChange = masterProxiesLastChange;
+		grvAffinityChosenTime = now();
+		auto const& fullList = clientInfo->get().proxies;
+		grvAffinityProxy = Reference<ProxyInfo>( new ProxyInfo( vector<MasterProxyInterface>( 1, fullList[ g_random->randomInt( 0, fullList.size() ) ] ), clientLocality ) );
+	}
+	return grvAffinityProxy;
+}
+
 //Actor which will wait until the MultiInterface<MasterProxyInterface> returned by the DatabaseContext cx is not NULL
 ACTOR Future<Reference<ProxyInfo>> getMasterProxiesFuture(DatabaseContext *cx) {
 	loop{
@@ -1184,6 +1247,68 @@ Future< vector< pair<KeyRange,Reference<LocationInfo>> > > getKeyRangeLocations(
 	return locations;
 }
 
+// Resolves a sorted batch of keys, returning one (range, location) pair per key.  Keys that fall in
+// the shard of their predecessor reuse its result without probing the cache again, and all cache
+// misses in a pass are fetched with a single location request spanning them rather than one request
+// per key.
+ACTOR Future< vector< pair<KeyRange,Reference<LocationInfo>> > > getKeyLocations_internal( Database cx, vector<Key> keys, TransactionInfo info ) {
+	ASSERT( keys.size() );
+	for(int i = 1; i < keys.size(); i++)
+		ASSERT( keys[i-1] <= keys[i] );
+	ASSERT( keys.back() < allKeys.end );
+
+	state vector< pair<KeyRange,Reference<LocationInfo>> > results( keys.size() );
+	loop {
+		vector<int> missing;
+		pair<KeyRange,Reference<LocationInfo>> last;
+		for(int i = 0; i < keys.size(); i++) {
+			if( results[i].second ) continue;
+			if( !(last.second && last.first.contains(keys[i])) )
+				last = cx->getCachedLocation( keys[i] );
+			if( last.second )
+				results[i] = last;
+			else
+				missing.push_back(i);
+		}
+		if( !missing.size() )
+			return results;
+
+		// One request covers the span from the first to the last missing key; shards between them are
+		// cached as a bonus.  If the reply is cut off by the shard limit, the next iteration's span
+		// starts at the first key that is still missing, so progress is guaranteed.
+		state Key spanEnd = keyAfter( keys[missing.back()] );
+		vector< pair<KeyRange,Reference<LocationInfo>> > _ = wait( getKeyRangeLocations_internal( cx, KeyRangeRef( keys[missing.front()], spanEnd ), 100, false, info ) );
+	}
+}
+
+template <class F>
+Future< vector< pair<KeyRange,Reference<LocationInfo>> > > getKeyLocations( Database const& cx, vector<Key> const& keys, F StorageServerInterface::*member, TransactionInfo const& info ) {
+	ASSERT( keys.size() );
+
+	vector< pair<KeyRange,Reference<LocationInfo>> > results;
+	results.reserve( keys.size() );
+	pair<KeyRange,Reference<LocationInfo>> last;
+	for(auto& key : keys) {
+		if( !(last.second && last.first.contains(key)) )
+			last = cx->getCachedLocation( key );
+		if( !last.second )
+			return getKeyLocations_internal( cx, keys, info );
+		results.push_back( last );
+	}
+
+	for(int r = 0; r < results.size(); r++) {
+		if( r && results[r].second == results[r-1].second ) continue;
+		for(int i = 0; i < results[r].second->size(); i++) {
+			if( IFailureMonitor::failureMonitor().onlyEndpointFailed(results[r].second->get(i, member).getEndpoint()) ) {
+				cx->invalidateCache( results[r].first.begin );
+				return getKeyLocations_internal( cx, keys, info );
+			}
+		}
+	}
+
+	return results;
+}
+
 ACTOR Future<Void> warmRange_impl( Transaction *self, Database cx, KeyRange keys ) {
 	state int totalRanges = 0;
 	state int totalRequests = 0;
@@ -1247,7 +1372,8 @@ ACTOR Future<Optional<Value>> getValue( Future<Version> version, Key key, Databa
 			startTime = timer_int();
 			startTimeD = now();
 			++cx->transactionPhysicalReads;
-			state GetValueReply reply = wait( loadBalance( ssi.second, &StorageServerInterface::getValue, GetValueRequest(key, ver, getValueID), TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL ) );
+			state GetValueReply reply = wait( loadBalance( ssi.second, &StorageServerInterface::getValue, GetValueRequest(key, ver, getValueID), TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL,
+				FLOW_KNOBS->LOAD_BALANCE_SHARD_AFFINITY ? loadBalanceAffinityHash(key) : 0, ver ) );
 			double latency = now() - startTimeD;
 			cx->readLatencies.addSample(latency);
 			if (trLogInfo) {
@@ -1276,7 +1402,7 @@ ACTOR Future<Optional<Value>> getValue( Future<Version> version, Key key, Databa
 					.detail("ReplySize", reply.value.present() ? reply.value.get().size() : -1);*/
 			}
 			if (e.code() == error_code_wrong_shard_server || e.code() == error_code_all_alternatives_failed ||
-				(e.code() == error_code_transaction_too_old && ver == latestVersion) ) {
+				(e.code() == error_code_transaction_too_old && (ver == latestVersion || ver == replicaDurableVersion)) ) {
 				cx->invalidateCache( key );
 				wait(delay(CLIENT_KNOBS->WRONG_SHARD_SERVER_DELAY, info.taskID));
 			} else {
@@ -1288,12 +1414,75 @@ ACTOR Future<Optional<Value>> getValue( Future<Version> version, Key key, Databa
 	}
 }
 
+// Attaches to the outstanding getValue request for this key at the same read version if there is
+// one, so any number of concurrent reads of a hot key hold a single request to the storage
+// servers.  Sharing is only safe at an identical version, which in practice means transactions
+// using the cached read version; each distinct version still issues its own request.
+ACTOR Future<Optional<Value>> sharedGetValue( Future<Version> version, Key key, Database cx, TransactionInfo info, Reference<TransactionLogInfo> trLogInfo )
+{
+	state Version ver = wait( version );
+
+	if( ver == latestVersion || ver == replicaDurableVersion ) {
+		// Reads at a sentinel version have no single version to agree on, so each gets its own request
+		Optional<Value> value = wait( getValue( ver, key, cx, info, trLogInfo ) );
+		return value;
+	}
+
+	state std::pair<Version, Key> mapKey = std::make_pair(ver, key);
+	state Reference<ReadInfo> read;
+
+	auto it = cx->getValueMap.find(mapKey);
+	if( it != cx->getValueMap.end() ) {
+		TEST(true); // get() coalesced with an identical outstanding read
+		read = it->second;
+	} else {
+		read = Reference<ReadInfo>( new ReadInfo() );
+		read->value = getValue( ver, key, cx, info, trLogInfo );
+		cx->getValueMap[mapKey] = read;
+	}
+	++read->readers;
+
+	try {
+		state Optional<Value> result = wait( read->value );
+	} catch( Error &e ) {
+		if( --read->readers == 0 ) {
+			auto done = cx->getValueMap.find(mapKey);
+			if( done != cx->getValueMap.end() && done->second == read )
+				cx->getValueMap.erase(done);
+		}
+		throw;
+	}
+
+	if( --read->readers == 0 ) {
+		auto done = cx->getValueMap.find(mapKey);
+		if( done != cx->getValueMap.end() && done->second == read )
+			cx->getValueMap.erase(done);
+	}
+
+	return result;
+}
+
+// A getKey request issued to a shard past the one currently being queried, predicting the
+// remainder selector the current resolution will be left with when it reaches that shard
+struct SpeculativeGetKey {
+	KeySelector sel;    // the remainder selector this request was issued for
+	KeyRange shard;     // the location range it was sent to
+	Future<GetKeyReply> reply;
+};
+
 ACTOR Future<Key> getKey( Database cx, KeySelector k, Future<Version> version, TransactionInfo info ) {
 	Version ver = wait(version);
 
 	if( info.debugID.present() )
 		g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getKey.AfterVersion");
 
+	// A selector whose offset crosses a shard comes back as a remainder selector anchored at the
+	// shard boundary, normally costing one serial round trip per shard.  When a shard consumes
+	// none of the offset the remainder is exactly predictable - the boundary anchored with the
+	// offset unchanged - so requests for the next few shards are issued on that prediction in
+	// parallel with the current one.  A speculative reply is only used when the actual remainder
+	// matches the selector it was issued for, so a misprediction merely wastes the request.
+	state std::vector<SpeculativeGetKey> speculative;
 	loop {
 		if (k.getKey() == allKeys.end) {
 			if (k.offset > 0) return allKeys.end;
@@ -1309,8 +1498,33 @@ ACTOR Future<Key> getKey( Database cx, KeySelector k, Future<Version> version, T
 		try {
 			if( info.debugID.present() )
 				g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getKey.Before"); //.detail("StartKey", printable(k.getKey())).detail("Offset",k.offset).detail("OrEqual",k.orEqual);
-			++cx->transactionPhysicalReads;
-			GetKeyReply reply = wait( loadBalance( ssi.second, &StorageServerInterface::getKey, GetKeyRequest(k, version.get()), TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL ) );
+
+			state Future<GetKeyReply> replyFuture;
+			if (speculative.size() && speculative.front().sel.getKey() == k.getKey() && speculative.front().sel.orEqual == k.orEqual && speculative.front().sel.offset == k.offset) {
+				TEST(true); // Speculative getKey request used
+				replyFuture = speculative.front().reply;
+				speculative.erase(speculative.begin());
+			} else {
+				speculative.clear();
+				++cx->transactionPhysicalReads;
+				replyFuture = loadBalance( ssi.second, &StorageServerInterface::getKey, GetKeyRequest(k, ver), TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL,
+					FLOW_KNOBS->LOAD_BALANCE_SHARD_AFFINITY ? loadBalanceAffinityHash(k.getKey()) : 0, ver );
+			}
+
+			while (std::abs(k.offset) > 1 && speculative.size() < CLIENT_KNOBS->GET_KEY_SPECULATIVE_SHARDS) {
+				KeyRange prevShard = speculative.size() ? speculative.back().shard : ssi.first;
+				state Key specBoundary = k.offset > 0 ? prevShard.end : prevShard.begin;
+				if ((k.offset > 0 && specBoundary == allKeys.end) || (k.offset <= 0 && specBoundary == allKeys.begin))
+					break;
+				state KeySelector specSel = KeySelector( KeySelectorRef( specBoundary, false, k.offset ) );
+				pair<KeyRange, Reference<LocationInfo>> specLocation = wait( getKeyLocation(cx, specBoundary, &StorageServerInterface::getKey, info, specSel.isBackward()) );
+				++cx->transactionPhysicalReads;
+				speculative.push_back( SpeculativeGetKey{ specSel, specLocation.first,
+					loadBalance( specLocation.second, &StorageServerInterface::getKey, GetKeyRequest(specSel, ver), TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL,
+						FLOW_KNOBS->LOAD_BALANCE_SHARD_AFFINITY ? loadBalanceAffinityHash(specSel.getKey()) : 0, ver ) } );
+			}
+
+			GetKeyReply reply = wait( replyFuture );
 			if( info.debugID.present() )
 				g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getKey.After"); //.detail("NextKey",printable(reply.sel.key)).detail("Offset", reply.sel.offset).detail("OrEqual", k.orEqual);
 			k = reply.sel;
@@ -1318,6 +1532,7 @@ ACTOR Future<Key> getKey( Database cx, KeySelector k, Future<Version> version, T
 				return k.getKey();
 			}
 		} catch (Error& e) {
+			speculative.clear();
 			if (e.code() == error_code_wrong_shard_server || e.code() == error_code_all_alternatives_failed) {
 				cx->invalidateCache(k.getKey(), k.isBackward());
 
@@ -1404,6 +1619,65 @@ ACTOR Future< Void > watchValue( Future<Version> version, Key key, Optional<Valu
 	}
 }
 
+// Attaches to the outstanding watchValue request for this key and value if there is one, so that
+// any number of watches on the same key and value hold a single request to the storage servers
+ACTOR Future<Void> sharedWatchValue( Future<Version> version, Key key, Optional<Value> value, Database cx, int readVersionFlags, TransactionInfo info )
+{
+	state std::pair<Key, Optional<Value>> mapKey = std::make_pair(key, value);
+	state Reference<WatchInfo> watch;
+
+	auto it = cx->watchMap.find(mapKey);
+	if( it != cx->watchMap.end() ) {
+		watch = it->second;
+	} else {
+		watch = Reference<WatchInfo>( new WatchInfo() );
+		watch->watch = watchValue( version, key, value, cx, readVersionFlags, info );
+		cx->watchMap[mapKey] = watch;
+	}
+	++watch->watchers;
+
+	try {
+		wait( watch->watch );
+	} catch( Error &e ) {
+		if( --watch->watchers == 0 ) {
+			auto cancelled = cx->watchMap.find(mapKey);
+			if( cancelled != cx->watchMap.end() && cancelled->second == watch )
+				cx->watchMap.erase(cancelled);
+		}
+		throw;
+	}
+
+	// The watch has fired, so the next watch on this key and value must check it again
+	--watch->watchers;
+	auto fired = cx->watchMap.find(mapKey);
+	if( fired != cx->watchMap.end() && fired->second == watch )
+		cx->watchMap.erase(fired);
+
+	return Void();
+}
+
+// Rebuilds full keys from a prefix compressed reply (see GetKeyValuesRequest::prefixCompressed).
+// Rebuilt keys are allocated in the reply arena, which the getRange paths hand to the caller.
+void decompressKeyPrefixes( GetKeyValuesReply& rep ) {
+	if( !rep.prefixLengths.size() )
+		return;
+	ASSERT( rep.prefixLengths.size() == rep.data.size() );
+	KeyRef prev;
+	for(int i=0; i<rep.data.size(); i++) {
+		int prefixLen = rep.prefixLengths[i];
+		KeyRef suffix = rep.data[i].key;
+		if( prefixLen ) {
+			ASSERT( prefixLen <= prev.size() );
+			uint8_t* key = new (rep.arena) uint8_t[ prefixLen + suffix.size() ];
+			memcpy( key, prev.begin(), prefixLen );
+			memcpy( key + prefixLen, suffix.begin(), suffix.size() );
+			rep.data[i].key = KeyRef( key, prefixLen + suffix.size() );
+		}
+		prev = rep.data[i].key;
+	}
+	rep.prefixLengths = VectorRef<int32_t>();
+}
+
 void transformRangeLimits(GetRangeLimits limits, bool reverse, GetKeyValuesRequest &req) {
 	if(limits.bytes != 0) {
 		if(!limits.hasRowLimit())
@@ -1445,6 +1719,7 @@ ACTOR Future<Standalone<RangeResultRef>> getExactRange( Database cx, Version ver
 
 			transformRangeLimits(limits, reverse, req);
 			ASSERT(req.limitBytes > 0 && req.limit != 0 && req.limit < 0 == reverse);
+			req.prefixCompressed = CLIENT_KNOBS->RANGE_PREFIX_COMPRESSION != 0;
 
 			//FIXME: buggify byte limits on internal functions that use them, instead of globally
 			req.debugID = info.debugID;
@@ -1462,9 +1737,11 @@ ACTOR Future<Standalone<RangeResultRef>> getExactRange( Database cx, Version ver
 					.detail("Servers", locations[shard].second->description());*/
 				}
 				++cx->transactionPhysicalReads;
-				GetKeyValuesReply rep = wait( loadBalance( locations[shard].second, &StorageServerInterface::getKeyValues, req, TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL ) );
+				GetKeyValuesReply rep = wait( loadBalance( locations[shard].second, &StorageServerInterface::getKeyValues, req, TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL,
+					FLOW_KNOBS->LOAD_BALANCE_SHARD_AFFINITY ? loadBalanceAffinityHash(req.begin.getKey()) : 0, req.version ) );
 				if( info.debugID.present() )
 					g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getExactRange.After");
+				decompressKeyPrefixes( rep );
 				output.arena().dependsOn( rep.arena );
 				output.append( output.arena(), rep.data.begin(), rep.data.size() );
 
@@ -1552,6 +1829,142 @@ ACTOR Future<Standalone<RangeResultRef>> getExactRange( Database cx, Version ver
 	}
 }
 
+// Reads keys by issuing GetKeyValuesRequests for several shards concurrently instead of walking them
+// serially, stitching the replies back together in key order.  Each sub-range is read with the full
+// remaining limits, since we cannot know in advance how much of them earlier sub-ranges will consume;
+// the stitch loop truncates once limits are actually reached.  The concurrent window is bounded by
+// RANGE_READ_PARALLELISM and, when a byte limit is in effect, by RANGE_READ_PARALLEL_BYTE_LIMIT worth
+// of speculative replies.
+ACTOR Future<Standalone<RangeResultRef>> getExactRangeParallel( Database cx, Version version,
+	KeyRange keys, GetRangeLimits limits, bool reverse, TransactionInfo info )
+{
+	state Standalone<RangeResultRef> output;
+
+	loop {
+		state vector< pair<KeyRange, Reference<LocationInfo>> > locations = wait( getKeyRangeLocations( cx, keys, CLIENT_KNOBS->RANGE_READ_PARALLEL_SHARD_LIMIT, reverse, &StorageServerInterface::getKeyValues, info ) );
+		ASSERT( locations.size() );
+
+		state int parallelism = CLIENT_KNOBS->RANGE_READ_PARALLELISM;
+		if( limits.hasByteLimit() )
+			parallelism = std::max<int>( 1, std::min<int64_t>( parallelism, CLIENT_KNOBS->RANGE_READ_PARALLEL_BYTE_LIMIT / std::max( 1, limits.bytes ) ) );
+
+		state vector< Future<Standalone<RangeResultRef>> > readers( locations.size() );
+		state int started = 0;
+		state int finished = 0;
+		while( finished < locations.size() ) {
+			while( started < locations.size() && started - finished < parallelism ) {
+				readers[started] = getExactRange( cx, version, locations[started].first, limits, reverse, info );
+				started++;
+			}
+
+			Standalone<RangeResultRef> r = wait( readers[finished] );
+			readers[finished] = Future<Standalone<RangeResultRef>>();
+			finished++;
+
+			output.arena().dependsOn( r.arena() );
+			for(int i = 0; i < r.size(); i++) {
+				if( limits.isReached() ) {
+					output.more = true;
+					return output;
+				}
+				output.push_back( output.arena(), r[i] );
+				limits.decrement( r[i] );
+			}
+
+			if( r.more ) {
+				TEST(true);   // Sub-range hit its own limits in getExactRangeParallel
+				output.more = true;
+				return output;
+			}
+
+			// Soft byte limit, as in getExactRange
+			if( limits.hasSatisfiedMinRows() && output.size() > 0 ) {
+				output.more = true;
+				return output;
+			}
+		}
+
+		const KeyRangeRef& range = locations[locations.size()-1].first;
+		KeyRef begin = reverse ? keys.begin : range.end;
+		KeyRef end = reverse ? range.begin : keys.end;
+
+		if( begin >= end ) {
+			output.more = false;
+			return output;
+		}
+		TEST(true); //Multiple location requests in getExactRangeParallel
+
+		keys = KeyRangeRef( begin, end );
+	}
+}
+
+// Computes the exact row count and key+value byte sum of a range at the given version.  Each shard
+// is scanned entirely on its storage servers, in bounded batches, and only the totals cross the
+// network, so the cost to the client is independent of the amount of data in the range.
+ACTOR Future<RangeAggregate> getRangeAggregate( Database cx, Future<Version> fVersion, KeyRange keys, TransactionInfo info )
+{
+	state Version version = wait( fVersion );
+	state RangeAggregate output;
+
+	if( keys.empty() )
+		return output;
+
+	loop {
+		state vector< pair<KeyRange, Reference<LocationInfo>> > locations = wait( getKeyRangeLocations( cx, keys, CLIENT_KNOBS->GET_RANGE_SHARD_LIMIT, false, &StorageServerInterface::getKeyValues, info ) );
+		ASSERT( locations.size() );
+		state int shard = 0;
+		loop {
+			const KeyRangeRef& range = locations[shard].first;
+
+			GetKeyValuesRequest req;
+			req.version = version;
+			req.begin = firstGreaterOrEqual( range.begin );
+			req.end = firstGreaterOrEqual( range.end );
+			req.limit = CLIENT_KNOBS->RANGE_AGGREGATE_ROW_LIMIT;
+			req.limitBytes = CLIENT_KNOBS->RANGE_AGGREGATE_BYTE_LIMIT;
+			req.aggregateOnly = true;
+			req.debugID = info.debugID;
+
+			try {
+				if( info.debugID.present() )
+					g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getRangeAggregate.Before");
+				++cx->transactionPhysicalReads;
+				GetKeyValuesReply rep = wait( loadBalance( locations[shard].second, &StorageServerInterface::getKeyValues, req, TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL,
+					FLOW_KNOBS->LOAD_BALANCE_SHARD_AFFINITY ? loadBalanceAffinityHash(req.begin.getKey()) : 0, req.version ) );
+				if( info.debugID.present() )
+					g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getRangeAggregate.After");
+
+				output.rows += rep.aggregateRows;
+				output.bytes += rep.aggregateBytes;
+
+				if(shard == locations.size()-1) {
+					KeyRef begin = locations[shard].first.end;
+					if(begin >= keys.end)
+						return output;
+					TEST(true); //Multiple location requests in getRangeAggregate
+					keys = KeyRangeRef(begin, keys.end);
+					break;
+				}
+
+				++shard;
+			} catch (Error& e) {
+				if (e.code() == error_code_wrong_shard_server || e.code() == error_code_all_alternatives_failed) {
+					keys = KeyRangeRef( locations[shard].first.begin, keys.end );
+					cx->invalidateCache( keys );
+					wait( delay(CLIENT_KNOBS->WRONG_SHARD_SERVER_DELAY, info.taskID ));
+					break;
+				} else {
+					TraceEvent(SevInfo, "GetRangeAggregateError")
+						.error(e)
+						.detail("ShardBegin", printable(locations[shard].first.begin))
+						.detail("ShardEnd", printable(locations[shard].first.end));
+					throw;
+				}
+			}
+		}
+	}
+}
+
 Future<Key> resolveKey( Database const& cx, KeySelector const& key, Version const& version, TransactionInfo const& info ) {
 	if( key.isFirstGreaterOrEqual() )
 		return Future<Key>( key.getKey() );
@@ -1565,7 +1978,7 @@ Future<Key> resolveKey( Database const& cx, KeySelector const& key, Version cons
 ACTOR Future<Standalone<RangeResultRef>> getRangeFallback( Database cx, Version version,
 	KeySelector begin, KeySelector end, GetRangeLimits limits, bool reverse, TransactionInfo info )
 {
-	if(version == latestVersion) {
+	if(version == latestVersion || version == replicaDurableVersion) {
 		state Transaction transaction(cx);
 		transaction.setOption(FDBTransactionOptions::CAUSAL_READ_RISKY);
 		transaction.setOption(FDBTransactionOptions::LOCK_AWARE);
@@ -1656,6 +2069,34 @@ void getRangeFinished(Reference<TransactionLogInfo> trLogInfo, double startTime,
 	}
 }
 
+// Entry point for PARALLEL_RANGE_READS transactions.  Only used when begin and end are already plain
+// keys, so the whole range can be fanned out across shards by getExactRangeParallel.
+ACTOR Future<Standalone<RangeResultRef>> getParallelRange( Database cx, Reference<TransactionLogInfo> trLogInfo, Future<Version> fVersion,
+	KeySelector begin, KeySelector end, GetRangeLimits limits, Promise<std::pair<Key, Key>> conflictRange, bool snapshot, bool reverse,
+	TransactionInfo info )
+{
+	state double startTime = now();
+	try {
+		state Version version = wait( fVersion );
+		validateVersion(version);
+
+		state Standalone<RangeResultRef> result = wait( getExactRangeParallel( cx, version, KeyRangeRef(begin.getKey(), end.getKey()), limits, reverse, info ) );
+		if( begin.getKey() == allKeys.begin && ((reverse && !result.more) || !reverse) )
+			result.readToBegin = true;
+		if( end.getKey() == allKeys.end && ((!reverse && !result.more) || reverse) )
+			result.readThroughEnd = true;
+
+		getRangeFinished( trLogInfo, startTime, begin, end, snapshot, conflictRange, reverse, result );
+		return result;
+	} catch(Error &e) {
+		if( conflictRange.canBeSet() ) {
+			conflictRange.send(std::make_pair(Key(), Key()));
+		}
+
+		throw;
+	}
+}
+
 ACTOR Future<Standalone<RangeResultRef>> getRange( Database cx, Reference<TransactionLogInfo> trLogInfo, Future<Version> fVersion,
 	KeySelector begin, KeySelector end, GetRangeLimits limits, Promise<std::pair<Key, Key>> conflictRange, bool snapshot, bool reverse,
 	TransactionInfo info )
@@ -1712,6 +2153,7 @@ ACTOR Future<Standalone<RangeResultRef>> getRange( Database cx, Reference<Transa
 
 			transformRangeLimits(limits, reverse, req);
 			ASSERT(req.limitBytes > 0 && req.limit != 0 && req.limit < 0 == reverse);
+			req.prefixCompressed = CLIENT_KNOBS->RANGE_PREFIX_COMPRESSION != 0;
 
 			req.debugID = info.debugID;
 			try {
@@ -1734,7 +2176,8 @@ ACTOR Future<Standalone<RangeResultRef>> getRange( Database cx, Reference<Transa
 				}
 
 				++cx->transactionPhysicalReads;
-				GetKeyValuesReply rep = wait( loadBalance(beginServer.second, &StorageServerInterface::getKeyValues, req, TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL ) );
+				GetKeyValuesReply rep = wait( loadBalance(beginServer.second, &StorageServerInterface::getKeyValues, req, TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL,
+					FLOW_KNOBS->LOAD_BALANCE_SHARD_AFFINITY ? loadBalanceAffinityHash(req.begin.getKey()) : 0, req.version ) );
 
 				if( info.debugID.present() ) {
 					g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getRange.After");//.detail("SizeOf", rep.data.size());
@@ -1746,6 +2189,7 @@ ACTOR Future<Standalone<RangeResultRef>> getRange( Database cx, Reference<Transa
 						.detail("RowsReturned", rep.data.size());*/
 				}
 
+				decompressKeyPrefixes( rep );
 				ASSERT( !rep.more || rep.data.size() );
 				ASSERT( !limits.hasRowLimit() || rep.data.size() <= limits.rows );
 
@@ -1828,7 +2272,7 @@ ACTOR Future<Standalone<RangeResultRef>> getRange( Database cx, Reference<Transa
 					TraceEvent("TransactionDebugError", info.debugID.get()).error(e);
 				}
 				if (e.code() == error_code_wrong_shard_server || e.code() == error_code_all_alternatives_failed ||
-					(e.code() == error_code_transaction_too_old && readVersion == latestVersion))
+					(e.code() == error_code_transaction_too_old && (readVersion == latestVersion || readVersion == replicaDurableVersion)))
 				{
 					cx->invalidateCache( reverse ? end.getKey() : begin.getKey(), reverse ? (end-1).isBackward() : begin.isBackward() );
 
@@ -1863,6 +2307,163 @@ Future<Standalone<RangeResultRef>> getRange( Database const& cx, Future<Version>
 	return getRange(cx, Reference<TransactionLogInfo>(), fVersion, begin, end, limits, Promise<std::pair<Key, Key>>(), true, reverse, info);
 }
 
+// Cache miss path for USE_RANGE_READ_CACHE transactions: performs the read and stores the result in
+// the database's range read cache so identical reads within RANGE_CACHE_MAX_STALENESS are served
+// from memory.  The read is issued with snapshot=false so that getRangeFinished reports the exact
+// key range the read covered, which invalidateCache uses to drop the entry when it observes a shard
+// boundary change or failure in that range; the conflict range promise belongs to this actor, so no
+// conflict range is added to the transaction.
+ACTOR Future<Standalone<RangeResultRef>> getRangeAndCache( Database cx, Reference<TransactionLogInfo> trLogInfo, Future<Version> fVersion,
+	DatabaseContext::RangeReadCacheKey key, KeySelector begin, KeySelector end, GetRangeLimits limits, bool reverse, TransactionInfo info )
+{
+	state Promise<std::pair<Key, Key>> conflictRange;
+	state Future<std::pair<Key, Key>> coveredRange = conflictRange.getFuture();
+	Standalone<RangeResultRef> result = wait( ::getRange( cx, trLogInfo, fVersion, begin, end, limits, conflictRange, false, reverse, info ) );
+	std::pair<Key, Key> covered = wait( coveredRange );
+	if( covered.first < covered.second )
+		cx->setCachedRangeRead( key, KeyRangeRef( covered.first, covered.second ), result );
+	return result;
+}
+
+// Streams the contents of keys to results in reply-sized chunks as they arrive instead of buffering
+// the whole result.  A chunk is only sent once the consumer has drained the stream, bounding client
+// memory to roughly one chunk ahead of the consumer, and the next request goes on the wire before
+// the consumer is scheduled, so the network round trip overlaps with processing.  The stream is
+// terminated with end_of_stream (or the error that stopped the read).
+ACTOR Future<Void> getRangeStream( PromiseStream<Standalone<RangeResultRef>> results, Database cx, Reference<TransactionLogInfo> trLogInfo,
+	Future<Version> fVersion, KeySelector begin, KeySelector end, GetRangeLimits limits,
+	Promise<std::pair<Key, Key>> conflictRange, bool snapshot, bool reverse, TransactionInfo info )
+{
+	state double startTime = now();
+	state int accumulatedBytes = 0;
+	state Key lastDelivered;
+	try {
+		state Version version = wait( fVersion );
+		validateVersion(version);
+
+		Future<Key> fb = resolveKey(cx, begin, version, info);
+		state Future<Key> fe = resolveKey(cx, end, version, info);
+		state Key b = wait(fb);
+		state Key e = wait(fe);
+
+		state KeyRange keys = b < e ? KeyRangeRef(b, e) : KeyRange();
+		while( !keys.empty() && !limits.isReached() ) {
+			state vector< pair<KeyRange, Reference<LocationInfo>> > locations = wait( getKeyRangeLocations( cx, keys, CLIENT_KNOBS->GET_RANGE_SHARD_LIMIT, reverse, &StorageServerInterface::getKeyValues, info ) );
+			ASSERT( locations.size() );
+			state int shard = 0;
+			loop {
+				GetKeyValuesRequest req;
+				req.version = version;
+				req.begin = firstGreaterOrEqual( locations[shard].first.begin );
+				req.end = firstGreaterOrEqual( locations[shard].first.end );
+
+				// Individual requests are chunk sized so that replies can be surfaced as they arrive
+				GetRangeLimits chunkLimits = limits;
+				if( !chunkLimits.hasByteLimit() || chunkLimits.bytes > CLIENT_KNOBS->REPLY_BYTE_LIMIT )
+					chunkLimits.bytes = CLIENT_KNOBS->REPLY_BYTE_LIMIT;
+				transformRangeLimits(chunkLimits, reverse, req);
+				req.prefixCompressed = CLIENT_KNOBS->RANGE_PREFIX_COMPRESSION != 0;
+				req.debugID = info.debugID;
+
+				try {
+					if( info.debugID.present() )
+						g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getRangeStream.Before");
+					++cx->transactionPhysicalReads;
+					state GetKeyValuesReply rep = wait( loadBalance( locations[shard].second, &StorageServerInterface::getKeyValues, req, TaskDefaultPromiseEndpoint, false, cx->enableLocalityLoadBalance ? &cx->queueModel : NULL,
+						FLOW_KNOBS->LOAD_BALANCE_SHARD_AFFINITY ? loadBalanceAffinityHash(req.begin.getKey()) : 0, req.version ) );
+					if( info.debugID.present() )
+						g_traceBatch.addEvent("TransactionDebug", info.debugID.get().first(), "NativeAPI.getRangeStream.After");
+
+					decompressKeyPrefixes( rep );
+					limits.decrement( rep.data );
+
+					bool more = rep.more;
+					// If the reply says there is more but we know that we finished the shard, then fix more
+					if( reverse && more && rep.data.size() > 0 && rep.data[rep.data.size()-1].key == locations[shard].first.begin )
+						more = false;
+
+					if( more && rep.data.size() > 0 ) {
+						// The next request to the same shard starts just past the last key returned
+						if( reverse )
+							locations[shard].first = KeyRangeRef( locations[shard].first.begin, rep.data[rep.data.size()-1].key );
+						else
+							locations[shard].first = KeyRangeRef( keyAfter( rep.data[rep.data.size()-1].key ), locations[shard].first.end );
+					}
+
+					// Decide where the read continues before handing the chunk to the consumer, so the
+					// chunk's more flag reflects whether the stream has actually ended
+					state bool refreshLocations = false;
+					if( limits.isReached() ) {
+						keys = KeyRange();
+						refreshLocations = true;
+					} else if( !more || locations[shard].first.empty() ) {
+						if( shard == locations.size()-1 ) {
+							const KeyRangeRef& range = locations[shard].first;
+							KeyRef nb = reverse ? keys.begin : range.end;
+							KeyRef ne = reverse ? range.begin : keys.end;
+							keys = nb < ne ? KeyRangeRef( nb, ne ) : KeyRange();
+							refreshLocations = true;
+						} else {
+							++shard;
+						}
+					}
+
+					if( rep.data.size() > 0 ) {
+						accumulatedBytes += rep.data.expectedSize();
+						lastDelivered = Key( rep.data[rep.data.size()-1].key, rep.arena );
+						wait( results.onEmpty() );
+						results.send( Standalone<RangeResultRef>( RangeResultRef( rep.data, limits.isReached() || !refreshLocations || !keys.empty() ), rep.arena ) );
+					}
+
+					if( refreshLocations )
+						break;
+				} catch (Error& e) {
+					if (e.code() == error_code_wrong_shard_server || e.code() == error_code_all_alternatives_failed) {
+						const KeyRangeRef& range = locations[shard].first;
+
+						if( reverse )
+							keys = KeyRangeRef( keys.begin, range.end );
+						else
+							keys = KeyRangeRef( range.begin, keys.end );
+
+						cx->invalidateCache( keys );
+						wait( delay(CLIENT_KNOBS->WRONG_SHARD_SERVER_DELAY, info.taskID ));
+						break;
+					} else {
+						throw;
+					}
+				}
+			}
+		}
+
+		if( trLogInfo )
+			trLogInfo->addLog(FdbClientLogEvents::EventGetRange(startTime, now()-startTime, accumulatedBytes, b, e));
+
+		if( !snapshot ) {
+			Key rangeBegin = b;
+			Key rangeEnd = e;
+			if( limits.isReached() && lastDelivered.size() ) {
+				if( reverse )
+					rangeBegin = lastDelivered;
+				else
+					rangeEnd = keyAfter( lastDelivered );
+			}
+			conflictRange.send( std::make_pair( rangeBegin, rangeEnd ) );
+		}
+
+		results.sendError( end_of_stream() );
+		return Void();
+	} catch (Error& e) {
+		if( conflictRange.canBeSet() ) {
+			conflictRange.send(std::make_pair(Key(), Key()));
+		}
+		if( e.code() != error_code_actor_cancelled )
+			results.sendError( e );
+
+		throw;
+	}
+}
+
 Transaction::Transaction( Database const& cx )
 	: cx(cx), info(cx->taskID), backoff(CLIENT_KNOBS->DEFAULT_BACKOFF), committedVersion(invalidVersion), versionstampPromise(Promise<Standalone<StringRef>>()), numErrors(0), trLogInfo(createTrLogInfoProbabilistically(cx))
 {
@@ -1919,7 +2520,7 @@ Future<Optional<Value>> Transaction::get( const Key& key, bool snapshot ) {
 	if(key.size() > (key.startsWith(systemKeys.begin) ? CLIENT_KNOBS->SYSTEM_KEY_SIZE_LIMIT : CLIENT_KNOBS->KEY_SIZE_LIMIT))
 		return Optional<Value>();
 
-	auto ver = getReadVersion();
+	auto ver = getQueryVersion();
 
 /*	if (!systemKeys.contains(key))
 		return Optional<Value>(Value()); */
@@ -1927,6 +2528,9 @@ Future<Optional<Value>> Transaction::get( const Key& key, bool snapshot ) {
 	if( !snapshot )
 		tr.transaction.read_conflict_ranges.push_back(tr.arena, singleKeyRange(key, tr.arena));
 
+	if( CLIENT_KNOBS->COALESCE_IDENTICAL_GETS )
+		return sharedGetValue( ver, key, cx, info, trLogInfo );
+
 	return getValue( ver, key, cx, info, trLogInfo );
 }
 
@@ -2005,6 +2609,14 @@ Future< Standalone< VectorRef< const char*>>> Transaction::getAddressesForKey( c
 	return getAddressesForKeyActor(key, ver, cx, info);
 }
 
+Future< RangeAggregate > Transaction::getRangeAggregate( const KeyRange& keys ) {
+	++cx->transactionLogicalReads;
+
+	// This is a snapshot read: no read conflict range is added, since jobs sizing a range generally
+	// do not want to conflict with every write to it
+	return ::getRangeAggregate( cx, getQueryVersion(), keys, info );
+}
+
 ACTOR Future< Key > getKeyAndConflictRange(
 	Database cx, KeySelector k, Future<Version> version, Promise<std::pair<Key, Key>> conflictRange, TransactionInfo info)
 {
@@ -2024,11 +2636,11 @@ ACTOR Future< Key > getKeyAndConflictRange(
 Future< Key > Transaction::getKey( const KeySelector& key, bool snapshot ) {
 	++cx->transactionLogicalReads;
 	if( snapshot )
-		return ::getKey(cx, key, getReadVersion(), info);
+		return ::getKey(cx, key, getQueryVersion(), info);
 
 	Promise<std::pair<Key, Key>> conflictRange;
 	extraConflictRanges.push_back( conflictRange.getFuture() );
-	return getKeyAndConflictRange( cx, key, getReadVersion(), conflictRange, info );
+	return getKeyAndConflictRange( cx, key, getQueryVersion(), conflictRange, info );
 }
 
 Future< Standalone<RangeResultRef> > Transaction::getRange(
@@ -2065,12 +2677,25 @@ Future< Standalone<RangeResultRef> > Transaction::getRange(
 		return Standalone<RangeResultRef>();
 	}
 
+	if( options.useRangeReadCache && snapshot ) {
+		DatabaseContext::RangeReadCacheKey cacheKey = std::make_tuple( Key(b.getKey()), b.offset, Key(e.getKey()), e.offset, limits.rows, limits.minRows, limits.bytes, reverse );
+		Optional<Standalone<RangeResultRef>> cached = cx->getCachedRangeRead( cacheKey );
+		if( cached.present() ) {
+			TEST(true); // Range read served from the range read cache
+			return cached.get();
+		}
+		return ::getRangeAndCache( cx, trLogInfo, getQueryVersion(), cacheKey, b, e, limits, reverse, info );
+	}
+
 	Promise<std::pair<Key, Key>> conflictRange;
 	if(!snapshot) {
 		extraConflictRanges.push_back( conflictRange.getFuture() );
 	}
 
-	return ::getRange(cx, trLogInfo, getReadVersion(), b, e, limits, conflictRange, snapshot, reverse, info);
+	if( options.parallelRangeReads && b.isFirstGreaterOrEqual() && e.isFirstGreaterOrEqual() && b.getKey() < e.getKey() )
+		return ::getParallelRange(cx, trLogInfo, getQueryVersion(), b, e, limits, conflictRange, snapshot, reverse, info);
+
+	return ::getRange(cx, trLogInfo, getQueryVersion(), b, e, limits, conflictRange, snapshot, reverse, info);
 }
 
 Future< Standalone<RangeResultRef> > Transaction::getRange(
@@ -2083,6 +2708,46 @@ Future< Standalone<RangeResultRef> > Transaction::getRange(
 	return getRange( begin, end, GetRangeLimits( limit ), snapshot, reverse );
 }
 
+Future< Void > Transaction::getRangeStream(
+	const PromiseStream<Standalone<RangeResultRef>>& results,
+	const KeySelector& begin,
+	const KeySelector& end,
+	GetRangeLimits limits,
+	bool snapshot,
+	bool reverse )
+{
+	++cx->transactionLogicalReads;
+
+	if( limits.isReached() ) {
+		results.sendError( end_of_stream() );
+		return Void();
+	}
+
+	if( !limits.isValid() )
+		return range_limits_invalid();
+
+	ASSERT(limits.rows != 0);
+
+	KeySelector b = begin;
+	if( b.orEqual ) {
+		TEST(true); // Native stream begin orEqual==true
+		b.removeOrEqual(b.arena());
+	}
+
+	KeySelector e = end;
+	if( e.orEqual ) {
+		TEST(true); // Native stream end orEqual==true
+		e.removeOrEqual(e.arena());
+	}
+
+	Promise<std::pair<Key, Key>> conflictRange;
+	if(!snapshot) {
+		extraConflictRanges.push_back( conflictRange.getFuture() );
+	}
+
+	return ::getRangeStream( results, cx, trLogInfo, getQueryVersion(), b, e, limits, conflictRange, snapshot, reverse, info );
+}
+
 void Transaction::addReadConflictRange( KeyRangeRef const& keys ) {
 	ASSERT( !keys.empty() );
 
@@ -2114,7 +2779,7 @@ void Transaction::makeSelfConflicting() {
 	tr.transaction.write_conflict_ranges.push_back( tr.arena, r );
 }
 
-void Transaction::set( const KeyRef& key, const ValueRef& value, bool addConflictRange ) {
+void Transaction::set( const KeyRef& key, const ValueRef& value, bool addConflictRange, bool copyContents ) {
 
 	if(key.size() > (key.startsWith(systemKeys.begin) ? CLIENT_KNOBS->SYSTEM_KEY_SIZE_LIMIT : CLIENT_KNOBS->KEY_SIZE_LIMIT))
 		throw key_too_large();
@@ -2123,6 +2788,15 @@ void Transaction::set( const KeyRef& key, const ValueRef& value, bool addConflic
 
 	auto &req = tr;
 	auto &t = req.transaction;
+
+	if( !copyContents ) {
+		t.mutations.push_back( req.arena, MutationRef( MutationRef::SetValue, key, value ) );
+		if( addConflictRange ) {
+			t.write_conflict_ranges.push_back( req.arena, singleKeyRange( key, req.arena ) );
+		}
+		return;
+	}
+
 	auto r = singleKeyRange( key, req.arena );
 	auto v = ValueRef( req.arena, value );
 	t.mutations.push_back( req.arena, MutationRef( MutationRef::SetValue, r.begin, v ) );
@@ -2132,7 +2806,7 @@ void Transaction::set( const KeyRef& key, const ValueRef& value, bool addConflic
 	}
 }
 
-void Transaction::atomicOp(const KeyRef& key, const ValueRef& operand, MutationRef::Type operationType, bool addConflictRange) {
+void Transaction::atomicOp(const KeyRef& key, const ValueRef& operand, MutationRef::Type operationType, bool addConflictRange, bool copyContents) {
 	if(key.size() > (key.startsWith(systemKeys.begin) ? CLIENT_KNOBS->SYSTEM_KEY_SIZE_LIMIT : CLIENT_KNOBS->KEY_SIZE_LIMIT))
 		throw key_too_large();
 	if(operand.size() > CLIENT_KNOBS->VALUE_SIZE_LIMIT)
@@ -2147,18 +2821,26 @@ void Transaction::atomicOp(const KeyRef& key, const ValueRef& operand, MutationR
 
 	auto &req = tr;
 	auto &t = req.transaction;
-	auto r = singleKeyRange( key, req.arena );
-	auto v = ValueRef( req.arena, operand );
 
-	t.mutations.push_back( req.arena, MutationRef( operationType, r.begin, v ) );
+	if( !copyContents ) {
+		t.mutations.push_back( req.arena, MutationRef( operationType, key, operand ) );
+		if( addConflictRange )
+			t.write_conflict_ranges.push_back( req.arena, singleKeyRange( key, req.arena ) );
+	}
+	else {
+		auto r = singleKeyRange( key, req.arena );
+		auto v = ValueRef( req.arena, operand );
 
-	if( addConflictRange )
-		t.write_conflict_ranges.push_back( req.arena, r );
+		t.mutations.push_back( req.arena, MutationRef( operationType, r.begin, v ) );
+
+		if( addConflictRange )
+			t.write_conflict_ranges.push_back( req.arena, r );
+	}
 
 	TEST(true); //NativeAPI atomic operation
 }
 
-void Transaction::clear( const KeyRangeRef& range, bool addConflictRange ) {
+void Transaction::clear( const KeyRangeRef& range, bool addConflictRange, bool copyContents ) {
 	auto &req = tr;
 	auto &t = req.transaction;
 
@@ -2172,7 +2854,7 @@ void Transaction::clear( const KeyRangeRef& range, bool addConflictRange ) {
 	if(end.size() > (end.startsWith(systemKeys.begin) ? CLIENT_KNOBS->SYSTEM_KEY_SIZE_LIMIT : CLIENT_KNOBS->KEY_SIZE_LIMIT))
 		end = end.substr(0, (end.startsWith(systemKeys.begin) ? CLIENT_KNOBS->SYSTEM_KEY_SIZE_LIMIT : CLIENT_KNOBS->KEY_SIZE_LIMIT)+1);
 
-	auto r = KeyRangeRef( req.arena, KeyRangeRef(begin, end) );
+	auto r = copyContents ? KeyRangeRef( req.arena, KeyRangeRef(begin, end) ) : KeyRangeRef(begin, end);
 	if (r.empty()) return;
 
 	t.mutations.push_back( req.arena, MutationRef( MutationRef::ClearRange, r.begin, r.end ) );
@@ -2222,6 +2904,10 @@ void Transaction::addWriteConflictRange( const KeyRangeRef& keys ) {
 	t.write_conflict_ranges.push_back_deep( req.arena, r );
 }
 
+void Transaction::addCommitArenaDependency( Arena const& arena ) {
+	tr.arena.dependsOn( arena );
+}
+
 double Transaction::getBackoff(int errCode) {
 	double b = backoff * g_random->random01();
 	backoff = errCode == error_code_proxy_memory_limit_exceeded ? std::min(backoff * CLIENT_KNOBS->BACKOFF_GROWTH_RATE, CLIENT_KNOBS->RESOURCE_CONSTRAINED_MAX_BACKOFF) :
@@ -2399,7 +3085,7 @@ void Transaction::setupWatches() {
 		Future<Version> watchVersion = getCommittedVersion() > 0 ? getCommittedVersion() : getReadVersion();
 
 		for(int i = 0; i < watches.size(); ++i)
-			watches[i]->setWatch(watchValue( watchVersion, watches[i]->key, watches[i]->value, cx, options.getReadVersionFlags, info ));
+			watches[i]->setWatch(sharedWatchValue( watchVersion, watches[i]->key, watches[i]->value, cx, options.getReadVersionFlags, info ));
 
 		watches.clear();
 	}
@@ -2508,6 +3194,24 @@ ACTOR static Future<Void> tryCommit( Database cx, Reference<TransactionLogInfo>
 	}
 }
 
+// Sorts ranges and merges overlapping or adjacent ones in place.  Iterator heavy transactions
+// accumulate thousands of single key read conflict ranges, many of them duplicated or touching;
+// coalescing them before serialization shrinks the commit request and the number of ranges the
+// resolvers check individually.
+void coalesceConflictRanges( Arena& arena, VectorRef<KeyRangeRef>& ranges ) {
+	if( ranges.size() <= 1 )
+		return;
+	std::sort( ranges.begin(), ranges.end(), []( KeyRangeRef const& a, KeyRangeRef const& b ) { return a.begin < b.begin || (a.begin == b.begin && a.end < b.end); } );
+	int merged = 0;
+	for(int i=1; i<ranges.size(); i++) {
+		if( ranges[i].begin <= ranges[merged].end )
+			ranges[merged] = KeyRangeRef( ranges[merged].begin, std::max( ranges[merged].end, ranges[i].end ) );
+		else
+			ranges[++merged] = ranges[i];
+	}
+	ranges.resize( arena, merged + 1 );
+}
+
 Future<Void> Transaction::commitMutations() {
 	try {
 		//if this is a read-only transaction return immediately
@@ -2560,6 +3264,9 @@ Future<Void> Transaction::commitMutations() {
 			tr.transaction.read_conflict_ranges.append( tr.arena, tr.transaction.write_conflict_ranges.begin(), tr.transaction.write_conflict_ranges.size() );
 		}
 
+		coalesceConflictRanges( tr.arena, tr.transaction.read_conflict_ranges );
+		coalesceConflictRanges( tr.arena, tr.transaction.write_conflict_ranges );
+
 		if ( options.debugDump ) {
 			UID u = g_nondeterministic_random->randomUniqueID();
 			TraceEvent("TransactionDump", u);
@@ -2718,6 +3425,31 @@ void Transaction::setOption( FDBTransactionOptions::Option option, Optional<Stri
 			options.firstInBatch = true;
 			break;
 
+		case FDBTransactionOptions::USE_GRV_CACHE:
+			validateOptionValue(value, false);
+			options.useGrvCache = true;
+			break;
+
+		case FDBTransactionOptions::PARALLEL_RANGE_READS:
+			validateOptionValue(value, false);
+			options.parallelRangeReads = true;
+			break;
+
+		case FDBTransactionOptions::MIN_READ_VERSION:
+			validateOptionValue(value, true);
+			options.minReadVersion = extractIntOption(value, 0, std::numeric_limits<int64_t>::max());
+			break;
+
+		case FDBTransactionOptions::USE_RANGE_READ_CACHE:
+			validateOptionValue(value, false);
+			options.useRangeReadCache = true;
+			break;
+
+		case FDBTransactionOptions::READ_DURABLE_VERSION:
+			validateOptionValue(value, false);
+			options.readDurableVersion = true;
+			break;
+
 		default:
 			break;
 	}
@@ -2729,14 +3461,21 @@ ACTOR Future<GetReadVersionReply> getConsistentReadVersion( DatabaseContext *cx,
 			g_traceBatch.addEvent("TransactionDebug", debugID.get().first(), "NativeAPI.getConsistentReadVersion.Before");
 		loop {
 			state GetReadVersionRequest req( transactionCount, flags, debugID );
+			state Reference<ProxyInfo> proxies = CLIENT_KNOBS->GRV_PROXY_AFFINITY ? cx->getGrvProxyAffinity() : cx->getMasterProxies();
 			choose {
 				when ( wait( cx->onMasterProxiesChanged() ) ) {}
-				when ( GetReadVersionReply v = wait( loadBalance( cx->getMasterProxies(), &MasterProxyInterface::getConsistentReadVersion, req, cx->taskID ) ) ) {
+				when ( GetReadVersionReply v = wait( loadBalance( proxies, &MasterProxyInterface::getConsistentReadVersion, req, cx->taskID ) ) ) {
 					if( debugID.present() )
 						g_traceBatch.addEvent("TransactionDebug", debugID.get().first(), "NativeAPI.getConsistentReadVersion.After");
 					ASSERT( v.version > 0 );
 					return v;
 				}
+				// With a single pinned proxy, load balancing cannot route around a proxy that is alive
+				// but not answering, so give up on it and pick a new one
+				when ( wait( CLIENT_KNOBS->GRV_PROXY_AFFINITY && proxies ? delay( CLIENT_KNOBS->GRV_PROXY_AFFINITY_TIMEOUT, cx->taskID ) : Never() ) ) {
+					TEST(true); // Pinned GRV proxy unresponsive, repicking
+					cx->invalidateGrvProxyAffinity();
+				}
 			}
 		}
 	} catch (Error& e) {
@@ -2746,6 +3485,49 @@ ACTOR Future<GetReadVersionReply> getConsistentReadVersion( DatabaseContext *cx,
 	}
 }
 
+ACTOR Future<GetReadVersionReply> getMinVersionReadVersion( DatabaseContext *cx, uint32_t flags, Optional<UID> debugID, Version minVersion ) {
+	// Bypasses the version batcher: a proxy whose committed version is already >= minVersion replies
+	// immediately, so batching these requests would only add the batch interval back to the latency
+	// this option exists to remove.
+	if( debugID.present() )
+		g_traceBatch.addEvent("TransactionDebug", debugID.get().first(), "NativeAPI.getMinVersionReadVersion.Before");
+	loop {
+		state GetReadVersionRequest req( 1, flags, debugID, minVersion );
+		choose {
+			when ( wait( cx->onMasterProxiesChanged() ) ) {}
+			when ( GetReadVersionReply v = wait( loadBalance( cx->getMasterProxies(), &MasterProxyInterface::getConsistentReadVersion, req, cx->taskID ) ) ) {
+				if( debugID.present() )
+					g_traceBatch.addEvent("TransactionDebug", debugID.get().first(), "NativeAPI.getMinVersionReadVersion.After");
+				ASSERT( v.version >= minVersion );
+				return v;
+			}
+		}
+	}
+}
+
+// Keeps the cached read version fresh while transactions with the USE_GRV_CACHE option are using it.
+// Refreshes when the cache is more than half the staleness bound old, and goes quiet once no
+// transaction has consulted the cache for GRV_CACHE_IDLE_TIMEOUT so an idle client stops issuing GRVs.
+ACTOR Future<Void> backgroundGrvUpdater( DatabaseContext *cx, uint32_t flags ) {
+	loop {
+		wait( delay( CLIENT_KNOBS->GRV_CACHE_MAX_STALENESS / 2.0, cx->taskID ) );
+		if( now() - cx->lastGrvCacheUse > CLIENT_KNOBS->GRV_CACHE_IDLE_TIMEOUT || now() - cx->lastGrvTime <= CLIENT_KNOBS->GRV_CACHE_MAX_STALENESS / 2.0 )
+			continue;
+		try {
+			state double requestTime = now();
+			GetReadVersionReply rep = wait( getConsistentReadVersion( cx, 1, flags, Optional<UID>() ) );
+			if( !rep.locked && rep.version > cx->cachedReadVersion ) {
+				cx->cachedReadVersion = rep.version;
+				cx->lastGrvTime = requestTime;
+			}
+		} catch (Error& e) {
+			if( e.code() == error_code_actor_cancelled )
+				throw;
+			TraceEvent(SevWarn, "BackgroundGrvUpdaterError").error(e).suppressFor(1.0);
+		}
+	}
+}
+
 ACTOR Future<Void> readVersionBatcher( DatabaseContext *cx, FutureStream< std::pair< Promise<GetReadVersionReply>, Optional<UID> > > versionStream, uint32_t flags ) {
 	state std::vector< Promise<GetReadVersionReply> > requests;
 	state PromiseStream< Future<Void> > addActor;
@@ -2812,6 +3594,11 @@ ACTOR Future<Version> extractReadVersion(DatabaseContext* cx, Reference<Transact
 	cx->GRVLatencies.addSample(latency);
 	if (trLogInfo)
 		trLogInfo->addLog(FdbClientLogEvents::EventGetVersion(startTime, latency));
+	// A locked reply never feeds the version cache, so cached reads cannot bypass the lock check
+	if( !rep.locked && rep.version > cx->cachedReadVersion ) {
+		cx->cachedReadVersion = rep.version;
+		cx->lastGrvTime = startTime;
+	}
 	if(rep.locked && !lockAware)
 		throw database_locked();
 
@@ -2822,6 +3609,23 @@ Future<Version> Transaction::getReadVersion(uint32_t flags) {
 	cx->transactionReadVersions++;
 	flags |= options.getReadVersionFlags;
 
+	if (options.useGrvCache && !readVersion.isValid()) {
+		cx->lastGrvCacheUse = now();
+		if (!cx->grvUpdateHandler.isValid())
+			cx->grvUpdateHandler = backgroundGrvUpdater( cx.getPtr(), flags );
+		if (cx->cachedReadVersion >= std::max<Version>(1, options.minReadVersion) && now() - cx->lastGrvTime <= CLIENT_KNOBS->GRV_CACHE_MAX_STALENESS) {
+			startTime = now();
+			readVersion = cx->cachedReadVersion;
+			return readVersion;
+		}
+	}
+
+	if (options.minReadVersion > 0 && !readVersion.isValid()) {
+		startTime = now();
+		readVersion = extractReadVersion( cx.getPtr(), trLogInfo, getMinVersionReadVersion( cx.getPtr(), flags, info.debugID, options.minReadVersion ), options.lockAware, startTime );
+		return readVersion;
+	}
+
 	auto& batcher = cx->versionBatcher[ flags ];
 	if (!batcher.actor.isValid()) {
 		batcher.actor = readVersionBatcher( cx.getPtr(), batcher.stream.getFuture(), flags );
@@ -3002,6 +3806,49 @@ Future< StorageMetrics > Transaction::getStorageMetrics( KeyRange const& keys, i
 	return ::waitStorageMetrics( cx, keys, StorageMetrics(), m, StorageMetrics(), shardLimit );
 }
 
+// Sums the current sampled byte estimate of each shard intersecting keys.  Each storage server
+// answers from its byte sample in O(log n), so unlike a scan this stays cheap for arbitrarily
+// large ranges; ranges spanning more shards than one location request returns are walked in
+// pieces rather than delayed like waitStorageMetrics.
+ACTOR Future<int64_t> getEstimatedRangeSizeBytes( Database cx, KeyRange keys ) {
+	state int64_t total = 0;
+	state Key beginKey = keys.begin;
+	loop {
+		state vector< pair<KeyRange, Reference<LocationInfo>> > locations = wait( getKeyRangeLocations( cx, KeyRangeRef(beginKey, keys.end),
+			CLIENT_KNOBS->STORAGE_METRICS_SHARD_LIMIT, false, &StorageServerInterface::waitMetrics, TransactionInfo(TaskDataDistribution) ) );
+		try {
+			state vector<Future<StorageMetrics>> fx( locations.size() );
+			for(int i=0; i<locations.size(); i++) {
+				WaitMetricsRequest req( locations[i].first, StorageMetrics(), StorageMetrics() );
+				req.min.bytes = 0;
+				req.max.bytes = -1;  // The current metrics always exceed this, so the reply is immediate
+				fx[i] = loadBalance( locations[i].second, &StorageServerInterface::waitMetrics, req, TaskDataDistribution );
+			}
+			wait( waitForAll(fx) );
+			for(int i=0; i<fx.size(); i++)
+				total += fx[i].get().bytes;
+
+			if (locations.size() == CLIENT_KNOBS->STORAGE_METRICS_SHARD_LIMIT && locations.back().first.end < keys.end) {
+				TEST(true); //Multiple location requests in getEstimatedRangeSizeBytes
+				beginKey = locations.back().first.end;
+			} else {
+				return total;
+			}
+		} catch (Error& e) {
+			if (e.code() != error_code_wrong_shard_server && e.code() != error_code_all_alternatives_failed)
+				throw;
+			cx->invalidateCache( keys );
+			wait( delay( CLIENT_KNOBS->WRONG_SHARD_SERVER_DELAY, TaskDataDistribution ) );
+			total = 0;
+			beginKey = keys.begin;
+		}
+	}
+}
+
+Future< int64_t > Transaction::getEstimatedRangeSizeBytes( KeyRange const& keys ) {
+	return ::getEstimatedRangeSizeBytes( cx, keys );
+}
+
 ACTOR Future< Standalone<VectorRef<KeyRef>> > splitStorageMetrics( Database cx, KeyRange keys, StorageMetrics limit, StorageMetrics estimated )
 {
 	loop {
@@ -135,6 +135,7 @@ struct TransactionOptions {
 	double maxBackoff;
 	uint32_t getReadVersionFlags;
 	uint32_t customTransactionSizeLimit;
+	Version minReadVersion;
 	bool checkWritesEnabled : 1;
 	bool causalWriteRisky : 1;
 	bool commitOnFirstProxy : 1;
@@ -142,6 +143,10 @@ struct TransactionOptions {
 	bool lockAware : 1;
 	bool readOnly : 1;
 	bool firstInBatch : 1;
+	bool useGrvCache : 1;
+	bool parallelRangeReads : 1;
+	bool useRangeReadCache : 1;
+	bool readDurableVersion : 1;
 
 	TransactionOptions() {
 		reset();
@@ -223,6 +228,10 @@ public:
 	void setVersion( Version v );
 	Future<Version> getReadVersion() { return getReadVersion(0); }
 
+	// The version reads are issued at: the replicaDurableVersion sentinel when the
+	// READ_DURABLE_VERSION option is set, and otherwise the transaction's read version
+	Future<Version> getQueryVersion() { return options.readDurableVersion ? Future<Version>( (Version)replicaDurableVersion ) : getReadVersion(); }
+
 	Future< Optional<Value> > get( const Key& key, bool snapshot = false );
 	Future< Void > watch( Reference<Watch> watch );
 	Future< Key > getKey( const KeySelector& key, bool snapshot = false );
@@ -238,8 +247,23 @@ public:
 			KeySelector( firstGreaterOrEqual(keys.end), keys.arena() ), limits, snapshot, reverse ); 
 	}
 
+	// Streams the contents of the range to results in chunks as they arrive from the storage servers
+	// rather than buffering the entire result, terminating the stream with end_of_stream (or the
+	// error that stopped the read).  The producer waits for the consumer to drain the stream before
+	// sending another chunk, so client memory stays bounded for arbitrarily large scans.
+	Future< Void > getRangeStream( const PromiseStream<Standalone<RangeResultRef>>& results, const KeySelector& begin, const KeySelector& end, GetRangeLimits limits, bool snapshot = false, bool reverse = false );
+	Future< Void > getRangeStream( const PromiseStream<Standalone<RangeResultRef>>& results, const KeyRange& keys, GetRangeLimits limits, bool snapshot = false, bool reverse = false ) {
+		return getRangeStream( results, KeySelector( firstGreaterOrEqual(keys.begin), keys.arena() ),
+			KeySelector( firstGreaterOrEqual(keys.end), keys.arena() ), limits, snapshot, reverse );
+	}
+
 	Future< Standalone<VectorRef< const char*>>> getAddressesForKey (const Key& key );
 
+	// Exact row count and key+value byte sum of the range at the read version, computed on the
+	// storage servers so no row data is shipped to the client.  Snapshot read: adds no read
+	// conflict range.
+	Future< RangeAggregate > getRangeAggregate( const KeyRange& keys );
+
 	void enableCheckWrites();
 	void addReadConflictRange( KeyRangeRef const& keys );
 	void addWriteConflictRange( KeyRangeRef const& keys );
@@ -249,13 +273,24 @@ public:
 
 	Future< StorageMetrics > waitStorageMetrics( KeyRange const& keys, StorageMetrics const& min, StorageMetrics const& max, StorageMetrics const& permittedError, int shardLimit );
 	Future< StorageMetrics > getStorageMetrics( KeyRange const& keys, int shardLimit );
+
+	// Estimated byte size of the range, summed from the storage servers' byte samples without
+	// scanning any data.  The error is bounded by the sampling error of each shard's sample.
+	Future< int64_t > getEstimatedRangeSizeBytes( KeyRange const& keys );
 	Future< Standalone<VectorRef<KeyRef>> > splitStorageMetrics( KeyRange const& keys, StorageMetrics const& limit, StorageMetrics const& estimated );
 
-	// If checkWriteConflictRanges is true, existing write conflict ranges will be searched for this key
-	void set( const KeyRef& key, const ValueRef& value, bool addConflictRange = true );
-	void atomicOp( const KeyRef& key, const ValueRef& value, MutationRef::Type operationType, bool addConflictRange = true );
-	void clear( const KeyRangeRef& range, bool addConflictRange = true );
+	// If checkWriteConflictRanges is true, existing write conflict ranges will be searched for this key.
+	// If copyContents is false the memory referenced by key and value is referenced by the commit
+	// request rather than copied into it, and the caller must keep it alive until the transaction is
+	// reset or destroyed, e.g. by passing its arena to addCommitArenaDependency().
+	void set( const KeyRef& key, const ValueRef& value, bool addConflictRange = true, bool copyContents = true );
+	void atomicOp( const KeyRef& key, const ValueRef& value, MutationRef::Type operationType, bool addConflictRange = true, bool copyContents = true );
+	void clear( const KeyRangeRef& range, bool addConflictRange = true, bool copyContents = true );
 	void clear( const KeyRef& key, bool addConflictRange = true );
+
+	// Keeps arena alive for the lifetime of the commit request, so mutations added with
+	// copyContents=false remain valid while the commit is in flight
+	void addCommitArenaDependency( Arena const& arena );
 	Future<Void> commit(); // Throws not_committed or commit_unknown_result errors in normal operation
 
 	void setOption( FDBTransactionOptions::Option option, Optional<StringRef> value = Optional<StringRef>() );
@@ -61,6 +61,12 @@ KeyValueRef const& RYWIterator::kv( Arena& arena ) {
 }
 
 RYWIterator& RYWIterator::operator++() {
+	if (end_key_cmp < 0 && writes.is_cleared_range() && cache.is_kv()) {
+		// Every cached row left in this cleared range is shadowed by the clear, so gallop
+		// over them in one step rather than paying a key comparison per shadowed row.
+		cache.skipContiguous( writes.endKey() );
+		end_key_cmp = cache.endKey().cmp(writes.endKey());
+	}
 	if (end_key_cmp <= 0) ++cache;
 	if (end_key_cmp >= 0) ++writes;
 	begin_key_cmp = -end_key_cmp;
@@ -69,6 +75,11 @@ RYWIterator& RYWIterator::operator++() {
 }
 
 RYWIterator& RYWIterator::operator--() {
+	if (begin_key_cmp > 0 && writes.is_cleared_range() && cache.is_kv()) {
+		// See operator++; the same applies to shadowed rows when iterating backward.
+		cache.skipContiguousBack( writes.beginKey().keyAfter() );
+		begin_key_cmp = cache.beginKey().cmp(writes.beginKey());
+	}
 	if (begin_key_cmp >= 0) --cache;
 	if (begin_key_cmp <= 0) --writes;
 	end_key_cmp = -begin_key_cmp;
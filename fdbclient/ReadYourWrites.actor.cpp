@@ -271,9 +271,16 @@ public:
 		}
 	}
 	template <class Req> static inline Future<typename Req::Result> readWithConflictRange( ReadYourWritesTransaction* ryw, Req const& req, bool snapshot ) {
+		ryw->materializeWrites();
 		if (ryw->options.readYourWritesDisabled) {
 			return readWithConflictRangeThrough(ryw, req, snapshot);
 		} else if (snapshot && ryw->options.snapshotRywEnabled <= 0) {
+			// Snapshot reads with no writes to read through don't need the cache or iterator
+			// machinery: there is nothing to merge, no conflict range to add, and a repeated read
+			// at the same version returns the same data whether it is served from the snapshot
+			// cache or from storage.  Forwarding directly also skips the cache insertion.
+			if (ryw->writes.empty())
+				return readWithConflictRangeThrough(ryw, req, snapshot);
 			return readWithConflictRangeSnapshot(ryw, req);
 		}
 		return readWithConflictRangeRYW(ryw, req, snapshot);
@@ -1027,6 +1034,14 @@ public:
 			
 			ryw->writeRangeToNativeTransaction(KeyRangeRef(StringRef(), ryw->getMaxWriteKey()));
 
+			// Sets buffered after the last operation that needed the WriteMap are newer than
+			// everything written above, so they go to the native transaction afterwards, building
+			// their write conflict ranges here at commit time
+			for(auto const& s : ryw->deferredSets) {
+				ryw->tr.set( s.key, s.value, s.addWriteConflict, false );
+			}
+			ryw->deferredSets.clear();
+
 			auto conflictRanges = ryw->readConflicts.ranges();
 			for( auto iter = conflictRanges.begin(); iter != conflictRanges.end(); ++iter ) {
 				if( iter->value() ) {
@@ -1097,7 +1112,7 @@ public:
 	}
 };
 
-ReadYourWritesTransaction::ReadYourWritesTransaction( Database const& cx ) : cache(&arena), writes(&arena), tr(cx), retries(0), creationTime(now()), commitStarted(false), options(tr) {}
+ReadYourWritesTransaction::ReadYourWritesTransaction( Database const& cx ) : cache(&arena), writes(&arena), tr(cx), retries(0), creationTime(now()), commitStarted(false), approximateSize(0), options(tr) {}
 
 ACTOR Future<Void> timebomb(double totalSeconds, Promise<Void> resetPromise) {
 	if(totalSeconds == 0.0) {
@@ -1305,10 +1320,37 @@ Future< Standalone<VectorRef<const char*> >> ReadYourWritesTransaction::getAddre
 	// If key >= allKeys.end, then our resulting address vector will be empty.
 	
 	Future< Standalone<VectorRef<const char*> >> result = waitOrError(tr.getAddressesForKey(key), resetPromise.getFuture());
-	reading.add( success( result ) ); 
+	reading.add( success( result ) );
 	return result;
 }
 
+Future< RangeAggregate > ReadYourWritesTransaction::getRangeAggregate( const KeyRange& keys ) {
+	if(checkUsedDuringCommit()) {
+		return used_during_commit();
+	}
+
+	if( resetPromise.isSet() )
+		return resetPromise.getFuture().getError();
+
+	// The totals reflect the database at the read version; uncommitted writes in this transaction
+	// are not folded in
+
+	Future< RangeAggregate > result = waitOrError(tr.getRangeAggregate(keys), resetPromise.getFuture());
+	reading.add( success( result ) );
+	return result;
+}
+
+Future< int64_t > ReadYourWritesTransaction::getEstimatedRangeSizeBytes( const KeyRange& keys ) {
+	if(checkUsedDuringCommit()) {
+		return used_during_commit();
+	}
+
+	if( resetPromise.isSet() )
+		return resetPromise.getFuture().getError();
+
+	return waitOrError(tr.getEstimatedRangeSizeBytes(keys), resetPromise.getFuture());
+}
+
 void ReadYourWritesTransaction::addReadConflictRange( KeyRangeRef const& keys ) {
 	if(checkUsedDuringCommit()) {
 		throw used_during_commit();
@@ -1336,6 +1378,8 @@ void ReadYourWritesTransaction::addReadConflictRange( KeyRangeRef const& keys )
 		return;
 	}
 
+	approximateSize += r.expectedSize();
+
 	if(options.readYourWritesDisabled) {
 		tr.addReadConflictRange(r);
 		return;
@@ -1368,6 +1412,10 @@ void ReadYourWritesTransaction::updateConflictMap( KeyRangeRef const& keys, Writ
 }
 
 void ReadYourWritesTransaction::writeRangeToNativeTransaction( KeyRangeRef const& keys ) {
+	// Everything written below is backed by this transaction's arena, so the native transaction can
+	// reference the mutation contents instead of copying them into the commit request
+	tr.addCommitArenaDependency( arena );
+
 	WriteMap::iterator it( &writes );
 	it.skip(keys.begin);
 
@@ -1380,13 +1428,13 @@ void ReadYourWritesTransaction::writeRangeToNativeTransaction( KeyRangeRef const
 			clearBegin = std::max(ExtStringRef(keys.begin), it.beginKey());
 			inClearRange = true;
 		} else if( !it.is_cleared_range() && inClearRange ) {
-			tr.clear( KeyRangeRef( clearBegin.toArenaOrRef(arena), it.beginKey().toArenaOrRef(arena) ), false );
+			tr.clear( KeyRangeRef( clearBegin.toArenaOrRef(arena), it.beginKey().toArenaOrRef(arena) ), false, false );
 			inClearRange = false;
 		}
 	}
 
 	if( inClearRange ) {
-		tr.clear(KeyRangeRef(clearBegin.toArenaOrRef(arena), keys.end), false);
+		tr.clear(KeyRangeRef(clearBegin.toArenaOrRef(arena), keys.end), false, false);
 	}
 
 	it.skip(keys.begin);
@@ -1409,7 +1457,7 @@ void ReadYourWritesTransaction::writeRangeToNativeTransaction( KeyRangeRef const
 			for( int i = 0; i < op.size(); ++i) {
 				switch(op[i].type) {
 					case MutationRef::SetValue:
-						tr.set( it.beginKey().assertRef(), op[i].value.get(), false );
+						tr.set( it.beginKey().assertRef(), op[i].value.get(), false, false );
 						break;
 					case MutationRef::AddValue:
 					case MutationRef::AppendIfFits:
@@ -1424,7 +1472,7 @@ void ReadYourWritesTransaction::writeRangeToNativeTransaction( KeyRangeRef const
 					case MutationRef::ByteMax:
 					case MutationRef::MinV2:
 					case MutationRef::AndV2:
-						tr.atomicOp( it.beginKey().assertRef(), op[i].value.get(), op[i].type, false );
+						tr.atomicOp( it.beginKey().assertRef(), op[i].value.get(), op[i].type, false, false );
 						break;
 					default:
 						break;
@@ -1444,7 +1492,19 @@ bool ReadYourWritesTransactionOptions::getAndResetWriteConflictDisabled() {
 	return disabled;
 }
 
+void ReadYourWritesTransaction::materializeWrites() {
+	if( deferredSets.empty() )
+		return;
+
+	// Replayed in order, so the relative order of buffered sets is preserved
+	for(auto const& s : deferredSets) {
+		writes.mutate( s.key, MutationRef::SetValue, s.value, s.addWriteConflict );
+	}
+	deferredSets.clear();
+}
+
 void ReadYourWritesTransaction::getWriteConflicts( KeyRangeMap<bool> *result ) {
+	materializeWrites();
 	WriteMap::iterator it( &writes );
 	it.skip(allKeys.begin);
 
@@ -1507,6 +1567,7 @@ void ReadYourWritesTransaction::atomicOp( const KeyRef& key, const ValueRef& ope
 	if(operationType == MutationRef::SetVersionstampedKey) {
 		KeyRangeRef range = getVersionstampKeyRange(arena, k, getMaxReadKey()); // this does validation of the key and needs to be performed before the readYourWritesDisabled path
 		if(!options.readYourWritesDisabled) {
+			materializeWrites();
 			writeRangeToNativeTransaction(range);
 			writes.addUnmodifiedAndUnreadableRange(range);
 		}
@@ -1522,10 +1583,13 @@ void ReadYourWritesTransaction::atomicOp( const KeyRef& key, const ValueRef& ope
 			throw client_invalid_operation();
 	}
 
+	approximateSize += k.expectedSize() + v.expectedSize() + (addWriteConflict ? 2 * k.expectedSize() + 1 : 0);
+
 	if(options.readYourWritesDisabled) {
 		return tr.atomicOp(k, v, (MutationRef::Type) operationType, addWriteConflict);
 	}
 
+	materializeWrites();
 	writes.mutate(k, (MutationRef::Type) operationType, v, addWriteConflict);
 	RYWImpl::triggerWatches(this, k, Optional<ValueRef>(), false);
 }
@@ -1549,6 +1613,8 @@ void ReadYourWritesTransaction::set( const KeyRef& key, const ValueRef& value )
 	if(key >= getMaxWriteKey())
 		throw key_outside_legal_range();
 
+	approximateSize += key.expectedSize() + value.expectedSize() + (addWriteConflict ? 2 * key.expectedSize() + 1 : 0);
+
 	if(options.readYourWritesDisabled ) {
 		return tr.set(key, value, addWriteConflict);
 	}
@@ -1562,7 +1628,7 @@ void ReadYourWritesTransaction::set( const KeyRef& key, const ValueRef& value )
 	KeyRef k = KeyRef( arena, key );
 	ValueRef v = ValueRef( arena, value );
 
-	writes.mutate(k, MutationRef::SetValue, v, addWriteConflict);
+	deferredSets.push_back( DeferredSet( k, v, addWriteConflict ) );
 	RYWImpl::triggerWatches(this, key, value);
 }
 	
@@ -1577,6 +1643,8 @@ void ReadYourWritesTransaction::clear( const KeyRangeRef& range ) {
 	if(range.begin > maxKey || range.end > maxKey)
 		throw key_outside_legal_range();
 
+	approximateSize += (1 + addWriteConflict) * range.expectedSize();
+
 	if( options.readYourWritesDisabled ) {
 		return tr.clear(range, addWriteConflict);
 	}
@@ -1599,6 +1667,7 @@ void ReadYourWritesTransaction::clear( const KeyRangeRef& range ) {
 
 	r = KeyRangeRef( arena, r );
 
+	materializeWrites();
 	writes.clear(r, addWriteConflict);
 	RYWImpl::triggerWatches(this, r, Optional<ValueRef>());
 }
@@ -1616,6 +1685,8 @@ void ReadYourWritesTransaction::clear( const KeyRef& key ) {
 	if(key.size() > (key.startsWith(systemKeys.begin) ? CLIENT_KNOBS->SYSTEM_KEY_SIZE_LIMIT : CLIENT_KNOBS->KEY_SIZE_LIMIT))
 		return;
 
+	approximateSize += key.expectedSize() + (addWriteConflict ? 2 * key.expectedSize() + 1 : 0);
+
 	if( options.readYourWritesDisabled ) {
 		return tr.clear(key, addWriteConflict);
 	}
@@ -1623,6 +1694,7 @@ void ReadYourWritesTransaction::clear( const KeyRef& key ) {
 	KeyRangeRef r = singleKeyRange( key, arena );
 
 	//SOMEDAY: add an optimized single key clear to write map
+	materializeWrites();
 	writes.clear(r, addWriteConflict);
 
 	RYWImpl::triggerWatches(this, r, Optional<ValueRef>());
@@ -1675,12 +1747,15 @@ void ReadYourWritesTransaction::addWriteConflictRange( KeyRangeRef const& keys )
 		return;
 	}
 
+	approximateSize += r.expectedSize();
+
 	if(options.readYourWritesDisabled) {
 		tr.addWriteConflictRange(r);
 		return;
 	}
 
 	r = KeyRangeRef( arena, r );
+	materializeWrites();
 	writes.addConflictRange(r);
 }
 
@@ -1691,7 +1766,25 @@ Future<Void> ReadYourWritesTransaction::commit() {
 
 	if( resetPromise.isSet() )
 		return resetPromise.getFuture().getError();
-	
+
+	// A transaction with nothing to write cannot conflict and needs no proxy round trip, so commit it
+	// synchronously without building a commit request.  All writes pass through the WriteMap or the
+	// deferred set buffer when read-your-writes is enabled, so checking them (and that no reads or
+	// watches are outstanding) is sufficient to know the native transaction is empty.
+	if( !options.readYourWritesDisabled && reading.isReady() && !reading.isError() && writes.empty() && deferredSets.empty() && tr.watches.empty() ) {
+		TEST(true); // Elided commit of read-only transaction
+		++tr.getDatabase()->transactionsCommitElided;
+		commitStarted = true;
+		Future<Void> committed = tr.commitMutations();
+		ASSERT( committed.isReady() && !committed.isError() ); // An empty native transaction commits immediately
+		tr.reset();
+		debugLogRetries();
+		if( !tr.apiVersionAtLeast(410) ) {
+			reset();
+		}
+		return Void();
+	}
+
 	return RYWImpl::commit( this );
 }
 
@@ -1708,7 +1801,7 @@ void ReadYourWritesTransaction::setOption( FDBTransactionOptions::Option option,
 		case FDBTransactionOptions::READ_YOUR_WRITES_DISABLE:
 			validateOptionValue(value, false);
 
-			if (!reading.isReady() || !cache.empty() || !writes.empty())
+			if (!reading.isReady() || !cache.empty() || !writes.empty() || !deferredSets.empty())
 				throw client_invalid_operation();
 
 			options.readYourWritesDisabled = true;
@@ -1782,6 +1875,7 @@ void ReadYourWritesTransaction::setOption( FDBTransactionOptions::Option option,
 void ReadYourWritesTransaction::operator=(ReadYourWritesTransaction&& r) noexcept(true) {
 	cache = std::move( r.cache );
 	writes = std::move( r.writes );
+	deferredSets = std::move( r.deferredSets );
 	arena = std::move( r.arena );
 	tr = std::move( r.tr );
 	readConflicts = std::move( r.readConflicts );
@@ -1794,6 +1888,7 @@ void ReadYourWritesTransaction::operator=(ReadYourWritesTransaction&& r) noexcep
 	timeoutActor = r.timeoutActor;
 	creationTime = r.creationTime;
 	commitStarted = r.commitStarted;
+	approximateSize = r.approximateSize;
 	options = r.options;
 	transactionDebugInfo = r.transactionDebugInfo;
 	cache.arena = &arena;
@@ -1802,8 +1897,9 @@ void ReadYourWritesTransaction::operator=(ReadYourWritesTransaction&& r) noexcep
 
 ReadYourWritesTransaction::ReadYourWritesTransaction(ReadYourWritesTransaction&& r) noexcept(true) :
 	cache( std::move(r.cache) ),
-	writes( std::move(r.writes) ), 
-	arena( std::move(r.arena) ), 
+	writes( std::move(r.writes) ),
+	deferredSets( std::move(r.deferredSets) ),
+	arena( std::move(r.arena) ),
 	reading( std::move(r.reading) ),
 	retries( r.retries ), 
 	creationTime( r.creationTime ), 
@@ -1811,6 +1907,7 @@ ReadYourWritesTransaction::ReadYourWritesTransaction(ReadYourWritesTransaction&&
 	timeoutActor( std::move(r.timeoutActor) ),
 	resetPromise( std::move(r.resetPromise) ),
 	commitStarted( r.commitStarted ),
+	approximateSize( r.approximateSize ),
 	options( r.options ),
 	transactionDebugInfo( r.transactionDebugInfo )
 {
@@ -1834,10 +1931,12 @@ void ReadYourWritesTransaction::resetRyow() {
 	arena = Arena();
 	cache = SnapshotCache(&arena);
 	writes = WriteMap(&arena);
+	deferredSets.clear();
 	readConflicts = CoalescedKeyRefRangeMap<bool>();
 	watchMap.clear();
 	reading = AndFuture();
 	commitStarted = false;
+	approximateSize = 0;
 
 	deferredError = Error();
 
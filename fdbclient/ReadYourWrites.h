@@ -89,6 +89,15 @@ public:
 
 	Future< Standalone<VectorRef<const char*>> > getAddressesForKey(const Key& key);
 
+	// Exact row count and key+value byte sum of the range at the read version, computed entirely on
+	// the storage servers.  Snapshot read; uncommitted writes in this transaction are not folded in.
+	Future< RangeAggregate > getRangeAggregate( const KeyRange& keys );
+
+	// Estimated byte size of the range, answered from the storage servers' byte samples rather
+	// than by scanning; uncommitted writes in this transaction are not reflected.  Snapshot
+	// read: adds no read conflict range.
+	Future< int64_t > getEstimatedRangeSizeBytes( const KeyRange& keys );
+
 	void addReadConflictRange( KeyRangeRef const& keys );
 	void makeSelfConflicting() { tr.makeSelfConflicting(); }
 
@@ -103,6 +112,12 @@ public:
 
 	Future<Void> commit();
 	Version getCommittedVersion() { return tr.getCommittedVersion(); }
+
+	// An estimate of the size of the commit request this transaction will send, maintained
+	// incrementally as mutations and conflict ranges are added so batching layers can pack
+	// transactions against the transaction size limit in O(1) per check
+	int64_t getApproximateSize() const { return approximateSize; }
+
 	Future<Standalone<StringRef>> getVersionstamp();
 
 	void setOption( FDBTransactionOptions::Option option, Optional<StringRef> value = Optional<StringRef>() );
@@ -140,6 +155,19 @@ private:
 	Transaction tr;
 	SnapshotCache cache;
 	WriteMap writes;
+
+	// Sets are buffered here and only applied to the searchable WriteMap when a read, clear, or
+	// atomic op needs read-your-writes semantics, so set()-only transactions pay a flat append per
+	// write and build their write conflict ranges at commit time.  The buffer is always newer than
+	// everything in the WriteMap, so commit flushes the WriteMap first and then the buffer.
+	struct DeferredSet {
+		KeyRef key;
+		ValueRef value;
+		bool addWriteConflict;
+
+		DeferredSet( KeyRef const& key, ValueRef const& value, bool addWriteConflict ) : key(key), value(value), addWriteConflict(addWriteConflict) {}
+	};
+	std::vector<DeferredSet> deferredSets;
 	CoalescedKeyRefRangeMap<bool> readConflicts;
 	Map<Key, std::vector<Reference<Watch>>> watchMap;                      // Keys that are being watched in this transaction
 	Promise<Void> resetPromise;
@@ -148,6 +176,7 @@ private:
 	Future<Void> timeoutActor;
 	double creationTime;
 	bool commitStarted;
+	int64_t approximateSize;
 
 	Reference<TransactionDebugInfo> transactionDebugInfo;
 
@@ -155,6 +184,7 @@ private:
 	void updateConflictMap( KeyRangeRef const& keys, WriteMap::iterator& it ); // pre: it.segmentContains(keys.begin), keys are already inside this->arena
 	void writeRangeToNativeTransaction( KeyRangeRef const& keys );
 
+	void materializeWrites(); // applies deferredSets to the WriteMap, in order
 	void resetRyow(); // doesn't reset the encapsulated transaction, or creation time/retry state
 	KeyRef getMaxReadKey();
 	KeyRef getMaxWriteKey();
@@ -132,7 +132,8 @@ const KeyRef JSONSchemas::statusSchema = LiteralStringRef(R"statusSchema(
                "available_bytes":0,
                "limit_bytes":0,
                "unused_allocated_memory":0,
-               "used_bytes":0
+               "used_bytes":0,
+               "fast_allocations_hz":0.0
             },
             "messages":[
                {
@@ -176,6 +177,7 @@ const KeyRef JSONSchemas::statusSchema = LiteralStringRef(R"statusSchema(
             "cpu":{
                "usage_cores":0.0
             },
+            "run_loop_busy":0.2,
             "network":{
                "current_connections":0,
                "connections_established":{
@@ -261,6 +263,32 @@ const KeyRef JSONSchemas::statusSchema = LiteralStringRef(R"statusSchema(
          "transaction_start_seconds":0.0,
          "commit_seconds":0.02
       },
+      "continuous_latency_probes":{
+         "$map":{
+            "datacenter_id":"mr",
+            "grv":{
+               "samples":100,
+               "median_seconds":0.002,
+               "p99_seconds":0.01,
+               "p999_seconds":0.05,
+               "max_seconds":0.1
+            },
+            "read":{
+               "samples":100,
+               "median_seconds":0.002,
+               "p99_seconds":0.01,
+               "p999_seconds":0.05,
+               "max_seconds":0.1
+            },
+            "commit":{
+               "samples":100,
+               "median_seconds":0.005,
+               "p99_seconds":0.02,
+               "p999_seconds":0.1,
+               "max_seconds":0.2
+            }
+         }
+      },
       "clients":{
          "count":1,
          "supported_versions":[
@@ -0,0 +1,99 @@
+/*
+ * ShardedCounter.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBCLIENT_SHARDEDCOUNTER_H
+#define FDBCLIENT_SHARDEDCOUNTER_H
+#pragma once
+
+#include "fdbclient/ReadYourWrites.h"
+#include "fdbclient/Subspace.h"
+#include "fdbclient/Knobs.h"
+
+// A durable counter whose adds scatter over many sub-keys instead of serializing on one hot key.
+// An AddValue against a single key commits in parallel on the proxies but applies serially at the
+// storage team owning that key; spreading the adds over sub-keys spreads that work over as many
+// teams as the key range has shards.
+//
+// Each add lands on a randomly chosen sub-key of the counter's prefix, and the sub-key population
+// adapts to this client's observed add rate: a mostly idle counter stays a single key while a hot
+// one fans out, up to SHARDED_COUNTER_MAX_SHARDS.  Readers never need to know the fan-out, they
+// just sum a small range read of the prefix, so every writer can adapt independently.
+//
+// Adds are atomic ops and take no read conflict ranges; reading the total conflicts with
+// concurrent adds like any read of a mutated key range would, so frequent readers should read at
+// snapshot isolation.
+class ShardedCounter {
+public:
+	explicit ShardedCounter(KeyRef const& prefix) : space(prefix), shards(1), addsInWindow(0), windowStart(0) {}
+
+	// Atomically adds delta to the counter
+	void add(Reference<ReadYourWritesTransaction> tr, int64_t delta) {
+		adapt();
+		tr->atomicOp( space.pack( (int64_t)g_random->randomInt(0, shards) ), StringRef( (const uint8_t*)&delta, sizeof(delta) ), MutationRef::AddValue );
+	}
+
+	// Sum of all sub-keys.  Bounded by SHARDED_COUNTER_MAX_SHARDS small values, so this is a
+	// single range read.
+	Future<int64_t> getTotal(Reference<ReadYourWritesTransaction> tr, bool snapshot = false) const {
+		return map( tr->getRange( space.range(), CLIENT_KNOBS->SHARDED_COUNTER_MAX_SHARDS + 1, snapshot ), [](Standalone<RangeResultRef> const &kvs) -> int64_t {
+			int64_t total = 0;
+			for(int i = 0; i < kvs.size(); i++) {
+				int64_t part = 0;
+				memcpy( &part, kvs[i].value.begin(), std::min<int>(kvs[i].value.size(), sizeof(part)) );
+				total += part;
+			}
+			return total;
+		});
+	}
+
+	// Resets the counter to zero
+	void clear(Reference<ReadYourWritesTransaction> tr) {
+		tr->clear( space.range() );
+	}
+
+	Subspace space;
+
+private:
+	// Retarget the fan-out from the add rate this client has seen over the last adaptation
+	// window.  Shrinking is as safe as growing since readers always sum the whole prefix; the
+	// leftover sub-keys just stop being touched.
+	void adapt() {
+		if( windowStart == 0 )
+			windowStart = now();
+		++addsInWindow;
+		double elapsed = now() - windowStart;
+		if( elapsed > CLIENT_KNOBS->SHARDED_COUNTER_ADAPT_INTERVAL ) {
+			int target = std::max<int>( 1, std::min<double>( CLIENT_KNOBS->SHARDED_COUNTER_MAX_SHARDS, addsInWindow / elapsed / CLIENT_KNOBS->SHARDED_COUNTER_ADDS_PER_SHARD ) );
+			if( target > shards )
+				TEST(true);  // Sharded counter fanned out under write load
+			if( target < shards )
+				TEST(true);  // Sharded counter fan-out shrank after load dropped
+			shards = target;
+			addsInWindow = 0;
+			windowStart = now();
+		}
+	}
+
+	int shards;             // current fan-out for this client's adds
+	int64_t addsInWindow;
+	double windowStart;
+};
+
+#endif
@@ -28,6 +28,21 @@
 // Trailing whitespace in s is allowed
 json_spirit::mValue readJSONStrictly(const std::string &s);
 
+// Status documents are delta encoded between the cluster controller and monitoring clients at the
+// granularity of the document's top level members (see StatusRequest in ClusterInterface.h).
+// These helpers split an object's JSON text into members without fully parsing it.
+
+// Splits the text of a JSON object into its top level members, each a (name, text) pair where name
+// is the member's name token including quotes and text is the full '"name":value' member text.
+// Returns false, leaving sections in an unspecified state, if text is not a JSON object.
+bool splitJsonObjectText(const std::string &text, std::vector<std::pair<std::string, std::string>> *sections);
+
+// Reassembles member texts produced by splitJsonObjectText() into an object's JSON text
+std::string joinJsonObjectText(std::vector<std::pair<std::string, std::string>> const &sections);
+
+// Hash of a section's text, used to identify sections a client already has
+uint64_t hashJsonText(const std::string &text);
+
 struct StatusObject : json_spirit::mObject {
 	typedef json_spirit::mObject Map;
 	typedef json_spirit::mArray Array;
@@ -28,6 +28,7 @@
 #include "fdbclient/json_spirit/json_spirit_writer_template.h"
 #include "fdbclient/json_spirit/json_spirit_reader_template.h"
 #include "fdbrpc/genericactors.actor.h"
+#include "flow/Hash3.h"
 
 json_spirit::mValue readJSONStrictly(const std::string &s) {
 	json_spirit::mValue val;
@@ -53,6 +54,94 @@ json_spirit::mValue readJSONStrictly(const std::string &s) {
 	return val;
 }
 
+bool splitJsonObjectText(const std::string &text, std::vector<std::pair<std::string, std::string>> *sections) {
+	sections->clear();
+
+	size_t i = 0;
+	auto skipWhitespace = [&]() { while(i < text.size() && isspace(text[i])) ++i; };
+
+	skipWhitespace();
+	if(i >= text.size() || text[i++] != '{')
+		return false;
+	skipWhitespace();
+
+	while(i < text.size() && text[i] != '}') {
+		// Member name token, including the quotes.  It is only used as an opaque key so escape
+		// sequences are left as-is.
+		size_t memberStart = i;
+		if(text[i++] != '"')
+			return false;
+		while(i < text.size() && text[i] != '"') {
+			if(text[i] == '\\')
+				++i;
+			++i;
+		}
+		if(i >= text.size())
+			return false;
+		std::string name = text.substr(memberStart, ++i - memberStart);
+
+		skipWhitespace();
+		if(i >= text.size() || text[i++] != ':')
+			return false;
+
+		// Scan the member's value without parsing it, tracking only strings and nesting depth
+		int depth = 0;
+		bool inString = false;
+		while(i < text.size()) {
+			char c = text[i];
+			if(inString) {
+				if(c == '\\')
+					++i;
+				else if(c == '"')
+					inString = false;
+			}
+			else if(c == '"')
+				inString = true;
+			else if(c == '{' || c == '[')
+				++depth;
+			else if(c == '}' || c == ']') {
+				if(depth == 0)
+					break;
+				--depth;
+			}
+			else if(c == ',' && depth == 0)
+				break;
+			++i;
+		}
+		if(i >= text.size() || depth != 0 || inString)
+			return false;
+
+		sections->push_back(std::make_pair(name, text.substr(memberStart, i - memberStart)));
+
+		if(text[i] == ',') {
+			++i;
+			skipWhitespace();
+			if(i >= text.size() || text[i] != '"')
+				return false;
+		}
+	}
+
+	return i < text.size() && text[i] == '}';
+}
+
+std::string joinJsonObjectText(std::vector<std::pair<std::string, std::string>> const &sections) {
+	std::string text = "{";
+	for(int i = 0; i < sections.size(); i++) {
+		if(i > 0)
+			text += ",";
+		text += sections[i].second;
+	}
+	text += "}";
+	return text;
+}
+
+uint64_t hashJsonText(const std::string &text) {
+	uint32_t part1 = 0x8fc549cc;
+	uint32_t part2 = 0x52ea9c4c;
+	hashlittle2(text.data(), text.size(), &part1, &part2);
+	return ((uint64_t)part1 << 32) | part2;
+}
+
 uint64_t JSONDoc::expires_reference_version = std::numeric_limits<uint64_t>::max();
 
 // Template specializations for mergeOperator
@@ -357,12 +446,70 @@ ACTOR Future<StatusObject> clientStatusFetcher(Reference<ClusterConnectionFile>
 	return statusObj;
 }
 
+// The sections of the last status document received from the cluster controller, used to request
+// and decode delta encoded status replies (see StatusRequest in ClusterInterface.h).  One cache is
+// kept per process; a process polling more than one cluster just gets full documents whenever the
+// controller identity changes.
+struct StatusSectionCache {
+	UID controller;
+	std::vector<std::pair<std::string, uint64_t>> sectionHashes;
+	std::map<std::string, std::string> sectionText;
+};
+static StatusSectionCache statusSectionCache;
+
+// Rebuilds the full document text from a delta reply and the cached sections, returning false if
+// the cache doesn't contain an unchanged section with the expected hash (for example because
+// another status fetch replaced the cache while this one was in flight).
+static bool reassembleStatusDelta(StatusReply const& reply, std::string *text) {
+	std::map<std::string, std::string> changed(reply.changedSections.begin(), reply.changedSections.end());
+	std::vector<std::pair<std::string, std::string>> sections;
+
+	for (auto const& sh : reply.sectionHashes) {
+		auto c = changed.find(sh.first);
+		if (c != changed.end())
+			sections.push_back(*c);
+		else {
+			auto cached = statusSectionCache.sectionText.find(sh.first);
+			if (cached == statusSectionCache.sectionText.end() || hashJsonText(cached->second) != sh.second)
+				return false;
+			sections.push_back(*cached);
+		}
+	}
+
+	*text = joinJsonObjectText(sections);
+
+	statusSectionCache.sectionHashes = reply.sectionHashes;
+	statusSectionCache.sectionText.clear();
+	for (auto& s : sections)
+		statusSectionCache.sectionText[s.first] = std::move(s.second);
+
+	return true;
+}
+
+// Replaces the cached sections with those of a newly received full document
+static void cacheStatusSections(std::string const& statusStr) {
+	std::vector<std::pair<std::string, std::string>> sections;
+	statusSectionCache.sectionHashes.clear();
+	statusSectionCache.sectionText.clear();
+	if (splitJsonObjectText(statusStr, &sections)) {
+		for (auto& s : sections) {
+			statusSectionCache.sectionHashes.push_back(std::make_pair(s.first, hashJsonText(s.second)));
+			statusSectionCache.sectionText[s.first] = std::move(s.second);
+		}
+	}
+}
+
 // Cluster section of json output
 ACTOR Future<Optional<StatusObject>> clusterStatusFetcher(ClusterInterface cI, StatusArray *messages) {
 	state StatusRequest req;
 	state Future<Void> clusterTimeout = delay(30.0);
 	state Optional<StatusObject> oStatusObj;
 
+	if (statusSectionCache.controller == cI.id())
+		req.knownSections = statusSectionCache.sectionHashes;
+	else
+		statusSectionCache = StatusSectionCache();
+
 	wait(delay(0.0)); //make sure the cluster controller is marked as not failed
 
 	state Future<ErrorOr<StatusReply>> statusReply = cI.databaseStatus.tryGetReply(req);
@@ -371,13 +518,35 @@ ACTOR Future<Optional<StatusObject>> clusterStatusFetcher(ClusterInterface cI, S
 			when(ErrorOr<StatusReply> result = wait(statusReply)){
 				if (result.isError()){
 					if (result.getError().code() == error_code_request_maybe_delivered)
-						messages->push_back(makeMessage("unreachable_cluster_controller", 
+						messages->push_back(makeMessage("unreachable_cluster_controller",
 							("Unable to communicate with the cluster controller at " + cI.address().toString() + " to get status.").c_str()));
 					else
 						messages->push_back(makeMessage("status_incomplete_error", "Cluster encountered an error fetching status."));
 				}
+				else if (result.get().delta) {
+					std::string statusStr;
+					if (reassembleStatusDelta(result.get(), &statusStr)) {
+						statusSectionCache.controller = cI.id();
+						json_spirit::mValue mv;
+						if (g_network->isSimulated()) {
+							mv = readJSONStrictly(statusStr);
+						}
+						else {
+							// In non-simulation allow errors because some status data is better than no status data
+							json_spirit::read_string(statusStr, mv);
+						}
+						oStatusObj = StatusObject(mv.get_obj());
+					}
+					else {
+						// Throw away the cache so that the next request fetches a full document
+						statusSectionCache = StatusSectionCache();
+						messages->push_back(makeMessage("status_incomplete_error", "Cluster encountered an error fetching status."));
+					}
+				}
 				else {
 					oStatusObj = result.get().statusObj;
+					cacheStatusSections(result.get().statusStr);
+					statusSectionCache.controller = cI.id();
 				}
 				break;
 			}
@@ -97,13 +97,14 @@ struct ServerCacheInfo {
 
 struct GetValueReply : public LoadBalancedReply {
 	Optional<Value> value;
+	Version version; // the version the read was actually performed at; useful when a sentinel version was requested
 
-	GetValueReply() {}
-	GetValueReply(Optional<Value> value) : value(value) {}
+	GetValueReply() : version(invalidVersion) {}
+	GetValueReply(Optional<Value> value) : value(value), version(invalidVersion) {}
 
 	template <class Ar>
 	void serialize( Ar& ar ) {
-		ar & *(LoadBalancedReply*)this & value;
+		ar & *(LoadBalancedReply*)this & value & version;
 	}
 };
 
@@ -141,12 +142,17 @@ struct WatchValueRequest {
 struct GetKeyValuesReply : public LoadBalancedReply {
 	Arena arena;
 	VectorRef<KeyValueRef> data;
+	VectorRef<int32_t> prefixLengths; // if nonempty, 1:1 with data; data[i].key omits this many leading bytes shared with the previous row's full key
 	Version version; // useful when latestVersion was requested
 	bool more;
+	int64_t aggregateRows;   // for aggregateOnly requests: rows in the requested range within this shard
+	int64_t aggregateBytes;  // for aggregateOnly requests: sum of key and value bytes of those rows
+
+	GetKeyValuesReply() : aggregateRows(0), aggregateBytes(0) {}
 
 	template <class Ar>
 	void serialize( Ar& ar ) {
-		ar & *(LoadBalancedReply*)this & data & version & more & arena;
+		ar & *(LoadBalancedReply*)this & data & version & more & prefixLengths & aggregateRows & aggregateBytes & arena;
 	}
 };
 
@@ -155,14 +161,16 @@ struct GetKeyValuesRequest {
 	KeySelectorRef begin, end;
 	Version version;		// or latestVersion
 	int limit, limitBytes;
+	bool prefixCompressed;  // if true, the reply's keys are prefix compressed (see GetKeyValuesReply::prefixLengths)
+	bool aggregateOnly;     // if true, the server scans the whole range (in limit/limitBytes sized batches) and replies with only aggregateRows/aggregateBytes
 	Optional<UID> debugID;
 	ReplyPromise<GetKeyValuesReply> reply;
 
-	GetKeyValuesRequest() {}
+	GetKeyValuesRequest() : prefixCompressed(false), aggregateOnly(false) {}
 //	GetKeyValuesRequest(const KeySelectorRef& begin, const KeySelectorRef& end, Version version, int limit, int limitBytes, Optional<UID> debugID) : begin(begin), end(end), version(version), limit(limit), limitBytes(limitBytes) {}
 	template <class Ar>
 	void serialize( Ar& ar ) {
-		ar & begin & end & version & limit & limitBytes & debugID & reply & arena;
+		ar & begin & end & version & limit & limitBytes & prefixCompressed & aggregateOnly & debugID & reply & arena;
 	}
 };
 
@@ -225,6 +225,24 @@ public:
 		return task;
 	}
 
+	// Claim up to maxTasks tasks in a single transaction.  Each claim probes a new random UID, and
+	// since claimed tasks are cleared from the available keyspace within this transaction the
+	// probes do not find the same task twice.  One batch claim replaces maxTasks individual claim
+	// transactions that could conflict with each other over the same tasks and over the timeouts
+	// keyspace read by requeueTimedOutTasks.
+	ACTOR static Future<std::vector<Reference<Task>>> getSome(Reference<ReadYourWritesTransaction> tr, Reference<TaskBucket> taskBucket, int maxTasks) {
+		state std::vector<Reference<Task>> tasks;
+
+		while((int)tasks.size() < maxTasks) {
+			Reference<Task> task = wait(getOne(tr, taskBucket));
+			if(!task)
+				break;
+			tasks.push_back(task);
+		}
+
+		return tasks;
+	}
+
 	// Verify that the user configured task verification key still has the user specificied value
 	ACTOR static Future<bool> taskVerify(Reference<TaskBucket> tb, Reference<ReadYourWritesTransaction> tr, Reference<Task> task) {
 
@@ -420,32 +438,35 @@ public:
 		for(int i = 0; i < tasks.size(); ++i)
 			availableSlots.push_back(i);
 
-		state std::vector<Future<Reference<Task>>> getTasks;
 		state unsigned int getBatchSize = 1;
 
 		loop {
 			// Start running tasks while slots are available and we keep finding work to do
 			while(!availableSlots.empty()) {
-				getTasks.clear();
-				for(int i = 0, imax = std::min<unsigned int>(getBatchSize, availableSlots.size()); i < imax; ++i)
-					getTasks.push_back(taskBucket->getOne(cx));
-				wait(waitForAllReady(getTasks));
-
-				bool done = false;
-				for(int i = 0; i < getTasks.size(); ++i) {
-					if(getTasks[i].isError()) {
-						done = true;
-						continue;
-					}
-					Reference<Task> task = getTasks[i].get();
-					if(task) {
-						// Start the task
-						int slot = availableSlots.back();
-						availableSlots.pop_back();
-						tasks[slot] = taskBucket->doTask(cx, futureBucket, task);
-					}
-					else
-						done = true;
+				// Claim a batch of tasks in one transaction instead of one transaction per task, so
+				// concurrent dispatchers do not conflict with themselves over the tasks they probe
+				state int wanted = std::min<unsigned int>(getBatchSize, availableSlots.size());
+				state std::vector<Reference<Task>> newTasks;
+				state bool done = false;
+				newTasks.clear();
+				try {
+					std::vector<Reference<Task>> claimed = wait(taskBucket->getSome(cx, wanted));
+					newTasks = claimed;
+				} catch(Error &e) {
+					if(e.code() == error_code_actor_cancelled)
+						throw;
+					done = true;
+				}
+
+				// A short batch means the bucket ran out of available tasks
+				if((int)newTasks.size() < wanted)
+					done = true;
+
+				for(int i = 0; i < newTasks.size(); ++i) {
+					// Start the task
+					int slot = availableSlots.back();
+					availableSlots.pop_back();
+					tasks[slot] = taskBucket->doTask(cx, futureBucket, newTasks[i]);
 				}
 
 				if(done) {
@@ -866,6 +887,10 @@ Future<Reference<Task>> TaskBucket::getOne(Reference<ReadYourWritesTransaction>
 	return TaskBucketImpl::getOne(tr, Reference<TaskBucket>::addRef(this));
 }
 
+Future<std::vector<Reference<Task>>> TaskBucket::getSome(Reference<ReadYourWritesTransaction> tr, int maxTasks) {
+	return TaskBucketImpl::getSome(tr, Reference<TaskBucket>::addRef(this), maxTasks);
+}
+
 Future<bool> TaskBucket::doOne(Database cx, Reference<FutureBucket> futureBucket) {
 	return TaskBucketImpl::doOne(cx, Reference<TaskBucket>::addRef(this), futureBucket);
 }
@@ -153,6 +153,12 @@ public:
 		return runRYWTransaction(cx, [=](Reference<ReadYourWritesTransaction> tr){ return getOne(tr); });
 	}
 
+	// Claim up to maxTasks tasks in a single transaction
+	Future<std::vector<Reference<Task>>> getSome(Reference<ReadYourWritesTransaction> tr, int maxTasks);
+	Future<std::vector<Reference<Task>>> getSome(Database cx, int maxTasks) {
+		return runRYWTransaction(cx, [=](Reference<ReadYourWritesTransaction> tr){ return getSome(tr, maxTasks); });
+	}
+
 	Future<bool> doTask(Database cx, Reference<FutureBucket> futureBucket, Reference<Task> task);
 
 	Future<bool> doOne(Database cx, Reference<FutureBucket> futureBucket);
@@ -166,6 +166,36 @@ ThreadFuture<Standalone<VectorRef<const char*>>> ThreadSafeTransaction::getAddre
 	} );
 }
 
+ThreadFuture<int64_t> ThreadSafeTransaction::getRangeRowCount( const KeyRangeRef& keys ) {
+	KeyRange r = keys;
+
+	ReadYourWritesTransaction *tr = this->tr;
+	return onMainThread( [tr, r]() -> Future<int64_t> {
+		tr->checkDeferredError();
+		return map( tr->getRangeAggregate(r), [](RangeAggregate const& a) { return a.rows; } );
+	} );
+}
+
+ThreadFuture<int64_t> ThreadSafeTransaction::getRangeByteSum( const KeyRangeRef& keys ) {
+	KeyRange r = keys;
+
+	ReadYourWritesTransaction *tr = this->tr;
+	return onMainThread( [tr, r]() -> Future<int64_t> {
+		tr->checkDeferredError();
+		return map( tr->getRangeAggregate(r), [](RangeAggregate const& a) { return a.bytes; } );
+	} );
+}
+
+ThreadFuture<int64_t> ThreadSafeTransaction::getEstimatedRangeSizeBytes( const KeyRangeRef& keys ) {
+	KeyRange r = keys;
+
+	ReadYourWritesTransaction *tr = this->tr;
+	return onMainThread( [tr, r]() -> Future<int64_t> {
+		tr->checkDeferredError();
+		return tr->getEstimatedRangeSizeBytes(r);
+	} );
+}
+
 void ThreadSafeTransaction::addReadConflictRange( const KeyRangeRef& keys) {
 	KeyRange r = keys;
 
@@ -252,6 +282,13 @@ Version ThreadSafeTransaction::getCommittedVersion() {
 	return v;
 }
 
+ThreadFuture<int64_t> ThreadSafeTransaction::getApproximateSize() {
+	ReadYourWritesTransaction *tr = this->tr;
+	return onMainThread([tr]() -> Future<int64_t> {
+		return tr->getApproximateSize();
+	});
+}
+
 ThreadFuture<Standalone<StringRef>> ThreadSafeTransaction::getVersionstamp() {
 	ReadYourWritesTransaction *tr = this->tr;
 	return onMainThread([tr]() -> Future < Standalone<StringRef> > {
@@ -72,6 +72,9 @@ public:
 	}
 
 	ThreadFuture<Standalone<VectorRef<const char*>>> getAddressesForKey(const KeyRef& key);
+	ThreadFuture<int64_t> getRangeRowCount( const KeyRangeRef& keys );
+	ThreadFuture<int64_t> getRangeByteSum( const KeyRangeRef& keys );
+	ThreadFuture<int64_t> getEstimatedRangeSizeBytes( const KeyRangeRef& keys );
 
 	void addReadConflictRange( const KeyRangeRef& keys );
 	void makeSelfConflicting();
@@ -88,6 +91,7 @@ public:
 
 	ThreadFuture<Void> commit();
 	Version getCommittedVersion();
+	ThreadFuture<int64_t> getApproximateSize();
 	ThreadFuture<Standalone<StringRef>> getVersionstamp();
 
 	void setOption( FDBTransactionOptions::Option option, Optional<StringRef> value = Optional<StringRef>() );
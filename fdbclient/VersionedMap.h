@@ -27,6 +27,8 @@
 #include "fdbclient/FDBTypes.h"
 #include "flow/IRandom.h"
 #include "fdbclient/VersionedMap.actor.h"
+#include <deque>
+#include <algorithm>
 
 // PTree is a persistent balanced binary tree implementation. It is based on a treap as a way to guarantee O(1) space for node insertion (rotating is asymptotically cheap), 
 // but the constant factors are very large.
@@ -206,13 +208,33 @@ namespace PTreeImpl {
 		return f.back()->data;
 	}
 
-	// Modifies p to point to a PTree with x inserted
+	// Modifies p to point to a PTree with x inserted.  If a node equal to x is already present its
+	// data is replaced in the same descent, so callers do not need a separate contains()/remove()
+	// pass before inserting.
 	template<class T>
 	void insert(Reference<PTree<T>>& p, Version at, const T& x) {
 		if (!p){
 			p = Reference<PTree<T>>(new PTree<T>(x, at));
 		} else {
 			bool direction = !(x < p->data);
+			if (direction && !(p->data < x)) {
+				// x is equal to p->data, so replace this node's data.  The children and priority are
+				// unchanged, so no rebalancing is needed.
+				if (p->lastUpdateVersion == at && !p->updated) {
+					// A node created at this version is not visible to any older version and can be
+					// updated in place
+					p->data = x;
+				} else {
+					Reference<PTree<T>> r( new PTree<T>( p->priority, x, p->child(0, at), p->child(1, at), at ) );
+					if (p->lastUpdateVersion == at) {
+						// The replaced node's aux pointer will never be used again and should drop
+						// its reference count
+						p->pointer[2].clear();
+					}
+					p = r;
+				}
+				return;
+			}
 			Reference<PTree<T>> child = p->child(direction, at);
 			insert(child, at, x);
 			p = update(p, direction, child, at);
@@ -474,11 +496,23 @@ public:
 	typedef Reference< PTreeT > Tree;
 
 	Version oldestVersion, latestVersion;
-	std::map<Version, Tree> roots;
-	Tree *latestRoot;
+
+	// Since createNewVersion must be called with monotonically increasing versions, the roots
+	// deque is sorted by version and can be binary searched.  Compared to a std::map this
+	// avoids a node allocation per version and frees forgotten versions by popping the front.
+	std::deque<std::pair<Version, Tree>> roots;
+
+	struct rootsComparator {
+		bool operator()(const std::pair<Version, Tree>& value, const Version& key) const {
+			return value.first < key;
+		}
+		bool operator()(const Version& key, const std::pair<Version, Tree>& value) const {
+			return key < value.first;
+		}
+	};
 
 	Tree const& getRoot( Version v ) const {
-		auto r = roots.upper_bound(v);
+		auto r = std::upper_bound(roots.begin(), roots.end(), v, rootsComparator());
 		--r;
 		return r->second;
 	}
@@ -487,36 +521,44 @@ public:
 	struct iterator;
 
 	VersionedMap() : oldestVersion(0), latestVersion(0) {
-		latestRoot = &roots[0];
+		roots.push_back(std::make_pair(0, Tree()));
 	}
 	VersionedMap( VersionedMap&& v ) noexcept(true) : oldestVersion(v.oldestVersion), latestVersion(v.latestVersion), roots(std::move(v.roots)) {
-		latestRoot = &roots[latestVersion];
 	}
 	void operator = (VersionedMap && v) noexcept(true) {
 		oldestVersion = v.oldestVersion;
 		latestVersion = v.latestVersion;
 		roots = std::move(v.roots);
-		latestRoot = &roots[latestVersion];
 	}
 
 	Version getLatestVersion() const { return latestVersion; }
 	Version getOldestVersion() const { return oldestVersion; }
-	Version getNextOldestVersion() const { return roots.upper_bound(oldestVersion)->first; }
+	Version getNextOldestVersion() const { return std::upper_bound(roots.begin(), roots.end(), oldestVersion, rootsComparator())->first; }
+
+	// Returns an iterator to the root at newOldestVersion, inserting one with the preceding
+	// version's tree if no root exists at exactly that version
+	std::deque<std::pair<Version, Tree>>::iterator getRootAt(Version newOldestVersion) {
+		auto upper = std::upper_bound(roots.begin(), roots.end(), newOldestVersion, rootsComparator());
+		auto r = upper;
+		--r;
+		if (r->first != newOldestVersion)
+			r = roots.insert(upper, std::make_pair(newOldestVersion, r->second));
+		ASSERT( r->first == newOldestVersion );
+		return r;
+	}
 
 	void forgetVersionsBefore(Version newOldestVersion) {
 		ASSERT( newOldestVersion <= latestVersion );
-		roots[newOldestVersion] = getRoot(newOldestVersion);
-		roots.erase(roots.begin(), roots.lower_bound(newOldestVersion));
+		roots.erase(roots.begin(), getRootAt(newOldestVersion));
 		oldestVersion = newOldestVersion;
 	}
 
 	Future<Void> forgetVersionsBeforeAsync( Version newOldestVersion, int taskID = 7000 ) {
 		ASSERT( newOldestVersion <= latestVersion );
-		roots[newOldestVersion] = getRoot(newOldestVersion);
 
 		vector<Tree> toFree;
 		toFree.reserve(10000);
-		auto newBegin = roots.lower_bound(newOldestVersion);
+		auto newBegin = getRootAt(newOldestVersion);
 		Tree *lastRoot = nullptr;
 		for(auto root = roots.begin(); root != newBegin; ++root) {
 			if(root->second) {
@@ -540,8 +582,7 @@ public:
 		if (version > latestVersion) {
 			latestVersion = version;
 			Tree r = getRoot(version);
-			latestRoot = &roots[version];
-			*latestRoot = r;
+			roots.push_back(std::make_pair(version, r));
 		} else ASSERT( version == latestVersion );
 	}
 
@@ -550,14 +591,13 @@ public:
 		insert( k, t, latestVersion );
 	}
 	void insert(const K& k, const T& t, Version insertAt) {
-		if (PTreeImpl::contains( *latestRoot, latestVersion, k )) PTreeImpl::remove( *latestRoot, latestVersion, k ); // FIXME: Make PTreeImpl::insert do this automatically  (see also WriteMap.h FIXME)
-		PTreeImpl::insert( *latestRoot, latestVersion, MapPair<K,std::pair<T,Version>>(k,std::make_pair(t,insertAt)) );
+		PTreeImpl::insert( roots.back().second, latestVersion, MapPair<K,std::pair<T,Version>>(k,std::make_pair(t,insertAt)) );
 	}
 	void erase(const K& begin, const K& end) {
-		PTreeImpl::remove( *latestRoot, latestVersion, begin, end );
+		PTreeImpl::remove( roots.back().second, latestVersion, begin, end );
 	}
 	void erase(const K& key ) {  // key must be present
-		PTreeImpl::remove( *latestRoot, latestVersion, key );
+		PTreeImpl::remove( roots.back().second, latestVersion, key );
 	}
 	void erase(iterator const& item) {  // iterator must be in latest version!
 		// SOMEDAY: Optimize to use item.finger and avoid repeated search
@@ -652,7 +692,7 @@ public:
 	};
 
 	ViewAtVersion at( Version v ) const { return ViewAtVersion(getRoot(v), v); }
-	ViewAtVersion atLatest() const { return ViewAtVersion(*latestRoot, latestVersion); }
+	ViewAtVersion atLatest() const { return ViewAtVersion(roots.back().second, latestVersion); }
 
 	// TODO: getHistory?
 
@@ -158,7 +158,6 @@ public:
 		} else {
 			if( !it.is_unreadable() && operation == MutationRef::SetValue ) {
 				it.tree.clear();
-				PTreeImpl::remove( writes, ver, key );
 				PTreeImpl::insert( writes, ver, WriteMapEntry( key, OperationStack( RYWMutation( param, operation ) ), is_cleared, following_conflict, is_conflict, following_unreadable, is_unreadable ) );
 			} else {
 				WriteMapEntry e( it.entry() );
@@ -173,7 +172,6 @@ public:
 					e.stack.push( RYWMutation( param, operation ) );
 				
 				it.tree.clear();
-				PTreeImpl::remove( writes, ver, e.key ); // FIXME: Make PTreeImpl::insert do this automatically (see also VersionedMap.h FIXME)
 				PTreeImpl::insert( writes, ver, std::move(e) );
 			}
 		}
@@ -251,13 +249,9 @@ public:
 		it.reset(writes, ver);
 		it.skip( keys.begin );
 
-		std::vector<ExtStringRef> removals;
 		std::vector<WriteMapEntry> insertions;
-		
+
 		if( !it.entry().following_keys_conflict || !it.entry().is_conflict ) {
-			if( it.keyAtBegin() && it.beginKey() == keys.begin ) {
-				removals.push_back( keys.begin );
-			}
 			insertions.push_back( WriteMapEntry( keys.begin, it.is_operation() ? OperationStack( it.op() ) : OperationStack(), it.entry().following_keys_cleared, true, true, it.entry().following_keys_unreadable, it.entry().is_unreadable ) );
 		}
 
@@ -267,7 +261,6 @@ public:
 				WriteMapEntry e( it.entry() );
 				e.following_keys_conflict = true;
 				e.is_conflict = true;
-				removals.push_back( e.key );
 				insertions.push_back( std::move(e) );
 			}
 		}
@@ -287,10 +280,6 @@ public:
 		it.tree.clear();
 
 		//SOMEDAY: optimize this code by having a PTree removal/insertion that takes and returns an iterator
-		for( int i = 0; i < removals.size(); i++ ) {
-			PTreeImpl::remove( writes, ver, removals[i] ); // FIXME: Make PTreeImpl::insert do this automatically (see also VersionedMap.h FIXME)
-		}
-
 		for( int i = 0; i < insertions.size(); i++ ) {
 			PTreeImpl::insert( writes, ver, std::move(insertions[i]) );
 		}
@@ -34,12 +34,32 @@ EvictablePage::~EvictablePage() {
 			aligned_free(data);
 	}
 	if (index > -1) {
-		pageCache->pages[index] = pageCache->pages.back();
-		pageCache->pages[index]->index = index;
-		pageCache->pages.pop_back();
+		auto& list = promoted ? pageCache->mainPages : pageCache->probationary;
+		list[index] = list.back();
+		list[index]->index = index;
+		list.pop_back();
+		if (fileStats) {
+			--fileStats->pagesInCache;
+			--pageCache->rolePages[fileStats->role];
+		}
 	}
 }
 
+static bool filenameEndsWith( const std::string& filename, const char* suffix ) {
+	size_t len = strlen(suffix);
+	return filename.size() >= len && filename.compare(filename.size() - len, len, suffix) == 0;
+}
+
+int PageCacheFileStats::roleFor( const std::string& filename ) {
+	// DiskQueue files back the tLog and memory storage commit paths, where an evicted page
+	// costs commit latency; sqlite files serve storage reads, which can scan far more data
+	if (filenameEndsWith(filename, ".fdq"))
+		return LogRole;
+	if (filenameEndsWith(filename, ".sqlite") || filenameEndsWith(filename, ".sqlite-wal"))
+		return StorageRole;
+	return OtherRole;
+}
+
 std::map< std::string, OpenFileInfo > AsyncFileCached::openFiles;
 
 void AsyncFileCached::remove_page( AFCPage* page ) {
@@ -75,6 +95,14 @@ Future<Reference<IAsyncFile>> AsyncFileCached::open_impl( std::string filename,
 	return open_impl(filename, flags, mode, pageCache);
 }
 
+Reference<EvictablePageCache> AsyncFileCached::getPageCache4k() {
+	return pc4k.present() ? pc4k.get() : Reference<EvictablePageCache>();
+}
+
+Reference<EvictablePageCache> AsyncFileCached::getPageCache64k() {
+	return pc64k.present() ? pc64k.get() : Reference<EvictablePageCache>();
+}
+
 Future<Void> AsyncFileCached::read_write_impl( AsyncFileCached* self, void* data, int length, int64_t offset, bool writing ) {
 	if (writing) {
 		if (offset + length > self->length)
@@ -95,8 +123,19 @@ Future<Void> AsyncFileCached::read_write_impl( AsyncFileCached* self, void* data
 		++self->countCacheFinds;
 		auto p = self->pages.find( pageOffset );
 		if ( p == self->pages.end() ) {
+			++self->countFileCacheMisses;
+			++self->countCacheMisses;
+			if ( !writing )
+				++self->pageCache->readMisses;
 			AFCPage* page = new AFCPage( self, pageOffset );
 			p = self->pages.insert( std::make_pair(pageOffset, page) ).first;
+		} else {
+			++self->countFileCacheHits;
+			++self->countCacheHits;
+			if ( !writing )
+				++self->pageCache->readHits;
+			if ( !self->sequential )
+				self->pageCache->promote( p->second );
 		}
 
 		int bytesInPage = std::min(self->pageCache->pageSize - offsetInPage, remaining);
@@ -131,8 +170,15 @@ Future<Void> AsyncFileCached::readZeroCopy( void** data, int* length, int64_t of
 
 	auto p = pages.find( offset );
 	if ( p == pages.end() ) {
+		++countFileCacheMisses;
+		++countCacheMisses;
 		AFCPage* page = new AFCPage( this, offset );
 		p = pages.insert( std::make_pair(offset, page) ).first;
+	} else {
+		++countFileCacheHits;
+		++countCacheHits;
+		if ( !sequential )
+			pageCache->promote( p->second );
 	}
 
 	*data = p->second->data;
@@ -34,42 +34,135 @@
 #include "flow/network.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
+// Per-file accounting shared by a file and its pages in an EvictablePageCache.  Reference counted
+// because pages can outlive their file (e.g. while a truncation is in flight) and still need to
+// update the counts safely.
+struct PageCacheFileStats : ReferenceCounted<PageCacheFileStats> {
+	// Which role's share of the cache a file's pages count against, so that on a host running
+	// both a tLog and a storage server the storage working set cannot evict DiskQueue pages
+	enum Role { OtherRole = 0, LogRole, StorageRole, ROLE_COUNT };
+
+	int64_t pagesInCache;  // pages of this file currently on the cache's probationary or main list
+	bool pinned;           // pages of this file are evicted only when no other page is evictable
+	int role;
+
+	PageCacheFileStats() : pagesInCache(0), pinned(false), role(OtherRole) {}
+
+	// The role a file's pages belong to, decided from its name at open time
+	static int roleFor( const std::string& filename );
+};
+
 struct EvictablePage {
 	void* data;
 	int index;
+	bool promoted; // in the cache's main list rather than the probationary list
 	class Reference<struct EvictablePageCache> pageCache;
+	Reference<PageCacheFileStats> fileStats;  // may be null for pages with no per-file accounting
 
 	virtual bool evict() = 0; // true if page was evicted, false if it isn't immediately evictable (but will be evicted regardless if possible)
 
-	EvictablePage(Reference<EvictablePageCache> pageCache) : data(0), index(-1), pageCache(pageCache) {}
+	EvictablePage(Reference<EvictablePageCache> pageCache) : data(0), index(-1), promoted(false), pageCache(pageCache) {}
 	virtual ~EvictablePage();
 };
 
 struct EvictablePageCache : ReferenceCounted<EvictablePageCache> {
-	EvictablePageCache() : pageSize(0), maxPages(0) {}
-	explicit EvictablePageCache(int pageSize, int64_t maxSize) : pageSize(pageSize), maxPages(maxSize / pageSize) {}
+	EvictablePageCache() : pageSize(0), maxPages(0), readHits(0), readMisses(0) {
+		memset(rolePages, 0, sizeof(rolePages));
+	}
+	explicit EvictablePageCache(int pageSize, int64_t maxSize) : pageSize(pageSize), maxPages(maxSize / pageSize), readHits(0), readMisses(0) {
+		memset(rolePages, 0, sizeof(rolePages));
+	}
 
 	void allocate(EvictablePage* page) {
 		try_evict();
 		try_evict();
 		page->data = pageSize == 4096 ? FastAllocator<4096>::allocate() : aligned_alloc(4096,pageSize);
-		page->index = pages.size();
-		pages.push_back(page);
+		page->index = probationary.size();
+		probationary.push_back(page);
+		if (page->fileStats) {
+			++page->fileStats->pagesInCache;
+			++rolePages[page->fileStats->role];
+		}
+	}
+
+	// Called when a cached page is found by another lookup.  Pages start probationary and are only
+	// promoted when referenced again, so a one-shot scan cannot displace the main list.
+	void promote(EvictablePage* page) {
+		if (page->promoted) return;
+		probationary[page->index] = probationary.back();
+		probationary[page->index]->index = page->index;
+		probationary.pop_back();
+		page->promoted = true;
+		page->index = mainPages.size();
+		mainPages.push_back(page);
 	}
 
 	void try_evict() {
-		if (pages.size() >= (uint64_t)maxPages && !pages.empty()) {
+		if (probationary.size() + mainPages.size() >= (uint64_t)maxPages) {
+			int64_t softQuotaPages = int64_t( maxPages * FLOW_KNOBS->PAGE_CACHE_FILE_SOFT_QUOTA_FRACTION );
 			for (int i = 0; i < FLOW_KNOBS->MAX_EVICT_ATTEMPTS; i++) { // If we don't manage to evict anything, just go ahead and exceed the cache limit
-				int toEvict = g_random->randomInt(0, pages.size());
-				if (pages[toEvict]->evict())
+				// Victims come from the probationary list while it has pages, so scans recycle their
+				// own pages instead of evicting pages which have been referenced more than once
+				std::vector<EvictablePage*>& victims = probationary.empty() ? mainPages : probationary;
+				if (victims.empty())
+					break;
+				EvictablePage* candidate = victims[ g_random->randomInt(0, victims.size()) ];
+				if (candidate->fileStats) {
+					// Pinned files are passed over, and the first half of the attempts also spare any
+					// file within its soft quota, so one busy file reclaims from itself before it can
+					// displace the working set of a quieter file sharing the cache
+					if (candidate->fileStats->pinned) {
+						TEST(true); // Page cache eviction skipped a pinned file
+						continue;
+					}
+					if (candidate->fileStats->pagesInCache <= softQuotaPages && i < FLOW_KNOBS->MAX_EVICT_ATTEMPTS/2) {
+						TEST(true); // Page cache eviction spared a file within its soft quota
+						continue;
+					}
+					// A file whose role is within its share of the cache is likewise spared, so one
+					// role can borrow another's share only while that share is idle - once the owning
+					// role fills it again, the borrower's pages are the ones evicted
+					if (rolePages[candidate->fileStats->role] <= roleBudgetPages(candidate->fileStats->role) && i < FLOW_KNOBS->MAX_EVICT_ATTEMPTS/2) {
+						TEST(true); // Page cache eviction spared a file whose role is within its budget
+						continue;
+					}
+				}
+				if (candidate->evict())
 					break;
 			}
 		}
 	}
 
-	std::vector<EvictablePage*> pages;
+	// Changes the cache size limit.  Shrinking evicts immediately so the memory is returned
+	// promptly; pages which cannot be evicted (dirty or being read) stop the loop and are given
+	// back as they become clean, since try_evict already tolerates exceeding the limit.
+	void setMaxSize(int64_t maxSize) {
+		maxPages = std::max<int64_t>(1, maxSize / pageSize);
+		size_t before;
+		do {
+			before = probationary.size() + mainPages.size();
+			try_evict();
+		} while (probationary.size() + mainPages.size() > (uint64_t)maxPages && probationary.size() + mainPages.size() < before);
+	}
+
+	int64_t getMaxSize() const { return maxPages * (int64_t)pageSize; }
+
+	// The share of the cache reserved for a role's files; roles without an explicit fraction
+	// split whatever the configured fractions leave over
+	int64_t roleBudgetPages(int role) const {
+		double fraction = role == PageCacheFileStats::LogRole ? FLOW_KNOBS->PAGE_CACHE_LOG_ROLE_FRACTION
+			: role == PageCacheFileStats::StorageRole ? FLOW_KNOBS->PAGE_CACHE_STORAGE_ROLE_FRACTION
+			: std::max(0.0, 1.0 - FLOW_KNOBS->PAGE_CACHE_LOG_ROLE_FRACTION - FLOW_KNOBS->PAGE_CACHE_STORAGE_ROLE_FRACTION);
+		return int64_t( maxPages * fraction );
+	}
+
+	std::vector<EvictablePage*> probationary;
+	std::vector<EvictablePage*> mainPages;
+	int64_t rolePages[PageCacheFileStats::ROLE_COUNT];  // pages currently cached for files of each role
 	int pageSize;
 	int64_t maxPages;
+	int64_t readHits;    // cumulative reads served from cached pages; read by the page cache tuning loop in worker.actor.cpp
+	int64_t readMisses;  // cumulative reads which had to fault a page in
 };
 
 struct OpenFileInfo : NonCopyable {
@@ -105,6 +198,11 @@ public:
 		return openFiles[filename].get();
 	}
 
+	// The process-wide page caches, if they have been created; null otherwise.  Used by the page
+	// cache tuning loop in worker.actor.cpp
+	static Reference<EvictablePageCache> getPageCache4k();
+	static Reference<EvictablePageCache> getPageCache64k();
+
 	virtual Future<int> read( void* data, int length, int64_t offset ) {
 		++countFileCacheReads;
 		++countCacheReads;
@@ -206,6 +304,8 @@ private:
 	std::unordered_map<int64_t, AFCPage*> pages;
 	std::vector<AFCPage*> flushable;
 	Reference<EvictablePageCache> pageCache;
+	Reference<PageCacheFileStats> fileStats;
+	bool sequential;  // pages of this file are never promoted out of the cache's probationary list
 	Future<Void> currentTruncate;
 	int64_t currentTruncateSize;
 
@@ -220,6 +320,9 @@ private:
 	Int64MetricHandle countFileCacheWritesBlocked;
 	Int64MetricHandle countFileCachePageReadsMerged;
 	Int64MetricHandle countFileCacheReadBytes;
+	Int64MetricHandle countFileCacheHits;
+	Int64MetricHandle countFileCacheMisses;
+	Int64MetricHandle countFileCachePagesEvicted;
 
 	Int64MetricHandle countCacheFinds;
 	Int64MetricHandle countCacheReads;
@@ -228,9 +331,14 @@ private:
 	Int64MetricHandle countCacheWritesBlocked;
 	Int64MetricHandle countCachePageReadsMerged;
 	Int64MetricHandle countCacheReadBytes;
-
-	AsyncFileCached( Reference<IAsyncFile> uncached, const std::string& filename, int64_t length, Reference<EvictablePageCache> pageCache ) 
-		: uncached(uncached), filename(filename), length(length), prevLength(length), pageCache(pageCache), currentTruncate(Void()), currentTruncateSize(0) {
+	Int64MetricHandle countCacheHits;
+	Int64MetricHandle countCacheMisses;
+	Int64MetricHandle countCachePagesEvicted;
+
+	AsyncFileCached( Reference<IAsyncFile> uncached, const std::string& filename, int64_t length, Reference<EvictablePageCache> pageCache, bool sequential, bool pinned )
+		: uncached(uncached), filename(filename), length(length), prevLength(length), pageCache(pageCache), fileStats(new PageCacheFileStats()), sequential(sequential), currentTruncate(Void()), currentTruncateSize(0) {
+		fileStats->pinned = pinned;
+		fileStats->role = PageCacheFileStats::roleFor(filename);
 		if( !g_network->isSimulated() ) {
 			countFileCacheWrites.init(         LiteralStringRef("AsyncFile.CountFileCacheWrites"), filename);
 			countFileCacheReads.init(          LiteralStringRef("AsyncFile.CountFileCacheReads"), filename);
@@ -239,6 +347,9 @@ private:
 			countFileCachePageReadsMerged.init(LiteralStringRef("AsyncFile.CountFileCachePageReadsMerged"), filename);
 			countFileCacheFinds.init(          LiteralStringRef("AsyncFile.CountFileCacheFinds"), filename);
 			countFileCacheReadBytes.init(      LiteralStringRef("AsyncFile.CountFileCacheReadBytes"), filename);
+			countFileCacheHits.init(           LiteralStringRef("AsyncFile.CountFileCacheHits"), filename);
+			countFileCacheMisses.init(         LiteralStringRef("AsyncFile.CountFileCacheMisses"), filename);
+			countFileCachePagesEvicted.init(   LiteralStringRef("AsyncFile.CountFileCachePagesEvicted"), filename);
 
 			countCacheWrites.init(         LiteralStringRef("AsyncFile.CountCacheWrites"));
 			countCacheReads.init(          LiteralStringRef("AsyncFile.CountCacheReads"));
@@ -247,6 +358,9 @@ private:
 			countCachePageReadsMerged.init(LiteralStringRef("AsyncFile.CountCachePageReadsMerged"));
 			countCacheFinds.init(          LiteralStringRef("AsyncFile.CountCacheFinds"));
 			countCacheReadBytes.init(      LiteralStringRef("AsyncFile.CountCacheReadBytes"));
+			countCacheHits.init(           LiteralStringRef("AsyncFile.CountCacheHits"));
+			countCacheMisses.init(         LiteralStringRef("AsyncFile.CountCacheMisses"));
+			countCachePagesEvicted.init(   LiteralStringRef("AsyncFile.CountCachePagesEvicted"));
 
 		}
 	}
@@ -265,7 +379,7 @@ private:
 			int64_t l = wait( f->size() );
 			TraceEvent("AFCUnderlyingSize").detail("Filename", filename).detail("Size", l);
 			auto& of = openFiles[filename];
-			of.f = new AsyncFileCached(f, filename, l, pageCache);
+			of.f = new AsyncFileCached(f, filename, l, pageCache, (flags & IAsyncFile::OPEN_CACHED_SEQUENTIAL) != 0, (flags & IAsyncFile::OPEN_CACHED_PINNED) != 0);
 			of.opened = Future<Reference<IAsyncFile>>();
 			return Reference<IAsyncFile>( of.f );
 		} catch (Error& e) {
@@ -293,6 +407,8 @@ private:
 struct AFCPage : public EvictablePage, public FastAllocated<AFCPage> {
 	virtual bool evict() {
 		if ( notReading.isReady() && notFlushing.isReady() && !dirty && !zeroCopyRefCount && !truncated ) {
+			++owner->countFileCachePagesEvicted;
+			++owner->countCachePagesEvicted;
 			owner->remove_page( this );
 			delete this;
 			return true;
@@ -493,6 +609,7 @@ struct AFCPage : public EvictablePage, public FastAllocated<AFCPage> {
 	}
 
 	AFCPage( AsyncFileCached* owner, int64_t offset ) : EvictablePage(owner->pageCache), owner(owner), pageOffset(offset), dirty(false), valid(false), truncated(false), notReading(Void()), notFlushing(Void()), zeroCopyRefCount(0), flushableIndex(-1), writeThroughCount(0) {
+		fileStats = owner->fileStats;
 		pageCache->allocate(this);
 	}
 
@@ -35,6 +35,7 @@
 #include <sys/syscall.h>
 #include "fdbrpc/linux_kaio.h"
 #include "flow/Knobs.h"
+#include "flow/Histogram.h"
 #include "flow/UnitTest.h"
 #include <stdio.h>
 #include "flow/Hash3.h"
@@ -442,6 +443,40 @@ private:
 	Int64MetricHandle countLogicalWrites;
 	Int64MetricHandle countLogicalReads;
 
+	LogHistogram readLatency;
+	LogHistogram writeLatency;
+	double lastLatencyLogged;
+
+	// Periodically emit this file's read and write latency distributions, measured from AIO
+	// submit to completion, so a degrading disk can be traced to the file driving it
+	void maybeLogLatency() {
+		if (FLOW_KNOBS->KAIO_LATENCY_LOG_INTERVAL <= 0)
+			return;
+		double t = now();
+		if (t - lastLatencyLogged < FLOW_KNOBS->KAIO_LATENCY_LOG_INTERVAL)
+			return;
+		lastLatencyLogged = t;
+
+		TraceEvent e("AsyncFileKAIOLatency");
+		e.detail("Filename", filename);
+		if (readLatency.samples()) {
+			e.detail("ReadCount", readLatency.samples())
+				.detail("ReadMean", readLatency.mean())
+				.detail("ReadMedian", readLatency.median())
+				.detail("ReadP99", readLatency.percentile(0.99))
+				.detail("ReadMax", readLatency.max());
+		}
+		if (writeLatency.samples()) {
+			e.detail("WriteCount", writeLatency.samples())
+				.detail("WriteMean", writeLatency.mean())
+				.detail("WriteMedian", writeLatency.median())
+				.detail("WriteP99", writeLatency.percentile(0.99))
+				.detail("WriteMax", writeLatency.max());
+		}
+		readLatency.clear();
+		writeLatency.clear();
+	}
+
 	struct IOBlock : linux_iocb, FastAllocated<IOBlock> {
 		Promise<int> result;
 		Reference<AsyncFileKAIO> owner;
@@ -482,6 +517,14 @@ private:
 				TraceEvent("AsyncFileKAIOIOError").GetLastError().detail("Fd", aio_fildes).detail("Op", aio_lio_opcode).detail("Nbytes", nbytes).detail("Offset", offset).detail("Ptr", int64_t(buf))
 					.detail("Size", fst.st_size).detail("Filename", owner->filename);
 			}
+			if (startTime > 0) {
+				double latency = now() - startTime;
+				if (aio_lio_opcode == IO_CMD_PREAD)
+					owner->readLatency.addSample(latency);
+				else if (aio_lio_opcode == IO_CMD_PWRITE)
+					owner->writeLatency.addSample(latency);
+				owner->maybeLogLatency();
+			}
 			deliver( result, owner->failed, r, getTask() );
 			delete this;
 		}
@@ -569,7 +612,7 @@ private:
 	};
 	static Context ctx;
 
-	explicit AsyncFileKAIO(int fd, int flags, std::string const& filename) : fd(fd), flags(flags), filename(filename), failed(false) {
+	explicit AsyncFileKAIO(int fd, int flags, std::string const& filename) : fd(fd), flags(flags), filename(filename), failed(false), lastLatencyLogged(now()) {
 
 		if( !g_network->isSimulated() ) {
 			countFileLogicalWrites.init(LiteralStringRef("AsyncFile.CountFileLogicalWrites"), filename);
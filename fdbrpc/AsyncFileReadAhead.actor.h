@@ -29,6 +29,7 @@
 
 #include "flow/flow.h"
 #include "fdbrpc/IAsyncFile.h"
+#include "flow/Knobs.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
 // Read-only file type that wraps another file instance, reads in large blocks, and reads ahead of the actual range requested
@@ -61,6 +62,12 @@ public:
 		return block;
 	}
 
+	// Bytes of readahead window growth beyond the configured sizes, summed over all instances
+	static int64_t& totalExtraReadAheadBytes() {
+		static int64_t total = 0;
+		return total;
+	}
+
 	ACTOR static Future<int> read_impl(Reference<AsyncFileReadAheadCache> f, void *data, int length, int64_t offset) {
 		// Make sure range is valid for the file
 		int64_t fileSize = wait(f->size());
@@ -71,6 +78,24 @@ public:
 		if(offset + length > fileSize)
 			length = fileSize - offset;   // Length is at least 1 since offset < fileSize
 
+		// Grow the readahead window geometrically while the reads are sequential and shrink it back to the
+		// configured size on a seek, so sequential readers (restore in particular) reach full bandwidth without
+		// per-container tuning.  Growth beyond the configured window is limited by a memory budget shared by
+		// all instances of this class so that many files being read at once do not readahead too much in total.
+		if(offset == f->m_next_sequential_offset) {
+			int target = std::max(1, f->m_current_read_ahead_blocks * 2);
+			int64_t growth = (int64_t)(target - f->m_current_read_ahead_blocks) * f->m_block_size;
+			if(growth > 0 && totalExtraReadAheadBytes() + growth <= FLOW_KNOBS->READ_AHEAD_MEMORY_BUDGET) {
+				totalExtraReadAheadBytes() += growth;
+				f->m_current_read_ahead_blocks = target;
+			}
+		}
+		else if(f->m_current_read_ahead_blocks > f->m_read_ahead_blocks) {
+			totalExtraReadAheadBytes() -= (int64_t)(f->m_current_read_ahead_blocks - f->m_read_ahead_blocks) * f->m_block_size;
+			f->m_current_read_ahead_blocks = f->m_read_ahead_blocks;
+		}
+		f->m_next_sequential_offset = offset + length;
+
 		// Calculate block range for the blocks that contain this data
 		state int firstBlockNum = offset / f->m_block_size;
 		state int lastBlockNum = (offset + length) / f->m_block_size;
@@ -84,7 +109,11 @@ public:
 
 		// Start blocks up to the read ahead size beyond the last needed block but don't go past the end of the file
 		state int lastBlockNumInFile = ((fileSize + f->m_block_size - 1) / f->m_block_size) - 1;
-		int lastBlockToStart = std::min<int>(lastBlockNum + f->m_read_ahead_blocks, lastBlockNumInFile);
+		int lastBlockToStart = std::min<int>(lastBlockNum + f->m_current_read_ahead_blocks, lastBlockNumInFile);
+
+		// The cache must be allowed to hold the current window or newly started readahead blocks would be
+		// evicted below before they are ever waited on
+		state int cacheBlockLimit = std::max<int>(f->m_cache_block_limit, f->m_current_read_ahead_blocks + (lastBlockNum - firstBlockNum + 1));
 
 		for(blockNum = firstBlockNum; blockNum <= lastBlockToStart; ++blockNum) {
 			Future<Reference<CacheBlock>> fblock;
@@ -132,13 +161,13 @@ public:
 		//printf("cache block limit: %d   Cache contents:\n", f->m_cache_block_limit);
 		//for(auto &m : f->m_blocks) printf("\tblock %d refcount %d\n", m.first, m.second.getFutureReferenceCount());
 
-		if(f->m_blocks.size() > f->m_cache_block_limit) {
+		if(f->m_blocks.size() > cacheBlockLimit) {
 			auto i = f->m_blocks.begin();
 			while(i != f->m_blocks.end()) {
 				if(i->second.getFutureReferenceCount() == 1) {
 					//printf("evicting block %d\n", i->first);
 					i = f->m_blocks.erase(i);
-					if(f->m_blocks.size() <= f->m_cache_block_limit)
+					if(f->m_blocks.size() <= cacheBlockLimit)
 						break;
 				}
 				else
@@ -172,6 +201,8 @@ public:
 	virtual std::string getFilename() { return m_f->getFilename(); }
 
 	virtual ~AsyncFileReadAheadCache() {
+		if(m_current_read_ahead_blocks > m_read_ahead_blocks)
+			totalExtraReadAheadBytes() -= (int64_t)(m_current_read_ahead_blocks - m_read_ahead_blocks) * m_block_size;
 		for(auto &it : m_blocks) {
 			it.second.cancel();
 		}
@@ -179,7 +210,9 @@ public:
 
 	Reference<IAsyncFile> m_f;
 	int m_block_size;
-	int m_read_ahead_blocks;
+	int m_read_ahead_blocks;       // Configured readahead window, also the size the window shrinks to on a seek
+	int m_current_read_ahead_blocks;
+	int64_t m_next_sequential_offset;  // End of the previous read; a read starting here grows the window
 	int m_cache_block_limit;
 	FlowLock m_max_concurrent_reads;
 
@@ -187,7 +220,8 @@ public:
 	std::map<int, Future<Reference<CacheBlock>>> m_blocks;
 
 	AsyncFileReadAheadCache(Reference<IAsyncFile> f, int blockSize, int readAheadBlocks, int maxConcurrentReads, int cacheSizeBlocks)
-		: m_f(f), m_block_size(blockSize), m_read_ahead_blocks(readAheadBlocks), m_max_concurrent_reads(maxConcurrentReads),
+		: m_f(f), m_block_size(blockSize), m_read_ahead_blocks(readAheadBlocks), m_current_read_ahead_blocks(readAheadBlocks),
+		  m_next_sequential_offset(0), m_max_concurrent_reads(maxConcurrentReads),
 		  m_cache_block_limit(std::max<int>(1, cacheSizeBlocks)) {
 	}
 
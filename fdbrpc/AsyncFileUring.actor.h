@@ -0,0 +1,580 @@
+/*
+ * AsyncFileUring.actor.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#ifdef __linux__
+
+// When actually compiled (NO_INTELLISENSE), include the generated version of this file.  In intellisense use the source version.
+#if defined(NO_INTELLISENSE) && !defined(FLOW_ASYNCFILEURING_ACTOR_G_H)
+	#define FLOW_ASYNCFILEURING_ACTOR_G_H
+	#include "fdbrpc/AsyncFileUring.actor.g.h"
+#elif !defined(FLOW_ASYNCFILEURING_ACTOR_H)
+	#define FLOW_ASYNCFILEURING_ACTOR_H
+
+#include "fdbrpc/IAsyncFile.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include "fdbrpc/linux_uring.h"
+#include "fdbrpc/AsyncFileEIO.actor.h"
+#include "flow/Knobs.h"
+#include "flow/UnitTest.h"
+#include "flow/actorcompiler.h"  // This must be the last #include.
+
+// An IAsyncFile implementation backed by io_uring.  The public interface and scheduling
+// behavior (priority queue of pending operations drained from the run loop, eventfd
+// completion notification, io timeout handling) deliberately mirror AsyncFileKAIO so the
+// two engines are interchangeable from Net2FileSystem's point of view.  The differences
+// are in submission: requests are written into a shared memory submission queue, and with
+// URING_SQPOLL enabled the kernel polls that queue so steady-state submission requires no
+// syscall at all.
+class AsyncFileUring : public IAsyncFile, public ReferenceCounted<AsyncFileUring> {
+public:
+	static Future<Reference<IAsyncFile>> open( std::string filename, int flags, int mode, void* ignore ) {
+		ASSERT( flags & OPEN_UNBUFFERED );
+
+		if (flags & OPEN_LOCK)
+			mode |= 02000;  // Enable mandatory locking for this file if it is supported by the filesystem
+
+		std::string open_filename = filename;
+		if (flags & OPEN_ATOMIC_WRITE_AND_CREATE) {
+			ASSERT( (flags & OPEN_CREATE) && (flags & OPEN_READWRITE) && !(flags & OPEN_EXCLUSIVE) );
+			open_filename = filename + ".part";
+		}
+
+		int fd = ::open( open_filename.c_str(), openFlags(flags) | O_DIRECT, mode );
+		if (fd<0) {
+			Error e = errno==ENOENT ? file_not_found() : io_error();
+			TraceEvent ev("AsyncFileUringOpenFailed");
+			ev.error(e).detail("Filename", filename).detailf("Flags", "%x", flags)
+			  .detailf("OSFlags", "%x", openFlags(flags) | O_DIRECT).detailf("Mode", "0%o", mode).GetLastError();
+			return e;
+		} else {
+			TraceEvent("AsyncFileUringOpen")
+				.detail("Filename", filename)
+				.detail("Flags", flags)
+				.detail("Mode", mode)
+				.detail("Fd", fd);
+		}
+
+		Reference<AsyncFileUring> r(new AsyncFileUring( fd, flags, filename ));
+
+		if (flags & OPEN_LOCK) {
+			// Acquire a "write" lock for the entire file
+			flock lockDesc;
+			lockDesc.l_type = F_WRLCK;
+			lockDesc.l_whence = SEEK_SET;
+			lockDesc.l_start = 0;
+			lockDesc.l_len = 0;
+			lockDesc.l_pid = 0;
+			if (fcntl(fd, F_SETLK, &lockDesc) == -1) {
+				TraceEvent(SevError, "UnableToLockFile").detail("Filename", filename).GetLastError();
+				return io_error();
+			}
+		}
+
+		struct stat buf;
+		if (fstat( fd, &buf )) {
+			TraceEvent("AsyncFileUringFStatError").detail("Fd",fd).detail("Filename", filename).GetLastError();
+			return io_error();
+		}
+
+		r->lastFileSize = r->nextFileSize = buf.st_size;
+		return Reference<IAsyncFile>(std::move(r));
+	}
+
+	// Returns false if the kernel does not support io_uring, in which case the caller
+	// should fall back to AsyncFileKAIO.
+	static bool init( Reference<IEventFD> ev, double ioTimeout ) {
+		uring_params params;
+		memset(&params, 0, sizeof(params));
+		if (FLOW_KNOBS->URING_SQPOLL) {
+			params.flags |= URING_SETUP_SQPOLL;
+			params.sq_thread_idle = FLOW_KNOBS->URING_SQPOLL_IDLE_MS;
+		}
+
+		int ringFD = io_uring_setup( FLOW_KNOBS->MAX_OUTSTANDING, &params );
+		if (ringFD < 0) {
+			TraceEvent(SevWarnAlways, "IOUringSetupError").GetLastError();
+			return false;
+		}
+
+		ctx.ringFD = ringFD;
+		ctx.sqEntries = params.sq_entries;
+		ctx.cqEntries = params.cq_entries;
+		ctx.sqpoll = (params.flags & URING_SETUP_SQPOLL) != 0;
+
+		size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(uring_cqe);
+		void* sq = mmap(0, sqSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFD, URING_OFF_SQ_RING);
+		void* cq = mmap(0, cqSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFD, URING_OFF_CQ_RING);
+		void* sqes = mmap(0, params.sq_entries * sizeof(uring_sqe), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFD, URING_OFF_SQES);
+		if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+			TraceEvent(SevError, "IOUringMmapError").GetLastError();
+			throw io_error();
+		}
+
+		ctx.sqHead = (volatile uint32_t*)((char*)sq + params.sq_off.head);
+		ctx.sqTail = (volatile uint32_t*)((char*)sq + params.sq_off.tail);
+		ctx.sqMask = *(uint32_t*)((char*)sq + params.sq_off.ring_mask);
+		ctx.sqFlags = (volatile uint32_t*)((char*)sq + params.sq_off.flags);
+		ctx.sqArray = (uint32_t*)((char*)sq + params.sq_off.array);
+		ctx.sqes = (uring_sqe*)sqes;
+
+		ctx.cqHead = (volatile uint32_t*)((char*)cq + params.cq_off.head);
+		ctx.cqTail = (volatile uint32_t*)((char*)cq + params.cq_off.tail);
+		ctx.cqMask = *(uint32_t*)((char*)cq + params.cq_off.ring_mask);
+		ctx.cqes = (uring_cqe*)((char*)cq + params.cq_off.cqes);
+
+		ctx.evfd = ev->getFD();
+		if (io_uring_register( ringFD, URING_REGISTER_EVENTFD, &ctx.evfd, 1 ) < 0) {
+			TraceEvent(SevError, "IOUringRegisterEventFDError").GetLastError();
+			throw io_error();
+		}
+
+		if( !g_network->isSimulated() ) {
+			ctx.countUringSubmit.init(LiteralStringRef("AsyncFile.CountUringSubmit"));
+			ctx.countUringCollect.init(LiteralStringRef("AsyncFile.CountUringCollect"));
+			ctx.countPreSubmitTruncate.init(LiteralStringRef("AsyncFile.CountPreUringSubmitTruncate"));
+			ctx.preSubmitTruncateBytes.init(LiteralStringRef("AsyncFile.PreUringSubmitTruncateBytes"));
+		}
+
+		setTimeout(ioTimeout);
+		poll(ev);
+
+		g_network->setGlobal(INetwork::enRunCycleFunc, (flowGlobalType) &AsyncFileUring::launch);
+		TraceEvent("IOUringInit").detail("SQEntries", ctx.sqEntries).detail("CQEntries", ctx.cqEntries).detail("SQPoll", ctx.sqpoll);
+		return true;
+	}
+
+	static void setTimeout(double ioTimeout) { ctx.setIOTimeout(ioTimeout); }
+
+	virtual void addref() { ReferenceCounted<AsyncFileUring>::addref(); }
+	virtual void delref() { ReferenceCounted<AsyncFileUring>::delref(); }
+
+	virtual Future<int> read( void* data, int length, int64_t offset ) {
+		++countFileLogicalReads;
+		++countLogicalReads;
+
+		if(failed) {
+			return io_timeout();
+		}
+
+		IOBlock *io = new IOBlock(URING_OP_READV, fd);
+		io->buf = data;
+		io->nbytes = length;
+		io->offset = offset;
+
+		enqueue(io, "read", this);
+		return io->result.getFuture();
+	}
+
+	virtual Future<Void> write( void const* data, int length, int64_t offset ) {
+		++countFileLogicalWrites;
+		++countLogicalWrites;
+
+		if(failed) {
+			return io_timeout();
+		}
+
+		IOBlock *io = new IOBlock(URING_OP_WRITEV, fd);
+		io->buf = (void*)data;
+		io->nbytes = length;
+		io->offset = offset;
+
+		nextFileSize = std::max( nextFileSize, offset+length );
+
+		enqueue(io, "write", this);
+		return success(io->result.getFuture());
+	}
+
+	virtual Future<Void> truncate( int64_t size ) {
+		++countFileLogicalWrites;
+		++countLogicalWrites;
+
+		if(failed) {
+			return io_timeout();
+		}
+
+		int result = -1;
+		bool completed = false;
+		if( ctx.fallocateSupported && size >= lastFileSize ) {
+			result = fallocate( fd, 0, 0, size);
+			if (result != 0) {
+				int fallocateErrCode = errno;
+				TraceEvent("AsyncFileUringAllocateError").detail("Fd",fd).detail("Filename", filename).GetLastError();
+				if ( fallocateErrCode == EOPNOTSUPP ) {
+					ctx.fallocateSupported = false;
+				} else {
+					return io_error();
+				}
+			} else {
+				completed = true;
+			}
+		}
+		if ( !completed )
+			result = ftruncate(fd, size);
+
+		if(result != 0) {
+			TraceEvent("AsyncFileUringTruncateError").detail("Fd",fd).detail("Filename", filename).GetLastError();
+			return io_error();
+		}
+
+		lastFileSize = nextFileSize = size;
+
+		return Void();
+	}
+
+	ACTOR static Future<Void> throwErrorIfFailed( Reference<AsyncFileUring> self, Future<Void> sync ) {
+		wait( sync );
+		if(self->failed) {
+			throw io_timeout();
+		}
+		return Void();
+	}
+
+	virtual Future<Void> sync() {
+		++countFileLogicalWrites;
+		++countLogicalWrites;
+
+		if(failed) {
+			return io_timeout();
+		}
+
+		// URING_OP_FSYNC exists, but a sync must not be reordered ahead of the writes it covers
+		// and the submission queue gives no ordering guarantee, so as with KAIO we use the
+		// thread pool fdatasync.  Syncs are rare relative to writes so this costs little.
+		Future<Void> fsync = throwErrorIfFailed( Reference<AsyncFileUring>::addRef(this), AsyncFileEIO::async_fdatasync(fd) );
+
+		if (flags & OPEN_ATOMIC_WRITE_AND_CREATE) {
+			flags &= ~OPEN_ATOMIC_WRITE_AND_CREATE;
+
+			return AsyncFileEIO::waitAndAtomicRename( fsync, filename+".part", filename );
+		}
+
+		return fsync;
+	}
+	virtual Future<int64_t> size() { return nextFileSize; }
+	virtual int64_t debugFD() {
+		return fd;
+	}
+	virtual std::string getFilename() {
+		return filename;
+	}
+	~AsyncFileUring() {
+		close(fd);
+	}
+
+	static void launch() {
+		if (ctx.queue.size() && ctx.outstanding < FLOW_KNOBS->MAX_OUTSTANDING - FLOW_KNOBS->MIN_SUBMIT) {
+			double begin = timer_monotonic();
+			if (!ctx.outstanding) ctx.ioStallBegin = begin;
+
+			int n = std::min<size_t>(FLOW_KNOBS->MAX_OUTSTANDING - ctx.outstanding, ctx.queue.size());
+			int submitted = 0;
+
+			for(int i=0; i<n; i++) {
+				uint32_t tail = *ctx.sqTail;
+				if (tail - *ctx.sqHead >= ctx.sqEntries)
+					break;  // SQ ring full; the rest stays queued for the next run cycle
+
+				IOBlock* io = ctx.queue.top();
+				ctx.queue.pop();
+				io->startTime = now();
+
+				if(ctx.ioTimeout > 0) {
+					ctx.appendToRequestList(io);
+				}
+
+				if (io->owner->lastFileSize != io->owner->nextFileSize) {
+					++ctx.countPreSubmitTruncate;
+					int64_t truncateSize = io->owner->nextFileSize - io->owner->lastFileSize;
+					ASSERT(truncateSize > 0);
+					ctx.preSubmitTruncateBytes += truncateSize;
+					io->owner->truncate(io->owner->nextFileSize);
+				}
+
+				uint32_t index = tail & ctx.sqMask;
+				uring_sqe* sqe = &ctx.sqes[index];
+				memset(sqe, 0, sizeof(uring_sqe));
+				sqe->opcode = io->opcode;
+				sqe->fd = io->aio_fildes;
+				sqe->off = io->offset;
+				io->iov.iov_base = io->buf;
+				io->iov.iov_len = io->nbytes;
+				sqe->addr = (uint64_t)&io->iov;
+				sqe->len = 1;
+				sqe->user_data = (uint64_t)io;
+
+				ctx.sqArray[index] = index;
+				__sync_synchronize();  // The kernel must see the sqe before the tail advance
+				*ctx.sqTail = tail + 1;
+				++submitted;
+			}
+
+			if (submitted) {
+				int rc = 0;
+				if (ctx.sqpoll) {
+					// With SQPOLL the kernel-side thread consumes the ring; we only need a
+					// syscall if it has gone to sleep.
+					__sync_synchronize();
+					if (*ctx.sqFlags & URING_SQ_NEED_WAKEUP)
+						rc = io_uring_enter( ctx.ringFD, submitted, 0, URING_ENTER_SQ_WAKEUP );
+				} else {
+					rc = io_uring_enter( ctx.ringFD, submitted, 0, 0 );
+				}
+
+				if (rc < 0 && errno != EAGAIN && errno != EINTR) {
+					TraceEvent(SevError, "IOUringEnterError").GetLastError();
+					throw io_error();
+				}
+
+				ctx.outstanding += submitted;
+				++ctx.countUringSubmit;
+			}
+
+			double elapsed = timer_monotonic() - begin;
+			g_network->networkMetrics.secSquaredSubmit += elapsed*elapsed/2;
+		}
+	}
+
+	bool failed;
+private:
+	int fd, flags;
+	int64_t lastFileSize, nextFileSize;
+	std::string filename;
+	Int64MetricHandle countFileLogicalWrites;
+	Int64MetricHandle countFileLogicalReads;
+
+	Int64MetricHandle countLogicalWrites;
+	Int64MetricHandle countLogicalReads;
+
+	struct IOBlock : FastAllocated<IOBlock> {
+		Promise<int> result;
+		Reference<AsyncFileUring> owner;
+		int opcode;
+		int aio_fildes;
+		void* buf;
+		uint64_t nbytes;
+		int64_t offset;
+		struct iovec iov;
+		int64_t prio;
+		IOBlock *prev;
+		IOBlock *next;
+		double startTime;
+
+		struct indirect_order_by_priority { bool operator () ( IOBlock* a, IOBlock* b ) { return a->prio < b->prio; } };
+
+		IOBlock(int op, int fd) : opcode(op), aio_fildes(fd), buf(nullptr), nbytes(0), offset(0), prio(0), prev(nullptr), next(nullptr), startTime(0) {}
+
+		int getTask() const { return (prio>>32)+1; }
+
+		ACTOR static void deliver( Promise<int> result, bool failed, int r, int task ) {
+			wait( delay(0, task) );
+			if (failed) result.sendError(io_timeout());
+			else if (r < 0) result.sendError(io_error());
+			else result.send(r);
+		}
+
+		void setResult( int r ) {
+			if (r<0) {
+				errno = -r;
+				TraceEvent("AsyncFileUringIOError").GetLastError().detail("Fd", aio_fildes).detail("Op", opcode).detail("Nbytes", nbytes).detail("Offset", offset).detail("Ptr", int64_t(buf))
+					.detail("Filename", owner->filename);
+			}
+			deliver( result, owner->failed, r, getTask() );
+			delete this;
+		}
+
+		void timeout(bool warnOnly) {
+			TraceEvent(SevWarnAlways, "AsyncFileUringTimeout").detail("Fd", aio_fildes).detail("Op", opcode).detail("Nbytes", nbytes).detail("Offset", offset).detail("Ptr", int64_t(buf))
+				.detail("Filename", owner->filename);
+			g_network->setGlobal(INetwork::enASIOTimedOut, (flowGlobalType)true);
+
+			if(!warnOnly)
+				owner->failed = true;
+		}
+	};
+
+	struct Context {
+		int ringFD;
+		int evfd;
+		int outstanding;
+		uint32_t sqEntries, cqEntries;
+		bool sqpoll;
+		double ioStallBegin;
+		bool fallocateSupported;
+
+		volatile uint32_t *sqHead, *sqTail, *sqFlags;
+		uint32_t sqMask;
+		uint32_t *sqArray;
+		uring_sqe *sqes;
+
+		volatile uint32_t *cqHead, *cqTail;
+		uint32_t cqMask;
+		uring_cqe *cqes;
+
+		std::priority_queue<IOBlock*, std::vector<IOBlock*>, IOBlock::indirect_order_by_priority> queue;
+		Int64MetricHandle countUringSubmit;
+		Int64MetricHandle countUringCollect;
+		Int64MetricHandle countPreSubmitTruncate;
+		Int64MetricHandle preSubmitTruncateBytes;
+
+		double ioTimeout;
+		bool timeoutWarnOnly;
+		IOBlock *submittedRequestList;
+
+		uint32_t opsIssued;
+		Context() : ringFD(-1), evfd(-1), outstanding(0), sqEntries(0), cqEntries(0), sqpoll(false), ioStallBegin(0), fallocateSupported(true),
+			sqHead(nullptr), sqTail(nullptr), sqFlags(nullptr), sqMask(0), sqArray(nullptr), sqes(nullptr),
+			cqHead(nullptr), cqTail(nullptr), cqMask(0), cqes(nullptr), submittedRequestList(nullptr), opsIssued(0) {
+			setIOTimeout(0);
+		}
+
+		void setIOTimeout(double timeout) {
+			ioTimeout = fabs(timeout);
+			timeoutWarnOnly = timeout < 0;
+		}
+
+		void appendToRequestList(IOBlock *io) {
+			ASSERT(!io->next && !io->prev);
+
+			if(submittedRequestList) {
+				io->prev = submittedRequestList->prev;
+				io->prev->next = io;
+
+				submittedRequestList->prev = io;
+				io->next = submittedRequestList;
+			}
+			else {
+				submittedRequestList = io;
+				io->next = io->prev = io;
+			}
+		}
+
+		void removeFromRequestList(IOBlock *io) {
+			if(io->next == nullptr) {
+				ASSERT(io->prev == nullptr);
+				return;
+			}
+
+			ASSERT(io->prev != nullptr);
+
+			if(io == io->next) {
+				ASSERT(io == submittedRequestList && io == io->prev);
+				submittedRequestList = nullptr;
+			}
+			else {
+				io->next->prev = io->prev;
+				io->prev->next = io->next;
+
+				if(submittedRequestList == io) {
+					submittedRequestList = io->next;
+				}
+			}
+
+			io->next = io->prev = nullptr;
+		}
+	};
+	static Context ctx;
+
+	explicit AsyncFileUring(int fd, int flags, std::string const& filename) : fd(fd), flags(flags), filename(filename), failed(false) {
+		if( !g_network->isSimulated() ) {
+			countFileLogicalWrites.init(LiteralStringRef("AsyncFile.CountFileLogicalWrites"), filename);
+			countFileLogicalReads.init( LiteralStringRef("AsyncFile.CountFileLogicalReads"), filename);
+			countLogicalWrites.init(LiteralStringRef("AsyncFile.CountLogicalWrites"));
+			countLogicalReads.init( LiteralStringRef("AsyncFile.CountLogicalReads"));
+		}
+	}
+
+	void enqueue( IOBlock* io, const char* op, AsyncFileUring* owner ) {
+		ASSERT( int64_t(io->buf) % 4096 == 0 && io->offset % 4096 == 0 && io->nbytes % 4096 == 0 );
+
+		io->prio = (int64_t(g_network->getCurrentTask())<<32) - (++ctx.opsIssued);
+		io->owner = Reference<AsyncFileUring>::addRef(owner);
+
+		ctx.queue.push(io);
+	}
+
+	static int openFlags(int flags) {
+		int oflags = 0;
+		ASSERT( bool(flags & OPEN_READONLY) != bool(flags & OPEN_READWRITE) );  // readonly xor readwrite
+		if( flags & OPEN_EXCLUSIVE ) oflags |= O_EXCL;
+		if( flags & OPEN_CREATE )    oflags |= O_CREAT;
+		if( flags & OPEN_READONLY )  oflags |= O_RDONLY;
+		if( flags & OPEN_READWRITE ) oflags |= O_RDWR;
+		if( flags & OPEN_ATOMIC_WRITE_AND_CREATE ) oflags |= O_TRUNC;
+		return oflags;
+	}
+
+	ACTOR static void poll( Reference<IEventFD> ev ) {
+		loop {
+			wait(success( ev->read() ));
+
+			wait(delay(0, TaskDiskIOComplete));
+
+			int n = 0;
+			loop {
+				uint32_t head = *ctx.cqHead;
+				__sync_synchronize();
+				if (head == *ctx.cqTail) break;
+
+				uring_cqe* cqe = &ctx.cqes[head & ctx.cqMask];
+				IOBlock* iob = (IOBlock*)cqe->user_data;
+				int res = cqe->res;
+
+				__sync_synchronize();
+				*ctx.cqHead = head + 1;
+				++n;
+
+				if(ctx.ioTimeout > 0) {
+					ctx.removeFromRequestList(iob);
+				}
+
+				iob->setResult( res );
+			}
+
+			++ctx.countUringCollect;
+			if (n) {
+				double t = timer_monotonic();
+				double elapsed = t - ctx.ioStallBegin;
+				ctx.ioStallBegin = t;
+				g_network->networkMetrics.secSquaredDiskStall += elapsed*elapsed/2;
+			}
+
+			ctx.outstanding -= n;
+
+			if(ctx.ioTimeout > 0) {
+				double currentTime = now();
+				while(ctx.submittedRequestList && currentTime - ctx.submittedRequestList->startTime > ctx.ioTimeout) {
+					ctx.submittedRequestList->timeout(ctx.timeoutWarnOnly);
+					ctx.removeFromRequestList(ctx.submittedRequestList);
+				}
+			}
+		}
+	}
+};
+
+AsyncFileUring::Context AsyncFileUring::ctx;
+
+#include "flow/unactorcompiler.h"
+#endif
+#endif
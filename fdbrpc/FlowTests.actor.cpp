@@ -107,6 +107,27 @@ ACTOR static Future<int> addOneActor(Future<int> in) {
 	return i + 1;
 }
 
+ACTOR static FLATTEN Future<int> flattenedForwardActor(Future<int> in) {
+	int i = wait(in);
+	return i;
+}
+
+ACTOR static FLATTEN Future<Void> flattenedVoidActor(Future<Void> f) {
+	wait(f);
+	return Void();
+}
+
+static void throwIfTrue(bool b) {
+	if (b)
+		throw operation_failed();
+}
+
+ACTOR static FLATTEN Future<int> flattenedThrowActor(Future<int> in, bool fail) {
+	throwIfTrue(fail);
+	int i = wait(in);
+	return i;
+}
+
 ACTOR static Future<Void> chooseTwoActor(Future<Void> f, Future<Void> g) {
 	choose{
 		when(wait(f)) {}
@@ -372,6 +393,54 @@ TEST_CASE("/flow/flow/trivial futures")
 	return Void();
 }
 
+TEST_CASE("/flow/flow/flatten")
+{
+	// A FLATTEN actor compiles to a plain function that hands back the waited-on future
+	{
+		Promise<int> p;
+		Future<int> f = flattenedForwardActor(p.getFuture());
+		ASSERT(f.isValid() && !f.isReady());
+		p.send(7);
+		ASSERT(f.isReady() && f.get() == 7);
+	}
+
+	{
+		Future<int> f = flattenedForwardActor(Future<int>(3));
+		ASSERT(f.isReady() && f.get() == 3);
+	}
+
+	{
+		Promise<Void> p;
+		Future<Void> f = flattenedVoidActor(p.getFuture());
+		ASSERT(!f.isReady());
+		p.send(Void());
+		ASSERT(f.isReady() && !f.isError());
+	}
+
+	// An exception thrown before the wait becomes a broken future, matching ordinary actors
+	{
+		Future<int> f = flattenedThrowActor(Future<int>(1), true);
+		ASSERT(f.isError() && f.getError().code() == error_code_operation_failed);
+	}
+
+	{
+		Future<int> f = flattenedThrowActor(Future<int>(2), false);
+		ASSERT(f.isReady() && f.get() == 2);
+	}
+
+	// There is no intermediate promise/future pair: the caller holds the callee's future
+	// directly, and dropping it cancels the callee
+	{
+		Promise<int> p;
+		Future<int> f = flattenedForwardActor(p.getFuture());
+		ASSERT(p.getFutureReferenceCount() == 1);
+		f = Future<int>();
+		ASSERT(p.getFutureReferenceCount() == 0);
+	}
+
+	return Void();
+}
+
 TEST_CASE("/flow/flow/trivial promises")
 {
 	Future<int> f;
@@ -28,6 +28,7 @@
 #include "fdbrpc/FailureMonitor.h"
 #include "fdbrpc/crc32c.h"
 #include "fdbrpc/simulator.h"
+#include "fdbrpc/zlib/zlib.h"
 
 #if VALGRIND
 #include <memcheck.h>
@@ -46,8 +47,9 @@ class EndpointMap : NonCopyable {
 public:
 	EndpointMap();
 	void insert( NetworkMessageReceiver* r, Endpoint::Token& token, uint32_t priority );
+	void insertWellKnown( NetworkMessageReceiver* r, Endpoint::Token const& token, uint32_t priority );
 	NetworkMessageReceiver* get( Endpoint::Token const& token );
-	uint32_t getPriority( Endpoint::Token const& token );
+	NetworkMessageReceiver* get( Endpoint::Token const& token, uint32_t& priority );
 	void remove( Endpoint::Token const& token, NetworkMessageReceiver* r );
 
 private:
@@ -90,6 +92,23 @@ void EndpointMap::insert( NetworkMessageReceiver* r, Endpoint::Token& token, uin
 	data[index].receiver = r;
 }
 
+// Well-known endpoints go in the slot their token already names (the lower 32 bits of
+// token.second()), so registration order doesn't matter.  Only called a handful of times at
+// startup, so walking the free list to claim the slot is fine.
+void EndpointMap::insertWellKnown( NetworkMessageReceiver* r, Endpoint::Token const& token, uint32_t priority ) {
+	uint32_t index = token.second();
+	while ( data.size() <= index ) realloc();
+	ASSERT( !data[index].receiver );
+	uint32_t* link = &firstFree;
+	while (*link != index) {
+		ASSERT( *link != uint32_t(-1) );
+		link = &data[*link].nextFree;
+	}
+	*link = data[index].nextFree;
+	data[index].token() = Endpoint::Token( token.first(), (token.second()&0xffffffff00000000LL) | priority );
+	data[index].receiver = r;
+}
+
 NetworkMessageReceiver* EndpointMap::get( Endpoint::Token const& token ) {
 	uint32_t index = token.second();
 	if ( index < data.size() && data[index].token().first() == token.first() && ((data[index].token().second()&0xffffffff00000000LL)|index)==token.second() )
@@ -97,11 +116,15 @@ NetworkMessageReceiver* EndpointMap::get( Endpoint::Token const& token ) {
 	return 0;
 }
 
-uint32_t EndpointMap::getPriority( Endpoint::Token const& token ) {
+// Returns the receiver and its priority with a single probe of the table
+NetworkMessageReceiver* EndpointMap::get( Endpoint::Token const& token, uint32_t& priority ) {
 	uint32_t index = token.second();
-	if ( index < data.size() && data[index].token().first() == token.first() && ((data[index].token().second()&0xffffffff00000000LL)|index)==token.second() )
-		return data[index].token().second();
-	return TaskUnknownEndpoint;
+	if ( index < data.size() && data[index].token().first() == token.first() && ((data[index].token().second()&0xffffffff00000000LL)|index)==token.second() ) {
+		priority = data[index].token().second();
+		return data[index].receiver;
+	}
+	priority = TaskUnknownEndpoint;
+	return 0;
 }
 
 void EndpointMap::remove( Endpoint::Token const& token, NetworkMessageReceiver* r ) {
@@ -115,10 +138,7 @@ void EndpointMap::remove( Endpoint::Token const& token, NetworkMessageReceiver*
 
 struct EndpointNotFoundReceiver : NetworkMessageReceiver {
 	EndpointNotFoundReceiver(EndpointMap& endpoints) {
-		//endpoints[WLTOKEN_ENDPOINT_NOT_FOUND] = this;
-		Endpoint::Token e = WLTOKEN_ENDPOINT_NOT_FOUND;
-		endpoints.insert(this, e, TaskDefaultEndpoint);
-		ASSERT( e == WLTOKEN_ENDPOINT_NOT_FOUND );
+		endpoints.insertWellKnown(this, WLTOKEN_ENDPOINT_NOT_FOUND, TaskDefaultEndpoint);
 	}
 	virtual void receive( ArenaReader& reader ) {
 		// Remote machine tells us it doesn't have endpoint e
@@ -129,9 +149,7 @@ struct EndpointNotFoundReceiver : NetworkMessageReceiver {
 
 struct PingReceiver : NetworkMessageReceiver {
 	PingReceiver(EndpointMap& endpoints) {
-		Endpoint::Token e = WLTOKEN_PING_PACKET;
-		endpoints.insert(this, e, TaskReadSocket);
-		ASSERT( e == WLTOKEN_PING_PACKET );
+		endpoints.insertWellKnown(this, WLTOKEN_PING_PACKET, TaskReadSocket);
 	}
 	virtual void receive( ArenaReader& reader ) {
 		ReplyPromise<Void> reply; reader >> reply;
@@ -141,13 +159,15 @@ struct PingReceiver : NetworkMessageReceiver {
 
 class TransportData {
 public:
-	TransportData(uint64_t transportId) 
+	TransportData(uint64_t transportId)
 	  : endpointNotFoundReceiver(endpoints),
 		pingReceiver(endpoints),
 		warnAlwaysForLargePacket(true),
 		lastIncompatibleMessage(0),
 		transportId(transportId),
-		numIncompatibleConnections(0)
+		numIncompatibleConnections(0),
+		localDcIdHash(0),
+		connectLock(FLOW_KNOBS->MAX_CONCURRENT_CONNECTS)
 	{}
 
 	~TransportData();
@@ -166,13 +186,13 @@ public:
 	NetworkAddress localAddress;
 	std::map<NetworkAddress, struct Peer*> peers;
 	Future<Void> listen;
+	FlowLock connectLock;  // Bounds simultaneous outgoing connection establishments across all peers
 	bool warnAlwaysForLargePacket;
 
-	// These declarations must be in exactly this order
+	// The EndpointMap must be constructed before the receivers that register in it
 	EndpointMap endpoints;
 	EndpointNotFoundReceiver endpointNotFoundReceiver;
 	PingReceiver pingReceiver;
-	// End ordered declarations
 
 	Int64MetricHandle bytesSent;
 	Int64MetricHandle countPacketsReceived;
@@ -181,6 +201,18 @@ public:
 	Int64MetricHandle countConnClosedWithError;
 	Int64MetricHandle countConnClosedWithoutError;
 
+	// True if connections to the given peer should carry compressed byte streams.  We only know a
+	// peer's datacenter once we have seen a ConnectPacket from it, so the first outgoing connection
+	// to a peer after startup is always uncompressed.
+	bool shouldCompressConnection( NetworkAddress const& peer ) const {
+		if( !FLOW_KNOBS->COMPRESS_INTERDC_TRAFFIC || !localDcIdHash ) return false;
+		auto it = peerDcIdHashes.find( peer );
+		return it != peerDcIdHashes.end() && it->second != 0 && it->second != localDcIdHash;
+	}
+
+	uint32_t localDcIdHash;  // crc32c of this process's dcId, or 0 if it has none
+	std::map<NetworkAddress, uint32_t> peerDcIdHashes;  // Learned from each peer's ConnectPacket
+
 	std::map<NetworkAddress, std::pair<uint64_t, double>> incompatiblePeers;
 	uint32_t numIncompatibleConnections;
 	std::map<uint64_t, double> multiVersionConnections;
@@ -192,9 +224,11 @@ public:
 
 #define CONNECT_PACKET_V0 0x0FDB00A444020001LL
 #define CONNECT_PACKET_V1 0x0FDB00A446030001LL
+#define CONNECT_PACKET_V2 0x0FDB00B061040001LL
 #define CONNECT_PACKET_V0_SIZE 14
 #define CONNECT_PACKET_V1_SIZE 22
 #define CONNECT_PACKET_V2_SIZE 26
+#define CONNECT_PACKET_V3_SIZE 32
 
 #pragma pack( push, 1 )
 struct ConnectPacket {
@@ -203,17 +237,143 @@ struct ConnectPacket {
 	uint16_t canonicalRemotePort;  // Port number to reconnect to the originating process
 	uint64_t connectionId;         // Multi-version clients will use the same Id for both connections, other connections will set this to zero. Added at protocol Version 0x0FDB00A444020001.
 	uint32_t canonicalRemoteIp;    // IP Address to reconnect to the originating process
+	uint16_t flags;                // FLAG_* bits.  Added at protocol Version 0x0FDB00B061040001.
+	uint32_t dcIdHash;             // crc32c of the originating process's dcId, or 0 if it has none
+
+	enum {
+		FLAG_COMPRESSED = 1  // Every byte the originating process sends after this packet is a zlib deflate stream
+	};
 
 	size_t minimumSize() {
 		if (protocolVersion < CONNECT_PACKET_V0) return CONNECT_PACKET_V0_SIZE;
 		if (protocolVersion < CONNECT_PACKET_V1) return CONNECT_PACKET_V1_SIZE;
-		return CONNECT_PACKET_V2_SIZE;
+		if (protocolVersion < CONNECT_PACKET_V2) return CONNECT_PACKET_V2_SIZE;
+		return CONNECT_PACKET_V3_SIZE;
 	}
 };
 
-static_assert( sizeof(ConnectPacket) == CONNECT_PACKET_V2_SIZE, "ConnectPacket packed incorrectly" );
+static_assert( sizeof(ConnectPacket) == CONNECT_PACKET_V3_SIZE, "ConnectPacket packed incorrectly" );
 #pragma pack( pop )
 
+// Compresses one direction of a connection.  connectionWriter pushes the plaintext it would have
+// written to the socket through a zlib deflate stream instead, and writes the 'out' queue in its
+// place.  Each batch ends with a sync flush so the receiving end can always decode everything that
+// has actually been sent.
+struct ConnectionCompressor : ReferenceCounted<ConnectionCompressor>, NonCopyable {
+	UnsentPacketQueue out;
+
+	ConnectionCompressor() : rawPrefixBytes( sizeof(ConnectPacket) ) {
+		memset( &stream, 0, sizeof(stream) );
+		if (deflateInit( &stream, Z_BEST_SPEED ) != Z_OK)
+			throw platform_error();
+	}
+	~ConnectionCompressor() { deflateEnd( &stream ); }
+
+	// Consume the given chain of plaintext buffers (the same chain a call to IConnection::write
+	// would take) and append the compressed form to out.  Returns the number of plaintext bytes
+	// consumed, which is all of them.
+	int compress( SendBuffer const* plaintext ) {
+		int consumed = 0;
+		PacketBuffer* dst = out.getWriteBuffer();
+		for(SendBuffer const* p = plaintext; p; p = p->next) {
+			stream.next_in = (Bytef*)(p->data + p->bytes_sent);
+			stream.avail_in = p->bytes_written - p->bytes_sent;
+			consumed += stream.avail_in;
+
+			// The ConnectPacket at the head of the stream passes through unchanged, since the remote
+			// end parses it before it knows whether the connection is compressed
+			while (rawPrefixBytes && stream.avail_in) {
+				dst = ensureSpace(dst);
+				int n = std::min<int>( std::min<int>( rawPrefixBytes, stream.avail_in ), dst->bytes_unwritten() );
+				memcpy( dst->data + dst->bytes_written, stream.next_in, n );
+				dst->bytes_written += n;
+				stream.next_in += n;
+				stream.avail_in -= n;
+				rawPrefixBytes -= n;
+			}
+
+			while (stream.avail_in)
+				dst = deflateStep( dst, Z_NO_FLUSH );
+		}
+
+		// Flush so that the receiver can decode everything consumed so far without waiting for more
+		do {
+			dst = deflateStep( dst, Z_SYNC_FLUSH );
+		} while (stream.avail_out == 0);
+
+		out.setWriteBuffer(dst);
+		return consumed;
+	}
+
+private:
+	z_stream stream;
+	int rawPrefixBytes;
+
+	PacketBuffer* ensureSpace( PacketBuffer* dst ) {
+		if (!dst->bytes_unwritten()) {
+			dst->next = PacketBuffer::create();
+			dst = dst->nextPacketBuffer();
+		}
+		return dst;
+	}
+
+	PacketBuffer* deflateStep( PacketBuffer* dst, int flush ) {
+		dst = ensureSpace(dst);
+		stream.next_out = dst->data + dst->bytes_written;
+		stream.avail_out = dst->bytes_unwritten();
+		int r = deflate( &stream, flush );
+		ASSERT( r == Z_OK || r == Z_BUF_ERROR );  // Z_BUF_ERROR just means there was nothing left to flush
+		dst->bytes_written = dst->size() - stream.avail_out;
+		return dst;
+	}
+};
+
+// Decompresses the other direction.  Raw socket reads land in a staging buffer and are inflated on
+// demand into connectionReader's buffer, so everything downstream of the read sees plaintext.
+struct ConnectionInflater : ReferenceCounted<ConnectionInflater>, NonCopyable {
+	ConnectionInflater() {
+		memset( &stream, 0, sizeof(stream) );
+		if (inflateInit( &stream ) != Z_OK)
+			throw platform_error();
+	}
+	~ConnectionInflater() { inflateEnd( &stream ); }
+
+	// Hand over compressed bytes that were already read from the socket (the tail of the read that
+	// contained the peer's ConnectPacket)
+	void addInput( uint8_t const* data, int bytes ) {
+		ASSERT( stream.avail_in == 0 && bytes <= (int)sizeof(input) );
+		memcpy( input, data, bytes );
+		stream.next_in = input;
+		stream.avail_in = bytes;
+	}
+
+	bool hasBufferedInput() const { return stream.avail_in != 0; }
+
+	// Like IConnection::read, but returns inflated bytes.  Returns 0 when no progress can be made
+	// until the socket becomes readable again.
+	int read( Reference<IConnection> conn, uint8_t* begin, uint8_t* end ) {
+		if (!stream.avail_in) {
+			int compressedBytes = conn->read( input, input + sizeof(input) );
+			if (!compressedBytes) return 0;
+			stream.next_in = input;
+			stream.avail_in = compressedBytes;
+		}
+		stream.next_out = begin;
+		stream.avail_out = end - begin;
+		int r = inflate( &stream, Z_NO_FLUSH );
+		if (r != Z_OK && r != Z_BUF_ERROR) {
+			// A corrupt compressed stream means we can't trust anything else the connection delivers
+			TraceEvent(SevWarnAlways, "DecompressionError").detail("ZlibResult", r);
+			throw checksum_failed();
+		}
+		return (end - begin) - stream.avail_out;
+	}
+
+private:
+	z_stream stream;
+	uint8_t input[ 65536 ];
+};
+
 static Future<Void> connectionReader( TransportData* const& transport, Reference<IConnection> const& conn, Peer* const& peer, Promise<Peer*> const& onConnected );
 
 static PacketID sendPacket( TransportData* self, ISerializeSource const& what, const Endpoint& destination, bool reliable, bool openConnection );
@@ -224,6 +384,8 @@ struct Peer : NonCopyable {
 	UnsentPacketQueue unsent;
 	ReliablePacketList reliable;
 	AsyncTrigger dataToSend;  // Triggered when unsent.empty() becomes false
+	AsyncTrigger flushNow;    // Triggered when the writer's coalescing delay should be cut short
+	int64_t bytesCoalesced;   // Bytes queued since the writer last started writing
 	Future<Void> connect;
 	AsyncTrigger incompatibleDataRead;
 	bool compatible;
@@ -232,17 +394,23 @@ struct Peer : NonCopyable {
 	double reconnectionDelay;
 	int peerReferences;
 	bool incompatibleProtocolVersionNewer;
+	bool compressOutgoing;  // Whether the byte stream of the current connection is compressed, as declared in our last ConnectPacket
 
 	explicit Peer( TransportData* transport, NetworkAddress const& destination )
-		: transport(transport), destination(destination), outgoingConnectionIdle(false), lastConnectTime(0.0), reconnectionDelay(FLOW_KNOBS->INITIAL_RECONNECTION_TIME), compatible(true), incompatibleProtocolVersionNewer(false), peerReferences(-1)
+		: transport(transport), destination(destination), outgoingConnectionIdle(false), lastConnectTime(0.0), reconnectionDelay(FLOW_KNOBS->INITIAL_RECONNECTION_TIME), compatible(true), incompatibleProtocolVersionNewer(false), peerReferences(-1), bytesCoalesced(0), compressOutgoing(false)
 	{
 		connect = connectionKeeper(this);
 	}
 
-	void send(PacketBuffer* pb, ReliablePacket* rp, bool firstUnsent) {
+	void send(PacketBuffer* pb, ReliablePacket* rp, bool firstUnsent, int bytes, bool highPriority) {
 		unsent.setWriteBuffer(pb);
 		if (rp) reliable.insert(rp);
+		bytesCoalesced += bytes;
 		if (firstUnsent) dataToSend.trigger();
+		// Small packets accumulate for up to MAX_COALESCE_DELAY, but once a full write's worth has
+		// queued up (or for latency-sensitive traffic) there is nothing to gain by waiting longer
+		if (highPriority || bytesCoalesced >= FLOW_KNOBS->COALESCE_IMMEDIATE_BYTES)
+			flushNow.trigger();
 	}
 
 	void prependConnectPacket() {
@@ -259,8 +427,13 @@ struct Peer : NonCopyable {
 		pkt.connectPacketLength = sizeof(pkt)-sizeof(pkt.connectPacketLength);
 		pkt.protocolVersion = currentProtocolVersion;
 		pkt.connectionId = transport->transportId;
+		pkt.dcIdHash = transport->localDcIdHash;
+		pkt.flags = 0;
+		compressOutgoing = transport->shouldCompressConnection( destination );
+		if (compressOutgoing)
+			pkt.flags |= ConnectPacket::FLAG_COMPRESSED;
 
-		PacketBuffer* pb_first = new PacketBuffer;
+		PacketBuffer* pb_first = PacketBuffer::create();
 		PacketWriter wr( pb_first, NULL, Unversioned() );
 		wr.serializeBinaryItem(pkt);
 		unsent.prependWriteBuffer(pb_first, wr.finish());
@@ -325,7 +498,14 @@ struct Peer : NonCopyable {
 			FlowTransport::transport().sendUnreliable( SerializeSource<ReplyPromise<Void>>(reply), remotePing.getEndpoint() );
 
 			choose {
-				when (wait( delay( FLOW_KNOBS->CONNECTION_MONITOR_TIMEOUT ) )) { TraceEvent("ConnectionTimeout").suppressFor(1.0).detail("WithAddr", peer->destination); throw connection_failed(); }
+				when (wait( delay( FLOW_KNOBS->CONNECTION_MONITOR_TIMEOUT ) )) {
+					TraceEvent("ConnectionTimeout").suppressFor(1.0).detail("WithAddr", peer->destination);
+					// A peer that cannot answer a ping is reported failed right away; the failure monitoring
+					// server's view will confirm or correct this within its next round
+					if (FLOW_KNOBS->TRANSPORT_FAILURE_DETECTION && peer->destination.isPublic())
+						static_cast<SimpleFailureMonitor&>( IFailureMonitor::failureMonitor() ).setStatus( peer->destination, FailureStatus(true) );
+					throw connection_failed();
+				}
 				when (wait( reply.getFuture() )) {}
 				when (wait( peer->incompatibleDataRead.onTrigger())) {}
 			}
@@ -334,22 +514,31 @@ struct Peer : NonCopyable {
 
 	ACTOR static Future<Void> connectionWriter( Peer* self, Reference<IConnection> conn ) {
 		state double lastWriteTime = now();
+		state Reference<ConnectionCompressor> compressor;
+		if (self->compressOutgoing)
+			compressor = Reference<ConnectionCompressor>( new ConnectionCompressor );
 		loop {
 			//wait( delay(0, TaskWriteSocket) );
-			wait( delayJittered(std::max<double>(FLOW_KNOBS->MIN_COALESCE_DELAY, FLOW_KNOBS->MAX_COALESCE_DELAY - (now() - lastWriteTime)), TaskWriteSocket) );
+			wait( delayJittered(std::max<double>(FLOW_KNOBS->MIN_COALESCE_DELAY, FLOW_KNOBS->MAX_COALESCE_DELAY - (now() - lastWriteTime)), TaskWriteSocket) || self->flushNow.onTrigger() );
 			//wait( delay(500e-6, TaskWriteSocket) );
 			//wait( yield(TaskWriteSocket) );
 
 			// Send until there is nothing left to send
 			loop {
 				lastWriteTime = now();
+				self->bytesCoalesced = 0;
+
+				// When compressing, everything queued so far becomes one deflate batch and the
+				// compressed bytes are written to the socket in its place
+				if (compressor && !self->unsent.empty())
+					self->unsent.sent( compressor->compress( self->unsent.getUnsent() ) );
 
-				int sent = conn->write( self->unsent.getUnsent() );
+				int sent = conn->write( compressor ? compressor->out.getUnsent() : self->unsent.getUnsent() );
 				if (sent) {
 					self->transport->bytesSent += sent;
-					self->unsent.sent(sent);
+					(compressor ? compressor->out : self->unsent).sent(sent);
 				}
-				if (self->unsent.empty()) break;
+				if (compressor ? compressor->out.empty() : self->unsent.empty()) break;
 
 				TEST(true); // We didn't write everything, so apparently the write buffer is full.  Wait for it to be nonfull.
 				wait( conn->onWritable() );
@@ -377,17 +566,30 @@ struct Peer : NonCopyable {
 						wait( self->dataToSend.onTrigger() );
 					ASSERT( self->destination.isPublic() );
 					self->outgoingConnectionIdle = false;
-					wait( delayJittered( std::max(0.0, self->lastConnectTime+self->reconnectionDelay - now()) ) );  // Don't connect() to the same peer more than once per 2 sec
+					// Full jitter on the backoff: after a network blip every peer's keeper wakes at once, and
+					// spreading the retries over the whole backoff window breaks up the resulting lockstep
+					wait( delay( std::max(0.0, self->lastConnectTime + self->reconnectionDelay*(0.5 + g_random->random01()) - now()) ) );
+
+					// A lock over all outgoing connects turns a mass reconnection into a quickly drained
+					// queue instead of thousands of simultaneous connect()s
+					wait( self->transport->connectLock.take() );
+					state FlowLock::Releaser connectReleaser( self->transport->connectLock );
 					self->lastConnectTime = now();
 
 					TraceEvent("ConnectingTo", conn ? conn->getDebugID() : UID()).suppressFor(1.0).detail("PeerAddr", self->destination);
 					Reference<IConnection> _conn = wait( timeout( INetworkConnections::net()->connect(self->destination), FLOW_KNOBS->CONNECTION_MONITOR_TIMEOUT, Reference<IConnection>() ) );
+					connectReleaser.release();
 					if (_conn) {
 						conn = _conn;
 						TraceEvent("ConnectionExchangingConnectPacket", conn->getDebugID()).suppressFor(1.0).detail("PeerAddr", self->destination);
 						self->prependConnectPacket();
+						// Each success decays the backoff while failures below keep growing it, so the pace a
+						// destination is retried at tracks how well connects to it have been going recently
+						self->reconnectionDelay = std::max( FLOW_KNOBS->INITIAL_RECONNECTION_TIME, self->reconnectionDelay * FLOW_KNOBS->RECONNECTION_SUCCESS_DECAY_RATE );
 					} else {
 						TraceEvent("ConnectionTimedOut", conn ? conn->getDebugID() : UID()).suppressFor(1.0).detail("PeerAddr", self->destination);
+						if (FLOW_KNOBS->TRANSPORT_FAILURE_DETECTION && self->destination.isPublic())
+							static_cast<SimpleFailureMonitor&>( IFailureMonitor::failureMonitor() ).setStatus( self->destination, FailureStatus(true) );
 						throw connection_failed();
 					}
 
@@ -453,14 +655,16 @@ TransportData::~TransportData() {
 }
 
 ACTOR static void deliver( TransportData* self, Endpoint destination, ArenaReader reader, bool inReadSocket ) {
-	int priority = self->endpoints.getPriority(destination.token);
+	state uint32_t priority = TaskUnknownEndpoint;
+	state NetworkMessageReceiver* receiver = self->endpoints.get(destination.token, priority);
 	if (priority < TaskReadSocket || !inReadSocket) {
 		wait( delay(0, priority) );
+		// The receiver might have been removed while we were queued, so probe the table again
+		receiver = self->endpoints.get(destination.token);
 	} else {
 		g_network->setCurrentTask( priority );
 	}
 
-	auto receiver = self->endpoints.get(destination.token);
 	if (receiver) {
 		try {
 			g_currentDeliveryPeerAddress = destination.address;
@@ -493,6 +697,12 @@ static void scanPackets( TransportData* transport, uint8_t*& unprocessed_begin,
 	bool checksumEnabled = true;
 	if (transport->localAddress.isTLS() || peerAddress.isTLS()) {
 		checksumEnabled = false;
+	} else if (FLOW_KNOBS->DISABLE_SAME_HOST_CHECKSUMS && transport->localAddress.isPublic() && peerAddress.isPublic() &&
+	           transport->localAddress.ip == peerAddress.ip) {
+		// Traffic between processes on the same host moves over kernel loopback and never crosses hardware
+		// that could corrupt it.  Both sides decide this identically from the canonical addresses, the same
+		// way the TLS exemption works; the knob must therefore be set uniformly across a cluster.
+		checksumEnabled = false;
 	}
 
 	loop {
@@ -597,6 +807,9 @@ ACTOR static Future<Void> connectionReader(
 	state bool incompatibleProtocolVersionNewer = false;
 	state NetworkAddress peerAddress;
 	state uint64_t peerProtocolVersion = 0;
+	state Reference<ConnectionInflater> inflater;
+	state bool peerStreamCompressed = false;
+	state double lastPeerAliveUpdate = 0;
 
 	peerAddress = conn->getPeerAddress();
 	if (peer == nullptr) { 
@@ -619,7 +832,8 @@ ACTOR static Future<Void> connectionReader(
 					readAllBytes = buffer_end - unprocessed_end;
 				}
 
-				int readBytes = conn->read( unprocessed_end, buffer_end );
+				int readBytes = inflater ? inflater->read( conn, unprocessed_end, buffer_end )
+				                         : conn->read( unprocessed_end, buffer_end );
 				if (!readBytes) break;
 				state bool readWillBlock = readBytes != readAllBytes;
 				unprocessed_end += readBytes;
@@ -634,7 +848,10 @@ ACTOR static Future<Void> connectionReader(
 						if(p->protocolVersion >= 0x0FDB00A444020001) {
 							connectionId = p->connectionId;
 						}
-						
+						if(connectPacketSize >= CONNECT_PACKET_V3_SIZE) {
+							peerStreamCompressed = (p->flags & ConnectPacket::FLAG_COMPRESSED) != 0;
+						}
+
 						if( (p->protocolVersion & compatibleProtocolVersionMask) != (currentProtocolVersion & compatibleProtocolVersionMask) ) {
 							incompatibleProtocolVersionNewer = p->protocolVersion > currentProtocolVersion;
 							NetworkAddress addr = p->canonicalRemotePort ? NetworkAddress( p->canonicalRemoteIp, p->canonicalRemotePort ) : conn->getPeerAddress();
@@ -689,11 +906,15 @@ ACTOR static Future<Void> connectionReader(
 								incompatiblePeerCounted = true;
 							}
 							ASSERT( p->canonicalRemotePort == peerAddress.port );
+							if (connectPacketSize >= CONNECT_PACKET_V3_SIZE)
+								transport->peerDcIdHashes[ peerAddress ] = p->dcIdHash;
 						} else {
 							if (p->canonicalRemotePort) {
 								peerAddress = NetworkAddress( p->canonicalRemoteIp, p->canonicalRemotePort, true, peerAddress.isTLS() );
 							}
 							peer = transport->getPeer(peerAddress);
+							if (connectPacketSize >= CONNECT_PACKET_V3_SIZE)
+								transport->peerDcIdHashes[ peerAddress ] = p->dcIdHash;
 							peer->compatible = compatible;
 							peer->incompatibleProtocolVersionNewer = incompatibleProtocolVersionNewer;
 							if (!compatible) {
@@ -703,17 +924,32 @@ ACTOR static Future<Void> connectionReader(
 							onConnected.send( peer );
 							wait( delay(0) );  // Check for cancellation
 						}
+
+						if (compatible && peerStreamCompressed) {
+							// Everything the peer sends after its ConnectPacket is a deflate stream;
+							// move any bytes we have already read into the inflater and decompress
+							// from here on
+							inflater = Reference<ConnectionInflater>( new ConnectionInflater );
+							inflater->addInput( unprocessed_begin, unprocessed_end - unprocessed_begin );
+							unprocessed_end = unprocessed_begin;
+						}
 					}
 				}
 				if (compatible) {
 					scanPackets( transport, unprocessed_begin, unprocessed_end, arena, peerAddress, peerProtocolVersion );
+					// Anything received on an established connection proves the peer is alive, so report
+					// that locally instead of waiting for the next failure monitoring round trip
+					if (FLOW_KNOBS->TRANSPORT_FAILURE_DETECTION && peerAddress.isPublic() && now() - lastPeerAliveUpdate > FLOW_KNOBS->TRANSPORT_LIVENESS_UPDATE_INTERVAL) {
+						lastPeerAliveUpdate = now();
+						static_cast<SimpleFailureMonitor&>( IFailureMonitor::failureMonitor() ).setStatus( peerAddress, FailureStatus(false) );
+					}
 				}
 				else if(!expectConnectPacket) {
 					unprocessed_begin = unprocessed_end;
 					peer->incompatibleDataRead.trigger();
 				}
 
-				if (readWillBlock)
+				if (readWillBlock && !(inflater && inflater->hasBufferedInput()))
 					break;
 
 				wait(yield(TaskReadSocket));
@@ -814,6 +1050,14 @@ void FlowTransport::initMetrics() { self->initMetrics(); }
 
 NetworkAddress FlowTransport::getLocalAddress() { return self->localAddress; }
 
+void FlowTransport::setLocalDcId( StringRef dcId ) {
+	if (dcId.size()) {
+		uint32_t h = crc32c_append( 0, dcId.begin(), dcId.size() );
+		self->localDcIdHash = h ? h : 1;  // 0 means "no dcId", so a hash that collides with it is nudged
+	} else
+		self->localDcIdHash = 0;
+}
+
 std::map<NetworkAddress, std::pair<uint64_t, double>>* FlowTransport::getIncompatiblePeers() { 
 	for(auto it = self->incompatiblePeers.begin(); it != self->incompatiblePeers.end();) {
 		if( self->multiVersionConnections.count(it->second.first) ) {
@@ -829,7 +1073,23 @@ Future<Void> FlowTransport::bind( NetworkAddress publicAddress, NetworkAddress l
 	ASSERT( publicAddress.isPublic() );
 	self->localAddress = publicAddress;
 	TraceEvent("Binding").detail("PublicAddress", publicAddress).detail("ListenAddress", listenAddress);
-	self->listen = listen( self, listenAddress );
+
+	int listeners = 1;
+#ifdef __linux__
+	// With SO_REUSEPORT each listener gets its own kernel accept queue, so a burst of incoming
+	// connections (e.g. every client reconnecting after a cluster controller change) cannot
+	// overflow a single backlog while the run loop is busy
+	if( !g_network->isSimulated() )
+		listeners = std::max( 1, FLOW_KNOBS->LISTEN_SOCKET_COUNT );
+#endif
+	if( listeners == 1 )
+		self->listen = listen( self, listenAddress );
+	else {
+		std::vector<Future<Void>> all;
+		for(int i=0; i<listeners; i++)
+			all.push_back( listen( self, listenAddress ) );
+		self->listen = waitForAll( all );
+	}
 	return self->listen;
 }
 
@@ -883,9 +1143,7 @@ void FlowTransport::removeEndpoint( const Endpoint& endpoint, NetworkMessageRece
 void FlowTransport::addWellKnownEndpoint( Endpoint& endpoint, NetworkMessageReceiver* receiver, uint32_t taskID ) {
 	endpoint.address = getLocalAddress();
 	ASSERT( ((endpoint.token.first() & TOKEN_STREAM_FLAG)!=0) == receiver->isStream() );
-	Endpoint::Token otoken = endpoint.token;
-	self->endpoints.insert( receiver, endpoint.token, taskID );
-	ASSERT( endpoint.token == otoken );
+	self->endpoints.insertWellKnown( receiver, endpoint.token, taskID );
 }
 
 static PacketID sendPacket( TransportData* self, ISerializeSource const& what, const Endpoint& destination, bool reliable, bool openConnection ) {
@@ -907,6 +1165,9 @@ static PacketID sendPacket( TransportData* self, ISerializeSource const& what, c
 		bool checksumEnabled = true;
 		if (self->localAddress.isTLS() || destination.address.isTLS()) {
 			checksumEnabled = false;
+		} else if (FLOW_KNOBS->DISABLE_SAME_HOST_CHECKSUMS && self->localAddress.isPublic() && destination.address.isPublic() &&
+		           self->localAddress.ip == destination.address.ip) {
+			checksumEnabled = false;  // Must mirror the same-host rule in scanPackets()
 		}
 
 		++self->countPacketsGenerated;
@@ -948,14 +1209,14 @@ static PacketID sendPacket( TransportData* self, ISerializeSource const& what, c
 			// Find the correct place to start calculating checksum
 			uint32_t checksumUnprocessedLength = len;
 			prevBytesWritten += packetInfoSize;
-			if (prevBytesWritten >= PacketBuffer::DATA_SIZE) {
-				prevBytesWritten -= PacketBuffer::DATA_SIZE;
+			if (prevBytesWritten >= checksumPb->size()) {
+				prevBytesWritten -= checksumPb->size();
 				checksumPb = checksumPb->nextPacketBuffer();
 			}
 
 			// Checksum calculation
 			while (checksumUnprocessedLength > 0) {
-				uint32_t processLength = std::min(checksumUnprocessedLength, (uint32_t)(PacketBuffer::DATA_SIZE - prevBytesWritten));
+				uint32_t processLength = std::min(checksumUnprocessedLength, (uint32_t)(checksumPb->size() - prevBytesWritten));
 				checksum = crc32c_append(checksum, checksumPb->data + prevBytesWritten, processLength);
 				checksumUnprocessedLength -= processLength;
 				checksumPb = checksumPb->nextPacketBuffer();
@@ -995,7 +1256,8 @@ static PacketID sendPacket( TransportData* self, ISerializeSource const& what, c
 		}
 #endif
 
-		peer->send(pb, rp, firstUnsent);
+		bool highPriority = g_network->getCurrentTask() >= TaskProxyCommit;
+		peer->send(pb, rp, firstUnsent, wr.size(), highPriority);
 
 		return (PacketID)rp;
 	}
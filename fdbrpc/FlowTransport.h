@@ -48,7 +48,7 @@ public:
 	}
 };
 #pragma pack(pop)
-BINARY_SERIALIZABLE( Endpoint );
+FIXED_LAYOUT_BINARY_SERIALIZABLE( Endpoint, sizeof(NetworkAddress) + sizeof(Endpoint::Token) );
 
 
 class NetworkMessageReceiver {
@@ -80,6 +80,11 @@ public:
 	NetworkAddress getLocalAddress();
 	// Returns the NetworkAddress that would be assigned by addEndpoint (the public address)
 
+	void setLocalDcId( StringRef dcId );
+	// Declares which datacenter this process belongs to, which lets connections to peers in other
+	// datacenters negotiate compression.  Processes that never call this (e.g. clients) and processes
+	// that pass an empty dcId do not compress their outgoing streams.
+
 	std::map<NetworkAddress, std::pair<uint64_t, double>>* getIncompatiblePeers();
 	// Returns the same of all peers that have attempted to connect, but have incompatible protocol versions
 
@@ -48,8 +48,10 @@ public:
 		OPEN_ATOMIC_WRITE_AND_CREATE = 0x80000,  // A temporary file is opened, and on the first call to sync() it is atomically renamed to the given filename
 		OPEN_LARGE_PAGES = 0x100000, 
 		OPEN_NO_AIO = 0x200000,                   // Don't use AsyncFileKAIO or similar implementations that rely on filesystem support for AIO
-		OPEN_CACHED_READ_ONLY = 0x400000          // AsyncFileCached opens files read/write even if you specify read only
-	};  
+		OPEN_CACHED_READ_ONLY = 0x400000,         // AsyncFileCached opens files read/write even if you specify read only
+		OPEN_CACHED_SEQUENTIAL = 0x800000,        // Hint to AsyncFileCached that this file will be scanned once; its pages stay probationary so the scan recycles its own pages
+		OPEN_CACHED_PINNED = 0x1000000            // Hint to AsyncFileCached that this file's pages should stay resident; they are evicted only when no other page is evictable
+	};
 
 	virtual void addref() = 0;
 	virtual void delref() = 0;
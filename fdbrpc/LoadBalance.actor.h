@@ -52,32 +52,52 @@ struct ModelHolder : NonCopyable, public ReferenceCounted<ModelHolder> {
 		}
 	}
 
-	void release(bool clean, bool futureVersion, double penalty, bool measureLatency = true) {
+	void release(bool clean, bool futureVersion, double penalty, int64_t replicaVersion = 0, bool measureLatency = true) {
 		if(model && !released) {
 			released = true;
 			double latency = (clean || measureLatency) ? now() - startTime : 0.0;
-			model->endRequest(token, latency, penalty, delta, clean, futureVersion);
+			model->endRequest(token, latency, penalty, delta, clean, futureVersion, replicaVersion);
 		}
 	}
 
-	~ModelHolder() { 
-		release(false, false, -1.0, false);
+	~ModelHolder() {
+		release(false, false, -1.0, 0, false);
 	}
 };
 
 struct LoadBalancedReply {
 	double penalty;
-	LoadBalancedReply() : penalty(1.0) {}
+	int64_t replicaVersion;  // the replying server's version watermark, so clients can route later versioned reads to replicas able to serve them
+
+	LoadBalancedReply() : penalty(1.0), replicaVersion(0) {}
 
 	template <class Ar>
 	void serialize(Ar &ar) {
-		ar & penalty;
+		ar & penalty & replicaVersion;
 	}
 };
 
 Optional<LoadBalancedReply> getLoadBalancedReply(LoadBalancedReply *reply);
 Optional<LoadBalancedReply> getLoadBalancedReply(void*);
 
+// Cheap 64-bit mix (the splitmix64 finalizer), used for rendezvous hashing below
+inline uint64_t loadBalanceAffinityMix( uint64_t x ) {
+	x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+// Hashes the first LOAD_BALANCE_AFFINITY_PREFIX_BYTES of a key to an affinity token for
+// loadBalance(), so that nearby keys (likely sharing btree pages) prefer the same replica.
+// Never returns zero, which loadBalance() interprets as no affinity.
+inline uint64_t loadBalanceAffinityHash( StringRef key ) {
+	int len = std::min<int>( key.size(), FLOW_KNOBS->LOAD_BALANCE_AFFINITY_PREFIX_BYTES );
+	uint64_t h = 0;
+	for(int i=0; i<len; i++)
+		h = h*131 + key[i];
+	return loadBalanceAffinityMix(h) | 1;
+}
+
 // Returns true if we got a value for our request
 // Throws an error if the request returned an error that should bubble out
 // Returns false if we got an error that should result in reissuing the request
@@ -85,15 +105,17 @@ template <class T>
 bool checkAndProcessResult(ErrorOr<T> result, Reference<ModelHolder> holder, bool atMostOnce, bool triedAllOptions) {
 	int errCode = result.isError() ? result.getError().code() : error_code_success;
 	bool maybeDelivered = errCode == error_code_broken_promise || errCode == error_code_request_maybe_delivered;
-	bool receivedResponse = result.present() || (!maybeDelivered && errCode != error_code_process_behind);
-	bool futureVersion = errCode == error_code_future_version || errCode == error_code_process_behind;
+	bool receivedResponse = result.present() || (!maybeDelivered && errCode != error_code_process_behind && errCode != error_code_server_overloaded);
+	// A server that sheds a read for load gets the same brief failedUntil backoff as one behind on
+	// versions, so the next requests go to its teammates while it drains
+	bool futureVersion = errCode == error_code_future_version || errCode == error_code_process_behind || errCode == error_code_server_overloaded;
 
 	Optional<LoadBalancedReply> loadBalancedReply;
 	if(!result.isError()) {
 		loadBalancedReply = getLoadBalancedReply(&result.get());
 	}
 
-	holder->release(receivedResponse, futureVersion, loadBalancedReply.present() ? loadBalancedReply.get().penalty : -1.0);
+	holder->release(receivedResponse, futureVersion, loadBalancedReply.present() ? loadBalancedReply.get().penalty : -1.0, loadBalancedReply.present() ? loadBalancedReply.get().replicaVersion : 0);
 	
 	if(result.present()) {
 		return true;
@@ -107,7 +129,7 @@ bool checkAndProcessResult(ErrorOr<T> result, Reference<ModelHolder> holder, boo
 		throw request_maybe_delivered();
 	}
 
-	if(triedAllOptions && errCode == error_code_process_behind) {
+	if(triedAllOptions && (errCode == error_code_process_behind || errCode == error_code_server_overloaded)) {
 		throw future_version();
 	}
 
@@ -162,7 +184,9 @@ Future< REPLY_TYPE(Request) > loadBalance(
 	Request request = Request(),
 	int taskID = TaskDefaultPromiseEndpoint,
 	bool atMostOnce = false, // if true, throws request_maybe_delivered() instead of retrying automatically
-	QueueModel* model = NULL) 
+	QueueModel* model = NULL,
+	uint64_t affinityHash = 0, // if nonzero, prefer the replica chosen by rendezvous hashing (see loadBalanceAffinityHash())
+	int64_t minReplyVersion = 0) // if nonzero, avoid replicas whose last reported version watermark is behind this version
 {
 	state Future<Optional<REPLY_TYPE(Request)>> firstRequest;
 	state Optional<uint64_t> firstRequestEndpoint;
@@ -182,23 +206,50 @@ Future< REPLY_TYPE(Request) > loadBalance(
 	if( nextAlt >= bestAlt )
 		nextAlt++;
 
+	// With an affinity hash, reads for a sub-range deterministically prefer one replica of the
+	// nearest group (rendezvous hashing over the team), so each replica's page cache holds a
+	// distinct slice of the shard's working set rather than every replica caching all of it.
+	// Failed replicas are skipped as usual, and under load the preference is only worth
+	// LOAD_BALANCE_AFFINITY_PENALTY of expected time before another replica is chosen instead.
+	state int affinityAlt = -1;
+	if (affinityHash) {
+		uint64_t bestScore = 0;
+		for(int i=0; i<alternatives->countBest(); i++) {
+			uint64_t score = loadBalanceAffinityMix( affinityHash ^ alternatives->get( i, channel ).getEndpoint().token.first() );
+			if (affinityAlt < 0 || score > bestScore) {
+				affinityAlt = i;
+				bestScore = score;
+			}
+		}
+		bestAlt = affinityAlt;
+	}
+
 	if(model) {
 		double bestMetric = 1e9;
 		double nextMetric = 1e9;
 		double bestTime = 1e9;
 		double nextTime = 1e9;
 		for(int i=0; i<alternatives->size(); i++) {
-			if(bestMetric < 1e8 && i == alternatives->countBest()) {
-				break;
-			}
-			
 			RequestStream<Request> const* thisStream = &alternatives->get( i, channel );
 			if (!IFailureMonitor::failureMonitor().getState( thisStream->getEndpoint() ).failed) {
 				auto& qd = model->getMeasurement(thisStream->getEndpoint().token.first());
 				if(now() > qd.failedUntil) {
-					double thisMetric = qd.smoothOutstanding.smoothTotal();
-					double thisTime = qd.latency;
-				
+					// More distant alternatives pay a penalty per distance step, so nearby replicas are
+					// preferred until their queues are long enough to be worth crossing the network;
+					// likewise replicas other than the affinity preference pay for the cache misses
+					// they would take.  Every load balanced reply carries the replica's version
+					// watermark, which acts as a short lease: while it is fresh, a replica known to
+					// be behind the read version pays for the future_version retry it would cost
+					// instead of being discovered the slow way.
+					bool laggingReplica = minReplyVersion > 0 && qd.lastReportedVersion > 0 && qd.lastReportedVersion < minReplyVersion
+						&& now() - qd.versionReportTime < FLOW_KNOBS->LOAD_BALANCE_VERSION_LEASE_TIME;
+					if (laggingReplica)
+						TEST(true); // Load balance penalized a replica reporting a version behind the read version
+					double thisMetric = qd.expectedTime() + FLOW_KNOBS->LOAD_BALANCE_DISTANCE_PENALTY * ( alternatives->getDistance(i) - alternatives->bestDistance() )
+						+ ( affinityAlt >= 0 && i != affinityAlt ? FLOW_KNOBS->LOAD_BALANCE_AFFINITY_PENALTY : 0 )
+						+ ( laggingReplica ? FLOW_KNOBS->LOAD_BALANCE_LAGGING_REPLICA_PENALTY : 0 );
+					double thisTime = qd.smoothLatency;
+
 					if(thisMetric < bestMetric) {
 						if(i != bestAlt) {
 							nextAlt = bestAlt;
@@ -216,30 +267,16 @@ Future< REPLY_TYPE(Request) > loadBalance(
 				}
 			}
 		}
-		if( nextMetric > 1e8 ) {
-			for(int i=alternatives->countBest(); i<alternatives->size(); i++) {
-				RequestStream<Request> const* thisStream = &alternatives->get( i, channel );
-				if (!IFailureMonitor::failureMonitor().getState( thisStream->getEndpoint() ).failed) {
-					auto& qd = model->getMeasurement(thisStream->getEndpoint().token.first());
-					if(now() > qd.failedUntil) {
-						double thisMetric = qd.smoothOutstanding.smoothTotal();
-						double thisTime = qd.latency;
-				
-						if( thisMetric < nextMetric ) {
-							nextAlt = i;
-							nextMetric = thisMetric;
-							nextTime = thisTime;
-						}
-					}
-				}
-			}
-		}
 
 		if(nextTime < 1e9) {
+			// Time the backup request off what the selected endpoint itself usually needs (its
+			// tracked latency percentile), falling back to the runner-up's average until the
+			// selected endpoint has enough history
+			double hedgeTime = model->getMeasurement( alternatives->get( bestAlt, channel ).getEndpoint().token.first() ).hedgeLatency( nextTime );
 			if(bestTime > FLOW_KNOBS->INSTANT_SECOND_REQUEST_MULTIPLIER*(model->secondMultiplier*(nextTime) + FLOW_KNOBS->BASE_SECOND_REQUEST_TIME)) {
 				secondDelay = Void();
 			} else {
-				secondDelay = delay( model->secondMultiplier*nextTime + FLOW_KNOBS->BASE_SECOND_REQUEST_TIME );
+				secondDelay = delay( model->secondMultiplier*hedgeTime + FLOW_KNOBS->BASE_SECOND_REQUEST_TIME );
 			}
 		}
 		else {
@@ -154,12 +154,18 @@ ProcessClass::Fitness ProcessClass::machineClassFitness( ClusterRole role ) cons
 }
 
 LBDistance::Type loadBalanceDistance( LocalityData const& loc1, LocalityData const& loc2, NetworkAddress const& addr2 ) {
-	if ( loc1.zoneId().present() && loc1.zoneId() == loc2.zoneId() )
+	if ( loc1.machineId().present() && loc1.machineId() == loc2.machineId() )
 		return LBDistance::SAME_MACHINE;
+	// zoneId is the default machine locality, so a zone match still counts as the same machine when
+	// no finer-grained machineId has been configured
+	if ( loc1.zoneId().present() && loc1.zoneId() == loc2.zoneId() )
+		return loc1.machineId().present() && loc2.machineId().present() ? LBDistance::SAME_ZONE : LBDistance::SAME_MACHINE;
 
 	//FIXME: add this back in when load balancing works with local requests
 	//if ( g_network->isAddressOnThisHost( addr2 ) )
 	//	return LBDistance::SAME_MACHINE;
+	if ( loc1.dataHallId().present() && loc1.dataHallId() == loc2.dataHallId() )
+		return LBDistance::SAME_DATA_HALL;
 	if ( loc1.dcId().present() && loc1.dcId() == loc2.dcId() )
 		return LBDistance::SAME_DC;
 	return LBDistance::DISTANT;
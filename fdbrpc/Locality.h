@@ -285,10 +285,14 @@ struct LBLocalityData<Interface, typename std::enable_if< Interface::LocationAwa
 };
 
 struct LBDistance {
+	// Only the relative order of these matters; MultiInterface sorts alternatives by distance and
+	// load balances across the nearest group
 	enum Type {
 		SAME_MACHINE = 0,
-		SAME_DC = 1,
-		DISTANT = 2
+		SAME_ZONE = 1,
+		SAME_DATA_HALL = 2,
+		SAME_DC = 3,
+		DISTANT = 4
 	};
 };
 
@@ -82,6 +82,9 @@ public:
 			return LBDistance::DISTANT;
 		return (LBDistance::Type) alternatives[0].k;
 	}
+	LBDistance::Type getDistance( int index ) const {
+		return (LBDistance::Type) alternatives[index].k;
+	}
 	bool alwaysFresh() const {
 		return LBLocalityData<T>::alwaysFresh();
 	}
@@ -132,6 +135,9 @@ public:
 			return LBDistance::DISTANT;
 		return (LBDistance::Type) alternatives[0]->distance;
 	}
+	LBDistance::Type getDistance( int index ) const {
+		return (LBDistance::Type) alternatives[index]->distance;
+	}
 	bool alwaysFresh() const {
 		return LBLocalityData<T>::alwaysFresh();
 	}
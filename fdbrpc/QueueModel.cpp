@@ -21,12 +21,23 @@
 #include "fdbrpc/QueueModel.h"
 #include "fdbrpc/LoadBalance.h"
 
-void QueueModel::endRequest( uint64_t id, double latency, double penalty, double delta, bool clean, bool futureVersion ) {
+void QueueModel::endRequest( uint64_t id, double latency, double penalty, double delta, bool clean, bool futureVersion, int64_t replicaVersion ) {
 	auto& d = data[id];
 	d.smoothOutstanding.addDelta(-delta);
 
 	if(clean) {
 		d.latency = latency;
+		d.smoothLatency += (latency - d.smoothLatency) * FLOW_KNOBS->LOAD_BALANCE_LATENCY_SMOOTHING;
+
+		// Periodically restart the percentile sample so hedging tracks current conditions rather
+		// than the endpoint's all-time distribution
+		if (now() - d.latencySampleStart > FLOW_KNOBS->LOAD_BALANCE_SAMPLE_EXPIRATION) {
+			d.latencySample.clear();
+			d.latencySampleCount = 0;
+			d.latencySampleStart = now();
+		}
+		d.latencySample.addSample(latency);
+		d.latencySampleCount++;
 	} else {
 		d.latency = std::max(d.latency, latency);
 	}
@@ -45,6 +56,13 @@ void QueueModel::endRequest( uint64_t id, double latency, double penalty, double
 	if(penalty > 0) {
 		d.penalty = penalty;
 	}
+
+	// Versions only move forward, so keep the largest watermark we have seen but refresh its
+	// timestamp with every report
+	if(replicaVersion > 0) {
+		d.lastReportedVersion = std::max(d.lastReportedVersion, replicaVersion);
+		d.versionReportTime = now();
+	}
 }
 
 QueueData& QueueModel::getMeasurement( uint64_t id ) {
@@ -24,6 +24,7 @@
 
 #include "flow/flow.h"
 #include "fdbrpc/Smoother.h"
+#include "fdbrpc/ContinuousSample.h"
 #include "flow/Knobs.h"
 #include "flow/ActorCollection.h"
 
@@ -31,18 +32,39 @@
 struct QueueData {
 	Smoother smoothOutstanding;
 	double latency;
+	double smoothLatency;                    // EWMA of the latencies of clean requests
+	ContinuousSample<double> latencySample;  // Recent clean latencies, for percentile based hedging
+	int latencySampleCount;                  // Samples added since latencySampleStart (ContinuousSample doesn't expose its population)
+	double latencySampleStart;
 	double penalty;
 	double failedUntil;
 	double futureVersionBackoff;
 	double increaseBackoffTime;
-	QueueData() : latency(0.001), penalty(1.0), smoothOutstanding(FLOW_KNOBS->QUEUE_MODEL_SMOOTHING_AMOUNT), failedUntil(0), futureVersionBackoff(FLOW_KNOBS->FUTURE_VERSION_INITIAL_BACKOFF), increaseBackoffTime(0) {}
+	int64_t lastReportedVersion;             // the endpoint's version watermark from its most recent reply
+	double versionReportTime;                // when lastReportedVersion was reported; trusted for LOAD_BALANCE_VERSION_LEASE_TIME
+	QueueData() : latency(0.001), smoothLatency(0.001), latencySample(FLOW_KNOBS->LOAD_BALANCE_LATENCY_SAMPLE_SIZE), latencySampleCount(0), latencySampleStart(0), penalty(1.0), smoothOutstanding(FLOW_KNOBS->QUEUE_MODEL_SMOOTHING_AMOUNT), failedUntil(0), futureVersionBackoff(FLOW_KNOBS->FUTURE_VERSION_INITIAL_BACKOFF), increaseBackoffTime(0), lastReportedVersion(0), versionReportTime(0) {}
+
+	// Predicted time for a new request to complete at this endpoint: the work already outstanding
+	// there, served at the latency it has recently delivered
+	double expectedTime() {
+		return (smoothOutstanding.smoothTotal() + penalty) * smoothLatency;
+	}
+
+	// The latency this endpoint usually stays under, for deciding when a first request is "late"
+	// enough to hedge.  Returns fallback until enough samples have accumulated for the percentile
+	// to mean anything.
+	double hedgeLatency( double fallback ) {
+		if (latencySampleCount < FLOW_KNOBS->LOAD_BALANCE_MIN_HEDGE_SAMPLES)
+			return fallback;
+		return latencySample.percentile( FLOW_KNOBS->LOAD_BALANCE_HEDGE_PERCENTILE );
+	}
 };
 
 typedef double TimeEstimate;
 
 class QueueModel {
 public:
-	void endRequest( uint64_t id, double latency, double penalty, double delta, bool clean, bool futureVersion );
+	void endRequest( uint64_t id, double latency, double penalty, double delta, bool clean, bool futureVersion, int64_t replicaVersion = 0 );
 	QueueData& getMeasurement( uint64_t id );
 	double addRequest( uint64_t id );
 	double secondMultiplier;
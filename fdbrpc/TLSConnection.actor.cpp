@@ -22,6 +22,7 @@
 #include "flow/flow.h"
 #include "flow/network.h"
 #include "flow/Knobs.h"
+#include "flow/IThreadPool.h"
 #include "fdbrpc/TLSConnection.h"
 #include "fdbrpc/ITLSPlugin.h"
 #include "fdbrpc/LoadPlugin.h"
@@ -36,6 +37,14 @@ const char* tlsPluginName = "fdb-libressl-plugin";
 static int send_func(void* ctx, const uint8_t* buf, int len) {
 	TLSConnection* conn = (TLSConnection*)ctx;
 
+	// While a handshake step is running on the handshake thread pool the underlying connection
+	// cannot be used from that thread, so handshake records accumulate in a buffer which the
+	// network thread writes out when the step finishes
+	if ( conn->offloadingHandshake ) {
+		conn->handshakeSendBuffer.insert( conn->handshakeSendBuffer.end(), buf, buf + len );
+		return len;
+	}
+
 	try {
 		SendBuffer sb;
 		sb.bytes_sent = 0;
@@ -58,6 +67,18 @@ static int send_func(void* ctx, const uint8_t* buf, int len) {
 static int recv_func(void* ctx, uint8_t* buf, int len) {
 	TLSConnection* conn = (TLSConnection*)ctx;
 
+	// Bytes the network thread read ahead for a handshake step are consumed first.  Anything the
+	// handshake did not consume (e.g. application data sent immediately after the peer finished)
+	// is drained here before reading from the connection again.
+	if ( conn->handshakeRecvBuffer.size() ) {
+		int n = std::min<int>( len, conn->handshakeRecvBuffer.size() );
+		memcpy( buf, &conn->handshakeRecvBuffer[0], n );
+		conn->handshakeRecvBuffer.erase( conn->handshakeRecvBuffer.begin(), conn->handshakeRecvBuffer.begin() + n );
+		return n;
+	}
+	if ( conn->offloadingHandshake )
+		return 0;
+
 	try {
 		int r = conn->conn->read( buf, buf + len );
 		return r;
@@ -70,16 +91,96 @@ static int recv_func(void* ctx, uint8_t* buf, int len) {
 	}
 }
 
+// Handshake crypto (the private key operation in particular) costs milliseconds, so when possible
+// the handshake steps run on this small shared pool instead of the network thread.  Record
+// encryption stays inline: the ITLSSession callbacks write directly to the connection, which can
+// only be touched from the network thread.
+struct TLSHandshakeWorker : IThreadPoolReceiver {
+	virtual void init() {}
+
+	struct Handshake : TypedAction<TLSHandshakeWorker, Handshake>, FastAllocated<Handshake> {
+		explicit Handshake( ITLSSession* session ) : session(session) {}
+		virtual double getTimeEstimate() { return 0.001; }
+
+		ITLSSession* session;  // The TLSConnection holding the session is kept alive until done is sent (see TLSConnection::delref)
+		ThreadReturnPromise<int> done;
+	};
+
+	void action( Handshake& h ) {
+		h.done.send( h.session->handshake() );
+	}
+};
+
+static Reference<IThreadPool> handshakePool() {
+	static Reference<IThreadPool> pool;
+	if ( !pool ) {
+		pool = createGenericThreadPool();
+		for(int i = 0; i < FLOW_KNOBS->TLS_HANDSHAKE_THREADS; i++)
+			pool->addThread( new TLSHandshakeWorker() );
+	}
+	return pool;
+}
+
+static const int MAX_HANDSHAKE_RECV_BYTES = 256 * 1024;
+
+// Read whatever ciphertext is available so the next handshake step can consume it off-thread
+static void pumpHandshakeReads( TLSConnection* self ) {
+	uint8_t buf[16384];
+	while ( self->handshakeRecvBuffer.size() < MAX_HANDSHAKE_RECV_BYTES ) {
+		int r = self->conn->read( buf, buf + sizeof(buf) );
+		if ( r <= 0 ) break;
+		self->handshakeRecvBuffer.insert( self->handshakeRecvBuffer.end(), buf, buf + r );
+	}
+}
+
+ACTOR static Future<Void> sendHandshakeWrites( TLSConnection* self ) {
+	while ( self->handshakeSendBuffer.size() ) {
+		SendBuffer sb;
+		sb.bytes_sent = 0;
+		sb.bytes_written = self->handshakeSendBuffer.size();
+		sb.data = &self->handshakeSendBuffer[0];
+		sb.next = 0;
+
+		int w = self->conn->write( &sb );
+		if ( w )
+			self->handshakeSendBuffer.erase( self->handshakeSendBuffer.begin(), self->handshakeSendBuffer.begin() + w );
+		else
+			wait( self->conn->onWritable() );
+	}
+	return Void();
+}
+
 ACTOR static Future<Void> handshake( TLSConnection* self ) {
+	state Reference<IThreadPool> pool;
+	if ( !g_network->isSimulated() && FLOW_KNOBS->TLS_HANDSHAKE_THREADS > 0 )
+		pool = handshakePool();
+
 	loop {
-		int r = self->session->handshake();
+		state int r;
+		if ( pool ) {
+			pumpHandshakeReads( self );
+			state TLSHandshakeWorker::Handshake* step = new TLSHandshakeWorker::Handshake( self->session.getPtr() );
+			state Future<int> stepDone = step->done.getFuture();
+			self->offloadingHandshake = true;
+			pool->post( step );
+			int stepResult = wait( stepDone );  // If we are abandoned, delref() keeps self alive until this is ready
+			self->offloadingHandshake = false;
+			r = stepResult;
+			if ( self->closing ) throw connection_failed();
+			wait( sendHandshakeWrites( self ) );
+		} else {
+			r = self->session->handshake();
+		}
 		if ( r == ITLSSession::SUCCESS ) break;
 		if ( r == ITLSSession::FAILED ) {
 			TraceEvent("TLSConnectionHandshakeError", self->getDebugID()).suppressFor(1.0);
 			throw connection_failed();
 		}
 		ASSERT( r == ITLSSession::WANT_WRITE || r == ITLSSession::WANT_READ );
+		if ( r == ITLSSession::WANT_READ && self->handshakeRecvBuffer.size() )
+			continue;  // The step already has unconsumed input
 		wait( r == ITLSSession::WANT_WRITE ? self->conn->onWritable() : self->conn->onReadable() );
+		if ( self->closing ) throw connection_failed();
 	}
 
 	TraceEvent("TLSConnectionHandshakeSuccessful", self->getDebugID()).suppressFor(1.0).detail("Peer", self->getPeerAddress());
@@ -87,7 +188,22 @@ ACTOR static Future<Void> handshake( TLSConnection* self ) {
 	return Void();
 }
 
-TLSConnection::TLSConnection( Reference<IConnection> const& conn, Reference<ITLSPolicy> const& policy, bool is_client, std::string host) : conn(conn), write_wants(0), read_wants(0), uid(conn->getDebugID()) {
+void TLSConnection::delref() {
+	if ( ReferenceCounted<TLSConnection>::delref_no_destroy() ) {
+		if ( handshook.isReady() ) {
+			delete this;
+		} else {
+			// A handshake step may be running on the handshake pool with a pointer to our session, so
+			// destruction is deferred until the handshake actor reaches a stopping point.  Closing the
+			// underlying connection makes it reach one promptly.
+			closing = true;
+			conn->close();
+			uncancellable( holdWhile( Reference<TLSConnection>::addRef( this ), handshook ) );
+		}
+	}
+}
+
+TLSConnection::TLSConnection( Reference<IConnection> const& conn, Reference<ITLSPolicy> const& policy, bool is_client, std::string host) : conn(conn), write_wants(0), read_wants(0), uid(conn->getDebugID()), offloadingHandshake(false), closing(false) {
 	const char * serverName = host.empty() ? NULL : host.c_str();
 	session = Reference<ITLSSession>( policy->create_session(is_client, serverName, send_func, this, recv_func, this, (void*)&uid) );
 	if ( !session ) {
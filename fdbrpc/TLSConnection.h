@@ -37,8 +37,15 @@ struct TLSConnection : IConnection, ReferenceCounted<TLSConnection> {
 
 	UID uid;
 
+	// Handshake offload state (see handshake() in TLSConnection.actor.cpp).  While a handshake step is
+	// running on the handshake thread pool the session's callbacks use these buffers instead of conn.
+	bool offloadingHandshake;
+	bool closing;
+	std::vector<uint8_t> handshakeRecvBuffer;
+	std::vector<uint8_t> handshakeSendBuffer;
+
 	virtual void addref() { ReferenceCounted<TLSConnection>::addref(); }
-	virtual void delref() { ReferenceCounted<TLSConnection>::delref(); }
+	virtual void delref();
 
 	TLSConnection( Reference<IConnection> const& conn, Reference<ITLSPolicy> const& policy, bool is_client, std::string host);
 	~TLSConnection() {
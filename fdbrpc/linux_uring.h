@@ -0,0 +1,116 @@
+/*
+ * linux_uring.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// io_uring system calls and ring structures.  Like linux_kaio.h, this deliberately
+// avoids a library dependency (liburing) and talks to the kernel interface directly.
+
+#include <linux/fs.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+enum {
+	URING_OP_NOP = 0,
+	URING_OP_READV = 1,
+	URING_OP_WRITEV = 2,
+	URING_OP_FSYNC = 3,
+	URING_OP_READ_FIXED = 4,
+	URING_OP_WRITE_FIXED = 5
+};
+
+enum {
+	URING_SETUP_IOPOLL = 1U << 0,
+	URING_SETUP_SQPOLL = 1U << 1
+};
+
+enum {
+	URING_ENTER_GETEVENTS = 1U << 0,
+	URING_ENTER_SQ_WAKEUP = 1U << 1
+};
+
+enum {
+	URING_SQ_NEED_WAKEUP = 1U << 0
+};
+
+enum {
+	URING_REGISTER_BUFFERS = 0,
+	URING_UNREGISTER_BUFFERS = 1,
+	URING_REGISTER_EVENTFD = 4,
+	URING_UNREGISTER_EVENTFD = 5
+};
+
+enum {
+	URING_OFF_SQ_RING = 0ULL,
+	URING_OFF_CQ_RING = 0x8000000ULL,
+	URING_OFF_SQES = 0x10000000ULL
+};
+
+struct uring_sqe {
+	uint8_t opcode;
+	uint8_t flags;
+	uint16_t ioprio;
+	int32_t fd;
+	uint64_t off;
+	uint64_t addr;
+	uint32_t len;
+	uint32_t rw_flags;
+	uint64_t user_data;
+	union {
+		uint16_t buf_index;
+		uint64_t pad2[3];
+	};
+};
+
+struct uring_cqe {
+	uint64_t user_data;
+	int32_t res;
+	uint32_t flags;
+};
+
+struct uring_sqring_offsets {
+	uint32_t head, tail, ring_mask, ring_entries, flags, dropped, array, resv1;
+	uint64_t resv2;
+};
+
+struct uring_cqring_offsets {
+	uint32_t head, tail, ring_mask, ring_entries, overflow, cqes;
+	uint64_t resv[2];
+};
+
+struct uring_params {
+	uint32_t sq_entries, cq_entries, flags, sq_thread_cpu, sq_thread_idle, features;
+	uint32_t resv[4];
+	struct uring_sqring_offsets sq_off;
+	struct uring_cqring_offsets cq_off;
+};
+
+static int io_uring_setup(unsigned entries, struct uring_params* p) { return syscall( __NR_io_uring_setup, entries, p ); }
+static int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) { return syscall( __NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0 ); }
+static int io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) { return syscall( __NR_io_uring_register, fd, opcode, arg, nr_args ); }
@@ -925,7 +925,10 @@ public:
 			}
 			//if (!randLog/* && now() >= 32.0*/)
 			//	randLog = fopen("randLog.txt", "wt");
-			Task t = std::move( self->tasks.top() ); // Unfortunately still a copy under gcc where .top() returns const&
+			// .top() returns a const&, so cast it away to actually move instead of copying the
+			// promise and refcounts once per simulated event.  The task is removed immediately
+			// after, so nothing observes the moved-from state.
+			Task t = std::move( const_cast<Task&>( self->tasks.top() ) );
 			self->currentTaskID = t.taskID;
 			self->tasks.pop();
 			self->mutex.leave();
@@ -0,0 +1,81 @@
+/*
+ * BloomFilter.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBSERVER_BLOOMFILTER_H
+#define FDBSERVER_BLOOMFILTER_H
+#pragma once
+
+#include "flow/flow.h"
+#include "flow/Hash3.h"
+
+// A blocked bloom filter: bits are grouped into cache-line sized blocks and all probes for a
+// key land in one block, so a membership test touches a single cache line.  The storage server
+// maintains one of these over the durable keys of each shard it has fetched, so that point
+// reads of keys that were never written can be answered without a trip to the disk subsystem.
+// A key may only be inserted, never removed; clears just leave stale bits behind, which can
+// produce false positives but never false negatives.
+class BlockedBloomFilter : public ReferenceCounted<BlockedBloomFilter> {
+public:
+	BlockedBloomFilter( int64_t maxKeys, int bitsPerKey ) : numKeys(0), maxKeys(maxKeys) {
+		int64_t bits = std::max<int64_t>( maxKeys * bitsPerKey, BITS_PER_BLOCK );
+		blocks.resize( (bits + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK * WORDS_PER_BLOCK, 0 );
+	}
+
+	void insert( KeyRef key ) {
+		uint32_t h1 = 0xcafebabe, h2 = 0xdeadbeef;
+		hashlittle2( key.begin(), key.size(), &h1, &h2 );
+		uint64_t* block = blockFor( h1 );
+		for(int i = 0; i < PROBES; i++) {
+			uint32_t bit = (h2 + i*h1) % BITS_PER_BLOCK;
+			block[ bit >> 6 ] |= uint64_t(1) << (bit & 63);
+		}
+		++numKeys;
+	}
+
+	// If false, the key has definitely never been inserted
+	bool maybeContains( KeyRef key ) const {
+		uint32_t h1 = 0xcafebabe, h2 = 0xdeadbeef;
+		hashlittle2( key.begin(), key.size(), &h1, &h2 );
+		uint64_t const* block = blockFor( h1 );
+		for(int i = 0; i < PROBES; i++) {
+			uint32_t bit = (h2 + i*h1) % BITS_PER_BLOCK;
+			if (!( block[ bit >> 6 ] & (uint64_t(1) << (bit & 63)) ))
+				return false;
+		}
+		return true;
+	}
+
+	// Once more than maxKeys keys have been inserted the false positive rate degrades past what
+	// the filter was sized for, and the owner should stop using it
+	bool full() const { return numKeys > maxKeys; }
+
+	int64_t sizeBytes() const { return blocks.size() * sizeof(uint64_t); }
+
+private:
+	enum { BITS_PER_BLOCK = 512, WORDS_PER_BLOCK = BITS_PER_BLOCK / 64, PROBES = 6 };
+
+	std::vector<uint64_t> blocks;
+	int64_t numKeys, maxKeys;
+
+	uint64_t* blockFor( uint32_t h ) { return &blocks[ (h % uint32_t(blocks.size() / WORDS_PER_BLOCK)) * WORDS_PER_BLOCK ]; }
+	uint64_t const* blockFor( uint32_t h ) const { return &blocks[ (h % uint32_t(blocks.size() / WORDS_PER_BLOCK)) * WORDS_PER_BLOCK ]; }
+};
+
+#endif
@@ -628,7 +628,7 @@ public:
 				vector<Optional<Key>> dcPriority;
 				dcPriority.push_back(regions[0].dcId);
 				dcPriority.push_back(regions[1].dcId);
-				desiredDcIds.set(dcPriority);
+				setDesiredDcIds(dcPriority);
 				if(reply.isError()) {
 					throw reply.getError();
 				} else if(clusterControllerDcId.present() && regions[0].dcId == clusterControllerDcId.get()) {
@@ -649,7 +649,7 @@ public:
 					vector<Optional<Key>> dcPriority;
 					dcPriority.push_back(regions[1].dcId);
 					dcPriority.push_back(regions[0].dcId);
-					desiredDcIds.set(dcPriority);
+					setDesiredDcIds(dcPriority);
 				}
 				if(reply.isError()) {
 					throw reply.getError();
@@ -661,7 +661,7 @@ public:
 		} else if(req.configuration.regions.size() == 1) {
 			vector<Optional<Key>> dcPriority;
 			dcPriority.push_back(req.configuration.regions[0].dcId);
-			desiredDcIds.set(dcPriority);
+			setDesiredDcIds(dcPriority);
 			auto reply = findWorkersForConfiguration(req, req.configuration.regions[0].dcId);
 			if(reply.isError()) {
 				throw reply.getError();
@@ -739,11 +739,11 @@ public:
 			if(bestDC != clusterControllerDcId) {
 				vector<Optional<Key>> dcPriority;
 				dcPriority.push_back(bestDC);
-				desiredDcIds.set(dcPriority);
+				setDesiredDcIds(dcPriority);
 				throw no_more_servers();
 			}
 			//If this cluster controller dies, do not prioritize recruiting the next one in the same DC
-			desiredDcIds.set(vector<Optional<Key>>());
+			setDesiredDcIds(vector<Optional<Key>>());
 			TraceEvent("FindWorkersForConfig").detail("Replication", req.configuration.tLogReplicationFactor)
 				.detail("DesiredLogs", req.configuration.getDesiredLogs()).detail("ActualLogs", result.tLogs.size())
 				.detail("DesiredProxies", req.configuration.getDesiredProxies()).detail("ActualProxies", result.proxies.size())
@@ -759,6 +759,56 @@ public:
 		}
 	}
 
+	// findWorkersForConfiguration is also called speculatively to keep the warm recruitment plan
+	// fresh, so only fire the desired DC watchers when the priorities actually change
+	void setDesiredDcIds( vector<Optional<Key>> const& dcPriority ) {
+		if( !desiredDcIds.get().present() || desiredDcIds.get().get() != dcPriority ) {
+			desiredDcIds.set( dcPriority );
+		}
+	}
+
+	// The warm recruitment plan is a precomputed answer to the last recruitment request we served,
+	// refreshed as workers come and go and when a new master is chosen, so that a recovery can
+	// recruit from the plan immediately instead of re-running recruitment while the database is
+	// unavailable.
+	bool warmRecruitmentPlanValid( RecruitFromConfigurationRequest const& req ) {
+		if( !warmRecruitmentRequest.present() || !warmRecruitmentPlan.present() || warmRecruitmentMasterProcessId != masterProcessId )
+			return false;
+
+		auto& last = warmRecruitmentRequest.get();
+		if( !(last.configuration == req.configuration) || last.recruitSeedServers != req.recruitSeedServers || last.maxOldLogRouters != req.maxOldLogRouters )
+			return false;
+
+		auto& plan = warmRecruitmentPlan.get();
+		for( auto workers : { &plan.tLogs, &plan.satelliteTLogs, &plan.proxies, &plan.resolvers, &plan.storageServers, &plan.oldLogRouters } ) {
+			for( auto& w : *workers ) {
+				auto info = id_worker.find( w.locality.processId() );
+				if( info == id_worker.end() || info->second.interf.id() != w.id() || !workerAvailable( info->second, false ) )
+					return false;
+			}
+		}
+		return true;
+	}
+
+	void storeWarmRecruitmentPlan( RecruitFromConfigurationRequest const& req, RecruitFromConfigurationReply const& plan ) {
+		warmRecruitmentRequest = req;
+		warmRecruitmentPlan = plan;
+		warmRecruitmentMasterProcessId = masterProcessId;
+	}
+
+	void refreshWarmRecruitmentPlan() {
+		if( !warmRecruitmentRequest.present() )
+			return;
+		try {
+			warmRecruitmentPlan = findWorkersForConfiguration( warmRecruitmentRequest.get() );
+			warmRecruitmentMasterProcessId = masterProcessId;
+		} catch( Error& e ) {
+			if( e.code() != error_code_no_more_servers && e.code() != error_code_operation_failed )
+				throw;
+			warmRecruitmentPlan = Optional<RecruitFromConfigurationReply>();
+		}
+	}
+
 	void checkRegions(const std::vector<RegionInfo>& regions) {
 		if(desiredDcIds.get().present() && desiredDcIds.get().get().size() == 2 && desiredDcIds.get().get()[0].get() == regions[0].dcId && desiredDcIds.get().get()[1].get() == regions[1].dcId) {
 			return;
@@ -1004,6 +1054,9 @@ public:
 	AsyncVar<std::pair<bool,Optional<vector<Optional<Key>>>>> changingDcIds; //current DC priorities to change first, and whether that is the cluster controller
 	AsyncVar<std::pair<bool,Optional<vector<Optional<Key>>>>> changedDcIds; //current DC priorities to change second, and whether the cluster controller has been changed
 	UID id;
+	Optional<RecruitFromConfigurationRequest> warmRecruitmentRequest;  // Parameters of the last recruitment we served, used to keep the plan below fresh
+	Optional<RecruitFromConfigurationReply> warmRecruitmentPlan;
+	Optional<Standalone<StringRef>> warmRecruitmentMasterProcessId;  // The master process the plan was computed around
 	std::vector<RecruitFromConfigurationRequest> outstandingRecruitmentRequests;
 	std::vector<RecruitRemoteFromConfigurationRequest> outstandingRemoteRecruitmentRequests;
 	std::vector<std::pair<RecruitStorageRequest, double>> outstandingStorageRequests;
@@ -1077,6 +1130,7 @@ ACTOR Future<Void> clusterWatchDatabase( ClusterControllerData* cluster, Cluster
 			rmq.forceRecovery = db->forceRecovery;
 
 			cluster->masterProcessId = masterWorker.worker.first.locality.processId();
+			cluster->refreshWarmRecruitmentPlan();  // so the new master's recruitment can be served from the plan
 			cluster->db.unfinishedRecoveries++;
 			ErrorOr<MasterInterface> newMaster = wait( masterWorker.worker.first.master.tryGetReply( rmq ) );
 			if (newMaster.present()) {
@@ -1211,7 +1265,9 @@ void checkOutstandingRecruitmentRequests( ClusterControllerData* self ) {
 	for( int i = 0; i < self->outstandingRecruitmentRequests.size(); i++ ) {
 		RecruitFromConfigurationRequest& req = self->outstandingRecruitmentRequests[i];
 		try {
-			req.reply.send( self->findWorkersForConfiguration( req ) );
+			RecruitFromConfigurationReply rep = self->findWorkersForConfiguration( req );
+			self->storeWarmRecruitmentPlan( req, rep );
+			req.reply.send( rep );
 			swapAndPop( &self->outstandingRecruitmentRequests, i-- );
 		} catch (Error& e) {
 			if (e.code() == error_code_no_more_servers || e.code() == error_code_operation_failed) {
@@ -1277,6 +1333,7 @@ ACTOR Future<Void> doCheckOutstandingRequests( ClusterControllerData* self ) {
 		checkOutstandingRecruitmentRequests( self );
 		checkOutstandingRemoteRecruitmentRequests( self );
 		checkOutstandingStorageRequests( self );
+		self->refreshWarmRecruitmentPlan();
 
 		self->checkRecoveryStalled();
 		if (self->betterMasterExists()) {
@@ -1517,7 +1574,14 @@ ACTOR Future<Void> clusterRecruitFromConfiguration( ClusterControllerData* self,
 	TEST(true); //ClusterController RecruitTLogsRequest
 	loop {
 		try {
-			req.reply.send( self->findWorkersForConfiguration( req ) );
+			if( self->warmRecruitmentPlanValid( req ) ) {
+				TEST(true); //ClusterController recruitment served from warm plan
+				req.reply.send( self->warmRecruitmentPlan.get() );
+				return Void();
+			}
+			RecruitFromConfigurationReply rep = self->findWorkersForConfiguration( req );
+			self->storeWarmRecruitmentPlan( req, rep );
+			req.reply.send( rep );
 			return Void();
 		} catch (Error& e) {
 			if (e.code() == error_code_no_more_servers && now() - self->startTime >= SERVER_KNOBS->WAIT_FOR_GOOD_RECRUITMENT_DELAY) {
@@ -1812,6 +1876,9 @@ ACTOR Future<Void> statusServer(FutureStream< StatusRequest> requests,
 	// Place to accumulate a batch of requests to respond to
 	state std::vector<StatusRequest> requests_batch;
 
+	// Caches worker event and role metrics fan-out results between requests
+	state StatusEventCache eventCache;
+
 	loop {
 		try {
 			// Wait til first request is ready
@@ -1845,22 +1912,57 @@ ACTOR Future<Void> statusServer(FutureStream< StatusRequest> requests,
 				}
 			}
 
-			state ErrorOr<StatusReply> result = wait(errorOr(clusterGetStatus(self->db.serverInfo, self->cx, workers, self->db.workersWithIssues, self->db.clientsWithIssues, self->db.clientVersionMap, self->db.traceLogGroupMap, coordinators, incompatibleConnections, self->datacenterVersionDifference)));
+			state ErrorOr<StatusReply> result = wait(errorOr(clusterGetStatus(self->db.serverInfo, self->cx, workers, self->db.workersWithIssues, self->db.clientsWithIssues, self->db.clientVersionMap, self->db.traceLogGroupMap, coordinators, incompatibleConnections, self->datacenterVersionDifference, &eventCache)));
 			if (result.isError() && result.getError().code() == error_code_actor_cancelled)
 				throw result.getError();
 
 			// Update last_request_time now because GetStatus is finished and the delay is to be measured between requests
 			last_request_time = now();
 
+			// If any requester presented section hashes from a previous document, split the new
+			// document into its top level sections once so those requesters can be sent just the
+			// sections they don't already have.
+			state std::vector<std::pair<std::string, std::string>> sections;
+			state std::vector<std::pair<std::string, uint64_t>> sectionHashes;
+			state bool deltaAvailable = false;
+			if (!result.isError()) {
+				bool anyKnown = false;
+				for (auto& req : requests_batch)
+					anyKnown = anyKnown || !req.knownSections.empty();
+				if (anyKnown && splitJsonObjectText(result.get().statusStr, &sections)) {
+					for (auto& s : sections)
+						sectionHashes.push_back(std::make_pair(s.first, hashJsonText(s.second)));
+					deltaAvailable = true;
+				}
+			}
+
 			while (!requests_batch.empty())
 			{
 				if (result.isError())
 					requests_batch.back().reply.sendError(result.getError());
-				else
-					requests_batch.back().reply.send(result.get());
+				else {
+					StatusRequest& req = requests_batch.back();
+					if (deltaAvailable && !req.knownSections.empty()) {
+						std::map<std::string, uint64_t> known(req.knownSections.begin(), req.knownSections.end());
+						StatusReply deltaReply;
+						deltaReply.delta = true;
+						deltaReply.sectionHashes = sectionHashes;
+						for (int i = 0; i < sections.size(); i++) {
+							auto it = known.find(sections[i].first);
+							if (it == known.end() || it->second != sectionHashes[i].second)
+								deltaReply.changedSections.push_back(sections[i]);
+						}
+						TEST(deltaReply.changedSections.size() < sections.size()); // Status delta reply omitted unchanged sections
+						req.reply.send(deltaReply);
+					}
+					else
+						req.reply.send(result.get());
+				}
 				requests_batch.pop_back();
 				wait( yield() );
 			}
+			sections.clear();
+			sectionHashes.clear();
 		}
 		catch (Error &e) {
 			TraceEvent(SevError, "StatusServerError").error(e);
@@ -33,14 +33,9 @@ static int nextPowerOfTwo(int n) {
 static int less(StringRef a, StringRef b) {
 	int al = a.size(), bl = b.size();
 	int cl = al < bl ? al : bl;
-	uint8_t const* ap = a.begin();
-	uint8_t const* bp = b.begin();
-	for (int i = 0; i < cl; i++) {
-		if (ap[i] < bp[i])
-			return 1;
-		else if (bp[i] < ap[i])
-			return 0;
-	}
+	int p = commonPrefixLength(a.begin(), b.begin(), cl);
+	if (p != cl)
+		return a.begin()[p] < b.begin()[p];
 	return al < bl;
 }
 
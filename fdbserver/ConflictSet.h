@@ -53,9 +53,11 @@ private:
 	bool* transactionConflictStatus;
 
 	void checkIntraBatchConflicts();
+	void sortPointsParallel();
 	void combineWriteConflictRanges();
 	void checkReadConflictRanges();
 	void mergeWriteConflictRanges(Version now);
+	void shardConflictSet();
 	void addConflictRanges(Version now, vector< pair<StringRef,StringRef> >::iterator begin, vector< pair<StringRef,StringRef> >::iterator end, class SkipList* part);
 };
 
@@ -27,7 +27,10 @@
 ACTOR Future<GenerationRegReadReply> waitAndSendRead( RequestStream<GenerationRegReadRequest> to, GenerationRegReadRequest req ) {
 	if( SERVER_KNOBS->BUGGIFY_ALL_COORDINATION || BUGGIFY )
 		wait( delay( SERVER_KNOBS->BUGGIFIED_EVENTUAL_CONSISTENCY*g_random->random01() ) );
+	state double start = now();
 	state GenerationRegReadReply reply = wait( retryBrokenPromise( to, req ) );
+	if( now() - start > SERVER_KNOBS->COORDINATOR_SLOW_REPLY_WARN_LATENCY )
+		TraceEvent(SevWarn, "CoordinatedStateSlowRead").detail("Coordinator", to.getEndpoint().address).detail("Latency", now() - start);
 	if( SERVER_KNOBS->BUGGIFY_ALL_COORDINATION || BUGGIFY )
 		wait( delay( SERVER_KNOBS->BUGGIFIED_EVENTUAL_CONSISTENCY*g_random->random01() ) );
 	return reply;
@@ -36,7 +39,10 @@ ACTOR Future<GenerationRegReadReply> waitAndSendRead( RequestStream<GenerationRe
 ACTOR Future<UniqueGeneration> waitAndSendWrite(RequestStream<GenerationRegWriteRequest> to, GenerationRegWriteRequest req) {
 	if( SERVER_KNOBS->BUGGIFY_ALL_COORDINATION || BUGGIFY )
 		wait( delay( SERVER_KNOBS->BUGGIFIED_EVENTUAL_CONSISTENCY*g_random->random01() ) );
+	state double start = now();
 	state UniqueGeneration reply = wait( retryBrokenPromise( to, req ) );
+	if( now() - start > SERVER_KNOBS->COORDINATOR_SLOW_REPLY_WARN_LATENCY )
+		TraceEvent(SevWarn, "CoordinatedStateSlowWrite").detail("Coordinator", to.getEndpoint().address).detail("Latency", now() - start);
 	if( SERVER_KNOBS->BUGGIFY_ALL_COORDINATION || BUGGIFY )
 		wait( delay( SERVER_KNOBS->BUGGIFIED_EVENTUAL_CONSISTENCY*g_random->random01() ) );
 	return reply;
@@ -64,6 +70,8 @@ struct CoordinatedStateImpl {
 	bool doomed;
 	ActorCollection ac; //Errors are not reported
 	bool initial;
+	Optional<Value> cachedValue;    // The last value we read, identified by cachedValueGen; repeated reads of unchanged
+	UniqueGeneration cachedValueGen;  // state validate against this generation without resending the value
 
 	CoordinatedStateImpl( ServerCoordinators const& c ) : coordinators(c), stage(0), conflictGen(0), doomed(false), ac(false), initial(false) {}
 	uint64_t getConflict() { return conflictGen; }
@@ -131,7 +139,7 @@ struct CoordinatedStateImpl {
 		state vector< Future<GenerationRegReadReply> > rep_empty_reply;
 		state vector< Future<GenerationRegReadReply> > rep_reply;
 		for(int i=0; i<replicas.size(); i++) {
-			Future<GenerationRegReadReply> reply = waitAndSendRead( replicas[i].read, GenerationRegReadRequest(req.key, req.gen) );
+			Future<GenerationRegReadReply> reply = waitAndSendRead( replicas[i].read, GenerationRegReadRequest(req.key, req.gen, self->cachedValueGen) );
 			rep_empty_reply.push_back( nonemptyToNever( reply ) );
 			rep_reply.push_back( emptyToNever( reply ) );
 			self->ac.add( success( reply ) );
@@ -161,10 +169,23 @@ struct CoordinatedStateImpl {
 				}
 			ASSERT( best >= 0 );
 			auto result = rep_reply[best].get();
+			if (result.valueCached) {
+				// The coordinator elided the value because it matched our cache; a write with the same
+				// unique generation always carries the same value, so the cached copy is authoritative
+				TEST(true);  //Coordinated state read served from cached value
+				ASSERT( result.gen == self->cachedValueGen );
+				result.value = self->cachedValue;
+			} else {
+				self->cachedValue = result.value;
+				self->cachedValueGen = result.gen;
+			}
 			return result;
 		}
 	}
 
+	// Writes are sent to all coordinators concurrently and complete on the fastest majority (except
+	// the initial write, which must be unanimous so a later read cannot see a majority empty); a
+	// distant or slow coordinator therefore only adds latency when it is needed to form the majority
 	ACTOR static Future<UniqueGeneration> replicatedWrite( CoordinatedStateImpl* self, GenerationRegWriteRequest req ) {
 		state std::vector<GenerationRegInterface> &replicas = self->coordinators.stateServers;
 		state vector< Future<UniqueGeneration> > wrep_reply;
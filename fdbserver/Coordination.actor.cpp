@@ -138,7 +138,14 @@ ACTOR Future<Void> localGenerationReg( GenerationRegInterface interf, OnDemandSt
 				store->set( KeyValueRef( req.key, BinaryWriter::toValue(v, IncludeVersion()) ) );
 				wait(store->commit());
 			}
-			req.reply.send( GenerationRegReadReply( v.val, v.writeGen, v.readGen ) );
+			if (v.val.present() && v.writeGen.generation > 0 && v.writeGen == req.cachedGen) {
+				// The requester already has this value cached; a write with the same unique generation
+				// always carries the same value, so validate the generations without resending it
+				GenerationRegReadReply reply( Optional<Value>(), v.writeGen, v.readGen );
+				reply.valueCached = true;
+				req.reply.send( reply );
+			} else
+				req.reply.send( GenerationRegReadReply( v.val, v.writeGen, v.readGen ) );
 		}
 		when ( GenerationRegWriteRequest _wrq = waitNext( interf.write.getFuture() ) ) {
 			state GenerationRegWriteRequest wrq = _wrq;
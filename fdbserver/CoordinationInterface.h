@@ -73,23 +73,26 @@ struct UniqueGeneration {
 struct GenerationRegReadRequest {
 	Key key;
 	UniqueGeneration gen;
+	UniqueGeneration cachedGen;  // if this matches the stored write generation, the (unchanged) value is omitted from the reply
 	ReplyPromise<struct GenerationRegReadReply> reply;
 	GenerationRegReadRequest(){}
 	GenerationRegReadRequest( Key key, UniqueGeneration gen ) : key(key), gen(gen) {}
+	GenerationRegReadRequest( Key key, UniqueGeneration gen, UniqueGeneration cachedGen ) : key(key), gen(gen), cachedGen(cachedGen) {}
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & key & gen & reply;
+		ar & key & gen & cachedGen & reply;
 	}
 };
 
 struct GenerationRegReadReply {
 	Optional<Value> value;
 	UniqueGeneration gen, rgen;
-	GenerationRegReadReply() {}
-	GenerationRegReadReply( Optional<Value> value, UniqueGeneration gen, UniqueGeneration rgen ) : value(value), gen(gen), rgen(rgen) {}
+	bool valueCached;  // the value was omitted because it matches the requester's cachedGen
+	GenerationRegReadReply() : valueCached(false) {}
+	GenerationRegReadReply( Optional<Value> value, UniqueGeneration gen, UniqueGeneration rgen ) : value(value), gen(gen), rgen(rgen), valueCached(false) {}
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & value & gen & rgen;
+		ar & value & gen & rgen & valueCached;
 	}
 };
 
@@ -98,13 +98,22 @@ class WorkPool : public IThreadPool, public ReferenceCounted<WorkPool<Threadlike
 
 	// Pool can survive the destruction of WorkPool while it waits for workers to terminate
 	struct Pool : ReferenceCounted<Pool> {
+		// Actions are segregated into priority lanes; every worker drains the high lane before
+		// taking low priority work, so bulk work uses idle capacity without queueing ahead of
+		// latency-critical actions
+		struct Lane {
+			Deque<std::pair<PThreadAction, double>> work;  // action, and the timer_monotonic() at which it was posted
+			ThreadPoolQueueStats stats;
+		};
+
 		Mutex queueLock;
-		Deque<PThreadAction> work;
+		Lane lanes[2];
+		int reservedWorkers;  // the first this many workers added take only high priority work while the pool has any other worker
 		std::vector<Worker*> idle, workers;
 		ActorCollection anyError, allStopped;
 		Future<Void> m_holdRefUntilStopped;
 
-		Pool() : anyError(false), allStopped(true) {
+		explicit Pool(int reservedWorkers) : reservedWorkers(reservedWorkers), anyError(false), allStopped(true) {
 			m_holdRefUntilStopped = holdRefUntilStopped(this);
 		}
 
@@ -124,27 +133,44 @@ class WorkPool : public IThreadPool, public ReferenceCounted<WorkPool<Threadlike
 	struct Worker : Threadlike {
 		Pool* pool;
 		IThreadPoolReceiver* userData;
+		bool highPriorityOnly;
 		bool stop;
 		ThreadReturnPromise<Void> stopped;
 		ThreadReturnPromise<Void> error;
 
-		Worker( Pool* pool,  IThreadPoolReceiver* userData ) : pool(pool), userData(userData), stop(false) {
+		Worker( Pool* pool,  IThreadPoolReceiver* userData, bool highPriorityOnly ) : pool(pool), userData(userData), highPriorityOnly(highPriorityOnly), stop(false) {
+		}
+
+		// A reserved worker takes low priority work only when it is the pool's sole capacity, so a
+		// one-thread pool can't strand the low lane
+		bool canTake( int lane ) const {
+			return lane == IThreadPool::High || !highPriorityOnly || (int)pool->workers.size() <= pool->reservedWorkers;
 		}
 
 		virtual void run() {
 			try {
 				if(!stop)
 					userData->init();
-				
+
 				while (!stop) {
 					pool->queueLock.enter();
-					if (pool->work.empty()) {
+					int lane = -1;
+					for(int l = 0; l < 2; l++)
+						if (pool->lanes[l].work.size() && canTake(l)) {
+							lane = l;
+							break;
+						}
+					if (lane < 0) {
 						pool->idle.push_back( this );
 						pool->queueLock.leave();
 						Threadlike::block();
 					} else {
-						PThreadAction a = pool->work.front();
-						pool->work.pop_front();
+						PThreadAction a = pool->lanes[lane].work.front().first;
+						double queueDelay = timer_monotonic() - pool->lanes[lane].work.front().second;
+						pool->lanes[lane].work.pop_front();
+						++pool->lanes[lane].stats.started;
+						pool->lanes[lane].stats.totalQueueDelay += queueDelay;
+						pool->lanes[lane].stats.maxQueueDelay = std::max( pool->lanes[lane].stats.maxQueueDelay, queueDelay );
 						pool->queueLock.leave();
 						(*a)(userData);
 						if(IS_CORO) CoroThreadPool::waitFor(yield());
@@ -194,7 +220,7 @@ class WorkPool : public IThreadPool, public ReferenceCounted<WorkPool<Threadlike
 	}
 
 public:
-	WorkPool() : pool( new Pool ) {
+	explicit WorkPool(int reservedWorkers = 0) : pool( new Pool(reservedWorkers) ) {
 		m_stopOnError = stopOnError( this );
 	}
 
@@ -202,8 +228,8 @@ public:
 	virtual void addThread( IThreadPoolReceiver* userData ) {
 		checkError();
 
-		auto w = new Worker(pool.getPtr(), userData);
 		pool->queueLock.enter();
+		auto w = new Worker(pool.getPtr(), userData, (int)pool->workers.size() < pool->reservedWorkers);
 		pool->workers.push_back( w );
 		pool->queueLock.leave();
 		pool->anyError.add( w->error.getFuture() );
@@ -217,28 +243,47 @@ public:
 		w->start();
 	}
 	virtual void post( PThreadAction action ) {
+		post( action, High );
+	}
+	virtual void post( PThreadAction action, int priority ) {
 		checkError();
+		ASSERT( priority == High || priority == Low );
 
 		pool->queueLock.enter();
-		pool->work.push_back(action);
-		if (!pool->idle.empty()) {
-			Worker* c = pool->idle.back();
-			pool->idle.pop_back();
-			pool->queueLock.leave();
-			c->unblock();
-		} else
-			pool->queueLock.leave();
+		pool->lanes[priority].work.push_back( std::make_pair(action, timer_monotonic()) );
+		++pool->lanes[priority].stats.posted;
+		// Wake an idle worker that is allowed to take this lane's work; a reserved worker woken for
+		// low priority work would just go idle again without unsticking the queue
+		Worker* c = NULL;
+		for(int i=pool->idle.size()-1; i>=0; i--)
+			if (pool->idle[i]->canTake(priority)) {
+				c = pool->idle[i];
+				pool->idle.erase( pool->idle.begin() + i );
+				break;
+			}
+		pool->queueLock.leave();
+		if (c) c->unblock();
+	}
+	virtual ThreadPoolQueueStats getAndResetQueueStats( int priority ) {
+		ASSERT( priority == High || priority == Low );
+		pool->queueLock.enter();
+		ThreadPoolQueueStats r = pool->lanes[priority].stats;
+		pool->lanes[priority].stats = ThreadPoolQueueStats();
+		pool->queueLock.leave();
+		return r;
 	}
 	virtual Future<Void> stop() {
 		if (error.code() == invalid_error_code) error = success();
 
 		pool->queueLock.enter();
 		TraceEvent("WorkPool_Stop").detail("Workers", pool->workers.size()).detail("Idle", pool->idle.size())
-			.detail("Work", pool->work.size());
+			.detail("Work", pool->lanes[High].work.size() + pool->lanes[Low].work.size());
 
-		for(int i=0; i<pool->work.size(); i++)
-			pool->work[i]->cancel();   // What if cancel() does something to this?
-		pool->work.clear();
+		for(int l=0; l<2; l++) {
+			for(int i=0; i<pool->lanes[l].work.size(); i++)
+				pool->lanes[l].work[i].first->cancel();   // What if cancel() does something to this?
+			pool->lanes[l].work.clear();
+		}
 		for(int i=0; i<pool->workers.size(); i++)
 			pool->workers[i]->stop = true;
 
@@ -273,14 +318,61 @@ ACTOR void coroSwitcher( Future<Void> what, int taskID, Coro* coro ) {
 	Coro_switchTo_( swapCoro(coro), coro );
 }
 
+// The stackless equivalent of the coroSwitcher actor: the same state machine the actor
+// compiler would emit -- wait for `what', hop through delay(0, taskID) so the fiber
+// resumes at the right priority, then switch to it -- hand-written as one FastAllocated
+// object so each blocking VFS wait costs two callback registrations instead of an actor
+// with its own state and cancellation bookkeeping.  Errors from `what' are swallowed
+// here just as they are in coroSwitcher; the fiber rediscovers them from the future.
+struct CoroSwitcher;
+template <int Stage>
+struct CoroSwitcherCallback : Callback<Void> {
+	CoroSwitcher* self() { return static_cast<CoroSwitcher*>(this); }
+	virtual void fire(Void const&);
+	virtual void error(Error);
+};
+
+template <> void CoroSwitcherCallback<1>::fire(Void const&);
+template <> void CoroSwitcherCallback<1>::error(Error);
+template <> void CoroSwitcherCallback<2>::fire(Void const&);
+template <> void CoroSwitcherCallback<2>::error(Error);
+
+struct CoroSwitcher : CoroSwitcherCallback<1>, CoroSwitcherCallback<2>, FastAllocated<CoroSwitcher> {
+	int taskID;
+	Coro* coro;
+
+	CoroSwitcher( Future<Void> what, int taskID, Coro* coro ) : taskID(taskID), coro(coro) {
+		what.addCallbackAndClear( static_cast<CoroSwitcherCallback<1>*>(this) );
+	}
+
+	void waited() {
+		static_cast<CoroSwitcherCallback<1>*>(this)->remove();
+		Future<Void> hop = delay(0, taskID);
+		hop.addCallbackAndClear( static_cast<CoroSwitcherCallback<2>*>(this) );
+	}
+
+	void resume() {
+		static_cast<CoroSwitcherCallback<2>*>(this)->remove();
+		Coro* c = coro;
+		delete this;
+		Coro_switchTo_( swapCoro(c), c );
+	}
+};
 
+template <> void CoroSwitcherCallback<1>::fire(Void const&) { self()->waited(); }
+template <> void CoroSwitcherCallback<1>::error(Error) { self()->waited(); }
+template <> void CoroSwitcherCallback<2>::fire(Void const&) { self()->resume(); }
+template <> void CoroSwitcherCallback<2>::error(Error) { self()->resume(); }
 
 void CoroThreadPool::waitFor( Future<Void> what ) {
 	ASSERT (current_coro != main_coro);
 	if (what.isReady()) return;
 	Coro* c = current_coro;
 	double t = now();
-	coroSwitcher( what, g_network->getCurrentTask(), current_coro );
+	if (FLOW_KNOBS->CORO_STACKLESS_SWITCHER)
+		new CoroSwitcher( what, g_network->getCurrentTask(), current_coro );
+	else
+		coroSwitcher( what, g_network->getCurrentTask(), current_coro );
 	Coro_switchTo_( swapCoro(main_coro), main_coro );
 	//if (g_network->isSimulated() && g_simulator.getCurrentProcess()->rebooting && now()!=t)
 	//	TraceEvent("NonzeroWaitDuringReboot").detail("TaskID", currentTaskID).detail("Elapsed", now()-t).backtrace("Coro");
@@ -301,6 +393,6 @@ void CoroThreadPool::init()
 }
 
 
-Reference<IThreadPool> CoroThreadPool::createThreadPool() {
-	return Reference<IThreadPool>( new CoroPool );
+Reference<IThreadPool> CoroThreadPool::createThreadPool( int reservedHighPriorityWorkers ) {
+	return Reference<IThreadPool>( new CoroPool( reservedHighPriorityWorkers ) );
 }
@@ -33,7 +33,10 @@ public:
 	static void init();
 	static void waitFor( Future<Void> what );
 
-	static Reference<IThreadPool> createThreadPool();
+	// The first reservedHighPriorityWorkers workers added take only high priority work (as long as
+	// the pool has any other worker), so posting to the low lane cannot delay high priority actions
+	// behind every worker
+	static Reference<IThreadPool> createThreadPool( int reservedHighPriorityWorkers = 0 );
 
 protected:
 	CoroThreadPool() {}
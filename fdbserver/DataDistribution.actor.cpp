@@ -244,6 +244,18 @@ public:
 		return (physicalBytes + (inflightPenalty*inFlightBytes)) * freeSpaceMultiplier;
 	}
 
+	virtual int64_t getLoadBytesPerKSecond() {
+		int64_t perKSecSum = 0;
+		int added = 0;
+		for(int i=0; i<servers.size(); i++)
+			if( servers[i]->serverMetrics.present() ) {
+				added++;
+				perKSecSum += servers[i]->serverMetrics.get().load.bytesPerKSecond;
+			}
+
+		return added == 0 ? 0 : perKSecSum / added;
+	}
+
 	virtual int64_t getMinFreeSpace( bool includeInFlight = true ) {
 		int64_t minFreeSpace = std::numeric_limits<int64_t>::max();
 		for(int i=0; i<servers.size(); i++) {
@@ -42,6 +42,7 @@ struct RelocateData {
 	int workFactor;
 	std::vector<UID> src;
 	std::vector<UID> completeSources;
+	std::vector<UID> completeDests;
 	bool wantsNewServers;
 	TraceInterval interval;
 
@@ -158,6 +159,12 @@ public:
 		});
 	}
 
+	virtual int64_t getLoadBytesPerKSecond() {
+		return sum([](Reference<IDataDistributionTeam> team) {
+			return team->getLoadBytesPerKSecond();
+		});
+	}
+
 	virtual int64_t getMinFreeSpace(bool includeInFlight = true) {
 		int64_t result = std::numeric_limits<int64_t>::max();
 		for (auto it = teams.begin(); it != teams.end(); it++) {
@@ -285,6 +292,45 @@ int getWorkFactor( RelocateData const& relocation ) {
 		return WORK_FULL_UTILIZATION / relocation.src.size() / SERVER_KNOBS->RELOCATION_PARALLELISM_PER_SOURCE_SERVER;
 }
 
+int getDestWorkFactor() {
+	// Work of the destination servers is counted per server rather than per team, because fetches from
+	// different relocations land on individual servers
+	return WORK_FULL_UTILIZATION / SERVER_KNOBS->RELOCATION_PARALLELISM_PER_DEST_SERVER;
+}
+
+// return true if the destination servers are not too busy to absorb the relocation.  The ledger is
+// bucketed by priority, so outstanding low priority work never blocks a higher priority move.
+bool canLaunchDest( std::vector<std::pair<Reference<IDataDistributionTeam>,bool>> const& candidateTeams, int priority, std::map<UID, Busyness> & destBusymap ) {
+	if( SERVER_KNOBS->RELOCATION_PARALLELISM_PER_DEST_SERVER <= 0 )
+		return true;
+	int workFactor = getDestWorkFactor();
+	for( auto& team : candidateTeams ) {
+		for( UID id : team.first->getServerIDs() ) {
+			if( !destBusymap[id].canLaunch( priority, workFactor ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+// update the busyness of the destination servers; the work is removed in completeDest()
+void launchDest( RelocateData & relocation, std::vector<std::pair<Reference<IDataDistributionTeam>,bool>> const& candidateTeams, std::map<UID, Busyness> & destBusymap ) {
+	ASSERT( relocation.completeDests.empty() );
+	int destWorkFactor = getDestWorkFactor();
+	for( auto& team : candidateTeams ) {
+		for( UID id : team.first->getServerIDs() ) {
+			relocation.completeDests.push_back( id );
+			destBusymap[id].addWork( relocation.priority, destWorkFactor );
+		}
+	}
+}
+
+void completeDest( RelocateData const& relocation, std::map<UID, Busyness> & destBusymap ) {
+	int destWorkFactor = getDestWorkFactor();
+	for( UID id : relocation.completeDests )
+		destBusymap[id].removeWork( relocation.priority, destWorkFactor );
+}
+
 // return true if servers are not too busy to launch the relocation
 bool canLaunch( RelocateData & relocation, int teamSize, std::map<UID, Busyness> & busymap,
 		std::vector<RelocateData> cancellableRelocations ) {
@@ -322,10 +368,11 @@ void launch( RelocateData & relocation, std::map<UID, Busyness> & busymap ) {
 		busymap[ relocation.src[i] ].addWork( relocation.priority, relocation.workFactor );
 }
 
-void complete( RelocateData const& relocation, std::map<UID, Busyness> & busymap ) {
+void complete( RelocateData const& relocation, std::map<UID, Busyness> & busymap, std::map<UID, Busyness> & destBusymap ) {
 	ASSERT( relocation.workFactor > 0 );
 	for( int i = 0; i < relocation.src.size(); i++ )
 		busymap[ relocation.src[i] ].removeWork( relocation.priority, relocation.workFactor );
+	completeDest( relocation, destBusymap );
 }
 
 Future<Void> dataDistributionRelocator( struct DDQueueData* const& self, RelocateData const& rd );
@@ -349,6 +396,7 @@ struct DDQueueData {
 	int teamSize;
 
 	std::map<UID, Busyness> busymap;
+	std::map<UID, Busyness> destBusymap;
 
 	KeyRangeMap< RelocateData > queueMap;
 	std::set<RelocateData, std::greater<RelocateData>> fetchingSourcesQueue;
@@ -881,6 +929,7 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 		ASSERT( rd.src.size() );
 		loop {
 			state int stuckCount = 0;
+			state int destOverloadedCount = 0;
 			// state int bestTeamStuckThreshold = 50;
 			loop {
 				state int tciIndex = 0;
@@ -923,17 +972,29 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 					tciIndex++;
 				}
 				if (foundTeams && anyHealthy) {
-					break;
-				}
+					if( canLaunchDest( bestTeams, rd.priority, self->destBusymap ) ) {
+						break;
+					}
 
-				TEST(true); //did not find a healthy destination team on the first attempt
-				stuckCount++;
-				TraceEvent(stuckCount > 50 ? SevWarnAlways : SevWarn, "BestTeamStuck", masterId)
-				    .suppressFor(1.0)
-				    .detail("Count", stuckCount)
-				    .detail("TeamCollectionId", tciIndex)
-				    .detail("NumOfTeamCollections", self->teamCollections.size());
-				wait( delay( SERVER_KNOBS->BEST_TEAM_STUCK_DELAY, TaskDataDistributionLaunch ) );
+					TEST(true); //all healthy destination teams are too busy with other relocations
+					destOverloadedCount++;
+					TraceEvent(destOverloadedCount > 50 ? SevInfo : SevDebug, "DestSSBusy", masterId)
+					    .suppressFor(1.0)
+					    .detail("StuckCount", stuckCount)
+					    .detail("DestOverloadedCount", destOverloadedCount)
+					    .detail("TeamCollectionId", tciIndex)
+					    .detail("NumOfTeamCollections", self->teamCollections.size());
+					wait( delay( SERVER_KNOBS->DEST_OVERLOADED_DELAY, TaskDataDistributionLaunch ) );
+				} else {
+					TEST(true); //did not find a healthy destination team on the first attempt
+					stuckCount++;
+					TraceEvent(stuckCount > 50 ? SevWarnAlways : SevWarn, "BestTeamStuck", masterId)
+					    .suppressFor(1.0)
+					    .detail("Count", stuckCount)
+					    .detail("TeamCollectionId", tciIndex)
+					    .detail("NumOfTeamCollections", self->teamCollections.size());
+					wait( delay( SERVER_KNOBS->BEST_TEAM_STUCK_DELAY, TaskDataDistributionLaunch ) );
+				}
 			}
 
 			state std::vector<UID> destIds;
@@ -976,6 +1037,11 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 				    .detail("DestTeamSize", totalIds);
 			}
 
+			// Once the transfer has been signalled complete the queue has already settled this relocation's
+			// destination work using the servers it was signalled with, so don't book work for a new team
+			if( !signalledTransferComplete )
+				launchDest( rd, bestTeams, self->destBusymap );
+
 			self->shardsAffectedByTeamFailure->moveShard(rd.keys, destinationTeams);
 
 			//FIXME: do not add data in flight to servers that were already in the src.
@@ -1062,6 +1128,13 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 			} else {
 				TEST(true);  // move to removed server
 				healthyDestinations.addDataInFlightToTeam( -metrics.bytes );
+
+				// If the transfer has already been signalled complete the queue settled the destination
+				// work when it processed the signal, so only unbook it here for unsignalled relocations
+				if( !signalledTransferComplete )
+					completeDest( rd, self->destBusymap );
+				rd.completeDests.clear();
+
 				wait( delay( SERVER_KNOBS->RETRY_RELOCATESHARD_DELAY, TaskDataDistributionLaunch ) );
 			}
 		}
@@ -1093,7 +1166,18 @@ ACTOR Future<bool> rebalanceTeams( DDQueueData* self, int priority, Reference<ID
 
 	int64_t sourceBytes = sourceTeam->getLoadBytes(false);
 	int64_t destBytes = destTeam->getLoadBytes();
-	if( sourceBytes - destBytes <= 3 * std::max<int64_t>( SERVER_KNOBS->MIN_SHARD_BYTES, metrics.bytes ) || metrics.bytes == 0 )
+	int64_t sourceLoad = sourceTeam->getLoadBytesPerKSecond();
+	int64_t destLoad = destTeam->getLoadBytesPerKSecond();
+
+	bool sizeImbalance = metrics.bytes != 0 && sourceBytes - destBytes > 3 * std::max<int64_t>( SERVER_KNOBS->MIN_SHARD_BYTES, metrics.bytes );
+
+	// A team can also be "full" on traffic rather than bytes: a small scan-heavy shard pins its team at
+	// high utilization without ever tripping the size check above, so shards carrying meaningful traffic
+	// may also move from a team serving much more traffic than the destination
+	bool loadImbalance = SERVER_KNOBS->DD_REBALANCE_BY_LOAD && metrics.bytesPerKSecond > SERVER_KNOBS->SHARD_MIN_BYTES_PER_KSEC &&
+		sourceLoad - destLoad > 3 * std::max<int64_t>( SERVER_KNOBS->SHARD_MIN_BYTES_PER_KSEC, metrics.bytesPerKSecond );
+
+	if( !sizeImbalance && !loadImbalance )
 		return false;
 
 	//verify the shard is still in sabtf
@@ -1103,7 +1187,10 @@ ACTOR Future<bool> rebalanceTeams( DDQueueData* self, int priority, Reference<ID
 			TraceEvent(priority == PRIORITY_REBALANCE_OVERUTILIZED_TEAM ? "BgDDMountainChopper" : "BgDDValleyFiller", self->mi.id())
 				.detail("SourceBytes", sourceBytes)
 				.detail("DestBytes", destBytes)
+				.detail("SourceBytesPerKSec", sourceLoad)
+				.detail("DestBytesPerKSec", destLoad)
 				.detail("ShardBytes", metrics.bytes)
+				.detail("ShardBytesPerKSec", metrics.bytesPerKSecond)
 				.detail("SourceTeam", sourceTeam->getDesc())
 				.detail("DestTeam", destTeam->getDesc());
 
@@ -1251,7 +1338,7 @@ ACTOR Future<Void> dataDistributionQueue(
 					launchData = results;
 				}
 				when ( RelocateData done = waitNext( self.dataTransferComplete.getFuture() ) ) {
-					complete( done, self.busymap );
+					complete( done, self.busymap, self.destBusymap );
 					if(serversToLaunchFrom.empty() && !done.src.empty())
 						launchQueuedWorkTimeout = delay(0, TaskDataDistributionLaunch);
 					serversToLaunchFrom.insert(done.src.begin(), done.src.end());
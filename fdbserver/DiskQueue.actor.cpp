@@ -20,6 +20,7 @@
 
 #include "fdbserver/IDiskQueue.h"
 #include "fdbrpc/IAsyncFile.h"
+#include "fdbrpc/crc32c.h"
 #include "fdbserver/Knobs.h"
 #include "fdbrpc/simulator.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
@@ -84,13 +85,16 @@ struct StringBuffer {
 
 struct SyncQueue : ReferenceCounted<SyncQueue> {
 	SyncQueue( int outstandingLimit, Reference<IAsyncFile> file )
-		: outstandingLimit(outstandingLimit), file(file)
+		: outstandingLimit(outstandingLimit), file(file), waiters(0), lastBatch(0)
 	{
 		for(int i=0; i<outstandingLimit; i++)
 			outstanding.push_back( Void() );
+		syncCount.init(LiteralStringRef("RawDiskQueue.SyncCount"));
+		syncedCommitCount.init(LiteralStringRef("RawDiskQueue.SyncedCommitCount"));
 	}
 
 	Future<Void> onSync() {  // Future is set when all writes completed before the call to onSync are complete
+		++waiters;
 		if (outstanding.size() <= outstandingLimit)
 			outstanding.push_back( waitAndSync(this) );
 		return outstanding.back();
@@ -100,10 +104,24 @@ private:
 	int outstandingLimit;
 	Deque<Future<Void>> outstanding;
 	Reference<IAsyncFile> file;
+	int waiters;    // commits waiting on the sync at the back of outstanding
+	int lastBatch;  // commits covered by the most recently started sync
+	Int64MetricHandle syncCount;
+	Int64MetricHandle syncedCommitCount;
 
 	ACTOR static Future<Void> waitAndSync(SyncQueue* self) {
 		wait( self->outstanding.front() );
 		self->outstanding.pop_front();
+		if (self->lastBatch > 1 && SERVER_KNOBS->DISK_QUEUE_SYNC_COALESCE_TIME > 0) {
+			// Group commit: commits are arriving faster than syncs complete, so hold this sync open
+			// briefly so that concurrent commits share it instead of serializing on the next one.
+			// The knob bounds the latency added to the commits already waiting.
+			wait( delay(SERVER_KNOBS->DISK_QUEUE_SYNC_COALESCE_TIME) );
+		}
+		self->lastBatch = self->waiters;
+		self->waiters = 0;
+		self->syncCount++;
+		self->syncedCommitCount += self->lastBatch;
 		wait( self->file->sync() );
 		return Void();
 	}
@@ -114,11 +132,9 @@ public:
 	RawDiskQueue_TwoFiles( std::string basename, std::string fileExtension, UID dbgid, int64_t fileSizeWarningLimit )
 		: basename(basename), fileExtension(fileExtension), onError(delayed(error.getFuture())), onStopped(stopped.getFuture()),
 		readingFile(-1), readingPage(-1), writingPos(-1), dbgid(dbgid),
-		dbg_file0BeginSeq(0), fileExtensionBytes(10<<20), readingBuffer( dbgid ),
+		dbg_file0BeginSeq(0), fileExtensionBytes(SERVER_KNOBS->DISK_QUEUE_FILE_EXTENSION_BYTES), readingBuffer( dbgid ), readAheadBuffer( dbgid ),
 		readyToPush(Void()), fileSizeWarningLimit(fileSizeWarningLimit), lastCommit(Void()), isFirstCommit(true)
 	{
-		if(BUGGIFY)
-			fileExtensionBytes = 8<<10;
 		files[0].dbgFilename = filename(0);
 		files[1].dbgFilename = filename(1);
 		stallCount.init(LiteralStringRef("RawDiskQueue.StallCount"));
@@ -195,8 +211,10 @@ public:
 	bool isFirstCommit;
 
 	StringBuffer readingBuffer; // Pages that have been read and not yet returned
-	int readingFile;  // i if the next page after readingBuffer should be read from files[i], 2 if recovery is complete
-	int64_t readingPage;  // Page within readingFile that is the next page after readingBuffer
+	StringBuffer readAheadBuffer; // Pages being read ahead of readingBuffer during recovery
+	Future<int> readAheadRead; // The outstanding read into readAheadBuffer, if valid
+	int readingFile;  // i if the next page after readingBuffer and readAheadBuffer should be read from files[i], 2 if recovery is complete
+	int64_t readingPage;  // Page within readingFile that is the next page after readingBuffer and readAheadBuffer
 
 	int64_t writingPos;  // Position within files[1] that will be next written
 
@@ -541,6 +559,15 @@ public:
 	}
 
 	Future<int> fillReadingBuffer() {
+		// If the next stride was already read ahead, just take ownership of it
+		if ( readAheadRead.isValid() ) {
+			std::swap( readingBuffer, readAheadBuffer );
+			readAheadBuffer.clear();
+			Future<int> read = readAheadRead;
+			readAheadRead = Future<int>();
+			return read;
+		}
+
 		// If we're right at the end of a file...
 		if ( readingPage*sizeof(Page) >= (size_t)files[readingFile].size ) {
 			readingFile++;
@@ -553,8 +580,8 @@ public:
 			}
 		}
 
-		// Read up to 1MB into readingBuffer
-		int len = std::min<int64_t>( (files[readingFile].size/sizeof(Page) - readingPage)*sizeof(Page), BUGGIFY_WITH_PROB(1.0) ? sizeof(Page)*g_random->randomInt(1,4) : (1<<20) );
+		// Read up to DISK_QUEUE_RECOVERY_READ_BYTES into readingBuffer
+		int len = std::min<int64_t>( (files[readingFile].size/sizeof(Page) - readingPage)*sizeof(Page), BUGGIFY_WITH_PROB(1.0) ? sizeof(Page)*g_random->randomInt(1,4) : SERVER_KNOBS->DISK_QUEUE_RECOVERY_READ_BYTES );
 		readingBuffer.clear();
 		readingBuffer.alignReserve( sizeof(Page), len );
 		void* p = readingBuffer.append(len);
@@ -565,6 +592,31 @@ public:
 		return files[readingFile].f->read( p, len, pos );
 	}
 
+	void startReadAhead() {
+		// Begin reading the next stride of pages while the caller verifies readingBuffer, so that recovery
+		// overlaps page checks with disk reads.  Read ahead never crosses a file boundary, which keeps the
+		// position arithmetic in truncateBeforeLastReadPage() within a single file.
+		ASSERT( !readAheadRead.isValid() );
+		if ( readingFile >= 2 || readingPage*sizeof(Page) >= (size_t)files[readingFile].size )
+			return;
+
+		int len = std::min<int64_t>( (files[readingFile].size/sizeof(Page) - readingPage)*sizeof(Page), BUGGIFY_WITH_PROB(1.0) ? sizeof(Page)*g_random->randomInt(1,4) : SERVER_KNOBS->DISK_QUEUE_RECOVERY_READ_BYTES );
+		readAheadBuffer.clear();
+		readAheadBuffer.alignReserve( sizeof(Page), len );
+		void* p = readAheadBuffer.append(len);
+
+		auto pos = readingPage * sizeof(Page);
+		readingPage += len / sizeof(Page);
+		ASSERT( int64_t(p) % sizeof(Page) == 0 );
+		readAheadRead = readAhead( this, readingFile, p, len, pos );
+	}
+
+	ACTOR static Future<int> readAhead( RawDiskQueue_TwoFiles* self, int file, void* page, int len, int64_t pos ) {
+		state TrackMe trackMe(self);
+		int read = wait( self->files[file].f->read( page, len, pos ) );
+		return read;
+	}
+
 	ACTOR static UNCANCELLABLE Future<Standalone<StringRef>> readNextPage(RawDiskQueue_TwoFiles* self) {
 		state TrackMe trackMe(self);
 
@@ -579,6 +631,7 @@ public:
 
 				int read = wait( self->fillReadingBuffer() );
 				ASSERT( read == self->readingBuffer.size() );
+				self->startReadAhead();
 
 				wait(f);
 			}
@@ -608,13 +661,20 @@ public:
 	ACTOR static Future<Void> truncateBeforeLastReadPage( RawDiskQueue_TwoFiles* self ) {
 		try {
 			state int file = self->readingFile;
-			state int64_t pos = (self->readingPage - self->readingBuffer.size()/sizeof(Page) - 1) * sizeof(Page);
+			state int64_t pos = (self->readingPage - (self->readingBuffer.size() + self->readAheadBuffer.size())/sizeof(Page) - 1) * sizeof(Page);
 			state vector<Future<Void>> commits;
 			state bool swap = file==0;
 
 			TEST( file==0 ); // truncate before last read page on file 0
 			TEST( file==1 && pos != self->files[1].size ); // truncate before last read page on file 1
 
+			if (self->readAheadRead.isValid()) {
+				// Wait for the read ahead to finish before truncating and writing over the region it covers
+				ErrorOr<int> _ = wait( errorOr(self->readAheadRead) );
+				self->readAheadRead = Future<int>();
+				self->readAheadBuffer.clear();
+			}
+
 			self->readingFile = 2;
 			self->readingBuffer.clear();
 			self->writingPos = pos;
@@ -778,13 +838,20 @@ private:
 		int remainingCapacity() const { return maxPayload - payloadSize; }
 		uint64_t endSeq() const { return seq + sizeof(PageHeader) + payloadSize; }
 		void updateHash() {
-			// SOMEDAY: Better hash?
-			uint32_t part[2] = { 0x12345678, 0xbeefabcd };
-			hashlittle2( &seq, sizeof(Page)-sizeof(hash), &part[0], &part[1] );
-			hash = UID( (int64_t(part[0])<<32)+part[1], 0xfdb );
+			// New pages are checksummed with CRC-32C, which is implemented in hardware on most of the
+			// processors we run on; the 0xfdb2 marker distinguishes them from pages written by previous
+			// versions, which checkHash() still verifies with the original hash.
+			uint32_t crc = crc32c_append( 0xfdbeefdb, (uint8_t*)&seq, sizeof(Page)-sizeof(hash) );
+			hash = UID( int64_t(crc)<<32, 0xfdb2 );
 		}
 		bool checkHash() {
 			UID h = hash;
+			if (h.second() == 0xfdb) {
+				// Page written by a previous version
+				uint32_t part[2] = { 0x12345678, 0xbeefabcd };
+				hashlittle2( &seq, sizeof(Page)-sizeof(hash), &part[0], &part[1] );
+				return h == UID( (int64_t(part[0])<<32)+part[1], 0xfdb );
+			}
 			updateHash();
 			if (h != hash) { std::swap(h, hash); return false; }
 			return true;
@@ -40,6 +40,13 @@ public:
 	virtual KeyValueStoreType getType() = 0;
 	virtual void set( KeyValueRef keyValue, const Arena* arena = NULL ) = 0;
 	virtual void clear( KeyRangeRef range, const Arena* arena = NULL ) = 0;
+
+	// Equivalent to set() on each pair of kvs, which must be sorted ascending by key.  Stores may
+	// override this to merge the run into their data structures in bulk.
+	virtual void setSortedRun( VectorRef<KeyValueRef> kvs, const Arena* arena = NULL ) {
+		for(int i = 0; i < kvs.size(); i++)
+			set( kvs[i], arena );
+	}
 	virtual Future<Void> commit(bool sequential = false) = 0;  // returns when prior sets and clears are (atomically) durable
 
 	virtual Future<Optional<Value>> readValue( KeyRef key, Optional<UID> debugID = Optional<UID>() ) = 0;
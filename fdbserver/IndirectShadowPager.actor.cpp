@@ -73,8 +73,25 @@ inline void checksumWrite(IAsyncFile *file, uint8_t *page, int pageSize, Logical
 	checksum(file, page, pageSize, logical, physical, true);
 }
 
+static uint8_t* allocatePageBuffer() {
+	if(IndirectShadowPage::PAGE_BYTES == 4096) {
+		return (uint8_t*)FastAllocator<4096>::allocate();
+	}
+	// Larger pages are allocated on a 4KB boundary so that they can be used for direct I/O
+	return (uint8_t*)aligned_alloc(4096, IndirectShadowPage::PAGE_BYTES);
+}
+
+static void freePageBuffer(uint8_t *data) {
+	if(IndirectShadowPage::PAGE_BYTES == 4096) {
+		FastAllocator<4096>::release(data);
+	}
+	else {
+		aligned_free(data);
+	}
+}
+
 IndirectShadowPage::IndirectShadowPage() : fastAllocated(true) {
-	data = (uint8_t*)FastAllocator<4096>::allocate();
+	data = allocatePageBuffer();
 #if VALGRIND
 	// Prevent valgrind errors caused by writing random unneeded bytes to disk.
 	memset(data, 0, size());
@@ -83,7 +100,7 @@ IndirectShadowPage::IndirectShadowPage() : fastAllocated(true) {
 
 IndirectShadowPage::~IndirectShadowPage() {
 	if(fastAllocated) {
-		FastAllocator<4096>::release(data);
+		freePageBuffer(data);
 	}
 	else if(file) {
 		file->releaseZeroCopy(data, PAGE_BYTES, (int64_t) physicalPageID * PAGE_BYTES);
@@ -102,7 +119,7 @@ int IndirectShadowPage::size() const {
 	return PAGE_BYTES - PAGE_OVERHEAD_BYTES;
 }
 
-const int IndirectShadowPage::PAGE_BYTES = 4096;
+int IndirectShadowPage::PAGE_BYTES = 4096;
 const int IndirectShadowPage::PAGE_OVERHEAD_BYTES = sizeof(SumType);
 
 IndirectShadowPagerSnapshot::IndirectShadowPagerSnapshot(IndirectShadowPager *pager, Version version)
@@ -130,6 +147,9 @@ ACTOR Future<Void> recover(IndirectShadowPager *pager) {
 
 		// TODO: this can be done synchronously with the log recovery
 		int64_t flags = IAsyncFile::OPEN_READWRITE | IAsyncFile::OPEN_LOCK;
+		if(SERVER_KNOBS->REDWOOD_UNCACHED) {
+			flags |= IAsyncFile::OPEN_UNCACHED | IAsyncFile::OPEN_UNBUFFERED;
+		}
 		state bool exists = fileExists(pager->pageFileName);
 		if(!exists) {
 			flags |= IAsyncFile::OPEN_ATOMIC_WRITE_AND_CREATE | IAsyncFile::OPEN_CREATE;
@@ -148,6 +168,28 @@ ACTOR Future<Void> recover(IndirectShadowPager *pager) {
 		state int64_t fileSize = wait(pager->dataFile->size());
 		TraceEvent("PagerGotFileSize").detail("Size", fileSize).detail("Filename", pager->pageFileName);
 
+		// Verify or record the page size this pager's data file was created with.  A file can only
+		// be read with its original page size, and page size is process-wide, so a file created
+		// under a different REDWOOD_PAGE_SIZE cannot be opened.
+		Optional<Value> pageSizeValue = wait(pager->pageTableLog->readValue(IndirectShadowPager::PAGE_SIZE_KEY));
+		if(pageSizeValue.present()) {
+			BinaryReader sr(pageSizeValue.get(), Unversioned());
+			int pageSize;
+			sr >> pageSize;
+			if(pageSize != IndirectShadowPage::PAGE_BYTES) {
+				TraceEvent(SevError, "PagerPageSizeMismatch")
+					.detail("Filename", pager->pageFileName)
+					.detail("FilePageSize", pageSize)
+					.detail("ConfiguredPageSize", IndirectShadowPage::PAGE_BYTES);
+				throw internal_error();
+			}
+		}
+		else {
+			BinaryWriter sw(Unversioned());
+			sw << IndirectShadowPage::PAGE_BYTES;
+			pager->pageTableLog->set(KeyValueRef(IndirectShadowPager::PAGE_SIZE_KEY, sw.toStringRef()));
+		}
+
 		if(fileSize > 0) {
 			TraceEvent("PagerRecoveringFromLogs").detail("Filename", pager->pageFileName);
 			Optional<Value> pagesAllocatedValue = wait(pager->pageTableLog->readValue(IndirectShadowPager::PAGES_ALLOCATED_KEY));
@@ -346,9 +388,17 @@ ACTOR Future<Void> forwardError(Future<Void> f, Promise<Void> target) {
 	return Void();
 }
 
-IndirectShadowPager::IndirectShadowPager(std::string basename) 
-	: basename(basename), latestVersion(0), committedVersion(0), committing(Void()), oldestVersion(0), pagerFile(this)
+IndirectShadowPager::IndirectShadowPager(std::string basename)
+	: basename(basename), latestVersion(0), committedVersion(0), committing(Void()), oldestVersion(0), pageCacheHand(0), pageCacheMaxPages(0), pagerFile(this)
 {
+	// Direct I/O requires block-aligned buffers and transfer sizes, so the page size must be a
+	// multiple of 4KB regardless of whether REDWOOD_UNCACHED is set
+	ASSERT(SERVER_KNOBS->REDWOOD_PAGE_SIZE % 4096 == 0);
+	IndirectShadowPage::PAGE_BYTES = SERVER_KNOBS->REDWOOD_PAGE_SIZE;
+	if(SERVER_KNOBS->REDWOOD_UNCACHED) {
+		pageCacheMaxPages = SERVER_KNOBS->REDWOOD_PAGE_CACHE_BYTES / IndirectShadowPage::PAGE_BYTES;
+	}
+
 	pageFileName = basename;
 	recovery = forwardError(recover(this), errorPromise);
 	housekeeping = forwardError(housekeeper(this), errorPromise);
@@ -618,6 +668,29 @@ ACTOR Future<Reference<const IPage>> rawRead(IndirectShadowPager *pager, Logical
 	state int len = IndirectShadowPage::PAGE_BYTES;
 	state bool readSuccess = false;
 
+	if(SERVER_KNOBS->REDWOOD_UNCACHED) {
+		// The file is open for direct I/O, which does not support zero-copy reads, so read into a
+		// pager-owned buffer and keep the result in the pager's own cache
+		state Reference<IPage> page = pager->newPageBuffer();
+		try {
+			int bytes = wait(pager->dataFile->read(page->mutate(), IndirectShadowPage::PAGE_BYTES, (int64_t) physicalPageID * IndirectShadowPage::PAGE_BYTES));
+			ASSERT(bytes == IndirectShadowPage::PAGE_BYTES);
+
+			if(!checksumRead(pager->dataFile.getPtr(), page->mutate(), bytes, logicalPageID, physicalPageID)) {
+				throw checksum_failed();
+			}
+
+			pager->busyPages.erase(physicalPageID);
+			Reference<const IPage> result = page;
+			pager->cachePage(physicalPageID, result);
+			return result;
+		}
+		catch(Error &e) {
+			pager->busyPages.erase(physicalPageID);
+			throw;
+		}
+	}
+
 	try {
 		wait(pager->dataFile->readZeroCopy(&data, &len, (int64_t) physicalPageID * IndirectShadowPage::PAGE_BYTES));
 		readSuccess = true;
@@ -653,6 +726,12 @@ Future<Reference<const IPage>> getPageImpl(IndirectShadowPager *pager, Reference
 
 	debug_printf("%s: Reading logical %d v%lld physical %d mapSize %lu\n", pager->pageFileName.c_str(), logicalPageID, version, physicalPageID, pageVersionMap.size());
 
+	Reference<const IPage> cached = pager->getCachedPage(physicalPageID);
+	if(cached) {
+		TEST(true); // Pager read served from page cache
+		return cached;
+	}
+
 	IndirectShadowPager::BusyPage &bp = pager->busyPages[physicalPageID];
 	if(!bp.read.isValid()) {
 		Future<Reference<const IPage>> get = rawRead(pager, logicalPageID, physicalPageID);
@@ -675,6 +754,60 @@ Future<Reference<const IPage>> IndirectShadowPager::getPage(Reference<IndirectSh
 	return f;
 }
 
+Reference<const IPage> IndirectShadowPager::getCachedPage(PhysicalPageID pageID) {
+	auto itr = pageCache.find(pageID);
+	if(itr == pageCache.end()) {
+		return Reference<const IPage>();
+	}
+
+	itr->second.referenced = true;
+	return itr->second.page;
+}
+
+void IndirectShadowPager::cachePage(PhysicalPageID pageID, Reference<const IPage> page) {
+	if(pageCacheMaxPages == 0) {
+		return;
+	}
+
+	auto itr = pageCache.find(pageID);
+	if(itr != pageCache.end()) {
+		itr->second.page = page;
+		itr->second.referenced = true;
+		return;
+	}
+
+	if((int)pageCacheClock.size() < pageCacheMaxPages) {
+		pageCacheClock.push_back(pageID);
+		pageCache[pageID] = PageCacheEntry{ page, (int)pageCacheClock.size() - 1, true };
+		return;
+	}
+
+	// Sweep the clock hand, clearing referenced bits, until an evictable slot is found.  A slot is
+	// evictable if its page is unreferenced or if its page was already removed by evictPage().
+	for(;;) {
+		auto candidate = pageCache.find(pageCacheClock[pageCacheHand]);
+		if(candidate == pageCache.end() || candidate->second.slot != pageCacheHand) {
+			break;
+		}
+		if(!candidate->second.referenced) {
+			pageCache.erase(candidate);
+			break;
+		}
+		candidate->second.referenced = false;
+		pageCacheHand = (pageCacheHand + 1) % pageCacheClock.size();
+	}
+
+	pageCacheClock[pageCacheHand] = pageID;
+	pageCache[pageID] = PageCacheEntry{ page, pageCacheHand, true };
+	pageCacheHand = (pageCacheHand + 1) % pageCacheClock.size();
+}
+
+// Freed physical pages will eventually be reallocated and rewritten with unrelated contents, so
+// they cannot stay cached.  Their clock slots are reclaimed when the hand reaches them.
+void IndirectShadowPager::evictPage(PhysicalPageID pageID) {
+	pageCache.erase(pageID);
+}
+
 PageVersionMap::iterator IndirectShadowPager::pageVersionMapLowerBound(PageVersionMap &pageVersionMap, Version version) {
 	return std::lower_bound(pageVersionMap.begin(), pageVersionMap.end(), version, [](std::pair<Version, PhysicalPageID> p, Version v) {
 		return p.first < v;
@@ -741,6 +874,7 @@ void IndirectShadowPager::logPageTableClear(LogicalPageID logicalPageID, Version
 const StringRef IndirectShadowPager::LATEST_VERSION_KEY = LiteralStringRef("\xff/LatestVersion");
 const StringRef IndirectShadowPager::OLDEST_VERSION_KEY = LiteralStringRef("\xff/OldestVersion");
 const StringRef IndirectShadowPager::PAGES_ALLOCATED_KEY = LiteralStringRef("\xff/PagesAllocated");
+const StringRef IndirectShadowPager::PAGE_SIZE_KEY = LiteralStringRef("\xff/PageSize");
 const StringRef IndirectShadowPager::TABLE_ENTRY_PREFIX = LiteralStringRef("\x00");
 
 ACTOR Future<Void> copyPage(IndirectShadowPager *pager, Reference<IPage> page, LogicalPageID logical, PhysicalPageID from, PhysicalPageID to) {
@@ -755,7 +889,8 @@ ACTOR Future<Void> copyPage(IndirectShadowPager *pager, Reference<IPage> page, L
 		catch(Error &e) {
 			zeroCopied = false;
 			data = page->mutate();
-			int _bytes = wait(pager->dataFile->read(data, page->size(), (int64_t)from * IndirectShadowPage::PAGE_BYTES));
+			// The page buffer is PAGE_BYTES long; page->size() excludes the checksum, which must be copied too
+			int _bytes = wait(pager->dataFile->read(data, IndirectShadowPage::PAGE_BYTES, (int64_t)from * IndirectShadowPage::PAGE_BYTES));
 			bytes = _bytes;
 		}
 
@@ -878,6 +1013,7 @@ PhysicalPageID PagerFile::allocatePage(LogicalPageID logicalPageID, Version vers
 }
 
 void PagerFile::freePage(PhysicalPageID pageID) {
+	pager->evictPage(pageID);
 	freePages.insert(pageID);
 
 	if(pageID >= minVacuumQueuePage) {
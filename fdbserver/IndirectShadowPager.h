@@ -30,6 +30,8 @@
 
 #include "fdbrpc/IAsyncFile.h"
 
+#include <unordered_map>
+
 typedef uint32_t PhysicalPageID;
 typedef std::vector<std::pair<Version, PhysicalPageID>> PageVersionMap;
 typedef std::vector<PageVersionMap> LogicalPageTable;
@@ -56,7 +58,9 @@ public:
 	virtual uint8_t* mutate();
 
 //private:
-	static const int PAGE_BYTES;
+	// Process-wide page size, set from REDWOOD_PAGE_SIZE before the first pager starts and
+	// verified against the size recorded in each pager's log during recovery
+	static int PAGE_BYTES;
 	static const int PAGE_OVERHEAD_BYTES;
 
 private:
@@ -183,6 +187,24 @@ public:
 	typedef std::map<PhysicalPageID, BusyPage> BusyPageMapT;
 	BusyPageMapT busyPages;
 
+	// Pager-owned page cache, used when the data file is opened for direct I/O (REDWOOD_UNCACHED)
+	// and the OS page cache is therefore bypassed.  Eviction is clock (second chance): a cached
+	// page gets its referenced bit set on each hit and loses it as the hand sweeps past, and
+	// unreferenced pages are evicted.
+	struct PageCacheEntry {
+		Reference<const IPage> page;
+		int slot;
+		bool referenced;
+	};
+	std::unordered_map<PhysicalPageID, PageCacheEntry> pageCache;
+	std::vector<PhysicalPageID> pageCacheClock;
+	int pageCacheHand;
+	int pageCacheMaxPages;
+
+	Reference<const IPage> getCachedPage(PhysicalPageID pageID);
+	void cachePage(PhysicalPageID pageID, Reference<const IPage> page);
+	void evictPage(PhysicalPageID pageID);
+
 	SignalableActorCollection operations;
 	SignalableActorCollection writeActors;
 	Future<Void> committing;
@@ -208,6 +230,7 @@ public:
 	static const StringRef LATEST_VERSION_KEY;
 	static const StringRef OLDEST_VERSION_KEY;
 	static const StringRef PAGES_ALLOCATED_KEY;
+	static const StringRef PAGE_SIZE_KEY;
 	static const StringRef TABLE_ENTRY_PREFIX;
 
 };
@@ -121,6 +121,31 @@ public:
 		}
 	}
 
+	// Merges a pre-sorted run of pairs into the tree in one operation: the tree insert walks forward
+	// from the previous pair instead of searching from the root each time, and the whole run becomes
+	// a single log record instead of one per pair
+	virtual void setSortedRun(VectorRef<KeyValueRef> kvs, const Arena* arena) {
+		//A commit that occurs with no available space returns Never, so we can throw out all modifications
+		if(getAvailableSize() <= 0 || !kvs.size())
+			return;
+
+		if(transactionIsLarge) {
+			for(int i = 0; i < kvs.size(); i++) {
+				KeyValueMapPair pair(kvs[i].key, kvs[i].value);
+				dataSets.push_back(std::make_pair(pair, pair.arena.getSize() + data.getElementBytes()));
+			}
+			data.insert(dataSets);
+			dataSets.clear();
+		}
+		else {
+			Standalone<StringRef> run = encodeSortedRun(kvs);
+			queue.set_sorted(run, &run.arena());
+			if(recovering.isReady() && !disableSnapshot) {
+				semiCommit();
+			}
+		}
+	}
+
 	virtual void clear(KeyRangeRef range, const Arena* arena) {
 		//A commit that occurs with no available space returns Never, so we can throw out all modifications
 		if(getAvailableSize() <= 0)
@@ -268,7 +293,8 @@ private:
 		OpSnapshotEnd,
 		OpSnapshotAbort, // terminate an in progress snapshot in order to start a full snapshot
 		OpCommit,        // only in log, not in queue
-		OpRollback       // only in log, not in queue
+		OpRollback,      // only in log, not in queue
+		OpSetSorted      // a sorted run of pairs in a single record; added last so earlier op codes keep their on-disk values
 	};
 
 	struct OpRef {
@@ -312,6 +338,10 @@ private:
 			queue_op(OpClearToEnd, fromKey, StringRef(), arena);
 		}
 
+		void set_sorted( StringRef encodedRun, const Arena* arena = NULL ) {
+			queue_op(OpSetSorted, encodedRun, StringRef(), arena);
+		}
+
 		void queue_op( OpType op, StringRef p1, StringRef p2, const Arena* arena ) {
 			numBytes += p1.size() + p2.size() + sizeof(OpHeader) + sizeof(OpRef);
 
@@ -382,6 +412,21 @@ private:
 					data.insert( pair, pair.arena.getSize() + data.getElementBytes() );
 				}
 			}
+			else if (o->op == OpSetSorted) {
+				StringRef run = o->p1;
+				while (run.size()) {
+					int32_t klen = *(int32_t*)run.begin();
+					int32_t vlen = *(int32_t*)(run.begin() + sizeof(int32_t));
+					const uint8_t* kbegin = run.begin() + 2*sizeof(int32_t);
+					KeyValueMapPair pair( StringRef(kbegin, klen), StringRef(kbegin + klen, vlen) );
+					dataSets.push_back(std::make_pair(pair, pair.arena.getSize() + data.getElementBytes()));
+					run = run.substr( 2*sizeof(int32_t) + klen + vlen );
+				}
+				if(!sequential) {
+					data.insert(dataSets);
+					dataSets.clear();
+				}
+			}
 			else if (o->op == OpClear) {
 				if(sequential) {
 					data.insert(dataSets);
@@ -419,6 +464,25 @@ private:
 		return total;
 	}
 
+	// A sorted run travels through the op queue and the log as one record: the pairs concatenated as
+	// {int32 keyLen, int32 valueLen, key bytes, value bytes}
+	static Standalone<StringRef> encodeSortedRun( VectorRef<KeyValueRef> kvs ) {
+		int total = 0;
+		for(int i = 0; i < kvs.size(); i++)
+			total += 2*sizeof(int32_t) + kvs[i].key.size() + kvs[i].value.size();
+
+		Standalone<StringRef> run = makeString( total );
+		uint8_t* p = mutateString( run );
+		for(int i = 0; i < kvs.size(); i++) {
+			int32_t klen = kvs[i].key.size(), vlen = kvs[i].value.size();
+			memcpy(p, &klen, sizeof(klen)); p += sizeof(klen);
+			memcpy(p, &vlen, sizeof(vlen)); p += sizeof(vlen);
+			memcpy(p, kvs[i].key.begin(), klen); p += klen;
+			memcpy(p, kvs[i].value.begin(), vlen); p += vlen;
+		}
+		return run;
+	}
+
 	IDiskQueue::location log_op(OpType op, StringRef v1, StringRef v2) {
 		OpHeader h = {(int)op, v1.size(), v2.size()};
 		log->push( StringRef((const uint8_t*)&h, sizeof(h)) );
@@ -517,6 +581,9 @@ private:
 					} else if (h.op == OpSet) { // set mutation
 						recoveryQueue.set( KeyValueRef(p1,p2), &data.arena() );
 						++dbgMutationCount;
+					} else if (h.op == OpSetSorted) { // a sorted run of set mutations in one record
+						recoveryQueue.set_sorted( p1, &data.arena() );
+						++dbgMutationCount;
 					} else if (h.op == OpClear) { // clear mutation
 						recoveryQueue.clear( KeyRangeRef(p1,p2), &data.arena() );
 						++dbgMutationCount;
@@ -648,40 +715,52 @@ private:
 					.detail("LastOperationWasASnapshot", nextKey == Key() && !nextKeyAfter);
 			lastDiff = diff;
 
-			if (next == self->data.end()) {
-				auto thisSnapshotEnd = self->log_op( OpSnapshotEnd, StringRef(), StringRef() );
-				//TraceEvent("SnapshotEnd", self->id)
-				//	.detail("LastKey", printable(lastKey.present() ? lastKey.get() : LiteralStringRef("<none>")))
-				//	.detail("CurrentSnapshotEndLoc", self->currentSnapshotEnd)
-				//	.detail("PreviousSnapshotEndLoc", self->previousSnapshotEnd)
-				//	.detail("ThisSnapshotEnd", thisSnapshotEnd)
-				//	.detail("Items", snapItems)
-				//	.detail("CommittedWrites", self->notifiedCommittedWriteBytes.get())
-				//	.detail("SnapshotSize", snapshotBytes);
-
-				ASSERT(thisSnapshotEnd >= self->currentSnapshotEnd);
-				self->previousSnapshotEnd = self->currentSnapshotEnd;
-				self->currentSnapshotEnd = thisSnapshotEnd;
-
-				if(++self->snapshotCount == 2) {
-					self->replaceContent = false;
-				}
-				nextKey = Key();
-				nextKeyAfter = false;
-				snapItems = 0;
+			// Since a wait on a ready future does not yield, catching up with a large jump in committed bytes
+			// one item per whenAtLeast would stall the run loop for the whole catch-up.  Instead, log items in
+			// batches of at most MEMORY_SNAPSHOT_BATCH_BYTES with a yield between batches.  There are no waits
+			// inside this loop, so no commit can modify the data being iterated.
+			uint64_t batchEnd = std::min<uint64_t>( self->notifiedCommittedWriteBytes.get(),
+			                                        snapshotTotalWrittenBytes + SERVER_KNOBS->MEMORY_SNAPSHOT_BATCH_BYTES );
+			while (snapshotTotalWrittenBytes < batchEnd) {
+				if (next == self->data.end()) {
+					auto thisSnapshotEnd = self->log_op( OpSnapshotEnd, StringRef(), StringRef() );
+					//TraceEvent("SnapshotEnd", self->id)
+					//	.detail("LastKey", printable(lastKey.present() ? lastKey.get() : LiteralStringRef("<none>")))
+					//	.detail("CurrentSnapshotEndLoc", self->currentSnapshotEnd)
+					//	.detail("PreviousSnapshotEndLoc", self->previousSnapshotEnd)
+					//	.detail("ThisSnapshotEnd", thisSnapshotEnd)
+					//	.detail("Items", snapItems)
+					//	.detail("CommittedWrites", self->notifiedCommittedWriteBytes.get())
+					//	.detail("SnapshotSize", snapshotBytes);
+
+					ASSERT(thisSnapshotEnd >= self->currentSnapshotEnd);
+					self->previousSnapshotEnd = self->currentSnapshotEnd;
+					self->currentSnapshotEnd = thisSnapshotEnd;
+
+					if(++self->snapshotCount == 2) {
+						self->replaceContent = false;
+					}
+					nextKey = Key();
+					nextKeyAfter = false;
+					snapItems = 0;
 
-				snapshotBytes = 0;
+					snapshotBytes = 0;
 
-				snapshotTotalWrittenBytes += OP_DISK_OVERHEAD;
-			} else {
-				self->log_op( OpSnapshotItem, next->key, next->value );
-				nextKey = next->key;
-				nextKeyAfter = true;
-				snapItems++;
-				uint64_t opBytes = next->key.size() + next->value.size() + OP_DISK_OVERHEAD;
-				snapshotBytes += opBytes;
-				snapshotTotalWrittenBytes += opBytes;
+					snapshotTotalWrittenBytes += OP_DISK_OVERHEAD;
+					break; //the next pass starts from data.begin(), so recompute the cursor
+				} else {
+					self->log_op( OpSnapshotItem, next->key, next->value );
+					nextKey = next->key;
+					nextKeyAfter = true;
+					snapItems++;
+					uint64_t opBytes = next->key.size() + next->value.size() + OP_DISK_OVERHEAD;
+					snapshotBytes += opBytes;
+					snapshotTotalWrittenBytes += opBytes;
+					++next;
+				}
 			}
+
+			wait( yield() );
 		}
 	}
 
@@ -55,13 +55,14 @@ void hexdump(FILE *fout, StringRef val);
 
 struct SpringCleaningStats {
 	int64_t springCleaningCount;
+	int64_t deferredCleaningCount;
 	int64_t lazyDeletePages;
 	int64_t vacuumedPages;
 	double springCleaningTime;
 	double vacuumTime;
 	double lazyDeleteTime;
 
-	SpringCleaningStats() : springCleaningCount(0), lazyDeletePages(0), vacuumedPages(0), springCleaningTime(0.0), vacuumTime(0.0), lazyDeleteTime(0.0) {}
+	SpringCleaningStats() : springCleaningCount(0), deferredCleaningCount(0), lazyDeletePages(0), vacuumedPages(0), springCleaningTime(0.0), vacuumTime(0.0), lazyDeleteTime(0.0) {}
 };
 
 struct PageChecksumCodec {
@@ -1431,10 +1432,15 @@ public:
 	KeyValueStoreSQLite(std::string const& filename, UID logID, KeyValueStoreType type, bool checkChecksums, bool checkIntegrity);
 	~KeyValueStoreSQLite();
 
-	Future<Void> doClean();
+	Future<Void> doClean( double timeSlice );
+	bool deferCleaning();
 	void startReadThreads();
 
+	AsyncTrigger rangesCleared;  // fired per clear() so spring cleaning can restart promptly after a purge
+
 private:
+	void maybeAddReadThread();
+
 	KeyValueStoreType type;
 	UID logID;
 	std::string filename;
@@ -1442,6 +1448,7 @@ private:
 	Promise<Void> stopped;
 	Future<Void> cleaning, logging, starting, stopOnErr;
 
+	int activeReadThreads;
 	int64_t readsRequested, writesRequested;
 	ThreadSafeCounter readsComplete;
 	volatile int64_t writesComplete;
@@ -1605,19 +1612,28 @@ private:
 			a.result.send(Void());
 		}
 
-		struct SetAction : TypedAction<Writer, SetAction>, FastAllocated<SetAction> {
-			KeyValue kv;
-			SetAction( KeyValue kv ) : kv(kv) {}
-			virtual double getTimeEstimate() { return SERVER_KNOBS->SET_TIME_ESTIMATE; }
+		struct SetBatchAction : TypedAction<Writer, SetBatchAction>, FastAllocated<SetBatchAction> {
+			Standalone<VectorRef<KeyValueRef>> sets;
+			virtual double getTimeEstimate() { return std::max<int>(sets.size(), 1) * SERVER_KNOBS->SET_TIME_ESTIMATE; }
 		};
-		void action(SetAction& a) {
+		void action(SetBatchAction& a) {
 			double s = now();
-			checkFreePages();
-			cursor->set(a.kv);
-			++setsThisCommit;
+			// Applying the batch in sorted key order turns random-order ingest into mostly
+			// sequential btree descents: adjacent keys usually land on the same or neighboring
+			// pages, so far fewer pages are dirtied per commit.  The sort is stable, so of
+			// several sets to the same key the last one issued still wins and the earlier ones
+			// can be skipped entirely.
+			std::stable_sort( a.sets.begin(), a.sets.end(), KeyValueRef::OrderByKey() );
+			for(int i = 0; i < a.sets.size(); i++) {
+				if( i+1 < a.sets.size() && a.sets[i].key == a.sets[i+1].key )
+					continue;
+				checkFreePages();
+				cursor->set(a.sets[i]);
+				++setsThisCommit;
+			}
 			++writesComplete;
 			if (g_network->isSimulated() && g_simulator.getCurrentProcess()->rebooting)
-				TraceEvent("SetActionFinished", dbgid).detail("Elapsed", now()-s);
+				TraceEvent("SetBatchActionFinished", dbgid).detail("Elapsed", now()-s);
 		}
 
 		struct ClearAction : TypedAction<Writer, ClearAction>, FastAllocated<ClearAction> {
@@ -1704,12 +1720,14 @@ private:
 		}
 
 		struct SpringCleaningAction : TypedAction<Writer, SpringCleaningAction>, FastAllocated<SpringCleaningAction> {
+			double timeSlice;
 			ThreadReturnPromise<Void> result;
-			virtual double getTimeEstimate() { return SERVER_KNOBS->SPRING_CLEANING_TIME_ESTIMATE; }
+			explicit SpringCleaningAction( double timeSlice ) : timeSlice(timeSlice) {}
+			virtual double getTimeEstimate() { return timeSlice; }
 		};
 		void action(SpringCleaningAction& a) {
 			double s = now();
-			double end = now() + SERVER_KNOBS->SPRING_CLEANING_TIME_ESTIMATE;
+			double end = now() + a.timeSlice;
 
 			int lazyDeletePages = 0;
 			int vacuumedPages = 0;
@@ -1777,6 +1795,17 @@ private:
 		}
 	};
 
+	Writer::SetBatchAction* pendingSets;  // sets not yet posted to the writer thread; flushed before any clear or commit
+	const void* lastSetArena;             // the arena the current batch most recently took a reference on
+
+	void flushPendingSets() {
+		if (pendingSets) {
+			++writesRequested;
+			writeThread->post( pendingSets );
+			pendingSets = NULL;
+			lastSetArena = NULL;
+		}
+	}
 
 	ACTOR static Future<Void> logPeriodically( KeyValueStoreSQLite* self ) {
 		state int64_t lastReadsComplete = 0;
@@ -1792,10 +1821,22 @@ private:
 				.detail("WriteQueue", self->writesRequested - wc)
 				.detail("GlobalSQLiteMemoryHighWater", (int64_t)sqlite3_memory_highwater(1));
 
+			ThreadPoolQueueStats high = self->readThreads->getAndResetQueueStats( IThreadPool::High );
+			ThreadPoolQueueStats low = self->readThreads->getAndResetQueueStats( IThreadPool::Low );
+			TraceEvent("ReadLaneMetrics", self->logID)
+				.detail("HighPriStarted", high.started)
+				.detail("HighPriMeanQueueDelay", high.started ? high.totalQueueDelay / high.started : 0)
+				.detail("HighPriMaxQueueDelay", high.maxQueueDelay)
+				.detail("LowPriStarted", low.started)
+				.detail("LowPriMeanQueueDelay", low.started ? low.totalQueueDelay / low.started : 0)
+				.detail("LowPriMaxQueueDelay", low.maxQueueDelay);
+
 			TraceEvent("SpringCleaningMetrics", self->logID)
 				.detail("SpringCleaningCount", self->springCleaningStats.springCleaningCount)
+				.detail("DeferredCleaningCount", self->springCleaningStats.deferredCleaningCount)
 				.detail("LazyDeletePages", self->springCleaningStats.lazyDeletePages)
 				.detail("VacuumedPages", self->springCleaningStats.vacuumedPages)
+				.detail("FreeListPages", self->freeListPages)
 				.detail("SpringCleaningTime", self->springCleaningStats.springCleaningTime)
 				.detail("LazyDeleteTime", self->springCleaningStats.lazyDeleteTime)
 				.detail("VacuumTime", self->springCleaningStats.vacuumTime);
@@ -1848,10 +1889,40 @@ IKeyValueStore* keyValueStoreSQLite( std::string const& filename, UID logID, Key
 	return new KeyValueStoreSQLite(filename, logID, storeType, checkChecksums, checkIntegrity);
 }
 
+// Schedules spring cleaning adaptively.  While the store is idle, cleaning runs in sub-millisecond
+// slices at a short interval, so a commit arriving mid-clean waits at most one slice.  Whenever
+// foreground reads or writes are queued the slice is skipped and the interval backs off
+// exponentially, but a fixed-budget slice is taken at least every SPRING_CLEANING_MAX_INTERVAL
+// regardless of load so the lazy free table cannot grow without bound under sustained traffic.
+// A range clear restarts the backoff at the minimum interval: clears queue whole subtrees in the
+// lazy free table, and after a mass purge the space should be reclaimed promptly rather than at
+// whatever cadence the preceding load had backed cleaning off to.
 ACTOR Future<Void> cleanPeriodically( KeyValueStoreSQLite* self ) {
+	state double interval = SERVER_KNOBS->CLEANING_INTERVAL;
+	state double lastSlice = now();
 	loop {
-		wait( delayJittered(SERVER_KNOBS->CLEANING_INTERVAL) );
-		wait( self->doClean() );
+		choose {
+			when( wait( delayJittered(interval) ) ) {}
+			when( wait( self->rangesCleared.onTrigger() ) ) {
+				TEST(true); // Spring cleaning rescheduled by a range clear
+				interval = SERVER_KNOBS->SPRING_CLEANING_MIN_INTERVAL;
+				wait( delayJittered(interval) );
+			}
+		}
+		if( self->deferCleaning() ) {
+			if( now() - lastSlice < SERVER_KNOBS->SPRING_CLEANING_MAX_INTERVAL ) {
+				TEST(true); // Spring cleaning deferred by queued foreground work
+				interval = std::min( interval * 2, SERVER_KNOBS->SPRING_CLEANING_MAX_INTERVAL );
+				continue;
+			}
+			TEST(true); // Spring cleaning forced at maximum backoff
+			wait( self->doClean( SERVER_KNOBS->SPRING_CLEANING_TIME_ESTIMATE ) );
+		}
+		else {
+			wait( self->doClean( SERVER_KNOBS->SPRING_CLEANING_IDLE_TIME_SLICE ) );
+			interval = SERVER_KNOBS->SPRING_CLEANING_MIN_INTERVAL;
+		}
+		lastSlice = now();
 	}
 }
 
@@ -1868,9 +1939,9 @@ KeyValueStoreSQLite::KeyValueStoreSQLite(std::string const& filename, UID id, Ke
 	: type(storeType),
 	  filename(filename),
 	  logID(id),
-	  readThreads(CoroThreadPool::createThreadPool()),
+	  readThreads(CoroThreadPool::createThreadPool(SERVER_KNOBS->SQLITE_READER_RESERVED_PRIORITY_THREADS)),
 	  writeThread(CoroThreadPool::createThreadPool()),
-	  readsRequested(0), writesRequested(0), writesComplete(0), diskBytesUsed(0), freeListPages(0)
+	  activeReadThreads(0), readsRequested(0), writesRequested(0), writesComplete(0), diskBytesUsed(0), freeListPages(0), pendingSets(NULL), lastSetArena(NULL)
 {
 	stopOnErr = stopOnError(this);
 
@@ -1885,7 +1956,7 @@ KeyValueStoreSQLite::KeyValueStoreSQLite(std::string const& filename, UID id, Ke
 	//The DB file should not already be open
 	ASSERT(!vfsAsyncIsOpen(filename));
 
-	readCursors.resize(64); //< number of read threads
+	readCursors.resize( SERVER_KNOBS->SQLITE_READER_THREADS ); //< maximum number of read threads.  Must not be resized later, the Readers hold pointers into it.
 
 	sqlite3_soft_heap_limit64( SERVER_KNOBS->SOFT_HEAP_LIMIT );  // SOMEDAY: Is this a performance issue?  Should we drop the cache sizes for individual threads?
 	int taskId = g_network->getCurrentTask();
@@ -1901,6 +1972,7 @@ KeyValueStoreSQLite::KeyValueStoreSQLite(std::string const& filename, UID id, Ke
 }
 KeyValueStoreSQLite::~KeyValueStoreSQLite() {
 	//printf("dbf=%lld bytes, wal=%lld bytes\n", getFileSize((filename+".fdb").c_str()), getFileSize((filename+".fdb-wal").c_str()));
+	delete pendingSets;  // unflushed sets were never going to be committed
 }
 
 StorageBytes KeyValueStoreSQLite::getStorageBytes() {
@@ -1913,23 +1985,53 @@ StorageBytes KeyValueStoreSQLite::getStorageBytes() {
 }
 
 void KeyValueStoreSQLite::startReadThreads() {
-	int nReadThreads = readCursors.size();
+	int nReadThreads = std::min<int>( SERVER_KNOBS->SQLITE_INITIAL_READER_THREADS, readCursors.size() );
 	int taskId = g_network->getCurrentTask();
 	g_network->setCurrentTask(TaskDiskRead);
 	for(int i=0; i<nReadThreads; i++)
 		readThreads->addThread( new Reader(filename, type==KeyValueStoreType::SSD_BTREE_V2, readsComplete, logID, &readCursors[i]) );
 	g_network->setCurrentTask(taskId);
+	activeReadThreads = nReadThreads;
+}
+
+// Grows the reader pool one thread at a time whenever the queue of outstanding reads is deeper
+// than the current pool, up to the readCursors limit.  activeReadThreads stays zero until
+// startReadThreads() has run, so no reader is created before the writer has recovered the file.
+void KeyValueStoreSQLite::maybeAddReadThread() {
+	if( activeReadThreads > 0 && activeReadThreads < readCursors.size() && readsRequested - readsComplete > activeReadThreads ) {
+		int taskId = g_network->getCurrentTask();
+		g_network->setCurrentTask(TaskDiskRead);
+		readThreads->addThread( new Reader(filename, type==KeyValueStoreType::SSD_BTREE_V2, readsComplete, logID, &readCursors[activeReadThreads]) );
+		g_network->setCurrentTask(taskId);
+		++activeReadThreads;
+	}
 }
 
 void KeyValueStoreSQLite::set( KeyValueRef keyValue, const Arena* arena ) {
-	++writesRequested;
-	writeThread->post( new Writer::SetAction(keyValue) );
+	if (pendingSets == NULL)
+		pendingSets = new Writer::SetBatchAction;
+	if (arena) {
+		// Bulk writers (fetchKeys ingesting a sorted block) pass the arena holding their data, so the
+		// batch can reference it instead of copying every key and value on the main thread
+		if (arena->impl.getPtr() != lastSetArena) {
+			pendingSets->sets.arena().dependsOn(*arena);
+			lastSetArena = arena->impl.getPtr();
+		}
+		pendingSets->sets.push_back( pendingSets->sets.arena(), keyValue );
+	}
+	else
+		pendingSets->sets.push_back_deep( pendingSets->sets.arena(), keyValue );
+	if (pendingSets->sets.size() >= SERVER_KNOBS->SQLITE_SET_BATCH_SIZE)
+		flushPendingSets();
 }
 void KeyValueStoreSQLite::clear( KeyRangeRef range, const Arena* arena ) {
+	flushPendingSets();
 	++writesRequested;
 	writeThread->post( new Writer::ClearAction(range) );
+	rangesCleared.trigger();
 }
 Future<Void> KeyValueStoreSQLite::commit(bool sequential) {
+	flushPendingSets();
 	++writesRequested;
 	auto p = new Writer::CommitAction;
 	auto f = p->result.getFuture();
@@ -1938,32 +2040,46 @@ Future<Void> KeyValueStoreSQLite::commit(bool sequential) {
 }
 Future<Optional<Value>> KeyValueStoreSQLite::readValue( KeyRef key, Optional<UID> debugID ) {
 	++readsRequested;
+	maybeAddReadThread();
 	auto p = new Reader::ReadValueAction(key, debugID);
 	auto f = p->result.getFuture();
-	readThreads->post(p);
+	readThreads->post(p, IThreadPool::High);
 	return f;
 }
 Future<Optional<Value>> KeyValueStoreSQLite::readValuePrefix( KeyRef key, int maxLength, Optional<UID> debugID ) {
 	++readsRequested;
+	maybeAddReadThread();
 	auto p = new Reader::ReadValuePrefixAction(key, maxLength, debugID);
 	auto f = p->result.getFuture();
-	readThreads->post(p);
+	readThreads->post(p, IThreadPool::High);
 	return f;
 }
 Future<Standalone<VectorRef<KeyValueRef>>> KeyValueStoreSQLite::readRange( KeyRangeRef keys, int rowLimit, int byteLimit ) {
 	++readsRequested;
+	maybeAddReadThread();
+	// Range reads (including those servicing fetchKeys on the source server) use idle reader
+	// capacity, but queue behind latency-critical point reads
 	auto p = new Reader::ReadRangeAction(keys, rowLimit, byteLimit);
 	auto f = p->result.getFuture();
-	readThreads->post(p);
+	readThreads->post(p, IThreadPool::Low);
 	return f;
 }
-Future<Void> KeyValueStoreSQLite::doClean() {
+Future<Void> KeyValueStoreSQLite::doClean( double timeSlice ) {
 	++writesRequested;
-	auto p = new Writer::SpringCleaningAction;
+	auto p = new Writer::SpringCleaningAction( timeSlice );
 	auto f = p->result.getFuture();
 	writeThread->post(p);
 	return f;
 }
+// If foreground reads or writes are queued, counts a deferred cleaning slice and returns true.
+// Spring cleaning runs on the writer thread, so any work it takes delays queued commits directly.
+bool KeyValueStoreSQLite::deferCleaning() {
+	if( readsRequested > readsComplete || writesRequested > writesComplete ) {
+		++springCleaningStats.deferredCleaningCount;
+		return true;
+	}
+	return false;
+}
 
 void createTemplateDatabase() {
 	ASSERT( !vfs_registered );
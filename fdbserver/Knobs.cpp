@@ -42,6 +42,9 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( BUGGIFY_TLOG_STORAGE_MIN_UPDATE_INTERVAL,               30 );
 	init( UNFLUSHED_DATA_RATIO,                                 0.05 ); if( randomize && BUGGIFY ) UNFLUSHED_DATA_RATIO = 0.0;
 	init( DESIRED_TOTAL_BYTES,                                150000 ); if( randomize && BUGGIFY ) DESIRED_TOTAL_BYTES = 10000;
+	init( LOG_ROUTER_PEEK_REPLY_BYTES,                           2e6 ); if( randomize && BUGGIFY ) LOG_ROUTER_PEEK_REPLY_BYTES = DESIRED_TOTAL_BYTES;
+	init( LOG_ROUTER_PEEK_RESELECT_INTERVAL,                     5.0 ); if( randomize && BUGGIFY ) LOG_ROUTER_PEEK_RESELECT_INTERVAL = 1.0;
+	init( LOG_ROUTER_PEEK_SWITCH_LAG_VERSIONS, 5 * VERSIONS_PER_SECOND ); if( randomize && BUGGIFY ) LOG_ROUTER_PEEK_SWITCH_LAG_VERSIONS = VERSIONS_PER_SECOND/10;
 	init( DESIRED_UPDATE_BYTES,                2*DESIRED_TOTAL_BYTES );
 	init( UPDATE_DELAY,                                        0.001 );
 	init( MAXIMUM_PEEK_BYTES,                                   10e6 );
@@ -54,6 +57,7 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( BUGGIFY_WORKER_REMOVED_MAX_LAG,                         30 );
 	init( UPDATE_STORAGE_BYTE_LIMIT,                             1e6 );
 	init( TLOG_PEEK_DELAY,                                   0.00005 );
+	init( TLOG_WAN_PEEK_DELAY,                                 0.005 ); if( randomize && BUGGIFY ) TLOG_WAN_PEEK_DELAY = 0.1;
 	init( LEGACY_TLOG_UPGRADE_ENTRIES_PER_VERSION,               100 );
 	init( VERSION_MESSAGES_OVERHEAD_FACTOR_1024THS,             1072 ); // Based on a naive interpretation of the gcc version of std::deque, we would expect this to be 16 bytes overhead per 512 bytes data. In practice, it seems to be 24 bytes overhead per 512.
 	init( VERSION_MESSAGES_ENTRY_BYTES_WITH_OVERHEAD, std::ceil(16.0 * VERSION_MESSAGES_OVERHEAD_FACTOR_1024THS / 1024) );
@@ -61,14 +65,21 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( MAX_MESSAGE_SIZE,            std::max<int>(LOG_SYSTEM_PUSHED_DATA_BLOCK_SIZE, 1e5 + 2e4 + 1) + 8 ); // VALUE_SIZE_LIMIT + SYSTEM_KEY_SIZE_LIMIT + 9 bytes (4 bytes for length, 4 bytes for sequence number, and 1 byte for mutation type)
 	init( TLOG_MESSAGE_BLOCK_BYTES,                             10e6 );
 	init( TLOG_MESSAGE_BLOCK_OVERHEAD_FACTOR,      double(TLOG_MESSAGE_BLOCK_BYTES) / (TLOG_MESSAGE_BLOCK_BYTES - MAX_MESSAGE_SIZE) ); //1.0121466709838096006362758832473
+	init( TLOG_SPILL_COMPRESSION_MIN_BYTES,                      256 ); if( randomize && BUGGIFY ) TLOG_SPILL_COMPRESSION_MIN_BYTES = g_random->coinflip() ? 0 : -1;
 	init( PEEK_TRACKER_EXPIRATION_TIME,                          600 ); if( randomize && BUGGIFY ) PEEK_TRACKER_EXPIRATION_TIME = g_random->coinflip() ? 0.1 : 60;
 	init( PARALLEL_GET_MORE_REQUESTS,                             32 ); if( randomize && BUGGIFY ) PARALLEL_GET_MORE_REQUESTS = 2;
 	init( MULTI_CURSOR_PRE_FETCH_LIMIT,                           10 );
 	init( MAX_QUEUE_COMMIT_BYTES,                               15e6 ); if( randomize && BUGGIFY ) MAX_QUEUE_COMMIT_BYTES = 5000;
+	init( TLOG_EMPTY_PUSH_COALESCE_DELAY,                          0 ); if( randomize && BUGGIFY ) TLOG_EMPTY_PUSH_COALESCE_DELAY = g_random->coinflip() ? 0.002 : 0.05;
 	init( VERSIONS_PER_BATCH,                 VERSIONS_PER_SECOND/20 ); if( randomize && BUGGIFY ) VERSIONS_PER_BATCH = std::max<int64_t>(1,VERSIONS_PER_SECOND/1000);
 	init( CONCURRENT_LOG_ROUTER_READS,                             1 );
+	init( MUTATION_CHECKSUMS,                                      1 ); if( randomize && BUGGIFY ) MUTATION_CHECKSUMS = 0;
 	init( DISK_QUEUE_ADAPTER_MIN_SWITCH_TIME,                    1.0 );
 	init( DISK_QUEUE_ADAPTER_MAX_SWITCH_TIME,                    5.0 );
+	init( DISK_QUEUE_ADAPTER_PREFETCH_BYTES,                    32e6 ); if( randomize && BUGGIFY ) DISK_QUEUE_ADAPTER_PREFETCH_BYTES = 1e4;
+	init( DISK_QUEUE_SYNC_COALESCE_TIME,                         0.0 ); if( randomize && BUGGIFY ) DISK_QUEUE_SYNC_COALESCE_TIME = 0.002;
+	init( DISK_QUEUE_FILE_EXTENSION_BYTES,                    10<<20 ); if( randomize && BUGGIFY ) DISK_QUEUE_FILE_EXTENSION_BYTES = 8<<10;
+	init( DISK_QUEUE_RECOVERY_READ_BYTES,                      1<<20 );
 
 	// Data distribution queue
 	init( HEALTH_POLL_TIME,                                      1.0 );
@@ -76,9 +87,12 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( BG_DD_POLLING_INTERVAL,                               10.0 );
 	init( DD_QUEUE_LOGGING_INTERVAL,                             5.0 );
 	init( RELOCATION_PARALLELISM_PER_SOURCE_SERVER,                4 ); if( randomize && BUGGIFY ) RELOCATION_PARALLELISM_PER_SOURCE_SERVER = 1;
+	init( RELOCATION_PARALLELISM_PER_DEST_SERVER,                 10 ); if( randomize && BUGGIFY ) RELOCATION_PARALLELISM_PER_DEST_SERVER = 1; // Note: if this is smaller than RELOCATION_PARALLELISM_PER_SOURCE_SERVER, a newly recruited server cannot absorb work from every source at once
+	init( DEST_OVERLOADED_DELAY,                                 0.2 );
 	init( DD_QUEUE_MAX_KEY_SERVERS,                              100 ); if( randomize && BUGGIFY ) DD_QUEUE_MAX_KEY_SERVERS = 1;
 	init( DD_REBALANCE_PARALLELISM,                               50 );
 	init( DD_REBALANCE_RESET_AMOUNT,                              30 );
+	init( DD_REBALANCE_BY_LOAD,                                false ); if( randomize && BUGGIFY ) DD_REBALANCE_BY_LOAD = true;
 	init( BG_DD_MAX_WAIT,                                      120.0 );
 	init( BG_DD_MIN_WAIT,                                        0.1 );
 	init( BG_DD_INCREASE_RATE,                                  1.10 );
@@ -179,6 +193,10 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( CHECK_FREE_PAGE_AMOUNT,                                100 ); if( randomize && BUGGIFY ) CHECK_FREE_PAGE_AMOUNT = 5;
 	init( DISK_METRIC_LOGGING_INTERVAL,                          5.0 );
 	init( SOFT_HEAP_LIMIT,                                     300e6 );
+	init( SQLITE_READER_THREADS,                                  64 ); if( randomize && BUGGIFY ) SQLITE_READER_THREADS = 2;
+	init( SQLITE_INITIAL_READER_THREADS,                          16 ); if( randomize && BUGGIFY ) SQLITE_INITIAL_READER_THREADS = 1;
+	init( SQLITE_READER_RESERVED_PRIORITY_THREADS,                 1 ); if( randomize && BUGGIFY ) SQLITE_READER_RESERVED_PRIORITY_THREADS = g_random->randomInt(0, 3);
+	init( SQLITE_SET_BATCH_SIZE,                                 250 ); if( randomize && BUGGIFY ) SQLITE_SET_BATCH_SIZE = g_random->randomInt(1, 4);
 
 	init( SQLITE_PAGE_SCAN_ERROR_LIMIT,                        10000 );
 	init( SQLITE_BTREE_PAGE_USABLE,                          4096 - 8);  // pageSize - reserveSize for page checksum
@@ -207,7 +225,10 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 
 	// KeyValueStoreSqlite spring cleaning
 	init( CLEANING_INTERVAL,                                     1.0 );
+	init( SPRING_CLEANING_MIN_INTERVAL,                          .01 ); if( randomize && BUGGIFY ) SPRING_CLEANING_MIN_INTERVAL = g_random->random01() * 5;
+	init( SPRING_CLEANING_MAX_INTERVAL,                         10.0 ); if( randomize && BUGGIFY ) SPRING_CLEANING_MAX_INTERVAL = g_random->coinflip() ? 1.0 : 60.0;
 	init( SPRING_CLEANING_TIME_ESTIMATE,                        .010 );
+	init( SPRING_CLEANING_IDLE_TIME_SLICE,                     .0005 ); if( randomize && BUGGIFY ) SPRING_CLEANING_IDLE_TIME_SLICE = g_random->random01() * .010;
 	init( SPRING_CLEANING_VACUUMS_PER_LAZY_DELETE_PAGE,          0.0 ); if( randomize && BUGGIFY ) SPRING_CLEANING_VACUUMS_PER_LAZY_DELETE_PAGE = g_random->coinflip() ? 1e9 : g_random->random01() * 5;
 	init( SPRING_CLEANING_MIN_LAZY_DELETE_PAGES,                   0 ); if( randomize && BUGGIFY ) SPRING_CLEANING_MIN_LAZY_DELETE_PAGES = g_random->randomInt(1, 100);
 	init( SPRING_CLEANING_MAX_LAZY_DELETE_PAGES,                 1e9 ); if( randomize && BUGGIFY ) SPRING_CLEANING_MAX_LAZY_DELETE_PAGES = g_random->coinflip() ? 0 : g_random->randomInt(1, 1e4);
@@ -217,6 +238,7 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 
 	// KeyValueStoreMemory
 	init( REPLACE_CONTENTS_BYTES,                                1e5 ); if( randomize && BUGGIFY ) REPLACE_CONTENTS_BYTES = 1e3;
+	init( MEMORY_SNAPSHOT_BATCH_BYTES,                           1e6 ); if( randomize && BUGGIFY ) MEMORY_SNAPSHOT_BATCH_BYTES = g_random->randomInt(100, 10000);
 
 	// Leader election
 	bool longLeaderElection = randomize && BUGGIFY;
@@ -247,12 +269,18 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT,              8LL << 30 ); if (randomize && BUGGIFY) COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT = g_random->randomInt64(100LL << 20,  8LL << 30);
 	init( COMMIT_BATCHES_MEM_FRACTION_OF_TOTAL,                   0.5 );
 	init( COMMIT_BATCHES_MEM_TO_TOTAL_MEM_SCALE_FACTOR,          10.0 );
+	init( COMMIT_BATCHES_MEM_THROTTLE_FRACTION,                   0.5 ); if( randomize && BUGGIFY ) COMMIT_BATCHES_MEM_THROTTLE_FRACTION = 0.1;
+	init( COMMIT_TRACE_SAMPLE_RATE,                              0.01 ); if( randomize && BUGGIFY ) COMMIT_TRACE_SAMPLE_RATE = 1.0;
+	init( PROXY_BACKUP_ARENA_MIN_SIZE,                           4096 );
+	init( PROXY_BACKUP_ARENA_MAX_SIZE,                         262144 ); if( randomize && BUGGIFY ) PROXY_BACKUP_ARENA_MAX_SIZE = 4096;
 
 	// these settings disable batch bytes scaling.  Try COMMIT_TRANSACTION_BATCH_BYTES_MAX=1e6, COMMIT_TRANSACTION_BATCH_BYTES_SCALE_BASE=50000, COMMIT_TRANSACTION_BATCH_BYTES_SCALE_POWER=0.5?
 	init( COMMIT_TRANSACTION_BATCH_BYTES_MIN,                  100000 );
 	init( COMMIT_TRANSACTION_BATCH_BYTES_MAX,                  100000 ); if( randomize && BUGGIFY ) { COMMIT_TRANSACTION_BATCH_BYTES_MIN = COMMIT_TRANSACTION_BATCH_BYTES_MAX = 1000000; }
 	init( COMMIT_TRANSACTION_BATCH_BYTES_SCALE_BASE,           100000 );
 	init( COMMIT_TRANSACTION_BATCH_BYTES_SCALE_POWER,             0.0 );
+	init( COMMIT_BATCH_LATENCY_TARGET,                            0.0 ); if( randomize && BUGGIFY ) COMMIT_BATCH_LATENCY_TARGET = 0.05;
+	init( COMMIT_BATCH_BYTES_GROWTH_RATE,                        1.05 );
 
 	init( TRANSACTION_BUDGET_TIME,							   0.050 ); if( randomize && BUGGIFY ) TRANSACTION_BUDGET_TIME = 0.0;
 	init( RESOLVER_COALESCE_TIME,                                1.0 );
@@ -269,8 +297,10 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( KEY_BYTES_PER_SAMPLE,                                  2e4 ); if( fastBalancing ) KEY_BYTES_PER_SAMPLE = 1e3;
 	init( MIN_BALANCE_TIME,                                      0.2 );
 	init( MIN_BALANCE_DIFFERENCE,                                1e6 ); if( fastBalancing ) MIN_BALANCE_DIFFERENCE = 1e4;
+	init( MIN_BALANCE_RATIO,                                     .05 ); if( fastBalancing ) MIN_BALANCE_RATIO = .001;
 	init( SECONDS_BEFORE_NO_FAILURE_DELAY,                  8 * 3600 );
 	init( MAX_TXS_SEND_MEMORY,                                   1e7 ); if( randomize && BUGGIFY ) MAX_TXS_SEND_MEMORY = 1e5;
+	init( TXN_STATE_CHAIN_BROADCAST,                               1 ); if( randomize && BUGGIFY ) TXN_STATE_CHAIN_BROADCAST = 0;
 	init( MAX_RECOVERY_VERSIONS,           200 * VERSIONS_PER_SECOND );
 	init( MAX_RECOVERY_TIME,                                    20.0 ); if( randomize && BUGGIFY ) MAX_RECOVERY_TIME = 1.0;
 
@@ -279,6 +309,9 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( SAMPLE_EXPIRATION_TIME,                                1.0 );
 	init( SAMPLE_POLL_TIME,                                      0.1 );
 	init( RESOLVER_STATE_MEMORY_LIMIT,                           1e6 );
+	init( CONFLICT_SET_PARALLEL_THREADS,                           0 );
+	init( CONFLICT_SET_SHARDS,                                     8 ); if( randomize && BUGGIFY ) CONFLICT_SET_SHARDS = g_random->coinflip() ? 1 : 2;
+	init( CONFLICT_SET_SHARD_SAMPLE_RANGES,                     5000 ); if( randomize && BUGGIFY ) CONFLICT_SET_SHARD_SAMPLE_RANGES = 10;
 	init( LAST_LIMITED_RATIO,                                    0.6 );
 
 	//Cluster Controller
@@ -332,15 +365,21 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( SMOOTHING_AMOUNT,                                      1.0 ); if( slowRateKeeper ) SMOOTHING_AMOUNT = 5.0;
 	init( SLOW_SMOOTHING_AMOUNT,                                10.0 ); if( slowRateKeeper ) SLOW_SMOOTHING_AMOUNT = 50.0;
 	init( METRIC_UPDATE_RATE,                                     .1 ); if( slowRateKeeper ) METRIC_UPDATE_RATE = 0.5;
+	init( RATEKEEPER_MODEL_QUEUE_DRAIN,                        false ); if( randomize && BUGGIFY ) RATEKEEPER_MODEL_QUEUE_DRAIN = true;
+	init( RATEKEEPER_QUEUE_DRAIN_TIME,                          10.0 );
 
 	bool smallStorageTarget = randomize && BUGGIFY;
 	init( TARGET_BYTES_PER_STORAGE_SERVER,                    1000e6 ); if( smallStorageTarget ) TARGET_BYTES_PER_STORAGE_SERVER = 3000e3;
 	init( SPRING_BYTES_STORAGE_SERVER,                         100e6 ); if( smallStorageTarget ) SPRING_BYTES_STORAGE_SERVER = 300e3;
+	init( TARGET_BYTES_PER_STORAGE_SERVER_BATCH,               750e6 ); if( smallStorageTarget ) TARGET_BYTES_PER_STORAGE_SERVER_BATCH = 1500e3;
+	init( SPRING_BYTES_STORAGE_SERVER_BATCH,                   100e6 ); if( smallStorageTarget ) SPRING_BYTES_STORAGE_SERVER_BATCH = 150e3;
 	init( STORAGE_HARD_LIMIT_BYTES,                           1500e6 ); if( smallStorageTarget ) STORAGE_HARD_LIMIT_BYTES = 4500e3;
 
 	bool smallTlogTarget = randomize && BUGGIFY;
 	init( TARGET_BYTES_PER_TLOG,                              2400e6 ); if( smallTlogTarget ) TARGET_BYTES_PER_TLOG = 2000e3;
 	init( SPRING_BYTES_TLOG,								   400e6 ); if( smallTlogTarget ) SPRING_BYTES_TLOG = 200e3;
+	init( TARGET_BYTES_PER_TLOG_BATCH,                        1400e6 ); if( smallTlogTarget ) TARGET_BYTES_PER_TLOG_BATCH = 1400e3;
+	init( SPRING_BYTES_TLOG_BATCH,							   300e6 ); if( smallTlogTarget ) SPRING_BYTES_TLOG_BATCH = 150e3;
 	init( TLOG_SPILL_THRESHOLD,                               1500e6 ); if( smallTlogTarget ) TLOG_SPILL_THRESHOLD = 1500e3; if( randomize && BUGGIFY ) TLOG_SPILL_THRESHOLD = 0;
 	init( TLOG_HARD_LIMIT_BYTES,                              3000e6 ); if( smallTlogTarget ) TLOG_HARD_LIMIT_BYTES = 3000e3;
 	init( TLOG_RECOVER_MEMORY_LIMIT, TARGET_BYTES_PER_TLOG + SPRING_BYTES_TLOG );
@@ -367,10 +406,19 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( STORAGE_LIMIT_BYTES,                                500000 );
 	init( BUGGIFY_LIMIT_BYTES,                                  1000 );
 	init( FETCH_BLOCK_BYTES,                                     2e6 );
-	init( FETCH_KEYS_PARALLELISM_BYTES,                          5e6 ); if( randomize && BUGGIFY ) FETCH_KEYS_PARALLELISM_BYTES = 4e6;
+	init( FETCH_KEYS_PARALLELISM_BYTES,                          1e7 ); if( randomize && BUGGIFY ) FETCH_KEYS_PARALLELISM_BYTES = 4e6;
+	init( RANGE_READ_LOW_PRIORITY,                                 1 ); if( randomize && BUGGIFY ) RANGE_READ_LOW_PRIORITY = 0;
+	init( STORAGE_PENALTY_READ_QUEUE_DEPTH,                      100 ); if( randomize && BUGGIFY ) STORAGE_PENALTY_READ_QUEUE_DEPTH = 2;
+	init( STORAGE_PENALTY_VERSION_LAG,           VERSIONS_PER_SECOND ); if( randomize && BUGGIFY ) STORAGE_PENALTY_VERSION_LAG = VERSIONS_PER_SECOND/100;
+	init( STORAGE_SHED_READ_QUEUE_DEPTH,                        5000 ); if( randomize && BUGGIFY ) STORAGE_SHED_READ_QUEUE_DEPTH = 10;
+	init( STORAGE_BLOOM_FILTER_BITS_PER_KEY,                       0 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_BITS_PER_KEY = 10;
+	init( STORAGE_BLOOM_FILTER_MAX_KEYS,                         1e6 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_MAX_KEYS = 100;
+	init( STORAGE_KEY_INTERN_MAX_BYTES,                         10e6 ); if( randomize && BUGGIFY ) STORAGE_KEY_INTERN_MAX_BYTES = 1000;
+	init( STORAGE_HOT_VALUE_CACHE_BYTES,                         4e6 ); if( randomize && BUGGIFY ) STORAGE_HOT_VALUE_CACHE_BYTES = 1000;
 	init( BUGGIFY_BLOCK_BYTES,                                 10000 );
 	init( STORAGE_COMMIT_BYTES,                             10000000 ); if( randomize && BUGGIFY ) STORAGE_COMMIT_BYTES = 2000000;
 	init( STORAGE_COMMIT_INTERVAL,                               0.5 ); if( randomize && BUGGIFY ) STORAGE_COMMIT_INTERVAL = 2.0;
+	init( STORAGE_COMMIT_PIPELINE_DEPTH,                           2 ); if( randomize && BUGGIFY ) STORAGE_COMMIT_PIPELINE_DEPTH = g_random->randomInt(1, 4);
 	init( UPDATE_SHARD_VERSION_INTERVAL,                        0.25 ); if( randomize && BUGGIFY ) UPDATE_SHARD_VERSION_INTERVAL = 1.0;
 	init( BYTE_SAMPLING_FACTOR,                                  250 ); //cannot buggify because of differences in restarting tests
 	init( BYTE_SAMPLING_OVERHEAD,                                100 );
@@ -386,12 +434,24 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	//Worker
 	init( WORKER_LOGGING_INTERVAL,                               5.0 );
 	init( INCOMPATIBLE_PEER_DELAY_BEFORE_LOGGING,                5.0 );
+	init( LATENCY_PROBE_INTERVAL,                                1.0 ); if( randomize && BUGGIFY ) LATENCY_PROBE_INTERVAL = g_random->coinflip() ? 0.0 : 0.1;
+	init( LATENCY_PROBE_LOGGING_INTERVAL,                       30.0 ); if( randomize && BUGGIFY ) LATENCY_PROBE_LOGGING_INTERVAL = 2.0;
+	init( AUTO_PAGE_CACHE_MEMORY_FRACTION,                       0.0 );
+	init( AUTO_PROCESS_MEMORY_FRACTION,                          0.0 );
+	init( PAGE_CACHE_TUNING_INTERVAL,                           60.0 ); if( randomize && BUGGIFY ) PAGE_CACHE_TUNING_INTERVAL = 5.0;
+	init( PAGE_CACHE_TUNING_MIN_FREE_FRACTION,                  0.05 );
+	init( PAGE_CACHE_TUNING_GROW_FREE_FRACTION,                 0.15 );
+	init( PAGE_CACHE_TUNING_MISS_RATE_THRESHOLD,                0.05 );
+	init( PAGE_CACHE_TUNING_STEP_BYTES,                    256LL<<20 );
+	init( PAGE_CACHE_TUNING_MIN_BYTES,                     256LL<<20 );
+	init( PAGE_CACHE_TUNING_MAX_FRACTION,                        0.5 );
 
 	// Test harness
 	init( WORKER_POLL_DELAY,                                     1.0 );
 
 	// Coordination
 	init( COORDINATED_STATE_ONCONFLICT_POLL_INTERVAL,            1.0 ); if( randomize && BUGGIFY ) COORDINATED_STATE_ONCONFLICT_POLL_INTERVAL = 10.0;
+	init( COORDINATOR_SLOW_REPLY_WARN_LATENCY,                   0.1 );
 
 	// Buggification
 	init( BUGGIFIED_EVENTUAL_CONSISTENCY,                        1.0 );
@@ -399,12 +459,17 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 
 	// Status
 	init( STATUS_MIN_TIME_BETWEEN_REQUESTS,                      0.0 );
+	init( STATUS_WORKER_EVENT_CACHE_TIME,                        2.0 ); if( randomize && BUGGIFY ) STATUS_WORKER_EVENT_CACHE_TIME = g_random->coinflip() ? 0.0 : 10.0;
+	init( STATUS_STATIC_EVENT_CACHE_TIME,                       30.0 ); if( randomize && BUGGIFY ) STATUS_STATIC_EVENT_CACHE_TIME = 0.0;
 	init( CONFIGURATION_ROWS_TO_FETCH,                         20000 );
 
 	// IPager
 	init( PAGER_RESERVED_PAGES,                                    1 );
 
 	// IndirectShadowPager
+	init( REDWOOD_PAGE_SIZE,                                    4096 );
+	init( REDWOOD_UNCACHED,                                        0 ); if( randomize && BUGGIFY ) REDWOOD_UNCACHED = 1;
+	init( REDWOOD_PAGE_CACHE_BYTES,                            200e6 ); if( randomize && BUGGIFY ) REDWOOD_PAGE_CACHE_BYTES = 1e6;
 	init( FREE_PAGE_VACUUM_THRESHOLD,                              1 );
 	init( VACUUM_QUEUE_SIZE,                                  100000 );
 	init( VACUUM_BYTES_PER_SECOND,                               1e6 );
@@ -413,6 +478,11 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs) {
 	init( TIME_KEEPER_DELAY,                                      10 );
 	init( TIME_KEEPER_MAX_ENTRIES,                              3600 * 24 * 30 * 6); if( randomize && BUGGIFY ) { TIME_KEEPER_MAX_ENTRIES = 2; }
 
+	// Network test
+	init( NETWORK_TEST_CLIENT_COUNT,                              30 );
+	init( NETWORK_TEST_REQUEST_SIZE,                               1 );
+	init( NETWORK_TEST_REPLY_SIZE,                            600000 );
+
 	if(clientKnobs)
 		clientKnobs->IS_ACCEPTABLE_DELAY = clientKnobs->IS_ACCEPTABLE_DELAY*std::min(MAX_READ_TRANSACTION_LIFE_VERSIONS, MAX_WRITE_TRANSACTION_LIFE_VERSIONS)/(5.0*VERSIONS_PER_SECOND);
 }
@@ -46,6 +46,9 @@ public:
 	double BUGGIFY_TLOG_STORAGE_MIN_UPDATE_INTERVAL;
 	double UNFLUSHED_DATA_RATIO;
 	int DESIRED_TOTAL_BYTES;
+	int LOG_ROUTER_PEEK_REPLY_BYTES; // Larger reply target for log router peeks, which cross datacenters
+	double LOG_ROUTER_PEEK_RESELECT_INTERVAL; // Seconds between checks of whether the log router should change how it peeks the source log set
+	int64_t LOG_ROUTER_PEEK_SWITCH_LAG_VERSIONS; // Pull lag above which the log router peeks a quorum of the source log set instead of the single preferred server
 	int DESIRED_UPDATE_BYTES;
 	double UPDATE_DELAY;
 	int MAXIMUM_PEEK_BYTES;
@@ -58,21 +61,29 @@ public:
 	double BUGGIFY_WORKER_REMOVED_MAX_LAG;
 	int64_t UPDATE_STORAGE_BYTE_LIMIT;
 	double TLOG_PEEK_DELAY;
+	double TLOG_WAN_PEEK_DELAY; // Pause before replying to a blocked WAN-class peek (log routers), so more versions accumulate into each reply
 	int LEGACY_TLOG_UPGRADE_ENTRIES_PER_VERSION;
 	int VERSION_MESSAGES_OVERHEAD_FACTOR_1024THS; // Multiplicative factor to bound total space used to store a version message (measured in 1/1024ths, e.g. a value of 2048 yields a factor of 2).
 	int64_t VERSION_MESSAGES_ENTRY_BYTES_WITH_OVERHEAD;
 	double TLOG_MESSAGE_BLOCK_OVERHEAD_FACTOR;
 	int64_t TLOG_MESSAGE_BLOCK_BYTES;
 	int64_t MAX_MESSAGE_SIZE;
+	int TLOG_SPILL_COMPRESSION_MIN_BYTES; // Spilled values at least this large are deflate-compressed before being written to the storage engine; negative disables compression
 	int LOG_SYSTEM_PUSHED_DATA_BLOCK_SIZE;
 	double PEEK_TRACKER_EXPIRATION_TIME;
 	int PARALLEL_GET_MORE_REQUESTS;
 	int MULTI_CURSOR_PRE_FETCH_LIMIT;
 	int64_t MAX_QUEUE_COMMIT_BYTES;
+	double TLOG_EMPTY_PUSH_COALESCE_DELAY; // Defer commit broadcasts to tlogs with no messages for a version, flushing within this many seconds; 0 broadcasts every version
 	int64_t VERSIONS_PER_BATCH;
 	int CONCURRENT_LOG_ROUTER_READS;
+	int MUTATION_CHECKSUMS; // if nonzero, commit and peek message payloads carry a CRC-32C verified on receipt, localizing corruption to a hop of the mutation pipeline
 	double DISK_QUEUE_ADAPTER_MIN_SWITCH_TIME;
 	double DISK_QUEUE_ADAPTER_MAX_SWITCH_TIME;
+	int64_t DISK_QUEUE_ADAPTER_PREFETCH_BYTES; // how far ahead of the consumer the txnStateStore recovery peek runs
+	double DISK_QUEUE_SYNC_COALESCE_TIME; // Maximum latency added to a busy disk queue commit to let concurrent commits share one sync; 0 disables coalescing
+	int64_t DISK_QUEUE_FILE_EXTENSION_BYTES; // When we grow the disk queue, by how many bytes should it grow?
+	int64_t DISK_QUEUE_RECOVERY_READ_BYTES; // Aligned read size for scanning the disk queue during recovery
 
 	// Data distribution queue
 	double HEALTH_POLL_TIME;
@@ -80,9 +91,12 @@ public:
 	double BG_DD_POLLING_INTERVAL;
 	double DD_QUEUE_LOGGING_INTERVAL;
 	double RELOCATION_PARALLELISM_PER_SOURCE_SERVER;
+	double RELOCATION_PARALLELISM_PER_DEST_SERVER;
+	double DEST_OVERLOADED_DELAY;
 	int DD_QUEUE_MAX_KEY_SERVERS;
 	int DD_REBALANCE_PARALLELISM;
 	int DD_REBALANCE_RESET_AMOUNT;
+	bool DD_REBALANCE_BY_LOAD; // Background rebalancing also moves traffic-hot shards off teams serving far more traffic than average
 	double BG_DD_MAX_WAIT;
 	double BG_DD_MIN_WAIT;
 	double BG_DD_INCREASE_RATE;
@@ -143,6 +157,10 @@ public:
 	int CHECK_FREE_PAGE_AMOUNT;
 	double DISK_METRIC_LOGGING_INTERVAL;
 	int64_t SOFT_HEAP_LIMIT;
+	int SQLITE_READER_THREADS;
+	int SQLITE_INITIAL_READER_THREADS;
+	int SQLITE_READER_RESERVED_PRIORITY_THREADS;  // Reader threads reserved for point reads, never taken by range reads
+	int SQLITE_SET_BATCH_SIZE;  // Sets per batch posted to the writer thread; each batch is applied in sorted key order
 
 	int SQLITE_PAGE_SCAN_ERROR_LIMIT;
 	int SQLITE_BTREE_PAGE_USABLE;
@@ -154,7 +172,10 @@ public:
 
 	// KeyValueStoreSqlite spring cleaning
 	double CLEANING_INTERVAL;
+	double SPRING_CLEANING_MIN_INTERVAL;
+	double SPRING_CLEANING_MAX_INTERVAL;
 	double SPRING_CLEANING_TIME_ESTIMATE;
+	double SPRING_CLEANING_IDLE_TIME_SLICE;
 	double SPRING_CLEANING_VACUUMS_PER_LAZY_DELETE_PAGE;
 	int SPRING_CLEANING_MIN_LAZY_DELETE_PAGES;
 	int SPRING_CLEANING_MAX_LAZY_DELETE_PAGES;
@@ -164,6 +185,7 @@ public:
 
 	// KeyValueStoreMemory
 	int64_t REPLACE_CONTENTS_BYTES;
+	int64_t MEMORY_SNAPSHOT_BATCH_BYTES;  // Maximum bytes of snapshot items logged per task before yielding
 
 	// Leader election
 	int MAX_NOTIFICATIONS;
@@ -194,9 +216,15 @@ public:
 	int    COMMIT_TRANSACTION_BATCH_BYTES_MAX;
 	double COMMIT_TRANSACTION_BATCH_BYTES_SCALE_BASE;
 	double COMMIT_TRANSACTION_BATCH_BYTES_SCALE_POWER;
+	double COMMIT_BATCH_LATENCY_TARGET; // If positive, the batch byte target tracks this commit latency (seconds) instead of staying fixed
+	double COMMIT_BATCH_BYTES_GROWTH_RATE;
 	int64_t COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT;
 	double COMMIT_BATCHES_MEM_FRACTION_OF_TOTAL;
 	double COMMIT_BATCHES_MEM_TO_TOTAL_MEM_SCALE_FACTOR;
+	double COMMIT_BATCHES_MEM_THROTTLE_FRACTION; // Ratekeeper starts throttling when a proxy's commit batch memory exceeds this fraction of its limit
+	double COMMIT_TRACE_SAMPLE_RATE; // Fraction of commit batches that log a CommitBatchTiming event with per-stage durations
+	int    PROXY_BACKUP_ARENA_MIN_SIZE; // Bounds on the up-front arena reservation for a batch's backup mutation lists,
+	int    PROXY_BACKUP_ARENA_MAX_SIZE; // which is sized from the previous batch's backup mutation volume
 
 	double TRANSACTION_BUDGET_TIME;
 	double RESOLVER_COALESCE_TIME;
@@ -209,8 +237,10 @@ public:
 	double COMMIT_SLEEP_TIME;
 	double MIN_BALANCE_TIME;
 	int64_t MIN_BALANCE_DIFFERENCE;
+	double MIN_BALANCE_RATIO; // Fraction of total resolver load the max-min spread must exceed before ranges are moved
 	double SECONDS_BEFORE_NO_FAILURE_DELAY;
 	int64_t MAX_TXS_SEND_MEMORY;
+	int TXN_STATE_CHAIN_BROADCAST; // if nonzero, recovery txnState batches are relayed proxy-to-proxy in a chain instead of sent to every proxy by the master
 	int64_t MAX_RECOVERY_VERSIONS;
 	double MAX_RECOVERY_TIME;
 
@@ -220,6 +250,9 @@ public:
 	double SAMPLE_EXPIRATION_TIME;
 	double SAMPLE_POLL_TIME;
 	int64_t RESOLVER_STATE_MEMORY_LIMIT;
+	int CONFLICT_SET_PARALLEL_THREADS; // Worker threads for parallel conflict detection; 0 keeps detection on the resolver's main thread.  Ignored in simulation.
+	int CONFLICT_SET_SHARDS; // Key range shards for the conflict set; 1 keeps a single skip list
+	int CONFLICT_SET_SHARD_SAMPLE_RANGES; // Combined write conflict ranges a batch must have before shard boundaries are sampled from it
 
 	//Cluster Controller
 	double CLUSTER_CONTROLLER_LOGGING_DELAY;
@@ -272,12 +305,18 @@ public:
 	double SLOW_SMOOTHING_AMOUNT;
 	double METRIC_UPDATE_RATE;
 	double LAST_LIMITED_RATIO;
+	bool RATEKEEPER_MODEL_QUEUE_DRAIN;  // Limit rates from an explicit queue-drain model rather than the piecewise spring
+	double RATEKEEPER_QUEUE_DRAIN_TIME;  // Seconds over which the model returns a queue to its target size
 
 	int64_t TARGET_BYTES_PER_STORAGE_SERVER;
 	double SPRING_BYTES_STORAGE_SERVER;
+	int64_t TARGET_BYTES_PER_STORAGE_SERVER_BATCH;  // Stricter queue target applied to batch priority transactions
+	double SPRING_BYTES_STORAGE_SERVER_BATCH;
 
 	int64_t TARGET_BYTES_PER_TLOG;
 	double SPRING_BYTES_TLOG;
+	int64_t TARGET_BYTES_PER_TLOG_BATCH;
+	double SPRING_BYTES_TLOG_BATCH;
 	int64_t TLOG_SPILL_THRESHOLD;
 	int64_t TLOG_HARD_LIMIT_BYTES;
 	int64_t TLOG_RECOVER_MEMORY_LIMIT;
@@ -305,10 +344,19 @@ public:
 	int BUGGIFY_LIMIT_BYTES;
 	int FETCH_BLOCK_BYTES;
 	int FETCH_KEYS_PARALLELISM_BYTES;
+	int RANGE_READ_LOW_PRIORITY;	// If nonzero, serve range reads below point read priority so scans can't starve them
+	int STORAGE_PENALTY_READ_QUEUE_DEPTH;	// Queued reads that advertise one unit of load balance penalty to clients
+	int64_t STORAGE_PENALTY_VERSION_LAG;	// Versions behind the tlogs that advertise one unit of load balance penalty to clients
+	int STORAGE_SHED_READ_QUEUE_DEPTH;	// Reads are rejected with server_overloaded beyond this queue depth so clients fail over immediately; 0 disables shedding
+	int STORAGE_BLOOM_FILTER_BITS_PER_KEY;	// If nonzero, maintain a bloom filter over the durable keys of fetched shards to skip disk reads for absent keys
+	int64_t STORAGE_BLOOM_FILTER_MAX_KEYS;	// Keys per shard filter beyond which the filter is dropped rather than allowed to degrade
+	int64_t STORAGE_KEY_INTERN_MAX_BYTES;	// Memory cap for the interned key table; 0 disables key interning
+	int64_t STORAGE_HOT_VALUE_CACHE_BYTES;	// Memory cap for the hot value cache over the storage engine; 0 disables the cache
 	int BUGGIFY_BLOCK_BYTES;
 	int64_t STORAGE_HARD_LIMIT_BYTES;
 	int STORAGE_COMMIT_BYTES;
 	double STORAGE_COMMIT_INTERVAL;
+	int STORAGE_COMMIT_PIPELINE_DEPTH;	// Engine commits that may be syncing to disk while the next commit's mutations are serialized; 1 disables pipelining
 	double UPDATE_SHARD_VERSION_INTERVAL;
 	int BYTE_SAMPLING_FACTOR;
 	int BYTE_SAMPLING_OVERHEAD;
@@ -324,12 +372,24 @@ public:
 	//Worker
 	double WORKER_LOGGING_INTERVAL;
 	double INCOMPATIBLE_PEER_DELAY_BEFORE_LOGGING;
+	double LATENCY_PROBE_INTERVAL;	// time between probe transactions from each worker's continuous latency probe; 0 disables it
+	double LATENCY_PROBE_LOGGING_INTERVAL;
+	double AUTO_PAGE_CACHE_MEMORY_FRACTION; // if nonzero, size the 4K page cache at startup to this fraction of detected machine RAM (an explicit page_cache_4k knob wins)
+	double AUTO_PROCESS_MEMORY_FRACTION; // if nonzero, derive the process memory limit from this fraction of detected machine RAM (an explicit --memory wins)
+	double PAGE_CACHE_TUNING_INTERVAL; // time between page cache resizing decisions from runtime feedback; 0 disables tuning
+	double PAGE_CACHE_TUNING_MIN_FREE_FRACTION; // shrink the page cache while machine available memory is below this fraction of total
+	double PAGE_CACHE_TUNING_GROW_FREE_FRACTION; // grow the page cache only while machine available memory is above this fraction of total
+	double PAGE_CACHE_TUNING_MISS_RATE_THRESHOLD; // grow only when the fraction of reads missing the cache over the last interval exceeds this
+	int64_t PAGE_CACHE_TUNING_STEP_BYTES; // how much the page cache grows or shrinks per decision
+	int64_t PAGE_CACHE_TUNING_MIN_BYTES; // tuning never shrinks the page cache below this
+	double PAGE_CACHE_TUNING_MAX_FRACTION; // tuning never grows the page cache beyond this fraction of machine RAM or of the process memory limit
 
 	// Test harness
 	double WORKER_POLL_DELAY;
 
 	// Coordination
 	double COORDINATED_STATE_ONCONFLICT_POLL_INTERVAL;
+	double COORDINATOR_SLOW_REPLY_WARN_LATENCY; // Coordinated state replies slower than this (e.g. a WAN coordinator in the recovery path) are logged
 
 	// Buggification
 	double BUGGIFIED_EVENTUAL_CONSISTENCY;
@@ -337,12 +397,17 @@ public:
 
 	// Status
 	double STATUS_MIN_TIME_BETWEEN_REQUESTS;
+	double STATUS_WORKER_EVENT_CACHE_TIME;	// How long worker event and role metrics fan-out results are reused between status requests
+	double STATUS_STATIC_EVENT_CACHE_TIME;	// Same, for events that only change when a process restarts (ProgramStart)
 	int CONFIGURATION_ROWS_TO_FETCH;
 
 	// IPager
 	int PAGER_RESERVED_PAGES;
 
 	// IndirectShadowPager
+	int REDWOOD_PAGE_SIZE;	// Must be a multiple of 4096; recorded in the pager log, so it cannot change for existing files
+	int REDWOOD_UNCACHED;	// If nonzero, open the data file for direct I/O and cache pages in the pager instead of the OS
+	int64_t REDWOOD_PAGE_CACHE_BYTES;
 	int FREE_PAGE_VACUUM_THRESHOLD;
 	int VACUUM_QUEUE_SIZE;
 	int VACUUM_BYTES_PER_SECOND;
@@ -351,6 +416,11 @@ public:
 	int64_t TIME_KEEPER_DELAY;
 	int64_t TIME_KEEPER_MAX_ENTRIES;
 
+	// Network test
+	int NETWORK_TEST_CLIENT_COUNT;	// concurrent outstanding requests per client process; the pipelining depth
+	int NETWORK_TEST_REQUEST_SIZE;	// bytes of payload sent with each request; large values drive the client-to-server direction
+	int NETWORK_TEST_REPLY_SIZE;	// bytes of payload in each reply; large values of both make the test bidirectional
+
 	ServerKnobs(bool randomize = false, ClientKnobs* clientKnobs = NULL);
 };
 
@@ -176,6 +176,8 @@ ACTOR Future<Void> pullAsyncData( LogRouterData *self ) {
 	state Version tagPopped = 0;
 	state Version lastVer = 0;
 	state std::vector<int> tags;
+	state bool useMergePeekCursors = false;
+	state Future<Void> reselectPeek = delay(SERVER_KNOBS->LOG_ROUTER_PEEK_RESELECT_INTERVAL);
 
 	loop {
 		loop {
@@ -186,11 +188,29 @@ ACTOR Future<Void> pullAsyncData( LogRouterData *self ) {
 				when( wait( dbInfoChange ) ) { //FIXME: does this actually happen?
 					if(r) tagPopped = std::max(tagPopped, r->popped());
 					if( self->logSystem->get() )
-						r = self->logSystem->get()->peekLogRouter( self->dbgid, tagAt, self->routerTag );
+						r = self->logSystem->get()->peekLogRouter( self->dbgid, tagAt, self->routerTag, useMergePeekCursors );
 					else
 						r = Reference<ILogSystem::IPeekCursor>();
 					dbInfoChange = self->logSystem->onChange();
 				}
+				when( wait( reselectPeek ) ) {
+					// The preferred server is the cheapest source (one copy of the data crosses the WAN), so peek it
+					// while the pull keeps up.  When the pull lags far behind what the source DC has committed, the
+					// single peeked tlog is the bottleneck, so switch to a quorum peek of the set until we catch up.
+					// The half threshold on the way back provides hysteresis so a borderline lag does not flap.
+					Version lag = self->minKnownCommittedVersion - self->version.get();
+					bool useMerge = lag > ( useMergePeekCursors ? SERVER_KNOBS->LOG_ROUTER_PEEK_SWITCH_LAG_VERSIONS / 2
+						: SERVER_KNOBS->LOG_ROUTER_PEEK_SWITCH_LAG_VERSIONS );
+					if( r && useMerge != useMergePeekCursors && self->logSystem->get() ) {
+						TEST( useMerge ); // Log router switched to merge peek cursors
+						TEST( !useMerge ); // Log router switched back to the preferred server
+						TraceEvent("LogRouterPeekReselect", self->dbgid).detail("UseMergePeekCursors", useMerge).detail("Lag", lag).detail("Version", self->version.get());
+						useMergePeekCursors = useMerge;
+						tagPopped = std::max(tagPopped, r->popped());
+						r = self->logSystem->get()->peekLogRouter( self->dbgid, tagAt, self->routerTag, useMergePeekCursors );
+					}
+					reselectPeek = delay(SERVER_KNOBS->LOG_ROUTER_PEEK_RESELECT_INTERVAL);
+				}
 			}
 		}
 
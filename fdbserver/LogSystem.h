@@ -406,6 +406,7 @@ struct ILogSystem {
 		int bestServer, currentCursor, readQuorum;
 		Optional<LogMessageVersion> nextVersion;
 		LogMessageVersion messageVersion;
+		Version peersAdvancedTo; // The version the non-best cursors were last advanced to, so they are advanced once per version rather than once per message
 		bool hasNextMessage;
 		UID randomID;
 		int tLogReplicationFactor;
@@ -452,6 +453,7 @@ struct ILogSystem {
 		std::vector< std::pair<LogMessageVersion, int> > sortedVersions;
 		Optional<LogMessageVersion> nextVersion;
 		LogMessageVersion messageVersion;
+		Version peersAdvancedTo; // The version the non-best cursors were last advanced to, so they are advanced once per version rather than once per message
 		bool hasNextMessage;
 		bool useBestSet;
 		UID randomID;
@@ -620,9 +622,11 @@ struct ILogSystem {
 	virtual Reference<IPeekCursor> peekSingle( UID dbgid, Version begin, Tag tag, vector<pair<Version,Tag>> history = vector<pair<Version,Tag>>() ) = 0;
 		// Same contract as peek(), but blocks until the preferred log server(s) for the given tag are available (and is correspondingly less expensive)
 
-	virtual Reference<IPeekCursor> peekLogRouter( UID dbgid, Version begin, Tag tag ) = 0;
+	virtual Reference<IPeekCursor> peekLogRouter( UID dbgid, Version begin, Tag tag, bool useMergePeekCursors = false ) = 0;
 		// Same contract as peek(), but can only peek from the logs elected in the same generation.
 		// If the preferred log server is down, a different log from the same generation will merge results locally before sending them to the log router.
+		// If useMergePeekCursors is set, the cursor peeks a quorum of the source log set instead of pinning the single
+		// preferred log server, so the pull is not limited by the most loaded replica (at the cost of duplicate WAN reads).
 
 	virtual Reference<IPeekCursor> peekSpecial( UID dbgid, Version begin, Tag tag, int8_t peekLocality, Version localEnd ) = 0;
 		// Same contract as peek(), but it allows specifying a preferred peek locality for tags that do not have locality
@@ -745,33 +749,56 @@ struct LogPushData : NonCopyable {
 
 	template <class T>
 	void addTypedMessage( T const& item ) {
-		prev_tags.clear();
-		if(logSystem->hasRemoteLogs()) {
-			prev_tags.push_back( logSystem->getRandomRouterTag() );
-		}
-		for(auto& tag : next_message_tags) {
-			prev_tags.push_back(tag);
+		// Runs of mutations with the same tags (common within one shard) reuse the previous push
+		// locations instead of recomputing them.  With remote logs every message draws a random log
+		// router tag, and different router tags can push to different locations, so no reuse there.
+		if (logSystem->hasRemoteLogs() || next_message_tags.empty() || next_message_tags != prev_tags) {
+			prev_tags.clear();
+			if(logSystem->hasRemoteLogs()) {
+				prev_tags.push_back( logSystem->getRandomRouterTag() );
+			}
+			for(auto& tag : next_message_tags) {
+				prev_tags.push_back(tag);
+			}
+			msg_locations.clear();
+			logSystem->getPushLocations( prev_tags, msg_locations );
 		}
-		msg_locations.clear();
-		logSystem->getPushLocations( prev_tags, msg_locations );
-		
+
 		uint32_t subseq = this->subsequence++;
+		int firstLoc = -1;
+		int firstOffset = -1;
+		int firstLength = -1;
 		for(int loc : msg_locations) {
-			// FIXME: memcpy after the first time
 			BinaryWriter& wr = messagesWriter[loc];
-			int offset = wr.getLength();
-			wr << uint32_t(0) << subseq << uint16_t(prev_tags.size());
-			for(auto& tag : prev_tags)
-				wr << tag;
-			wr << item;
-			*(uint32_t*)((uint8_t*)wr.getData() + offset) = wr.getLength() - offset - sizeof(uint32_t);
+			if (firstLoc == -1) {
+				// Serialize the message once, into the first location's writer
+				int offset = wr.getLength();
+				wr << uint32_t(0) << subseq << uint16_t(prev_tags.size());
+				for(auto& tag : prev_tags)
+					wr << tag;
+				wr << item;
+				firstLoc = loc;
+				firstOffset = offset;
+				firstLength = wr.getLength() - offset;
+				*(uint32_t*)((uint8_t*)wr.getData() + offset) = firstLength - sizeof(uint32_t);
+			} else {
+				// The other locations get an identical message, so just copy the bytes
+				wr.serializeBytes( (uint8_t*)messagesWriter[firstLoc].getData() + firstOffset, firstLength );
+			}
 		}
 		next_message_tags.clear();
 	}
 
 	Arena getArena() { return arena; }
 	StringRef getMessages(int loc) {
-		return StringRef( arena, messagesWriter[loc].toStringRef() );  // FIXME: Unnecessary copy!
+		// Each location's messages are copied into the arena once and cached: the commit requests
+		// keep the arena (not the writers) alive, and callers may ask for the same location's
+		// messages more than once (e.g. once to checksum them and once to send them)
+		if (writtenMessages.empty())
+			writtenMessages.resize( messagesWriter.size() );
+		if (!writtenMessages[loc].size() && messagesWriter[loc].getLength())
+			writtenMessages[loc] = StringRef( arena, messagesWriter[loc].toStringRef() );
+		return writtenMessages[loc];
 	}
 
 private:
@@ -780,6 +807,7 @@ private:
 	vector<Tag> next_message_tags;
 	vector<Tag> prev_tags;
 	vector<BinaryWriter> messagesWriter;
+	vector<StringRef> writtenMessages;
 	vector<int> msg_locations;
 	uint32_t subsequence;
 };
@@ -25,13 +25,23 @@
 
 class LogSystemDiskQueueAdapterImpl {
 public:
-	ACTOR static Future<Standalone<StringRef>> readNext( LogSystemDiskQueueAdapter* self, int bytes ) {
-		while (self->recoveryQueueDataSize < bytes) {
+	// Runs ahead of readNext() consumers, keeping up to DISK_QUEUE_ADAPTER_PREFETCH_BYTES of peeked
+	// commit messages queued so that KeyValueStoreMemory replay of one batch overlaps the network
+	// fetch of the next instead of alternating with it
+	ACTOR static Future<Void> fetchRecoveryData( LogSystemDiskQueueAdapter* self ) {
+		loop {
+			while (self->recoveryQueueDataSize >= SERVER_KNOBS->DISK_QUEUE_ADAPTER_PREFETCH_BYTES && self->recoveryQueueDataSize >= self->readNextBytesNeeded) {
+				TEST(true); // Recovery prefetch paused at its memory budget
+				wait( self->recoveryQueueConsumed.onTrigger() );
+			}
+
 			if (self->recoveryLoc == self->logSystem->getEnd()) {
 				// Recovery will be complete once the current recoveryQueue is consumed, so we no longer need self->logSystem
-				TraceEvent("PeekNextEnd").detail("Queue", self->recoveryQueue.size()).detail("Bytes", bytes).detail("Loc", self->recoveryLoc).detail("End", self->logSystem->getEnd()); 
+				TraceEvent("PeekNextEnd").detail("Queue", self->recoveryQueue.size()).detail("Loc", self->recoveryLoc).detail("End", self->logSystem->getEnd());
+				self->recoveryFetchComplete = true;
 				self->logSystem.clear();
-				break;
+				self->cursor.clear();
+				return Void();
 			}
 
 			if(!self->cursor->hasMessage()) {
@@ -56,7 +66,7 @@ public:
 						}
 					}
 				}
-				TraceEvent("PeekNextGetMore").detail("Queue", self->recoveryQueue.size()).detail("Bytes", bytes).detail("Loc", self->recoveryLoc).detail("End", self->logSystem->getEnd()); 
+				TraceEvent("PeekNextGetMore").detail("Queue", self->recoveryQueue.size()).detail("Loc", self->recoveryLoc).detail("End", self->logSystem->getEnd());
 				if(self->recoveryQueueDataSize == 0) {
 					self->recoveryQueueLoc = self->recoveryLoc;
 				}
@@ -65,14 +75,34 @@ public:
 					continue;
 				}
 			}
-			
-			self->recoveryQueue.push_back( Standalone<StringRef>(self->cursor->getMessage(), self->cursor->arena()) );
-			self->recoveryQueueDataSize += self->recoveryQueue.back().size();
-			self->cursor->nextMessage();
-			if(!self->cursor->hasMessage()) self->recoveryLoc = self->cursor->version().version;
 
-			//TraceEvent("PeekNextResults").detail("From", self->recoveryLoc).detail("Queue", self->recoveryQueue.size()).detail("Bytes", bytes).detail("Has", self->cursor->hasMessage()).detail("End", self->logSystem->getEnd()); 
+			// Drain everything the cursor already holds; this can run past the prefetch budget by at
+			// most one peek reply
+			while (self->cursor->hasMessage()) {
+				self->recoveryQueue.push_back( Standalone<StringRef>(self->cursor->getMessage(), self->cursor->arena()) );
+				self->recoveryQueueDataSize += self->recoveryQueue.back().size();
+				self->cursor->nextMessage();
+			}
+			self->recoveryLoc = self->cursor->version().version;
+			self->recoveryQueueFilled.trigger();
+
+			//TraceEvent("PeekNextResults").detail("From", self->recoveryLoc).detail("Queue", self->recoveryQueue.size()).detail("End", self->logSystem->getEnd());
 		}
+	}
+
+	ACTOR static Future<Standalone<StringRef>> readNext( LogSystemDiskQueueAdapter* self, int bytes ) {
+		if (!self->recoveryFetcher.isValid())
+			self->recoveryFetcher = fetchRecoveryData( self );
+
+		self->readNextBytesNeeded = bytes;
+		while (self->recoveryQueueDataSize < bytes && !self->recoveryFetchComplete) {
+			choose {
+				when( wait( self->recoveryFetcher ) ) {}   // rethrows a prefetch error; otherwise recoveryFetchComplete is now set
+				when( wait( self->recoveryQueueFilled.onTrigger() ) ) {}
+			}
+		}
+		self->readNextBytesNeeded = 0;
+
 		if(self->recoveryQueue.size() > 1) {
 			self->recoveryQueue[0] = concatenate(self->recoveryQueue.begin(), self->recoveryQueue.end());
 			self->recoveryQueue.resize(1);
@@ -91,6 +121,7 @@ public:
 		if(self->recoveryQueue[0].size() == 0) {
 			self->recoveryQueue.clear();
 		}
+		self->recoveryQueueConsumed.trigger();
 		return result;
 	}
 };
@@ -22,6 +22,20 @@
 #include "fdbrpc/FailureMonitor.h"
 #include "fdbserver/Knobs.h"
 #include "fdbrpc/ReplicationUtils.h"
+#include "fdbrpc/crc32c.h"
+
+// The storage server verifies peek replies before applying anything from them, so corruption on
+// the tlog to storage hop has a distinct signature from corruption earlier in the mutation
+// pipeline.  A zero checksum means the tlog did not stamp one (e.g. an older log system).
+static void verifyPeekChecksum( UID randomID, Tag tag, TLogPeekReply const& res ) {
+	if( SERVER_KNOBS->MUTATION_CHECKSUMS && res.checksum && crc32c_append( 0, res.messages.begin(), res.messages.size() ) != res.checksum ) {
+		TraceEvent(SevError, "PeekCursorChecksumMismatch", randomID)
+			.detail("Tag", tag.toString())
+			.detail("End", res.end)
+			.detail("MessageBytes", res.messages.size());
+		throw checksum_failed();
+	}
+}
 
 ILogSystem::ServerPeekCursor::ServerPeekCursor( Reference<AsyncVar<OptionalInterface<TLogInterface>>> const& interf, Tag tag, Version begin, Version end, bool returnIfBlocked, bool parallelGetMore )
 			: interf(interf), tag(tag), messageVersion(begin), end(end), hasMsg(false), rd(results.arena, results.messages, Unversioned()), randomID(g_random->randomUniqueID()), poppedVersion(0), returnIfBlocked(returnIfBlocked), sequence(0), parallelGetMore(parallelGetMore) {
@@ -154,6 +168,7 @@ ACTOR Future<Void> serverPeekParallelGetMore( ILogSystem::ServerPeekCursor* self
 					if(res.begin.get() != expectedBegin) {
 						throw timed_out();
 					}
+					verifyPeekChecksum( self->randomID, self->tag, res );
 					expectedBegin = res.end;
 					self->futureResults.pop_front();
 					self->results = res;
@@ -201,6 +216,7 @@ ACTOR Future<Void> serverPeekGetMore( ILogSystem::ServerPeekCursor* self, int ta
 			choose {
 				when( TLogPeekReply res = wait( self->interf->get().present() ?
 					brokenPromiseToNever( self->interf->get().interf().peekMessages.getReply(TLogPeekRequest(self->messageVersion.version,self->tag,self->returnIfBlocked), taskID) ) : Never() ) ) {
+					verifyPeekChecksum( self->randomID, self->tag, res );
 					self->results = res;
 					if(res.popped.present())
 						self->poppedVersion = std::min( std::max(self->poppedVersion, res.popped.get()), self->end.version );
@@ -267,13 +283,13 @@ Version ILogSystem::ServerPeekCursor::popped() { return poppedVersion; }
 
 ILogSystem::MergedPeekCursor::MergedPeekCursor( vector< Reference<ILogSystem::IPeekCursor> > const& serverCursors, Version begin )
 	: serverCursors(serverCursors), bestServer(-1), readQuorum(serverCursors.size()), tag(invalidTag), currentCursor(0), hasNextMessage(false),
-	messageVersion(begin), randomID(g_random->randomUniqueID()), tLogReplicationFactor(0) {
+	messageVersion(begin), peersAdvancedTo(invalidVersion), randomID(g_random->randomUniqueID()), tLogReplicationFactor(0) {
 	sortedVersions.resize(serverCursors.size());
 }
 
 ILogSystem::MergedPeekCursor::MergedPeekCursor( std::vector<Reference<AsyncVar<OptionalInterface<TLogInterface>>>> const& logServers, int bestServer, int readQuorum, Tag tag, Version begin, Version end,
 	bool parallelGetMore, std::vector< LocalityData > const& tLogLocalities, IRepPolicyRef const tLogPolicy, int tLogReplicationFactor )
-	: bestServer(bestServer), readQuorum(readQuorum), tag(tag), currentCursor(0), hasNextMessage(false), messageVersion(begin), randomID(g_random->randomUniqueID()), tLogReplicationFactor(tLogReplicationFactor) {
+	: bestServer(bestServer), readQuorum(readQuorum), tag(tag), currentCursor(0), hasNextMessage(false), messageVersion(begin), peersAdvancedTo(invalidVersion), randomID(g_random->randomUniqueID()), tLogReplicationFactor(tLogReplicationFactor) {
 	if(tLogPolicy) {
 		logSet = Reference<LogSet>( new LogSet() );
 		logSet->tLogPolicy = tLogPolicy;
@@ -291,7 +307,7 @@ ILogSystem::MergedPeekCursor::MergedPeekCursor( std::vector<Reference<AsyncVar<O
 }
 
 ILogSystem::MergedPeekCursor::MergedPeekCursor( vector< Reference<ILogSystem::IPeekCursor> > const& serverCursors, LogMessageVersion const& messageVersion, int bestServer, int readQuorum, Optional<LogMessageVersion> nextVersion, Reference<LogSet> logSet, int tLogReplicationFactor )
-	: serverCursors(serverCursors), bestServer(bestServer), readQuorum(readQuorum), currentCursor(0), hasNextMessage(false), messageVersion(messageVersion), nextVersion(nextVersion), logSet(logSet),
+	: serverCursors(serverCursors), bestServer(bestServer), readQuorum(readQuorum), currentCursor(0), hasNextMessage(false), messageVersion(messageVersion), peersAdvancedTo(invalidVersion), nextVersion(nextVersion), logSet(logSet),
 	randomID(g_random->randomUniqueID()), tLogReplicationFactor(tLogReplicationFactor) {
 	sortedVersions.resize(serverCursors.size());
 	calcHasMessage();
@@ -324,8 +340,13 @@ void ILogSystem::MergedPeekCursor::calcHasMessage() {
 			currentCursor = bestServer;
 			hasNextMessage = true;
 
-			for (auto& c : serverCursors)
-				c->advanceTo(messageVersion);
+			// The other cursors hold copies of the same commits, so they only need to catch up when the
+			// best server moves to a new version, not for every message within a version
+			if( messageVersion.version > peersAdvancedTo ) {
+				peersAdvancedTo = messageVersion.version;
+				for (auto& c : serverCursors)
+					c->advanceTo(messageVersion);
+			}
 
 			return;
 		}
@@ -496,7 +517,7 @@ Version ILogSystem::MergedPeekCursor::popped() {
 }
 
 ILogSystem::SetPeekCursor::SetPeekCursor( std::vector<Reference<LogSet>> const& logSets, int bestSet, int bestServer, Tag tag, Version begin, Version end, bool parallelGetMore )
-	: logSets(logSets), bestSet(bestSet), bestServer(bestServer), tag(tag), currentCursor(0), currentSet(bestSet), hasNextMessage(false), messageVersion(begin), useBestSet(true), randomID(g_random->randomUniqueID()) {
+	: logSets(logSets), bestSet(bestSet), bestServer(bestServer), tag(tag), currentCursor(0), currentSet(bestSet), hasNextMessage(false), messageVersion(begin), peersAdvancedTo(invalidVersion), useBestSet(true), randomID(g_random->randomUniqueID()) {
 	serverCursors.resize(logSets.size());
 	int maxServers = 0;
 	for( int i = 0; i < logSets.size(); i++ ) {
@@ -510,7 +531,7 @@ ILogSystem::SetPeekCursor::SetPeekCursor( std::vector<Reference<LogSet>> const&
 }
 
 ILogSystem::SetPeekCursor::SetPeekCursor( std::vector<Reference<LogSet>> const& logSets, std::vector< std::vector< Reference<IPeekCursor> > > const& serverCursors, LogMessageVersion const& messageVersion, int bestSet, int bestServer, 
-	Optional<LogMessageVersion> nextVersion, bool useBestSet ) : logSets(logSets), serverCursors(serverCursors), messageVersion(messageVersion), bestSet(bestSet), bestServer(bestServer), nextVersion(nextVersion), currentSet(bestSet), currentCursor(0),
+	Optional<LogMessageVersion> nextVersion, bool useBestSet ) : logSets(logSets), serverCursors(serverCursors), messageVersion(messageVersion), peersAdvancedTo(invalidVersion), bestSet(bestSet), bestServer(bestServer), nextVersion(nextVersion), currentSet(bestSet), currentCursor(0),
 	hasNextMessage(false), useBestSet(useBestSet), randomID(g_random->randomUniqueID()) {
 	int maxServers = 0;
 	for( int i = 0; i < logSets.size(); i++ ) {
@@ -560,9 +581,14 @@ void ILogSystem::SetPeekCursor::calcHasMessage() {
 
 			//TraceEvent("LPC_Calc1").detail("Ver", messageVersion.toString()).detail("Tag", tag.toString()).detail("HasNextMessage", hasNextMessage);
 
-			for (auto& cursors : serverCursors) {
-				for(auto& c : cursors) {
-					c->advanceTo(messageVersion);
+			// The other cursors hold copies of the same commits, so they only need to catch up when the
+			// best server moves to a new version, not for every message within a version
+			if( messageVersion.version > peersAdvancedTo ) {
+				peersAdvancedTo = messageVersion.version;
+				for (auto& cursors : serverCursors) {
+					for(auto& c : cursors) {
+						c->advanceTo(messageVersion);
+					}
 				}
 			}
 
@@ -54,24 +54,28 @@ struct MasterInterface {
 struct GetRateInfoRequest {
 	UID requesterID;
 	int64_t totalReleasedTransactions;
+	int64_t batchReleasedTransactions;
+	int64_t commitBatchesMemBytes;       // Current bytes of in-flight commit batches on the requesting proxy
+	int64_t commitBatchesMemBytesLimit;  // The requesting proxy's commit batch memory limit
 	ReplyPromise<struct GetRateInfoReply> reply;
 
 	GetRateInfoRequest() {}
-	GetRateInfoRequest( UID const& requesterID, int64_t totalReleasedTransactions ) : requesterID(requesterID), totalReleasedTransactions(totalReleasedTransactions) {}
+	GetRateInfoRequest( UID const& requesterID, int64_t totalReleasedTransactions, int64_t batchReleasedTransactions, int64_t commitBatchesMemBytes, int64_t commitBatchesMemBytesLimit ) : requesterID(requesterID), totalReleasedTransactions(totalReleasedTransactions), batchReleasedTransactions(batchReleasedTransactions), commitBatchesMemBytes(commitBatchesMemBytes), commitBatchesMemBytesLimit(commitBatchesMemBytesLimit) {}
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & requesterID & totalReleasedTransactions & reply;
+		ar & requesterID & totalReleasedTransactions & batchReleasedTransactions & commitBatchesMemBytes & commitBatchesMemBytesLimit & reply;
 	}
 };
 
 struct GetRateInfoReply {
 	double transactionRate;
+	double batchTransactionRate;
 	double leaseDuration;
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & transactionRate & leaseDuration;
+		ar & transactionRate & batchTransactionRate & leaseDuration;
 	}
 };
 
@@ -44,6 +44,7 @@
 struct ProxyStats {
 	CounterCollection cc;
 	Counter txnStartIn, txnStartOut, txnStartBatch;
+	Counter txnMinVersionFastStarted;
 	Counter txnSystemPriorityStartIn, txnSystemPriorityStartOut;
 	Counter txnBatchPriorityStartIn, txnBatchPriorityStartOut;
 	Counter txnDefaultPriorityStartIn, txnDefaultPriorityStartOut;
@@ -55,11 +56,22 @@ struct ProxyStats {
 	Counter conflictRanges;
 	Version lastCommitVersionAssigned;
 
+	LogHistogram commitLatency;
+	LogHistogram grvLatency;
+
+	// Per-stage breakdown of commitLatency, sampled once per commit batch
+	LogHistogram commitBatchingLatency;
+	LogHistogram commitGetVersionLatency;
+	LogHistogram commitResolutionLatency;
+	LogHistogram commitProcessingLatency;
+	LogHistogram commitLoggingLatency;
+	LogHistogram commitReplyLatency;
+
 	Future<Void> logger;
 
 	explicit ProxyStats(UID id, Version* pVersion, NotifiedVersion* pCommittedVersion, int64_t *commitBatchesMemBytesCountPtr)
 	  : cc("ProxyStats", id.toString()),
-		txnStartIn("TxnStartIn", cc), txnStartOut("TxnStartOut", cc), txnStartBatch("TxnStartBatch", cc), txnSystemPriorityStartIn("TxnSystemPriorityStartIn", cc), txnSystemPriorityStartOut("TxnSystemPriorityStartOut", cc), txnBatchPriorityStartIn("TxnBatchPriorityStartIn", cc), txnBatchPriorityStartOut("TxnBatchPriorityStartOut", cc),
+		txnStartIn("TxnStartIn", cc), txnStartOut("TxnStartOut", cc), txnStartBatch("TxnStartBatch", cc), txnMinVersionFastStarted("TxnMinVersionFastStarted", cc), txnSystemPriorityStartIn("TxnSystemPriorityStartIn", cc), txnSystemPriorityStartOut("TxnSystemPriorityStartOut", cc), txnBatchPriorityStartIn("TxnBatchPriorityStartIn", cc), txnBatchPriorityStartOut("TxnBatchPriorityStartOut", cc),
 		txnDefaultPriorityStartIn("TxnDefaultPriorityStartIn", cc), txnDefaultPriorityStartOut("TxnDefaultPriorityStartOut", cc), txnCommitIn("TxnCommitIn", cc),	txnCommitVersionAssigned("TxnCommitVersionAssigned", cc), txnCommitResolving("TxnCommitResolving", cc), txnCommitResolved("TxnCommitResolved", cc), txnCommitOut("TxnCommitOut", cc),
 		txnCommitOutSuccess("TxnCommitOutSuccess", cc), txnConflicts("TxnConflicts", cc), commitBatchIn("CommitBatchIn", cc), commitBatchOut("CommitBatchOut", cc), mutationBytes("MutationBytes", cc), mutations("Mutations", cc), conflictRanges("ConflictRanges", cc), lastCommitVersionAssigned(0)
 	{
@@ -67,6 +79,14 @@ struct ProxyStats {
 		specialCounter(cc, "Version", [pVersion](){return *pVersion; });
 		specialCounter(cc, "CommittedVersion", [pCommittedVersion](){ return pCommittedVersion->get(); });
 		specialCounter(cc, "CommitBatchesMemBytesCount", [commitBatchesMemBytesCountPtr]() { return *commitBatchesMemBytesCountPtr; });
+		histogramCounters(cc, "CommitLatency", &commitLatency);
+		histogramCounters(cc, "GRVLatency", &grvLatency);
+		histogramCounters(cc, "CommitBatchingLatency", &commitBatchingLatency);
+		histogramCounters(cc, "CommitGetVersionLatency", &commitGetVersionLatency);
+		histogramCounters(cc, "CommitResolutionLatency", &commitResolutionLatency);
+		histogramCounters(cc, "CommitProcessingLatency", &commitProcessingLatency);
+		histogramCounters(cc, "CommitLoggingLatency", &commitLoggingLatency);
+		histogramCounters(cc, "CommitReplyLatency", &commitReplyLatency);
 		logger = traceCounters("ProxyMetrics", id, SERVER_KNOBS->WORKER_LOGGING_INTERVAL, &cc, "ProxyMetrics");
 	}
 };
@@ -82,7 +102,7 @@ Future<Void> forwardValue(Promise<T> out, Future<T> in)
 
 int getBytes(Promise<Version> const& r) { return 0; }
 
-ACTOR Future<Void> getRate(UID myID, MasterInterface master, int64_t* inTransactionCount, double* outTransactionRate) {
+ACTOR Future<Void> getRate(UID myID, MasterInterface master, int64_t* inTransactionCount, int64_t* inBatchTransactionCount, int64_t* inCommitBatchesMemBytes, int64_t* inCommitBatchesMemBytesLimit, double* outTransactionRate, double* outBatchTransactionRate) {
 	state Future<Void> nextRequestTimer = Void();
 	state Future<Void> leaseTimeout = Never();
 	state Future<GetRateInfoReply> reply;
@@ -91,65 +111,26 @@ ACTOR Future<Void> getRate(UID myID, MasterInterface master, int64_t* inTransact
 	loop choose{
 		when(wait(nextRequestTimer)) {
 			nextRequestTimer = Never();
-			reply = brokenPromiseToNever(master.getRateInfo.getReply(GetRateInfoRequest(myID, *inTransactionCount)));
+			reply = brokenPromiseToNever(master.getRateInfo.getReply(GetRateInfoRequest(myID, *inTransactionCount, *inBatchTransactionCount, *inCommitBatchesMemBytes, *inCommitBatchesMemBytesLimit)));
 		}
 		when(GetRateInfoReply rep = wait(reply)) {
 			reply = Never();
 			*outTransactionRate = rep.transactionRate;
-			//TraceEvent("MasterProxyRate", myID).detail("Rate", rep.transactionRate).detail("Lease", rep.leaseDuration).detail("ReleasedTransactions", *inTransactionCount - lastTC);
+			*outBatchTransactionRate = rep.batchTransactionRate;
+			//TraceEvent("MasterProxyRate", myID).detail("Rate", rep.transactionRate).detail("BatchRate", rep.batchTransactionRate).detail("Lease", rep.leaseDuration).detail("ReleasedTransactions", *inTransactionCount - lastTC);
 			lastTC = *inTransactionCount;
 			leaseTimeout = delay(rep.leaseDuration);
 			nextRequestTimer = delayJittered(rep.leaseDuration / 2);
 		}
 		when(wait(leaseTimeout)) {
 			*outTransactionRate = 0;
-			//TraceEvent("MasterProxyRate", myID).detail("Rate", 0).detail("Lease", "Expired");
+			*outBatchTransactionRate = 0;
+			//TraceEvent("MasterProxyRate", myID).detail("Rate", 0).detail("BatchRate", 0).detail("Lease", "Expired");
 			leaseTimeout = Never();
 		}
 	}
 }
 
-ACTOR Future<Void> queueTransactionStartRequests(
-	std::priority_queue< std::pair<GetReadVersionRequest, int64_t>, std::vector< std::pair<GetReadVersionRequest, int64_t> > > *transactionQueue,
-	FutureStream<GetReadVersionRequest> readVersionRequests,
-	PromiseStream<Void> GRVTimer, double *lastGRVTime,
-	double *GRVBatchTime, FutureStream<double> replyTimes,
-	ProxyStats* stats) 
-{
-	state int64_t counter = 0;
-	loop choose{
-		when(GetReadVersionRequest req = waitNext(readVersionRequests)) {
-			if (req.debugID.present())
-				g_traceBatch.addEvent("TransactionDebug", req.debugID.get().first(), "MasterProxyServer.queueTransactionStartRequests.Before");
-
-			stats->txnStartIn += req.transactionCount;
-			if (req.priority() >= GetReadVersionRequest::PRIORITY_SYSTEM_IMMEDIATE)
-				stats->txnSystemPriorityStartIn += req.transactionCount;
-			else if (req.priority() >= GetReadVersionRequest::PRIORITY_DEFAULT)
-				stats->txnDefaultPriorityStartIn += req.transactionCount;
-			else
-				stats->txnBatchPriorityStartIn += req.transactionCount;
-
-			if (transactionQueue->empty()) {
-				if (now() - *lastGRVTime > *GRVBatchTime)
-					*lastGRVTime = now() - *GRVBatchTime;
-
-				forwardPromise(GRVTimer, delayJittered(*GRVBatchTime - (now() - *lastGRVTime), TaskProxyGRVTimer));
-			}
-
-			transactionQueue->push(std::make_pair(req, counter--));
-		}
-		// dynamic batching monitors reply latencies
-		when(double reply_latency = waitNext(replyTimes)) {
-			double target_latency = reply_latency * SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
-			*GRVBatchTime = 
-				std::max(SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_MIN, 
-					std::min(SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_MAX, 
-						target_latency * SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA + *GRVBatchTime * (1-SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA)));
-		}
-	}
-}
-
 ACTOR void discardCommit(UID id, Future<LogSystemDiskQueueAdapter::CommitMessage> fcm, Future<Void> dummyCommitState) {
 	ASSERT(!dummyCommitState.isReady());
 	LogSystemDiskQueueAdapter::CommitMessage cm = wait(fcm);
@@ -169,6 +150,7 @@ DESCR struct SingleKeyMutation {
 struct ProxyCommitData {
 	UID dbgid;
 	int64_t commitBatchesMemBytesCount;
+	int64_t commitBatchesMemBytesLimit;
 	ProxyStats stats;
 	MasterInterface master;
 	vector<ResolverInterface> resolvers;
@@ -189,7 +171,10 @@ struct ProxyCommitData {
 	bool firstProxy;
 	double lastCoalesceTime;
 	bool locked;
+	bool readyForTxnStarts;  // Set once recovery has reached ACCEPTING_COMMITS, so committedVersion is a committed version
 	double commitBatchInterval;
+	int64_t commitBatchBytesTarget;
+	double smoothedCommitLatency;
 
 	int64_t localCommitBatchesStarted;
 	NotifiedVersion latestLocalCommitBatchResolving;
@@ -202,6 +187,8 @@ struct ProxyCommitData {
 	Database cx;
 	EventMetricHandle<SingleKeyMutation> singleKeyMutationEvent;
 
+	int64_t backupMutationBytesEstimate; // arena bytes the previous batch's backup mutation lists needed
+
 	std::map<UID, Reference<StorageInfo>> storageCache;
 	std::map<Tag, Version> tag_popped;
 	Deque<std::pair<Version, Version>> txsPopVersions;
@@ -233,12 +220,88 @@ struct ProxyCommitData {
 			committedVersion(recoveryTransactionVersion), version(0), minKnownCommittedVersion(0),
 			lastVersionTime(0), commitVersionRequestNumber(1), mostRecentProcessedRequestNumber(0),
 			getConsistentReadVersion(getConsistentReadVersion), commit(commit), lastCoalesceTime(0),
-			localCommitBatchesStarted(0), locked(false), commitBatchInterval(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN),
+			localCommitBatchesStarted(0), locked(false), readyForTxnStarts(false), commitBatchInterval(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN),
+			commitBatchBytesTarget(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_MIN), smoothedCommitLatency(0),
 			firstProxy(firstProxy), cx(openDBOnServer(db, TaskDefaultEndpoint, true, true)),
-			singleKeyMutationEvent(LiteralStringRef("SingleKeyMutation")), commitBatchesMemBytesCount(0), lastTxsPop(0)
-	{}
+			singleKeyMutationEvent(LiteralStringRef("SingleKeyMutation")), commitBatchesMemBytesCount(0), commitBatchesMemBytesLimit(0), lastTxsPop(0), backupMutationBytesEstimate(0)
+	{
+		// Batch controller state, in microseconds for the latencies
+		specialCounter(stats.cc, "CommitBatchInterval", [this]() { return int64_t(this->commitBatchInterval * 1e6); });
+		specialCounter(stats.cc, "CommitBatchBytesTarget", [this]() { return this->commitBatchBytesTarget; });
+		specialCounter(stats.cc, "SmoothedCommitLatency", [this]() { return int64_t(this->smoothedCommitLatency * 1e6); });
+	}
 };
 
+ACTOR Future<Void> queueTransactionStartRequests(
+	ProxyCommitData* commitData,
+	std::priority_queue< std::pair<GetReadVersionRequest, int64_t>, std::vector< std::pair<GetReadVersionRequest, int64_t> > > *transactionQueue,
+	FutureStream<GetReadVersionRequest> readVersionRequests,
+	PromiseStream<Void> GRVTimer, double *lastGRVTime,
+	double *GRVBatchTime, FutureStream<double> replyTimes,
+	int64_t *transactionCount)
+{
+	state ProxyStats* stats = &commitData->stats;
+	state int64_t counter = 0;
+	loop choose{
+		when(GetReadVersionRequest req = waitNext(readVersionRequests)) {
+			if (req.debugID.present())
+				g_traceBatch.addEvent("TransactionDebug", req.debugID.get().first(), "MasterProxyServer.queueTransactionStartRequests.Before");
+
+			stats->txnStartIn += req.transactionCount;
+			if (req.priority() >= GetReadVersionRequest::PRIORITY_SYSTEM_IMMEDIATE)
+				stats->txnSystemPriorityStartIn += req.transactionCount;
+			else if (req.priority() >= GetReadVersionRequest::PRIORITY_DEFAULT)
+				stats->txnDefaultPriorityStartIn += req.transactionCount;
+			else
+				stats->txnBatchPriorityStartIn += req.transactionCount;
+
+			if (req.minVersion > 0 && commitData->readyForTxnStarts && commitData->committedVersion.get() >= req.minVersion) {
+				// The client only needs a committed version at least req.minVersion, and we already have one,
+				// so reply immediately from committedVersion rather than waiting out a GRV batch.  As with
+				// CAUSAL_READ_RISKY this skips confirmEpochLive, so the version returned is committed but not
+				// necessarily the latest committed version.  The transactions still count against the rate
+				// the ratekeeper has given us.
+				GetReadVersionReply reply;
+				reply.version = commitData->committedVersion.get();
+				reply.locked = commitData->locked;
+				req.reply.send(reply);
+
+				*transactionCount += req.transactionCount;
+				stats->txnMinVersionFastStarted += req.transactionCount;
+				stats->txnStartOut += req.transactionCount;
+				if (req.priority() >= GetReadVersionRequest::PRIORITY_SYSTEM_IMMEDIATE)
+					stats->txnSystemPriorityStartOut += req.transactionCount;
+				else if (req.priority() >= GetReadVersionRequest::PRIORITY_DEFAULT)
+					stats->txnDefaultPriorityStartOut += req.transactionCount;
+				else
+					stats->txnBatchPriorityStartOut += req.transactionCount;
+
+				if (req.debugID.present())
+					g_traceBatch.addEvent("TransactionDebug", req.debugID.get().first(), "MasterProxyServer.queueTransactionStartRequests.MinVersionFastPath");
+			}
+			else {
+				if (transactionQueue->empty()) {
+					if (now() - *lastGRVTime > *GRVBatchTime)
+						*lastGRVTime = now() - *GRVBatchTime;
+
+					forwardPromise(GRVTimer, delayJittered(*GRVBatchTime - (now() - *lastGRVTime), TaskProxyGRVTimer));
+				}
+
+				transactionQueue->push(std::make_pair(req, counter--));
+			}
+		}
+		// dynamic batching monitors reply latencies
+		when(double reply_latency = waitNext(replyTimes)) {
+			stats->grvLatency.addSample(reply_latency);
+			double target_latency = reply_latency * SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
+			*GRVBatchTime =
+				std::max(SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_MIN,
+					std::min(SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_MAX,
+						target_latency * SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA + *GRVBatchTime * (1-SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA)));
+		}
+	}
+}
+
 struct ResolutionRequestBuilder {
 	ProxyCommitData* self;
 	vector<ResolveTransactionBatchRequest> requests;
@@ -320,7 +383,13 @@ struct ResolutionRequestBuilder {
 	}
 };
 
-ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std::pair<std::vector<CommitTransactionRequest>, int> > out, FutureStream<CommitTransactionRequest> in, int desiredBytes, int64_t memBytesLimit) {
+struct BatchedCommitRequests {
+	std::vector<CommitTransactionRequest> trs;
+	int bytes;
+	double firstRequestTime; // when the oldest transaction in this batch arrived at the batcher
+};
+
+ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<BatchedCommitRequests> out, FutureStream<CommitTransactionRequest> in, int64_t memBytesLimit) {
 	wait(delayJittered(commitData->commitBatchInterval, TaskProxyCommitBatcher));  
 
 	state double lastBatch = 0;
@@ -329,6 +398,7 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std:
 		state Future<Void> timeout;
 		state std::vector<CommitTransactionRequest> batch;
 		state int batchBytes = 0;
+		state double batchFirstRequestTime = now();
 
 		if(SERVER_KNOBS->MAX_COMMIT_BATCH_INTERVAL <= 0) {
 			timeout = Never();
@@ -337,7 +407,7 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std:
 			timeout = delayJittered(SERVER_KNOBS->MAX_COMMIT_BATCH_INTERVAL, TaskProxyCommitBatcher);
 		}
 
-		while(!timeout.isReady() && !(batch.size() == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX || batchBytes >= desiredBytes)) {
+		while(!timeout.isReady() && !(batch.size() == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX || batchBytes >= commitData->commitBatchBytesTarget)) {
 			choose{
 				when(CommitTransactionRequest req = waitNext(in)) {
 					int bytes = getBytes(req);
@@ -356,6 +426,7 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std:
 					}
 
 					if(!batch.size()) {
+						batchFirstRequestTime = now();
 						commitData->commitBatchStartNotifications.send(Void());
 						if(now() - lastBatch > commitData->commitBatchInterval) {
 							timeout = delayJittered(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_FROM_IDLE, TaskProxyCommitBatcher);
@@ -366,8 +437,9 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std:
 					}
 
 					if((batchBytes + bytes > CLIENT_KNOBS->TRANSACTION_SIZE_LIMIT || req.firstInBatch()) && batch.size()) {
-						out.send({ batch, batchBytes });
+						out.send({ batch, batchBytes, batchFirstRequestTime });
 						lastBatch = now();
+						batchFirstRequestTime = now();
 						commitData->commitBatchStartNotifications.send(Void());
 						timeout = delayJittered(commitData->commitBatchInterval, TaskProxyCommitBatcher);
 						batch = std::vector<CommitTransactionRequest>();
@@ -381,7 +453,7 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std:
 				when(wait(timeout)) {}
 			}
 		}
-		out.send({ std::move(batch), batchBytes });
+		out.send({ std::move(batch), batchBytes, batchFirstRequestTime });
 		lastBatch = now();
 	}
 }
@@ -389,13 +461,20 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std:
 ACTOR Future<Void> commitBatch(
 	ProxyCommitData* self,
 	vector<CommitTransactionRequest> trs,
-	int currentBatchMemBytesCount)
+	int currentBatchMemBytesCount,
+	double batchFirstRequestTime)
 {
 	state int64_t localBatchNumber = ++self->localCommitBatchesStarted;
 	state LogPushData toCommit(self->logSystem);
 	state double t1 = now();
+	state double tGotVersion = 0;
+	state double tResolved = 0;
+	state double tProcessed = 0;
+	state double tLogged = 0;
+	state double batchingTime = trs.size() ? t1 - batchFirstRequestTime : 0;
 	state Optional<UID> debugID;
 	state bool forceRecovery = false;
+	state bool traceSampled = g_random->random01() < SERVER_KNOBS->COMMIT_TRACE_SAMPLE_RATE;
 
 	ASSERT(SERVER_KNOBS->MAX_READ_TRANSACTION_LIFE_VERSIONS <= SERVER_KNOBS->MAX_VERSIONS_IN_FLIGHT);  // since we are using just the former to limit the number of versions actually in flight!
 
@@ -442,6 +521,8 @@ ACTOR Future<Void> commitBatch(
 	self->stats.txnCommitVersionAssigned += trs.size();
 	self->stats.lastCommitVersionAssigned = versionReply.version;
 
+	tGotVersion = now();
+
 	state Version commitVersion = versionReply.version;
 	state Version prevVersion = versionReply.prevVersion;
 
@@ -485,6 +566,7 @@ ACTOR Future<Void> commitBatch(
 
 	/////// Phase 2: Resolution (waiting on the network; pipelined)
 	state vector<ResolveTransactionBatchReply> resolution = wait( getAll(replies) );
+	tResolved = now();
 
 	if (debugID.present())
 		g_traceBatch.addEvent("CommitDebug", debugID.get().first(), "MasterProxyServer.commitBatch.AfterResolution");
@@ -499,7 +581,7 @@ ACTOR Future<Void> commitBatch(
 	if (debugID.present())
 		g_traceBatch.addEvent("CommitDebug", debugID.get().first(), "MasterProxyServer.commitBatch.ProcessingMutations");
 
-	state Arena arena;
+	state Arena arena = ArenaPool::get();
 	state bool isMyFirstBatch = !self->version;
 	state Optional<Value> oldCoordinators = self->txnStateStore->readValue(coordinatorsKey).get();
 
@@ -637,7 +719,12 @@ ACTOR Future<Void> commitBatch(
 	state int mutationBytes = 0;
 	
 	state std::map<Key, MutationListRef> logRangeMutations;
-	state Arena logRangeMutationsArena;
+	// Reserving from the previous batch's backup mutation volume gives one right-sized block per
+	// batch instead of a fresh chain of doubling arena blocks for every batch of a sustained
+	// commit stream
+	state Arena logRangeMutationsArena( self->vecBackupKeys.size() > 1
+		? std::min<int64_t>( SERVER_KNOBS->PROXY_BACKUP_ARENA_MAX_SIZE, std::max<int64_t>( SERVER_KNOBS->PROXY_BACKUP_ARENA_MIN_SIZE, self->backupMutationBytesEstimate ) )
+		: 0 );
 	state uint32_t v = commitVersion / CLIENT_KNOBS->LOG_RANGE_BLOCK_SIZE;
 	state int transactionNum = 0;
 	state int yieldBytes = 0;
@@ -782,6 +869,14 @@ ACTOR Future<Void> commitBatch(
 		}
 	}
 
+	if (self->vecBackupKeys.size() > 1) {
+		int64_t backupBytes = 0;
+		for (auto& logRangeMutation : logRangeMutations)
+			backupBytes += logRangeMutation.second.expectedSize();
+		// Halving rather than dropping the estimate keeps the reservation stable across bursty streams
+		self->backupMutationBytesEstimate = std::max( backupBytes, self->backupMutationBytesEstimate/2 );
+	}
+
 	// Serialize and backup the mutations as a single mutation
 	if ((self->vecBackupKeys.size() > 1) && logRangeMutations.size()) {
 
@@ -892,6 +987,7 @@ ACTOR Future<Void> commitBatch(
 	if ( prevVersion && commitVersion - prevVersion < SERVER_KNOBS->MAX_VERSIONS_IN_FLIGHT/2 )
 		debug_advanceMaxCommittedVersion(UID(), commitVersion);
 
+	tProcessed = now();
 	Future<Version> loggingComplete = self->logSystem->push( prevVersion, commitVersion, self->committedVersion.get(), self->minKnownCommittedVersion, toCommit, debugID );
 
 	if (!forceRecovery) {
@@ -915,6 +1011,7 @@ ACTOR Future<Void> commitBatch(
 		throw;
 	}
 	wait(yield());
+	tLogged = now();
 
 	if( self->popRemoteTxs && msg.popTo > ( self->txsPopVersions.size() ? self->txsPopVersions.back().second : self->lastTxsPop ) ) {
 		if(self->txsPopVersions.size() >= SERVER_KNOBS->MAX_TXS_POP_VERSION_HISTORY) {
@@ -965,6 +1062,27 @@ ACTOR Future<Void> commitBatch(
 	}
 
 	++self->stats.commitBatchOut;
+	self->stats.commitLatency.addSample(now() - t1);
+	if (trs.size())
+		self->stats.commitBatchingLatency.addSample(batchingTime);
+	self->stats.commitGetVersionLatency.addSample(tGotVersion - t1);
+	self->stats.commitResolutionLatency.addSample(tResolved - tGotVersion);
+	self->stats.commitProcessingLatency.addSample(tProcessed - tResolved);
+	self->stats.commitLoggingLatency.addSample(tLogged - tProcessed);
+	self->stats.commitReplyLatency.addSample(now() - tLogged);
+	if (traceSampled || debugID.present())
+		TraceEvent("CommitBatchTiming", self->dbgid)
+			.detail("Transactions", trs.size())
+			.detail("BatchBytes", currentBatchMemBytesCount)
+			.detail("CommitVersion", commitVersion)
+			.detail("Batching", batchingTime)
+			.detail("GetVersion", tGotVersion - t1)
+			.detail("Resolution", tResolved - tGotVersion)
+			.detail("Processing", tProcessed - tResolved)
+			.detail("Logging", tLogged - tProcessed)
+			.detail("Reply", now() - tLogged)
+			.detail("Total", now() - t1)
+			.detail("DebugID", debugID.present() ? debugID.get().toString() : "");
 	self->stats.txnCommitOut += trs.size();
 	self->stats.txnConflicts += trs.size() - commitCount;
 	self->stats.txnCommitOutSuccess += commitCount;
@@ -986,15 +1104,30 @@ ACTOR Future<Void> commitBatch(
 	}
 
 	// Dynamic batching for commits
-	double target_latency = (now() - t1) * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
-	self->commitBatchInterval = 
-		std::max(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN, 
-			std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX, 
+	double elapsed = now() - t1;
+	double target_latency = elapsed * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
+	self->commitBatchInterval =
+		std::max(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
+			std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX,
 				target_latency * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA + self->commitBatchInterval * (1-SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA)));
 
+	self->smoothedCommitLatency = elapsed * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA + self->smoothedCommitLatency * (1-SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA);
+
+	// If a latency target is configured, the batch byte target also adapts: grow batches while
+	// smoothed commit latency exceeds the target so each pipeline pass carries more work, and shrink
+	// them back once the pipeline has latency to spare so small commits flush promptly
+	if(SERVER_KNOBS->COMMIT_BATCH_LATENCY_TARGET > 0) {
+		if(self->smoothedCommitLatency > SERVER_KNOBS->COMMIT_BATCH_LATENCY_TARGET)
+			self->commitBatchBytesTarget = std::min<int64_t>(self->commitBatchBytesTarget * SERVER_KNOBS->COMMIT_BATCH_BYTES_GROWTH_RATE, SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_MAX);
+		else
+			self->commitBatchBytesTarget = std::max<int64_t>(self->commitBatchBytesTarget / SERVER_KNOBS->COMMIT_BATCH_BYTES_GROWTH_RATE, SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_MIN);
+	}
+
 
 	self->commitBatchesMemBytesCount -= currentBatchMemBytesCount;
 	ASSERT_ABORT(self->commitBatchesMemBytesCount >= 0);
+
+	ArenaPool::release(std::move(arena));  // everything serialized from it has been copied or sent by now
 	return Void();
 }
 
@@ -1009,7 +1142,7 @@ ACTOR Future<GetReadVersionReply> getLiveCommittedVersion(ProxyCommitData* commi
 
 	state vector<Future<GetReadVersionReply>> proxyVersions;
 	for (auto const& p : *otherProxies)
-		proxyVersions.push_back(brokenPromiseToNever(p.getRawCommittedVersion.getReply(GetRawCommittedVersionRequest(debugID), TaskTLogConfirmRunningReply)));
+		proxyVersions.push_back(brokenPromiseToNever(p.getRawCommittedVersion.getReply(GetRawCommittedVersionRequest(debugID), TaskProxyGetConsistentReadVersion)));
 
 	if (!(flags&GetReadVersionRequest::FLAG_CAUSAL_READ_RISKY))
 	{
@@ -1062,14 +1195,17 @@ ACTOR static Future<Void> transactionStarter(
 	state double GRVBatchTime = SERVER_KNOBS->START_TRANSACTION_BATCH_INTERVAL_MIN;
 
 	state int64_t transactionCount = 0;
+	state int64_t batchTransactionCount = 0;
 	state double transactionBudget = 0;
+	state double batchTransactionBudget = 0;
 	state double transactionRate = 10;
+	state double batchTransactionRate = 0;
 	state std::priority_queue<std::pair<GetReadVersionRequest, int64_t>, std::vector<std::pair<GetReadVersionRequest, int64_t>>> transactionQueue;
 	state vector<MasterProxyInterface> otherProxies;
 
 	state PromiseStream<double> replyTimes;
-	addActor.send(getRate(proxy.id(), master, &transactionCount, &transactionRate));
-	addActor.send(queueTransactionStartRequests(&transactionQueue, proxy.getConsistentReadVersion.getFuture(), GRVTimer, &lastGRVTime, &GRVBatchTime, replyTimes.getFuture(), &commitData->stats));
+	addActor.send(getRate(proxy.id(), master, &transactionCount, &batchTransactionCount, &commitData->commitBatchesMemBytesCount, &commitData->commitBatchesMemBytesLimit, &transactionRate, &batchTransactionRate));
+	addActor.send(queueTransactionStartRequests(commitData, &transactionQueue, proxy.getConsistentReadVersion.getFuture(), GRVTimer, &lastGRVTime, &GRVBatchTime, replyTimes.getFuture(), &transactionCount));
 
 	// Get a list of the other proxies that go together with us
 	while (std::find(db->get().client.proxies.begin(), db->get().client.proxies.end(), proxy) == db->get().client.proxies.end())
@@ -1080,6 +1216,7 @@ ACTOR static Future<Void> transactionStarter(
 	}
 
 	ASSERT(db->get().recoveryState >= RecoveryState::ACCEPTING_COMMITS);  // else potentially we could return uncommitted read versions (since self->committedVersion is only a committed version if this recovery succeeds)
+	commitData->readyForTxnStarts = true;
 
 	TraceEvent("ProxyReadyForTxnStarts", proxy.id());
 
@@ -1092,6 +1229,7 @@ ACTOR static Future<Void> transactionStarter(
 
 		if(elapsed == 0) elapsed = 1e-15; // resolve a possible indeterminant multiplication with infinite transaction rate
 		double nTransactionsToStart = std::min(transactionRate * elapsed, SERVER_KNOBS->START_TRANSACTION_MAX_TRANSACTIONS_TO_START) + transactionBudget;
+		double nBatchTransactionsToStart = std::min(batchTransactionRate * elapsed, SERVER_KNOBS->START_TRANSACTION_MAX_TRANSACTIONS_TO_START) + batchTransactionBudget;
 
 		int transactionsStarted[2] = {0,0};
 		int systemTransactionsStarted[2] = {0,0};
@@ -1102,6 +1240,7 @@ ACTOR static Future<Void> transactionStarter(
 		Optional<UID> debugID;
 
 		double leftToStart = 0;
+		double batchLeftToStart = 0;
 		while (!transactionQueue.empty()) {
 			auto& req = transactionQueue.top().first;
 			int tc = req.transactionCount;
@@ -1110,6 +1249,15 @@ ACTOR static Future<Void> transactionStarter(
 			bool startNext = tc < leftToStart || req.priority() >= GetReadVersionRequest::PRIORITY_SYSTEM_IMMEDIATE || tc * g_random->random01() < leftToStart - std::max(0.0, transactionBudget);
 			if (!startNext) break;
 
+			// Batch priority transactions are also limited by the stricter batch rate, so they are shed
+			// before the cluster has to slow down default priority traffic.  The queue is ordered by
+			// priority, so everything behind a blocked batch priority request is also batch priority.
+			if (req.priority() < GetReadVersionRequest::PRIORITY_DEFAULT) {
+				batchLeftToStart = nBatchTransactionsToStart - batchPriTransactionsStarted[0] - batchPriTransactionsStarted[1];
+				bool startNextBatch = tc < batchLeftToStart || tc * g_random->random01() < batchLeftToStart - std::max(0.0, batchTransactionBudget);
+				if (!startNextBatch) break;
+			}
+
 			if (req.debugID.present()) {
 				if (!debugID.present()) debugID = g_nondeterministic_random->randomUniqueID();
 				g_traceBatch.addAttach("TransactionAttachID", req.debugID.get().first(), debugID.get().first());
@@ -1149,7 +1297,9 @@ ACTOR static Future<Void> transactionStarter(
 		}
 
 		transactionCount += transactionsStarted[0] + transactionsStarted[1];
+		batchTransactionCount += batchPriTransactionsStarted[0] + batchPriTransactionsStarted[1];
 		transactionBudget = std::max(std::min(nTransactionsToStart - transactionsStarted[0] - transactionsStarted[1], SERVER_KNOBS->START_TRANSACTION_MAX_BUDGET_SIZE), -SERVER_KNOBS->START_TRANSACTION_MAX_BUDGET_SIZE);
+		batchTransactionBudget = std::max(std::min(nBatchTransactionsToStart - batchPriTransactionsStarted[0] - batchPriTransactionsStarted[1], SERVER_KNOBS->START_TRANSACTION_MAX_BUDGET_SIZE), -SERVER_KNOBS->START_TRANSACTION_MAX_BUDGET_SIZE);
 		if (debugID.present())
 			g_traceBatch.addEvent("TransactionDebug", debugID.get().first(), "MasterProxyServer.masterProxyServerCore.Broadcast");
 		for (int i = 0; i<start.size(); i++) {
@@ -1343,7 +1493,7 @@ ACTOR Future<Void> masterProxyServerCore(
 	state ProxyCommitData commitData(proxy.id(), master, proxy.getConsistentReadVersion, recoveryTransactionVersion, proxy.commit, db, firstProxy);
 
 	state Future<Sequence> sequenceFuture = (Sequence)0;
-	state PromiseStream< std::pair<vector<CommitTransactionRequest>, int> > batchedCommits;
+	state PromiseStream< BatchedCommitRequests > batchedCommits;
 	state Future<Void> commitBatcherActor;
 	state Future<Void> lastCommitComplete = Void();
 
@@ -1380,6 +1530,7 @@ ACTOR Future<Void> masterProxyServerCore(
 	// ((SERVER_MEM_LIMIT * COMMIT_BATCHES_MEM_FRACTION_OF_TOTAL) / COMMIT_BATCHES_MEM_TO_TOTAL_MEM_SCALE_FACTOR) is only a approximate formula for limiting the memory used.
 	// COMMIT_BATCHES_MEM_TO_TOTAL_MEM_SCALE_FACTOR is an estimate based on experiments and not an accurate one.
 	state int64_t commitBatchesMemoryLimit = std::min(SERVER_KNOBS->COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT, static_cast<int64_t>((SERVER_KNOBS->SERVER_MEM_LIMIT * SERVER_KNOBS->COMMIT_BATCHES_MEM_FRACTION_OF_TOTAL) / SERVER_KNOBS->COMMIT_BATCHES_MEM_TO_TOTAL_MEM_SCALE_FACTOR));
+	commitData.commitBatchesMemBytesLimit = commitBatchesMemoryLimit;
 	TraceEvent(SevInfo, "CommitBatchesMemoryLimit").detail("BytesLimit", commitBatchesMemoryLimit);
 
 	addActor.send(monitorRemoteCommitted(&commitData, db));
@@ -1389,12 +1540,12 @@ ACTOR Future<Void> masterProxyServerCore(
 	// wait for txnStateStore recovery
 	Optional<Value> _ = wait(commitData.txnStateStore->readValue(StringRef()));
 
-	int commitBatchByteLimit = 
-		(int)std::min<double>(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_MAX, 
-			std::max<double>(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_MIN, 
+	commitData.commitBatchBytesTarget =
+		(int64_t)std::min<double>(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_MAX,
+			std::max<double>(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_MIN,
 				SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_SCALE_BASE * pow(db->get().client.proxies.size(), SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_BYTES_SCALE_POWER)));
 
-	commitBatcherActor = commitBatcher(&commitData, batchedCommits, proxy.commit.getFuture(), commitBatchByteLimit, commitBatchesMemoryLimit);
+	commitBatcherActor = commitBatcher(&commitData, batchedCommits, proxy.commit.getFuture(), commitBatchesMemoryLimit);
 	loop choose{
 		when( wait( dbInfoChange ) ) {
 			dbInfoChange = db->onChange();
@@ -1407,15 +1558,15 @@ ACTOR Future<Void> masterProxyServerCore(
 			}
 		}
 		when(wait(onError)) {}
-		when(std::pair<vector<CommitTransactionRequest>, int> batchedRequests = waitNext(batchedCommits.getFuture())) {
-			const vector<CommitTransactionRequest> &trs = batchedRequests.first;
-			int batchBytes = batchedRequests.second;
+		when(BatchedCommitRequests batchedRequests = waitNext(batchedCommits.getFuture())) {
+			const vector<CommitTransactionRequest> &trs = batchedRequests.trs;
+			int batchBytes = batchedRequests.bytes;
 			//TraceEvent("MasterProxyCTR", proxy.id()).detail("CommitTransactions", trs.size()).detail("TransactionRate", transactionRate).detail("TransactionQueue", transactionQueue.size()).detail("ReleasedTransactionCount", transactionCount);
 			if (trs.size() || (db->get().recoveryState >= RecoveryState::ACCEPTING_COMMITS && now() - lastCommit >= SERVER_KNOBS->MAX_COMMIT_BATCH_INTERVAL)) {
 				lastCommit = now();
 
 				if (trs.size() || lastCommitComplete.isReady()) {
-					lastCommitComplete = commitBatch(&commitData, trs, batchBytes);
+					lastCommitComplete = commitBatch(&commitData, trs, batchBytes, batchedRequests.firstRequestTime);
 					addActor.send(lastCommitComplete);
 				}
 			}
@@ -1431,6 +1582,18 @@ ACTOR Future<Void> masterProxyServerCore(
 		}
 		when(TxnStateRequest req = waitNext(proxy.txnState.getFuture())) {
 			state ReplyPromise<Void> reply = req.reply;
+			state Future<Void> chainAck = Void();
+			if(req.forward.size()) {
+				// Relay the batch down the proxy chain before applying it locally, so the next
+				// link's transfer overlaps with our own work
+				TxnStateRequest forwardReq;
+				forwardReq.arena = req.arena;
+				forwardReq.data = req.data;
+				forwardReq.sequence = req.sequence;
+				forwardReq.last = req.last;
+				forwardReq.forward.assign( req.forward.begin()+1, req.forward.end() );
+				chainAck = brokenPromiseToNever( req.forward[0].getReply( forwardReq ) );
+			}
 			if(req.last) maxSequence = req.sequence + 1;
 			if (!txnSequences.count(req.sequence)) {
 				txnSequences.insert(req.sequence);
@@ -1512,7 +1675,11 @@ ACTOR Future<Void> masterProxyServerCore(
 					commitData.txnStateStore->enableSnapshot();
 				}
 			}
-			reply.send(Void());
+			// Our reply means everyone downstream of us in the chain has the batch too
+			if(chainAck.isReady())
+				reply.send(Void());
+			else
+				forwardPromise( reply, chainAck );
 			wait(yield());
 		}
 	}
@@ -27,33 +27,8 @@
 #include <string.h>
 
 typedef uint64_t Word;
-static inline int commonPrefixLength(uint8_t const* ap, uint8_t const* bp, int cl) {
-	int i = 0;
-	const int wordEnd = cl - sizeof(Word) + 1;
-
-	for(; i < wordEnd; i += sizeof(Word)) {
-		register Word a = *(Word *)ap;
-		register Word b = *(Word *)bp;
-		if(a != b) {
-			return i + ctzll(a ^ b) / 8;
-		}
-		ap += sizeof(Word);
-		bp += sizeof(Word);
-	}
 
-	for (; i < cl; i++) {
-		if (*ap != *bp) {
-			return i;
-		}
-		++ap;
-		++bp;
-	}
-	return cl;
-}
-
-static int commonPrefixLength(StringRef a, StringRef b) {
-	return commonPrefixLength(a.begin(), b.begin(), std::min(a.size(), b.size()));
-}
+// commonPrefixLength() lives in flow/Arena.h now, beside StringRef's other comparison kernels.
 
 // This appears to be the fastest version
 static int lessOrEqualPowerOfTwo(int n) {
@@ -38,6 +38,7 @@ enum limitReason_t {
 	storage_server_min_free_space_ratio,  // a storage server's normal limits are being reduced by a low free space ratio
 	log_server_min_free_space,
 	log_server_min_free_space_ratio,
+	proxy_commit_memory,  // a proxy's commit batch memory is approaching its limit
 	limitReason_t_end
 };
 
@@ -53,7 +54,8 @@ const char* limitReasonName[] = {
 	"storage_server_min_free_space",
 	"storage_server_min_free_space_ratio",
 	"log_server_min_free_space",
-	"log_server_min_free_space_ratio"
+	"log_server_min_free_space_ratio",
+	"proxy_commit_memory"
 };
 static_assert(sizeof(limitReasonName) / sizeof(limitReasonName[0]) == limitReason_t_end, "limitReasonDesc table size");
 
@@ -70,6 +72,7 @@ const char* limitReasonDesc[] = {
 	"Storage server running out of space (approaching 5% limit).",
 	"Log server running out of space (approaching 100MB limit).",
 	"Log server running out of space (approaching 5% limit).",
+	"Proxy commit batch memory approaching its limit.",
 };
 
 static_assert(sizeof(limitReasonDesc) / sizeof(limitReasonDesc[0]) == limitReason_t_end, "limitReasonDesc table size");
@@ -111,25 +114,61 @@ struct TLogQueueInfo {
 	}
 };
 
+// One set of rate control targets; normal traffic is controlled against the full queue targets while
+// batch priority traffic is controlled against stricter targets, so it is shed first as queues grow
+struct RatekeeperLimits {
+	double tpsLimit;
+	Int64MetricHandle tpsLimitMetric;
+	Int64MetricHandle reasonMetric;
+
+	int64_t storageTargetBytes;
+	int64_t storageSpringBytes;
+	int64_t logTargetBytes;
+	int64_t logSpringBytes;
+
+	std::string context;
+
+	RatekeeperLimits(std::string context, int64_t storageTargetBytes, int64_t storageSpringBytes, int64_t logTargetBytes, int64_t logSpringBytes) :
+		tpsLimit(std::numeric_limits<double>::infinity()),
+		tpsLimitMetric(StringRef("Ratekeeper.TPSLimit" + context)),
+		reasonMetric(StringRef("Ratekeeper.Reason" + context)),
+		storageTargetBytes(storageTargetBytes),
+		storageSpringBytes(storageSpringBytes),
+		logTargetBytes(logTargetBytes),
+		logSpringBytes(logSpringBytes),
+		context(context)
+	{}
+};
+
+struct TransactionCounts {
+	int64_t total;
+	int64_t batch;
+	int64_t memBytes;
+	int64_t memBytesLimit;
+	double time;
+
+	TransactionCounts() : total(0), batch(0), memBytes(0), memBytesLimit(0), time(0) {}
+};
+
 struct Ratekeeper {
 	Map<UID, StorageQueueInfo> storageQueueInfo;
 	Map<UID, TLogQueueInfo> tlogQueueInfo;
-	std::map<UID, std::pair<int64_t, double> > proxy_transactionCountAndTime;
-	Smoother smoothReleasedTransactions, smoothTotalDurableBytes;
-	double TPSLimit;
+	std::map<UID, TransactionCounts> proxy_transactionCounts;
+	Smoother smoothReleasedTransactions, smoothBatchReleasedTransactions, smoothTotalDurableBytes;
 	DatabaseConfiguration configuration;
 
-	Int64MetricHandle tpsLimitMetric;
 	Int64MetricHandle actualTpsMetric;
-	Int64MetricHandle reasonMetric;
 	double lastWarning;
 	double* lastLimited;
 
-	Ratekeeper() : smoothReleasedTransactions(SERVER_KNOBS->SMOOTHING_AMOUNT), smoothTotalDurableBytes(SERVER_KNOBS->SLOW_SMOOTHING_AMOUNT), TPSLimit(std::numeric_limits<double>::infinity()),
-		tpsLimitMetric(LiteralStringRef("Ratekeeper.TPSLimit")),
+	RatekeeperLimits normalLimits;
+	RatekeeperLimits batchLimits;
+
+	Ratekeeper() : smoothReleasedTransactions(SERVER_KNOBS->SMOOTHING_AMOUNT), smoothBatchReleasedTransactions(SERVER_KNOBS->SMOOTHING_AMOUNT), smoothTotalDurableBytes(SERVER_KNOBS->SLOW_SMOOTHING_AMOUNT),
 		actualTpsMetric(LiteralStringRef("Ratekeeper.ActualTPS")),
-		reasonMetric(LiteralStringRef("Ratekeeper.Reason")),
-		lastWarning(0)
+		lastWarning(0),
+		normalLimits("", SERVER_KNOBS->TARGET_BYTES_PER_STORAGE_SERVER, SERVER_KNOBS->SPRING_BYTES_STORAGE_SERVER, SERVER_KNOBS->TARGET_BYTES_PER_TLOG, SERVER_KNOBS->SPRING_BYTES_TLOG),
+		batchLimits("Batch", SERVER_KNOBS->TARGET_BYTES_PER_STORAGE_SERVER_BATCH, SERVER_KNOBS->SPRING_BYTES_STORAGE_SERVER_BATCH, SERVER_KNOBS->TARGET_BYTES_PER_TLOG_BATCH, SERVER_KNOBS->SPRING_BYTES_TLOG_BATCH)
 	{}
 };
 
@@ -247,7 +286,7 @@ ACTOR Future<Void> trackEachStorageServer(
 	}
 }
 
-void updateRate( Ratekeeper* self ) {
+void updateRate( Ratekeeper* self, RatekeeperLimits* limits ) {
 	//double controlFactor = ;  // dt / eFoldingTime
 
 	double actualTPS = self->smoothReleasedTransactions.smoothRate();
@@ -255,7 +294,7 @@ void updateRate( Ratekeeper* self ) {
 	// SOMEDAY: Remove the max( 1.0, ... ) since the below calculations _should_ be able to recover back up from this value
 	actualTPS = std::max( std::max( 1.0, actualTPS ), self->smoothTotalDurableBytes.smoothRate() / CLIENT_KNOBS->TRANSACTION_SIZE_LIMIT );
 
-	self->TPSLimit = std::numeric_limits<double>::infinity();
+	limits->tpsLimit = std::numeric_limits<double>::infinity();
 	UID reasonID = UID();
 	limitReason_t limitReason = limitReason_t::unlimited;
 
@@ -264,6 +303,8 @@ void updateRate( Ratekeeper* self ) {
 	int64_t worstFreeSpaceStorageServer = std::numeric_limits<int64_t>::max();
 	int64_t worstStorageQueueStorageServer = 0;
 	int64_t limitingStorageQueueStorageServer = 0;
+	double limitingDurableRateStorageServer = 0;
+	double limitingInputRateStorageServer = 0;
 
 	std::multimap<double, StorageQueueInfo*> storageTPSLimitReverseIndex;
 
@@ -279,9 +320,9 @@ void updateRate( Ratekeeper* self ) {
 
 		worstFreeSpaceStorageServer = std::min(worstFreeSpaceStorageServer, (int64_t)ss.smoothFreeSpace.smoothTotal() - minFreeSpace);
 
-		int64_t springBytes = std::max<int64_t>(1, std::min(SERVER_KNOBS->SPRING_BYTES_STORAGE_SERVER, (ss.smoothFreeSpace.smoothTotal() - minFreeSpace) * 0.2));
-		int64_t targetBytes = std::max<int64_t>(1, std::min(SERVER_KNOBS->TARGET_BYTES_PER_STORAGE_SERVER, (int64_t)ss.smoothFreeSpace.smoothTotal() - minFreeSpace));
-		if (targetBytes != SERVER_KNOBS->TARGET_BYTES_PER_STORAGE_SERVER) {
+		int64_t springBytes = std::max<int64_t>(1, std::min<int64_t>(limits->storageSpringBytes, (ss.smoothFreeSpace.smoothTotal() - minFreeSpace) * 0.2));
+		int64_t targetBytes = std::max<int64_t>(1, std::min(limits->storageTargetBytes, (int64_t)ss.smoothFreeSpace.smoothTotal() - minFreeSpace));
+		if (targetBytes != limits->storageTargetBytes) {
 			if (minFreeSpace == SERVER_KNOBS->MIN_FREE_SPACE) {
 				ss.limitReason = limitReason_t::storage_server_min_free_space;
 			} else {
@@ -295,6 +336,18 @@ void updateRate( Ratekeeper* self ) {
 		double targetRateRatio = std::min(( b + springBytes ) / (double)springBytes, 2.0);
 
 		double inputRate = ss.smoothInputBytes.smoothRate();
+
+		if (SERVER_KNOBS->RATEKEEPER_MODEL_QUEUE_DRAIN && inputRate > 0) {
+			// Model the queue explicitly instead of springing on its instantaneous size: the sustainable
+			// ingest rate is the rate the server is proving durable, plus (or minus) the rate that returns
+			// the queue to its target over RATEKEEPER_QUEUE_DRAIN_TIME.  A short burst above target only
+			// costs excess/drainTime of rate rather than sliding down the spring, which damps the sawtooth.
+			// The ratio below cancels against smoothedRate in the limit calculation, yielding
+			// lim = actualTPS * allowedInputRate / inputRate.
+			double smoothedRate = std::max( ss.verySmoothDurableBytes.smoothRate(), actualTPS / SERVER_KNOBS->MAX_TRANSACTIONS_PER_BYTE );
+			double allowedInputRate = std::max( smoothedRate + (targetBytes - storageQueue) / SERVER_KNOBS->RATEKEEPER_QUEUE_DRAIN_TIME, smoothedRate * 0.5 );  // never throttle below half the durable rate, matching the spring's 2.0 cap
+			targetRateRatio = smoothedRate / allowedInputRate;
+		}
 		//inputRate = std::max( inputRate, actualTPS / SERVER_KNOBS->MAX_TRANSACTIONS_PER_BYTE );
 
 		/*if( g_random->random01() < 0.1 ) {
@@ -334,15 +387,15 @@ void updateRate( Ratekeeper* self ) {
 
 		storageTPSLimitReverseIndex.insert(std::make_pair(limitTPS, &ss));
 
-		if(limitTPS < self->TPSLimit && (ss.limitReason == limitReason_t::storage_server_min_free_space || ss.limitReason == limitReason_t::storage_server_min_free_space_ratio)) {
+		if(limitTPS < limits->tpsLimit && (ss.limitReason == limitReason_t::storage_server_min_free_space || ss.limitReason == limitReason_t::storage_server_min_free_space_ratio)) {
 			reasonID = ss.id;
-			self->TPSLimit = limitTPS;
+			limits->tpsLimit = limitTPS;
 			limitReason = ss.limitReason;
 		}
 	}
 
 	std::set<Optional<Standalone<StringRef>>> ignoredMachines;
-	for(auto ss = storageTPSLimitReverseIndex.begin(); ss != storageTPSLimitReverseIndex.end() && ss->first < self->TPSLimit; ++ss) {
+	for(auto ss = storageTPSLimitReverseIndex.begin(); ss != storageTPSLimitReverseIndex.end() && ss->first < limits->tpsLimit; ++ss) {
 		if(ignoredMachines.size() < std::min(self->configuration.storageTeamSize - 1, SERVER_KNOBS->MAX_MACHINES_FALLING_BEHIND)) {
 			ignoredMachines.insert(ss->second->locality.zoneId());
 			continue;
@@ -352,7 +405,9 @@ void updateRate( Ratekeeper* self ) {
 		}
 
 		limitingStorageQueueStorageServer = ss->second->lastReply.bytesInput - ss->second->smoothDurableBytes.smoothTotal();
-		self->TPSLimit = ss->first;
+		limitingDurableRateStorageServer = ss->second->verySmoothDurableBytes.smoothRate();
+		limitingInputRateStorageServer = ss->second->smoothInputBytes.smoothRate();
+		limits->tpsLimit = ss->first;
 		limitReason = storageTPSLimitReverseIndex.begin()->second->limitReason;
 		reasonID = storageTPSLimitReverseIndex.begin()->second->id; // Although we aren't controlling based on the worst SS, we still report it as the limiting process
 
@@ -405,9 +460,9 @@ void updateRate( Ratekeeper* self ) {
 
 		worstFreeSpaceTLog = std::min(worstFreeSpaceTLog, (int64_t)tl.smoothFreeSpace.smoothTotal() - minFreeSpace);
 
-		int64_t springBytes = std::max<int64_t>(1, std::min(SERVER_KNOBS->SPRING_BYTES_TLOG, (tl.smoothFreeSpace.smoothTotal() - minFreeSpace) * 0.2));
-		int64_t targetBytes = std::max<int64_t>(1, std::min(SERVER_KNOBS->TARGET_BYTES_PER_TLOG, (int64_t)tl.smoothFreeSpace.smoothTotal() - minFreeSpace));
-		if (targetBytes != SERVER_KNOBS->TARGET_BYTES_PER_TLOG) {
+		int64_t springBytes = std::max<int64_t>(1, std::min<int64_t>(limits->logSpringBytes, (tl.smoothFreeSpace.smoothTotal() - minFreeSpace) * 0.2));
+		int64_t targetBytes = std::max<int64_t>(1, std::min(limits->logTargetBytes, (int64_t)tl.smoothFreeSpace.smoothTotal() - minFreeSpace));
+		if (targetBytes != limits->logTargetBytes) {
 			if (minFreeSpace == SERVER_KNOBS->MIN_FREE_SPACE) {
 				tlogLimitReason = limitReason_t::log_server_min_free_space;
 			} else {
@@ -426,26 +481,33 @@ void updateRate( Ratekeeper* self ) {
 			}
 			reasonID = tl.id;
 			limitReason = limitReason_t::log_server_min_free_space;
-			self->TPSLimit = 0.0;
+			limits->tpsLimit = 0.0;
 		}
 
 		double targetRateRatio = std::min( ( b + springBytes ) / (double)springBytes, 2.0 );
 
+		double inputRate = tl.smoothInputBytes.smoothRate();
+
+		if (SERVER_KNOBS->RATEKEEPER_MODEL_QUEUE_DRAIN && inputRate > 0) {
+			// Same queue-drain model as the storage servers above
+			double smoothedRate = std::max( tl.verySmoothDurableBytes.smoothRate(), actualTPS / SERVER_KNOBS->MAX_TRANSACTIONS_PER_BYTE );
+			double allowedInputRate = std::max( smoothedRate + (targetBytes - queue) / SERVER_KNOBS->RATEKEEPER_QUEUE_DRAIN_TIME, smoothedRate * 0.5 );
+			targetRateRatio = smoothedRate / allowedInputRate;
+		}
+
 		if (writeToReadLatencyLimit > targetRateRatio){
 			targetRateRatio = writeToReadLatencyLimit;
 			tlogLimitReason = limitReason_t::storage_server_readable_behind;
 		}
 
-		double inputRate = tl.smoothInputBytes.smoothRate();
-
 		if (targetRateRatio > 0) {
 			double smoothedRate = std::max( tl.verySmoothDurableBytes.smoothRate(), actualTPS / SERVER_KNOBS->MAX_TRANSACTIONS_PER_BYTE );
 			double x = smoothedRate / (inputRate * targetRateRatio);
 			if (targetRateRatio < .75)  //< FIXME: KNOB for 2.0
 				x = std::max(x, 0.95);
 			double lim = actualTPS * x;
-			if (lim < self->TPSLimit){
-				self->TPSLimit = lim;
+			if (lim < limits->tpsLimit){
+				limits->tpsLimit = lim;
 				reasonID = tl.id;
 				limitReason = tlogLimitReason;
 			}
@@ -454,18 +516,39 @@ void updateRate( Ratekeeper* self ) {
 			// Don't let any tlogs use up its target bytes faster than its MVCC window!
 			double x = ((targetBytes - springBytes) / ((((double)SERVER_KNOBS->MAX_READ_TRANSACTION_LIFE_VERSIONS)/SERVER_KNOBS->VERSIONS_PER_SECOND) + 2.0)) / inputRate;
 			double lim = actualTPS * x;
-			if (lim < self->TPSLimit){
-				self->TPSLimit = lim;
+			if (lim < limits->tpsLimit){
+				limits->tpsLimit = lim;
 				reasonID = tl.id;
 				limitReason = limitReason_t::log_server_mvcc_write_bandwidth;
 			}
 		}
 	}
 
-	self->TPSLimit = std::max(self->TPSLimit, 0.0);
+	// Shed load before a proxy's commit batch memory reaches its hard limit (at which point it rejects
+	// commits outright): above the start fraction, ramp the rate down linearly so it reaches zero as the
+	// fullest proxy reaches its limit
+	double worstProxyCommitMemoryRatio = 0;
+	UID worstProxyCommitMemoryID;
+	for(auto const& p : self->proxy_transactionCounts) {
+		if (p.second.memBytesLimit > 0 && p.second.memBytes / (double)p.second.memBytesLimit > worstProxyCommitMemoryRatio) {
+			worstProxyCommitMemoryRatio = p.second.memBytes / (double)p.second.memBytesLimit;
+			worstProxyCommitMemoryID = p.first;
+		}
+	}
+	if (worstProxyCommitMemoryRatio > SERVER_KNOBS->COMMIT_BATCHES_MEM_THROTTLE_FRACTION) {
+		double x = std::max( 0.0, (1.0 - worstProxyCommitMemoryRatio) / (1.0 - SERVER_KNOBS->COMMIT_BATCHES_MEM_THROTTLE_FRACTION) );
+		double lim = actualTPS * x;
+		if (lim < limits->tpsLimit) {
+			limits->tpsLimit = lim;
+			reasonID = worstProxyCommitMemoryID;
+			limitReason = limitReason_t::proxy_commit_memory;
+		}
+	}
+
+	limits->tpsLimit = std::max(limits->tpsLimit, 0.0);
 
 	if(g_network->isSimulated() && g_simulator.speedUpSimulation) {
-		self->TPSLimit = std::max(self->TPSLimit, 100.0);
+		limits->tpsLimit = std::max(limits->tpsLimit, 100.0);
 	}
 
 	int64_t totalDiskUsageBytes = 0;
@@ -476,32 +559,34 @@ void updateRate( Ratekeeper* self ) {
 		if (s.value.valid)
 			totalDiskUsageBytes += s.value.lastReply.storageBytes.used;
 
-	self->tpsLimitMetric = std::min(self->TPSLimit, 1e6);
-	self->reasonMetric = limitReason;
-
-	if( self->smoothReleasedTransactions.smoothRate() > SERVER_KNOBS->LAST_LIMITED_RATIO * self->TPSLimit ) {
-		(*self->lastLimited) = now();
-	}
+	limits->tpsLimitMetric = std::min(limits->tpsLimit, 1e6);
+	limits->reasonMetric = limitReason;
 
 	if (g_random->random01() < 0.1){
-		TraceEvent("RkUpdate")
-			.detail("TPSLimit", self->TPSLimit)
+		std::string name = "RkUpdate" + limits->context;
+		TraceEvent(name.c_str())
+			.detail("TPSLimit", limits->tpsLimit)
 			.detail("Reason", limitReason)
 			.detail("ReasonServerID", reasonID)
 			.detail("ReleasedTPS", self->smoothReleasedTransactions.smoothRate())
+			.detail("ReleasedBatchTPS", self->smoothBatchReleasedTransactions.smoothRate())
 			.detail("TPSBasis", actualTPS)
 			.detail("StorageServers", sscount)
-			.detail("Proxies", self->proxy_transactionCountAndTime.size())
+			.detail("Proxies", self->proxy_transactionCounts.size())
 			.detail("TLogs", tlcount)
 			.detail("WorstFreeSpaceStorageServer", worstFreeSpaceStorageServer)
 			.detail("WorstFreeSpaceTLog", worstFreeSpaceTLog)
 			.detail("WorstStorageServerQueue", worstStorageQueueStorageServer)
 			.detail("LimitingStorageServerQueue", limitingStorageQueueStorageServer)
+			.detail("LimitingStorageServerDurableRate", limitingDurableRateStorageServer)
+			.detail("LimitingStorageServerInputRate", limitingInputRateStorageServer)
+			.detail("ModelQueueDrain", SERVER_KNOBS->RATEKEEPER_MODEL_QUEUE_DRAIN)
 			.detail("WorstTLogQueue", worstStorageQueueTLog)
+			.detail("WorstProxyCommitMemoryRatio", worstProxyCommitMemoryRatio)
 			.detail("TotalDiskUsageBytes", totalDiskUsageBytes)
 			.detail("WorstStorageServerVersionLag", worstVersionLag)
 			.detail("LimitingStorageServerVersionLag", limitingVersionLag)
-			.trackLatest("RkUpdate");
+			.trackLatest(name.c_str());
 	}
 }
 
@@ -536,11 +621,17 @@ ACTOR Future<Void> rateKeeper(
 		choose {
 			when (wait( track )) { break; }
 			when (wait( timeout )) {
-				updateRate( &self );
+				updateRate( &self, &self.normalLimits );
+				updateRate( &self, &self.batchLimits );
+
+				if( self.smoothReleasedTransactions.smoothRate() > SERVER_KNOBS->LAST_LIMITED_RATIO * self.normalLimits.tpsLimit ) {
+					(*self.lastLimited) = now();
+				}
+
 				double tooOld = now() - 1.0;
-				for(auto p=self.proxy_transactionCountAndTime.begin(); p!=self.proxy_transactionCountAndTime.end(); ) {
-					if (p->second.second < tooOld)
-						p = self.proxy_transactionCountAndTime.erase(p);
+				for(auto p=self.proxy_transactionCounts.begin(); p!=self.proxy_transactionCounts.end(); ) {
+					if (p->second.time < tooOld)
+						p = self.proxy_transactionCounts.erase(p);
 					else
 						++p;
 				}
@@ -549,15 +640,21 @@ ACTOR Future<Void> rateKeeper(
 			when (GetRateInfoRequest req = waitNext(getRateInfo)) {
 				GetRateInfoReply reply;
 
-				auto& p = self.proxy_transactionCountAndTime[ req.requesterID ];
-				//TraceEvent("RKMPU", req.requesterID).detail("TRT", req.totalReleasedTransactions).detail("Last", p.first).detail("Delta", req.totalReleasedTransactions - p.first);
-				if (p.first > 0)
-					self.smoothReleasedTransactions.addDelta( req.totalReleasedTransactions - p.first );
-
-				p.first = req.totalReleasedTransactions;
-				p.second = now();
-
-				reply.transactionRate = self.TPSLimit / self.proxy_transactionCountAndTime.size();
+				auto& p = self.proxy_transactionCounts[ req.requesterID ];
+				//TraceEvent("RKMPU", req.requesterID).detail("TRT", req.totalReleasedTransactions).detail("Last", p.total).detail("Delta", req.totalReleasedTransactions - p.total);
+				if (p.total > 0)
+					self.smoothReleasedTransactions.addDelta( req.totalReleasedTransactions - p.total );
+				if (p.batch > 0)
+					self.smoothBatchReleasedTransactions.addDelta( req.batchReleasedTransactions - p.batch );
+
+				p.total = req.totalReleasedTransactions;
+				p.batch = req.batchReleasedTransactions;
+				p.memBytes = req.commitBatchesMemBytes;
+				p.memBytesLimit = req.commitBatchesMemBytesLimit;
+				p.time = now();
+
+				reply.transactionRate = self.normalLimits.tpsLimit / self.proxy_transactionCounts.size();
+				reply.batchTransactionRate = self.batchLimits.tpsLimit / self.proxy_transactionCounts.size();
 				reply.leaseDuration = SERVER_KNOBS->METRIC_UPDATE_RATE;
 				req.reply.send( reply );
 			}
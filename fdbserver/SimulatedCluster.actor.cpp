@@ -741,9 +741,15 @@ void SimulationConfig::generateNormalConfig(int minimumReplication, int minimumR
 	if (g_random->random01() < 0.25) db.desiredTLogCount = g_random->randomInt(1,7);
 	if (g_random->random01() < 0.25) db.masterProxyCount = g_random->randomInt(1,7);
 	if (g_random->random01() < 0.25) db.resolverCount = g_random->randomInt(1,7);
-	if (g_random->random01() < 0.5) {
+	double storageEngine = g_random->random01();
+	if (storageEngine < 0.1) {
+		TEST( true );  // Simulated cluster using redwood storage engine
+		set_config("ssd-redwood-experimental");
+	} else if (storageEngine < 0.5) {
+		TEST( true );  // Simulated cluster using ssd storage engine
 		set_config("ssd");
 	} else {
+		TEST( true );  // Simulated cluster using memory storage engine
 		set_config("memory");
 	}
 	if(simple) {
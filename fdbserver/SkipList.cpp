@@ -39,8 +39,6 @@
 #include "fdbclient/SystemData.h"
 #include "fdbserver/Knobs.h"
 
-#define PARALLEL_THREAD_COUNT 0	// FIXME: When >1, program execution (e.g. random numbers) is/was nondeterministic.  Why?
-
 using std::min;
 using std::max;
 using std::make_pair;
@@ -224,60 +222,67 @@ struct SortTask {
 	SortTask(int begin, int size, int character) : begin(begin), size(size), character(character) {}
 };
 
-void sortPoints(vector<KeyInfo>& points){
-	vector<SortTask> tasks;
-	vector<KeyInfo> newPoints;
-	vector<int> counts;
+// Performs one radix pass over the given range of points, pushing any runs that still need further
+// sorting onto `tasks`.  newPoints and counts are scratch space reused across calls.
+static void doSortTask(vector<KeyInfo>& points, const SortTask& st, vector<SortTask>& tasks, vector<KeyInfo>& newPoints, vector<int>& counts){
+	if (st.size < 10){
+		//smallSort(points, st.begin, st.size);
+		std::sort(points.begin() + st.begin, points.begin() + st.begin + st.size );
+		return;
+	}
 
-	tasks.push_back( SortTask(0, points.size(), 0) );
+	newPoints.resize(st.size);
+	counts.assign(256+5, 0);
 
-	while (tasks.size()){
-		SortTask st = tasks.back();
-		tasks.pop_back();
+	// get counts
+	int c;
+	bool allDone = true;
+	for (int i=st.begin; i<st.begin+st.size; i++){
+		allDone &= getCharacter(points[i], st.character, c);
+		counts[c]++;
+	}
+	if (allDone)
+		return;
 
-		if (st.size < 10){
-			//smallSort(points, st.begin, st.size);
-			std::sort(points.begin() + st.begin, points.begin() + st.begin + st.size );
-			continue;
-		}
+	// calculate offsets from counts and build next level of tasks
+	int total=0;
+	for(int i=0;i<counts.size();i++){
+		int temp = counts[i];
+		if (temp > 1)
+			tasks.push_back(SortTask(st.begin+total, temp, st.character+1));
+		counts[i] = total;
+		total += temp;
+	}
 
-		newPoints.resize(st.size);
-		counts.assign(256+5, 0);
+	// put in their places
+	for (int i=st.begin; i<st.begin+st.size; i++){
+		getCharacter(points[i], st.character, c);
+		newPoints[counts[c]++] = points[i];
+	}
 
-		// get counts
-		int c;
-		bool allDone = true;
-		for (int i=st.begin; i<st.begin+st.size; i++){
-			allDone &= getCharacter(points[i], st.character, c);
-			counts[c]++;
-		}
-		if (allDone)
-			continue;
-
-		// calculate offsets from counts and build next level of tasks
-		int total=0;
-		for(int i=0;i<counts.size();i++){
-			int temp = counts[i];
-			if (temp > 1)
-				tasks.push_back(SortTask(st.begin+total, temp, st.character+1));
-			counts[i] = total;
-			total += temp;
-		}
+	//copy back into original points array
+	for (int i=0;i<st.size;i++)
+		points[st.begin+i] = newPoints[i];
+}
 
-		// put in their places
-		for (int i=st.begin; i<st.begin+st.size; i++){
-			getCharacter(points[i], st.character, c);
-			newPoints[counts[c]++] = points[i];
-		}
+static void runSortTasks(vector<KeyInfo>& points, vector<SortTask>& tasks){
+	vector<KeyInfo> newPoints;
+	vector<int> counts;
 
-		//copy back into original points array
-		for (int i=0;i<st.size;i++)
-			points[st.begin+i] = newPoints[i];
+	while (tasks.size()){
+		SortTask st = tasks.back();
+		tasks.pop_back();
+		doSortTask(points, st, tasks, newPoints, counts);
 	}
 
 	//cout << endl << "Radix sort done" << endl;
 }
 
+void sortPoints(vector<KeyInfo>& points){
+	vector<SortTask> tasks( 1, SortTask(0, points.size(), 0) );
+	runSortTasks(points, tasks);
+}
+
 class SkipList : NonCopyable
 {
 private:
@@ -880,30 +885,44 @@ PAction action( F && f ) {
 	return new FAction( std::move(f) );
 };
 
-void workerThread( PAction* nextAction, Event* nextActionReady, int index, Event* whenFinished ) {
-	ASSERT(false);
-	/*
-	inThread<Void>( [nextAction,nextActionReady,index,whenFinished]()->Void {
-		g_seed = index*123; fastrand();
-		setAffinity( index );
-		while (true) {
-			try {
-				nextActionReady->block();   // auto-reset
-				Action* action = *nextAction;
-				*nextAction = 0;
-				if (!action) break;
-
-				(*action)();
-			} catch (Error& e) {
-				fprintf(stderr, "Error in worker thread: %s\n", e.what());
-			} catch (...) {
-				fprintf(stderr, "Error in worker thread: %s\n", unknown_error().what());
-			}
+struct WorkerThreadArgs {
+	PAction* nextAction;
+	Event* nextActionReady;
+	int index;
+	Event* whenFinished;
+	WorkerThreadArgs( PAction* nextAction, Event* nextActionReady, int index, Event* whenFinished )
+		: nextAction(nextAction), nextActionReady(nextActionReady), index(index), whenFinished(whenFinished) {}
+};
+
+THREAD_FUNC workerThreadMain( void* arg ) {
+	WorkerThreadArgs args = *(WorkerThreadArgs*)arg;
+	delete (WorkerThreadArgs*)arg;
+
+	// Each worker draws skip list levels from its own thread-local random stream, seeded only by the
+	// worker index.  Since work is also partitioned by index, the data structures produced by the
+	// parallel path do not depend on thread scheduling.
+	g_seed = (args.index+1)*123;
+
+	while (true) {
+		try {
+			args.nextActionReady->block();   // auto-reset
+			Action* action = *args.nextAction;
+			*args.nextAction = 0;
+			if (!action) break;
+
+			(*action)();
+		} catch (Error& e) {
+			fprintf(stderr, "Error in worker thread: %s\n", e.what());
+		} catch (...) {
+			fprintf(stderr, "Error in worker thread: %s\n", unknown_error().what());
 		}
-		//cout << "Worker thread finished" << endl;
-		whenFinished->set();
-		return Void();
-	});*/
+	}
+	args.whenFinished->set();
+	THREAD_RETURN;
+}
+
+void workerThread( PAction* nextAction, Event* nextActionReady, int index, Event* whenFinished ) {
+	startThread( workerThreadMain, new WorkerThreadArgs( nextAction, nextActionReady, index, whenFinished ) );
 }
 
 StringRef setK( Arena& arena, int i ) {
@@ -924,16 +943,20 @@ StringRef setK( Arena& arena, int i ) {
 #include "fdbserver/ConflictSet.h"
 
 struct ConflictSet {
-	ConflictSet() : oldestVersion(0) {
-		static_assert(PARALLEL_THREAD_COUNT == 0, "workerThread() not implemented");
-		static_assert(PARALLEL_THREAD_COUNT == 0 || FASTALLOC_THREAD_SAFE, "Thread safe fast allocator required for multithreaded conflict set");
-		for (int i = 0; i < PARALLEL_THREAD_COUNT; i++) {
+	ConflictSet() : oldestVersion(0), gcShard(0) {
+		shards.push_back( SkipList() );
+		removalKeys.resize(1);
+		static_assert(FASTALLOC_THREAD_SAFE, "Thread safe fast allocator required for multithreaded conflict set");
+		// The workers are real OS threads, which the simulator cannot schedule deterministically, so
+		// the parallel path is only used in real deployments
+		int threadCount = (g_network && g_network->isSimulated()) ? 0 : SERVER_KNOBS->CONFLICT_SET_PARALLEL_THREADS;
+		for (int i = 0; i < threadCount; i++) {
 			worker_nextAction.push_back( NULL );
 			worker_ready.push_back( new Event );
 			worker_finished.push_back( new Event );
 		}
 		for(int t=0; t<worker_nextAction.size(); t++)
-			workerThread( &worker_nextAction[t], worker_ready[t], (t)*2, worker_finished[t] );
+			workerThread( &worker_nextAction[t], worker_ready[t], t, worker_finished[t] );
 	}
 	~ConflictSet() {
 		for(int i=0; i<worker_nextAction.size(); i++) {
@@ -945,17 +968,37 @@ struct ConflictSet {
 			worker_finished[i]->block();
 	}
 
-	SkipList versionHistory;
-	Key removalKey;
+	// The version history is sharded by key range once a large enough batch has been seen to
+	// sample boundaries from: shards[i] covers [shardBoundaries[i-1], shardBoundaries[i]), with
+	// the first and last shards open ended.  A batch only touches the shards its ranges
+	// intersect, and oldest-version trimming visits one shard per batch, so neither cost is
+	// concentrated in a single walk of one structure.
+	vector<SkipList> shards;
+	vector<Key> shardBoundaries;
+	vector<Key> removalKeys;     // per shard, the key at which incremental trimming resumes
+	int gcShard;                 // the next shard removeBefore will visit
 	Version oldestVersion;
 	vector<PAction> worker_nextAction;
 	vector<Event*> worker_ready;
 	vector<Event*> worker_finished;
+
+	// The index of the shard whose key range contains key
+	int shardFor( StringRef key ) {
+		int s = 0;
+		while (s < shardBoundaries.size() && compare( shardBoundaries[s], key ) <= 0)
+			s++;
+		return s;
+	}
 };
 
 ConflictSet* newConflictSet() { return new ConflictSet; }
 void clearConflictSet( ConflictSet* cs, Version v ) {
-	SkipList(v).swap( cs->versionHistory );
+	cs->shards.clear();
+	cs->shards.push_back( SkipList(v) );
+	cs->shardBoundaries.clear();
+	cs->removalKeys.clear();
+	cs->removalKeys.resize(1);
+	cs->gcShard = 0;
 }
 void destroyConflictSet(ConflictSet* cs) {
 	delete cs;
@@ -1162,7 +1205,10 @@ void ConflictBatch::GetTooOldTransactions(vector<int>& tooOldTransactions) {
 
 void ConflictBatch::detectConflicts(Version now, Version newOldestVersion, vector<int>& nonConflicting, vector<int>* tooOldTransactions) {
 	double t = timer();
-	sortPoints( points );
+	if (cs->worker_nextAction.size())
+		sortPointsParallel();
+	else
+		sortPoints( points );
 	//std::sort( combinedReadConflictRanges.begin(), combinedReadConflictRanges.end() );
 	g_sort += timer()-t;
 
@@ -1196,39 +1242,150 @@ void ConflictBatch::detectConflicts(Version now, Version newOldestVersion, vecto
 	delete[] transactionConflictStatus;
 
 	t = timer();
+	if (cs->shards.size() == 1 && SERVER_KNOBS->CONFLICT_SET_SHARDS > 1 &&
+			combinedWriteConflictRanges.size() >= SERVER_KNOBS->CONFLICT_SET_SHARD_SAMPLE_RANGES)
+		shardConflictSet();
 	if (newOldestVersion > cs->oldestVersion) {
 		cs->oldestVersion = newOldestVersion;
-		SkipList::Finger finger; 
+		// One shard is trimmed per batch, round robin, so the incremental removeBefore work is
+		// spread across batches and never walks more than one shard's structure
+		int s = cs->gcShard;
+		cs->gcShard = (cs->gcShard+1) % cs->shards.size();
+		SkipList::Finger finger;
 		int temp;
-		cs->versionHistory.find( &cs->removalKey, &finger, &temp, 1 );
-		cs->versionHistory.removeBefore( cs->oldestVersion, finger, combinedWriteConflictRanges.size()*3 + 10 );
-		cs->removalKey = finger.getValue();
+		cs->shards[s].find( &cs->removalKeys[s], &finger, &temp, 1 );
+		cs->shards[s].removeBefore( cs->oldestVersion, finger, combinedWriteConflictRanges.size()*3 + 10 );
+		cs->removalKeys[s] = finger.getValue();
 	}
 	g_removeBefore += timer()-t;
 }
 
+// Samples shard boundaries from this batch's combined write conflict ranges and splits the single
+// version history at them.  The shards then remain independent for the life of the conflict set:
+// SkipList::split() carries the preceding entry's version onto each new shard's header, so every
+// shard answers queries for its own key range exactly as the combined structure would have.
+void ConflictBatch::shardConflictSet() {
+	vector<Key> boundaries;
+	for(int s=1; s<SERVER_KNOBS->CONFLICT_SET_SHARDS; s++) {
+		StringRef b = combinedWriteConflictRanges[ s*combinedWriteConflictRanges.size()/SERVER_KNOBS->CONFLICT_SET_SHARDS ].first;
+		if (!boundaries.size() || compare( boundaries.back(), b ) < 0)
+			boundaries.push_back( Key(b) );  // deep copy: the batch's memory does not outlive the batch
+	}
+	if (!boundaries.size())
+		return;
+	TEST(true); // Conflict set sharded by key range
+
+	vector<StringRef> splits( boundaries.begin(), boundaries.end() );
+	vector<SkipList> parts;
+	for(int i=0; i<boundaries.size()+1; i++)
+		parts.push_back( SkipList() );
+	cs->shards[0].partition( &splits[0], splits.size(), &parts[0] );
+	cs->shards = std::move(parts);
+	cs->shardBoundaries = std::move(boundaries);
+	cs->removalKeys.clear();
+	cs->removalKeys.resize( cs->shards.size() );
+	cs->gcShard = 0;
+}
+
+void ConflictBatch::sortPointsParallel() {
+	int threads = cs->worker_nextAction.size();
+
+	// A few breadth-first radix passes on this thread split the points into enough disjoint runs to
+	// spread across the workers
+	vector<SortTask> tasks( 1, SortTask(0, points.size(), 0) );
+	vector<KeyInfo> newPoints;
+	vector<int> counts;
+	int nextTask = 0;   // tasks[0..nextTask) have been processed; their unfinished runs follow them
+	while (nextTask < tasks.size() && tasks.size() - nextTask < threads*4) {
+		SortTask st = tasks[nextTask];  // doSortTask may grow tasks, invalidating references into it
+		doSortTask(points, st, tasks, newPoints, counts);
+		nextTask++;
+	}
+
+	// Each worker sorts a deterministic share of the runs, balanced by total run length, so the
+	// result does not depend on thread scheduling.  The runs are disjoint subranges of points.
+	vector<vector<SortTask>> threadTasks(threads);
+	vector<int64_t> threadSizes(threads, 0);
+	for(int i=nextTask; i<tasks.size(); i++) {
+		int best = 0;
+		for(int t=1; t<threads; t++)
+			if (threadSizes[t] < threadSizes[best])
+				best = t;
+		threadTasks[best].push_back(tasks[i]);
+		threadSizes[best] += tasks[i].size;
+	}
+
+	Event* done = new Event[ threads ];
+	for(int t=0; t<threads; t++) {
+		cs->worker_nextAction[t] = action( [&,t] {
+			runSortTasks( points, threadTasks[t] );
+			done[t].set();
+		});
+		cs->worker_ready[t]->set();
+	}
+	for(int i=0; i<threads; i++)
+		done[i].block();
+	delete[] done;
+}
+
 void ConflictBatch::checkReadConflictRanges() {
-	if (!combinedReadConflictRanges.size()) 
+	if (!combinedReadConflictRanges.size())
+		return;
+
+	int threads = cs->worker_nextAction.size();
+
+	if (cs->shards.size() > 1) {
+		// Split the sorted ranges into per-shard runs, clipping ranges that straddle a boundary,
+		// so each shard is checked independently and only the shards the batch reads are touched
+		vector<vector<ReadConflictRange>> shardRanges( cs->shards.size() );
+		for(auto& r : combinedReadConflictRanges) {
+			int s = cs->shardFor( r.begin );
+			StringRef begin = r.begin;
+			while (s < cs->shardBoundaries.size() && compare( cs->shardBoundaries[s], r.end ) < 0) {
+				shardRanges[s].push_back( ReadConflictRange( begin, cs->shardBoundaries[s], r.version, r.transaction ) );
+				begin = cs->shardBoundaries[s];
+				s++;
+			}
+			shardRanges[s].push_back( ReadConflictRange( begin, r.end, r.version, r.transaction ) );
+		}
+		if (threads) {
+			Event* done = new Event[ threads ];
+			for(int t=0; t<threads; t++) {
+				cs->worker_nextAction[t] = action( [&,t] {
+					for(int s=t; s<shardRanges.size(); s+=threads)
+						if (shardRanges[s].size())
+							cs->shards[s].detectConflicts( &shardRanges[s][0], shardRanges[s].size(), transactionConflictStatus );
+					done[t].set();
+				});
+				cs->worker_ready[t]->set();
+			}
+			for(int i=0; i<threads; i++)
+				done[i].block();
+			delete[] done;
+		} else {
+			for(int s=0; s<shardRanges.size(); s++)
+				if (shardRanges[s].size())
+					cs->shards[s].detectConflicts( &shardRanges[s][0], shardRanges[s].size(), transactionConflictStatus );
+		}
 		return;
+	}
 
-	if (PARALLEL_THREAD_COUNT) {
-		Event done[PARALLEL_THREAD_COUNT?PARALLEL_THREAD_COUNT:1];
-		for(int t=0; t<PARALLEL_THREAD_COUNT; t++) {
+	if (threads) {
+		Event* done = new Event[ threads ];
+		for(int t=0; t<threads; t++) {
 			cs->worker_nextAction[t] = action( [&,t] {
-#pragma GCC diagnostic push
-DISABLE_ZERO_DIVISION_FLAG
-				auto begin = &combinedReadConflictRanges[0] + t*combinedReadConflictRanges.size()/PARALLEL_THREAD_COUNT;
-				auto end = &combinedReadConflictRanges[0] + (t+1)*combinedReadConflictRanges.size()/PARALLEL_THREAD_COUNT;
-#pragma GCC diagnostic pop
-				cs->versionHistory.detectConflicts( begin, end-begin, transactionConflictStatus );
+				auto begin = &combinedReadConflictRanges[0] + t*combinedReadConflictRanges.size()/threads;
+				auto end = &combinedReadConflictRanges[0] + (t+1)*combinedReadConflictRanges.size()/threads;
+				cs->shards[0].detectConflicts( begin, end-begin, transactionConflictStatus );
 				done[t].set();
 			});
 			cs->worker_ready[t]->set();
 		}
-		for(int i=0; i<PARALLEL_THREAD_COUNT; i++)
+		for(int i=0; i<threads; i++)
 			done[i].block();
+		delete[] done;
 	} else {
-		cs->versionHistory.detectConflicts( &combinedReadConflictRanges[0], combinedReadConflictRanges.size(), transactionConflictStatus );
+		cs->shards[0].detectConflicts( &combinedReadConflictRanges[0], combinedReadConflictRanges.size(), transactionConflictStatus );
 	}
 }
 
@@ -1258,21 +1415,60 @@ void ConflictBatch::addConflictRanges(Version now, vector< pair<StringRef,String
 }
 
 void ConflictBatch::mergeWriteConflictRanges(Version now) {
-	if (!combinedWriteConflictRanges.size()) 
+	if (!combinedWriteConflictRanges.size())
 		return;
 
-	if (PARALLEL_THREAD_COUNT) {
+	int threads = cs->worker_nextAction.size();
+
+	if (cs->shards.size() > 1) {
+		// Clip the combined (disjoint, sorted) ranges at shard boundaries and insert each shard's
+		// run independently; the shards partition the keyspace permanently, so no transient
+		// partition/concatenate of a single structure is needed
+		vector<vector<pair<StringRef,StringRef>>> shardRanges( cs->shards.size() );
+		for(auto& w : combinedWriteConflictRanges) {
+			int s = cs->shardFor( w.first );
+			StringRef begin = w.first;
+			while (s < cs->shardBoundaries.size() && compare( cs->shardBoundaries[s], w.second ) < 0) {
+				shardRanges[s].push_back( make_pair( begin, StringRef(cs->shardBoundaries[s]) ) );
+				begin = cs->shardBoundaries[s];
+				s++;
+			}
+			shardRanges[s].push_back( make_pair( begin, w.second ) );
+		}
+		if (threads) {
+			Event* done = new Event[ threads ];
+			for(int t=0; t<threads; t++) {
+				cs->worker_nextAction[t] = action( [&,t] {
+					for(int s=t; s<shardRanges.size(); s+=threads)
+						if (shardRanges[s].size())
+							addConflictRanges( now, shardRanges[s].begin(), shardRanges[s].end(), &cs->shards[s] );
+					done[t].set();
+				});
+				cs->worker_ready[t]->set();
+			}
+			for(int i=0; i<threads; i++)
+				done[i].block();
+			delete[] done;
+		} else {
+			for(int s=0; s<shardRanges.size(); s++)
+				if (shardRanges[s].size())
+					addConflictRanges( now, shardRanges[s].begin(), shardRanges[s].end(), &cs->shards[s] );
+		}
+		return;
+	}
+
+	if (threads) {
 		vector<SkipList> parts;
-		for (int i = 0; i < PARALLEL_THREAD_COUNT; i++)
+		for (int i = 0; i < threads; i++)
 			parts.push_back(SkipList());
 
 		vector<StringRef> splits( parts.size()-1 );
 		for(int s=0; s<splits.size(); s++)
 			splits[s] = combinedWriteConflictRanges[ (s+1)*combinedWriteConflictRanges.size()/parts.size() ].first;
 
-		cs->versionHistory.partition( splits.size() ? &splits[0] : NULL, splits.size(), &parts[0] );
-		vector<double> tstart(PARALLEL_THREAD_COUNT), tend(PARALLEL_THREAD_COUNT);
-		Event done[PARALLEL_THREAD_COUNT ? PARALLEL_THREAD_COUNT : 1];
+		cs->shards[0].partition( splits.size() ? &splits[0] : NULL, splits.size(), &parts[0] );
+		vector<double> tstart(threads), tend(threads);
+		Event* done = new Event[ threads ];
 		double before = timer();
 		for(int t=0; t<parts.size(); t++) {
 			cs->worker_nextAction[t] = action( [&,t] {
@@ -1288,8 +1484,9 @@ void ConflictBatch::mergeWriteConflictRanges(Version now) {
 			cs->worker_ready[t]->set();
 		}
 		double launch = timer();
-		for(int i=0; i<PARALLEL_THREAD_COUNT; i++)
+		for(int i=0; i<threads; i++)
 			done[i].block();
+		delete[] done;
 		double after = timer();
 
 		g_merge_launch += launch-before;
@@ -1308,9 +1505,9 @@ void ConflictBatch::mergeWriteConflictRanges(Version now) {
 		g_merge_run_longest += run_max;
 		g_merge_run_total += std::accumulate(tend.begin(),tend.end(),0.0)-std::accumulate(tstart.begin(),tstart.end(),0.0);
 
-		cs->versionHistory.concatenate( &parts[0], parts.size() );
+		cs->shards[0].concatenate( &parts[0], parts.size() );
 	} else {
-		addConflictRanges( now, combinedWriteConflictRanges.begin(), combinedWriteConflictRanges.end(), &cs->versionHistory );
+		addConflictRanges( now, combinedWriteConflictRanges.begin(), combinedWriteConflictRanges.end(), &cs->shards[0] );
 	}
 
 	//for(auto w = combinedWriteConflictRanges.begin(); w != combinedWriteConflictRanges.end(); ++w)
@@ -1446,7 +1643,7 @@ void skipListTest() {
 		}
 	}
 	printf("Test data generated (%d)\n", g_random->randomInt(0,100000));
-	printf("  %d threads, %d batches, %d/batch\n", PARALLEL_THREAD_COUNT, testData.size(), testData[0].size());
+	printf("  %d threads, %d batches, %d/batch\n", (int)cs->worker_nextAction.size(), testData.size(), testData[0].size());
 
 	printf("Running\n");
 
@@ -1508,7 +1705,10 @@ void skipListTest() {
 
 	//showNumaStatus();
 
-	printf("%d entries in version history\n", cs->versionHistory.count());
+	int historyEntries = 0;
+	for(int s=0; s<cs->shards.size(); s++)
+		historyEntries += cs->shards[s].count();
+	printf("%d entries in version history (%d shards)\n", historyEntries, (int)cs->shards.size());
 
 	/*start = timer();
 	vector<vector<int>> nonConflict2( testData.size() );
@@ -80,8 +80,6 @@ extern int limitReasonEnd;
 extern const char* limitReasonName[];
 extern const char* limitReasonDesc[];
 
-struct WorkerEvents : std::map<NetworkAddress, TraceEventFields>  {};
-
 ACTOR static Future< Optional<TraceEventFields> > latestEventOnWorker(WorkerInterface worker, std::string eventName) {
 	try {
 		EventLogRequest req = eventName.size() > 0 ? EventLogRequest(Standalone<StringRef>(eventName)) : EventLogRequest();
@@ -134,8 +132,29 @@ ACTOR static Future< Optional< std::pair<WorkerEvents, std::set<std::string>> >
 		throw;
 	}
 }
-static Future< Optional< std::pair<WorkerEvents, std::set<std::string>> > > latestErrorOnWorkers(std::vector<std::pair<WorkerInterface, ProcessClass>> workers) {
-	return latestEventOnWorkers( workers, "" );
+// Wraps latestEventOnWorkers() with a cache lookup.  Successful fan-out results fetched less than
+// cacheTime seconds ago are reused, so closely spaced status requests only query each worker once.
+ACTOR static Future< Optional< std::pair<WorkerEvents, std::set<std::string>> > > latestEventOnWorkersCached(StatusEventCache *cache, std::vector<std::pair<WorkerInterface, ProcessClass>> workers, std::string eventName, double cacheTime) {
+	if (cache != nullptr && cacheTime > 0) {
+		auto it = cache->entries.find(eventName);
+		if (it != cache->entries.end() && now() - it->second.fetchTime < cacheTime) {
+			TEST(true); // Worker event fan-out served from status cache
+			return Optional<std::pair<WorkerEvents, std::set<std::string>>>(it->second.events);
+		}
+	}
+
+	state double fetchTime = now();
+	Optional<std::pair<WorkerEvents, std::set<std::string>>> result = wait(latestEventOnWorkers(workers, eventName));
+	if (cache != nullptr && cacheTime > 0 && result.present()) {
+		StatusEventCache::Entry &entry = cache->entries[eventName];
+		entry.fetchTime = fetchTime;
+		entry.events = result.get();
+	}
+	return result;
+}
+
+static Future< Optional< std::pair<WorkerEvents, std::set<std::string>> > > latestErrorOnWorkers(StatusEventCache *cache, std::vector<std::pair<WorkerInterface, ProcessClass>> workers) {
+	return latestEventOnWorkersCached( cache, workers, "", SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME );
 }
 
 static Optional<std::pair<WorkerInterface, ProcessClass>> getWorker(std::vector<std::pair<WorkerInterface, ProcessClass>> const& workers, NetworkAddress const& address) {
@@ -640,6 +659,10 @@ ACTOR static Future<JsonBuilderObject> processStatusFetcher(
 					cpuObj["usage_cores"] = std::max(0.0, cpu_seconds / elapsed);
 					statusObj["cpu"] = cpuObj;
 
+					std::string runLoopBusy;
+					if (event.tryGetValue("RunLoopBusySeconds", runLoopBusy))
+						statusObj["run_loop_busy"] = std::max(0.0, std::min(parseDouble(runLoopBusy) / elapsed, 1.0));
+
 					diskObj["busy"] = std::max(0.0, std::min((elapsed - diskIdleSeconds) / elapsed, 1.0));
 
 					JsonBuilderObject readsObj;
@@ -687,6 +710,10 @@ ACTOR static Future<JsonBuilderObject> processStatusFetcher(
 
 				memoryObj.setKeyRawNumber("used_bytes",event.getValue("Memory"));
 				memoryObj.setKeyRawNumber("unused_allocated_memory",event.getValue("UnusedAllocatedMemory"));
+
+				std::string fastAllocations;
+				if (elapsed > 0 && event.tryGetValue("FastAllocations", fastAllocations))
+					memoryObj["fast_allocations_hz"] = parseDouble(fastAllocations) / elapsed;
 			}
 
 			if (programStarts.count(address)) {
@@ -974,6 +1001,50 @@ ACTOR static Future<JsonBuilderObject> latencyProbeFetcher(Database cx, JsonBuil
 	return statusObj;
 }
 
+// Rolls up the LatencyProbeMetrics events published by each worker's continuous latency probe
+// (worker.actor.cpp) into one section keyed by process address.  Unlike the on demand probe
+// above, these are percentiles over every probe in the worker's logging interval, so tail
+// behavior between status requests is visible.  Each entry carries its datacenter id so
+// dashboards can aggregate per DC.
+static JsonBuilderObject continuousProbeStatusFetcher(WorkerEvents probeMetrics, vector<std::pair<WorkerInterface, ProcessClass>> workers, std::set<std::string> *incomplete_reasons) {
+	JsonBuilderObject probeMap;
+
+	std::map<NetworkAddress, std::string> dcIds;
+	for (auto worker : workers)
+		if (worker.first.locality.dcId().present())
+			dcIds[worker.first.address()] = worker.first.locality.dcId().get().printable();
+
+	for(auto it = probeMetrics.begin(); it != probeMetrics.end(); it++) {
+		if (!it->second.size())
+			continue;
+
+		const TraceEventFields& event = it->second;
+		try {
+			JsonBuilderObject statusObj;
+			if (dcIds.count(it->first))
+				statusObj["datacenter_id"] = dcIds[it->first];
+
+			static const std::pair<const char*, const char*> probeTypes[] = { {"Grv","grv"}, {"Read","read"}, {"Commit","commit"} };
+			for (auto const& p : probeTypes) {
+				JsonBuilderObject probeObj;
+				probeObj["samples"] = parseInt64(event.getValue(format("%sSamples", p.first)));
+				probeObj["median_seconds"] = parseDouble(event.getValue(format("%sMedian", p.first)));
+				probeObj["p99_seconds"] = parseDouble(event.getValue(format("%sP99", p.first)));
+				probeObj["p999_seconds"] = parseDouble(event.getValue(format("%sP999", p.first)));
+				probeObj["max_seconds"] = parseDouble(event.getValue(format("%sMax", p.first)));
+				statusObj[p.second] = probeObj;
+			}
+
+			probeMap[it->first.toString()] = statusObj;
+		}
+		catch (Error& e) {
+			incomplete_reasons->insert("Could not parse continuous latency probe metrics from some processes.");
+		}
+	}
+
+	return probeMap;
+}
+
 ACTOR static Future<std::pair<Optional<DatabaseConfiguration>,Optional<bool>>> loadConfiguration(Database cx, JsonBuilderArray *messages, std::set<std::string> *status_incomplete_reasons){
 	state Optional<DatabaseConfiguration> result;
 	state Optional<bool> fullReplication;
@@ -1244,6 +1315,38 @@ ACTOR static Future<vector<std::pair<TLogInterface, TraceEventFields>>> getTLogs
 	return results;
 }
 
+// Cacheing wrappers for the role metrics fan-outs, in the style of latestEventOnWorkersCached().
+// Only successful fetches are cached; errors propagate to the errorOr() at the call site.
+ACTOR static Future<vector<std::pair<StorageServerInterface, TraceEventFields>>> getStorageServersAndMetricsCached(StatusEventCache *cache, Database cx, std::unordered_map<NetworkAddress, WorkerInterface> address_workers) {
+	if (cache != nullptr && cache->storageServers.present() && now() - cache->storageServersFetchTime < SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME) {
+		TEST(true); // Storage role metrics served from status cache
+		return cache->storageServers.get();
+	}
+
+	state double fetchTime = now();
+	vector<std::pair<StorageServerInterface, TraceEventFields>> results = wait(getStorageServersAndMetrics(cx, address_workers));
+	if (cache != nullptr && SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME > 0) {
+		cache->storageServersFetchTime = fetchTime;
+		cache->storageServers = results;
+	}
+	return results;
+}
+
+ACTOR static Future<vector<std::pair<TLogInterface, TraceEventFields>>> getTLogsAndMetricsCached(StatusEventCache *cache, Reference<AsyncVar<struct ServerDBInfo>> db, std::unordered_map<NetworkAddress, WorkerInterface> address_workers) {
+	if (cache != nullptr && cache->tLogs.present() && now() - cache->tLogsFetchTime < SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME) {
+		TEST(true); // Log role metrics served from status cache
+		return cache->tLogs.get();
+	}
+
+	state double fetchTime = now();
+	vector<std::pair<TLogInterface, TraceEventFields>> results = wait(getTLogsAndMetrics(db, address_workers));
+	if (cache != nullptr && SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME > 0) {
+		cache->tLogsFetchTime = fetchTime;
+		cache->tLogs = results;
+	}
+	return results;
+}
+
 static int getExtraTLogEligibleMachines(vector<std::pair<WorkerInterface, ProcessClass>> workers, DatabaseConfiguration configuration) {
 	std::set<StringRef> allMachines;
 	std::map<Key,std::set<StringRef>> dcId_machine;
@@ -1705,7 +1808,8 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		std::map<NetworkAddress, std::string> traceLogGroupMap,
 		ServerCoordinators coordinators,
 		std::vector<NetworkAddress> incompatibleConnections,
-		Version datacenterVersionDifference )
+		Version datacenterVersionDifference,
+		StatusEventCache *eventCache )
 {
 	state double tStart = timer();
 
@@ -1723,15 +1827,33 @@ ACTOR Future<StatusReply> clusterGetStatus(
 			messages.push_back(JsonString::makeMessage("unreachable_master_worker", "Unable to locate the master worker."));
 		}
 
+		// Everything cached from previous status requests was fetched from a particular set of
+		// workers, so throw it all away if that set has changed.
+		if (eventCache != nullptr) {
+			std::vector<NetworkAddress> workerAddresses;
+			for (auto const& w : workers)
+				workerAddresses.push_back(w.first.address());
+			std::sort(workerAddresses.begin(), workerAddresses.end());
+			if (workerAddresses != eventCache->workerAddresses) {
+				eventCache->entries.clear();
+				eventCache->storageServers = Optional<vector<std::pair<StorageServerInterface, TraceEventFields>>>();
+				eventCache->tLogs = Optional<vector<std::pair<TLogInterface, TraceEventFields>>>();
+				eventCache->workerAddresses = workerAddresses;
+			}
+		}
+
 		// Get latest events for various event types from ALL workers
 		// WorkerEvents is a map of worker's NetworkAddress to its event string
 		// The pair represents worker responses and a set of worker NetworkAddress strings which did not respond
+		// Results are cached between closely spaced status requests; ProgramStart only changes when
+		// a process restarts, so it is reused for much longer than the metrics events.
 		std::vector< Future< Optional <std::pair<WorkerEvents, std::set<std::string>>> > > futures;
-		futures.push_back(latestEventOnWorkers(workers, "MachineMetrics"));
-		futures.push_back(latestEventOnWorkers(workers, "ProcessMetrics"));
-		futures.push_back(latestErrorOnWorkers(workers));
-		futures.push_back(latestEventOnWorkers(workers, "TraceFileOpenError"));
-		futures.push_back(latestEventOnWorkers(workers, "ProgramStart"));
+		futures.push_back(latestEventOnWorkersCached(eventCache, workers, "MachineMetrics", SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME));
+		futures.push_back(latestEventOnWorkersCached(eventCache, workers, "ProcessMetrics", SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME));
+		futures.push_back(latestErrorOnWorkers(eventCache, workers));
+		futures.push_back(latestEventOnWorkersCached(eventCache, workers, "TraceFileOpenError", SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME));
+		futures.push_back(latestEventOnWorkersCached(eventCache, workers, "ProgramStart", SERVER_KNOBS->STATUS_STATIC_EVENT_CACHE_TIME));
+		futures.push_back(latestEventOnWorkersCached(eventCache, workers, "LatencyProbeMetrics", SERVER_KNOBS->STATUS_WORKER_EVENT_CACHE_TIME));
 
 		// Wait for all response pairs.
 		state std::vector< Optional <std::pair<WorkerEvents, std::set<std::string>>> > workerEventsVec = wait(getAll(futures));
@@ -1771,6 +1893,8 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		state WorkerEvents latestError = workerEventsVec[2].present() ? workerEventsVec[2].get().first : WorkerEvents();
 		state WorkerEvents traceFileOpenErrors = workerEventsVec[3].present() ? workerEventsVec[3].get().first : WorkerEvents();
 		state WorkerEvents programStarts = workerEventsVec[4].present() ? workerEventsVec[4].get().first : WorkerEvents();
+		// continuous latency probe metrics
+		state WorkerEvents probeMetrics = workerEventsVec[5].present() ? workerEventsVec[5].get().first : WorkerEvents();
 
 		state JsonBuilderObject statusObj;
 		if(db->get().recoveryCount > 0) {
@@ -1811,13 +1935,18 @@ ACTOR Future<StatusReply> clusterGetStatus(
 				statusObj["latency_probe"] = latencyProbeResults;
 			}
 
+			JsonBuilderObject continuousProbes = continuousProbeStatusFetcher(probeMetrics, workers, &status_incomplete_reasons);
+			if (!continuousProbes.empty()) {
+				statusObj["continuous_latency_probes"] = continuousProbes;
+			}
+
 			// Start getting storage servers now (using system priority) concurrently.  Using sys priority because having storage servers
 			// in status output is important to give context to error messages in status that reference a storage server role ID.
 			state std::unordered_map<NetworkAddress, WorkerInterface> address_workers;
 			for (auto worker : workers)
 				address_workers[worker.first.address()] = worker.first;
-			state Future<ErrorOr<vector<std::pair<StorageServerInterface, TraceEventFields>>>> storageServerFuture = errorOr(getStorageServersAndMetrics(cx, address_workers));
-			state Future<ErrorOr<vector<std::pair<TLogInterface, TraceEventFields>>>> tLogFuture = errorOr(getTLogsAndMetrics(db, address_workers));
+			state Future<ErrorOr<vector<std::pair<StorageServerInterface, TraceEventFields>>>> storageServerFuture = errorOr(getStorageServersAndMetricsCached(eventCache, cx, address_workers));
+			state Future<ErrorOr<vector<std::pair<TLogInterface, TraceEventFields>>>> tLogFuture = errorOr(getTLogsAndMetricsCached(eventCache, db, address_workers));
 
 			state int minReplicasRemaining = -1;
 			std::vector<Future<JsonBuilderObject>> futures2;
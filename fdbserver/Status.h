@@ -30,8 +30,38 @@
 typedef std::map< NetworkAddress, std::pair<std::string,UID> > ProcessIssuesMap;
 typedef std::map< NetworkAddress, Standalone<VectorRef<ClientVersionRef>> > ClientVersionMap;
 
+struct WorkerEvents : std::map<NetworkAddress, TraceEventFields> {};
+
+// Caches the results of the per-worker and per-role fan-outs performed while building a status
+// document so that frequent status polling does not repeatedly query every process in the cluster.
+// Owned by the cluster controller's status server, which passes it to each clusterGetStatus() call.
+// How long cached results are reused is controlled by STATUS_WORKER_EVENT_CACHE_TIME and
+// STATUS_STATIC_EVENT_CACHE_TIME; setting either to 0 disables the corresponding caching.
+struct StatusEventCache {
+	struct Entry {
+		double fetchTime;
+		std::pair<WorkerEvents, std::set<std::string>> events;
+	};
+
+	// Cached worker event fan-out results, keyed by event name ("" is the latest error query)
+	std::map<std::string, Entry> entries;
+
+	// Cached storage and log role metrics
+	double storageServersFetchTime;
+	Optional<vector<std::pair<StorageServerInterface, TraceEventFields>>> storageServers;
+	double tLogsFetchTime;
+	Optional<vector<std::pair<TLogInterface, TraceEventFields>>> tLogs;
+
+	// The worker addresses the cached results were fetched from.  Everything cached is
+	// invalidated when the set of workers changes.
+	std::vector<NetworkAddress> workerAddresses;
+
+	StatusEventCache() : storageServersFetchTime(0), tLogsFetchTime(0) {}
+};
+
 Future<StatusReply> clusterGetStatus( Reference<AsyncVar<struct ServerDBInfo>> const& db, Database const& cx, vector<std::pair<WorkerInterface, ProcessClass>> const& workers,
 	ProcessIssuesMap const& workerIssues, ProcessIssuesMap const& clientIssues, ClientVersionMap const& clientVersionMap, std::map<NetworkAddress, std::string> const& traceLogGroupMap,
-	ServerCoordinators const& coordinators, std::vector<NetworkAddress> const& incompatibleConnections, Version const& datacenterVersionDifference );
+	ServerCoordinators const& coordinators, std::vector<NetworkAddress> const& incompatibleConnections, Version const& datacenterVersionDifference,
+	StatusEventCache* const& eventCache );
 
 #endif
@@ -25,10 +25,13 @@
 #include "fdbclient/StorageServerInterface.h"
 #include "fdbclient/KeyRangeMap.h"
 #include "fdbserver/Knobs.h"
+#include "flow/PackedIndexedSet.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
 struct StorageMetricSample {
-	IndexedSet<Key, int64_t> sample;
+	// Packs several keys and metric subtotals per node, so the range sums and index()
+	// searches done on every read have far fewer cache misses than the AVL IndexedSet
+	PackedIndexedSet<Key, int64_t> sample;
 	int64_t metricUnitsPerSample;
 
 	StorageMetricSample( int64_t metricUnitsPerSample ) : metricUnitsPerSample(metricUnitsPerSample) {}
@@ -143,10 +143,13 @@ struct TLogPeekReply {
 	Version maxKnownVersion;
 	Version minKnownCommittedVersion;
 	Optional<Version> begin;
+	uint32_t checksum; // CRC-32C of messages, or 0 if the sender did not stamp one
+
+	TLogPeekReply() : checksum(0) {}
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & arena & messages & end & popped & maxKnownVersion & minKnownCommittedVersion & begin;
+		ar & arena & messages & end & popped & maxKnownVersion & minKnownCommittedVersion & begin & checksum;
 	}
 };
 
@@ -205,16 +208,17 @@ struct TLogCommitRequest {
 	Version prevVersion, version, knownCommittedVersion, minKnownCommittedVersion;
 
 	StringRef messages;// Each message prefixed by a 4-byte length
+	uint32_t checksum; // CRC-32C of messages, or 0 if the sender did not stamp one
 
 	ReplyPromise<Version> reply;
 	Optional<UID> debugID;
 
-	TLogCommitRequest() {}
-	TLogCommitRequest( const Arena& a, Version prevVersion, Version version, Version knownCommittedVersion, Version minKnownCommittedVersion, StringRef messages, Optional<UID> debugID )
-		: arena(a), prevVersion(prevVersion), version(version), knownCommittedVersion(knownCommittedVersion), minKnownCommittedVersion(minKnownCommittedVersion), messages(messages), debugID(debugID) {}
+	TLogCommitRequest() : checksum(0) {}
+	TLogCommitRequest( const Arena& a, Version prevVersion, Version version, Version knownCommittedVersion, Version minKnownCommittedVersion, StringRef messages, Optional<UID> debugID, uint32_t checksum = 0 )
+		: arena(a), prevVersion(prevVersion), version(version), knownCommittedVersion(knownCommittedVersion), minKnownCommittedVersion(minKnownCommittedVersion), messages(messages), checksum(checksum), debugID(debugID) {}
 	template <class Ar>
 	void serialize( Ar& ar ) {
-		ar & prevVersion & version & knownCommittedVersion & minKnownCommittedVersion & messages & reply & arena & debugID;
+		ar & prevVersion & version & knownCommittedVersion & minKnownCommittedVersion & messages & reply & arena & debugID & checksum;
 	}
 };
 
@@ -33,6 +33,8 @@
 #include "fdbrpc/FailureMonitor.h"
 #include "fdbserver/IDiskQueue.h"
 #include "fdbrpc/sim_validation.h"
+#include "fdbrpc/zlib/zlib.h"
+#include "fdbrpc/crc32c.h"
 #include "fdbserver/ServerDBInfo.h"
 #include "fdbserver/LogSystem.h"
 #include "fdbserver/WaitFailure.h"
@@ -394,6 +396,10 @@ struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 	CounterCollection cc;
 	Counter bytesInput;
 	Counter bytesDurable;
+	Counter localPeeks;     // Peek replies served to local consumers (storage servers)
+	Counter wanPeeks;       // Peek replies served to WAN consumers (log routers)
+	Counter localPeekBytes;
+	Counter wanPeekBytes;
 
 	UID logId;
 	Version newPersistentDataVersion;
@@ -414,7 +420,9 @@ struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 	Future<Void> terminated;
 
 	explicit LogData(TLogData* tLogData, TLogInterface interf, Tag remoteTag, bool isPrimary, int logRouterTags, UID recruitmentID, std::vector<Tag> tags) : tLogData(tLogData), knownCommittedVersion(0), logId(interf.id()),
-			cc("TLog", interf.id().toString()), bytesInput("BytesInput", cc), bytesDurable("BytesDurable", cc), remoteTag(remoteTag), isPrimary(isPrimary), logRouterTags(logRouterTags), recruitmentID(recruitmentID),
+			cc("TLog", interf.id().toString()), bytesInput("BytesInput", cc), bytesDurable("BytesDurable", cc),
+			localPeeks("LocalPeeks", cc), wanPeeks("WanPeeks", cc), localPeekBytes("LocalPeekBytes", cc), wanPeekBytes("WanPeekBytes", cc),
+			remoteTag(remoteTag), isPrimary(isPrimary), logRouterTags(logRouterTags), recruitmentID(recruitmentID),
 			logSystem(new AsyncVar<Reference<ILogSystem>>()), logRouterPoppedVersion(0), durableKnownCommittedVersion(0), minKnownCommittedVersion(0), allTags(tags.begin(), tags.end()), terminated(tLogData->terminated.getFuture()),
 			// These are initialized differently on init() or recovery
 			recoveryCount(), stopped(false), initialized(false), queueCommittingVersion(0), newPersistentDataVersion(invalidVersion), unrecoveredBefore(1), recoveredAt(1), unpoppedRecoveredTags(0),
@@ -545,6 +553,64 @@ void updatePersistentPopped( TLogData* self, Reference<LogData> logData, Referen
 		data->nothingPersistent = true;
 }
 
+// Spilled values are self-describing: a raw value begins with the 32-bit length of its first
+// message, so the impossible length 0xFFFFFFFF marks an entry whose remaining bytes are a 32-bit
+// uncompressed length followed by a zlib deflate stream.  Entries written before compression
+// existed therefore keep reading correctly.
+static const uint32_t spilledValueCompressedMagic = 0xFFFFFFFF;
+
+// Returns an empty Optional if the value did not shrink enough to be worth storing compressed
+static Optional<Value> compressSpilledValue( StringRef raw ) {
+	z_stream stream;
+	memset( &stream, 0, sizeof(stream) );
+	int rc = deflateInit( &stream, Z_BEST_SPEED );
+	ASSERT( rc == Z_OK );
+	uLong bound = deflateBound( &stream, raw.size() );
+	Standalone<StringRef> buf = makeString( bound );
+	stream.next_in = (Bytef*)raw.begin();
+	stream.avail_in = raw.size();
+	stream.next_out = mutateString( buf );
+	stream.avail_out = bound;
+	rc = deflate( &stream, Z_FINISH );
+	int compressedSize = stream.total_out;
+	deflateEnd( &stream );
+	ASSERT( rc == Z_STREAM_END );
+	if( compressedSize + 2*sizeof(uint32_t) >= raw.size() )
+		return Optional<Value>();
+	BinaryWriter wr( Unversioned() );
+	wr << spilledValueCompressedMagic << uint32_t(raw.size());
+	wr.serializeBytes( mutateString(buf), compressedSize );
+	return Value( wr.toStringRef() );
+}
+
+static bool isCompressedSpilledValue( StringRef value ) {
+	return value.size() >= sizeof(uint32_t) && *(uint32_t*)value.begin() == spilledValueCompressedMagic;
+}
+
+// Appends a spilled value's messages to wr, decompressing if necessary, and returns the raw size
+static int appendSpilledValue( StringRef value, BinaryWriter& wr ) {
+	if( !isCompressedSpilledValue(value) ) {
+		wr.serializeBytes( value );
+		return value.size();
+	}
+	uint32_t rawSize = *(uint32_t*)(value.begin() + sizeof(uint32_t));
+	z_stream stream;
+	memset( &stream, 0, sizeof(stream) );
+	int rc = inflateInit( &stream );
+	ASSERT( rc == Z_OK );
+	Standalone<StringRef> buf = makeString( rawSize );
+	stream.next_in = (Bytef*)value.begin() + 2*sizeof(uint32_t);
+	stream.avail_in = value.size() - 2*sizeof(uint32_t);
+	stream.next_out = mutateString( buf );
+	stream.avail_out = rawSize;
+	rc = inflate( &stream, Z_FINISH );
+	bool ok = rc == Z_STREAM_END && stream.total_out == rawSize;
+	inflateEnd( &stream );
+	ASSERT( ok );  // The storage engine checksums its pages, so a malformed stream here is a code bug rather than disk corruption
+	wr.serializeBytes( buf );
+	return rawSize;
+}
+
 ACTOR Future<Void> updatePersistentData( TLogData* self, Reference<LogData> logData, Version newPersistentDataVersion ) {
 	// PERSIST: Changes self->persistentDataVersion and writes and commits the relevant changes
 	ASSERT( newPersistentDataVersion <= logData->version.get() );
@@ -573,12 +639,46 @@ ACTOR Future<Void> updatePersistentData( TLogData* self, Reference<LogData> logD
 					currentVersion = msg->first;
 					anyData = true;
 					tagData->nothingPersistent = false;
-					BinaryWriter wr( Unversioned() );
 
-					for(; msg != tagData->versionMessages.end() && msg->first == currentVersion; ++msg)
-						wr << msg->second.toStringRef();
+					// The spilled value is the concatenation of each message's length-prefixed bytes,
+					// which is exactly how the messages are laid out in the message blocks, so
+					// contiguous runs of messages can be referenced in place rather than re-serialized
+					// one message at a time.  When a tag is attached to every message in a version
+					// (e.g. a log router tag for a lagging remote DC) the whole version is one run.
+					std::vector<StringRef> runs;
+					uint8_t* runBegin = NULL;
+					uint8_t* runEnd = NULL;
+					for(; msg != tagData->versionMessages.end() && msg->first == currentVersion; ++msg) {
+						uint8_t* b = (uint8_t*)msg->second.getLengthPtr();
+						uint8_t* e = b + sizeof(uint32_t) + msg->second.expectedSize();
+						if(b != runEnd) {
+							if(runBegin)
+								runs.push_back( StringRef(runBegin, runEnd - runBegin) );
+							runBegin = b;
+						}
+						runEnd = e;
+					}
+					if(runBegin)
+						runs.push_back( StringRef(runBegin, runEnd - runBegin) );
+
+					BinaryWriter wr( Unversioned() );
+					StringRef value;
+					if(runs.size() == 1) {
+						TEST(true); // Spilled a version's messages by reference
+						value = runs[0];
+					}
+					else {
+						TEST(true); // Spilled a version's messages from multiple runs
+						for(auto& run : runs)
+							wr.serializeBytes( run );
+						value = wr.toStringRef();
+					}
 
-					self->persistentData->set( KeyValueRef( persistTagMessagesKey( logData->logId, tagData->tag, currentVersion ), wr.toStringRef() ) );
+					Optional<Value> compressed;
+					if( SERVER_KNOBS->TLOG_SPILL_COMPRESSION_MIN_BYTES >= 0 && value.size() >= SERVER_KNOBS->TLOG_SPILL_COMPRESSION_MIN_BYTES )
+						compressed = compressSpilledValue( value );
+					TEST( compressed.present() ); // Spilled value written compressed
+					self->persistentData->set( KeyValueRef( persistTagMessagesKey( logData->logId, tagData->tag, currentVersion ), compressed.present() ? compressed.get() : value ) );
 
 					Future<Void> f = yield(TaskUpdateStorage);
 					if(!f.isReady()) {
@@ -903,6 +1003,17 @@ ACTOR Future<Void> tLogPop( TLogData* self, TLogPopRequest req, Reference<LogDat
 	return Void();
 }
 
+// Peek consumers fall into two classes identified by the tag they peek: log routers pull across
+// datacenters, where batching aggressively amortizes the WAN round trip over more versions;
+// everything else (primarily storage servers) is local and its lag should stay small.
+static bool isWANPeek( TLogPeekRequest const& req ) {
+	return req.tag.locality == tagLocalityLogRouter;
+}
+
+static int peekReplyBytes( TLogPeekRequest const& req ) {
+	return isWANPeek(req) ? SERVER_KNOBS->LOG_ROUTER_PEEK_REPLY_BYTES : SERVER_KNOBS->DESIRED_TOTAL_BYTES;
+}
+
 void peekMessagesFromMemory( Reference<LogData> self, TLogPeekRequest const& req, BinaryWriter& messages, Version& endVersion ) {
 	ASSERT( !messages.getLength() );
 
@@ -915,7 +1026,7 @@ void peekMessagesFromMemory( Reference<LogData> self, TLogPeekRequest const& req
 	Version currentVersion = -1;
 	for(; it != deque.end(); ++it) {
 		if(it->first != currentVersion) {
-			if (messages.getLength() >= SERVER_KNOBS->DESIRED_TOTAL_BYTES) {
+			if (messages.getLength() >= peekReplyBytes(req)) {
 				endVersion = currentVersion + 1;
 				//TraceEvent("TLogPeekMessagesReached2", self->dbgid);
 				break;
@@ -978,7 +1089,9 @@ ACTOR Future<Void> tLogPeekMessages( TLogData* self, TLogPeekRequest req, Refere
 	// Wait until we have something to return that the caller doesn't already have
 	if( logData->version.get() < req.begin ) {
 		wait( logData->version.whenAtLeast( req.begin ) );
-		wait( delay(SERVER_KNOBS->TLOG_PEEK_DELAY, g_network->getCurrentTask()) );
+		// WAN consumers pause longer before replying so more versions accumulate into each
+		// (already larger) reply; local storage peeks stay prompt
+		wait( delay(isWANPeek(req) ? SERVER_KNOBS->TLOG_WAN_PEEK_DELAY : SERVER_KNOBS->TLOG_PEEK_DELAY, g_network->getCurrentTask()) );
 	}
 
 	if( req.tag.locality == tagLocalityLogRouter ) {
@@ -1034,17 +1147,28 @@ ACTOR Future<Void> tLogPeekMessages( TLogData* self, TLogPeekRequest req, Refere
 		Standalone<VectorRef<KeyValueRef>> kvs = wait(
 			self->persistentData->readRange(KeyRangeRef(
 				persistTagMessagesKey(logData->logId, req.tag, req.begin),
-				persistTagMessagesKey(logData->logId, req.tag, logData->persistentDataDurableVersion + 1)), SERVER_KNOBS->DESIRED_TOTAL_BYTES, SERVER_KNOBS->DESIRED_TOTAL_BYTES));
+				persistTagMessagesKey(logData->logId, req.tag, logData->persistentDataDurableVersion + 1)), peekReplyBytes(req), peekReplyBytes(req)));
 
 		//TraceEvent("TLogPeekResults", self->dbgid).detail("ForAddress", req.reply.getEndpoint().address).detail("Tag1Results", s1).detail("Tag2Results", s2).detail("Tag1ResultsLim", kv1.size()).detail("Tag2ResultsLim", kv2.size()).detail("Tag1ResultsLast", kv1.size() ? printable(kv1[0].key) : "").detail("Tag2ResultsLast", kv2.size() ? printable(kv2[0].key) : "").detail("Limited", limited).detail("NextEpoch", next_pos.epoch).detail("NextSeq", next_pos.sequence).detail("NowEpoch", self->epoch()).detail("NowSeq", self->sequence.getNextSequence());
 
+		int rawReplyBytes = 0;
+		bool limited = false;
 		for (auto &kv : kvs) {
 			auto ver = decodeTagMessagesKey(kv.key);
 			messages << int32_t(-1) << ver;
-			messages.serializeBytes(kv.value);
+			rawReplyBytes += appendSpilledValue( kv.value, messages );
+			// The read limit above counts on-disk bytes, and decompression can expand the reply
+			// well past it, so re-apply the limit to what will actually be sent
+			if (rawReplyBytes >= peekReplyBytes(req)) {
+				limited = true;
+				endVersion = ver + 1;
+				break;
+			}
 		}
 
-		if (kvs.expectedSize() >= SERVER_KNOBS->DESIRED_TOTAL_BYTES)
+		if (limited) {
+			TEST(true); // Spilled peek reply limited by decompressed size
+		} else if (kvs.expectedSize() >= peekReplyBytes(req))
 			endVersion = decodeTagMessagesKey(kvs.end()[-1].key) + 1;
 		else
 			messages.serializeBytes( messages2.toStringRef() );
@@ -1058,6 +1182,8 @@ ACTOR Future<Void> tLogPeekMessages( TLogData* self, TLogPeekRequest req, Refere
 	reply.minKnownCommittedVersion = logData->minKnownCommittedVersion;
 	reply.messages = messages.toStringRef();
 	reply.end = endVersion;
+	if( SERVER_KNOBS->MUTATION_CHECKSUMS )
+		reply.checksum = crc32c_append( 0, reply.messages.begin(), reply.messages.size() );
 
 	//TraceEvent("TlogPeek", self->dbgid).detail("LogId", logData->logId).detail("EndVer", reply.end).detail("MsgBytes", reply.messages.expectedSize()).detail("ForAddress", req.reply.getEndpoint().address);
 
@@ -1081,6 +1207,14 @@ ACTOR Future<Void> tLogPeekMessages( TLogData* self, TLogPeekRequest req, Refere
 		reply.begin = req.begin;
 	}
 
+	if (isWANPeek(req)) {
+		++logData->wanPeeks;
+		logData->wanPeekBytes += reply.messages.size();
+	} else {
+		++logData->localPeeks;
+		logData->localPeekBytes += reply.messages.size();
+	}
+
 	req.reply.send( reply );
 	return Void();
 }
@@ -1179,6 +1313,17 @@ ACTOR Future<Void> tLogCommit(
 		g_traceBatch.addEvent("CommitDebug", tlogDebugID.get().first(), "TLog.tLogCommit.BeforeWaitForVersion");
 	}
 
+	// A mismatch here means the messages rotted between the proxy serializing them and us receiving
+	// them, as opposed to in our queue or on the peek path, which have their own checksums
+	if( SERVER_KNOBS->MUTATION_CHECKSUMS && req.checksum && crc32c_append( 0, req.messages.begin(), req.messages.size() ) != req.checksum ) {
+		TraceEvent(SevError, "TLogCommitChecksumMismatch", logData->logId)
+			.detail("Version", req.version)
+			.detail("PrevVersion", req.prevVersion)
+			.detail("MessageBytes", req.messages.size());
+		req.reply.sendError( checksum_failed() );
+		return Void();
+	}
+
 	logData->minKnownCommittedVersion = std::max(logData->minKnownCommittedVersion, req.minKnownCommittedVersion);
 
 	wait( logData->version.whenAtLeast( req.prevVersion ) );
@@ -1979,7 +2124,9 @@ ACTOR Future<Void> tLogStart( TLogData* self, InitializeTLogRequest req, Localit
 					logData->logRouterPopToVersion = req.recoverAt;
 					std::vector<Tag> tags;
 					tags.push_back(logData->remoteTag);
-					wait(pullAsyncData(self, logData, tags, logData->unrecoveredBefore, req.recoverAt, true, false) || logData->removed);
+					// This pull is bounded by recoverAt and on the recovery critical path, so keep multiple
+					// peeks outstanding like the recoverTags pull below rather than one round trip at a time
+					wait(pullAsyncData(self, logData, tags, logData->unrecoveredBefore, req.recoverAt, true, true) || logData->removed);
 				} else if(!req.recoverTags.empty()) {
 					ASSERT(logData->unrecoveredBefore > req.knownCommittedVersion);
 					wait(pullAsyncData(self, logData, req.recoverTags, req.knownCommittedVersion + 1, req.recoverAt, false, true) || logData->removed);
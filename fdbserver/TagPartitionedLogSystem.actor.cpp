@@ -28,8 +28,15 @@
 #include "fdbrpc/Replication.h"
 #include "fdbrpc/ReplicationUtils.h"
 #include "fdbserver/RecoveryState.h"
+#include "fdbrpc/crc32c.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
+// Stamps commit payloads with a checksum the receiving tlog verifies, so corruption between the
+// proxy's serialization and the tlog's queue push has a distinct signature from later corruption
+static uint32_t messageChecksum( StringRef messages ) {
+	return SERVER_KNOBS->MUTATION_CHECKSUMS ? crc32c_append( 0, messages.begin(), messages.size() ) : 0;
+}
+
 ACTOR Future<Version> minVersionWhenReady( Future<Void> f, std::vector<Future<Version>> replies) {
 	wait(f);
 	Version minVersion = std::numeric_limits<Version>::max();
@@ -41,6 +48,19 @@ ACTOR Future<Version> minVersionWhenReady( Future<Void> f, std::vector<Future<Ve
 	return minVersion;
 }
 
+ACTOR Future<Void> whenVersionAcked( Reference<AsyncVar<Version>> ackedVersion, Version version ) {
+	while( ackedVersion->get() < version )
+		wait( ackedVersion->onChange() );
+	return Void();
+}
+
+ACTOR Future<Version> recordCommitReply( Future<Version> reply, Reference<AsyncVar<Version>> ackedVersion, Version version ) {
+	Version kcv = wait( reply );
+	if( version > ackedVersion->get() )
+		ackedVersion->set( version );
+	return kcv;
+}
+
 struct OldLogData {
 	std::vector<Reference<LogSet>> tLogs;
 	int32_t logRouterTags;
@@ -88,7 +108,22 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 	std::vector<OldLogData> oldLogData;
 	AsyncTrigger logSystemConfigChanged;
 
-	TagPartitionedLogSystem( UID dbgid, LocalityData locality, Optional<PromiseStream<Future<Void>>> addActor = Optional<PromiseStream<Future<Void>>>() ) : dbgid(dbgid), locality(locality), addActor(addActor), popActors(false), recoveryCompleteWrittenToCoreState(false), remoteLogsWrittenToCoreState(false), logSystemType(0), logRouterTags(0), expectedLogSets(0), hasRemoteServers(false), stopped(false), repopulateRegionAntiQuorum(0) {}
+	// Empty commit coalescing state (see push()), one entry per local push location.  A version with
+	// no messages for a location is not broadcast immediately; the next non-empty commit (or the
+	// beacon below) carries the version advancement, with prevSent maintaining that location's
+	// version chain across the versions it never saw.
+	struct PushLocationState {
+		Version prevSent;        // prevVersion for the next TLogCommitRequest to this location
+		Version deferredVersion; // newest version whose empty commit has been deferred, or invalidVersion
+		Reference<AsyncVar<Version>> ackedVersion; // highest version this location has durably committed and acknowledged
+		PushLocationState() : prevSent(invalidVersion), deferredVersion(invalidVersion), ackedVersion(new AsyncVar<Version>(invalidVersion)) {}
+	};
+	std::vector<PushLocationState> pushLocationState;
+	Version lastPushKnownCommittedVersion;
+	Version lastPushMinKnownCommittedVersion;
+	Future<Void> emptyPushBeacon;
+
+	TagPartitionedLogSystem( UID dbgid, LocalityData locality, Optional<PromiseStream<Future<Void>>> addActor = Optional<PromiseStream<Future<Void>>>() ) : dbgid(dbgid), locality(locality), addActor(addActor), popActors(false), recoveryCompleteWrittenToCoreState(false), remoteLogsWrittenToCoreState(false), logSystemType(0), logRouterTags(0), expectedLogSets(0), hasRemoteServers(false), stopped(false), repopulateRegionAntiQuorum(0), lastPushKnownCommittedVersion(0), lastPushMinKnownCommittedVersion(0) {}
 
 	virtual void stopRejoins() {
 		rejoins = Future<Void>();
@@ -395,21 +430,92 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 		}
 	}
 
+	// Sends any deferred empty commits so idle log servers keep advancing (and so the versions
+	// deferred behind them can be acknowledged) even when no further pushes arrive for them
+	void flushDeferredEmptyPushes() {
+		int location = 0;
+		for(auto& it : tLogs) {
+			if(it->isLocal && it->logServers.size()) {
+				for(int loc=0; loc<it->logServers.size(); loc++) {
+					auto& st = pushLocationState[location + loc];
+					if( st.deferredVersion != invalidVersion ) {
+						TEST(true); // Deferred empty tlog commit flushed by beacon
+						Future<Version> reply = recordCommitReply( it->logServers[loc]->get().interf().commit.getReply( TLogCommitRequest( Arena(), st.prevSent, st.deferredVersion, lastPushKnownCommittedVersion, lastPushMinKnownCommittedVersion, StringRef(), Optional<UID>() ), TaskTLogCommitReply ), st.ackedVersion, st.deferredVersion );
+						addActor.get().send( success( reply ) );
+						st.prevSent = st.deferredVersion;
+						st.deferredVersion = invalidVersion;
+					}
+				}
+				location += it->logServers.size();
+			}
+		}
+	}
+
+	ACTOR static Future<Void> emptyPushBeaconActor( TagPartitionedLogSystem* self ) {
+		loop {
+			wait( delay( SERVER_KNOBS->TLOG_EMPTY_PUSH_COALESCE_DELAY, TaskTLogCommitReply ) );
+			self->flushDeferredEmptyPushes();
+		}
+	}
+
 	virtual Future<Version> push( Version prevVersion, Version version, Version knownCommittedVersion, Version minKnownCommittedVersion, LogPushData& data, Optional<UID> debugID ) {
-		// FIXME: Randomize request order as in LegacyLogSystem?
+		// With TLOG_EMPTY_PUSH_COALESCE_DELAY set, versions that carry no messages for a log server
+		// are not broadcast to it individually; the advancement rides on that server's next non-empty
+		// commit (or the periodic beacon).  The version is still only acknowledged once every local
+		// log server has durably reached it, so a deferred location contributes a waiter on its
+		// acknowledged version to the quorum in place of a direct reply.
+		bool coalesceEmpty = SERVER_KNOBS->TLOG_EMPTY_PUSH_COALESCE_DELAY > 0;
+		if(coalesceEmpty) {
+			if(pushLocationState.empty()) {
+				int totalLocations = 0;
+				for(auto& it : tLogs)
+					if(it->isLocal && it->logServers.size())
+						totalLocations += it->logServers.size();
+				pushLocationState.resize(totalLocations);
+			}
+			lastPushKnownCommittedVersion = knownCommittedVersion;
+			lastPushMinKnownCommittedVersion = minKnownCommittedVersion;
+			if(!emptyPushBeacon.isValid())
+				emptyPushBeacon = emptyPushBeaconActor(this);
+		}
+
 		vector<Future<Void>> quorumResults;
 		vector<Future<Version>> allReplies;
 		int location = 0;
 		for(auto& it : tLogs) {
 			if(it->isLocal && it->logServers.size()) {
+				// Dispatch the requests in a random order each version so the same log server is not
+				// systematically the last to receive its messages and become the version's straggler
+				vector<int> order(it->logServers.size());
+				for(int loc=0; loc<order.size(); loc++)
+					order[loc] = loc;
+				g_random->randomShuffle(order);
+
 				vector<Future<Void>> tLogCommitResults;
-				for(int loc=0; loc< it->logServers.size(); loc++) {
-					allReplies.push_back( it->logServers[loc]->get().interf().commit.getReply( TLogCommitRequest( data.getArena(), prevVersion, version, knownCommittedVersion, minKnownCommittedVersion, data.getMessages(location), debugID ), TaskTLogCommitReply ) );
+				for(int i=0; i<order.size(); i++) {
+					int loc = order[i];
+					if(coalesceEmpty) {
+						auto& st = pushLocationState[location + loc];
+						if(!data.getMessages(location + loc).size()) {
+							TEST(true); // Empty tlog commit deferred
+							if(st.prevSent == invalidVersion)
+								st.prevSent = prevVersion;
+							st.deferredVersion = version;
+							tLogCommitResults.push_back( whenVersionAcked( st.ackedVersion, version ) );
+							continue;
+						}
+						Version locPrevVersion = st.prevSent == invalidVersion ? prevVersion : st.prevSent;
+						st.prevSent = version;
+						st.deferredVersion = invalidVersion;
+						allReplies.push_back( recordCommitReply( it->logServers[loc]->get().interf().commit.getReply( TLogCommitRequest( data.getArena(), locPrevVersion, version, knownCommittedVersion, minKnownCommittedVersion, data.getMessages(location + loc), debugID, messageChecksum(data.getMessages(location + loc)) ), TaskTLogCommitReply ), st.ackedVersion, version ) );
+					} else {
+						allReplies.push_back( it->logServers[loc]->get().interf().commit.getReply( TLogCommitRequest( data.getArena(), prevVersion, version, knownCommittedVersion, minKnownCommittedVersion, data.getMessages(location + loc), debugID, messageChecksum(data.getMessages(location + loc)) ), TaskTLogCommitReply ) );
+					}
 					Future<Void> commitSuccess = success(allReplies.back());
 					addActor.get().send(commitSuccess);
 					tLogCommitResults.push_back(commitSuccess);
-					location++;
 				}
+				location += it->logServers.size();
 				quorumResults.push_back( quorum( tLogCommitResults, tLogCommitResults.size() - it->tLogWriteAntiQuorum ) );
 			}
 		}
@@ -765,7 +871,7 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 		}
 	}
 
-	virtual Reference<IPeekCursor> peekLogRouter( UID dbgid, Version begin, Tag tag ) {
+	virtual Reference<IPeekCursor> peekLogRouter( UID dbgid, Version begin, Tag tag, bool useMergePeekCursors ) {
 		bool found = false;
 		for( auto& log : tLogs ) {
 			for( auto& router : log->logRouters ) {
@@ -779,7 +885,7 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 			}
 		}
 		if( found ) {
-			if(stopped) {
+			if(stopped || useMergePeekCursors) {
 				std::vector<Reference<LogSet>> localSets;
 				int bestSet = 0;
 				for(auto& log : tLogs) {
@@ -792,9 +898,12 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 					}
 				}
 
-				TraceEvent("TLogPeekLogRouterSets", dbgid).detail("Tag", tag.toString()).detail("Begin", begin);
+				TraceEvent("TLogPeekLogRouterSets", dbgid).detail("Tag", tag.toString()).detail("Begin", begin).detail("UseMergePeekCursors", useMergePeekCursors);
 				//FIXME: do this merge on one of the logs in the other data center to avoid sending multiple copies across the WAN
-				return Reference<ILogSystem::SetPeekCursor>( new ILogSystem::SetPeekCursor( localSets, bestSet, localSets[bestSet]->bestLocationFor( tag ), tag, begin, getPeekEnd(), true ) );
+				// A merge peek for a live epoch does not pin a best server, so any quorum of the set can satisfy the
+				// cursor and a single loaded tlog cannot stall the pull; a stopped epoch keeps the pinned best server
+				// since its data is finite and the merge there is only a fallback for failures
+				return Reference<ILogSystem::SetPeekCursor>( new ILogSystem::SetPeekCursor( localSets, bestSet, stopped ? localSets[bestSet]->bestLocationFor( tag ) : -1, tag, begin, getPeekEnd(), true ) );
 			} else {
 				for( auto& log : tLogs ) {
 					if(log->logServers.size() && log->isLocal && log->locality != tagLocalitySatellite) {
@@ -1470,20 +1579,29 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 				allLockResults.push_back(lockResult);
 			}
 
-			state int lockNum = 0;
 			state Version maxRecoveryVersion = 0;
 			state int maxRecoveryIndex = 0;
-			while(lockNum < allLockResults.size()) {
-				auto versions = TagPartitionedLogSystem::getDurableVersion(dbgid, allLockResults[lockNum]);
-				if(versions.present()) {
-					if(versions.get().second > maxRecoveryVersion) {
-						TraceEvent("HigherRecoveryVersion", dbgid).detail("Idx", lockNum).detail("Ver", versions.get().second);
-						maxRecoveryVersion = versions.get().second;
-						maxRecoveryIndex = lockNum;
+			state int unresolvedGenerations = allLockResults.size();
+			while(unresolvedGenerations > 0) {
+				// Wait on every generation at once instead of one at a time; the lock requests are
+				// already outstanding, so the total wait is the slowest generation rather than the sum
+				std::vector<Future<Void>> changes;
+				unresolvedGenerations = 0;
+				for(int lockNum = 0; lockNum < allLockResults.size(); lockNum++) {
+					auto versions = TagPartitionedLogSystem::getDurableVersion(dbgid, allLockResults[lockNum]);
+					if(versions.present()) {
+						if(versions.get().second > maxRecoveryVersion) {
+							TraceEvent("HigherRecoveryVersion", dbgid).detail("Idx", lockNum).detail("Ver", versions.get().second);
+							maxRecoveryVersion = versions.get().second;
+							maxRecoveryIndex = lockNum;
+						}
+					} else {
+						unresolvedGenerations++;
+						changes.push_back( TagPartitionedLogSystem::getDurableVersionChanged(allLockResults[lockNum]) );
 					}
-					lockNum++;
-				} else {
-					wait( TagPartitionedLogSystem::getDurableVersionChanged(allLockResults[lockNum]) );
+				}
+				if(unresolvedGenerations > 0) {
+					wait( waitForAny(changes) );
 				}
 			}
 			if(maxRecoveryIndex > 0) {
@@ -51,6 +51,7 @@ struct WorkerInterface {
 	RequestStream< struct EventLogRequest > eventLogRequest;
 	RequestStream< struct TraceBatchDumpRequest > traceBatchDumpRequest;
 	RequestStream< struct DiskStoreRequest > diskStoreRequest;
+	RequestStream< struct CounterQueryRequest > counterQuery;
 
 	TesterInterface testerInterface;
 
@@ -62,7 +63,7 @@ struct WorkerInterface {
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		ar & clientInterface & locality & tLog & master & masterProxy & resolver & storage & logRouter & debugPing & coordinationPing & waitFailure & setMetricsRate & eventLogRequest & traceBatchDumpRequest & testerInterface & diskStoreRequest;
+		ar & clientInterface & locality & tLog & master & masterProxy & resolver & storage & logRouter & debugPing & coordinationPing & waitFailure & setMetricsRate & eventLogRequest & traceBatchDumpRequest & testerInterface & diskStoreRequest & counterQuery;
 	}
 };
 
@@ -238,6 +239,55 @@ struct EventLogRequest {
 	}
 };
 
+struct CounterValueRef {
+	StringRef collection;    // CounterCollection name, e.g. "ProxyStats"
+	StringRef id;            // the collection's id (usually the role's UID), may be empty
+	StringRef name;
+	int64_t value;           // cumulative since the role started
+	double rate;             // dValue/dt over the current trace interval, or 0 for gauge-style counters
+
+	CounterValueRef() : value(0), rate(0) {}
+	CounterValueRef( StringRef collection, StringRef id, StringRef name, int64_t value, double rate ) : collection(collection), id(id), name(name), value(value), rate(rate) {}
+	CounterValueRef( Arena& a, CounterValueRef const& c ) : collection(a, c.collection), id(a, c.id), name(a, c.name), value(c.value), rate(c.rate) {}
+
+	size_t expectedSize() const {
+		return collection.expectedSize() + id.expectedSize() + name.expectedSize();
+	}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & collection & id & name & value & rate;
+	}
+};
+
+struct CounterQueryReply {
+	Arena arena;
+	double time;   // when the values were read
+	VectorRef<CounterValueRef> counters;
+
+	CounterQueryReply() : time(0) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & time & counters & arena;
+	}
+};
+
+// Returns the current values of the registered counters on a worker, so that they can be polled
+// at a finer resolution than the trace interval and without parsing logs
+struct CounterQueryRequest {
+	Standalone<StringRef> collectionFilter;   // if non-empty, only collections with this name are returned
+	ReplyPromise< struct CounterQueryReply > reply;
+
+	CounterQueryRequest() {}
+	explicit CounterQueryRequest( Standalone<StringRef> collectionFilter ) : collectionFilter( collectionFilter ) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & collectionFilter & reply;
+	}
+};
+
 struct DebugEntryRef {
 	double time;
 	NetworkAddress address;
@@ -56,6 +56,7 @@
 #include "fdbrpc/Platform.h"
 #include "fdbserver/CoroFlow.h"
 #include "flow/SignalSafeUnwind.h"
+#include "flow/BinaryTraceLogFormatter.h"
 
 #define BOOST_DATE_TIME_NO_LIB
 #include <boost/interprocess/managed_shared_memory.hpp>
@@ -77,7 +78,7 @@
 
 enum {
 	OPT_CONNFILE, OPT_SEEDCONNFILE, OPT_SEEDCONNSTRING, OPT_ROLE, OPT_LISTEN, OPT_PUBLICADDR, OPT_DATAFOLDER, OPT_LOGFOLDER, OPT_PARENTPID, OPT_NEWCONSOLE, OPT_NOBOX, OPT_TESTFILE, OPT_RESTARTING, OPT_RANDOMSEED, OPT_KEY, OPT_MEMLIMIT, OPT_STORAGEMEMLIMIT, OPT_MACHINEID, OPT_DCID, OPT_MACHINE_CLASS, OPT_BUGGIFY, OPT_VERSION, OPT_CRASHONERROR, OPT_HELP, OPT_NETWORKIMPL, OPT_NOBUFSTDOUT, OPT_BUFSTDOUTERR, OPT_TRACECLOCK, OPT_NUMTESTERS, OPT_DEVHELP, OPT_ROLLSIZE, OPT_MAXLOGS, OPT_MAXLOGSSIZE, OPT_KNOB, OPT_TESTSERVERS, OPT_TEST_ON_SERVERS, OPT_METRICSCONNFILE, OPT_METRICSPREFIX,
-	OPT_LOGGROUP, OPT_LOCALITY, OPT_IO_TRUST_SECONDS, OPT_IO_TRUST_WARN_ONLY, OPT_FILESYSTEM, OPT_KVFILE };
+	OPT_LOGGROUP, OPT_LOCALITY, OPT_IO_TRUST_SECONDS, OPT_IO_TRUST_WARN_ONLY, OPT_FILESYSTEM, OPT_KVFILE, OPT_TRACEFILE };
 
 CSimpleOpt::SOption g_rgOptions[] = {
 	{ OPT_CONNFILE,             "-C",                          SO_REQ_SEP },
@@ -110,6 +111,7 @@ CSimpleOpt::SOption g_rgOptions[] = {
 	{ OPT_NOBOX,                "--no_dialog",                 SO_NONE },
 #endif
 	{ OPT_KVFILE,               "--kvfile",                    SO_REQ_SEP },
+	{ OPT_TRACEFILE,            "--tracefile",                 SO_REQ_SEP },
 	{ OPT_TESTFILE,             "-f",                          SO_REQ_SEP },
 	{ OPT_TESTFILE,             "--testfile",                  SO_REQ_SEP },
 	{ OPT_RESTARTING,           "-R",                          SO_NONE },
@@ -570,7 +572,8 @@ static void printUsage( const char *name, bool devhelp ) {
 		printf("  -r ROLE, --role ROLE\n"
 			   "                 Server role (valid options are fdbd, test, multitest,\n");
 		printf("                 simulation, networktestclient, networktestserver, restore\n");
-		printf("                 consistencycheck, kvfileintegritycheck, kvfilegeneratesums). The default is `fdbd'.\n");
+		printf("                 consistencycheck, kvfileintegritycheck, kvfilegeneratesums,\n");
+		printf("                 tracebinarytoxml). The default is `fdbd'.\n");
 #ifdef _WIN32
 		printf("  -n, --newconsole\n"
 			   "                 Create a new console.\n");
@@ -590,6 +593,8 @@ static void printUsage( const char *name, bool devhelp ) {
 			   "                 Memory limit. The default value is 8GiB. When specified\n"
 			   "                 without a unit, MiB is assumed.\n");
 		printf("  --kvfile FILE  Input file (SQLite database file) for use by the 'kvfilegeneratesums' and 'kvfileintegritycheck' roles.\n");
+		printf("  --tracefile FILE\n");
+		printf("                 Input file (binary trace file) for use by the 'tracebinarytoxml' role, which writes XML to standard output.\n");
 		printf("  -M SIZE, --storage_memory SIZE\n"
 			   "                 Maximum amount of memory used for storage. The default\n"
 			   "                 value is 1GiB. When specified without a unit, MB is\n"
@@ -773,7 +778,8 @@ int main(int argc, char* argv[]) {
 			Restore,
 			KVFileIntegrityCheck,
 			KVFileGenerateIOLogChecksums,
-			ConsistencyCheck
+			ConsistencyCheck,
+			ConvertTraceFileToXml
 		};
 		std::string fileSystemPath = "", dataFolder, connFile = "", seedConnFile = "", seedConnString = "", logFolder = ".", metricsConnFile = "", metricsPrefix = "";
 		std::string logGroup = "default";
@@ -782,11 +788,13 @@ int main(int argc, char* argv[]) {
 
 		const char *testFile = "tests/default.txt";
 		std::string kvFile;
+		std::string traceFile;
 		std::string publicAddressStr, listenAddressStr = "public";
 		std::string testServersStr;
 		NetworkAddress publicAddress, listenAddress;
 		const char *targetKey = NULL;
 		uint64_t memLimit = 8LL << 30; // Nice to maintain the same default value for memLimit and SERVER_KNOBS->SERVER_MEM_LIMIT and SERVER_KNOBS->COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT
+		bool memLimitExplicit = false;
 		uint64_t storageMemLimit = 1LL << 30;
 		bool buggifyEnabled = false, machineIdOverride = false, restarting = false;
 		Optional<Standalone<StringRef>> zoneId;
@@ -908,6 +916,7 @@ int main(int argc, char* argv[]) {
 					else if (!strcmp(sRole, "kvfileintegritycheck")) role = KVFileIntegrityCheck;
 					else if (!strcmp(sRole, "kvfilegeneratesums")) role = KVFileGenerateIOLogChecksums;
 					else if (!strcmp(sRole, "consistencycheck")) role = ConsistencyCheck;
+					else if (!strcmp(sRole, "tracebinarytoxml")) role = ConvertTraceFileToXml;
 					else {
 						fprintf(stderr, "ERROR: Unknown role `%s'\n", sRole);
 						printHelpTeaser(argv[0]);
@@ -1040,6 +1049,9 @@ int main(int argc, char* argv[]) {
 				case OPT_KVFILE:
 					kvFile = args.OptionArg();
 					break;
+				case OPT_TRACEFILE:
+					traceFile = args.OptionArg();
+					break;
 				case OPT_RESTARTING:
 					restarting = true;
 					break;
@@ -1081,6 +1093,7 @@ int main(int argc, char* argv[]) {
 						flushAndExit(FDB_EXIT_ERROR);
 					}
 					memLimit = ti.get();
+					memLimitExplicit = true;
 					break;
 				case OPT_STORAGEMEMLIMIT:
 					ti = parse_with_suffix(args.OptionArg(), "MB");
@@ -1175,7 +1188,7 @@ int main(int argc, char* argv[]) {
 		bool autoPublicAddress = StringRef(publicAddressStr).startsWith(LiteralStringRef("auto:"));
 
 		Reference<ClusterConnectionFile> connectionFile;
-		if ( (role != Simulation && role != CreateTemplateDatabase && role != KVFileIntegrityCheck && role != KVFileGenerateIOLogChecksums) || autoPublicAddress ) {
+		if ( (role != Simulation && role != CreateTemplateDatabase && role != KVFileIntegrityCheck && role != KVFileGenerateIOLogChecksums && role != ConvertTraceFileToXml) || autoPublicAddress ) {
 
 				if (seedSpecified && !fileExists(connFile)){
 					std::string connectionString = seedConnString.length() ? seedConnString : "";
@@ -1343,6 +1356,31 @@ int main(int argc, char* argv[]) {
 				throw;
 			}
 		}
+		// Startup memory sizing: when enabled, derive the per-process memory limit and the page
+		// cache size from detected machine RAM instead of the static defaults, so heterogeneous
+		// hosts running an identical config each use the memory they actually have.  Explicitly
+		// set options and knobs always win.
+		if (role == FDBD && (SERVER_KNOBS->AUTO_PROCESS_MEMORY_FRACTION > 0 || SERVER_KNOBS->AUTO_PAGE_CACHE_MEMORY_FRACTION > 0)) {
+			MachineRAMInfo memInfo;
+			getMachineRAMInfo(memInfo);
+			if (memInfo.total > 0) {
+				if (SERVER_KNOBS->AUTO_PROCESS_MEMORY_FRACTION > 0 && !memLimitExplicit) {
+					memLimit = memInfo.total * SERVER_KNOBS->AUTO_PROCESS_MEMORY_FRACTION;
+					if (!serverKnobs->setKnob("commit_batches_mem_bytes_hard_limit", std::to_string(memLimit))) ASSERT(false);
+				}
+				bool pageCacheExplicit = false;
+				for(auto k=knobs.begin(); k!=knobs.end(); ++k)
+					if (k->first == "page_cache_4k")
+						pageCacheExplicit = true;
+				if (SERVER_KNOBS->AUTO_PAGE_CACHE_MEMORY_FRACTION > 0 && !pageCacheExplicit) {
+					if (!flowKnobs->setKnob("page_cache_4k", std::to_string(int64_t(memInfo.total * SERVER_KNOBS->AUTO_PAGE_CACHE_MEMORY_FRACTION)))) ASSERT(false);
+				}
+				TraceEvent("StartupMemorySizing")
+					.detail("MachineTotalRAM", memInfo.total)
+					.detail("MemoryLimit", memLimit)
+					.detail("PageCache4K", FLOW_KNOBS->PAGE_CACHE_4K);
+			}
+		}
 		if (!serverKnobs->setKnob("server_mem_limit", std::to_string(memLimit))) ASSERT(false);
 
 		if (role == SkipListTest) {
@@ -1360,6 +1398,15 @@ int main(int argc, char* argv[]) {
 			flushAndExit(FDB_EXIT_SUCCESS);
 		}
 
+		if (role == ConvertTraceFileToXml) {
+			if (!traceFile.size()) {
+				fprintf(stderr, "ERROR: please specify an input file with --tracefile\n");
+				printHelpTeaser(argv[0]);
+				flushAndExit(FDB_EXIT_ERROR);
+			}
+			flushAndExit(convertTraceFileToXml(traceFile, stdout) ? FDB_EXIT_SUCCESS : FDB_EXIT_ERROR);
+		}
+
 		if (role == SearchMutations && !targetKey) {
 			fprintf(stderr, "ERROR: please specify a target key\n");
 			printHelpTeaser(argv[0]);
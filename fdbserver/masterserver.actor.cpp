@@ -705,14 +705,30 @@ ACTOR Future<Void> sendInitialCommitToResolvers( Reference<MasterData> self ) {
 		((KeyRangeRef&)txnKeys) = KeyRangeRef( keyAfter(data.back().key, txnKeys.arena()), txnKeys.end );
 		Standalone<VectorRef<KeyValueRef>> nextData = self->txnStateStore->readRange(txnKeys, BUGGIFY ? 3 : SERVER_KNOBS->DESIRED_TOTAL_BYTES, SERVER_KNOBS->DESIRED_TOTAL_BYTES).get();
 
-		for(auto& r : self->proxies) {
+		if( SERVER_KNOBS->TXN_STATE_CHAIN_BROADCAST && self->proxies.size() > 1 ) {
+			// Relay each batch proxy-to-proxy instead of sending a copy to every proxy ourselves, so
+			// the master's outbound bandwidth stops scaling with proxy count.  The chain head's reply
+			// means every proxy in the chain has applied the batch, so the completion semantics (and
+			// the hang-until-recovery-restarts behavior if a proxy dies) are unchanged.
 			TxnStateRequest req;
 			req.arena = data.arena();
 			req.data = data;
 			req.sequence = txnSequence;
 			req.last = !nextData.size();
-			txnReplies.push_back( brokenPromiseToNever( r.txnState.getReply( req ) ) );
-			dataOutstanding += data.arena().getSize();
+			for(int i = 1; i < self->proxies.size(); i++)
+				req.forward.push_back( self->proxies[i].txnState );
+			txnReplies.push_back( brokenPromiseToNever( self->proxies[0].txnState.getReply( req ) ) );
+			dataOutstanding += data.arena().getSize() * self->proxies.size();
+		} else {
+			for(auto& r : self->proxies) {
+				TxnStateRequest req;
+				req.arena = data.arena();
+				req.data = data;
+				req.sequence = txnSequence;
+				req.last = !nextData.size();
+				txnReplies.push_back( brokenPromiseToNever( r.txnState.getReply( req ) ) );
+				dataOutstanding += data.arena().getSize();
+			}
 		}
 		data = nextData;
 		txnSequence++;
@@ -980,7 +996,11 @@ ACTOR Future<Void> resolutionBalancing(Reference<MasterData> self) {
 			metrics.insert(std::make_pair(futures[i].get(), i), NoMetric());
 			//TraceEvent("ResolverMetric").detail("I", i).detail("Metric", futures[i].get());
 		}
-		if( metrics.lastItem()->first - metrics.begin()->first > SERVER_KNOBS->MIN_BALANCE_DIFFERENCE ) {
+		// Move ranges when the spread is large in absolute terms and relative to the total load, so a
+		// lightly loaded cluster doesn't shuffle ranges over sampling noise and a heavily loaded one
+		// doesn't churn over a small fractional imbalance
+		int64_t spread = metrics.lastItem()->first - metrics.begin()->first;
+		if( spread > std::max<int64_t>( SERVER_KNOBS->MIN_BALANCE_DIFFERENCE, SERVER_KNOBS->MIN_BALANCE_RATIO * total ) ) {
 			try {
 				state int src = metrics.lastItem()->second;
 				state int dest = metrics.begin()->second;
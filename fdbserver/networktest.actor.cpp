@@ -19,6 +19,8 @@
  */
 
 #include "fdbserver/NetworkTest.h"
+#include "fdbserver/Knobs.h"
+#include "flow/Histogram.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
 UID WLTOKEN_NETWORKTEST( -1, 2 );
@@ -56,23 +58,25 @@ ACTOR Future<Void> networkTestServer() {
 	}
 }
 
-ACTOR Future<Void> testClient( std::vector<NetworkTestInterface> interfs, int* sent ) {
-	state double lastTime = now();
-
+ACTOR Future<Void> testClient( std::vector<NetworkTestInterface> interfs, Key payload, int* sent, LogHistogram* latency ) {
 	loop {
-		NetworkTestReply rep = wait(  retryBrokenPromise(interfs[g_random->randomInt(0, interfs.size())].test, NetworkTestRequest( LiteralStringRef("."), 600000 ) ) );
+		state double start = timer_monotonic();
+		NetworkTestReply rep = wait(  retryBrokenPromise(interfs[g_random->randomInt(0, interfs.size())].test, NetworkTestRequest( payload, SERVER_KNOBS->NETWORK_TEST_REPLY_SIZE ) ) );
+		latency->addSample( timer_monotonic() - start );
 		(*sent)++;
 	}
 }
 
-ACTOR Future<Void> logger( int* sent ) {
+ACTOR Future<Void> logger( int* sent, LogHistogram* latency ) {
 	state double lastTime = now();
 	loop {
 		wait( delay(1.0) );
 		auto spd = *sent / (now() - lastTime);
-		fprintf( stderr, "messages per second: %f\n", spd);
+		fprintf( stderr, "messages per second: %f  latency us: median %0.1f  p99 %0.1f  p999 %0.1f  max %0.1f\n",
+			spd, latency->median()*1e6, latency->percentile(0.99)*1e6, latency->percentile(0.999)*1e6, latency->max()*1e6 );
 		lastTime = now();
 		*sent = 0;
+		latency->clear();
 	}
 }
 
@@ -144,15 +148,22 @@ ACTOR Future<Void> networkTestClient( std:: string testServers ) {
 	state std::vector<NetworkTestInterface> interfs;
 	state std::vector<NetworkAddress> servers = NetworkAddress::parseList(testServers);
 	state int sent = 0;
+	state LogHistogram latency;
 
 	for( int i = 0; i < servers.size(); i++ ) {
 		interfs.push_back( NetworkTestInterface( servers[i] ) );
 	}
 
+	// The client count is the pipelining depth: every client keeps one request outstanding.
+	// Request and reply sizes are knobs, so a single pair of processes can drive either
+	// direction, or both at once, at saturation:
+	//   fdbserver -r networktestserver
+	//   fdbserver -r networktestclient --knob_network_test_request_size 600000 ...
+	state Key payload( std::string( SERVER_KNOBS->NETWORK_TEST_REQUEST_SIZE, '.' ) );
 	state std::vector<Future<Void>> clients;
-	for( int i = 0; i < 30; i++ )
-		clients.push_back( testClient( interfs, &sent ) );
-	clients.push_back( logger( &sent ) );
+	for( int i = 0; i < SERVER_KNOBS->NETWORK_TEST_CLIENT_COUNT; i++ )
+		clients.push_back( testClient( interfs, payload, &sent, &latency ) );
+	clients.push_back( logger( &sent, &latency ) );
 
 	wait( waitForAll( clients ) );
 	return Void();
@@ -19,6 +19,8 @@
  */
 
 
+#include <set>
+
 #include "fdbrpc/fdbrpc.h"
 #include "fdbrpc/LoadBalance.h"
 #include "flow/IndexedSet.h"
@@ -38,6 +40,7 @@
 #include "fdbserver/Knobs.h"
 #include "fdbserver/WaitFailure.h"
 #include "fdbserver/IKeyValueStore.h"
+#include "fdbserver/BloomFilter.h"
 #include "fdbclient/VersionedMap.h"
 #include "fdbserver/StorageMetrics.h"
 #include "fdbrpc/sim_validation.h"
@@ -62,6 +65,7 @@ inline bool canReplyWith(Error e) {
 		case error_code_future_version:
 		case error_code_wrong_shard_server:
 		case error_code_process_behind:
+		case error_code_server_overloaded:
 		//case error_code_all_alternatives_failed:
 			return true;
 		default:
@@ -78,13 +82,29 @@ public:
 	bool isValue() const { return !isClear; };
 	bool isClearTo() const { return isClear; }
 
-	ValueRef const& getValue() const { ASSERT( isValue() ); return item; };
+	// An inline value is returned as a reference into this entry, valid only while the entry is
+	ValueRef getValue() const { ASSERT( isValue() ); return inlineLength >= 0 ? ValueRef( inlineItem, inlineLength ) : item; };
 	KeyRef const&  getEndKey() const { ASSERT(isClearTo()); return item; };
 
 private:
-	ValueOrClearToRef( StringRef item, bool isClear ) : item(item), isClear(isClear) {}
+	ValueOrClearToRef( StringRef item, bool isClear ) : item(item), inlineLength(-1), isClear(isClear) {
+		if (!isClear && item.size() <= INLINE_ITEM_BYTES) {
+			inlineLength = item.size();
+			memcpy( inlineItem, item.begin(), item.size() );
+		}
+	}
 
-	StringRef item;
+	// Values of up to INLINE_ITEM_BYTES (e.g. counters) are copied into the entry itself instead of
+	// referencing the version arena, saving a dereference on every read of a recently written small
+	// value.  The inline buffer overlays the StringRef, so the entry (and therefore the PTree node
+	// holding it) is no bigger than before.  Clear end keys are never stored inline: expandMutation
+	// and removeDataRange keep references from getEndKey() across map updates.
+	enum { INLINE_ITEM_BYTES = 16 };
+	union {
+		StringRef item;
+		uint8_t inlineItem[INLINE_ITEM_BYTES];
+	};
+	int8_t inlineLength;  // length of the inline value, or -1 if item is a reference
 	bool isClear;
 };
 
@@ -167,7 +187,8 @@ struct StorageServerDisk {
 	void changeLogProtocol(Version version, uint64_t protocol);
 
 	void writeMutation( MutationRef mutation );
-	void writeKeyValue( KeyValueRef kv );
+	void writeKeyValue( KeyValueRef kv, const Arena* arena = NULL );
+	void writeSortedRun( VectorRef<KeyValueRef> kvs, const Arena* arena = NULL );
 	void clearRange( KeyRangeRef keys );
 
 	Future<Void> getError() { return storage->getError(); }
@@ -203,6 +224,12 @@ struct UpdateEagerReadInfo {
 	vector<pair<KeyRef, int>> keys;
 	vector<Optional<Value>> value;
 
+	// The key and value written by the most recently expanded mutation in this update batch, so
+	// that a run of atomic ops on the same key (e.g. a hot counter) does not search the versioned
+	// map for the value that the previous mutation just wrote.  Cleared by any ClearRange.
+	KeyRef lastExpandedKey;
+	Optional<ValueRef> lastExpandedValue;
+
 	void addMutations( VectorRef<MutationRef> const& mutations ) {
 		for(auto& m : mutations)
 			addMutation(m);
@@ -248,6 +275,16 @@ struct FetchInjectionInfo {
 	vector<VerUpdateRef> changes;
 };
 
+// All watch requests for the same key and value share one actor waiting for the value to change and
+// one entry of watch memory budget, so the number of outstanding watches does not multiply actor
+// overhead on the storage server
+struct SharedWatchInfo : ReferenceCounted<SharedWatchInfo> {
+	Future<Version> change;
+	int watchers;
+
+	SharedWatchInfo() : watchers(0) {}
+};
+
 struct StorageServer {
 	typedef VersionedMap<KeyRef, ValueOrClearToRef> VersionedData;
 
@@ -284,6 +321,50 @@ public:
 	std::map<Version, Arena> freeable;  // for each version, an Arena that must be held until that version is < oldestVersion
 	Arena lastArena;
 
+	// Deduplicated storage for keys that are set repeatedly within the MVCC window, so a hot key
+	// contributes one copy of its bytes rather than one per version entry.  Each version's arena
+	// takes a dependency on the interned bytes, so their lifetime is protected by the same
+	// freeable mechanism as the per-version arenas; the table itself holds only one extra
+	// reference and can therefore evict entries at any time.
+	std::map<StringRef, std::pair<Standalone<StringRef>, Version>> internedKeys;
+	int64_t internedKeyBytes;
+	Key internedKeySweepPosition;
+
+	// Returns a reference to a shared copy of key, kept alive (at least) as long as arena
+	KeyRef internKey( KeyRef key, Arena& arena, Version ver ) {
+		if (!SERVER_KNOBS->STORAGE_KEY_INTERN_MAX_BYTES) return key;
+		auto i = internedKeys.find( key );
+		if (i == internedKeys.end()) {
+			if (internedKeyBytes + key.size() > SERVER_KNOBS->STORAGE_KEY_INTERN_MAX_BYTES)
+				return key;
+			Standalone<StringRef> k( key );
+			i = internedKeys.insert( std::make_pair( (StringRef)k, std::make_pair( k, ver ) ) ).first;
+			internedKeyBytes += key.size();
+		}
+		i->second.second = ver;
+		arena.dependsOn( i->second.first.arena() );
+		return i->second.first;
+	}
+
+	// Evicts a bounded number of interned keys that haven't been set since before the given
+	// version.  Dropping an entry only releases the table's reference; versions still
+	// referencing the bytes keep them alive through their arenas.
+	void evictInternedKeys( Version before ) {
+		auto i = internedKeys.lower_bound( internedKeySweepPosition );
+		for(int n = 0; n < 100; n++) {
+			if (i == internedKeys.end()) {
+				internedKeySweepPosition = Key();
+				return;
+			}
+			if (i->second.second < before) {
+				internedKeyBytes -= i->first.size();
+				i = internedKeys.erase(i);
+			} else
+				++i;
+		}
+		internedKeySweepPosition = i == internedKeys.end() ? Key() : Key( i->first );
+	}
+
 	std::map<Version, Standalone<VersionUpdateRef>> const & getMutationLog() { return mutationLog; }
 	std::map<Version, Standalone<VersionUpdateRef>>& getMutableMutationLog() { return mutationLog; }
 	VersionedData const& data() const { return versionedData; }
@@ -338,9 +419,24 @@ public:
 	}
 
 	MutationRef addMutationToMutationLog(Standalone<VersionUpdateRef> &mLV, MutationRef const& m){
-		byteSampleApplyMutation(m, mLV.version);
 		counters.bytesInput += mvccStorageBytes(m);
-		return mLV.mutations.push_back_deep( mLV.arena(), m );
+		MutationRef result = mLV.mutations.push_back_deep( mLV.arena(), m );
+		// Byte sample maintenance is deferred to applyDeferredByteSampleUpdates() so the sampling and
+		// metric notification work stays off the mutation apply path; result is backed by the mutation
+		// log arena, which outlives the queue entry
+		deferredByteSampleUpdates.push_back( std::make_pair( mLV.version, result ) );
+		return result;
+	}
+
+	// Processes deferred byte sample maintenance in order.  Called at TaskUpdateStorage priority at the
+	// start of each updateStorage batch, before any queued version's mutation log entry can be drained
+	// or freed, and before any direct (ver==invalidVersion) byte sample update so ordering is preserved
+	void applyDeferredByteSampleUpdates() {
+		while (deferredByteSampleUpdates.size()) {
+			auto u = deferredByteSampleUpdates.front();
+			deferredByteSampleUpdates.pop_front();
+			byteSampleApplyMutation( u.second, u.first );
+		}
 	}
 
 	StorageServerDisk storage;
@@ -348,6 +444,104 @@ public:
 	KeyRangeMap< Reference<ShardInfo> > shards;
 	uint64_t shardChangeCounter;      // max( shards->changecounter )
 
+	// Bloom filters over the durable keys of shards fetched by this server, used to answer point
+	// reads of absent keys without reading the disk.  A null filter means reads of that range must
+	// go to disk; in particular no filters exist for shards that were already durable at reboot.
+	// A filter is created when fetchKeys is about to start writing a durably empty range, so it
+	// covers every key that subsequently becomes durable in the range.
+	KeyRangeMap< Reference<BlockedBloomFilter> > bloomFilters;
+
+	void bloomFilterInsert( KeyRef key ) {
+		auto r = bloomFilters.rangeContaining( key );
+		if (r->value()) {
+			r->value()->insert( key );
+			if (r->value()->full()) {
+				KeyRange dropped = r->range();  // deep copy: insert() frees the nodes the iterator's range aliases
+				bloomFilters.insert( dropped, Reference<BlockedBloomFilter>() );
+			}
+		}
+	}
+
+	// Bounded cache of recently read durable values, consulted by point reads before dispatching
+	// to the storage engine.  An entry only exists while the versioned data has no entry covering
+	// its key (inserts are skipped otherwise, and applying a mutation invalidates its keys), so a
+	// hit is exactly what the engine would have returned for any readable version.
+	struct HotValueCache {
+		std::map<StringRef, std::pair<Key, Value>> entries;  // map keys point into the Keys held in the values
+		Deque<Key> insertOrder;  // FIFO eviction; entries already erased by invalidation are skipped
+		int64_t bytes;
+		uint64_t invalidations;  // incremented by every invalidation, so in-flight engine reads can detect racing mutations
+
+		HotValueCache() : bytes(0), invalidations(0) {}
+
+		Optional<Value> get( KeyRef key ) const {
+			auto i = entries.find( key );
+			if (i == entries.end()) return Optional<Value>();
+			return i->second.second;
+		}
+
+		void insert( Key const& key, Value const& value, int64_t maxBytes ) {
+			if (key.size() + value.size() > maxBytes || entries.count( key )) return;
+			entries[ key ] = std::make_pair( key, value );
+			insertOrder.push_back( key );
+			bytes += key.size() + value.size();
+			while (bytes > maxBytes && insertOrder.size()) {
+				auto i = entries.find( insertOrder.front() );
+				if (i != entries.end()) {
+					bytes -= i->first.size() + i->second.second.size();
+					entries.erase(i);
+				}
+				insertOrder.pop_front();
+			}
+		}
+
+		void invalidate( KeyRef key ) {
+			++invalidations;
+			auto i = entries.find( key );
+			if (i != entries.end()) {
+				bytes -= i->first.size() + i->second.second.size();
+				entries.erase(i);
+			}
+			compactInsertOrder();
+		}
+
+		void invalidate( KeyRangeRef range ) {
+			++invalidations;
+			auto i = entries.lower_bound( range.begin );
+			while (i != entries.end() && i->first < range.end) {
+				bytes -= i->first.size() + i->second.second.size();
+				i = entries.erase(i);
+			}
+			compactInsertOrder();
+		}
+
+		// Invalidation leaves a key's insertOrder entry behind to be skipped lazily by eviction,
+		// but eviction only runs while bytes exceeds the cap, so a read-populate/invalidate cycle
+		// over a small key set would otherwise grow insertOrder without bound.  Once stale entries
+		// dominate, rebuild it; keeping only the first surviving occurrence of each live key
+		// preserves FIFO eviction order, and the O(live) rebuild is amortized by the growth needed
+		// to trigger it.
+		void compactInsertOrder() {
+			if (insertOrder.size() <= 128 || insertOrder.size() <= 4 * int64_t(entries.size())) return;
+			Deque<Key> compacted;
+			std::set<StringRef> seen;
+			for(int i = 0; i < insertOrder.size(); i++) {
+				Key const& k = insertOrder[i];
+				if (entries.count( k ) && seen.insert( k ).second)
+					compacted.push_back( k );
+			}
+			insertOrder = std::move(compacted);
+		}
+
+		void clear() {
+			++invalidations;
+			entries.clear();
+			insertOrder.clear();
+			bytes = 0;
+		}
+	};
+	HotValueCache hotValueCache;
+
 	// newestAvailableVersion[k]
 	//   == invalidVersion -> k is unavailable at all versions
 	//   <= storageVersion -> k is unavailable at all versions (but might be read anyway from storage if we are in the process of committing makeShardDurable)
@@ -382,9 +576,11 @@ public:
 	CoalescedKeyRangeMap<bool, int64_t, KeyBytesMetric<int64_t>> byteSampleClears;
 	AsyncVar<bool> byteSampleClearsTooLarge;
 	Future<Void> byteSampleRecovery;
+	Deque< std::pair<Version, MutationRef> > deferredByteSampleUpdates;  // logged mutations not yet applied to the byte sample, in log order
 	Future<Void> durableInProgress;
 
 	AsyncMap<Key,bool> watches;
+	std::map<std::pair<Key,Optional<Value>>, Reference<SharedWatchInfo>> sharedWatches;
 	int64_t watchBytes;
 	int64_t numWatches;
 	AsyncVar<bool> noRecentUpdates;
@@ -421,7 +617,9 @@ public:
 
 	struct Counters {
 		CounterCollection cc;
-		Counter allQueries, getKeyQueries, getValueQueries, getRangeQueries, finishedQueries, rowsQueried, bytesQueried, watchQueries;
+		Counter allQueries, getKeyQueries, getValueQueries, getRangeQueries, finishedQueries, lowPriorityQueries, rowsQueried, bytesQueried, watchQueries;
+		Counter bloomFilterNegatives;  // Point reads answered from a shard's bloom filter without reading the disk
+		Counter hotValueCacheHits, hotValueCacheMisses;  // Point reads answered from / missing the hot value cache
 		Counter bytesInput, bytesDurable, bytesFetched,
 			mutationBytes;  // Like bytesInput but without MVCC accounting
 		Counter mutations, setMutations, clearRangeMutations, atomicMutations;
@@ -436,9 +634,13 @@ public:
 			getRangeQueries("GetRangeQueries", cc),
 			allQueries("QueryQueue", cc),
 			finishedQueries("FinishedQueries", cc),
+			lowPriorityQueries("LowPriorityQueries", cc),
 			rowsQueried("RowsQueried", cc),
 			bytesQueried("BytesQueried", cc),
 			watchQueries("WatchQueries", cc),
+			bloomFilterNegatives("BloomFilterNegatives", cc),
+			hotValueCacheHits("HotValueCacheHits", cc),
+			hotValueCacheMisses("HotValueCacheMisses", cc),
 			bytesInput("BytesInput", cc),
 			bytesDurable("BytesDurable", cc),
 			bytesFetched("BytesFetched", cc),
@@ -470,6 +672,8 @@ public:
 			specialCounter(cc, "BytesStored", [self](){ return self->metrics.byteSample.getEstimate(allKeys); });
 			specialCounter(cc, "ActiveWatches", [self](){ return self->numWatches; });
 			specialCounter(cc, "WatchBytes", [self](){ return self->watchBytes; });
+			specialCounter(cc, "InternedKeyBytes", [self](){ return self->internedKeyBytes; });
+			specialCounter(cc, "HotValueCacheBytes", [self](){ return self->hotValueCache.bytes; });
 
 			specialCounter(cc, "KvstoreBytesUsed", [self](){ return self->storage.getStorageBytes().used; });
 			specialCounter(cc, "KvstoreBytesFree", [self](){ return self->storage.getStorageBytes().free; });
@@ -492,7 +696,7 @@ public:
 			logProtocol(0), counters(this), tag(invalidTag), maxQueryQueue(0), thisServerID(ssi.id()),
 			readQueueSizeMetric(LiteralStringRef("StorageServer.ReadQueueSize")),
 			behind(false), byteSampleClears(false, LiteralStringRef("\xff\xff\xff")), noRecentUpdates(false),
-			lastUpdate(now()), poppedAllAfter(std::numeric_limits<Version>::max())
+			lastUpdate(now()), poppedAllAfter(std::numeric_limits<Version>::max()), internedKeyBytes(0)
 	{
 		version.initMetric(LiteralStringRef("StorageServer.Version"), counters.cc.id);
 		oldestVersion.initMetric(LiteralStringRef("StorageServer.OldestVersion"), counters.cc.id);
@@ -567,8 +771,21 @@ public:
 		return counters.bytesInput.getValue() - counters.bytesDurable.getValue();
 	}
 
+	// The penalty is this server's self-reported busyness, measured in equivalent outstanding
+	// requests; it multiplies into the client's queue model so loaded replicas lose reads to their
+	// teammates immediately instead of after seconds of observed latency.  Beyond the durability
+	// queue it reflects the read queue depth and how far behind the tlogs this server is running.
 	double getPenalty() {
-		 return std::max(1.0, (queueSize() - (SERVER_KNOBS->TARGET_BYTES_PER_STORAGE_SERVER - 2*SERVER_KNOBS->SPRING_BYTES_STORAGE_SERVER)) / SERVER_KNOBS->SPRING_BYTES_STORAGE_SERVER);
+		double penalty = (queueSize() - (SERVER_KNOBS->TARGET_BYTES_PER_STORAGE_SERVER - 2*SERVER_KNOBS->SPRING_BYTES_STORAGE_SERVER)) / SERVER_KNOBS->SPRING_BYTES_STORAGE_SERVER;
+		penalty = std::max( penalty, readQueueSizeMetric.getValue() / (double)SERVER_KNOBS->STORAGE_PENALTY_READ_QUEUE_DEPTH );
+		penalty = std::max( penalty, versionLag / (double)SERVER_KNOBS->STORAGE_PENALTY_VERSION_LAG );
+		return std::max(1.0, penalty);
+	}
+
+	// A read rejected here costs the client one cheap round trip to fail over to another replica,
+	// versus timing out at the end of a queue we already know is too long
+	bool shouldShedRead() {
+		return SERVER_KNOBS->STORAGE_SHED_READ_QUEUE_DEPTH > 0 && readQueueSizeMetric.getValue() > SERVER_KNOBS->STORAGE_SHED_READ_QUEUE_DEPTH;
 	}
 };
 
@@ -669,6 +886,13 @@ void validate(StorageServer* data, bool force = false) {
 #pragma region Queries
 ACTOR Future<Version> waitForVersion( StorageServer* data, Version version ) {
 	// This could become an Actor transparently, but for now it just does the lookup
+	if (version == replicaDurableVersion) {
+		// Answer at oldestVersion (storageVersion), the oldest version the invariants guarantee
+		// readable; durableVersion can trail it (e.g. while fetchKeys ingest advances oldestVersion
+		// ahead of the engine commit), and versions below oldestVersion have had their in-memory
+		// MVCC roots discarded.  There is still never a wait.
+		return std::max(Version(1), data->oldestVersion.get());
+	}
 	if (version == latestVersion)
 		version = std::max(Version(1), data->version.get());
 	if (version < data->oldestVersion.get() || version <= 0) throw transaction_too_old();
@@ -701,6 +925,8 @@ ACTOR Future<Version> waitForVersion( StorageServer* data, Version version ) {
 
 ACTOR Future<Version> waitForVersionNoTooOld( StorageServer* data, Version version ) {
 	// This could become an Actor transparently, but for now it just does the lookup
+	if (version == replicaDurableVersion)
+		return std::max(Version(1), data->oldestVersion.get());  // see waitForVersion
 	if (version == latestVersion)
 		version = std::max(Version(1), data->version.get());
 	if (version <= data->version.get())
@@ -730,6 +956,11 @@ ACTOR Future<Void> getValueQ( StorageServer* data, GetValueRequest req ) {
 		++data->readQueueSizeMetric;
 		data->maxQueryQueue = std::max<int>( data->maxQueryQueue, data->counters.allQueries.getValue() - data->counters.finishedQueries.getValue());
 
+		if( data->shouldShedRead() ) {
+			TEST(true); // getValue shed for load
+			throw server_overloaded();
+		}
+
 		wait( delay(0, TaskDefaultEndpoint) );
 
 		if( req.debugID.present() )
@@ -753,19 +984,47 @@ ACTOR Future<Void> getValueQ( StorageServer* data, GetValueRequest req ) {
 			v = (Value)i->getValue();
 			path = 1;
 		} else if (!i || !i->isClearTo() || i->getEndKey() <= req.key) {
-			path = 2;
-			Optional<Value> vv = wait( data->storage.readValue( req.key, req.debugID ) );
-			// Validate that while we were reading the data we didn't lose the version or shard
-			if (version < data->storageVersion()) {
-				TEST(true); // transaction_too_old after readValue
-				throw transaction_too_old();
+			auto& bloom = data->bloomFilters[req.key];
+			if (bloom && !bloom->maybeContains(req.key)) {
+				// The filter covers every durable key in this shard, so the key cannot be on disk
+				TEST(true); // bloom filter negative on point read
+				++data->counters.bloomFilterNegatives;
+				path = 3;
+			} else if (SERVER_KNOBS->STORAGE_HOT_VALUE_CACHE_BYTES > 0 && data->hotValueCache.get(req.key).present()) {
+				// There have been no waits since waitForVersion returned, so the cache still reflects every
+				// applied mutation and an entry here is what the engine read below would return
+				TEST(true); // hot value cache hit on point read
+				++data->counters.hotValueCacheHits;
+				v = data->hotValueCache.get(req.key);
+				path = 4;
+			} else {
+				path = 2;
+				if (SERVER_KNOBS->STORAGE_HOT_VALUE_CACHE_BYTES > 0)
+					++data->counters.hotValueCacheMisses;
+				state uint64_t cacheInvalidations = data->hotValueCache.invalidations;
+				Optional<Value> vv = wait( data->storage.readValue( req.key, req.debugID ) );
+				// Validate that while we were reading the data we didn't lose the version or shard
+				if (version < data->storageVersion()) {
+					TEST(true); // transaction_too_old after readValue
+					throw transaction_too_old();
+				}
+				data->checkChangeCounter(changeCounter, req.key);
+				v = vv;
+				if (SERVER_KNOBS->STORAGE_HOT_VALUE_CACHE_BYTES > 0 && vv.present() &&
+					cacheInvalidations == data->hotValueCache.invalidations) {
+					// Only cache if the latest versioned data has nothing covering this key: an entry there
+					// means a mutation is still in the MVCC window, and once it becomes durable the value we
+					// just read would be stale
+					auto latest = data->data().atLatest().lastLessOrEqual(req.key);
+					if (!latest || !(( latest->isValue() && latest.key() == req.key ) ||
+									 ( latest->isClearTo() && latest->getEndKey() > req.key )))
+						data->hotValueCache.insert( req.key, vv.get(), SERVER_KNOBS->STORAGE_HOT_VALUE_CACHE_BYTES );
+				}
 			}
-			data->checkChangeCounter(changeCounter, req.key);
-			v = vv;
 		}
 
 		debugMutation("ShardGetValue", version, MutationRef(MutationRef::DebugKey, req.key, v.present()?v.get():LiteralStringRef("<null>")));
-		debugMutation("ShardGetPath", version, MutationRef(MutationRef::DebugKey, req.key, path==0?LiteralStringRef("0"):path==1?LiteralStringRef("1"):LiteralStringRef("2")));
+		debugMutation("ShardGetPath", version, MutationRef(MutationRef::DebugKey, req.key, path==0?LiteralStringRef("0"):path==1?LiteralStringRef("1"):path==2?LiteralStringRef("2"):path==3?LiteralStringRef("3"):LiteralStringRef("4")));
 
 		/*
 		StorageMetrics m;
@@ -783,7 +1042,9 @@ ACTOR Future<Void> getValueQ( StorageServer* data, GetValueRequest req ) {
 			g_traceBatch.addEvent("GetValueDebug", req.debugID.get().first(), "getValueQ.AfterRead"); //.detail("TaskID", g_network->getCurrentTask());
 
 		GetValueReply reply(v);
+		reply.version = version;
 		reply.penalty = data->getPenalty();
+		reply.replicaVersion = data->version.get();
 		req.reply.send(reply);
 	} catch (Error& e) {
 		if(!canReplyWith(e))
@@ -797,7 +1058,47 @@ ACTOR Future<Void> getValueQ( StorageServer* data, GetValueRequest req ) {
 	return Void();
 };
 
+ACTOR Future<Version> watchWaitForValueChange( StorageServer* data, Key key, Optional<Value> expectedValue, Optional<UID> debugID ) {
+	loop {
+		try {
+			state Version latest = data->data().latestVersion;
+			state Future<Void> watchFuture = data->watches.onChange(key);
+			GetValueRequest getReq( key, latest, debugID );
+			state Future<Void> getValue = getValueQ( data, getReq ); //we are relying on the delay zero at the top of getValueQ, if removed we need one here
+			GetValueReply reply = wait( getReq.reply.getFuture() );
+			//TraceEvent("WatcherCheckValue").detail("Key", printable( key ) ).detail("Value", printable( expectedValue ) ).detail("CurrentValue", printable( v ) ).detail("Ver", latest);
+
+			debugMutation("ShardWatchValue", latest, MutationRef(MutationRef::DebugKey, key, reply.value.present() ? StringRef( reply.value.get() ) : LiteralStringRef("<null>") ) );
+
+			if( reply.value != expectedValue )
+				return latest;
+
+			if( data->watchBytes > SERVER_KNOBS->MAX_STORAGE_SERVER_WATCH_BYTES ) {
+				TEST(true); //Too many watches, reverting to polling
+				throw watch_cancelled();
+			}
+
+			++data->numWatches;
+			data->watchBytes += ( key.expectedSize() + expectedValue.expectedSize() + 1000 );
+			try {
+				wait( watchFuture );
+				--data->numWatches;
+				data->watchBytes -= ( key.expectedSize() + expectedValue.expectedSize() + 1000 );
+			} catch( Error &e ) {
+				--data->numWatches;
+				data->watchBytes -= ( key.expectedSize() + expectedValue.expectedSize() + 1000 );
+				throw;
+			}
+		} catch( Error &e ) {
+			if( e.code() != error_code_transaction_too_old )
+				throw;
+		}
+	}
+}
+
 ACTOR Future<Void> watchValue_impl( StorageServer* data, WatchValueRequest req ) {
+	state std::pair<Key,Optional<Value>> mapKey = std::make_pair(req.key, req.value);
+	state Reference<SharedWatchInfo> shared;
 	try {
 		++data->counters.watchQueries;
 
@@ -808,49 +1109,37 @@ ACTOR Future<Void> watchValue_impl( StorageServer* data, WatchValueRequest req )
 		if( req.debugID.present() )
 			g_traceBatch.addEvent("WatchValueDebug", req.debugID.get().first(), "watchValueQ.AfterVersion"); //.detail("TaskID", g_network->getCurrentTask());
 
-		loop {
-			try {
-				state Version latest = data->data().latestVersion;
-				state Future<Void> watchFuture = data->watches.onChange(req.key);
-				GetValueRequest getReq( req.key, latest, req.debugID );
-				state Future<Void> getValue = getValueQ( data, getReq ); //we are relying on the delay zero at the top of getValueQ, if removed we need one here
-				GetValueReply reply = wait( getReq.reply.getFuture() );
-				//TraceEvent("WatcherCheckValue").detail("Key", printable( req.key ) ).detail("Value", printable( req.value ) ).detail("CurrentValue", printable( v ) ).detail("Ver", latest);
-
-				debugMutation("ShardWatchValue", latest, MutationRef(MutationRef::DebugKey, req.key, reply.value.present() ? StringRef( reply.value.get() ) : LiteralStringRef("<null>") ) );
-
-				if( req.debugID.present() )
-					g_traceBatch.addEvent("WatchValueDebug", req.debugID.get().first(), "watchValueQ.AfterRead"); //.detail("TaskID", g_network->getCurrentTask());
-
-				if( reply.value != req.value ) {
-					req.reply.send( latest );
-					return Void();
-				}
-
-				if( data->watchBytes > SERVER_KNOBS->MAX_STORAGE_SERVER_WATCH_BYTES ) {
-					TEST(true); //Too many watches, reverting to polling
-					req.reply.sendError( watch_cancelled() );
-					return Void();
-				}
-
-				++data->numWatches;
-				data->watchBytes += ( req.key.expectedSize() + req.value.expectedSize() + 1000 );
-				try {
-					wait( watchFuture );
-					--data->numWatches;
-					data->watchBytes -= ( req.key.expectedSize() + req.value.expectedSize() + 1000 );
-				} catch( Error &e ) {
-					--data->numWatches;
-					data->watchBytes -= ( req.key.expectedSize() + req.value.expectedSize() + 1000 );
-					throw;
-				}
-			} catch( Error &e ) {
-				if( e.code() != error_code_transaction_too_old )
-					throw;
+		auto it = data->sharedWatches.find(mapKey);
+		if( it != data->sharedWatches.end() ) {
+			shared = it->second;
+		} else {
+			shared = Reference<SharedWatchInfo>( new SharedWatchInfo() );
+			shared->change = watchWaitForValueChange( data, req.key, req.value, req.debugID );
+			data->sharedWatches[mapKey] = shared;
+		}
+		++shared->watchers;
+		try {
+			state Version changed = wait( shared->change );
+			if( req.debugID.present() )
+				g_traceBatch.addEvent("WatchValueDebug", req.debugID.get().first(), "watchValueQ.AfterRead"); //.detail("TaskID", g_network->getCurrentTask());
+
+			// The value has changed, so the next request for this key and value must check it again
+			--shared->watchers;
+			auto fired = data->sharedWatches.find(mapKey);
+			if( fired != data->sharedWatches.end() && fired->second == shared )
+				data->sharedWatches.erase(fired);
+
+			req.reply.send( changed );
+		} catch( Error &e ) {
+			if( --shared->watchers == 0 ) {
+				auto cancelled = data->sharedWatches.find(mapKey);
+				if( cancelled != data->sharedWatches.end() && cancelled->second == shared )
+					data->sharedWatches.erase(cancelled);
 			}
+			throw;
 		}
 	} catch (Error& e) {
-		if(!canReplyWith(e))
+		if(!canReplyWith(e) && e.code() != error_code_watch_cancelled)
 			throw;
 		req.reply.sendError(e);
 	}
@@ -925,6 +1214,7 @@ void merge( Arena& arena, VectorRef<KeyValueRef>& output, VectorRef<KeyValueRef>
 			int versionedDataCount, int limit, bool stopAtEndOfBase, int limitBytes = 1<<30 )
 // Combines data from base (at an older version) with sets from newer versions in [start, end) and appends the first (up to) |limit| rows to output
 // If limit<0, base and output are in descending order, and start->key()>end->key(), but start is still inclusive and end is exclusive
+// Rows from base are referenced, not copied; the caller must add base's backing arena as a dependency of arena
 {
 	if (limit==0) return;
 	int originalLimit = abs(limit) + output.size();
@@ -936,7 +1226,7 @@ void merge( Arena& arena, VectorRef<KeyValueRef>& output, VectorRef<KeyValueRef>
 	KeyValueRef const* baseEnd = base.end();
 	while (baseStart!=baseEnd && start!=end && --limit>=0 && accumulatedBytes < limitBytes) {
 		if (forward ? baseStart->key < start.key() : baseStart->key > start.key())
-			output.push_back_deep( arena, *baseStart++ );
+			output.push_back( arena, *baseStart++ );
 		else {
 			output.push_back_deep( arena, KeyValueRef(start.key(), start->getValue()) );
 			if (baseStart->key == start.key()) ++baseStart;
@@ -945,7 +1235,7 @@ void merge( Arena& arena, VectorRef<KeyValueRef>& output, VectorRef<KeyValueRef>
 		accumulatedBytes += sizeof(KeyValueRef) + output.end()[-1].expectedSize();
 	}
 	while (baseStart!=baseEnd && --limit>=0 && accumulatedBytes < limitBytes) {
-		output.push_back_deep( arena, *baseStart++ );
+		output.push_back( arena, *baseStart++ );
 		accumulatedBytes += sizeof(KeyValueRef) + output.end()[-1].expectedSize();
 	}
 	if( !stopAtEndOfBase ) {
@@ -1035,6 +1325,8 @@ ACTOR Future<GetKeyValuesReply> readRange( StorageServer* data, Version version,
 
 			// merge the sets in [vStart,vEnd) with the sets on disk, stopping at the last key from disk if there is 'more'
 			int prevSize = result.data.size();
+			result.arena.dependsOn( atStorageVersion.arena() );  // merge references the disk rows instead of copying them
+			result.data.reserve( result.arena, prevSize + atStorageVersion.size() + vCount );  // exact upper bound on the rows merge can append, so it doesn't reallocate mid-merge
 			merge( result.arena, result.data, atStorageVersion, vStart, vEnd, vCount, limit, more, *pLimitBytes );
 			limit -= result.data.size() - prevSize;
 
@@ -1123,6 +1415,8 @@ ACTOR Future<GetKeyValuesReply> readRange( StorageServer* data, Version version,
 			if (data->storageVersion() > version) throw transaction_too_old();
 
 			int prevSize = result.data.size();
+			result.arena.dependsOn( atStorageVersion.arena() );  // merge references the disk rows instead of copying them
+			result.data.reserve( result.arena, prevSize + atStorageVersion.size() + vCount );  // exact upper bound on the rows merge can append, so it doesn't reallocate mid-merge
 			merge( result.arena, result.data, atStorageVersion, vStart, vEnd, vCount, limit, false, *pLimitBytes );
 			limit += result.data.size() - prevSize;
 
@@ -1235,10 +1529,22 @@ ACTOR Future<Void> getKeyValues( StorageServer* data, GetKeyValuesRequest req )
 	data->maxQueryQueue = std::max<int>( data->maxQueryQueue, data->counters.allQueries.getValue() - data->counters.finishedQueries.getValue());
 
 	// Active load balancing runs at a very high priority (to obtain accurate queue lengths)
-	// so we need to downgrade here
-	wait( delay(0, TaskDefaultEndpoint) );
+	// so we need to downgrade here.  Range reads are further downgraded below point reads so that
+	// when the server is saturated, a flood of large scans queues behind getValue requests rather
+	// than in front of them.
+	if( SERVER_KNOBS->RANGE_READ_LOW_PRIORITY ) {
+		++data->counters.lowPriorityQueries;
+		wait( delay(0, TaskLowPriorityRead) );
+	}
+	else
+		wait( delay(0, TaskDefaultEndpoint) );
 
 	try {
+		if( data->shouldShedRead() ) {
+			TEST(true); // getKeyValues shed for load
+			throw server_overloaded();
+		}
+
 		if( req.debugID.present() )
 			g_traceBatch.addEvent("TransactionDebug", req.debugID.get().first(), "storageserver.getKeyValues.Before");
 		state Version version = wait( waitForVersion( data, req.version ) );
@@ -1288,14 +1594,55 @@ ACTOR Future<Void> getKeyValues( StorageServer* data, GetKeyValuesRequest req )
 			none.version = version;
 			none.more = false;
 			none.penalty = data->getPenalty();
+			none.replicaVersion = data->version.get();
 
 			data->checkChangeCounter( changeCounter, KeyRangeRef( std::min<KeyRef>(req.begin.getKey(), req.end.getKey()), std::max<KeyRef>(req.begin.getKey(), req.end.getKey()) ) );
 			req.reply.send( none );
+		} else if (req.aggregateOnly) {
+			// Scan the range in limit/limitBytes sized batches, accumulating row and byte totals and
+			// discarding the rows, so only integers are shipped back to the client.  The shard
+			// assignment is re-checked after every batch, since the scan yields and shards can move.
+			state GetKeyValuesReply agg;
+			agg.version = version;
+			agg.more = false;
+			state Key aggBegin = begin;
+			loop {
+				state int aggLimitBytes = req.limitBytes;
+				GetKeyValuesReply r = wait( readRange(data, version, KeyRangeRef(aggBegin, end), req.limit, &aggLimitBytes) );
+				data->checkChangeCounter( changeCounter, KeyRangeRef(begin, end) );
+
+				agg.aggregateRows += r.data.size();
+				for(int i = 0; i < r.data.size(); i++)
+					agg.aggregateBytes += r.data[i].expectedSize();
+				data->counters.rowsQueried += r.data.size();
+
+				if (!r.more || !r.data.size())
+					break;
+				aggBegin = keyAfter( r.data.end()[-1].key );
+				if (aggBegin >= end)
+					break;
+
+				// Point reads that queued while this batch was scanning get the CPU first
+				if( SERVER_KNOBS->RANGE_READ_LOW_PRIORITY )
+					wait( delay(0, TaskLowPriorityRead) );
+			}
+			TEST(true); // aggregate-only range query
+
+			if( req.debugID.present() )
+				g_traceBatch.addEvent("TransactionDebug", req.debugID.get().first(), "storageserver.getKeyValues.AfterAggregate");
+
+			agg.penalty = data->getPenalty();
+			agg.replicaVersion = data->version.get();
+			req.reply.send( agg );
 		} else {
 			state int remainingLimitBytes = req.limitBytes;
 
-			GetKeyValuesReply _r = wait( readRange(data, version, KeyRangeRef(begin, end), req.limit, &remainingLimitBytes) );
-			GetKeyValuesReply r = _r;
+			state GetKeyValuesReply r = wait( readRange(data, version, KeyRangeRef(begin, end), req.limit, &remainingLimitBytes) );
+
+			// Charge the cost of the read before replying, so that point reads that queued while
+			// this scan was running get the CPU ahead of this reply and the requester's next chunk
+			if( SERVER_KNOBS->RANGE_READ_LOW_PRIORITY )
+				wait( delay(0, TaskLowPriorityRead) );
 
 			if( req.debugID.present() )
 				g_traceBatch.addEvent("TransactionDebug", req.debugID.get().first(), "storageserver.getKeyValues.AfterReadRange");
@@ -1314,7 +1661,24 @@ ACTOR Future<Void> getKeyValues( StorageServer* data, GetKeyValuesRequest req )
 				data->metrics.notify(r.data[i].key, m);
 			}*/
 
+			if (req.prefixCompressed && r.data.size()) {
+				// Strip from each key the prefix it shares with its predecessor.  The suffixes alias
+				// the existing key bytes, so compressing costs one vectorized prefix comparison per
+				// row; NativeAPI rebuilds the full keys when it copies the reply out of the network
+				// arena.
+				r.prefixLengths.reserve( r.arena, r.data.size() );
+				KeyRef prev;
+				for(int i=0; i<r.data.size(); i++) {
+					KeyRef full = r.data[i].key;
+					int prefixLen = commonPrefixLength( prev, full );
+					r.prefixLengths.push_back( r.arena, prefixLen );
+					r.data[i].key = full.substr( prefixLen );
+					prev = full;
+				}
+			}
+
 			r.penalty = data->getPenalty();
+			r.replicaVersion = data->version.get();
 			req.reply.send( r );
 
 			data->counters.rowsQueried += r.data.size();
@@ -1343,6 +1707,11 @@ ACTOR Future<Void> getKey( StorageServer* data, GetKeyRequest req ) {
 	wait( delay(0, TaskDefaultEndpoint) );
 
 	try {
+		if( data->shouldShedRead() ) {
+			TEST(true); // getKey shed for load
+			throw server_overloaded();
+		}
+
 		state Version version = wait( waitForVersion( data, req.version ) );
 		state uint64_t changeCounter = data->shardChangeCounter;
 		state KeyRange shard = getShardKeyRange( data, req.sel );
@@ -1364,6 +1733,7 @@ ACTOR Future<Void> getKey( StorageServer* data, GetKeyRequest req ) {
 
 		GetKeyReply reply(updated);
 		reply.penalty = data->getPenalty();
+		reply.replicaVersion = data->version.get();
 		req.reply.send(reply);
 	}
 	catch (Error& e) {
@@ -1480,6 +1850,7 @@ bool changeDurableVersion( StorageServer* data, Version desiredDurableVersion )
 	}
 	data->getMutableMutationLog().erase(data->getMutationLog().begin(), data->getMutationLog().upper_bound(nextDurableVersion));
 	data->freeable.erase( data->freeable.begin(), data->freeable.lower_bound(nextDurableVersion) );
+	data->evictInternedKeys( nextDurableVersion );
 
 	Future<Void> checkFatalError = data->otherError.getFuture();
 	data->durableVersion.set( nextDurableVersion );
@@ -1536,16 +1907,24 @@ bool expandMutation( MutationRef& m, StorageServer::VersionedData const& data, U
 	else if (m.type != MutationRef::SetValue && (m.type)) {
 
 		Optional<StringRef> oldVal;
-		auto it = data.atLatest().lastLessOrEqual(m.param1);
-		if (it != data.atLatest().end() && it->isValue() && it.key() == m.param1)
-			oldVal = it->getValue();
-		else if (it != data.atLatest().end() && it->isClearTo() && it->getEndKey() > m.param1) {
-			TEST(true); // Atomic op right after a clear.
+		if (eager->lastExpandedValue.present() && eager->lastExpandedKey == m.param1) {
+			// The previous mutation in this batch wrote this key, so its current value is known
+			// without searching the versioned map
+			TEST(true); // Fused run of atomic ops on the same key
+			oldVal = eager->lastExpandedValue.get();
 		}
 		else {
-			Optional<Value>& oldThing = eager->getValue(m.param1);
-			if (oldThing.present())
-				oldVal = oldThing.get();
+			auto it = data.atLatest().lastLessOrEqual(m.param1);
+			if (it != data.atLatest().end() && it->isValue() && it.key() == m.param1)
+				oldVal = it->getValue();
+			else if (it != data.atLatest().end() && it->isClearTo() && it->getEndKey() > m.param1) {
+				TEST(true); // Atomic op right after a clear.
+			}
+			else {
+				Optional<Value>& oldThing = eager->getValue(m.param1);
+				if (oldThing.present())
+					oldVal = oldThing.get();
+			}
 		}
 
 		switch(m.type) {
@@ -1586,6 +1965,16 @@ bool expandMutation( MutationRef& m, StorageServer::VersionedData const& data, U
 		m.type = MutationRef::SetValue;
 	}
 
+	// Remember the result of this mutation so that a following atomic op on the same key in this
+	// batch can skip the versioned map search above
+	if (m.type == MutationRef::SetValue) {
+		eager->lastExpandedKey = m.param1;
+		eager->lastExpandedValue = m.param2;
+	} else if (m.type == MutationRef::ClearRange) {
+		eager->lastExpandedKey = KeyRef();
+		eager->lastExpandedValue = Optional<ValueRef>();
+	}
+
 	return true;
 }
 
@@ -1618,13 +2007,16 @@ void applyMutation( StorageServer *self, MutationRef const& m, Arena& arena, Sto
 				data.insert( nextKey, ValueOrClearToRef::clearTo( KeyRef(arena, end) ) );
 			}
 		}
-		data.insert( m.param1, ValueOrClearToRef::value(m.param2) );
-		self->watches.trigger( m.param1 );
+		data.insert( self->internKey( m.param1, arena, data.getLatestVersion() ), ValueOrClearToRef::value(m.param2) );
+		self->hotValueCache.invalidate( m.param1 );
+		if (!self->watches.empty())
+			self->watches.trigger( m.param1 );
 	} else if (m.type == MutationRef::ClearRange) {
 		data.erase( m.param1, m.param2 );
 		ASSERT( m.param2 > m.param1 );
 		ASSERT( !isClearContaining( data.atLatest(), m.param1 ) );
 		data.insert( m.param1, ValueOrClearToRef::clearTo(m.param2) );
+		self->hotValueCache.invalidate( KeyRangeRef(m.param1, m.param2) );
 		self->watches.triggerRange( m.param1, m.param2 );
 	}
 
@@ -1638,6 +2030,11 @@ void removeDataRange( StorageServer *ss, Standalone<VersionUpdateRef> &mLV, KeyR
 	MutationRef clearRange( MutationRef::ClearRange, range.begin, range.end );
 	clearRange = ss->addMutationToMutationLog( mLV, clearRange );
 
+	// The durable data in this range is going away, so any bloom filter over it is no longer
+	// worth its memory.  If the range is fetched again, fetchKeys will build a fresh filter.
+	ss->bloomFilters.insert( range, Reference<BlockedBloomFilter>() );
+	ss->hotValueCache.invalidate( range );
+
 	auto& data = ss->mutableData();
 
 	// Expand the range to the right to include other shards not in versionedData
@@ -1829,6 +2226,13 @@ ACTOR Future<Void> fetchKeys( StorageServer *data, AddingShard* shard ) {
 
 		TraceEvent(SevDebug, "FetchKeysVersionSatisfied", data->thisServerID).detail("FKID", interval.pairID);
 
+		// The range is durably empty now, so a filter created here will cover every key that
+		// becomes durable in it - both the fetched blocks below and the buffered updates that are
+		// applied through the mutation log after the fetch completes.
+		if (SERVER_KNOBS->STORAGE_BLOOM_FILTER_BITS_PER_KEY > 0)
+			data->bloomFilters.insert( keys, Reference<BlockedBloomFilter>( new BlockedBloomFilter(
+				SERVER_KNOBS->STORAGE_BLOOM_FILTER_MAX_KEYS, SERVER_KNOBS->STORAGE_BLOOM_FILTER_BITS_PER_KEY ) ) );
+
 		wait( data->fetchKeysParallelismLock.take( TaskDefaultYield, fetchBlockBytes ) );
 		state FlowLock::Releaser holdingFKPL( data->fetchKeysParallelismLock, fetchBlockBytes );
 
@@ -1879,23 +2283,10 @@ ACTOR Future<Void> fetchKeys( StorageServer *data, AddingShard* shard ) {
 					holdingFKPL.release( fetchBlockBytes - expectedSize );
 				}
 
-				// Wait for permission to proceed
-				//wait( data->fetchKeysStorageWriteLock.take() );
-				//state FlowLock::Releaser holdingFKSWL( data->fetchKeysStorageWriteLock );
-
-				// Write this_block to storage
-				state KeyValueRef *kvItr = this_block.begin();
-				for(; kvItr != this_block.end(); ++kvItr) {
-					data->storage.writeKeyValue( *kvItr );
-					wait(yield());
-				}
-
-				kvItr = this_block.begin();
-				for(; kvItr != this_block.end(); ++kvItr) {
-					data->byteSampleApplySet( *kvItr, invalidVersion );
-					wait(yield());
-				}
-
+				// If there is more data to fetch, split the remainder of the shard off *before* writing
+				// this block, so that the new shard's fetchKeys starts pulling the next disjoint
+				// sub-range (independently load balanced over the source replicas, up to the
+				// fetchKeysParallelismLock budget) while we are ingesting this block locally.
 				if (this_block.more) {
 					Key nfk = this_block.readThrough.present() ? this_block.readThrough.get() : keyAfter( this_block.end()[-1].key );
 					if (nfk != keys.end) {
@@ -1921,6 +2312,24 @@ ACTOR Future<Void> fetchKeys( StorageServer *data, AddingShard* shard ) {
 					}
 				}
 
+				// Wait for permission to proceed
+				//wait( data->fetchKeysStorageWriteLock.take() );
+				//state FlowLock::Releaser holdingFKSWL( data->fetchKeysStorageWriteLock );
+
+				// Write this_block to storage as a single pre-sorted run.  Passing the block's arena
+				// lets the storage engine take a reference to the fetched data rather than copying
+				// each pair; the memory engine merges the run into its tree with amortized
+				// rebalancing and logs it as one record instead of one per pair.
+				data->storage.writeSortedRun( this_block, &this_block.arena() );
+				wait(yield());
+
+				state KeyValueRef *kvItr = this_block.begin();
+				for(; kvItr != this_block.end(); ++kvItr) {
+					data->byteSampleApplySet( *kvItr, invalidVersion );
+					if (((kvItr - this_block.begin()) & 63) == 63)
+						wait(yield());
+				}
+
 				this_block = Standalone<RangeResultRef>();
 
 				if (BUGGIFY) wait( delay( 1 ) );
@@ -2145,6 +2554,10 @@ void changeServerKeys( StorageServer* data, const KeyRangeRef& keys, bool nowAss
 		return;
 	}
 
+	// Cached values for the moving range could be stale once it is fetched again, since fetched data
+	// doesn't pass through applyMutation()
+	data->hotValueCache.invalidate( keys );
+
 	// Save a backup of the ShardInfo references before we start messing with shards, in order to defer fetchKeys cancellation (and
 	// its potential call to removeDataRange()) until shards is again valid
 	vector< Reference<ShardInfo> > oldShards;
@@ -2276,8 +2689,8 @@ struct OrderByVersion {
 
 class StorageUpdater {
 public:
-	StorageUpdater() : fromVersion(invalidVersion), currentVersion(invalidVersion), restoredVersion(invalidVersion), processedStartKey(false) {}
-	StorageUpdater(Version fromVersion, Version restoredVersion) : fromVersion(fromVersion), currentVersion(fromVersion), restoredVersion(restoredVersion), processedStartKey(false) {}
+	StorageUpdater() : fromVersion(invalidVersion), currentVersion(invalidVersion), restoredVersion(invalidVersion), processedStartKey(false), cachedShardChangeCounter(0) {}
+	StorageUpdater(Version fromVersion, Version restoredVersion) : fromVersion(fromVersion), currentVersion(fromVersion), restoredVersion(restoredVersion), processedStartKey(false), cachedShardChangeCounter(0) {}
 
 	void applyMutation(StorageServer* data, MutationRef const& m, Version ver) {
 		//TraceEvent("SSNewVersion", data->thisServerID).detail("VerWas", data->mutableData().latestVersion).detail("ChVer", ver);
@@ -2297,7 +2710,25 @@ public:
 			//	debugMutation("SSUpdateMutation", changes[c].version, *m);
 			//}
 
-			splitMutation( data->shards, m, ver );
+			if(isSingleKeyMutation((MutationRef::Type) m.type) && ( !SHORT_CIRCUT_ACTUAL_STORAGE || !normalKeys.contains(m.param1) )) {
+				// Consecutive mutations usually land in the same shard, so reuse the last shard map
+				// lookup when we can.  The shard map can change during the delays update() takes
+				// between mutations, so the cached range is only trusted while the shard change
+				// counter is unchanged.  The counter must be checked before the range, which points
+				// into the old map otherwise.
+				if( data->shardChangeCounter != cachedShardChangeCounter || !cachedShardRange.contains(m.param1) ) {
+					auto shard = data->shards.rangeContaining( m.param1 );
+					cachedShardChangeCounter = data->shardChangeCounter;
+					cachedShardRange = shard->range();
+					cachedShard = shard->value();
+				}
+				else {
+					TEST(true); // Shard map lookup reused for consecutive mutations
+				}
+				cachedShard->addMutation( ver, m );
+			}
+			else if(!isSingleKeyMutation((MutationRef::Type) m.type))
+				splitMutation( data->shards, m, ver );
 		}
 
 		if (data->otherError.getFuture().isReady()) data->otherError.getFuture().get();
@@ -2312,6 +2743,10 @@ private:
 	bool nowAssigned;
 	bool processedStartKey;
 
+	uint64_t cachedShardChangeCounter;
+	KeyRangeRef cachedShardRange;
+	Reference<ShardInfo> cachedShard;
+
 	void applyPrivateData( StorageServer* data, MutationRef const& m ) {
 		TraceEvent(SevDebug, "SSPrivateMutation", data->thisServerID).detail("Mutation", m.toString());
 
@@ -2644,13 +3079,96 @@ ACTOR Future<Void> update( StorageServer* data, bool* pReceivedUpdate )
 }
 
 ACTOR Future<Void> updateStorage(StorageServer* data) {
+	// Engine commits are pipelined: while up to STORAGE_COMMIT_PIPELINE_DEPTH commits are syncing to disk, the
+	// mutations for the next commit are already being serialized into the engine, so oldestVersion can run ahead
+	// of durableVersion by several commits.  This is safe because reads already tolerate storage[k] being at any
+	// version in [durableVersion, storageVersion] (see the data representation notes above), and both engines
+	// apply writes and commits in submission order.  durableVersion still advances only as each sync completes.
+	state Deque<std::pair<Version, Future<Void>>> pendingCommits;
+	state Deque<Promise<Void>> pendingDurable;  // resolved per commit, in submission order
+	state Future<Void> durableDelay = Void();
+
 	loop {
-		ASSERT( data->durableVersion.get() == data->storageVersion() );
-		wait( data->desiredOldestVersion.whenAtLeast( data->storageVersion()+1 ) );
+		if (pendingCommits.empty())
+			ASSERT( data->durableVersion.get() == data->storageVersion() );
+		else
+			ASSERT( data->durableVersion.get() < data->storageVersion() );
+
+		// Block until the next commit can be serialized: there must be new versions to make durable, room in the
+		// pipeline, and the pacing delay from the previous commit must have elapsed.  While blocked, retire
+		// outstanding commits as their syncs finish so durableVersion keeps advancing.
+		loop {
+			if( data->desiredOldestVersion.get() > data->storageVersion() && durableDelay.isReady() &&
+				(int)pendingCommits.size() < std::max(1, SERVER_KNOBS->STORAGE_COMMIT_PIPELINE_DEPTH) )
+				break;
+
+			state Future<Void> unblock;
+			if( data->desiredOldestVersion.get() <= data->storageVersion() )
+				unblock = data->desiredOldestVersion.whenAtLeast( data->storageVersion()+1 );
+			else if( !durableDelay.isReady() )
+				unblock = durableDelay;
+			else
+				unblock = Never();  // The pipeline is full; only retiring the oldest commit lets us continue
+
+			state bool retire = false;
+			if( pendingCommits.empty() ) {
+				wait( unblock );
+			} else {
+				choose {
+					when( wait( pendingCommits.front().second ) ) { retire = true; }
+					when( wait( unblock ) ) {}
+				}
+			}
+
+			if( retire ) {
+				state Version committedVersion = pendingCommits.front().first;
+				state Promise<Void> committedInProgress = pendingDurable.front();
+				pendingCommits.pop_front();
+				pendingDurable.pop_front();
+
+				debug_advanceMinCommittedVersion( data->thisServerID, committedVersion );
+
+				if(committedVersion > data->rebootAfterDurableVersion) {
+					TraceEvent("RebootWhenDurableTriggered", data->thisServerID).detail("NewOldestVersion", committedVersion).detail("RebootAfterDurableVersion", data->rebootAfterDurableVersion);
+					// Let commits already handed to the storage engine finish syncing before the reboot
+					while( pendingCommits.size() ) {
+						wait( pendingCommits.front().second );
+						pendingCommits.pop_front();
+					}
+					throw please_reboot();
+				}
+
+				committedInProgress.send(Void());
+				wait( delay(0, TaskUpdateStorage) ); //Setting durableInProgess could cause the storage server to shut down, so delay to check for cancellation
+
+				// Taking and releasing the durableVersionLock ensures that no eager reads both begin before the commit was effective and
+				// are applied after we change the durable version. Also ensure that we have to lock while calling changeDurableVersion,
+				// because otherwise the latest version of mutableData might be partially loaded.
+				wait( data->durableVersionLock.take() );
+				data->popVersion( data->durableVersion.get() + 1 );
+
+				while (!changeDurableVersion( data, committedVersion )) {
+					if(g_network->check_yield(TaskUpdateStorage)) {
+						data->durableVersionLock.release();
+						wait(delay(0, TaskUpdateStorage));
+						wait( data->durableVersionLock.take() );
+					}
+				}
+
+				data->durableVersionLock.release();
+
+				//TraceEvent("StorageServerDurable", data->thisServerID).detail("Version", committedVersion);
+			}
+		}
+
 		wait( delay(0, TaskUpdateStorage) );
 
+		// Apply deferred byte sample maintenance while we are at low priority, and before the mutation
+		// log entries backing the queued updates can be drained below
+		data->applyDeferredByteSampleUpdates();
+
 		state Promise<Void> durableInProgress;
-		data->durableInProgress = durableInProgress.getFuture();
+		data->durableInProgress = durableInProgress.getFuture();  // Commits complete in order, so the newest future covers all outstanding commits
 
 		state Version startOldestVersion = data->storageVersion();
 		state Version newOldestVersion = data->storageVersion();
@@ -2671,43 +3189,12 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 			data->storage.makeVersionDurable( newOldestVersion );
 
 		debug_advanceMaxCommittedVersion( data->thisServerID, newOldestVersion );
-		state Future<Void> durable = data->storage.commit();
-		state Future<Void> durableDelay = Void();
+		pendingCommits.push_back( std::make_pair( newOldestVersion, data->storage.commit() ) );
+		pendingDurable.push_back( durableInProgress );
+		TEST( pendingCommits.size() > 1 );  // Storage engine commit overlapped with the next commit's serialization
 
 		if (bytesLeft > 0)
 			durableDelay = delay(SERVER_KNOBS->STORAGE_COMMIT_INTERVAL);
-
-		wait( durable );
-
-		debug_advanceMinCommittedVersion( data->thisServerID, newOldestVersion );
-
-		if(newOldestVersion > data->rebootAfterDurableVersion) {
-			TraceEvent("RebootWhenDurableTriggered", data->thisServerID).detail("NewOldestVersion", newOldestVersion).detail("RebootAfterDurableVersion", data->rebootAfterDurableVersion);
-			throw please_reboot();
-		}
-
-		durableInProgress.send(Void());
-		wait( delay(0, TaskUpdateStorage) ); //Setting durableInProgess could cause the storage server to shut down, so delay to check for cancellation
-
-		// Taking and releasing the durableVersionLock ensures that no eager reads both begin before the commit was effective and
-		// are applied after we change the durable version. Also ensure that we have to lock while calling changeDurableVersion,
-		// because otherwise the latest version of mutableData might be partially loaded.
-		wait( data->durableVersionLock.take() );
-		data->popVersion( data->durableVersion.get() + 1 );
-
-		while (!changeDurableVersion( data, newOldestVersion )) {
-			if(g_network->check_yield(TaskUpdateStorage)) {
-				data->durableVersionLock.release();
-				wait(delay(0, TaskUpdateStorage));
-				wait( data->durableVersionLock.take() );
-			}
-		}
-
-		data->durableVersionLock.release();
-
-		//TraceEvent("StorageServerDurable", data->thisServerID).detail("Version", newOldestVersion);
-
-		wait( durableDelay );
 	}
 }
 
@@ -2778,13 +3265,21 @@ void StorageServerDisk::clearRange( KeyRangeRef keys ) {
 	storage->clear(keys);
 }
 
-void StorageServerDisk::writeKeyValue( KeyValueRef kv ) {
-	storage->set( kv );
+void StorageServerDisk::writeKeyValue( KeyValueRef kv, const Arena* arena ) {
+	data->bloomFilterInsert( kv.key );
+	storage->set( kv, arena );
+}
+
+void StorageServerDisk::writeSortedRun( VectorRef<KeyValueRef> kvs, const Arena* arena ) {
+	for(int i = 0; i < kvs.size(); i++)
+		data->bloomFilterInsert( kvs[i].key );
+	storage->setSortedRun( kvs, arena );
 }
 
 void StorageServerDisk::writeMutation( MutationRef mutation ) {
 	// FIXME: debugMutation(debugContext, debugVersion, *m);
 	if (mutation.type == MutationRef::SetValue) {
+		data->bloomFilterInsert( mutation.param1 );
 		storage->set( KeyValueRef(mutation.param1, mutation.param2) );
 	} else if (mutation.type == MutationRef::ClearRange) {
 		storage->clear( KeyRangeRef(mutation.param1, mutation.param2) );
@@ -2796,6 +3291,7 @@ void StorageServerDisk::writeMutations( MutationListRef mutations, Version debug
 	for(auto m = mutations.begin(); m; ++m) {
 		debugMutation(debugContext, debugVersion, *m);
 		if (m->type == MutationRef::SetValue) {
+			data->bloomFilterInsert( m->param1 );
 			storage->set( KeyValueRef(m->param1, m->param2) );
 		} else if (m->type == MutationRef::ClearRange) {
 			storage->clear( KeyRangeRef(m->param1, m->param2) );
@@ -3010,6 +3506,9 @@ void StorageServer::addMutationToMutationLogOrStorage( Version ver, MutationRef
 void StorageServer::byteSampleApplySet( KeyValueRef kv, Version ver ) {
 	// Update byteSample in memory and (eventually) on disk and notify waiting metrics
 
+	if (ver == invalidVersion)
+		applyDeferredByteSampleUpdates();  // direct updates must not be reordered ahead of earlier logged updates
+
 	ByteSampleInfo sampleInfo = isKeyValueInSample(kv);
 	auto& byteSample = metrics.byteSample.sample;
 
@@ -3044,6 +3543,9 @@ void StorageServer::byteSampleApplySet( KeyValueRef kv, Version ver ) {
 void StorageServer::byteSampleApplyClear( KeyRangeRef range, Version ver ) {
 	// Update byteSample in memory and (eventually) on disk via the mutationLog and notify waiting metrics
 
+	if (ver == invalidVersion)
+		applyDeferredByteSampleUpdates();  // direct updates must not be reordered ahead of earlier logged updates
+
 	auto& byteSample = metrics.byteSample.sample;
 	bool any = false;
 
@@ -3164,18 +3666,44 @@ Future<Void> StorageServerMetrics::waitMetrics(WaitMetricsRequest req, Future<Vo
 /////////////////////////////// Core //////////////////////////////////////
 #pragma region Core
 
+// Size estimates are incomplete until the byte sample has been fully read back from disk, so requests
+// that need them are answered only after the background recovery finishes.  The shard map and physical
+// metrics do not depend on the byte sample, so everything else is served immediately on reboot.
+ACTOR Future<Void> waitMetricsAfterByteSampleRecovery( StorageServer* self, WaitMetricsRequest req ) {
+	wait( self->byteSampleRecovery );
+	if (!self->isReadable( req.keys )) {
+		TEST( true );	// waitMetrics wrong_shard_server() after byte sample recovery
+		req.reply.sendError(wrong_shard_server());
+	} else {
+		wait( self->metrics.waitMetrics( req, delayJittered( SERVER_KNOBS->STORAGE_METRIC_TIMEOUT ) ) );
+	}
+	return Void();
+}
+
+ACTOR Future<Void> splitMetricsAfterByteSampleRecovery( StorageServer* self, SplitMetricsRequest req ) {
+	wait( self->byteSampleRecovery );
+	if (!self->isReadable( req.keys )) {
+		TEST( true );	// splitMetrics wrong_shard_server() after byte sample recovery
+		req.reply.sendError(wrong_shard_server());
+	} else {
+		self->metrics.splitMetrics( req );
+	}
+	return Void();
+}
+
 ACTOR Future<Void> metricsCore( StorageServer* self, StorageServerInterface ssi ) {
 	state Future<Void> doPollMetrics = Void();
 	state ActorCollection actors(false);
 
-	wait( self->byteSampleRecovery );
-
 	actors.add(traceCounters("StorageMetrics", self->thisServerID, SERVER_KNOBS->STORAGE_LOGGING_DELAY, &self->counters.cc, self->thisServerID.toString() + "/StorageMetrics"));
 
 	loop {
 		choose {
 			when (WaitMetricsRequest req = waitNext(ssi.waitMetrics.getFuture())) {
-				if (!self->isReadable( req.keys )) {
+				if (!self->byteSampleRecovery.isReady()) {
+					TEST( true );	// waitMetrics before byte sample recovery is complete
+					actors.add( waitMetricsAfterByteSampleRecovery( self, req ) );
+				} else if (!self->isReadable( req.keys )) {
 					TEST( true );	// waitMetrics immediate wrong_shard_server()
 					req.reply.sendError(wrong_shard_server());
 				} else {
@@ -3183,7 +3711,10 @@ ACTOR Future<Void> metricsCore( StorageServer* self, StorageServerInterface ssi
 				}
 			}
 			when (SplitMetricsRequest req = waitNext(ssi.splitMetrics.getFuture())) {
-				if (!self->isReadable( req.keys )) {
+				if (!self->byteSampleRecovery.isReady()) {
+					TEST( true );	// splitMetrics before byte sample recovery is complete
+					actors.add( splitMetricsAfterByteSampleRecovery( self, req ) );
+				} else if (!self->isReadable( req.keys )) {
 					TEST( true );	// splitMetrics immediate wrong_shard_server()
 					req.reply.sendError(wrong_shard_server());
 				} else {
@@ -3282,7 +3813,6 @@ ACTOR Future<Void> storageServerCore( StorageServer* self, StorageServerInterfac
 			}
 			when( WatchValueRequest req = waitNext(ssi.watchValue.getFuture()) ) {
 				// TODO: fast load balancing?
-				// SOMEDAY: combine watches for the same key/value into a single watch
 				actors.add( watchValueQ( self, req ) );
 			}
 			when (GetKeyRequest req = waitNext(ssi.getKey.getFuture())) {
@@ -771,12 +771,112 @@ ACTOR Future<Void> checkConsistency(Database cx, std::vector< TesterInterface >
 	}
 }
 
+static void setComparisonKnobs( std::vector<std::pair<std::string, std::string>> const& knobs ) {
+	for(auto const& kv : knobs) {
+		if (!const_cast<FlowKnobs*>(FLOW_KNOBS)->setKnob( kv.first, kv.second ) &&
+			!const_cast<ClientKnobs*>(CLIENT_KNOBS)->setKnob( kv.first, kv.second ) &&
+			!const_cast<ServerKnobs*>(SERVER_KNOBS)->setKnob( kv.first, kv.second ))
+		{
+			TraceEvent(SevError, "CompareKnobUnknown").detail("Knob", kv.first);
+			ASSERT(false);
+		}
+	}
+}
+
+//Runs the workload spec.knobComparisonSamples times under the current knob values and again under
+//the overrides in spec.compareKnobs, then logs each metric's mean under both configurations along
+//with an approximate 95% confidence bound on the difference of the means.  Knobs are process
+//globals, so in simulation an override takes effect on every simulated process at once; outside
+//simulation it would change only this tester, so the mode is limited to simulation.
+ACTOR Future<DistributedTestResults> runKnobComparison( Database cx, std::vector< TesterInterface > testers, TestSpec spec ) {
+	ASSERT( g_network->isSimulated() );
+
+	// Capture the current value of each knob being compared so it can be restored
+	state std::vector<std::pair<std::string, std::string>> baseKnobs;
+	for(auto const& kv : spec.compareKnobs) {
+		std::string value;
+		if (!FLOW_KNOBS->getKnob( kv.first, &value ) &&
+			!CLIENT_KNOBS->getKnob( kv.first, &value ) &&
+			!SERVER_KNOBS->getKnob( kv.first, &value ))
+		{
+			TraceEvent(SevError, "CompareKnobUnknown").detail("Knob", kv.first);
+			ASSERT(false);
+		}
+		baseKnobs.push_back( std::make_pair( kv.first, value ) );
+	}
+
+	state std::vector<std::map<std::string, std::vector<double>>> metricSamples(2);
+	state DistributedTestResults lastResults;
+	state int config = 0;
+	state int sample;
+	try {
+		for(; config < 2; config++) {
+			if( config == 1 )
+				setComparisonKnobs( spec.compareKnobs );
+			for(sample = 0; sample < spec.knobComparisonSamples; sample++) {
+				DistributedTestResults results = wait( runWorkload( cx, testers, spec ) );
+				lastResults = results;
+				if( !lastResults.ok() ) {
+					// Report the failure through the returned results rather than comparing
+					// metrics from a failed run
+					setComparisonKnobs( baseKnobs );
+					return lastResults;
+				}
+				for(auto const& m : lastResults.metrics)
+					metricSamples[config][ m.name() ].push_back( m.value() );
+
+				// Each run redoes the workload's setup phase, so put the database back the way the run found it
+				if( spec.useDB && spec.clearAfterTest )
+					wait( timeoutError( clearData(cx), 1000.0 ) );
+			}
+		}
+	} catch(Error& e) {
+		setComparisonKnobs( baseKnobs );
+		throw;
+	}
+	setComparisonKnobs( baseKnobs );
+
+	for(auto const& m : metricSamples[0]) {
+		auto other = metricSamples[1].find( m.first );
+		if( other == metricSamples[1].end() )
+			continue;
+
+		double mean[2] = { 0, 0 }, var[2] = { 0, 0 };
+		int n[2] = { (int)m.second.size(), (int)other->second.size() };
+		for(int c = 0; c < 2; c++) {
+			auto const& v = c == 0 ? m.second : other->second;
+			for(auto s : v) mean[c] += s;
+			mean[c] /= n[c];
+			for(auto s : v) var[c] += (s - mean[c]) * (s - mean[c]);
+			if( n[c] > 1 ) var[c] /= n[c] - 1;
+		}
+
+		// Approximate 95% bound on the difference of the means; with one sample per
+		// configuration no variance is observable and no significance can be claimed
+		double bound = 1.96 * sqrt( var[0] / n[0] + var[1] / n[1] );
+		double delta = mean[1] - mean[0];
+
+		TraceEvent("KnobComparisonResult")
+			.detail("Metric", m.first)
+			.detail("BaseMean", mean[0])
+			.detail("BaseSamples", n[0])
+			.detail("OverrideMean", mean[1])
+			.detail("OverrideSamples", n[1])
+			.detail("Delta", delta)
+			.detail("ConfidenceBound", bound)
+			.detail("Significant", n[0] > 1 && n[1] > 1 && fabs(delta) > bound);
+		printf("  %s: base %f, override %f, delta %f +/- %f\n", m.first.c_str(), mean[0], mean[1], delta, bound);
+	}
+
+	return lastResults;
+}
+
 ACTOR Future<bool> runTest( Database cx, std::vector< TesterInterface > testers, TestSpec spec, Reference<AsyncVar<ServerDBInfo>> dbInfo )
 {
 	state DistributedTestResults testResults;
 
 	try {
-		Future<DistributedTestResults> fTestResults = runWorkload( cx, testers, spec );
+		Future<DistributedTestResults> fTestResults = spec.compareKnobs.empty() ? runWorkload( cx, testers, spec ) : runKnobComparison( cx, testers, spec );
 		if( spec.timeout > 0 ) {
 			fTestResults = timeoutError( fTestResults, spec.timeout );
 		}
@@ -958,6 +1058,15 @@ vector<TestSpec> readTests( ifstream& ifs ) {
 			TraceEvent("TestParserTest").detail("ParsedMinimumRegions", "");
 		} else if( attrib == "buggify" ) {
 			TraceEvent("TestParserTest").detail("ParsedBuggify", "");
+		} else if( attrib == "compareKnob" ) {
+			size_t eq = value.find( '=' );
+			ASSERT( eq != string::npos );
+			spec.compareKnobs.push_back( std::make_pair( removeWhitespace( value.substr( 0, eq ) ), removeWhitespace( value.substr( eq + 1 ) ) ) );
+			TraceEvent("TestParserTest").detail("ParsedCompareKnob", value);
+		} else if( attrib == "knobComparisonSamples" ) {
+			sscanf( value.c_str(), "%d", &spec.knobComparisonSamples );
+			ASSERT( spec.knobComparisonSamples > 0 );
+			TraceEvent("TestParserTest").detail("ParsedKnobComparisonSamples", spec.knobComparisonSamples);
 		} else if( attrib == "checkOnly" ) {
 			if(value == "true")
 				spec.phases = TestWorkload::CHECK;
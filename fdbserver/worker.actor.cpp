@@ -19,9 +19,12 @@
  */
 
 #include "flow/ActorCollection.h"
+#include "flow/Histogram.h"
+#include "flow/Stats.h"
 #include "flow/SystemMonitor.h"
 #include "flow/TDMetric.actor.h"
 #include "fdbrpc/simulator.h"
+#include "fdbrpc/AsyncFileCached.actor.h"
 #include "fdbclient/NativeAPI.h"
 #include "fdbclient/MetricLogger.h"
 #include "fdbserver/WorkerInterface.h"
@@ -342,6 +345,11 @@ void updateCpuProfiler(ProfilerRequest req) {
 			break;
 		}
 		break;
+	case ProfilerRequest::Type::FLOW_DUMP:
+		// Snapshot the aggregated stacks of the running flow profiler; the action is irrelevant
+		if (!dumpProfilerCollapsedStacks(req.outputFile.toString()))
+			TraceEvent(SevWarn, "ProfilerStackDumpFailed").detail("OutputFile", req.outputFile.toString());
+		break;
 	}
 }
 
@@ -517,6 +525,118 @@ ACTOR Future<Void> monitorServerDBInfo( Reference<AsyncVar<Optional<ClusterContr
 	}
 }
 
+// Continuously measures end to end GRV, single key read, and commit latency from this process
+// against the cluster, at a rate low enough to be negligible load.  Percentiles over each
+// logging interval are published through a trace event that status rolls up into its
+// continuous_latency_probes section, so unlike the on demand probe that status performs
+// itself, tail behavior between status requests is captured.
+ACTOR Future<Void> latencyProbeServer( Reference<AsyncVar<ServerDBInfo>> dbInfo ) {
+	state Database cx = openDBOnServer( dbInfo, TaskDefaultEndpoint, true, true );
+	state LogHistogram grvLatency, readLatency, commitLatency;
+	state double lastLogged = now();
+	loop {
+		wait( delayJittered( SERVER_KNOBS->LATENCY_PROBE_INTERVAL ) );
+
+		state Transaction tr( cx );
+		try {
+			tr.setOption( FDBTransactionOptions::LOCK_AWARE );
+			state double start = timer_monotonic();
+			wait( success( tr.getReadVersion() ) );
+			state double grvDone = timer_monotonic();
+			grvLatency.addSample( grvDone - start );
+
+			wait( success( tr.get( LiteralStringRef("\xff/latencyProbeKey") ) ) );
+			state double readDone = timer_monotonic();
+			readLatency.addSample( readDone - grvDone );
+
+			// A self conflicting empty commit exercises the full commit path without mutating anything
+			tr.makeSelfConflicting();
+			wait( tr.commit() );
+			commitLatency.addSample( timer_monotonic() - readDone );
+		} catch( Error& e ) {
+			if( e.code() == error_code_actor_cancelled ) throw;
+			// A failed probe contributes no samples; availability problems are reported elsewhere in status
+		}
+
+		if( now() - lastLogged > SERVER_KNOBS->LATENCY_PROBE_LOGGING_INTERVAL ) {
+			TraceEvent("LatencyProbeMetrics")
+				.detail("Elapsed", now() - lastLogged)
+				.detail("GrvSamples", grvLatency.samples())
+				.detail("GrvMedian", grvLatency.median())
+				.detail("GrvP99", grvLatency.percentile(0.99))
+				.detail("GrvP999", grvLatency.percentile(0.999))
+				.detail("GrvMax", grvLatency.max())
+				.detail("ReadSamples", readLatency.samples())
+				.detail("ReadMedian", readLatency.median())
+				.detail("ReadP99", readLatency.percentile(0.99))
+				.detail("ReadP999", readLatency.percentile(0.999))
+				.detail("ReadMax", readLatency.max())
+				.detail("CommitSamples", commitLatency.samples())
+				.detail("CommitMedian", commitLatency.median())
+				.detail("CommitP99", commitLatency.percentile(0.99))
+				.detail("CommitP999", commitLatency.percentile(0.999))
+				.detail("CommitMax", commitLatency.max())
+				.trackLatest("LatencyProbeMetrics");
+			grvLatency.clear();
+			readLatency.clear();
+			commitLatency.clear();
+			lastLogged = now();
+		}
+	}
+}
+
+// Periodically resizes the 4K page cache from runtime feedback: grows it while reads are missing
+// the cache and the machine has memory to spare, and shrinks it when machine memory runs short.
+// Processes on large hosts thereby use the RAM actually available to them rather than the static
+// knob, and processes sharing a host throttle each other through the machine-wide available
+// memory they all observe.
+ACTOR Future<Void> pageCacheTuner( int64_t memoryLimit ) {
+	state int64_t lastHits = 0;
+	state int64_t lastMisses = 0;
+	loop {
+		wait( delay( SERVER_KNOBS->PAGE_CACHE_TUNING_INTERVAL ) );
+
+		state Reference<EvictablePageCache> cache = AsyncFileCached::getPageCache4k();
+		if( !cache )
+			continue;
+		MachineRAMInfo memInfo;
+		getMachineRAMInfo( memInfo );
+		if( memInfo.total <= 0 )  // platforms without machine RAM detection
+			continue;
+
+		int64_t hits = cache->readHits - lastHits;
+		int64_t misses = cache->readMisses - lastMisses;
+		lastHits = cache->readHits;
+		lastMisses = cache->readMisses;
+		double missRate = hits + misses > 0 ? (double)misses / (hits + misses) : 0.0;
+
+		int64_t ceiling = memInfo.total * SERVER_KNOBS->PAGE_CACHE_TUNING_MAX_FRACTION;
+		if( memoryLimit > 0 )
+			ceiling = std::min<int64_t>( ceiling, memoryLimit * SERVER_KNOBS->PAGE_CACHE_TUNING_MAX_FRACTION );
+
+		int64_t oldSize = cache->getMaxSize();
+		int64_t newSize = oldSize;
+		if( memInfo.available < memInfo.total * SERVER_KNOBS->PAGE_CACHE_TUNING_MIN_FREE_FRACTION ) {
+			newSize = std::max( SERVER_KNOBS->PAGE_CACHE_TUNING_MIN_BYTES, oldSize - SERVER_KNOBS->PAGE_CACHE_TUNING_STEP_BYTES );
+			TEST( newSize < oldSize ); // Page cache shrunk under memory pressure
+		} else if( missRate > SERVER_KNOBS->PAGE_CACHE_TUNING_MISS_RATE_THRESHOLD &&
+				   memInfo.available > memInfo.total * SERVER_KNOBS->PAGE_CACHE_TUNING_GROW_FREE_FRACTION ) {
+			newSize = std::min( ceiling, oldSize + SERVER_KNOBS->PAGE_CACHE_TUNING_STEP_BYTES );
+			TEST( newSize > oldSize ); // Page cache grown from miss rate feedback
+		}
+
+		if( newSize != oldSize ) {
+			cache->setMaxSize( newSize );
+			TraceEvent("PageCacheTuning")
+				.detail("OldSizeBytes", oldSize)
+				.detail("NewSizeBytes", newSize)
+				.detail("MissRate", missRate)
+				.detail("AvailableMemory", memInfo.available)
+				.detail("TotalMemory", memInfo.total);
+		}
+	}
+}
+
 ACTOR Future<Void> workerServer( Reference<ClusterConnectionFile> connFile, Reference<AsyncVar<Optional<ClusterControllerFullInterface>>> ccInterface, LocalityData locality,
 	Reference<AsyncVar<ClusterControllerPriorityInfo>> asyncPriorityInfo, ProcessClass initialClass, std::string folder, int64_t memoryLimit, std::string metricsConnFile, std::string metricsPrefix, Promise<Void> recoveredDiskFiles) {
 	state PromiseStream< ErrorInfo > errors;
@@ -551,6 +671,12 @@ ACTOR Future<Void> workerServer( Reference<ClusterConnectionFile> connFile, Refe
 	errorForwarders.add( waitFailureServer( interf.waitFailure.getFuture() ) );
 	errorForwarders.add( monitorServerDBInfo( ccInterface, connFile, locality, dbInfo ) );
 	errorForwarders.add( testerServerCore( interf.testerInterface, connFile, dbInfo, locality ) );
+	if( SERVER_KNOBS->LATENCY_PROBE_INTERVAL > 0 )
+		errorForwarders.add( latencyProbeServer( dbInfo ) );
+	// The simulator shares one machine's RAM between many simulated processes, so tuning from real
+	// machine memory there is meaningless
+	if( !g_network->isSimulated() && SERVER_KNOBS->PAGE_CACHE_TUNING_INTERVAL > 0 )
+		errorForwarders.add( pageCacheTuner( memoryLimit ) );
 
 	filesClosed.add(stopping.getFuture());
 
@@ -695,6 +821,14 @@ ACTOR Future<Void> workerServer( Reference<ClusterConnectionFile> connFile, Refe
 					profilerReq.reply.sendError(e);
 				}
 			}
+			when( MemSampleDumpRequest req = waitNext(interf.clientInterface.memSampleDump.getFuture()) ) {
+				MemSampleDumpReply reply;
+				reply.backTraces = dumpMemorySamples();
+				reply.instrumented = reply.backTraces >= 0;
+				if( !reply.instrumented )
+					reply.backTraces = 0;
+				req.reply.send(reply);
+			}
 			when( RecruitMasterRequest req = waitNext(interf.master.getFuture()) ) {
 				MasterInterface recruited;
 				recruited.locality = locality;
@@ -854,6 +988,19 @@ ACTOR Future<Void> workerServer( Reference<ClusterConnectionFile> connFile, Refe
 				g_traceBatch.dump();
 				req.reply.send(Void());
 			}
+			when( CounterQueryRequest req = waitNext(interf.counterQuery.getFuture()) ) {
+				CounterQueryReply reply;
+				reply.time = now();
+				for( auto collection : registeredCounterCollections() ) {
+					if( req.collectionFilter.size() && req.collectionFilter != StringRef(collection->name) )
+						continue;
+					for( auto c : collection->counters )
+						reply.counters.push_back_deep( reply.arena, CounterValueRef(
+							StringRef(collection->name), StringRef(collection->id), StringRef(c->getName()),
+							c->getValue(), c->hasRate() ? c->getRate() : 0 ) );
+				}
+				req.reply.send(reply);
+			}
 			when( DiskStoreRequest req = waitNext(interf.diskStoreRequest.getFuture()) ) {
 				Standalone<VectorRef<UID>> ids;
 				for(DiskStore d : getDiskStores(folder)) {
@@ -1044,6 +1191,9 @@ ACTOR Future<Void> fdbd(
 		ServerCoordinators coordinators( connFile );
 		TraceEvent("StartingFDBD").detailext("ZoneID", localities.zoneId()).detailext("MachineId", localities.machineId()).detail("DiskPath", dataFolder).detail("CoordPath", coordFolder);
 
+		if (localities.dcId().present())
+			FlowTransport::transport().setLocalDcId( localities.dcId().get() );
+
 		// SOMEDAY: start the services on the machine in a staggered fashion in simulation?
 		state vector<Future<Void>> v;
 		// Endpoints should be registered first before any process trying to connect to it. So coordinationServer actor should be the first one executed before any other.
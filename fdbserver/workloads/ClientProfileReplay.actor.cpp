@@ -0,0 +1,305 @@
+/*
+ * ClientProfileReplay.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbserver/workloads/workloads.h"
+#include "fdbclient/ManagementAPI.h"
+#include "fdbclient/RunTransaction.actor.h"
+
+// Replays traffic captured by client transaction profiling (the sampled transaction info written
+// under \xff\x02/fdbClientInfo/client_latency/ when fdbClientInfoTxnSampleRate is set).  Each
+// captured transaction becomes a "shape" - its operations with their actual keys and sizes - and
+// the workload reproduces the captured op mix, key distribution and arrival process by sampling
+// whole shapes, so performance changes can be validated against real traffic rather than the
+// synthetic patterns of ReadWrite.  Captured mutations are not reapplied; commits write
+// size-matched data under a workload-private prefix so the database contents are not disturbed.
+struct ClientProfileReplayWorkload : TestWorkload {
+	struct ReplayOp {
+		enum Type { OP_GET = 0, OP_GETRANGE, OP_COMMIT };
+		int op;
+		Key begin, end;     // the key read, the range bounds, or the first mutation key of a commit
+		int numMutations;
+		int commitBytes;
+
+		ReplayOp() : op(OP_GET), numMutations(0), commitBytes(0) {}
+	};
+
+	// One captured transaction: when it started and what it did, in order
+	struct ReplayShape {
+		double startTs;
+		std::vector<ReplayOp> ops;
+
+		ReplayShape() : startTs(0) {}
+	};
+
+	double testDuration, samplingProbability;
+	int actorCount;
+	double intensity;   // replayed arrival rate as a multiple of the captured rate
+
+	std::vector<ReplayShape> shapes;
+	std::vector<double> interArrivals;
+	int64_t transactions, operations, retries;
+
+	ClientProfileReplayWorkload(WorkloadContext const& wcx)
+		: TestWorkload(wcx), transactions(0), operations(0), retries(0)
+	{
+		testDuration = getOption( options, LiteralStringRef("testDuration"), 10.0 );
+		actorCount = getOption( options, LiteralStringRef("actorCount"), 20 );
+		intensity = getOption( options, LiteralStringRef("intensity"), 1.0 );
+		samplingProbability = getOption( options, LiteralStringRef("samplingProbability"), 0.0 );
+	}
+
+	virtual std::string description() { return "ClientProfileReplay"; }
+
+	virtual Future<Void> setup(Database const& cx) {
+		// Optionally (re)enable capture, so a test file can record the traffic of preceding
+		// workloads and replay it in a later phase
+		if (clientId == 0 && samplingProbability > 0)
+			return runRYWTransaction(cx, [=](Reference<ReadYourWritesTransaction> tr) -> Future<Void> {
+				tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+				tr->setOption(FDBTransactionOptions::LOCK_AWARE);
+				tr->set(fdbClientInfoTxnSampleRate, BinaryWriter::toValue(samplingProbability, Unversioned()));
+				return Void();
+			});
+		return Void();
+	}
+
+	virtual Future<Void> start(Database const& cx) {
+		return _start(cx, this);
+	}
+
+	virtual Future<bool> check(Database const& cx) { return true; }
+
+	virtual void getMetrics(vector<PerfMetric>& m) {
+		m.push_back( PerfMetric( "Transactions replayed", transactions, false ) );
+		m.push_back( PerfMetric( "Operations replayed", operations, false ) );
+		m.push_back( PerfMetric( "Retries", retries, false ) );
+		m.push_back( PerfMetric( "Captured shapes", shapes.size(), false ) );
+	}
+
+	// Parses one reassembled transaction info entry into a shape; returns false on an entry in an
+	// unknown format, which is skipped rather than failing the workload
+	bool parseShape(BinaryReader &reader, ReplayShape &shape) {
+		uint64_t protocolVersion;
+		reader >> protocolVersion;
+		reader.setProtocolVersion(protocolVersion);
+
+		while (!reader.empty()) {
+			FdbClientLogEvents::EventType event;
+			reader >> event;
+			double timeStamp;
+			reader >> timeStamp;
+			if (shape.startTs == 0)
+				shape.startTs = timeStamp;
+			switch (event) {
+			case FdbClientLogEvents::GET_VERSION_LATENCY:
+			{
+				FdbClientLogEvents::EventGetVersion gv;
+				reader >> gv;
+				break;
+			}
+			case FdbClientLogEvents::GET_LATENCY:
+			{
+				FdbClientLogEvents::EventGet g;
+				reader >> g;
+				ReplayOp op;
+				op.op = ReplayOp::OP_GET;
+				op.begin = g.key;
+				shape.ops.push_back(op);
+				break;
+			}
+			case FdbClientLogEvents::GET_RANGE_LATENCY:
+			{
+				FdbClientLogEvents::EventGetRange gr;
+				reader >> gr;
+				ReplayOp op;
+				op.op = ReplayOp::OP_GETRANGE;
+				op.begin = gr.startKey;
+				op.end = gr.endKey;
+				shape.ops.push_back(op);
+				break;
+			}
+			case FdbClientLogEvents::COMMIT_LATENCY:
+			{
+				FdbClientLogEvents::EventCommit c;
+				reader >> c;
+				ReplayOp op;
+				op.op = ReplayOp::OP_COMMIT;
+				if (c.req.transaction.mutations.size())
+					op.begin = c.req.transaction.mutations[0].param1;
+				op.numMutations = std::max(1, c.numMutations);
+				op.commitBytes = c.commitBytes;
+				shape.ops.push_back(op);
+				break;
+			}
+			case FdbClientLogEvents::ERROR_GET:
+			{
+				FdbClientLogEvents::EventGetError ge;
+				reader >> ge;
+				break;
+			}
+			case FdbClientLogEvents::ERROR_GET_RANGE:
+			{
+				FdbClientLogEvents::EventGetRangeError gre;
+				reader >> gre;
+				break;
+			}
+			case FdbClientLogEvents::ERROR_COMMIT:
+			{
+				FdbClientLogEvents::EventCommitError ce;
+				reader >> ce;
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		return shape.ops.size() > 0;
+	}
+
+	void addShape(const Value& entry) {
+		BinaryReader reader(entry, Unversioned());
+		ReplayShape shape;
+		if (parseShape(reader, shape))
+			shapes.push_back(shape);
+		else
+			TraceEvent(SevWarn, "ClientProfileReplayUnparsedEntry");
+	}
+
+	// Reads all captured transaction info entries and assembles multi-chunk entries, mirroring the
+	// key format checked by ClientTransactionProfileCorrectness
+	ACTOR static Future<Void> loadShapes(Database cx, ClientProfileReplayWorkload* self) {
+		state Key prefix = LiteralStringRef("client_latency/").withPrefix(fdbClientInfoPrefixRange.begin);
+		state KeySelector begin = firstGreaterOrEqual(prefix);
+		state KeySelector end = firstGreaterOrEqual(strinc(prefix));
+		state int keysLimit = 10;
+		state std::map<std::string, std::string> partialEntries;
+		state Transaction tr(cx);
+		loop {
+			try {
+				tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+				tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+				Standalone<RangeResultRef> kvRange = wait(tr.getRange(begin, end, keysLimit));
+				if (kvRange.empty())
+					break;
+				for (auto& kv : kvRange) {
+					// Key layout: <prefix><10 byte versionstamp>/<16 byte id>/<4 byte chunk><4 byte chunks>/
+					int idStart = prefix.size() + 10 + 1;
+					int chunkStart = idStart + 16 + 1;
+					if (kv.key.size() < chunkStart + 8) {
+						TraceEvent(SevWarn, "ClientProfileReplayShortKey").detail("Size", kv.key.size());
+						continue;
+					}
+					int chunkNum = bigEndian32(BinaryReader::fromStringRef<int>(kv.key.substr(chunkStart, 4), Unversioned()));
+					int numChunks = bigEndian32(BinaryReader::fromStringRef<int>(kv.key.substr(chunkStart + 4, 4), Unversioned()));
+					std::string trId = kv.key.substr(idStart, 16).toString();
+
+					if (numChunks == 1) {
+						self->addShape(kv.value);
+					} else if (chunkNum == 1) {
+						partialEntries[trId] = kv.value.toString();
+					} else if (partialEntries.count(trId)) {
+						partialEntries[trId].append(kv.value.begin(), kv.value.end() - kv.value.begin());
+						if (chunkNum == numChunks) {
+							self->addShape(Value(partialEntries[trId]));
+							partialEntries.erase(trId);
+						}
+					}
+				}
+				begin = firstGreaterThan(kvRange.back().key);
+				tr.reset();
+			}
+			catch (Error& e) {
+				if (e.code() == error_code_transaction_too_old)
+					keysLimit = std::max(1, keysLimit / 2);
+				wait(tr.onError(e));
+			}
+		}
+
+		// The empirical arrival process: gaps between consecutive captured transaction starts
+		std::vector<double> starts;
+		for (auto& s : self->shapes)
+			starts.push_back(s.startTs);
+		std::sort(starts.begin(), starts.end());
+		for (int i = 1; i < starts.size(); i++)
+			self->interArrivals.push_back(starts[i] - starts[i-1]);
+
+		TraceEvent("ClientProfileReplayLoaded").detail("Shapes", self->shapes.size());
+		return Void();
+	}
+
+	ACTOR static Future<Void> replayTransaction(Database cx, ClientProfileReplayWorkload* self, ReplayShape* shape) {
+		state Transaction tr(cx);
+		loop {
+			try {
+				state int i;
+				for (i = 0; i < shape->ops.size(); i++) {
+					ReplayOp& op = shape->ops[i];
+					if (op.op == ReplayOp::OP_GET) {
+						wait(success( tr.get(op.begin) ));
+					} else if (op.op == ReplayOp::OP_GETRANGE) {
+						if (op.begin < op.end)
+							wait(success( tr.getRange(KeyRangeRef(shape->ops[i].begin, shape->ops[i].end), CLIENT_KNOBS->TOO_MANY) ));
+					} else {
+						// Same mutation count and bytes as the captured commit, but under a private
+						// prefix so the replay cannot disturb the data it is reading
+						int valueBytes = std::max(0, op.commitBytes / op.numMutations - (int)op.begin.size());
+						for (int m = 0; m < op.numMutations; m++)
+							tr.set( op.begin.withPrefix(LiteralStringRef("\x01profileReplay/")), Value(std::string(std::min(valueBytes, CLIENT_KNOBS->VALUE_SIZE_LIMIT), 'x')) );
+					}
+					++self->operations;
+				}
+				if (shape->ops.back().op == ReplayOp::OP_COMMIT)
+					wait( tr.commit() );
+				++self->transactions;
+				return Void();
+			}
+			catch (Error& e) {
+				++self->retries;
+				wait(tr.onError(e));
+			}
+		}
+	}
+
+	ACTOR static Future<Void> replayClient(Database cx, ClientProfileReplayWorkload* self, double delayScale) {
+		loop {
+			wait(delay( self->interArrivals[ g_random->randomInt(0, self->interArrivals.size()) ] * delayScale ));
+			wait(replayTransaction( cx, self, &self->shapes[ g_random->randomInt(0, self->shapes.size()) ] ));
+		}
+	}
+
+	ACTOR static Future<Void> _start(Database cx, ClientProfileReplayWorkload* self) {
+		wait(loadShapes(cx, self));
+		if (self->shapes.empty() || self->interArrivals.empty()) {
+			TraceEvent(SevWarnAlways, "ClientProfileReplayNoCapture");
+			return Void();
+		}
+
+		// Each actor samples from the shared arrival process, so the gaps are scaled up by the
+		// number of actors replaying it to preserve the aggregate captured rate
+		state std::vector<Future<Void>> clients;
+		for (int c = 0; c < self->actorCount; c++)
+			clients.push_back(timeout( replayClient( cx, self, self->actorCount * self->clientCount / self->intensity ), self->testDuration, Void() ));
+		wait(waitForAll(clients));
+		return Void();
+	}
+};
+
+WorkloadFactory<ClientProfileReplayWorkload> ClientProfileReplayWorkloadFactory("ClientProfileReplay");
@@ -70,6 +70,15 @@ struct ConsistencyCheckWorkload : TestWorkload
 	//Whether to continuously perfom the consistency check
 	bool indefinite;
 
+	//If true, record a completion marker in the database for each checked shard so an interrupted
+	//check can resume where it left off.  Once every shard has been checked the markers are
+	//cleared, so the next pass covers the whole keyspace again.
+	bool resumable;
+
+	//Like resumable, but the markers are never cleared; a shard is only rechecked when its team
+	//assignment has changed since its marker was written (i.e. data distribution moved it)
+	bool incremental;
+
 	ConsistencyCheckWorkload(WorkloadContext const& wcx)
 		: TestWorkload(wcx)
 	{
@@ -81,6 +90,8 @@ struct ConsistencyCheckWorkload : TestWorkload
 		rateLimit = getOption(options, LiteralStringRef("rateLimit"), 0);
 		shuffleShards = getOption(options, LiteralStringRef("shuffleShards"), false);
 		indefinite = getOption(options, LiteralStringRef("indefinite"), false);
+		resumable = getOption(options, LiteralStringRef("resumable"), false);
+		incremental = getOption(options, LiteralStringRef("incremental"), false);
 
 		success = true;
 
@@ -561,6 +572,25 @@ struct ConsistencyCheckWorkload : TestWorkload
 
 	//Checks that the data in each shard is the same on each storage server that it resides on.  Also performs some sanity checks on the sizes of shards and storage servers.
 	//Returns false if there is a failure
+	//Keyspace where resumable and incremental checks record a marker per fully checked shard
+	static KeyRangeRef progressKeys() {
+		return KeyRangeRef( LiteralStringRef("\xff\x02/consistencyCheckProgress/"), LiteralStringRef("\xff\x02/consistencyCheckProgress0") );
+	}
+
+	static Key progressKeyFor( KeyRangeRef range ) {
+		return range.begin.withPrefix( progressKeys().begin );
+	}
+
+	//Fingerprint of a shard's current team assignment, stored in the shard's completion marker.
+	//When data distribution moves the shard the fingerprint stops matching, so incremental
+	//checks know to visit it again.
+	static Value shardFingerprint( KeyRangeRef range, vector<UID> storageServers ) {
+		std::sort( storageServers.begin(), storageServers.end() );
+		BinaryWriter wr( Unversioned() );
+		wr << range.end << storageServers;
+		return Value( wr.toStringRef() );
+	}
+
 	ACTOR Future<bool> checkDataConsistency(Database cx, VectorRef<KeyValueRef> keyLocations, DatabaseConfiguration configuration, ConsistencyCheckWorkload *self)
 	{
 		//Stores the total number of bytes on each storage server
@@ -649,6 +679,34 @@ struct ConsistencyCheckWorkload : TestWorkload
 			state vector<UID> storageServers = (isRelocating) ? destStorageServers : sourceStorageServers;
 			state vector<StorageServerInterface> storageServerInterfaces;
 
+			//In resumable or incremental mode, skip shards that were already checked with this
+			//same team assignment.  Quiescent checks need to visit every shard for their size
+			//accounting, so they do not track progress.
+			state bool trackProgress = (self->resumable || self->incremental) && !self->performQuiescentChecks;
+			state Value fingerprint;
+			if(trackProgress)
+			{
+				fingerprint = shardFingerprint(range, storageServers);
+				state Optional<Value> progressMarker;
+				loop {
+					try {
+						tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+						Optional<Value> marker = wait(tr.get(progressKeyFor(range)));
+						progressMarker = marker;
+						break;
+					}
+					catch(Error &e) {
+						wait(tr.onError(e));
+					}
+				}
+				if(progressMarker.present() && progressMarker.get() == fingerprint)
+				{
+					TraceEvent("ConsistencyCheck_ShardAlreadyChecked").suppressFor(1.0)
+						.detail("ShardBegin", printable(range.begin)).detail("ShardEnd", printable(range.end));
+					continue;
+				}
+			}
+
 			loop {
 				try {
 					vector< Future< Optional<Value> > > serverListEntries;
@@ -993,6 +1051,23 @@ struct ConsistencyCheckWorkload : TestWorkload
 					self->testFailure(format("Shard size in quiescent database is too %s", (sampledBytes < shardBounds.min.bytes) ? "small" : "large"));
 					return false;
 				}
+
+				//Record that this shard has been fully checked with its current team assignment
+				if(trackProgress)
+				{
+					loop {
+						try {
+							tr.reset();
+							tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+							tr.set(progressKeyFor(range), fingerprint);
+							wait(tr.commit());
+							break;
+						}
+						catch(Error &e) {
+							wait(tr.onError(e));
+						}
+					}
+				}
 			}
 
 			if(bytesReadInRange > 0) {
@@ -1018,6 +1093,25 @@ struct ConsistencyCheckWorkload : TestWorkload
 			}
 		}*/
 
+		//A resumable pass that reaches this point has visited every shard, so clear the markers
+		//to make the next pass a fresh full check.  Incremental mode keeps them, rechecking only
+		//shards that data distribution has moved since their markers were written.  Markers other
+		//clients write after this clear just cause an extra recheck on the next pass.
+		if(self->firstClient && self->resumable && !self->incremental)
+		{
+			state Transaction clearTr(cx);
+			loop {
+				try {
+					clearTr.setOption(FDBTransactionOptions::LOCK_AWARE);
+					clearTr.clear(progressKeys());
+					wait(clearTr.commit());
+					break;
+				}
+				catch(Error &e) {
+					wait(clearTr.onError(e));
+				}
+			}
+		}
 
 		return true;
 	}
@@ -192,6 +192,7 @@ ACTOR Future<Void> testKVCommit( KVTest* test, Histogram<float>* latency, PerfIn
 }
 
 Future<Void> testKVStore( struct KVStoreTestWorkload *const& );
+Future<Void> testKVStores( struct KVStoreTestWorkload *const& );
 
 struct KVStoreTestWorkload : TestWorkload {
 	bool enabled, saturation;
@@ -204,9 +205,12 @@ struct KVStoreTestWorkload : TestWorkload {
 	Histogram<float> readLatency, commitLatency;
 	double setupTook;
 	std::string storeType;
+	std::vector<std::string> storeTypes;  // When more than one, each engine runs the same test in turn and metrics are reported per engine
+	int64_t spaceBytesUsed;
+	vector<PerfMetric> engineMetrics;
 
 	KVStoreTestWorkload( WorkloadContext const& wcx )
-		: TestWorkload(wcx), reads("Reads"), sets("Sets"), commits("Commits"), setupTook(0)
+		: TestWorkload(wcx), reads("Reads"), sets("Sets"), commits("Commits"), setupTook(0), spaceBytesUsed(0)
 	{
 		enabled = !clientId; // only do this on the "first" client
 		testDuration = getOption( options, LiteralStringRef("testDuration"), 10.0 );
@@ -222,12 +226,13 @@ struct KVStoreTestWorkload : TestWorkload {
 		filename = getOption( options, LiteralStringRef("filename"), Value() ).toString();
 		saturation = getOption( options, LiteralStringRef("saturation"), false );
 		storeType = getOption( options, LiteralStringRef("storeType"), LiteralStringRef("ssd") ).toString();
+		storeTypes = getOption( options, LiteralStringRef("storeTypes"), vector<std::string>(1, storeType) );
 	}
 	virtual std::string description() { return "KVStoreTest"; }
 	virtual Future<Void> setup( Database const& cx ) { return Void(); }
 	virtual Future<Void> start( Database const& cx ) {
 		if (enabled)
-			return testKVStore(this);
+			return testKVStores(this);
 		return Void();
 	}
 	virtual Future<bool> check( Database const& cx ) { return true; }
@@ -239,6 +244,12 @@ struct KVStoreTestWorkload : TestWorkload {
 		m.push_back( PerfMetric( "Max " + name, 1000.0 * h.max(), true) );
 	}
 	virtual void getMetrics( vector<PerfMetric>& m ) {
+		if (storeTypes.size() > 1) {
+			// Comparative mode: per-engine metrics were collected as each engine finished
+			m.insert( m.end(), engineMetrics.begin(), engineMetrics.end() );
+			return;
+		}
+
 		if (setupTook) m.push_back( PerfMetric("SetupTook", setupTook, false) );
 
 		m.push_back(reads.getMetric());
@@ -246,6 +257,27 @@ struct KVStoreTestWorkload : TestWorkload {
 		m.push_back(commits.getMetric());
 		metricsFromHistogram(m, "Read Latency (ms)", readLatency);
 		metricsFromHistogram(m, "Commit Latency (ms)", commitLatency);
+		m.push_back( PerfMetric( "Space Used (bytes)", spaceBytesUsed, false ) );
+	}
+
+	// Snapshots this engine's results under a storeType prefix and resets the counters for the next engine
+	void collectEngineMetrics() {
+		std::string prefix = storeType + " ";
+		if (setupTook) engineMetrics.push_back( PerfMetric( prefix + "SetupTook", setupTook, false ) );
+		engineMetrics.push_back( PerfMetric( prefix + "Reads", reads.getValue(), false, "%.0lf" ) );
+		engineMetrics.push_back( PerfMetric( prefix + "Sets", sets.getValue(), false, "%.0lf" ) );
+		engineMetrics.push_back( PerfMetric( prefix + "Commits", commits.getValue(), false, "%.0lf" ) );
+		metricsFromHistogram( engineMetrics, prefix + "Read Latency (ms)", readLatency );
+		metricsFromHistogram( engineMetrics, prefix + "Commit Latency (ms)", commitLatency );
+		engineMetrics.push_back( PerfMetric( prefix + "Space Used (bytes)", spaceBytesUsed, false ) );
+
+		setupTook = 0;
+		reads.clear();
+		sets.clear();
+		commits.clear();
+		readLatency.reset();
+		commitLatency.reset();
+		spaceBytesUsed = 0;
 	}
 };
 
@@ -399,9 +431,27 @@ ACTOR Future<Void> testKVStore(KVStoreTestWorkload* workload) {
 	}
 	main.cancel();
 
+	StorageBytes sb = test.store->getStorageBytes();
+	workload->spaceBytesUsed = sb.used;
+
 	Future<Void> c = test.store->onClosed();
 	test.close();
 	wait( c );
 	if (err.code() != invalid_error_code) throw err;
 	return Void();
 }
+
+// Runs the same test against each engine in storeTypes, in order, so engines can be compared
+// within one run.  Each engine gets its own store (and its own KVTest version map), and its
+// results are snapshotted under a storeType-prefixed metric name as it finishes.
+ACTOR Future<Void> testKVStores(KVStoreTestWorkload* workload) {
+	state int i;
+	for(i = 0; i < workload->storeTypes.size(); i++) {
+		workload->storeType = workload->storeTypes[i];
+		TraceEvent("KVStoreTestEngineStart").detail("StoreType", workload->storeType);
+		wait( testKVStore(workload) );
+		if (workload->storeTypes.size() > 1)
+			workload->collectEngineMetrics();
+	}
+	return Void();
+}
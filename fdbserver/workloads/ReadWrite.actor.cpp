@@ -20,7 +20,7 @@
 
 #include <boost/lexical_cast.hpp>
 
-#include "fdbrpc/ContinuousSample.h"
+#include "flow/Histogram.h"
 #include "fdbclient/NativeAPI.h"
 #include "fdbserver/TesterInterface.h"
 #include "fdbserver/WorkerInterface.h"
@@ -31,7 +31,6 @@
 #include "flow/TDMetric.actor.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
-const int sampleSize = 10000;
 static Future<Version> nextRV;
 static Version lastRV = invalidVersion;
 
@@ -105,7 +104,8 @@ struct ReadWriteWorkload : KVWorkload {
 
 	vector<Future<Void>> clients;
 	PerfIntCounter aTransactions, bTransactions, retries;
-	ContinuousSample<double> latencies, readLatencies, commitLatencies, GRVLatencies, fullReadLatencies;
+	// Log-bucketed rather than reservoir-sampled, so tail percentiles are trustworthy
+	LogHistogram latencies, readLatencies, commitLatencies, GRVLatencies, fullReadLatencies;
 	double readLatencyTotal; int readLatencyCount;
 
 	vector<uint64_t> insertionCountsToMeasure;
@@ -117,9 +117,7 @@ struct ReadWriteWorkload : KVWorkload {
 
 	ReadWriteWorkload(WorkloadContext const& wcx)
 		: KVWorkload(wcx),
-		latencies( sampleSize ), readLatencies( sampleSize ), fullReadLatencies( sampleSize ), 
-		commitLatencies( sampleSize ), GRVLatencies( sampleSize ), readLatencyTotal( 0 ), 
-		readLatencyCount(0), loadTime(0.0), dependentReads(false), adjacentReads(false), adjacentWrites(false),
+		readLatencyTotal( 0 ), readLatencyCount(0), loadTime(0.0), dependentReads(false), adjacentReads(false), adjacentWrites(false),
 		clientBegin(0),	aTransactions("A Transactions"), bTransactions("B Transactions"), retries("Retries"),
 		totalReadsMetric(LiteralStringRef("RWWorkload.TotalReads")),
 		totalRetriesMetric(LiteralStringRef("RWWorkload.TotalRetries"))
@@ -268,6 +266,8 @@ struct ReadWriteWorkload : KVWorkload {
 			m.push_back(PerfMetric("Median Latency (ms, averaged)", 1000 * latencies.median(), true));
 			m.push_back(PerfMetric("90% Latency (ms, averaged)", 1000 * latencies.percentile(0.90), true));
 			m.push_back(PerfMetric("98% Latency (ms, averaged)", 1000 * latencies.percentile(0.98), true));
+			m.push_back(PerfMetric("99% Latency (ms, averaged)", 1000 * latencies.percentile(0.99), true));
+			m.push_back(PerfMetric("99.9% Latency (ms, averaged)", 1000 * latencies.percentile(0.999), true));
 			m.push_back(PerfMetric("Max Latency (ms, averaged)", 1000 * latencies.max(), true));
 
 			m.push_back(PerfMetric("Mean Row Read Latency (ms)", 1000 * readLatencies.mean(), true));
@@ -280,10 +280,12 @@ struct ReadWriteWorkload : KVWorkload {
 
 			m.push_back(PerfMetric("Mean GRV Latency (ms)", 1000 * GRVLatencies.mean(), true));
 			m.push_back(PerfMetric("Median GRV Latency (ms, averaged)", 1000 * GRVLatencies.median(), true));
+			m.push_back(PerfMetric("99.9% GRV Latency (ms, averaged)", 1000 * GRVLatencies.percentile(0.999), true));
 			m.push_back(PerfMetric("Max GRV Latency (ms, averaged)", 1000 * GRVLatencies.max(), true));
 
 			m.push_back(PerfMetric("Mean Commit Latency (ms)", 1000 * commitLatencies.mean(), true));
 			m.push_back(PerfMetric("Median Commit Latency (ms, averaged)", 1000 * commitLatencies.median(), true));
+			m.push_back(PerfMetric("99.9% Commit Latency (ms, averaged)", 1000 * commitLatencies.percentile(0.999), true));
 			m.push_back(PerfMetric("Max Commit Latency (ms, averaged)", 1000 * commitLatencies.max(), true));
 		}
 
@@ -374,7 +376,7 @@ struct ReadWriteWorkload : KVWorkload {
 		}
 	}
 
-	ACTOR static Future<Void> logLatency( Future<Optional<Value>> f, ContinuousSample<double> *latencies, double* totalLatency, int* latencyCount, EventMetricHandle<ReadMetric> readMetric, bool shouldRecord ) {
+	ACTOR static Future<Void> logLatency( Future<Optional<Value>> f, LogHistogram *latencies, double* totalLatency, int* latencyCount, EventMetricHandle<ReadMetric> readMetric, bool shouldRecord ) {
 		state double readBegin = now();
 		Optional<Value> value = wait( f );
 
@@ -389,7 +391,7 @@ struct ReadWriteWorkload : KVWorkload {
 		return Void();
 	}
 
-	ACTOR static Future<Void> logLatency(Future<Standalone<RangeResultRef>> f, ContinuousSample<double> *latencies, double* totalLatency, int* latencyCount, EventMetricHandle<ReadMetric> readMetric, bool shouldRecord) {
+	ACTOR static Future<Void> logLatency(Future<Standalone<RangeResultRef>> f, LogHistogram *latencies, double* totalLatency, int* latencyCount, EventMetricHandle<ReadMetric> readMetric, bool shouldRecord) {
 		state double readBegin = now();
 		Standalone<RangeResultRef> value = wait(f);
 
@@ -22,7 +22,10 @@
 #include "flow/UnitTest.h"
 
 void forceLinkIndexedSetTests();
+void forceLinkPackedIndexedSetTests();
 void forceLinkDequeTests();
+void forceLinkBoundedMPSCQueueTests();
+void forceLinkHistogramTests();
 void forceLinkFlowTests();
 
 struct UnitTestWorkload : TestWorkload {
@@ -40,7 +43,10 @@ struct UnitTestWorkload : TestWorkload {
 		testPattern = getOption(options, LiteralStringRef("testsMatching"), Value()).toString();
 		testRunLimit = getOption(options, LiteralStringRef("maxTestCases"), -1);
 		forceLinkIndexedSetTests();
+		forceLinkPackedIndexedSetTests();
 		forceLinkDequeTests();
+		forceLinkBoundedMPSCQueueTests();
+		forceLinkHistogramTests();
 		forceLinkFlowTests();
 	}
 
@@ -163,6 +163,7 @@ public:
 		simConnectionFailuresDisableDuration = 0;
 		simBackupAgents = ISimulator::NoBackupAgents;
 		simDrAgents = ISimulator::NoBackupAgents;
+		knobComparisonSamples = 3;
 	}
 	TestSpec( StringRef title, bool dump, bool clear, double startDelay = 30.0, bool useDB = true, double databasePingDelay = -1.0 ) : 
 			title( title ), dumpAfterTest( dump ), 
@@ -193,6 +194,9 @@ public:
 	double simConnectionFailuresDisableDuration;
 	ISimulator::BackupAgentType simBackupAgents; //If set to true, then the simulation runs backup agents on the workers. Can only be used in simulation.
 	ISimulator::BackupAgentType simDrAgents;
+
+	std::vector<std::pair<std::string, std::string>> compareKnobs; //If nonempty, the test runs under the current knob values and again with these overrides applied, and the two sets of metrics are compared.  Can only be used in simulation, where knobs are process globals shared by every simulated process.
+	int knobComparisonSamples; //Runs of the workload per knob configuration when compareKnobs is set
 };
 
 Future<DistributedTestResults> runWorkload( 
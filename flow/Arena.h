@@ -97,6 +97,7 @@ public:
 	Arena& operator=(Arena&&) noexcept(true);
 
 	inline void dependsOn( const Arena& p );
+	inline void reset();
 	inline size_t getSize() const;
 
 	inline bool hasFree( size_t size, const void *address );
@@ -257,6 +258,22 @@ struct ArenaBlock : NonCopyable, ThreadSafeReferenceCounted<ArenaBlock>
 
 	inline void destroy();
 
+	// Drops the references this block holds on other blocks and makes it empty again, so the block
+	// (which is the most recently allocated and therefore normally the largest in its arena) can back
+	// a fresh arena without an allocator round trip.  Caller must hold the only reference, and the
+	// block must not be tiny (tiny blocks have no room worth recycling).
+	void reset() {
+		ASSERT( !isTiny() && isSoleOwnerUnsafe() );
+		int o = nextBlockOffset;
+		while (o) {
+			ArenaBlockRef* r = (ArenaBlockRef*)((char*)getData() + o);
+			o = r->nextBlockOffset;
+			r->next->delref();
+		}
+		nextBlockOffset = 0;
+		bigUsed = sizeof(ArenaBlock);
+	}
+
 	void destroyLeaf() {
 		if (isTiny()) {
 			if (tinySize <= 16) { FastAllocator<16>::release(this); INSTRUMENT_RELEASE("Arena16");}
@@ -301,6 +318,16 @@ inline void Arena::dependsOn( const Arena& p ) {
 	if (p.impl)
 		ArenaBlock::dependOn( impl, p.impl.getPtr() );
 }
+// Empties the arena for reuse, keeping the head (most recently allocated) block's memory.  If
+// anything else still references the arena, it just detaches (leaving the other references, and any
+// data allocated from the arena, intact) and the next allocation starts a fresh block chain.
+inline void Arena::reset() {
+	if (!impl) return;
+	if (impl->isTiny() || !impl->isSoleOwnerUnsafe())
+		impl.clear();
+	else
+		impl->reset();
+}
 inline size_t Arena::getSize() const { return impl ? impl->totalSize() : 0; }
 inline bool Arena::hasFree( size_t size, const void *address ) { return impl && impl->unused() >= size && impl->getNextData() == address; }
 inline void* operator new ( size_t size, Arena& p ) {
@@ -314,6 +341,39 @@ inline void* operator new[] ( size_t size, Arena& p ) {
 }
 inline void operator delete[]( void*, Arena& p ) {}
 
+// A per-thread cache of recycled arenas for short-lived request and reply processing.  Size-classed
+// reuse of individual blocks is already handled by FastAllocator's thread-local magazines; what the
+// pool saves is the create/destroy round trip for the whole block chain on every request, by keeping
+// a few reset() arenas (each retaining its largest block) hot and ready to hand out.
+class ArenaPool {
+public:
+	// Returns an empty arena, backed by a recycled block when one is available
+	static Arena get() {
+		auto& p = pool();
+		if (p.empty()) return Arena();
+		Arena a;
+		a.impl.setPtrUnsafe( p.back() );
+		p.pop_back();
+		return a;
+	}
+	// Recycles the given arena if nothing else references it; otherwise just drops this reference
+	static void release( Arena&& a ) {
+		auto& p = pool();
+		if (a.impl && !a.impl->isTiny() && a.impl->isSoleOwnerUnsafe() && p.size() < MAX_POOLED) {
+			a.impl->reset();
+			p.push_back( a.impl.extractPtr() );
+		} else
+			a = Arena();
+	}
+
+private:
+	enum { MAX_POOLED = 64 };
+	static std::vector<struct ArenaBlock*>& pool() {
+		static thread_local std::vector<ArenaBlock*> p;
+		return p;
+	}
+};
+
 template <class Archive>
 inline void load( Archive& ar, Arena& p ) {
 	p = ar.arena();
@@ -390,6 +450,52 @@ private:
 
 extern std::string format(const char* form, ...);
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define STRINGREF_SSE2_COMPARE 1
+#include <emmintrin.h>
+#endif
+
+// The comparison and common-prefix kernels below are the hottest leaf functions on storage
+// servers (IndexedSet lookups, SkipList conflict detection, key sorting), so they process 16
+// bytes per iteration with SSE2 where available instead of calling out to memcmp, which for the
+// short keys typical of FoundationDB spends most of its time in dispatch overhead.  Both loops
+// read only bytes inside [a,a+cl), so they are safe on arena-allocated strings that end at a
+// page boundary.
+
+// Returns the length of the common prefix of [a,a+cl) and [b,b+cl)
+inline int commonPrefixLength(uint8_t const* a, uint8_t const* b, int cl) {
+	int i = 0;
+#if STRINGREF_SSE2_COMPARE
+	for(; i+16 <= cl; i += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i*)(a+i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+		int unequal = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xffff;
+		if (unequal)
+			return i + ctzll(unequal);
+	}
+#else
+	const int wordEnd = cl - sizeof(uint64_t) + 1;
+	for(; i < wordEnd; i += sizeof(uint64_t)) {
+		uint64_t av, bv;
+		memcpy(&av, a+i, sizeof(uint64_t));
+		memcpy(&bv, b+i, sizeof(uint64_t));
+		if (av != bv)
+			return i + ctzll(av ^ bv) / 8;
+	}
+#endif
+	for(; i < cl; i++)
+		if (a[i] != b[i])
+			return i;
+	return cl;
+}
+
+// memcmp() with the same vectorization as commonPrefixLength(); only the sign of the result is meaningful
+inline int compareBytes(uint8_t const* a, uint8_t const* b, int cl) {
+	int p = commonPrefixLength(a, b, cl);
+	if (p == cl) return 0;
+	return a[p] < b[p] ? -1 : 1;
+}
+
 #pragma pack( push, 4 )
 class StringRef {
 public:
@@ -501,7 +607,7 @@ public:
 	int expectedSize() const { return size(); }
 
 	int compare( StringRef const& other ) const {
-		int c = memcmp( begin(), other.begin(), std::min( size(), other.size() ) );
+		int c = compareBytes( begin(), other.begin(), std::min( size(), other.size() ) );
 		if (c!=0) return c;
 		return size() - other.size();
 	}
@@ -572,15 +678,18 @@ inline bool operator == (const StringRef& lhs, const StringRef& rhs ) {
 	return lhs.size() == rhs.size() && !memcmp(lhs.begin(), rhs.begin(), lhs.size());
 }
 inline bool operator < ( const StringRef& lhs, const StringRef& rhs ) {
-	int c = memcmp( lhs.begin(), rhs.begin(), std::min(lhs.size(), rhs.size()) );
+	int c = compareBytes( lhs.begin(), rhs.begin(), std::min(lhs.size(), rhs.size()) );
 	if (c!=0) return c<0;
 	return lhs.size() < rhs.size();
 }
 inline bool operator > ( const StringRef& lhs, const StringRef& rhs ) {
-	int c = memcmp( lhs.begin(), rhs.begin(), std::min(lhs.size(), rhs.size()) );
+	int c = compareBytes( lhs.begin(), rhs.begin(), std::min(lhs.size(), rhs.size()) );
 	if (c!=0) return c>0;
 	return lhs.size() > rhs.size();
 }
+inline int commonPrefixLength(StringRef a, StringRef b) {
+	return commonPrefixLength(a.begin(), b.begin(), std::min(a.size(), b.size()));
+}
 inline bool operator != (const StringRef& lhs, const StringRef& rhs ) { return !(lhs==rhs); }
 inline bool operator <= ( const StringRef& lhs, const StringRef& rhs ) { return !(lhs>rhs); }
 inline bool operator >= ( const StringRef& lhs, const StringRef& rhs ) { return !(lhs<rhs); }
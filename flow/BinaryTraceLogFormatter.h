@@ -0,0 +1,76 @@
+/*
+ * BinaryTraceLogFormatter.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_BINARY_TRACE_LOG_FORMATTER_H
+#define FLOW_BINARY_TRACE_LOG_FORMATTER_H
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "flow/FastRef.h"
+#include "flow/Trace.h"
+
+// A compact trace log format: each event is a record of length-prefixed field bytes, with
+// attribute names and event types replaced by references into dictionaries interned on
+// first use.  Each file is self-contained; the dictionaries reset when a new file starts.
+//
+// formatEvent() is only ever called from the single trace writer thread (see
+// TraceLog::WriterThread), which is what makes the stateful dictionaries safe.
+struct BinaryTraceLogFormatter : public ITraceLogFormatter, ReferenceCounted<BinaryTraceLogFormatter> {
+	void addref();
+	void delref();
+
+	const char* getExtension();
+	const char* getHeader(); // Also resets the dictionaries for the new file
+	const char* getFooter();
+	std::string formatEvent(const TraceEventFields &fields);
+
+	// Decodes the contents of one binary trace file, header included.  Throws file_corrupt()
+	// on malformed input.
+	class Reader {
+	public:
+		Reader(const uint8_t* data, int length);
+		bool next(TraceEventFields &event); // Returns false at end of input
+
+	private:
+		const uint8_t* pos;
+		const uint8_t* end;
+		std::vector<std::string> keyDict;
+		std::vector<std::string> typeDict;
+
+		uint64_t readVarint();
+		std::string readString();
+		std::string readInterned(std::vector<std::string> &dict);
+	};
+
+private:
+	std::map<std::string, uint32_t> keyDict;
+	std::map<std::string, uint32_t> typeDict;
+
+	static void appendVarint(std::string &out, uint64_t value);
+	static void appendInterned(std::string &out, std::map<std::string, uint32_t> &dict, const std::string &s);
+};
+
+// Converts a binary trace file to the XML format, writing to `out'.  Returns false (after
+// printing a message to stderr) if the file cannot be read or is corrupt.
+bool convertTraceFileToXml(const std::string &inputPath, FILE* out);
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * BoundedMPSCQueue.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flow/UnitTest.h"
+#include "flow/BoundedMPSCQueue.h"
+#include "flow/ThreadPrimitives.h"
+
+TEST_CASE("/flow/BoundedMPSCQueue/interface") {
+	BoundedMPSCQueue<int> q(3);  // rounds up to 4
+	ASSERT( q.empty() );
+	ASSERT( !q.pop().present() );
+
+	ASSERT( q.push(1) && q.push(2) && q.push(3) && q.push(4) );
+	ASSERT( !q.push(5) );  // full
+	ASSERT( q.pop().get() == 1 );
+	ASSERT( q.push(5) );   // the vacated cell is reusable
+	ASSERT( q.pop().get() == 2 );
+
+	int expected = 3;
+	int n = q.popBatch( [&](int v) { ASSERT( v == expected++ ); } );
+	ASSERT( n == 3 && expected == 6 );
+	ASSERT( q.empty() );
+	ASSERT( q.popBatch( [](int) { ASSERT(false); } ) == 0 );
+
+	BoundedMPSCQueue<int> disabled(0);
+	ASSERT( !disabled.push(1) );
+	ASSERT( disabled.empty() && !disabled.pop().present() );
+	return Void();
+}
+
+struct QueueStressProducer {
+	BoundedMPSCQueue<int>* queue;
+	int tag, iterations;
+	Event done;
+
+	THREAD_FUNC run(void* arg) {
+		QueueStressProducer* self = (QueueStressProducer*)arg;
+		for(int i=0; i<self->iterations; i++)
+			while (!self->queue->push( (self->tag<<24) | i ))
+				_mm_pause();
+		self->done.set();
+		THREAD_RETURN;
+	}
+};
+
+TEST_CASE("/flow/BoundedMPSCQueue/threaded") {
+	BoundedMPSCQueue<int> q(128);  // Much smaller than the item count, so producers hit the full ring constantly
+
+	QueueStressProducer producers[2];
+	int next[2] = { 0, 0 };
+	for(int t=0; t<2; t++) {
+		producers[t].queue = &q;
+		producers[t].tag = t;
+		producers[t].iterations = 100000;
+		startThread( QueueStressProducer::run, &producers[t] );
+	}
+
+	int count = 0;
+	while (count < producers[0].iterations + producers[1].iterations) {
+		int n = q.popBatch( [&](int v) {
+			int t = v>>24;
+			ASSERT( (v & 0xffffff) == next[t] );  // Each producer's items arrive in order
+			++next[t];
+		} );
+		if (!n) _mm_pause();
+		count += n;
+	}
+	ASSERT( q.empty() );
+
+	producers[0].done.block();
+	producers[1].done.block();
+	return Void();
+}
+
+void forceLinkBoundedMPSCQueueTests() {}
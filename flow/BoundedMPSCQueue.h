@@ -0,0 +1,122 @@
+/*
+ * BoundedMPSCQueue.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_BOUNDEDMPSCQUEUE_H
+#define FLOW_BOUNDEDMPSCQUEUE_H
+#pragma once
+
+#include "flow/flow.h"
+
+// BoundedMPSCQueue<T> is a multi-producer, single-consumer queue over a fixed-size ring.
+//
+// Unlike ThreadSafeQueue<T> it never allocates per item: each push() is one CAS on the
+// enqueue cursor plus a store to a preallocated cell, and the consumer can drain every
+// published item in one popBatch() call with a single volatile read per cell.  The cost of
+// boundedness is that push() can fail: it returns false when the ring is full (or the
+// queue was constructed with capacity 0), and the caller must fall back to an unbounded
+// path or drop the item.
+//
+// It has no sleep/wake facility of its own; callers that need one (see Net2::onMainThread)
+// should pair it with a flag the consumer sets before blocking and rechecks against empty().
+//
+// Based on the bounded queue at http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// by Dmitry Vyukov, under the same BSD license reproduced in ThreadSafeQueue.h.
+
+// T must be default constructible and copyable.
+template <class T>
+class BoundedMPSCQueue : NonCopyable {
+	struct Cell {
+		volatile int64_t sequence;
+		T data;
+	};
+
+	Cell* cells;
+	int64_t mask;
+	volatile int64_t enqueuePos;  // shared among producers
+	int64_t dequeuePos;           // consumer only
+
+public:
+	// capacity is rounded up to a power of two; 0 constructs a disabled queue whose push()
+	// always returns false.
+	explicit BoundedMPSCQueue(int64_t capacity) : cells(nullptr), mask(-1), enqueuePos(0), dequeuePos(0) {
+		if (capacity <= 0) return;
+		int64_t size = 2;
+		while (size < capacity) size <<= 1;
+		mask = size - 1;
+		cells = new Cell[size];
+		for (int64_t i = 0; i < size; i++)
+			cells[i].sequence = i;
+	}
+	~BoundedMPSCQueue() { delete[] cells; }
+
+	// Returns false if the ring is full; the item was not enqueued and the caller must
+	// dispose of it some other way.  May be called from any thread.
+	bool push(T const& data) {
+		if (!cells) return false;
+		int64_t pos = enqueuePos;
+		while (true) {
+			Cell& cell = cells[pos & mask];
+			int64_t dif = cell.sequence - pos;
+			if (dif == 0) {
+				if (interlockedCompareExchange64(&enqueuePos, pos + 1, pos) == pos) {
+					cell.data = data;
+					interlockedExchange64(&cell.sequence, pos + 1);  // publish, with a full barrier after the data store
+					return true;
+				}
+				pos = enqueuePos;
+			} else if (dif < 0)
+				return false;  // The consumer hasn't vacated this cell yet: the ring is full
+			else
+				pos = enqueuePos;  // Another producer claimed pos; reload and retry
+		}
+	}
+
+	///////////// The below functions may only be called by a single, consumer thread //////////////////
+
+	bool empty() const { return !cells || cells[dequeuePos & mask].sequence != dequeuePos + 1; }
+
+	Optional<T> pop() {
+		if (empty()) return Optional<T>();
+		Cell& cell = cells[dequeuePos & mask];
+		T data = std::move(cell.data);
+		interlockedExchange64(&cell.sequence, dequeuePos + mask + 1);  // vacate, with a full barrier after the data load
+		++dequeuePos;
+		return Optional<T>(std::move(data));
+	}
+
+	// Calls f(item) for every item published at the time of the call, vacating cells as it
+	// goes so producers can reuse them, and returns the number of items processed.
+	template <class F>
+	int popBatch(F&& f) {
+		int count = 0;
+		while (cells) {
+			Cell& cell = cells[dequeuePos & mask];
+			if (cell.sequence != dequeuePos + 1) break;
+			T data = std::move(cell.data);
+			interlockedExchange64(&cell.sequence, dequeuePos + mask + 1);
+			++dequeuePos;
+			++count;
+			f(std::move(data));
+		}
+		return count;
+	}
+};
+
+#endif
@@ -36,6 +36,8 @@
 #ifdef __linux__
 #include <sys/mman.h>
 #include <linux/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 #define FAST_ALLOCATOR_DEBUG 0
@@ -119,7 +121,9 @@ void recordAllocation( void *ptr, size_t size ) {
 #endif
 
 		if( nptrs > 0 ) {
-			uint32_t a = 0, b = 0;
+			// The hash is seeded with the size so that the same stack allocating from different
+			// size classes is accounted separately
+			uint32_t a = (uint32_t)size, b = 0;
 			hashlittle2( buffer, nptrs * sizeof(void *), &a, &b );
 
 			{
@@ -134,6 +138,7 @@ void recordAllocation( void *ptr, size_t size ) {
 						bt.backTrace->push_back( buffer[j] );
 					}
 					bt.totalSize = sizeDelta;
+					bt.objectSize = size;
 					bt.count = countDelta;
 					bt.sampleCount = 1;
 				} else {
@@ -183,13 +188,98 @@ void recordDeallocation( void *ptr ) {
 #endif
 }
 
+// Emits one MemSampleDump trace event per sampled allocation backtrace currently holding memory,
+// plus a MemSampleSizeClass summary per size class, so a live process's memory growth can be
+// attributed among its allocation sites on demand rather than on the system monitor's schedule.
+// Returns the number of backtraces dumped, or -1 if the binary was built without
+// ALLOC_INSTRUMENTATION.
+int64_t dumpMemorySamples() {
+#ifdef ALLOC_INSTRUMENTATION
+	std::unordered_map<uint32_t, BackTraceAccount> traceCounts;
+	memSample_entered = true;
+	{
+		ThreadSpinLockHolder holder( memLock );
+		traceCounts = backTraceLookup;
+	}
+	memSample_entered = false;
+
+	std::map<size_t, std::pair<int64_t, int64_t>> sizeClassTotals;  // size class -> (estimated live bytes, estimated live count)
+	for( auto i = traceCounts.begin(); i != traceCounts.end(); ++i ) {
+		char buf[1024];
+		std::vector<void *> *frames = i->second.backTrace;
+		std::string backTraceStr;
+#if defined(_WIN32)
+		for (int j = 1; j < frames->size(); j++) {
+			_snprintf(buf, 1024, "%p ", frames->at(j));
+			backTraceStr += buf;
+		}
+#else
+		backTraceStr = platform::format_backtrace(&(*frames)[0], frames->size());
+#endif
+		TraceEvent("MemSampleDump")
+			.detail("ObjectSize", i->second.objectSize)
+			.detail("Count", (int64_t)i->second.count)
+			.detail("TotalSize", i->second.totalSize)
+			.detail("SampleCount", i->second.sampleCount)
+			.detailf("Hash", "%lld", (long long)i->first)
+			.detail("Bt", backTraceStr);
+
+		auto& totals = sizeClassTotals[ i->second.objectSize ];
+		totals.first += i->second.totalSize;
+		totals.second += (int64_t)i->second.count;
+	}
+
+	for( auto i = sizeClassTotals.begin(); i != sizeClassTotals.end(); ++i )
+		TraceEvent("MemSampleSizeClass")
+			.detail("ObjectSize", i->first)
+			.detail("TotalSize", i->second.first)
+			.detail("Count", i->second.second)
+			.detail("InverseByteSampleRatio", SAMPLE_BYTES);
+
+	return traceCounts.size();
+#else
+	return -1;
+#endif
+}
+
+static bool g_fastAllocHugePages = false;
+static bool g_fastAllocNumaAware = false;
+
+void setFastAllocatorHugePages( bool enabled ) { g_fastAllocHugePages = enabled; }
+void setFastAllocatorNumaAware( bool enabled ) { g_fastAllocNumaAware = enabled; }
+
+// The maximum number of per-node freelists; threads on nodes beyond this share the last list
+static const int FASTALLOC_MAX_NUMA_NODES = 8;
+
+// The node the calling thread is currently running on, or 0 if NUMA awareness is off or the
+// platform can't tell us.  Cached per thread: magazine traffic is far too hot to pay a syscall
+// per magazine, and threads rarely migrate across sockets.
+static int fastAllocNumaNode() {
+	if (!g_fastAllocNumaAware)
+		return 0;
+#ifdef __linux__
+	static thread_local int cachedNode = -1;
+	if (cachedNode < 0) {
+		unsigned cpu = 0, node = 0;
+		if (syscall( SYS_getcpu, &cpu, &node, nullptr ) != 0)
+			node = 0;
+		cachedNode = std::min<int>( node, FASTALLOC_MAX_NUMA_NODES-1 );
+	}
+	return cachedNode;
+#else
+	return 0;
+#endif
+}
+
 template <int Size>
 struct FastAllocator<Size>::GlobalData {
 	CRITICAL_SECTION mutex;
-	std::vector<void*> magazines;   // These magazines are always exactly magazine_size ("full")
+	std::vector<void*> magazines[FASTALLOC_MAX_NUMA_NODES];   // Per-node freelists of magazines that are always exactly magazine_size ("full")
 	std::vector<std::pair<int, void*>> partial_magazines;  // Magazines that are not "full" and their counts.  Only created by releaseThreadMagazines().
 	long long memoryUsed;
-	GlobalData() : memoryUsed(0) { 
+	long long localMagazineTraffic, remoteMagazineTraffic;
+	long long allocationCount;  // allocate() calls by threads that have since released their magazines
+	GlobalData() : memoryUsed(0), localMagazineTraffic(0), remoteMagazineTraffic(0), allocationCount(0) {
 		InitializeCriticalSection(&mutex);
 	}
 };
@@ -201,7 +291,25 @@ long long FastAllocator<Size>::getMemoryUsed() {
 
 template <int Size>
 long long FastAllocator<Size>::getMemoryUnused() {
-	return globalData()->magazines.size() * magazine_size * Size;
+	size_t magazines = 0;
+	for(int node=0; node<FASTALLOC_MAX_NUMA_NODES; node++)
+		magazines += globalData()->magazines[node].size();
+	return magazines * magazine_size * Size;
+}
+
+template <int Size>
+long long FastAllocator<Size>::getLocalMagazineTraffic() {
+	return globalData()->localMagazineTraffic;
+}
+
+template <int Size>
+long long FastAllocator<Size>::getRemoteMagazineTraffic() {
+	return globalData()->remoteMagazineTraffic;
+}
+
+template <int Size>
+long long FastAllocator<Size>::getAllocationCount() {
+	return globalData()->allocationCount + threadData.allocCount;
 }
 
 static int64_t getSizeCode(int i) {
@@ -223,6 +331,7 @@ template<int Size>
 void *FastAllocator<Size>::allocate() {
 #if FASTALLOC_THREAD_SAFE
 	ThreadData& thr = threadData;
+	++thr.allocCount;
 	if (!thr.freelist) {
 		if (thr.alternate) {
 			thr.freelist = thr.alternate;
@@ -337,15 +446,29 @@ void FastAllocator<Size>::check(void* ptr, bool alloc) {
 template <int Size>
 void FastAllocator<Size>::getMagazine() {
 	if (threadInitFunction) threadInitFunction();
+	int node = fastAllocNumaNode();
 	EnterCriticalSection(&globalData()->mutex);
-	if (globalData()->magazines.size()) {
-		void* m = globalData()->magazines.back();
-		globalData()->magazines.pop_back();
+	if (globalData()->magazines[node].size()) {
+		void* m = globalData()->magazines[node].back();
+		globalData()->magazines[node].pop_back();
+		++globalData()->localMagazineTraffic;
 		LeaveCriticalSection(&globalData()->mutex);
 		threadData.freelist = m;
 		threadData.count = magazine_size;
 		return;
-	} else if (globalData()->partial_magazines.size()) {
+	}
+	for(int otherNode=0; otherNode<FASTALLOC_MAX_NUMA_NODES; otherNode++) {
+		if (otherNode != node && globalData()->magazines[otherNode].size()) {
+			void* m = globalData()->magazines[otherNode].back();
+			globalData()->magazines[otherNode].pop_back();
+			++globalData()->remoteMagazineTraffic;
+			LeaveCriticalSection(&globalData()->mutex);
+			threadData.freelist = m;
+			threadData.count = magazine_size;
+			return;
+		}
+	}
+	if (globalData()->partial_magazines.size()) {
 		std::pair<int, void*> p = globalData()->partial_magazines.back();
 		globalData()->partial_magazines.pop_back();
 		LeaveCriticalSection(&globalData()->mutex);
@@ -353,7 +476,6 @@ void FastAllocator<Size>::getMagazine() {
 		threadData.count = p.first;
 		return;
 	}
-	globalData()->memoryUsed += magazine_size*Size;
 	LeaveCriticalSection(&globalData()->mutex);
 
 	// Allocate a new page of data from the system allocator
@@ -365,7 +487,7 @@ void FastAllocator<Size>::getMagazine() {
 #if FAST_ALLOCATOR_DEBUG
 #ifdef WIN32
 	static int alt = 0; alt++;
-	block = (void**)VirtualAllocEx( GetCurrentProcess(), 
+	block = (void**)VirtualAllocEx( GetCurrentProcess(),
 									(void*)( ((getSizeCode(Size)<<11) + alt) * magazine_size*Size), magazine_size*Size, MEM_COMMIT|MEM_RESERVE, PAGE_READWRITE );
 #else
 	static int alt = 0; alt++;
@@ -373,43 +495,69 @@ void FastAllocator<Size>::getMagazine() {
 	block = (void**)mmap( desiredBlock, magazine_size*Size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
 	ASSERT( block == desiredBlock );
 #endif
+	EnterCriticalSection(&globalData()->mutex);
+	globalData()->memoryUsed += magazine_size*Size;
+	LeaveCriticalSection(&globalData()->mutex);
 #else
-	// FIXME: We should be able to allocate larger magazine sizes here if we
-	// detect that the underlying system supports hugepages.  Using hugepages
-	// with smaller-than-2MiB magazine sizes strands memory.  See issue #909.
-	block = (void **)::allocate(magazine_size * Size, false);
+	// Magazines are smaller than a 2MiB huge page, which would strand memory if each magazine
+	// got its own (see issue #909), so when huge pages are enabled we carve one slab into
+	// several magazines and make the extras immediately available to other threads on this
+	// node.  First touch from this thread puts the slab's pages on the local NUMA node.
+	static const int slabBytes = 2<<20;
+	static const int magazinesPerSlab = slabBytes / (magazine_size*Size);
+	if (g_fastAllocHugePages && magazinesPerSlab > 1) {
+		block = (void **)::allocate(slabBytes, true);
+		EnterCriticalSection(&globalData()->mutex);
+		globalData()->memoryUsed += slabBytes;
+		for(int m=1; m<magazinesPerSlab; m++)
+			globalData()->magazines[node].push_back( linkMagazine( (void**)((uint8_t*)block + m*magazine_size*Size) ) );
+		LeaveCriticalSection(&globalData()->mutex);
+	} else {
+		block = (void **)::allocate(magazine_size * Size, false);
+		EnterCriticalSection(&globalData()->mutex);
+		globalData()->memoryUsed += magazine_size*Size;
+		LeaveCriticalSection(&globalData()->mutex);
+	}
 #endif
 
-	//void** block = new void*[ magazine_size * PSize ];
+	threadData.freelist = linkMagazine(block);
+	threadData.count = magazine_size;
+}
+
+template <int Size>
+void* FastAllocator<Size>::linkMagazine(void** block) {
 	for(int i=0; i<magazine_size-1; i++) {
 		block[i*PSize+1] = block[i*PSize] = &block[(i+1)*PSize];
 		check( &block[i*PSize], false );
 	}
-		
+
 	block[(magazine_size-1)*PSize+1] = block[(magazine_size-1)*PSize] = 0;
 	check( &block[(magazine_size-1)*PSize], false );
-	threadData.freelist = block;
-	threadData.count = magazine_size;
+	return block;
 }
 template <int Size>
 void FastAllocator<Size>::releaseMagazine(void* mag) {
+	int node = fastAllocNumaNode();
 	EnterCriticalSection(&globalData()->mutex);
-	globalData()->magazines.push_back(mag);
+	globalData()->magazines[node].push_back(mag);
 	LeaveCriticalSection(&globalData()->mutex);
 }
 template <int Size>
 void FastAllocator<Size>::releaseThreadMagazines() {
 	ThreadData& thr = threadData;
 
-	if (thr.freelist || thr.alternate) {
+	if (thr.freelist || thr.alternate || thr.allocCount) {
+		int node = fastAllocNumaNode();
 		EnterCriticalSection(&globalData()->mutex);
 		if (thr.freelist) globalData()->partial_magazines.push_back( std::make_pair(thr.count, thr.freelist) );
-		if (thr.alternate) globalData()->magazines.push_back(thr.alternate);
+		if (thr.alternate) globalData()->magazines[node].push_back(thr.alternate);
+		globalData()->allocationCount += thr.allocCount;
 		LeaveCriticalSection(&globalData()->mutex);
 	}
 	thr.count = 0;
 	thr.alternate = 0;
 	thr.freelist = 0;
+	thr.allocCount = 0;
 }
 
 void releaseAllThreadMagazines() {
@@ -424,6 +572,30 @@ void releaseAllThreadMagazines() {
 	FastAllocator<4096>::releaseThreadMagazines();
 }
 
+void getFastAllocatorNumaTraffic( int64_t& localMagazines, int64_t& remoteMagazines ) {
+	localMagazines =
+		FastAllocator<16>::getLocalMagazineTraffic() + FastAllocator<32>::getLocalMagazineTraffic() +
+		FastAllocator<64>::getLocalMagazineTraffic() + FastAllocator<128>::getLocalMagazineTraffic() +
+		FastAllocator<256>::getLocalMagazineTraffic() + FastAllocator<512>::getLocalMagazineTraffic() +
+		FastAllocator<1024>::getLocalMagazineTraffic() + FastAllocator<2048>::getLocalMagazineTraffic() +
+		FastAllocator<4096>::getLocalMagazineTraffic();
+	remoteMagazines =
+		FastAllocator<16>::getRemoteMagazineTraffic() + FastAllocator<32>::getRemoteMagazineTraffic() +
+		FastAllocator<64>::getRemoteMagazineTraffic() + FastAllocator<128>::getRemoteMagazineTraffic() +
+		FastAllocator<256>::getRemoteMagazineTraffic() + FastAllocator<512>::getRemoteMagazineTraffic() +
+		FastAllocator<1024>::getRemoteMagazineTraffic() + FastAllocator<2048>::getRemoteMagazineTraffic() +
+		FastAllocator<4096>::getRemoteMagazineTraffic();
+}
+
+int64_t getTotalFastAllocationCount() {
+	return
+		FastAllocator<16>::getAllocationCount() + FastAllocator<32>::getAllocationCount() +
+		FastAllocator<64>::getAllocationCount() + FastAllocator<128>::getAllocationCount() +
+		FastAllocator<256>::getAllocationCount() + FastAllocator<512>::getAllocationCount() +
+		FastAllocator<1024>::getAllocationCount() + FastAllocator<2048>::getAllocationCount() +
+		FastAllocator<4096>::getAllocationCount();
+}
+
 int64_t getTotalUnusedAllocatedMemory() {
 	int64_t unusedMemory = 0;
 
@@ -80,6 +80,7 @@ struct BackTraceAccount {
 	double count;
 	size_t sampleCount;
 	size_t totalSize;
+	size_t objectSize;  // the FastAllocator size class the samples came from; sampling keys on (backtrace, size class), so one account never mixes classes
 	std::vector<void*> *backTrace;
 };
 // maps from a hash of a backtrace to a backtrace and the total size of data currently allocated from this stack
@@ -109,6 +110,16 @@ public:
 	static long long getMemoryUsed();
 	static long long getMemoryUnused();
 
+	// Counts of magazines handed to a thread from its own NUMA node's freelist vs. stolen
+	// from another node's.  Always zero unless setFastAllocatorNumaAware(true) was called.
+	static long long getLocalMagazineTraffic();
+	static long long getRemoteMagazineTraffic();
+
+	// Total number of allocate() calls: those made by the calling thread plus those flushed
+	// by threads that have released their magazines.  Divided by a count of operations from
+	// the same trace interval, this gives allocations per operation.
+	static long long getAllocationCount();
+
 	static void releaseThreadMagazines();
 
 #ifdef ALLOC_INSTRUMENTATION
@@ -127,6 +138,7 @@ private:
 		void* freelist;
 		int count;		  // there are count items on freelist
 		void* alternate;  // alternate is either a full magazine, or an empty one
+		long long allocCount;  // allocate() calls made by this thread, flushed to GlobalData by releaseThreadMagazines()
 	};
 	static thread_local ThreadData threadData;
 	static GlobalData* globalData() {
@@ -146,11 +158,17 @@ private:
 	FastAllocator();  // not implemented
 	static void getMagazine();   // sets threadData.freelist and threadData.count
 	static void releaseMagazine(void*);
+	static void* linkMagazine(void** block);   // builds the in-place freelist for a raw magazine_size*Size block
 };
 
 void releaseAllThreadMagazines();
 int64_t getTotalUnusedAllocatedMemory();
 void setFastAllocatorThreadInitFunction( void (*)() );  // The given function will be called at least once in each thread that allocates from a FastAllocator.  Currently just one such function is tracked.
+void setFastAllocatorHugePages( bool enabled );  // New magazines will be carved from 2MiB huge page slabs when the system supports them
+void setFastAllocatorNumaAware( bool enabled );  // Keep per-NUMA-node magazine freelists so a thread's magazines come from local memory
+void getFastAllocatorNumaTraffic( int64_t& localMagazines, int64_t& remoteMagazines );  // Sums getLocal/RemoteMagazineTraffic over all sizes
+int64_t getTotalFastAllocationCount();  // Sums getAllocationCount over all sizes
+int64_t dumpMemorySamples();  // Traces the sampled allocation backtraces and per-size-class totals now; returns the number of backtraces, or -1 without ALLOC_INSTRUMENTATION
 
 template<int X>
 class NextPowerOfTwo {
@@ -0,0 +1,129 @@
+/*
+ * FlowBench.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Microbenchmarks for flow primitives.  These are named under !/flowbench so that random unit
+// test runs (which match the prefix "/") never pick them up; run them with
+//
+//     fdbserver -r unittests -f !/flowbench
+//
+// or through tests/FlowBench.txt.  Each benchmark logs one FlowBench trace event with ns/op and
+// allocations/op so results can be extracted mechanically and tracked across releases.
+
+#include "flow/flow.h"
+#include "flow/IndexedSet.h"
+#include "flow/serialize.h"
+#include "flow/UnitTest.h"
+#include "flow/actorcompiler.h"  // This must be the last #include.
+
+static void reportBench( const char* name, int64_t ops, double elapsed, int64_t allocations ) {
+	TraceEvent("FlowBench")
+		.detail("Benchmark", name)
+		.detail("Ops", ops)
+		.detail("Elapsed", elapsed)
+		.detail("NsPerOp", 1e9 * elapsed / ops)
+		.detail("AllocationsPerOp", double(allocations) / ops);
+	printf("FlowBench %-24s %8.1f ns/op  %6.3f allocations/op  (%lld ops in %0.3fs)\n",
+		name, 1e9 * elapsed / ops, double(allocations) / ops, (long long)ops, elapsed);
+}
+
+TEST_CASE("!/flowbench/FastAllocator") {
+	int64_t ops = 20000000;
+	int64_t startAllocs = getTotalFastAllocationCount();
+	double begin = timer_monotonic();
+	for(int64_t i = 0; i < ops; i++) {
+		void* p = FastAllocator<64>::allocate();
+		FastAllocator<64>::release(p);
+	}
+	reportBench("FastAllocator<64>", ops, timer_monotonic() - begin, getTotalFastAllocationCount() - startAllocs);
+	return Void();
+}
+
+TEST_CASE("!/flowbench/StringRefCompare") {
+	// A small alphabet makes prefixes collide often, exercising the compare loop rather than
+	// returning on the first byte
+	Arena arena;
+	std::vector<StringRef> strings;
+	for(int i = 0; i < 1000; i++) {
+		int len = g_random->randomInt(8, 64);
+		uint8_t* data = new (arena) uint8_t[len];
+		for(int j = 0; j < len; j++)
+			data[j] = g_random->randomInt(0, 4);
+		strings.push_back(StringRef(data, len));
+	}
+
+	int64_t ops = 20000000;
+	int64_t startAllocs = getTotalFastAllocationCount();
+	int64_t sum = 0;
+	double begin = timer_monotonic();
+	for(int64_t i = 0; i < ops; i++)
+		sum += strings[i % strings.size()].compare(strings[(i * 31) % strings.size()]);
+	double elapsed = timer_monotonic() - begin;
+	static volatile int64_t benchSink;
+	benchSink = sum;  // Keeps the loop from being optimized away
+	reportBench("StringRef::compare", ops, elapsed, getTotalFastAllocationCount() - startAllocs);
+	return Void();
+}
+
+TEST_CASE("!/flowbench/IndexedSetInsert") {
+	int64_t ops = 1000000;
+	int64_t startAllocs = getTotalFastAllocationCount();
+	IndexedSet<int, int> is;
+	double begin = timer_monotonic();
+	for(int64_t i = 0; i < ops; i++)
+		is.insert((int)(i * 2654435761u), 1);  // Fibonacci hashing scatters the insertion order
+	double elapsed = timer_monotonic() - begin;
+	reportBench("IndexedSet::insert", ops, elapsed, getTotalFastAllocationCount() - startAllocs);
+	return Void();
+}
+
+ACTOR static Future<Void> benchYield( int64_t ops ) {
+	state int64_t i = 0;
+	for(; i < ops; i++)
+		wait( yield() );
+	return Void();
+}
+
+TEST_CASE("!/flowbench/ActorYield") {
+	// The cost of suspending and resuming an actor through the ready queue, including the
+	// already-ready fast path that most yields take
+	state int64_t ops = 1000000;
+	state int64_t startAllocs = getTotalFastAllocationCount();
+	state double begin = timer_monotonic();
+	wait( benchYield(ops) );
+	reportBench("ActorYield", ops, timer_monotonic() - begin, getTotalFastAllocationCount() - startAllocs);
+	return Void();
+}
+
+TEST_CASE("!/flowbench/BinaryWriter") {
+	int64_t ops = 1000000;
+	int64_t startAllocs = getTotalFastAllocationCount();
+	int64_t total = 0;
+	double begin = timer_monotonic();
+	for(int64_t i = 0; i < ops; i++) {
+		BinaryWriter wr(Unversioned());
+		wr << i << (uint32_t)i << (uint16_t)i << (uint8_t)i;
+		wr.serializeBytes(&i, sizeof(i));
+		total += wr.getLength();
+	}
+	double elapsed = timer_monotonic() - begin;
+	ASSERT(total == ops * 23);
+	reportBench("BinaryWriter", ops, elapsed, getTotalFastAllocationCount() - startAllocs);
+	return Void();
+}
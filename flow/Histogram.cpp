@@ -0,0 +1,92 @@
+/*
+ * Histogram.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flow/UnitTest.h"
+#include "flow/Histogram.h"
+#include "flow/serialize.h"
+
+#include <algorithm>
+#include <vector>
+
+TEST_CASE("/flow/Histogram/percentileAccuracy") {
+	LogHistogram h;
+	std::vector<double> exact;
+
+	ASSERT( h.percentile(0.999) == 0 );
+
+	for(int i = 0; i < 100000; i++) {
+		// Log-uniform latencies from ~1us to ~10s, the range we care about
+		double sample = std::pow(10.0, g_random->random01() * 7 - 6);
+		h.addSample(sample);
+		exact.push_back(sample);
+	}
+	std::sort(exact.begin(), exact.end());
+
+	ASSERT( h.samples() == exact.size() );
+	ASSERT( h.min() == exact.front() && h.max() == exact.back() );
+
+	for(double p : { 0.05, 0.5, 0.9, 0.99, 0.999 }) {
+		double reference = exact[std::max<size_t>(1, size_t(std::ceil(p * exact.size()))) - 1];
+		double estimate = h.percentile(p);
+		// The bucket lower bound is within one sub-bucket (2^(1/8), ~9.1%) below the true value
+		ASSERT( estimate <= reference * 1.0001 && estimate >= reference / 1.15 );
+	}
+
+	return Void();
+}
+
+TEST_CASE("/flow/Histogram/mergeAndSerialize") {
+	LogHistogram a, b, combined;
+	for(int i = 0; i < 10000; i++) {
+		double sample = g_random->random01();
+		(g_random->coinflip() ? a : b).addSample(sample);
+		combined.addSample(sample);
+	}
+
+	a.merge(b);
+	ASSERT( a.samples() == combined.samples() );
+	ASSERT( a.min() == combined.min() && a.max() == combined.max() );
+	for(double p : { 0.1, 0.5, 0.99, 0.999 }) {
+		ASSERT( a.percentile(p) == combined.percentile(p) );
+	}
+
+	BinaryWriter wr( Unversioned() );
+	wr << a;
+	LogHistogram decoded;
+	BinaryReader rd( wr.toStringRef(), Unversioned() );
+	rd >> decoded;
+
+	ASSERT( decoded.samples() == a.samples() );
+	ASSERT( decoded.min() == a.min() && decoded.max() == a.max() );
+	ASSERT( decoded.mean() == a.mean() );
+	for(double p : { 0.1, 0.5, 0.99, 0.999 }) {
+		ASSERT( decoded.percentile(p) == a.percentile(p) );
+	}
+
+	// Out-of-range samples saturate the end buckets rather than being dropped
+	LogHistogram extremes;
+	extremes.addSample(0).addSample(-1).addSample(1e-9).addSample(1e9);
+	ASSERT( extremes.samples() == 4 );
+	ASSERT( extremes.percentile(1.0) == 1e9 );
+
+	return Void();
+}
+
+void forceLinkHistogramTests() {}
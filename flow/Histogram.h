@@ -0,0 +1,157 @@
+/*
+ * Histogram.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_HISTOGRAM_H
+#define FLOW_HISTOGRAM_H
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+#include "flow/flow.h"
+
+// A fixed-memory log-bucketed histogram for latencies in seconds.  Unlike
+// ContinuousSample's reservoir, every sample lands in a bucket, so tail percentiles
+// (p99.9 and beyond) are exact up to the bucket resolution instead of being noisy
+// functions of which samples survived the reservoir.  Recording is one array increment
+// with no allocation; the bucket index comes straight from the bits of the double.
+//
+// Histograms can be merged, and serialize sparsely (only nonzero buckets), so per-process
+// snapshots can be combined into cluster-wide percentiles.
+class LogHistogram {
+public:
+	static const int SUB_BUCKET_BITS = 3; // 8 sub-buckets per power of two: <=9.1% relative error
+	static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	static const int MIN_EXPONENT = -20;  // ~0.95 microseconds
+	static const int MAX_EXPONENT = 7;    // values past 255 seconds saturate the last bucket
+	static const int BUCKETS = (MAX_EXPONENT - MIN_EXPONENT + 1) * SUB_BUCKETS;
+
+	LogHistogram() { clear(); }
+
+	LogHistogram& addSample(double sample) {
+		if (!populationSize)
+			_min = _max = sample;
+		++populationSize;
+		sum += sample;
+		_max = std::max(_max, sample);
+		_min = std::min(_min, sample);
+		++buckets[bucketFor(sample)];
+		return *this;
+	}
+
+	void merge(LogHistogram const& other) {
+		if (!other.populationSize) return;
+		if (!populationSize) {
+			_min = other._min;
+			_max = other._max;
+		} else {
+			_min = std::min(_min, other._min);
+			_max = std::max(_max, other._max);
+		}
+		populationSize += other.populationSize;
+		sum += other.sum;
+		for(int i = 0; i < BUCKETS; i++)
+			buckets[i] += other.buckets[i];
+	}
+
+	double mean() const {
+		if (!populationSize) return 0;
+		return sum / populationSize;
+	}
+
+	double median() const { return percentile(0.5); }
+
+	// Returns the lower bound of the bucket holding the requested percentile, clamped to
+	// the exact observed min and max.
+	double percentile(double percentile) const {
+		if (!populationSize || percentile < 0.0 || percentile > 1.0)
+			return 0;
+		uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(percentile * populationSize));
+		if (rank >= populationSize)
+			return _max;
+		uint64_t seen = 0;
+		for(int i = 0; i < BUCKETS; i++) {
+			seen += buckets[i];
+			if (seen >= rank)
+				return std::min(_max, std::max(_min, bucketLowerBound(i)));
+		}
+		return _max;
+	}
+
+	double min() const { return _min; }
+	double max() const { return _max; }
+	uint64_t samples() const { return populationSize; }
+
+	void clear() {
+		memset(buckets, 0, sizeof(buckets));
+		populationSize = 0;
+		sum = 0;
+		_min = _max = 0;
+	}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		ar & populationSize & sum & _min & _max;
+		if (Ar::isDeserializing) {
+			memset(buckets, 0, sizeof(buckets));
+			uint32_t nonZero;
+			ar & nonZero;
+			for(uint32_t i = 0; i < nonZero; i++) {
+				uint16_t bucket;
+				uint64_t count;
+				ar & bucket & count;
+				if (bucket < BUCKETS)
+					buckets[bucket] += count;
+			}
+		} else {
+			uint32_t nonZero = 0;
+			for(int i = 0; i < BUCKETS; i++)
+				if (buckets[i])
+					++nonZero;
+			ar & nonZero;
+			for(uint16_t i = 0; i < BUCKETS; i++)
+				if (buckets[i])
+					ar & i & buckets[i];
+		}
+	}
+
+private:
+	uint64_t buckets[BUCKETS];
+	uint64_t populationSize;
+	double sum;
+	double _min, _max;
+
+	static int bucketFor(double sample) {
+		if (!(sample > 0)) return 0;
+		uint64_t bits;
+		memcpy(&bits, &sample, sizeof(bits));
+		int exponent = int((bits >> 52) & 0x7ff) - 1023;
+		if (exponent < MIN_EXPONENT) return 0;
+		if (exponent > MAX_EXPONENT) return BUCKETS - 1;
+		int sub = int(bits >> (52 - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+		return (exponent - MIN_EXPONENT) * SUB_BUCKETS + sub;
+	}
+
+	static double bucketLowerBound(int bucket) {
+		return std::pow(2.0, MIN_EXPONENT + bucket / SUB_BUCKETS) * (1.0 + double(bucket % SUB_BUCKETS) / SUB_BUCKETS);
+	}
+};
+
+#endif
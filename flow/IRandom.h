@@ -51,7 +51,9 @@ public:
 
 	template <class Ar>
 	void serialize_unversioned(Ar& ar) { // Changing this serialization format will affect key definitions, so can't simply be versioned!
-		ar & part[0] & part[1];
+		// One copy of both parts; byte-identical to serializing part[0] then part[1]
+		static_assert( sizeof(UID) == 2*sizeof(uint64_t), "UID must have no padding to be serialized as a single copy" );
+		ar.serializeBinaryItem(*this);
 	}
 };
 
@@ -47,19 +47,36 @@ public:
 	virtual void init() = 0;
 };
 
-struct ThreadAction { 
+struct ThreadAction {
 	virtual void operator()(IThreadPoolReceiver*) = 0;		// self-destructs
 	virtual void cancel() = 0;
 	virtual double getTimeEstimate() = 0;                   // for simulation
 };
 typedef ThreadAction* PThreadAction;
 
+// Statistics about one priority lane of a thread pool, accumulated since the last call to
+// getAndResetQueueStats()
+struct ThreadPoolQueueStats {
+	int64_t posted;          // actions posted to the lane
+	int64_t started;         // actions dequeued by a pool thread
+	double totalQueueDelay;  // total seconds started actions spent queued
+	double maxQueueDelay;    // longest time a started action spent queued, in seconds
+
+	ThreadPoolQueueStats() : posted(0), started(0), totalQueueDelay(0), maxQueueDelay(0) {}
+};
+
 class IThreadPool {
 public:
+	enum Priority { High = 0, Low = 1 };
+
 	virtual ~IThreadPool() {}
 	virtual Future<Void> getError() = 0;  // asynchronously throws an error if there is an internal error
 	virtual void addThread( IThreadPoolReceiver* userData ) = 0;
 	virtual void post( PThreadAction action ) = 0;
+	// Post to a priority lane.  Pools without priority lanes run everything in arrival order.
+	virtual void post( PThreadAction action, int priority ) { post( action ); }
+	// Queue-delay statistics for a lane; zeroes for pools that don't track them
+	virtual ThreadPoolQueueStats getAndResetQueueStats( int priority ) { return ThreadPoolQueueStats(); }
 	virtual Future<Void> stop() = 0;
 	virtual bool isCoro() const { return false; }
 	virtual void addref() = 0;
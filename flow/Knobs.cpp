@@ -44,6 +44,9 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	init( SLOWTASK_PROFILING_INTERVAL,                       0.125 ); // A value of 0 disables SlowTask profiling
 	init( SLOWTASK_PROFILING_MAX_LOG_INTERVAL,                 1.0 );
 	init( SLOWTASK_PROFILING_LOG_BACKOFF,                      2.0 );
+	init( SLOWTASK_OFFENDER_INTERVAL,                         60.0 ); // A value of 0 disables SlowTaskOffender summaries
+	init( SLOWTASK_OFFENDER_COUNT,                              10 );
+	init( CHECK_YIELD_AUDIT_BUDGET,                              0 ); // Seconds between yield checks above which CheckYieldAudit is logged; 0 disables auditing
 
 	init( RANDOMSEED_RETRY_LIMIT,                                4 );
 
@@ -59,9 +62,16 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	init( MAX_RECONNECTION_TIME,                               0.5 );
 	init( RECONNECTION_TIME_GROWTH_RATE,                       1.2 );
 	init( RECONNECTION_RESET_TIME,                             5.0 );
+	init( RECONNECTION_SUCCESS_DECAY_RATE,                     0.5 );
+	init( MAX_CONCURRENT_CONNECTS,                             100 ); if( randomize && BUGGIFY ) MAX_CONCURRENT_CONNECTS = 2;
 	init( CONNECTION_ACCEPT_DELAY,                            0.01 );
+	init( COMPRESS_INTERDC_TRAFFIC,                              1 ); if( randomize && BUGGIFY ) COMPRESS_INTERDC_TRAFFIC = 0;
+	init( TRANSPORT_FAILURE_DETECTION,                           1 ); if( randomize && BUGGIFY ) TRANSPORT_FAILURE_DETECTION = 0;
+	init( TRANSPORT_LIVENESS_UPDATE_INTERVAL,                  0.5 );
+	init( DISABLE_SAME_HOST_CHECKSUMS,                           1 ); if( randomize && BUGGIFY ) DISABLE_SAME_HOST_CHECKSUMS = 0;
 
 	init( TLS_CERT_REFRESH_DELAY_SECONDS,                 12*60*60 );
+	init( TLS_HANDSHAKE_THREADS,                                 2 );
 
 	//AsyncFileCached
 	init( PAGE_CACHE_4K,                                2000LL<<20 );
@@ -71,11 +81,27 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	init( BUGGIFY_SIM_PAGE_CACHE_4K,                           1e6 );
 	init( BUGGIFY_SIM_PAGE_CACHE_64K,                          1e6 );
 	init( MAX_EVICT_ATTEMPTS,                                  100 ); if( randomize && BUGGIFY ) MAX_EVICT_ATTEMPTS = 2;
+	init( PAGE_CACHE_FILE_SOFT_QUOTA_FRACTION,                 0.5 ); if( randomize && BUGGIFY ) PAGE_CACHE_FILE_SOFT_QUOTA_FRACTION = 0.05;
+	init( PAGE_CACHE_LOG_ROLE_FRACTION,                        0.2 ); if( randomize && BUGGIFY ) PAGE_CACHE_LOG_ROLE_FRACTION = 0.02;
+	init( PAGE_CACHE_STORAGE_ROLE_FRACTION,                    0.6 ); if( randomize && BUGGIFY ) PAGE_CACHE_STORAGE_ROLE_FRACTION = 0.02;
 	init( PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION,                 0.1 ); if( randomize && BUGGIFY ) PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION = 0.0; else if( randomize && BUGGIFY ) PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION = 1.0;
 
+	//AsyncFileReadAhead
+	init( READ_AHEAD_MEMORY_BUDGET,                      64LL<<20 ); if( randomize && BUGGIFY ) READ_AHEAD_MEMORY_BUDGET = 4LL<<20;
+
 	//AsyncFileKAIO
 	init( MAX_OUTSTANDING,                                      64 );
 	init( MIN_SUBMIT,                                           10 );
+	init( KAIO_LATENCY_LOG_INTERVAL,                          30.0 ); if( randomize && BUGGIFY ) KAIO_LATENCY_LOG_INTERVAL = 1.0;
+
+	//FastAlloc
+	init( FASTALLOC_HUGE_PAGES,                                  0 );
+	init( FASTALLOC_NUMA_AWARE,                                  0 );
+
+	//AsyncFileUring
+	init( ENABLE_IO_URING,                                       0 );
+	init( URING_SQPOLL,                                          0 );
+	init( URING_SQPOLL_IDLE_MS,                                100 );
 
 	init( PAGE_WRITE_CHECKSUM_HISTORY,                           0 ); if( randomize && BUGGIFY ) PAGE_WRITE_CHECKSUM_HISTORY = 10000000;
 
@@ -93,14 +119,26 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	//Net2 and FlowTransport
 	init( MIN_COALESCE_DELAY,                                10e-6 ); if( randomize && BUGGIFY ) MIN_COALESCE_DELAY = 0;
 	init( MAX_COALESCE_DELAY,                                20e-6 ); if( randomize && BUGGIFY ) MAX_COALESCE_DELAY = 0;
+	init( COALESCE_IMMEDIATE_BYTES,                           4096 ); if( randomize && BUGGIFY ) COALESCE_IMMEDIATE_BYTES = 128;
 	init( SLOW_LOOP_CUTOFF,                          15.0 / 1000.0 );
 	init( SLOW_LOOP_SAMPLING_RATE,                             0.1 );
 	init( TSC_YIELD_TIME,                                  1000000 );
+	init( READY_QUEUE_AGING_INTERVAL,                            0 ); // Tasks queued longer than this are boosted by the priority step below; 0 disables aging
+	init( READY_QUEUE_AGING_PRIORITY_BOOST,                   1000 );
+	init( NET2_THREAD_READY_RING,                             4096 ); if( randomize && BUGGIFY ) NET2_THREAD_READY_RING = g_random->coinflip() ? 0 : 4;  // Exercise the unbounded fallback path
+	init( TIMER_WHEEL_RESOLUTION,                            0.004 ); if( randomize && BUGGIFY ) TIMER_WHEEL_RESOLUTION = 0.5;
+	init( TIMER_WHEEL_BUCKETS,                                1024 ); if( randomize && BUGGIFY ) TIMER_WHEEL_BUCKETS = g_random->coinflip() ? 0 : 4;  // Exercise the heap fallback and bucket collisions
+	init( LISTEN_SOCKET_COUNT,                                   1 );
+	init( NOTIFIED_VERSION_WAKE_LIMIT,                        1000 ); if( randomize && BUGGIFY ) NOTIFIED_VERSION_WAKE_LIMIT = 1;
+
+	//Coroutines
+	init( CORO_STACKLESS_SWITCHER,                               1 ); if( randomize && BUGGIFY ) CORO_STACKLESS_SWITCHER = 0;  // Resume blocking coroutine waits through the actor-based switcher
 
 	//Network
 	init( PACKET_LIMIT,                                  100LL<<20 );
 	init( PACKET_WARNING,                                  2LL<<20 );  // 2MB packet warning quietly allows for 1MB system messages
 	init( TIME_OFFSET_LOGGING_INTERVAL,                       60.0 );
+	init( DNS_CACHE_TTL,                                      60.0 ); if( randomize && BUGGIFY ) DNS_CACHE_TTL = 0.1;
 
 	//Sim2
 	init( MIN_OPEN_TIME,                                    0.0002 );
@@ -120,9 +158,11 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	init( MIN_TRACE_SEVERITY,                 isSimulated ? 0 : 10 ); // Related to the trace severity in Trace.h
 	init( MAX_TRACE_SUPPRESSIONS,                              1e4 );
 	init( TRACE_SYNC_ENABLED,                                    0 );
+	init( TRACE_FORMAT,                                      "xml" ); // "xml" or "bin" (compact binary; convert with `fdbserver -r tracebinarytoxml')
 	init( TRACE_EVENT_METRIC_UNITS_PER_SAMPLE,                 500 );
 	init( TRACE_EVENT_THROTTLER_SAMPLE_EXPIRY,              1800.0 ); // 30 mins
 	init( TRACE_EVENT_THROTTLER_MSG_LIMIT,                   20000 );
+	init( TRACE_LOG_MAX_PENDING_BYTES,                        50e6 );
 
 	//TDMetrics
 	init( MAX_METRICS,                                         600 );
@@ -143,6 +183,17 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	init( SECOND_REQUEST_MULTIPLIER_DECAY,                 0.00025 );
 	init( SECOND_REQUEST_BUDGET_GROWTH,                       0.05 );
 	init( SECOND_REQUEST_MAX_BUDGET,                         100.0 );
+	init( LOAD_BALANCE_LATENCY_SMOOTHING,                      0.1 );
+	init( LOAD_BALANCE_LATENCY_SAMPLE_SIZE,                    500 );
+	init( LOAD_BALANCE_MIN_HEDGE_SAMPLES,                       30 );
+	init( LOAD_BALANCE_HEDGE_PERCENTILE,                      0.95 ); if( randomize && BUGGIFY ) LOAD_BALANCE_HEDGE_PERCENTILE = 0.5;
+	init( LOAD_BALANCE_SAMPLE_EXPIRATION,                     60.0 ); if( randomize && BUGGIFY ) LOAD_BALANCE_SAMPLE_EXPIRATION = 5.0;
+	init( LOAD_BALANCE_DISTANCE_PENALTY,                     0.010 ); if( randomize && BUGGIFY ) LOAD_BALANCE_DISTANCE_PENALTY = 0.0;
+	init( LOAD_BALANCE_SHARD_AFFINITY,                           1 ); if( randomize && BUGGIFY ) LOAD_BALANCE_SHARD_AFFINITY = 0;
+	init( LOAD_BALANCE_AFFINITY_PENALTY,                     0.005 ); if( randomize && BUGGIFY ) LOAD_BALANCE_AFFINITY_PENALTY = 0.0;
+	init( LOAD_BALANCE_AFFINITY_PREFIX_BYTES,                   12 ); if( randomize && BUGGIFY ) LOAD_BALANCE_AFFINITY_PREFIX_BYTES = g_random->randomInt(0, 16);
+	init( LOAD_BALANCE_VERSION_LEASE_TIME,                     2.0 ); if( randomize && BUGGIFY ) LOAD_BALANCE_VERSION_LEASE_TIME = 0.0;
+	init( LOAD_BALANCE_LAGGING_REPLICA_PENALTY,              0.010 ); if( randomize && BUGGIFY ) LOAD_BALANCE_LAGGING_REPLICA_PENALTY = 0.0;
 	init( ALTERNATIVES_FAILURE_RESET_TIME,                     5.0 );
 	init( ALTERNATIVES_FAILURE_MAX_DELAY,                      1.0 );
 	init( ALTERNATIVES_FAILURE_MIN_DELAY,                     0.05 );
@@ -187,6 +238,30 @@ bool Knobs::setKnob( std::string const& knob, std::string const& value ) {
 	return false;
 }
 
+bool Knobs::getKnob( std::string const& knob, std::string* value ) const {
+	auto d = double_knobs.find(knob);
+	if (d != double_knobs.end()) {
+		*value = format("%.17g", *d->second);
+		return true;
+	}
+	auto i64 = int64_knobs.find(knob);
+	if (i64 != int64_knobs.end()) {
+		*value = format("%lld", *i64->second);
+		return true;
+	}
+	auto i = int_knobs.find(knob);
+	if (i != int_knobs.end()) {
+		*value = format("%d", *i->second);
+		return true;
+	}
+	auto s = string_knobs.find(knob);
+	if (s != string_knobs.end()) {
+		*value = *s->second;
+		return true;
+	}
+	return false;
+}
+
 static std::string toLower( std::string const& name ) {
 	std::string lower_name;
 	for(auto c = name.begin(); c != name.end(); ++c)
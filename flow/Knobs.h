@@ -31,6 +31,7 @@
 class Knobs {
 public:
 	bool setKnob( std::string const& name, std::string const& value ); // Returns true if the knob name is known, false if it is unknown
+	bool getKnob( std::string const& name, std::string* value ) const; // Returns true and sets *value if the knob name is known
 	void trace();
 
 protected:
@@ -66,6 +67,9 @@ public:
 	double SLOWTASK_PROFILING_INTERVAL;
 	double SLOWTASK_PROFILING_MAX_LOG_INTERVAL;
 	double SLOWTASK_PROFILING_LOG_BACKOFF;
+	double SLOWTASK_OFFENDER_INTERVAL;
+	int SLOWTASK_OFFENDER_COUNT;
+	double CHECK_YIELD_AUDIT_BUDGET;
 
 	//connectionMonitor
 	double CONNECTION_MONITOR_LOOP_TIME;
@@ -79,9 +83,16 @@ public:
 	double MAX_RECONNECTION_TIME;
 	double RECONNECTION_TIME_GROWTH_RATE;
 	double RECONNECTION_RESET_TIME;
+	double RECONNECTION_SUCCESS_DECAY_RATE; // Multiplier applied to a peer's reconnection delay each time a connect succeeds
+	int MAX_CONCURRENT_CONNECTS; // Outgoing connection establishments allowed at once, so the mesh reconnects as a quickly drained queue rather than a storm
 	double CONNECTION_ACCEPT_DELAY;
+	int COMPRESS_INTERDC_TRAFFIC;
+	int TRANSPORT_FAILURE_DETECTION;
+	double TRANSPORT_LIVENESS_UPDATE_INTERVAL;
+	int DISABLE_SAME_HOST_CHECKSUMS;
 
 	int TLS_CERT_REFRESH_DELAY_SECONDS;
+	int TLS_HANDSHAKE_THREADS;
 
 	//AsyncFileCached
 	int64_t PAGE_CACHE_4K;
@@ -91,11 +102,27 @@ public:
 	int64_t BUGGIFY_SIM_PAGE_CACHE_4K;
 	int64_t BUGGIFY_SIM_PAGE_CACHE_64K;
 	int MAX_EVICT_ATTEMPTS;
+	double PAGE_CACHE_FILE_SOFT_QUOTA_FRACTION;
+	double PAGE_CACHE_LOG_ROLE_FRACTION;
+	double PAGE_CACHE_STORAGE_ROLE_FRACTION;
 	double PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION;
 
+	//AsyncFileReadAhead
+	int64_t READ_AHEAD_MEMORY_BUDGET;
+
 	//AsyncFileKAIO
 	int MAX_OUTSTANDING;
 	int MIN_SUBMIT;
+	double KAIO_LATENCY_LOG_INTERVAL;
+
+	//FastAlloc
+	int FASTALLOC_HUGE_PAGES;
+	int FASTALLOC_NUMA_AWARE;
+
+	//AsyncFileUring
+	int ENABLE_IO_URING;
+	int URING_SQPOLL;
+	int URING_SQPOLL_IDLE_MS;
 
 	int PAGE_WRITE_CHECKSUM_HISTORY;
 
@@ -113,15 +140,27 @@ public:
 	//Net2
 	double MIN_COALESCE_DELAY;
 	double MAX_COALESCE_DELAY;
+	int COALESCE_IMMEDIATE_BYTES;
 	double SLOW_LOOP_CUTOFF;
 	double SLOW_LOOP_SAMPLING_RATE;
 	int64_t TSC_YIELD_TIME;
 	int64_t REACTOR_FLAGS;
+	int NET2_THREAD_READY_RING;
+	double TIMER_WHEEL_RESOLUTION;  // bucket width of the short-delay timing wheel; timers may fire this much late
+	int TIMER_WHEEL_BUCKETS;        // wheel span is RESOLUTION*BUCKETS; longer delays use the timer heap; 0 disables the wheel
+	int LISTEN_SOCKET_COUNT;        // SO_REUSEPORT listen sockets per process (Linux only; always 1 elsewhere and in simulation)
+	int NOTIFIED_VERSION_WAKE_LIMIT;  // waiters woken inline by one version advance; the excess resume as separately scheduled yield tasks
+
+	//Coroutines
+	int CORO_STACKLESS_SWITCHER;
+	double READY_QUEUE_AGING_INTERVAL;
+	int READY_QUEUE_AGING_PRIORITY_BOOST;
 
 	//Network
 	int64_t PACKET_LIMIT;
 	int64_t PACKET_WARNING;  // 2MB packet warning quietly allows for 1MB system messages
 	double TIME_OFFSET_LOGGING_INTERVAL;
+	double DNS_CACHE_TTL; // How long resolved hostnames are served from cache before being re-resolved in the background; the resolver does not expose record TTLs
 
 	//Sim2
 	//FIMXE: more parameters could be factored out
@@ -142,9 +181,11 @@ public:
 	int MIN_TRACE_SEVERITY;
 	int MAX_TRACE_SUPPRESSIONS;
 	int TRACE_SYNC_ENABLED;
+	std::string TRACE_FORMAT;
 	int TRACE_EVENT_METRIC_UNITS_PER_SAMPLE;
 	int TRACE_EVENT_THROTTLER_SAMPLE_EXPIRY;
 	int TRACE_EVENT_THROTTLER_MSG_LIMIT;
+	int64_t TRACE_LOG_MAX_PENDING_BYTES;	// Events below SevError are shed (and counted) while this much trace data awaits the writer thread
 
 	//TDMetrics
 	int64_t MAX_METRIC_SIZE;
@@ -165,6 +206,17 @@ public:
 	double SECOND_REQUEST_MULTIPLIER_DECAY;
 	double SECOND_REQUEST_BUDGET_GROWTH;
 	double SECOND_REQUEST_MAX_BUDGET;
+	double LOAD_BALANCE_LATENCY_SMOOTHING;
+	int LOAD_BALANCE_LATENCY_SAMPLE_SIZE;
+	int LOAD_BALANCE_MIN_HEDGE_SAMPLES;
+	double LOAD_BALANCE_HEDGE_PERCENTILE;
+	double LOAD_BALANCE_SAMPLE_EXPIRATION;
+	double LOAD_BALANCE_DISTANCE_PENALTY;
+	int LOAD_BALANCE_SHARD_AFFINITY;		// If nonzero, route reads for a sub-range to a deterministic preferred replica for cache locality
+	double LOAD_BALANCE_AFFINITY_PENALTY;	// Expected time penalty paid by replicas other than the affinity preference
+	int LOAD_BALANCE_AFFINITY_PREFIX_BYTES;	// Key prefix length hashed to pick the preferred replica; nearby keys share a replica
+	double LOAD_BALANCE_VERSION_LEASE_TIME;	// How long a replica's reported version watermark is trusted when choosing a replica for a versioned read; 0 disables version-aware selection
+	double LOAD_BALANCE_LAGGING_REPLICA_PENALTY;	// Expected time penalty paid by replicas whose trusted watermark is behind the read version
 	double ALTERNATIVES_FAILURE_RESET_TIME;
 	double ALTERNATIVES_FAILURE_MAX_DELAY;
 	double ALTERNATIVES_FAILURE_MIN_DELAY;
@@ -32,6 +32,7 @@
 
 #include "flow/ActorCollection.h"
 #include "flow/ThreadSafeQueue.h"
+#include "flow/BoundedMPSCQueue.h"
 #include "flow/ThreadHelper.actor.h"
 #include "flow/TDMetric.actor.h"
 #include "flow/AsioReactor.h"
@@ -55,7 +56,7 @@ using namespace boost::asio::ip;
 //
 //                                                       xyzdev
 //                                                       vvvv
-const uint64_t currentProtocolVersion        = 0x0FDB00B061020001LL;
+const uint64_t currentProtocolVersion        = 0x0FDB00B061050001LL;  // Bumped for the status delta encoding fields in StatusRequest/StatusReply (see ClusterInterface.h)
 const uint64_t compatibleProtocolVersionMask = 0xffffffffffff0000LL;
 const uint64_t minValidProtocolVersion       = 0x0FDB00A200060001LL;
 
@@ -66,6 +67,13 @@ static_assert(currentProtocolVersion < 0x0FDB00B100000000LL, "Unexpected protoco
 #include <execinfo.h>
 
 volatile double net2liveness = 0;
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cxxabi.h>
+#endif
+
+#if defined(__linux__)
 
 volatile size_t net2backtraces_max = 10000;
 volatile void** volatile net2backtraces = NULL;
@@ -114,7 +122,9 @@ struct OrderedTask {
 	int64_t priority;
 	int taskID;
 	Task *task;
-	OrderedTask(int64_t priority, int taskID, Task* task) : priority(priority), taskID(taskID), task(task) {}
+	double enqueueTime;  // 0 if not tracked (e.g. the task came from another thread before processThreadReady saw it)
+	OrderedTask() : priority(0), taskID(0), task(nullptr), enqueueTime(0) {}  // Empty BoundedMPSCQueue cell
+	OrderedTask(int64_t priority, int taskID, Task* task, double enqueueTime = 0) : priority(priority), taskID(taskID), task(task), enqueueTime(enqueueTime) {}
 	bool operator < (OrderedTask const& rhs) const { return priority < rhs.priority; }
 };
 
@@ -174,6 +184,9 @@ public:
 	bool stopped;
 	std::map< uint32_t, bool > addressOnHostCache;
 
+	std::map<std::string, std::pair<std::vector<NetworkAddress>, double>> dnsCache;  // resolved addresses by "host:service", with the time they were resolved
+	std::map<std::string, Future<Void>> dnsRefreshes;  // background re-resolutions of stale cache entries
+
 	uint64_t numYields;
 
 	double lastPriorityTrackTime;
@@ -181,7 +194,9 @@ public:
 	double priorityTimer[NetworkMetrics::PRIORITY_BINS];
 
 	std::priority_queue<OrderedTask, std::vector<OrderedTask>> ready;
-	ThreadSafeQueue<OrderedTask> threadReady;
+	ThreadSafeQueue<OrderedTask> threadReady;        // Unbounded overflow path, and carrier of the sleep sentinel
+	BoundedMPSCQueue<OrderedTask> threadReadyRing;   // Allocation-free fast path for cross-thread wakeups
+	volatile int64_t ringSleeping;                   // Nonzero while the run loop may be blocked in sleepAndReact without having observed the ring
 
 	struct DelayedTask : OrderedTask {
 		double at;
@@ -190,12 +205,35 @@ public:
 	};
 	std::priority_queue<DelayedTask, std::vector<DelayedTask>> timers;
 
+	// Delays shorter than the wheel's span are armed in O(1) by hashing their deadline into a
+	// bucket; firing scans only the buckets the clock has passed since the last iteration.
+	// Because only intervals shorter than one rotation are wheeled, every entry in a bucket is
+	// due by the time the bucket's tick is processed.  Longer delays use the heap above.
+	std::vector<std::vector<DelayedTask>> timerWheel;  // bucket i holds deadlines with tick % TIMER_WHEEL_BUCKETS == i
+	int64_t wheelTick;   // all buckets through this tick have been fired
+	int wheelCount;      // entries currently in timerWheel
+
 	void checkForSlowTask(int64_t tscBegin, int64_t tscEnd, double duration, int64_t priority);
 	bool check_yield(int taskId, bool isRunLoop);
 	void processThreadReady();
 	void trackMinPriority( int minTaskID, double now );
+	int priorityBin( int taskID );
+	double lastReadyQueueAging;
+
+	// Slow task time attributed to the actor that was most recently resumed when the slow task
+	// was detected, keyed by the (stable) typeid name pointer; the top offenders are logged and
+	// the table cleared every SLOWTASK_OFFENDER_INTERVAL seconds
+	struct SlowTaskOffender {
+		int64_t count;
+		double totalDuration;
+		double maxDuration;
+		SlowTaskOffender() : count(0), totalDuration(0), maxDuration(0) {}
+	};
+	std::unordered_map<const char*, SlowTaskOffender> slowTaskOffenders;
+	double lastOffenderLog;
+	void logSlowTaskOffenders();
 	void stopImmediately() {
-		stopped=true; decltype(ready) _1; ready.swap(_1); decltype(timers) _2; timers.swap(_2);
+		stopped=true; decltype(ready) _1; ready.swap(_1); decltype(timers) _2; timers.swap(_2); decltype(timerWheel) _3; timerWheel.swap(_3); wheelCount = 0;
 	}
 
 	Future<Void> timeOffsetLogger;
@@ -435,8 +473,19 @@ class Listener : public IListener, ReferenceCounted<Listener> {
 
 public:
 	Listener( boost::asio::io_service& io_service, NetworkAddress listenAddress )
-		: listenAddress(listenAddress), acceptor( io_service, tcpEndpoint( listenAddress ) )
+		: listenAddress(listenAddress), acceptor( io_service )
 	{
+		auto endpoint = tcpEndpoint( listenAddress );
+		acceptor.open( endpoint.protocol() );
+		acceptor.set_option( tcp::acceptor::reuse_address(true) );
+#ifdef __linux__
+		if (FLOW_KNOBS->LISTEN_SOCKET_COUNT > 1)
+			// Each listener then has its own kernel accept queue, and the kernel spreads
+			// incoming connections across all sockets bound to the address
+			acceptor.set_option( boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true) );
+#endif
+		acceptor.bind( endpoint );
+		acceptor.listen( boost::asio::socket_base::max_connections );
 	}
 
 	virtual void addref() { ReferenceCounted<Listener>::addref(); }
@@ -483,11 +532,16 @@ Net2::Net2(NetworkAddress localAddress, bool useThreadPool, bool useMetrics)
 	: useThreadPool(useThreadPool),
 	  network(this),
 	  reactor(this),
+	  threadReadyRing(FLOW_KNOBS->NET2_THREAD_READY_RING),
+	  ringSleeping(0),
 	  stopped(false),
 	  tasksIssued(0),
 	  // Until run() is called, yield() will always yield
 	  tsc_begin(0), tsc_end(0), taskBegin(0), currentTaskID(TaskDefaultYield),
 	  lastMinTaskID(0),
+	  lastReadyQueueAging(0),
+	  lastOffenderLog(0),
+	  wheelTick(0), wheelCount(0),
 	  numYields(0)
 {
 	TraceEvent("Net2Starting");
@@ -504,6 +558,8 @@ Net2::Net2(NetworkAddress localAddress, bool useThreadPool, bool useMetrics)
 	setGlobal(INetwork::enEventFD, (flowGlobalType) N2::ASIOReactor::newEventFD(reactor));
 #endif
 
+	setFastAllocatorHugePages( FLOW_KNOBS->FASTALLOC_HUGE_PAGES != 0 );
+	setFastAllocatorNumaAware( FLOW_KNOBS->FASTALLOC_NUMA_AWARE != 0 );
 
 	int priBins[] = { 1, 2050, 3050, 4050, 4950, 5050, 7050, 8050, 10050 };
 	static_assert( sizeof(priBins) == sizeof(int)*NetworkMetrics::PRIORITY_BINS, "Fix priority bins");
@@ -583,6 +639,16 @@ void Net2::run() {
 		bool b = ready.empty();
 		if (b) {
 			b = threadReady.canSleep();
+			if (b) {
+				// Announce that we may block, then recheck the ring: a producer that pushed
+				// before seeing the announcement is guaranteed to be visible here, and one that
+				// pushed after will see the announcement and wake us.
+				interlockedExchange64( &ringSleeping, 1 );
+				if (!threadReadyRing.empty()) {
+					ringSleeping = 0;
+					b = false;
+				}
+			}
 			if (!b) ++countCantSleep;
 		} else
 			++countWontSleep;
@@ -590,12 +656,19 @@ void Net2::run() {
 			sleepTime = 1e99;
 			if (!timers.empty())
 				sleepTime = timers.top().at - timer_monotonic();  // + 500e-6?
+			if (wheelCount)
+				for(int i=1; i<=FLOW_KNOBS->TIMER_WHEEL_BUCKETS; i++)
+					if (!timerWheel[ (wheelTick+i) % FLOW_KNOBS->TIMER_WHEEL_BUCKETS ].empty()) {
+						sleepTime = std::min( sleepTime, (wheelTick+i) * FLOW_KNOBS->TIMER_WHEEL_RESOLUTION - timer_monotonic() );
+						break;
+					}
 		}
 
 		awakeMetric = false;
 		if( sleepTime > 0 )
 			priorityMetric = 0;
 		reactor.sleepAndReact(sleepTime);
+		ringSleeping = 0;
 		awakeMetric = true;
 
 		updateNow();
@@ -607,23 +680,72 @@ void Net2::run() {
 		if (sleepTime) trackMinPriority( 0, now );
 		while (!timers.empty() && timers.top().at < now) {
 			++countTimers;
-			ready.push( timers.top() );
+			OrderedTask t = timers.top();
+			t.enqueueTime = now;   // A timer's queue delay starts when it becomes ready, not when it was set
+			ready.push( t );
 			timers.pop();
 		}
 
+		if (!timerWheel.empty()) {
+			int64_t nowTick = int64_t( now / FLOW_KNOBS->TIMER_WHEEL_RESOLUTION );
+			if (wheelCount) {
+				// One full rotation visits every bucket, so a pause longer than the wheel's span
+				// doesn't need to step through the skipped ticks individually
+				int64_t limit = std::min( nowTick, wheelTick + FLOW_KNOBS->TIMER_WHEEL_BUCKETS );
+				while (wheelTick < limit) {
+					++wheelTick;
+					std::vector<DelayedTask>& bucket = timerWheel[ wheelTick % FLOW_KNOBS->TIMER_WHEEL_BUCKETS ];
+					wheelCount -= bucket.size();
+					for(auto& t : bucket) {
+						++countTimers;
+						t.enqueueTime = now;   // A timer's queue delay starts when it becomes ready, not when it was set
+						ready.push( t );
+					}
+					bucket.clear();
+				}
+			}
+			// Track now even while the wheel is empty: a stale tick would make the next sweep
+			// cover a full rotation, firing freshly armed timers before their deadline
+			if (wheelTick < nowTick) wheelTick = nowTick;
+		}
+
 		processThreadReady();
 
+		// In aging mode, every interval each task that has been queued for longer than the
+		// interval has its effective priority raised by the configured step.  The boost repeats
+		// each interval, so work at any starting priority eventually outranks a sustained burst
+		// of higher-priority tasks instead of being starved behind it.
+		if (FLOW_KNOBS->READY_QUEUE_AGING_INTERVAL > 0 && now - lastReadyQueueAging >= FLOW_KNOBS->READY_QUEUE_AGING_INTERVAL) {
+			lastReadyQueueAging = now;
+			std::vector<OrderedTask> tasks;
+			tasks.reserve(ready.size());
+			while (!ready.empty()) {
+				tasks.push_back(ready.top());
+				ready.pop();
+			}
+			for(auto& t : tasks)
+				if (t.enqueueTime > 0 && now - t.enqueueTime > FLOW_KNOBS->READY_QUEUE_AGING_INTERVAL)
+					t.priority += int64_t(FLOW_KNOBS->READY_QUEUE_AGING_PRIORITY_BOOST)<<32;
+			ready = std::priority_queue<OrderedTask, std::vector<OrderedTask>>( tasks.begin(), tasks.end() );
+		}
+
 		tsc_begin = __rdtsc();
 		tsc_end = tsc_begin + FLOW_KNOBS->TSC_YIELD_TIME;
 		taskBegin = timer_monotonic();
 		numYields = 0;
 		int minTaskID = TaskMaxPriority;
+		double taskStart = taskBegin;
 
 		while (!ready.empty()) {
 			++countTasks;
 			currentTaskID = ready.top().taskID;
 			priorityMetric = currentTaskID;
 			minTaskID = std::min(minTaskID, currentTaskID);
+			int bin = priorityBin(currentTaskID);
+			if (ready.top().enqueueTime > 0) {
+				networkMetrics.queueDelaySum[bin] += std::max(0.0, taskStart - ready.top().enqueueTime);
+				++networkMetrics.queueDelayCount[bin];
+			}
 			Task* task = ready.top().task;
 			ready.pop();
 
@@ -635,6 +757,10 @@ void Net2::run() {
 				TraceEvent(SevError, "TaskError").error(unknown_error());
 			}
 
+			double taskEnd = timer_monotonic();
+			networkMetrics.secPriorityBusy[bin] += std::max(0.0, taskEnd - taskStart);
+			taskStart = taskEnd;
+
 			if (check_yield(TaskMaxPriority, true)) { ++countYields; break; }
 		}
 
@@ -686,6 +812,11 @@ void Net2::run() {
 		if ((nnow-now) > FLOW_KNOBS->SLOW_LOOP_CUTOFF && g_nondeterministic_random->random01() < (nnow-now)*FLOW_KNOBS->SLOW_LOOP_SAMPLING_RATE)
 			TraceEvent("SomewhatSlowRunLoopBottom").detail("Elapsed", nnow - now); // This includes the time spent running tasks
 
+		if (FLOW_KNOBS->SLOWTASK_OFFENDER_INTERVAL > 0 && nnow - lastOffenderLog > FLOW_KNOBS->SLOWTASK_OFFENDER_INTERVAL) {
+			lastOffenderLog = nnow;
+			logSlowTaskOffenders();
+		}
+
 		trackMinPriority( minTaskID, nnow );
 	}
 
@@ -694,6 +825,15 @@ void Net2::run() {
 	#endif
 }
 
+// The index of the priority band in networkMetrics.priorityBins containing the given task priority
+int Net2::priorityBin( int taskID ) {
+	int bin = 0;
+	for(int i=0; i<NetworkMetrics::PRIORITY_BINS; i++)
+		if (networkMetrics.priorityBins[i] <= taskID)
+			bin = i;
+	return bin;
+}
+
 void Net2::trackMinPriority( int minTaskID, double now ) {
 	if (minTaskID != lastMinTaskID)
 		for(int c=0; c<NetworkMetrics::PRIORITY_BINS; c++) {
@@ -711,15 +851,58 @@ void Net2::trackMinPriority( int minTaskID, double now ) {
 }
 
 void Net2::processThreadReady() {
+	threadReadyRing.popBatch( [this](OrderedTask&& t) {
+		t.priority -= ++tasksIssued;
+		t.enqueueTime = currentTime;
+		ASSERT( t.task != 0 );
+		ready.push( t );
+	} );
 	while (true) {
 		Optional<OrderedTask> t = threadReady.pop();
 		if (!t.present()) break;
 		t.get().priority -= ++tasksIssued;
+		t.get().enqueueTime = currentTime;
 		ASSERT( t.get().task != 0 );
 		ready.push( t.get() );
 	}
 }
 
+// Demangles a typeid name for logging, at offender-summary frequency only
+static std::string demangledActorName(const char* name) {
+#if defined(__linux__) || defined(__APPLE__)
+	int status = -1;
+	char* demangled = abi::__cxa_demangle(name, NULL, NULL, &status);
+	if (demangled) {
+		std::string s = demangled;
+		free(demangled);
+		return s;
+	}
+#endif
+	return name;
+}
+
+void Net2::logSlowTaskOffenders() {
+	if (slowTaskOffenders.empty())
+		return;
+
+	std::vector<std::pair<const char*, SlowTaskOffender>> offenders( slowTaskOffenders.begin(), slowTaskOffenders.end() );
+	int n = std::min<int>(FLOW_KNOBS->SLOWTASK_OFFENDER_COUNT, offenders.size());
+	std::partial_sort( offenders.begin(), offenders.begin() + n, offenders.end(),
+		[](std::pair<const char*, SlowTaskOffender> const& a, std::pair<const char*, SlowTaskOffender> const& b) {
+			return a.second.totalDuration > b.second.totalDuration;
+		} );
+
+	for(int i=0; i<n; i++) {
+		TraceEvent("SlowTaskOffender")
+			.detail("Rank", i)
+			.detail("Actor", demangledActorName(offenders[i].first))
+			.detail("Count", offenders[i].second.count)
+			.detail("TotalDuration", offenders[i].second.totalDuration)
+			.detail("MaxDuration", offenders[i].second.maxDuration);
+	}
+	slowTaskOffenders.clear();
+}
+
 void Net2::checkForSlowTask(int64_t tscBegin, int64_t tscEnd, double duration, int64_t priority) {
 	int64_t elapsed = tscEnd-tscBegin;
 	if (elapsed > FLOW_KNOBS->TSC_YIELD_TIME && tscBegin > 0) {
@@ -727,6 +910,13 @@ void Net2::checkForSlowTask(int64_t tscBegin, int64_t tscEnd, double duration, i
 		int s = ++networkMetrics.countSlowEvents[i];
 		uint64_t warnThreshold = g_network->isSimulated() ? 10e9 : 500e6;
 
+		if (FLOW_KNOBS->SLOWTASK_OFFENDER_INTERVAL > 0 && g_currentActorName) {
+			auto& offender = slowTaskOffenders[g_currentActorName];
+			++offender.count;
+			offender.totalDuration += duration;
+			offender.maxDuration = std::max(offender.maxDuration, duration);
+		}
+
 		//printf("SlowTask: %d, %d yields\n", (int)(elapsed/1e6), numYields);
 
 		slowTaskMetric->clocks = elapsed;
@@ -741,7 +931,8 @@ void Net2::checkForSlowTask(int64_t tscBegin, int64_t tscEnd, double duration, i
 		}
 
 		if ( !DEBUG_DETERMINISM && (g_nondeterministic_random->random01() < sampleRate ))
-			TraceEvent(elapsed > warnThreshold ? SevWarnAlways : SevInfo, "SlowTask").detail("TaskID", priority).detail("MClocks", elapsed/1e6).detail("Duration", duration).detail("SampleRate", sampleRate).detail("NumYields", numYields);
+			TraceEvent(elapsed > warnThreshold ? SevWarnAlways : SevInfo, "SlowTask").detail("TaskID", priority).detail("MClocks", elapsed/1e6).detail("Duration", duration).detail("SampleRate", sampleRate).detail("NumYields", numYields)
+				.detail("LastActor", g_currentActorName ? demangledActorName(g_currentActorName) : "");
 	}
 }
 
@@ -766,6 +957,16 @@ bool Net2::check_yield( int taskID, bool isRunLoop ) {
 	// SOMEDAY: Yield if there are lots of higher priority tasks queued?
 	int64_t tsc_now = __rdtsc();
 	double newTaskBegin = timer_monotonic();
+
+	if (!isRunLoop && FLOW_KNOBS->CHECK_YIELD_AUDIT_BUDGET > 0 && newTaskBegin - taskBegin > FLOW_KNOBS->CHECK_YIELD_AUDIT_BUDGET) {
+		// Audit mode: the backtrace identifies the call site that finally checked for a yield,
+		// which is ordinarily in or near the loop that overran the budget
+		TraceEvent("CheckYieldAudit")
+			.detail("Elapsed", newTaskBegin - taskBegin)
+			.detail("TaskID", taskID)
+			.detail("Backtrace", platform::get_backtrace());
+	}
+
 	if (tsc_now < tsc_begin) {
 		return true;
 	}
@@ -802,7 +1003,7 @@ Future<class Void> Net2::yield( int taskID ) {
 Future<Void> Net2::delay( double seconds, int taskId ) {
 	if (seconds <= 0.) {
 		PromiseTask* t = new PromiseTask;
-		this->ready.push( OrderedTask( (int64_t(taskId)<<32)-(++tasksIssued), taskId, t) );
+		this->ready.push( OrderedTask( (int64_t(taskId)<<32)-(++tasksIssued), taskId, t, currentTime) );
 		return t->promise.getFuture();
 	}
 	if (seconds >= 4e12)  // Intervals that overflow an int64_t in microseconds (more than 100,000 years) are treated as infinite
@@ -810,7 +1011,19 @@ Future<Void> Net2::delay( double seconds, int taskId ) {
 
 	double at = now() + seconds;
 	PromiseTask* t = new PromiseTask;
-	this->timers.push( DelayedTask( at, (int64_t(taskId)<<32)-(++tasksIssued), taskId, t ) );
+	int64_t priority = (int64_t(taskId)<<32)-(++tasksIssued);
+	if (FLOW_KNOBS->TIMER_WHEEL_BUCKETS > 0 && seconds < (FLOW_KNOBS->TIMER_WHEEL_BUCKETS-1) * FLOW_KNOBS->TIMER_WHEEL_RESOLUTION) {
+		if (timerWheel.empty()) {
+			timerWheel.resize( FLOW_KNOBS->TIMER_WHEEL_BUCKETS );
+			wheelTick = int64_t( now() / FLOW_KNOBS->TIMER_WHEEL_RESOLUTION );
+		}
+		// Rounding the deadline up to the next tick boundary means the timer fires at most one
+		// resolution late, never early
+		int64_t tick = std::max( int64_t( at / FLOW_KNOBS->TIMER_WHEEL_RESOLUTION ) + 1, wheelTick + 1 );
+		timerWheel[ tick % FLOW_KNOBS->TIMER_WHEEL_BUCKETS ].push_back( DelayedTask( at, priority, taskId, t ) );
+		++wheelCount;
+	} else
+		this->timers.push( DelayedTask( at, priority, taskId, t ) );
 	return t->promise.getFuture();
 }
 
@@ -822,10 +1035,16 @@ void Net2::onMainThread(Promise<Void>&& signal, int taskID) {
 	if ( thread_network == this )
 	{
 		processThreadReady();
-		this->ready.push( OrderedTask( priority-(++tasksIssued), taskID, p ) );
+		this->ready.push( OrderedTask( priority-(++tasksIssued), taskID, p, currentTime ) );
 	} else {
-		if (threadReady.push( OrderedTask( priority, taskID, p ) ))
-			reactor.wake();
+		if (threadReadyRing.push( OrderedTask( priority, taskID, p ) )) {
+			if (ringSleeping && interlockedCompareExchange64( &ringSleeping, 0, 1 ) == 1)
+				reactor.wake();
+		} else {
+			// The ring is full (or disabled); fall back to the unbounded allocating queue
+			if (threadReady.push( OrderedTask( priority, taskID, p ) ))
+				reactor.wake();
+		}
 	}
 }
 
@@ -876,8 +1095,40 @@ ACTOR static Future<std::vector<NetworkAddress>> resolveTCPEndpoint_impl( Net2 *
 	return result.get();
 }
 
+ACTOR static Future<Void> refreshTCPEndpoint( Net2 *self, std::string key, std::string host, std::string service ) {
+	try {
+		std::vector<NetworkAddress> addrs = wait( resolveTCPEndpoint_impl(self, host, service) );
+		self->dnsCache[key] = std::make_pair(addrs, self->now());
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled)
+			throw;
+		// Keep serving the stale entry; the next stale lookup tries again
+		TraceEvent(SevWarn, "DNSRefreshFailed").error(e).suppressFor(60).detail("Host", host).detail("Service", service);
+	}
+	return Void();
+}
+
+ACTOR static Future<std::vector<NetworkAddress>> resolveAndCacheTCPEndpoint( Net2 *self, std::string key, std::string host, std::string service ) {
+	std::vector<NetworkAddress> addrs = wait( resolveTCPEndpoint_impl(self, host, service) );
+	self->dnsCache[key] = std::make_pair(addrs, self->now());
+	return addrs;
+}
+
 Future<std::vector<NetworkAddress>> Net2::resolveTCPEndpoint( std::string host, std::string service) {
-	return resolveTCPEndpoint_impl(this, host, service);
+	// Cached names are served without waiting, and an entry older than DNS_CACHE_TTL keeps being
+	// served while it is re-resolved in the background, so a slow or unavailable DNS server never
+	// stalls a caller that has resolved the name before
+	std::string key = host + ":" + service;
+	auto cached = dnsCache.find(key);
+	if (cached != dnsCache.end()) {
+		if (now() - cached->second.second > FLOW_KNOBS->DNS_CACHE_TTL) {
+			auto refresh = dnsRefreshes.find(key);
+			if (refresh == dnsRefreshes.end() || refresh->second.isReady())
+				dnsRefreshes[key] = refreshTCPEndpoint(this, key, host, service);
+		}
+		return cached->second.first;
+	}
+	return resolveAndCacheTCPEndpoint(this, key, host, service);
 }
 
 bool Net2::isAddressOnThisHost( NetworkAddress const& addr ) {
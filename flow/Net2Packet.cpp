@@ -42,25 +42,25 @@ PacketBuffer* PacketWriter::finish() {
 
 void PacketWriter::serializeBytesAcrossBoundary(const void* data, int bytes) {
 	while(true) {
-		int b = std::min( bytes, PacketBuffer::DATA_SIZE - buffer->bytes_written );
+		int b = std::min( bytes, buffer->bytes_unwritten() );
 		memcpy( buffer->data + buffer->bytes_written, data, b );
 		buffer->bytes_written += b;
 		bytes -= b;
 		if (!bytes) break;
 
 		data = (uint8_t*)data + b;
-		nextBuffer();
+		nextBuffer(bytes);  // the remainder goes into a single buffer, however large
 	}
 }
 
-void PacketWriter::nextBuffer() {
-	ASSERT( buffer->bytes_written == PacketBuffer::DATA_SIZE );
-	length += PacketBuffer::DATA_SIZE;
-	buffer->next = new PacketBuffer;
+void PacketWriter::nextBuffer( int bytesNeeded ) {
+	ASSERT( !buffer->bytes_unwritten() );
+	length += buffer->bytes_written;
+	buffer->next = PacketBuffer::create(bytesNeeded);
 	buffer = buffer->nextPacketBuffer();
 
 	if (reliable) {
-		reliable->end = PacketBuffer::DATA_SIZE;
+		reliable->end = reliable->buffer->bytes_written;
 		reliable->cont = new ReliablePacket;
 		reliable = reliable->cont;
 		reliable->buffer = buffer; buffer->addref();
@@ -69,15 +69,15 @@ void PacketWriter::nextBuffer() {
 }
 
 void PacketWriter::writeAhead( int bytes, struct SplitBuffer* buf ) {
-	if (bytes <= PacketBuffer::DATA_SIZE - buffer->bytes_written) {
+	if (bytes <= buffer->bytes_unwritten()) {
 		buf->begin = buffer->data + buffer->bytes_written;
 		buf->first_length = bytes;
 		buffer->bytes_written += bytes;
 		buf->next = 0;
 	} else {
 		buf->begin = buffer->data + buffer->bytes_written;
-		buf->first_length = PacketBuffer::DATA_SIZE - buffer->bytes_written;
-		buffer->bytes_written = PacketBuffer::DATA_SIZE;
+		buf->first_length = buffer->bytes_unwritten();
+		buffer->bytes_written = buffer->size();
 		nextBuffer();
 		buf->next = buffer->data;
 		buffer->bytes_written = bytes - buf->first_length;
@@ -142,14 +142,14 @@ void UnsentPacketQueue::sent(int bytes) {
 
 		if (b->bytes_sent + bytes <= b->bytes_written && (b->bytes_sent + bytes != b->bytes_written || (!b->next && b->bytes_unwritten()))) {
 			b->bytes_sent += bytes;
-			ASSERT( b->bytes_sent <= PacketBuffer::DATA_SIZE );
+			ASSERT( b->bytes_sent <= b->size() );
 			break;
 		}
 
 		// We've sent an entire buffer
 		bytes -= b->bytes_written - b->bytes_sent;
 		b->bytes_sent = b->bytes_written;
-		ASSERT( b->bytes_written <= PacketBuffer::DATA_SIZE );
+		ASSERT( b->bytes_written <= b->size() );
 		unsent_first = b->nextPacketBuffer();
 		if (!unsent_first) unsent_last = NULL;
 		b->delref();
@@ -171,8 +171,8 @@ PacketBuffer* ReliablePacketList::compact(PacketBuffer* into, PacketBuffer* end)
 		for(ReliablePacket* c = r; c; c = c->cont) {
 			if (c->buffer == end /*&& c->begin>=c->buffer->bytes_written*/)   // quit when we hit the unsent range
 				return into;
-			if (into->bytes_written == PacketBuffer::DATA_SIZE) {
-				into->next = new PacketBuffer;
+			if (!into->bytes_unwritten()) {
+				into->next = PacketBuffer::create();
 				into = into->nextPacketBuffer();
 			}
 
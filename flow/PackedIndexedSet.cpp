@@ -0,0 +1,150 @@
+/*
+ * PackedIndexedSet.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file just contains tests.  PackedIndexedSet<> is a template and so all
+// the important implementation is in the header file
+
+#include "flow/PackedIndexedSet.h"
+#include "flow/IndexedSet.h"
+#include "flow/IRandom.h"
+#include <string>
+#include "flow/UnitTest.h"
+
+// Compares a PackedIndexedSet against the reference IndexedSet under a random workload
+TEST_CASE("/flow/PackedIndexedSet/random ops vs IndexedSet") {
+	for (int t = 0; t < 50; t++) {
+		PackedIndexedSet<int, int64_t> ps;
+		IndexedSet<int, int64_t> is;
+		int rr = g_random->randomInt(0, 400) * g_random->randomInt(0, 400);
+		for (int n = 0; n < rr; n++) {
+			int k = g_random->randomInt(0, 1000000);
+			double which = g_random->random01();
+			if (which < 0.45) {
+				int64_t m = g_random->randomInt(1, 1000);
+				ps.insert(k, m);
+				is.insert(k, m);
+			} else if (which < 0.70) {
+				ps.erase(k);
+				is.erase(k);
+			} else if (which < 0.90) {
+				int64_t m = g_random->randomInt(1, 1000);
+				int64_t a = ps.addMetric(k, m);
+				int64_t b = is.addMetric(k, m);
+				ASSERT(a == b);
+			} else {
+				int e = g_random->randomInt(0, 1000000);
+				int b = std::min(k, e), en = std::max(k, e);
+				ps.erase(b, en);
+				is.erase(b, en);
+			}
+		}
+
+		ASSERT(ps.sumTo(ps.end()) == is.sumTo(is.end()));
+		ASSERT(ps.empty() == is.empty());
+
+		auto pi = ps.begin();
+		for (auto i = is.begin(); i != is.end(); ++i, ++pi) {
+			ASSERT(pi != ps.end());
+			ASSERT(*pi == *i);
+			ASSERT(ps.getMetric(pi) == is.getMetric(i));
+		}
+		ASSERT(pi == ps.end());
+
+		for (int q = 0; q < 100; q++) {
+			int k = g_random->randomInt(0, 1000000);
+			ASSERT((ps.find(k) == ps.end()) == (is.find(k) == is.end()));
+			auto plb = ps.lower_bound(k), ilb = is.lower_bound(k);
+			ASSERT((plb == ps.end()) == (ilb == is.end()));
+			if (ilb != is.end()) ASSERT(*plb == *ilb);
+			ASSERT(ps.sumTo(plb) == is.sumTo(ilb));
+			auto pub = ps.upper_bound(k), iub = is.upper_bound(k);
+			ASSERT((pub == ps.end()) == (iub == is.end()));
+			if (iub != is.end()) ASSERT(*pub == *iub);
+
+			int e = g_random->randomInt(0, 1000000);
+			ASSERT(ps.sumRange(std::min(k, e), std::max(k, e)) == is.sumRange(std::min(k, e), std::max(k, e)));
+
+			int64_t total = is.sumTo(is.end());
+			if (total > 0) {
+				int64_t m = g_random->randomInt64(0, total + 10);
+				auto px = ps.index(m);
+				auto ix = is.index(m);
+				ASSERT((px == ps.end()) == (ix == is.end()));
+				if (ix != is.end()) ASSERT(*px == *ix);
+			}
+		}
+	}
+	return Void();
+}
+
+TEST_CASE("/flow/PackedIndexedSet/strings") {
+	PackedIndexedSet<std::string, int64_t> ps;
+	ps.insert(std::string("Apple"), 1000);
+	ps.insert(std::string("Banana"), 2000);
+	ps.insert(std::string("Cat"), 1000);
+	ps.insert(std::string("Cathode"), 1000);
+	ps.insert(std::string("Dog"), 1000);
+
+	// Searches may use a type comparable to the element type
+	ASSERT(ps.find("Cat") != ps.end());
+	ASSERT(ps.find("Category") == ps.end());
+	ASSERT(*ps.lower_bound("Banana") == "Banana");
+	ASSERT(*ps.upper_bound("Banana") == "Cat");
+	ASSERT(*ps.lastLessOrEqual("Cow") == "Cathode");
+	ASSERT(ps.sumRange("A", "D") == 5000);
+	ASSERT(ps.sumRange("B", "C") == 2000);
+	ASSERT(*ps.index(3500) == "Cat");
+
+	auto i = ps.lastItem();
+	ASSERT(*i == "Dog");
+	i.decrementNonEnd();
+	ASSERT(*i == "Cathode");
+
+	ps.erase("Cat", "D");
+	ASSERT(ps.find("Cat") == ps.end());
+	ASSERT(ps.find("Cathode") == ps.end());
+	ASSERT(ps.sumTo(ps.end()) == 4000);
+
+	return Void();
+}
+
+TEST_CASE("/flow/PackedIndexedSet/erase 400k of 1M") {
+	PackedIndexedSet<int, int64_t> ps;
+	for (int i = 0; i < 1000000; i++) ps.insert(i, 3);
+
+	ps.erase(300000, 700000);
+
+	int count = 0;
+	for (auto i = ps.begin(); i != ps.end(); ++i) {
+		ASSERT(*i < 300000 || *i >= 700000);
+		count++;
+	}
+	ASSERT(count == 600000);
+	ASSERT(ps.sumTo(ps.end()) == 600000 * 3);
+
+	// the tree is still usable for further mutation after the bulk erase
+	for (int i = 300000; i < 700000; i += 1000) ps.insert(i, 3);
+	for (int i = 0; i < 300000; i += 2) ps.erase(i);
+	ASSERT(ps.sumTo(ps.end()) == (600000 + 400 - 150000) * 3);
+
+	return Void();
+}
+
+void forceLinkPackedIndexedSetTests() {}
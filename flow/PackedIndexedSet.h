@@ -0,0 +1,794 @@
+/*
+ * PackedIndexedSet.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2019 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_PACKEDINDEXEDSET_H
+#define FLOW_PACKEDINDEXEDSET_H
+#pragma once
+
+#include "flow/Platform.h"
+#include "flow/FastAlloc.h"
+#include "flow/Trace.h"
+#include "flow/Error.h"
+
+#include <vector>
+
+// PackedIndexedSet<T, Metric> implements the subset of the IndexedSet<T, Metric> interface used
+// by the storage server's metric samples, but as a counted B+-tree rather than an AVL tree.
+// Each node packs several keys (and one metric subtotal per subtree), so a lookup in a set with
+// 100M+ elements touches roughly a quarter of the cache lines that the one-key-per-node AVL
+// representation does.  Leaves are chained, so iteration chases a pointer only at leaf
+// boundaries instead of at every element.
+//
+// Differences from IndexedSet:
+//   - T must be default constructible as well as totally ordered (nodes hold arrays of T)
+//   - erase(begin, end) detaches whole subtrees in O(FANOUT * log N) but leaves the nodes on
+//     the two boundary paths underfull rather than rebalancing them eagerly; later inserts and
+//     erases repair them
+//   - the bulk vector insert() overload and testonly balance checks are not provided
+
+template <class T>
+class Future;
+
+class Void;
+
+template <class T, class Metric>
+struct PackedIndexedSet {
+	typedef T value_type;
+	typedef T key_type;
+
+	static const int FANOUT = 8;      // children per internal node
+	static const int LEAF_ITEMS = 8;  // elements per leaf node
+
+private:
+	static const int MIN_CHILDREN = FANOUT / 2;
+	static const int MIN_ITEMS = LEAF_ITEMS / 2;
+
+	struct Node {
+		Metric total;  // sum of the metrics of all elements in this subtree
+		int count;     // elements in a leaf, children of an internal node
+		bool leaf;
+		explicit Node(bool leaf) : total(), count(0), leaf(leaf) {}
+
+		// Deletes n after queueing its children on toFree, for incremental destruction of
+		// detached subtrees (see PISFreeNodes)
+		static void freeShallow(Node* n, std::vector<Node*>& toFree);
+	};
+	struct LeafNode : Node, FastAllocated<LeafNode> {
+		T item[LEAF_ITEMS];
+		Metric metric[LEAF_ITEMS];
+		LeafNode *prevLeaf, *nextLeaf;
+		LeafNode() : Node(true), prevLeaf(NULL), nextLeaf(NULL) {}
+	};
+	struct InternalNode : Node, FastAllocated<InternalNode> {
+		Node* child[FANOUT];
+		// lowKey[i] is a lower bound for every element under child[i].  lowKey[0] is never
+		// consulted by searches and may be stale on the leftmost spine of the tree.
+		T lowKey[FANOUT];
+		InternalNode() : Node(false) {}
+	};
+
+public:
+	struct iterator {
+		LeafNode* n;
+		int pos;
+		iterator() : n(NULL), pos(0) {}
+		iterator(LeafNode* n, int pos) : n(n), pos(pos) {}
+		T& operator*() { return n->item[pos]; }
+		T* operator->() { return &n->item[pos]; }
+		void operator++() {
+			if (++pos == n->count) {
+				n = n->nextLeaf;
+				pos = 0;
+			}
+		}
+		void decrementNonEnd() {
+			if (pos == 0) {
+				n = n->prevLeaf;
+				pos = n->count - 1;
+			} else
+				--pos;
+		}
+		bool operator==(const iterator& r) const { return n == r.n && pos == r.pos; }
+		bool operator!=(const iterator& r) const { return !(*this == r); }
+	};
+
+	PackedIndexedSet() : root(NULL) {}
+	~PackedIndexedSet() { freeSubtree(root); }
+	PackedIndexedSet(PackedIndexedSet&& r) noexcept(true) : root(r.root) { r.root = NULL; }
+	PackedIndexedSet& operator=(PackedIndexedSet&& r) noexcept(true) {
+		freeSubtree(root);
+		root = r.root;
+		r.root = NULL;
+		return *this;
+	}
+
+	iterator begin() const {
+		LeafNode* l = leftmostLeaf(root);
+		return l ? iterator(l, 0) : iterator();
+	}
+	iterator end() const { return iterator(); }
+	iterator lastItem() const {
+		LeafNode* l = rightmostLeaf(root);
+		return l ? iterator(l, l->count - 1) : iterator();
+	}
+	iterator previous(iterator i) const {
+		if (i == end()) return lastItem();
+		i.decrementNonEnd();
+		return i;
+	}
+
+	bool empty() const { return !root; }
+	void clear() {
+		freeSubtree(root);
+		root = NULL;
+	}
+	void swap(PackedIndexedSet& r) { std::swap(root, r.root); }
+
+	// Place data in the set with the given metric.  If an item equal to data is already in the
+	//   set and replaceExisting == true, it will be overwritten (and its metric will be replaced)
+	template <class T_, class Metric_>
+	iterator insert(T_&& data, Metric_&& metric, bool replaceExisting = true) {
+		if (!root) {
+			LeafNode* l = new LeafNode;
+			l->item[0] = std::forward<T_>(data);
+			l->metric[0] = std::forward<Metric_>(metric);
+			l->count = 1;
+			l->total = l->metric[0];
+			root = l;
+			return iterator(l, 0);
+		}
+		if (isFull(root)) {
+			InternalNode* r = new InternalNode;
+			r->count = 1;
+			r->child[0] = root;
+			r->total = root->total;
+			root = r;
+			splitChild(r, 0);
+		}
+		return insertRec(root, std::forward<T_>(data), std::forward<Metric_>(metric), replaceExisting);
+	}
+
+	// Increase the metric for the given item by the given amount.  Inserts data into the set if
+	//   it doesn't exist.  Returns the new sum.
+	template <class T_, class Metric_>
+	Metric addMetric(T_&& data, Metric_&& metric) {
+		auto i = find(data);
+		if (i == end()) {
+			insert(std::forward<T_>(data), std::forward<Metric_>(metric));
+			return metric;
+		} else {
+			Metric m = metric + getMetric(i);
+			insert(std::forward<T_>(data), m);
+			return m;
+		}
+	}
+
+	// Remove the data item, if any, which is equal to key
+	template <class Key>
+	void erase(const Key& key) {
+		if (!root) return;
+		eraseRec(root, key);
+		shrinkRoot();
+	}
+
+	// Erase the indicated item.  No effect if item == end().
+	void erase(iterator item) {
+		if (item == end()) return;
+		T key = *item;  // copy; erasing restructures the node under the iterator
+		erase(key);
+	}
+
+	// Erase all data items x for which begin<=x<end
+	template <class Key>
+	void erase(const Key& begin, const Key& end) {
+		std::vector<Node*> toFree;
+		eraseRange(&begin, &end, toFree);
+		freeForest(toFree);
+	}
+
+	// Erase the items in the indicated range.
+	void erase(iterator begin, iterator end) {
+		if (begin == this->end()) return;
+		T b = *begin;
+		std::vector<Node*> toFree;
+		if (end == this->end())
+			eraseRange(&b, (const T*)NULL, toFree);
+		else {
+			T e = *end;
+			eraseRange(&b, &e, toFree);
+		}
+		freeForest(toFree);
+	}
+
+	// Erase data items with a deferred (async) free process.  The data structure has the items
+	//  removed synchronously with the invocation of this method so any subsequent call will see
+	//  this new state.
+	template <class Key>
+	Future<Void> eraseAsync(const Key& begin, const Key& end);
+
+	// Returns the number of items equal to key (either 0 or 1)
+	template <class Key>
+	int count(const Key& key) const {
+		return find(key) != end();
+	}
+
+	// Returns x such that key==*x, or end()
+	template <class Key>
+	iterator find(const Key& key) const {
+		iterator i = lower_bound(key);
+		if (i != end() && !(key < *i)) return i;
+		return end();
+	}
+
+	// Returns the smallest x such that *x>=key, or end()
+	template <class Key>
+	iterator lower_bound(const Key& key) const {
+		Node* n = root;
+		if (!n) return iterator();
+		while (!n->leaf) {
+			InternalNode* in = (InternalNode*)n;
+			n = in->child[childFor(in, key)];
+		}
+		LeafNode* l = (LeafNode*)n;
+		int p = 0;
+		while (p < l->count && l->item[p] < key) p++;
+		if (p == l->count) return l->nextLeaf ? iterator(l->nextLeaf, 0) : iterator();
+		return iterator(l, p);
+	}
+
+	// Returns the smallest x such that *x>key, or end()
+	template <class Key>
+	iterator upper_bound(const Key& key) const {
+		Node* n = root;
+		if (!n) return iterator();
+		while (!n->leaf) {
+			InternalNode* in = (InternalNode*)n;
+			n = in->child[childFor(in, key)];
+		}
+		LeafNode* l = (LeafNode*)n;
+		int p = 0;
+		while (p < l->count && !(key < l->item[p])) p++;
+		if (p == l->count) return l->nextLeaf ? iterator(l->nextLeaf, 0) : iterator();
+		return iterator(l, p);
+	}
+
+	// Returns the largest x such that *x<=key, or end()
+	template <class Key>
+	iterator lastLessOrEqual(const Key& key) const {
+		iterator i = upper_bound(key);
+		if (i == begin()) return end();
+		return previous(i);
+	}
+
+	// Returns smallest x such that sumTo(x+1) > metric, or end()
+	template <class M>
+	iterator index(M const& metric) const {
+		M m = metric;
+		Node* n = root;
+		if (!n) return iterator();
+		while (!n->leaf) {
+			InternalNode* in = (InternalNode*)n;
+			int i = 0;
+			while (i < in->count && !(m < in->child[i]->total)) {
+				m = m - in->child[i]->total;
+				i++;
+			}
+			if (i == in->count) return iterator();
+			n = in->child[i];
+		}
+		LeafNode* l = (LeafNode*)n;
+		for (int p = 0; p < l->count; p++) {
+			if (m < l->metric[p]) return iterator(l, p);
+			m = m - l->metric[p];
+		}
+		return iterator();
+	}
+
+	// Return the metric inserted with item x
+	Metric getMetric(iterator x) const { return x.n->metric[x.pos]; }
+
+	// Return the sum of getMetric(x) for begin()<=x<to
+	Metric sumTo(iterator to) const {
+		if (!root) return Metric();
+		if (to == end()) return root->total;
+		// Re-derive the path to `to' from the root, accumulating everything to its left
+		const T& key = to.n->item[to.pos];
+		Metric m = Metric();
+		Node* n = root;
+		while (!n->leaf) {
+			InternalNode* in = (InternalNode*)n;
+			int i = childFor(in, key);
+			for (int j = 0; j < i; j++) m = m + in->child[j]->total;
+			n = in->child[i];
+		}
+		LeafNode* l = (LeafNode*)n;
+		for (int p = 0; p < l->count && l->item[p] < key; p++) m = m + l->metric[p];
+		return m;
+	}
+
+	// Return the sum of getMetric(x) for begin<=x<end
+	Metric sumRange(iterator begin, iterator end) const { return sumTo(end) - sumTo(begin); }
+
+	// Return the sum of getMetric(x) for all x s.t. begin <= *x && *x < end
+	template <class Key>
+	Metric sumRange(const Key& begin, const Key& end) const {
+		return sumRange(lower_bound(begin), lower_bound(end));
+	}
+
+	// Approximate amount of memory used per entry, assuming half-full nodes
+	static int getElementBytes() { return sizeof(LeafNode) / MIN_ITEMS + sizeof(InternalNode) / (MIN_ITEMS * MIN_CHILDREN); }
+
+private:
+	// Copy operations unimplemented, as for IndexedSet
+	PackedIndexedSet(const PackedIndexedSet&);
+	PackedIndexedSet& operator=(const PackedIndexedSet&);
+
+	Node* root;
+
+	static bool isFull(Node* n) { return n->count == (n->leaf ? LEAF_ITEMS : FANOUT); }
+	static int minCount(Node* n) { return n->leaf ? MIN_ITEMS : MIN_CHILDREN; }
+	static int maxCount(Node* n) { return n->leaf ? LEAF_ITEMS : FANOUT; }
+
+	// Returns the largest i such that lowKey[i] <= k, or 0
+	template <class Key>
+	static int childFor(InternalNode* n, const Key& k) {
+		int i = n->count - 1;
+		while (i > 0 && k < n->lowKey[i]) i--;
+		return i;
+	}
+
+	static Metric computeTotal(Node* n) {
+		Metric m = Metric();
+		if (n->leaf) {
+			LeafNode* l = (LeafNode*)n;
+			for (int i = 0; i < l->count; i++) m = m + l->metric[i];
+		} else {
+			InternalNode* in = (InternalNode*)n;
+			for (int i = 0; i < in->count; i++) m = m + in->child[i]->total;
+		}
+		return m;
+	}
+
+	static LeafNode* leftmostLeaf(Node* n) {
+		if (!n) return NULL;
+		while (!n->leaf) n = ((InternalNode*)n)->child[0];
+		return (LeafNode*)n;
+	}
+	static LeafNode* rightmostLeaf(Node* n) {
+		if (!n) return NULL;
+		while (!n->leaf) n = ((InternalNode*)n)->child[n->count - 1];
+		return (LeafNode*)n;
+	}
+
+	static void freeSubtree(Node* n) {
+		if (!n) return;
+		if (!n->leaf) {
+			InternalNode* in = (InternalNode*)n;
+			for (int i = 0; i < in->count; i++) freeSubtree(in->child[i]);
+			in->count = 0;
+			delete in;
+		} else
+			delete (LeafNode*)n;
+	}
+
+	static void freeForest(std::vector<Node*>& toFree) {
+		while (!toFree.empty()) {
+			Node* n = toFree.back();
+			toFree.pop_back();
+			Node::freeShallow(n, toFree);
+		}
+	}
+
+	// Splits the full child[i] of p in half.  p must not be full.
+	static void splitChild(InternalNode* p, int i) {
+		Node* c = p->child[i];
+		T sep;
+		Node* right;
+		if (c->leaf) {
+			LeafNode* l = (LeafNode*)c;
+			LeafNode* r = new LeafNode;
+			for (int j = MIN_ITEMS; j < LEAF_ITEMS; j++) {
+				r->item[j - MIN_ITEMS] = std::move(l->item[j]);
+				r->metric[j - MIN_ITEMS] = std::move(l->metric[j]);
+				l->item[j] = T();
+				l->metric[j] = Metric();
+			}
+			r->count = LEAF_ITEMS - MIN_ITEMS;
+			l->count = MIN_ITEMS;
+			r->nextLeaf = l->nextLeaf;
+			if (r->nextLeaf) r->nextLeaf->prevLeaf = r;
+			r->prevLeaf = l;
+			l->nextLeaf = r;
+			r->total = computeTotal(r);
+			l->total = computeTotal(l);
+			sep = r->item[0];
+			right = r;
+		} else {
+			InternalNode* l = (InternalNode*)c;
+			InternalNode* r = new InternalNode;
+			for (int j = MIN_CHILDREN; j < FANOUT; j++) {
+				r->child[j - MIN_CHILDREN] = l->child[j];
+				r->lowKey[j - MIN_CHILDREN] = std::move(l->lowKey[j]);
+				l->child[j] = NULL;
+				l->lowKey[j] = T();
+			}
+			r->count = FANOUT - MIN_CHILDREN;
+			l->count = MIN_CHILDREN;
+			r->total = computeTotal(r);
+			l->total = computeTotal(l);
+			sep = r->lowKey[0];
+			right = r;
+		}
+		for (int j = p->count; j > i + 1; j--) {
+			p->child[j] = p->child[j - 1];
+			p->lowKey[j] = std::move(p->lowKey[j - 1]);
+		}
+		p->child[i + 1] = right;
+		p->lowKey[i + 1] = std::move(sep);
+		p->count++;
+	}
+
+	template <class T_, class Metric_>
+	iterator insertRec(Node* n, T_&& data, Metric_&& metric, bool replaceExisting) {
+		if (n->leaf) {
+			LeafNode* l = (LeafNode*)n;
+			int p = 0;
+			while (p < l->count && l->item[p] < data) p++;
+			if (p < l->count && !(data < l->item[p])) {  // equal
+				if (replaceExisting) {
+					l->item[p] = std::forward<T_>(data);
+					l->metric[p] = std::forward<Metric_>(metric);
+					l->total = computeTotal(l);
+				}
+				return iterator(l, p);
+			}
+			for (int j = l->count; j > p; j--) {
+				l->item[j] = std::move(l->item[j - 1]);
+				l->metric[j] = std::move(l->metric[j - 1]);
+			}
+			l->item[p] = std::forward<T_>(data);
+			l->metric[p] = std::forward<Metric_>(metric);
+			l->count++;
+			l->total = computeTotal(l);
+			return iterator(l, p);
+		}
+		InternalNode* in = (InternalNode*)n;
+		int i = childFor(in, data);
+		if (isFull(in->child[i])) {
+			splitChild(in, i);
+			if (!(data < in->lowKey[i + 1])) i++;
+		}
+		iterator result = insertRec(in->child[i], std::forward<T_>(data), std::forward<Metric_>(metric), replaceExisting);
+		in->total = computeTotal(in);
+		return result;
+	}
+
+	template <class Key>
+	static void eraseRec(Node* n, const Key& key) {
+		if (n->leaf) {
+			LeafNode* l = (LeafNode*)n;
+			int p = 0;
+			while (p < l->count && l->item[p] < key) p++;
+			if (p == l->count || key < l->item[p]) return;  // not present
+			for (int j = p + 1; j < l->count; j++) {
+				l->item[j - 1] = std::move(l->item[j]);
+				l->metric[j - 1] = std::move(l->metric[j]);
+			}
+			l->count--;
+			l->item[l->count] = T();
+			l->metric[l->count] = Metric();
+			l->total = computeTotal(l);
+			return;
+		}
+		InternalNode* in = (InternalNode*)n;
+		int i = childFor(in, key);
+		if (in->child[i]->count <= minCount(in->child[i])) {
+			fixChild(in, i);
+			i = childFor(in, key);  // fixChild may have merged key's subtree leftward
+		}
+		eraseRec(in->child[i], key);
+		in->total = computeTotal(in);
+	}
+
+	// Gives child[i] more than the minimum element count if possible, by merging with or
+	// borrowing from a neighbor.  Tolerates children left underfull by erase(begin, end).
+	static void fixChild(InternalNode* n, int i) {
+		if (n->count < 2) return;
+		Node* c = n->child[i];
+		Node* l = i > 0 ? n->child[i - 1] : NULL;
+		Node* r = i + 1 < n->count ? n->child[i + 1] : NULL;
+		int cap = maxCount(c);
+		if (l && l->count + c->count <= cap)
+			mergeChildren(n, i - 1);
+		else if (r && c->count + r->count <= cap)
+			mergeChildren(n, i);
+		else if (l)
+			borrowFromLeft(n, i);
+		else
+			borrowFromRight(n, i);
+	}
+
+	// Merges child[i+1] into child[i] and removes the vacated slot
+	static void mergeChildren(InternalNode* n, int i) {
+		Node* a = n->child[i];
+		Node* b = n->child[i + 1];
+		if (a->leaf) {
+			LeafNode* x = (LeafNode*)a;
+			LeafNode* y = (LeafNode*)b;
+			for (int j = 0; j < y->count; j++) {
+				x->item[x->count + j] = std::move(y->item[j]);
+				x->metric[x->count + j] = std::move(y->metric[j]);
+			}
+			x->count += y->count;
+			x->nextLeaf = y->nextLeaf;
+			if (x->nextLeaf) x->nextLeaf->prevLeaf = x;
+			x->total = computeTotal(x);
+			delete y;
+		} else {
+			InternalNode* x = (InternalNode*)a;
+			InternalNode* y = (InternalNode*)b;
+			for (int j = 0; j < y->count; j++) {
+				x->child[x->count + j] = y->child[j];
+				x->lowKey[x->count + j] = std::move(y->lowKey[j]);
+			}
+			x->count += y->count;
+			x->total = computeTotal(x);
+			y->count = 0;
+			delete y;
+		}
+		for (int j = i + 1; j < n->count - 1; j++) {
+			n->child[j] = n->child[j + 1];
+			n->lowKey[j] = std::move(n->lowKey[j + 1]);
+		}
+		n->count--;
+		n->child[n->count] = NULL;
+		n->lowKey[n->count] = T();
+	}
+
+	static void borrowFromLeft(InternalNode* n, int i) {
+		Node* c = n->child[i];
+		Node* l = n->child[i - 1];
+		if (c->leaf) {
+			LeafNode* x = (LeafNode*)c;
+			LeafNode* y = (LeafNode*)l;
+			for (int j = x->count; j > 0; j--) {
+				x->item[j] = std::move(x->item[j - 1]);
+				x->metric[j] = std::move(x->metric[j - 1]);
+			}
+			x->item[0] = std::move(y->item[y->count - 1]);
+			x->metric[0] = std::move(y->metric[y->count - 1]);
+			y->item[y->count - 1] = T();
+			y->metric[y->count - 1] = Metric();
+			x->count++;
+			y->count--;
+			n->lowKey[i] = x->item[0];
+		} else {
+			InternalNode* x = (InternalNode*)c;
+			InternalNode* y = (InternalNode*)l;
+			for (int j = x->count; j > 0; j--) {
+				x->child[j] = x->child[j - 1];
+				x->lowKey[j] = std::move(x->lowKey[j - 1]);
+			}
+			x->child[0] = y->child[y->count - 1];
+			x->lowKey[0] = y->lowKey[y->count - 1];
+			n->lowKey[i] = std::move(y->lowKey[y->count - 1]);
+			y->child[y->count - 1] = NULL;
+			x->count++;
+			y->count--;
+		}
+		c->total = computeTotal(c);
+		l->total = computeTotal(l);
+	}
+
+	static void borrowFromRight(InternalNode* n, int i) {
+		Node* c = n->child[i];
+		Node* r = n->child[i + 1];
+		if (c->leaf) {
+			LeafNode* x = (LeafNode*)c;
+			LeafNode* y = (LeafNode*)r;
+			x->item[x->count] = std::move(y->item[0]);
+			x->metric[x->count] = std::move(y->metric[0]);
+			x->count++;
+			for (int j = 1; j < y->count; j++) {
+				y->item[j - 1] = std::move(y->item[j]);
+				y->metric[j - 1] = std::move(y->metric[j]);
+			}
+			y->count--;
+			y->item[y->count] = T();
+			y->metric[y->count] = Metric();
+			n->lowKey[i + 1] = y->item[0];
+		} else {
+			InternalNode* x = (InternalNode*)c;
+			InternalNode* y = (InternalNode*)r;
+			x->child[x->count] = y->child[0];
+			x->lowKey[x->count] = std::move(y->lowKey[0]);
+			x->count++;
+			for (int j = 1; j < y->count; j++) {
+				y->child[j - 1] = y->child[j];
+				y->lowKey[j - 1] = std::move(y->lowKey[j]);
+			}
+			y->count--;
+			y->child[y->count] = NULL;
+			y->lowKey[y->count] = T();
+			n->lowKey[i + 1] = y->lowKey[0];
+		}
+		c->total = computeTotal(c);
+		r->total = computeTotal(r);
+	}
+
+	void shrinkRoot() {
+		while (root && !root->leaf && root->count == 1) {
+			InternalNode* in = (InternalNode*)root;
+			root = in->child[0];
+			in->count = 0;
+			delete in;
+		}
+		if (root && root->leaf && root->count == 0) {
+			delete (LeafNode*)root;
+			root = NULL;
+		}
+	}
+
+	// Splices the leaf span of n out of the leaf chain and queues n for freeing
+	static void detachSubtree(Node* n, std::vector<Node*>& toFree) {
+		LeafNode* first = leftmostLeaf(n);
+		LeafNode* last = rightmostLeaf(n);
+		if (first->prevLeaf) first->prevLeaf->nextLeaf = last->nextLeaf;
+		if (last->nextLeaf) last->nextLeaf->prevLeaf = first->prevLeaf;
+		first->prevLeaf = NULL;
+		last->nextLeaf = NULL;
+		toFree.push_back(n);
+	}
+
+	// Frees a node whose elements (or children) have all been removed already
+	static void freeEmpty(Node* n) {
+		if (n->leaf) {
+			LeafNode* l = (LeafNode*)n;
+			if (l->prevLeaf) l->prevLeaf->nextLeaf = l->nextLeaf;
+			if (l->nextLeaf) l->nextLeaf->prevLeaf = l->prevLeaf;
+			delete l;
+		} else
+			delete (InternalNode*)n;
+	}
+
+	// Erases [*b, *e) where a NULL bound means unbounded on that side.  Wholly contained
+	// subtrees are detached onto toFree without visiting their nodes.
+	template <class Key>
+	void eraseRange(const Key* b, const Key* e, std::vector<Node*>& toFree) {
+		if (!root) return;
+		eraseRangeRec(root, b, e, toFree);
+		if (root->count == 0 && !root->leaf) {
+			delete (InternalNode*)root;
+			root = NULL;
+		} else
+			shrinkRoot();
+	}
+
+	template <class Key>
+	static void eraseRangeRec(Node* n, const Key* b, const Key* e, std::vector<Node*>& toFree) {
+		if (n->leaf) {
+			LeafNode* l = (LeafNode*)n;
+			int lo = 0;
+			if (b)
+				while (lo < l->count && l->item[lo] < *b) lo++;
+			int hi = lo;
+			while (hi < l->count && (!e || l->item[hi] < *e)) hi++;
+			if (lo == hi) return;
+			int removed = hi - lo;
+			for (int j = hi; j < l->count; j++) {
+				l->item[j - removed] = std::move(l->item[j]);
+				l->metric[j - removed] = std::move(l->metric[j]);
+			}
+			for (int j = l->count - removed; j < l->count; j++) {
+				l->item[j] = T();
+				l->metric[j] = Metric();
+			}
+			l->count -= removed;
+			l->total = computeTotal(l);
+			return;
+		}
+
+		InternalNode* in = (InternalNode*)n;
+		int iLo = b ? childFor(in, *b) : 0;
+		int iHi = e ? childFor(in, *e) : in->count - 1;
+
+		if (iLo == iHi) {
+			eraseRangeRec(in->child[iLo], b, e, toFree);
+			if (in->child[iLo]->count == 0) {
+				freeEmpty(in->child[iLo]);
+				for (int j = iLo + 1; j < in->count; j++) {
+					in->child[j - 1] = in->child[j];
+					in->lowKey[j - 1] = std::move(in->lowKey[j]);
+				}
+				in->count--;
+				in->child[in->count] = NULL;
+				in->lowKey[in->count] = T();
+			}
+			in->total = computeTotal(in);
+			return;
+		}
+
+		// Children strictly between the boundary children lie entirely inside [b, e)
+		for (int j = iLo + 1; j < iHi; j++) detachSubtree(in->child[j], toFree);
+		Node* lc = in->child[iLo];
+		Node* rc = in->child[iHi];
+		eraseRangeRec(lc, b, (const Key*)NULL, toFree);
+		eraseRangeRec(rc, (const Key*)NULL, e, toFree);
+
+		// Compact out the detached children and any boundary child that was emptied
+		int w = 0;
+		for (int j = 0; j < in->count; j++) {
+			if (j > iLo && j < iHi) continue;  // detached above
+			if (in->child[j]->count == 0) {
+				freeEmpty(in->child[j]);
+				continue;
+			}
+			if (w != j) {
+				in->child[w] = in->child[j];
+				in->lowKey[w] = std::move(in->lowKey[j]);
+			}
+			w++;
+		}
+		for (int j = w; j < in->count; j++) {
+			in->child[j] = NULL;
+			in->lowKey[j] = T();
+		}
+		in->count = w;
+
+		// Best-effort repair of surviving boundary children; anything left underfull is
+		// repaired by later single-key erases
+		repairChild(in, lc);
+		repairChild(in, rc);
+		in->total = computeTotal(in);
+	}
+
+	static void repairChild(InternalNode* n, Node* c) {
+		if (n->count < 2) return;
+		for (int i = 0; i < n->count; i++)
+			if (n->child[i] == c) {
+				if (c->count < minCount(c)) fixChild(n, i);
+				return;
+			}
+	}
+};
+
+#include "flow/flow.h"
+#include "flow/PackedIndexedSet.actor.h"
+
+template <class T, class Metric>
+void PackedIndexedSet<T, Metric>::Node::freeShallow(Node* n, std::vector<Node*>& toFree) {
+	if (!n->leaf) {
+		InternalNode* in = (InternalNode*)n;
+		for (int i = 0; i < in->count; i++) toFree.push_back(in->child[i]);
+		in->count = 0;
+		delete in;
+	} else
+		delete (LeafNode*)n;
+}
+
+template <class T, class Metric>
+template <class Key>
+Future<Void> PackedIndexedSet<T, Metric>::eraseAsync(const Key& begin, const Key& end) {
+	std::vector<Node*> toFree;
+	eraseRange(&begin, &end, toFree);
+	return uncancellable(PISFreeNodes(toFree, false));
+}
+
+#endif
@@ -399,6 +399,7 @@ inline static int64_t interlockedIncrement64(volatile int64_t *a) { return _Inte
 inline static int32_t interlockedDecrement(volatile int32_t *a) { return _InterlockedDecrement((long*)a); }
 inline static int64_t interlockedDecrement64(volatile int64_t *a) { return _InterlockedDecrement64(a); }
 inline static int32_t interlockedCompareExchange(volatile int32_t *a, int32_t b, int32_t c) { return _InterlockedCompareExchange((long*)a, (long)b, (long)c); }
+inline static int64_t interlockedCompareExchange64(volatile int64_t *a, int64_t b, int64_t c) { return _InterlockedCompareExchange64(a, b, c); }
 inline static int64_t interlockedExchangeAdd64(volatile int64_t *a, int64_t b) { return _InterlockedExchangeAdd64(a, b); }
 inline static int64_t interlockedExchange64(volatile int64_t *a, int64_t b) { return _InterlockedExchange64(a, b); }
 inline static int64_t interlockedOr64(volatile int64_t *a, int64_t b) { return _InterlockedOr64(a, b); }
@@ -409,6 +410,7 @@ inline static int64_t interlockedIncrement64(volatile int64_t *a) { return __syn
 inline static int32_t interlockedDecrement(volatile int32_t *a) { return __sync_add_and_fetch(a, -1); }
 inline static int64_t interlockedDecrement64(volatile int64_t *a) { return __sync_add_and_fetch(a, -1); }
 inline static int32_t interlockedCompareExchange(volatile int32_t *a, int32_t b, int32_t c) { return __sync_val_compare_and_swap(a, c, b); }
+inline static int64_t interlockedCompareExchange64(volatile int64_t *a, int64_t b, int64_t c) { return __sync_val_compare_and_swap(a, c, b); }
 inline static int64_t interlockedExchangeAdd64(volatile int64_t *a, int64_t b) { return __sync_fetch_and_add(a, b); }
 inline static int64_t interlockedExchange64(volatile int64_t *a, int64_t b) {
 	__sync_synchronize();
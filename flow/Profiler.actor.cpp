@@ -122,6 +122,7 @@ struct Profiler {
 	};
 
 	enum { MAX_STACK_DEPTH = 256 };
+	enum { MAX_AGGREGATED_STACKS = 100000 };  // Bounds the memory used by the always-on mode
 
 	void* addresses[MAX_STACK_DEPTH];
 	SignalClosure signalClosure;
@@ -134,7 +135,13 @@ struct Profiler {
 	timer_t periodicTimer;
 	bool timerInitialized;
 
-	Profiler(int period, std::string const& outfn, INetwork* network) : environmentInfoWriter(Unversioned()), signalClosure(signal_handler_for_closure, this), network(network), timerInitialized(false) {
+	// Aggregated (collapsed) samples, maintained outside the signal handler by the profile() actor.
+	// This is what stays compact when the profiler is left running continuously: each distinct call
+	// stack costs one map entry however many times it is sampled.
+	std::map<std::vector<void*>, int64_t> stackCounts;
+	int64_t droppedStacks;
+
+	Profiler(int period, std::string const& outfn, INetwork* network) : environmentInfoWriter(Unversioned()), signalClosure(signal_handler_for_closure, this), network(network), timerInitialized(false), droppedStacks(0) {
 		actor = profile(this, period, outfn);
 	}
 
@@ -182,12 +189,70 @@ struct Profiler {
 		return 0;
 	}
 
+	// Folds the raw samples in the given buffer (a timestamp, up to MAX_STACK_DEPTH return addresses
+	// and a -1 terminator per sample) into stackCounts.  Runs in the profile() actor, not the signal
+	// handler, so ordinary containers are fine here.
+	void aggregateSamples( OutputBuffer* buffer ) {
+		auto& out = buffer->output;
+		std::vector<void*> stack;
+		size_t i = 0;
+		while (i < out.size()) {
+			i++;  // timestamp
+			stack.clear();
+			while (i < out.size() && out[i] != (void*)-1LL)
+				stack.push_back( out[i++] );
+			if (i == out.size()) break;  // the buffer filled up mid-sample
+			i++;  // terminator
+
+			if (stackCounts.size() < MAX_AGGREGATED_STACKS || stackCounts.count(stack))
+				++stackCounts[stack];
+			else
+				++droppedStacks;
+		}
+	}
+
+	// Writes the aggregated samples in collapsed-stack format: one line per distinct stack, frames
+	// root-first as hex return addresses separated by semicolons, then a space and the sample count.
+	// A comment header gives the load address of each shared object so the addresses can be
+	// symbolicated offline (and then fed straight to flamegraph.pl).
+	bool dumpCollapsedStacks( std::string const& filename ) {
+		FILE* f = fopen( filename.c_str(), "wt" );
+		if (!f) {
+			TraceEvent(SevWarn, "FailedToOpenCollapsedStacksFile").detail("Filename", filename).GetLastError();
+			return false;
+		}
+
+		dl_iterate_phdr( text_phdr_callback, f );
+		if (droppedStacks)
+			fprintf(f, "# %" PRId64 " samples dropped after reaching %d distinct stacks\n", droppedStacks, (int)MAX_AGGREGATED_STACKS);
+
+		for(auto const& sc : stackCounts) {
+			auto const& stack = sc.first;
+			for(int i=stack.size()-1; i>=0; i--)
+				fprintf(f, "0x%llx%s", (unsigned long long)(uintptr_t)stack[i], i ? ";" : "");
+			fprintf(f, " %" PRId64 "\n", sc.second);
+		}
+
+		bool ok = !fclose(f);
+		TraceEvent("ProfilerStackDump").detail("Filename", filename).detail("Stacks", (int64_t)stackCounts.size()).detail("DroppedStacks", droppedStacks);
+		return ok;
+	}
+
+	static int text_phdr_callback(struct dl_phdr_info *info, size_t size, void *data) {
+		fprintf((FILE*)data, "# module 0x%llx %s\n", (unsigned long long)info->dlpi_addr, info->dlpi_name);
+		return 0;
+	}
+
 	ACTOR static Future<Void> profile(Profiler* self, int period, std::string outfn) {
-		// Open and truncate output file
-		state Reference<SyncFileForSim> outFile = Reference<SyncFileForSim>(new SyncFileForSim(outfn));
-		if(!outFile->isOpen()) {
-			TraceEvent(SevWarn, "FailedToOpenProfilingOutputFile").detail("Filename", outfn).GetLastError();
-			return Void();
+		// Open and truncate output file.  An empty filename selects the continuous low-overhead mode:
+		// samples are only aggregated in memory (see dumpCollapsedStacks), never written out raw.
+		state Reference<SyncFileForSim> outFile;
+		if (outfn.size()) {
+			outFile = Reference<SyncFileForSim>(new SyncFileForSim(outfn));
+			if(!outFile->isOpen()) {
+				TraceEvent(SevWarn, "FailedToOpenProfilingOutputFile").detail("Filename", outfn).GetLastError();
+				return Void();
+			}
 		}
 
 		// According to folk wisdom, calling this once before setting up the signal handler makes
@@ -241,10 +306,12 @@ struct Profiler {
 		}
 
 		state int64_t outOffset = 0;
-		wait( outFile->truncate(outOffset) );
+		if (outFile) {
+			wait( outFile->truncate(outOffset) );
 
-		wait( outFile->write( self->environmentInfoWriter.getData(), self->environmentInfoWriter.getLength(), outOffset ) );
-		outOffset += self->environmentInfoWriter.getLength();
+			wait( outFile->write( self->environmentInfoWriter.getData(), self->environmentInfoWriter.getLength(), outOffset ) );
+			outOffset += self->environmentInfoWriter.getLength();
+		}
 
 		loop {
 			wait( self->network->delay(1.0, TaskMinPriority) || self->network->delay(2.0, TaskMaxPriority) );
@@ -253,8 +320,11 @@ struct Profiler {
 			std::swap( self->output_buffer, otherBuffer );
 			self->enableSignal(true);
 
-			wait( otherBuffer->writeTo(outFile, outOffset) );
-			wait( outFile->flush() );
+			self->aggregateSamples( otherBuffer );
+			if (outFile) {
+				wait( otherBuffer->writeTo(outFile, outOffset) );
+				wait( outFile->flush() );
+			}
 			otherBuffer->clear();
 		}
 	}
@@ -297,9 +367,16 @@ void stopProfiling() {
 	}
 }
 
+bool dumpProfilerCollapsedStacks( std::string const& outputFile ) {
+	if (!Profiler::active_profiler)
+		return false;
+	return Profiler::active_profiler->dumpCollapsedStacks( outputFile );
+}
+
 #else
 
 void startProfiling(INetwork* network, Optional<int> period, Optional<StringRef> outputFile) {}
 void stopProfiling() {}
+bool dumpProfilerCollapsedStacks( std::string const& outputFile ) { return false; }
 
 #endif
@@ -26,7 +26,13 @@
 
 class INetwork;
 
+// An empty outputFile leaves the profiler in a continuous low-overhead mode that only aggregates
+// samples in memory, for later retrieval with dumpProfilerCollapsedStacks()
 void startProfiling(INetwork* network, Optional<int> period = {}, Optional<StringRef> outputFile = {});
 void stopProfiling();
 
+// Writes the running profiler's aggregated samples as a collapsed-stack file (addresses, for
+// offline symbolication).  Returns false if no profiler is running or the file can't be written.
+bool dumpProfilerCollapsedStacks( std::string const& outputFile );
+
 #endif  // _FDB_FLOW_PROFILER_H_
@@ -20,6 +20,30 @@
 
 #include "flow/Stats.h"
 
+static std::vector<CounterCollection*>& counterRegistry() {
+	static std::vector<CounterCollection*> registry;
+	return registry;
+}
+
+CounterCollection::CounterCollection(std::string name, std::string id) : name(name), id(id) {
+	counterRegistry().push_back(this);
+}
+
+CounterCollection::~CounterCollection() {
+	for (auto c : counters_to_remove)
+		c->remove();
+	auto& registry = counterRegistry();
+	for (int i = 0; i < registry.size(); i++)
+		if (registry[i] == this) {
+			registry.erase(registry.begin() + i);
+			break;
+		}
+}
+
+std::vector<CounterCollection*> const& registeredCounterCollections() {
+	return counterRegistry();
+}
+
 Counter::Counter(std::string const& name, CounterCollection& collection)
 : name(name), interval_start(0), last_event(0), interval_sq_time(0), interval_start_value(0), interval_delta(0)
 {
@@ -68,6 +92,48 @@ void Counter::clear() {
 	metric = 0;
 }
 
+struct HistogramCounter : ICounter, FastAllocated<HistogramCounter> {
+	enum Op { MEAN, PERCENTILE, MAX };
+
+	HistogramCounter(CounterCollection& collection, std::string const& name, LogHistogram* histogram, Op op, double percentile, bool clearOnReset)
+		: name(name), histogram(histogram), op(op), percentile(percentile), clearOnReset(clearOnReset)
+	{
+		collection.counters.push_back(this);
+		collection.counters_to_remove.push_back(this);
+	}
+	virtual void remove() { delete this; }
+
+	virtual std::string const& getName() const { return name; }
+	virtual int64_t getValue() const {
+		double seconds = op == MEAN ? histogram->mean() : op == MAX ? histogram->max() : histogram->percentile(percentile);
+		return (int64_t)(seconds * 1e6);
+	}
+
+	virtual void resetInterval() {
+		if (clearOnReset)
+			histogram->clear();
+	}
+
+	virtual bool hasRate() const { return false; }
+	virtual double getRate() const { throw internal_error(); }
+	virtual bool hasRoughness() const { return false; }
+	virtual double getRoughness() const { throw internal_error(); }
+
+	std::string name;
+	LogHistogram* histogram;
+	Op op;
+	double percentile;
+	bool clearOnReset;
+};
+
+void histogramCounters(CounterCollection& collection, std::string const& name, LogHistogram* histogram) {
+	new HistogramCounter(collection, name + "MeanUS", histogram, HistogramCounter::MEAN, 0, false);
+	new HistogramCounter(collection, name + "MedianUS", histogram, HistogramCounter::PERCENTILE, 0.5, false);
+	new HistogramCounter(collection, name + "P99US", histogram, HistogramCounter::PERCENTILE, 0.99, false);
+	new HistogramCounter(collection, name + "P999US", histogram, HistogramCounter::PERCENTILE, 0.999, false);
+	new HistogramCounter(collection, name + "MaxUS", histogram, HistogramCounter::MAX, 0, true); // last: clears the histogram
+}
+
 ACTOR Future<Void> traceCounters(std::string traceEventName, UID traceEventID, double interval, CounterCollection* counters, std::string trackLatestName) {
 	wait(delay(0)); // Give an opportunity for all members used in special counters to be initialized
 
@@ -78,12 +144,15 @@ ACTOR Future<Void> traceCounters(std::string traceEventName, UID traceEventID, d
 
 	loop{
 		TraceEvent te(traceEventName.c_str(), traceEventID);
-		te.detail("Elapsed", now() - last_interval);
+		// The fixed-buffer details keep this periodic emitter from allocating strings for every
+		// field; each Counter maintains its own Int64Metric, so skipping the event metric here
+		// loses nothing
+		te.detailFixed("Elapsed", now() - last_interval);
 		for (ICounter* c : counters->counters) {
 			if (c->hasRate() && c->hasRoughness())
-				te.detailf(c->getName().c_str(), "%g %g %lld", c->getRate(), c->getRoughness(), (long long)c->getValue());
+				te.detailFixed(c->getName().c_str(), "%g %g %lld", c->getRate(), c->getRoughness(), (long long)c->getValue());
 			else
-				te.detail(c->getName().c_str(), c->getValue());
+				te.detailFixed(c->getName().c_str(), c->getValue());
 			c->resetInterval();
 		}
 		if (!trackLatestName.empty())
@@ -36,6 +36,7 @@ MyCounters() : foo("foo", cc), bar("bar", cc), baz("baz", cc) {}
 #include <cstdint>
 #include <cstddef>
 #include "flow/flow.h"
+#include "flow/Histogram.h"
 #include "flow/TDMetric.actor.h"
 
 struct ICounter {
@@ -55,13 +56,19 @@ struct ICounter {
 };
 
 struct CounterCollection {
-	CounterCollection(std::string name, std::string id = std::string()) : name(name), id(id) {}
+	CounterCollection(std::string name, std::string id = std::string());
 	std::vector<struct ICounter*> counters, counters_to_remove;
-	~CounterCollection() { for (auto c : counters_to_remove) c->remove(); }
+	~CounterCollection();
 	std::string name;
 	std::string id;
 };
 
+// All live CounterCollections in the process, so that current counter values can be read on
+// demand rather than only from periodic trace events.  Collections register themselves on
+// construction and deregister on destruction.  Note that in simulation every simulated process
+// shares one registry, so readers may see collections belonging to other simulated processes.
+std::vector<CounterCollection*> const& registeredCounterCollections();
+
 struct Counter : ICounter {
 public:
 	typedef int64_t Value;
@@ -110,6 +117,13 @@ struct SpecialCounter : ICounter, FastAllocated<SpecialCounter<F>> {
 template <class F>
 static void specialCounter(CounterCollection& collection, std::string const& name, F && f) { new SpecialCounter<F>(collection, name, std::move(f)); }
 
+// Registers counters reporting the mean, median, p99, p999 and max of a LogHistogram, in
+// microseconds, named <name>MeanUS etc.  The histogram is cleared at the end of each trace
+// interval, so the reported percentiles cover exactly one interval.  The clear rides on the
+// last of these counters' resetInterval(), and traceCounters() reads each counter before
+// resetting it, so all five report from the same population.
+void histogramCounters(CounterCollection& collection, std::string const& name, LogHistogram* histogram);
+
 Future<Void> traceCounters(std::string const& traceEventName, UID const& traceEventID, double const& interval, CounterCollection* const& counters, std::string const& trackLatestName = std::string());
 
 #endif
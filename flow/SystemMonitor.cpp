@@ -42,7 +42,7 @@ void systemMonitor() {
 }
 
 #define TRACEALLOCATOR( size ) TraceEvent("MemSample").detail("Count", FastAllocator<size>::getMemoryUnused()/size).detail("TotalSize", FastAllocator<size>::getMemoryUnused()).detail("SampleCount", 1).detail("Hash", "FastAllocatedUnused" #size ).detail("Bt", "na")
-#define DETAILALLOCATORMEMUSAGE( size ) detail("AllocatedMemory"#size, FastAllocator<size>::getMemoryUsed()).detail("ApproximateUnusedMemory"#size, FastAllocator<size>::getMemoryUnused())
+#define DETAILALLOCATORMEMUSAGE( size ) detail("AllocatedMemory"#size, FastAllocator<size>::getMemoryUsed()).detail("ApproximateUnusedMemory"#size, FastAllocator<size>::getMemoryUnused()).detail("AllocationCount"#size, FastAllocator<size>::getAllocationCount())
 
 SystemStatistics customSystemMonitor(std::string eventName, StatisticsState *statState, bool machineMetrics) {
 	SystemStatistics currentStats = getSystemStatistics(machineState.folder.present() ? machineState.folder.get() : "", 
@@ -52,11 +52,18 @@ SystemStatistics customSystemMonitor(std::string eventName, StatisticsState *sta
 	netData.init();
 	if (!DEBUG_DETERMINISM && currentStats.initialized) {
 		{
+			double runLoopBusy = 0;
+			for (int i = 0; i<NetworkMetrics::PRIORITY_BINS; i++)
+				runLoopBusy += g_network->networkMetrics.secPriorityBusy[i] - statState->networkMetricsState.secPriorityBusy[i];
+			int64_t fastAllocations = getTotalFastAllocationCount();
+
 			TraceEvent e(eventName.c_str());
 			e
 				.detail("Elapsed", currentStats.elapsed)
 				.detail("CPUSeconds", currentStats.processCPUSeconds)
 				.detail("MainThreadCPUSeconds", currentStats.mainThreadCPUSeconds)
+				.detail("RunLoopBusySeconds", runLoopBusy)
+				.detail("FastAllocations", fastAllocations - statState->fastAllocationCount)
 				.detail("UptimeSeconds", now() - machineState.monitorStartTime)
 				.detail("Memory", currentStats.processMemory)
 				.detail("ResidentMemory", currentStats.processResidentMemory)
@@ -77,6 +84,8 @@ SystemStatistics customSystemMonitor(std::string eventName, StatisticsState *sta
 				.detail("FileReads", netData.countFileLogicalReads - statState->networkState.countFileLogicalReads)
 				.detail("CacheReadBytes", netData.countFileCacheReadBytes - statState->networkState.countFileCacheReadBytes)
 				.detail("CacheFinds", netData.countFileCacheFinds - statState->networkState.countFileCacheFinds)
+				.detail("CacheHits", netData.countFileCacheHits - statState->networkState.countFileCacheHits)
+				.detail("CacheMisses", netData.countFileCacheMisses - statState->networkState.countFileCacheMisses)
 				.detail("CacheWritesBlocked", netData.countFileCacheWritesBlocked - statState->networkState.countFileCacheWritesBlocked)
 				.detail("CacheReadsBlocked", netData.countFileCacheReadsBlocked - statState->networkState.countFileCacheReadsBlocked)
 				.detail("CachePageReadsMerged", netData.countFileCachePageReadsMerged - statState->networkState.countFileCachePageReadsMerged)
@@ -94,7 +103,12 @@ SystemStatistics customSystemMonitor(std::string eventName, StatisticsState *sta
 				.detail("ConnectionErrors", (netData.countConnClosedWithError - statState->networkState.countConnClosedWithError) / currentStats.elapsed)
 				.trackLatest(eventName.c_str());
 
+			int64_t localMagazines, remoteMagazines;
+			getFastAllocatorNumaTraffic(localMagazines, remoteMagazines);
 			TraceEvent("MemoryMetrics")
+				.detail("FastAllocations", fastAllocations - statState->fastAllocationCount)
+				.detail("LocalNodeMagazines", localMagazines)
+				.detail("RemoteNodeMagazines", remoteMagazines)
 				.DETAILALLOCATORMEMUSAGE(16)
 				.DETAILALLOCATORMEMUSAGE(32)
 				.DETAILALLOCATORMEMUSAGE(64)
@@ -132,6 +146,15 @@ SystemStatistics customSystemMonitor(std::string eventName, StatisticsState *sta
 			for (int i = 0; i<NetworkMetrics::PRIORITY_BINS; i++)
 				if (double x = g_network->networkMetrics.secSquaredPriorityBlocked[i] - statState->networkMetricsState.secSquaredPriorityBlocked[i])
 					n.detail(format("S2Pri%d", g_network->networkMetrics.priorityBins[i]).c_str(), x);
+			for (int i = 0; i<NetworkMetrics::PRIORITY_BINS; i++)
+				if (double x = g_network->networkMetrics.secPriorityBusy[i] - statState->networkMetricsState.secPriorityBusy[i])
+					n.detail(format("BusyPri%d", g_network->networkMetrics.priorityBins[i]).c_str(), x);
+			for (int i = 0; i<NetworkMetrics::PRIORITY_BINS; i++)
+				if (int64_t c = g_network->networkMetrics.queueDelayCount[i] - statState->networkMetricsState.queueDelayCount[i]) {
+					n.detail(format("QueueDelayPri%d", g_network->networkMetrics.priorityBins[i]).c_str(),
+						g_network->networkMetrics.queueDelaySum[i] - statState->networkMetricsState.queueDelaySum[i]);
+					n.detail(format("QueueCountPri%d", g_network->networkMetrics.priorityBins[i]).c_str(), c);
+				}
 		}
 
 		if(machineMetrics) {
@@ -258,5 +281,6 @@ SystemStatistics customSystemMonitor(std::string eventName, StatisticsState *sta
 #endif
 	statState->networkMetricsState = g_network->networkMetrics;
 	statState->networkState = netData;
+	statState->fastAllocationCount = getTotalFastAllocationCount();
 	return currentStats;
 }
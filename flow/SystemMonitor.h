@@ -73,6 +73,8 @@ struct NetworkData {
 	int64_t countFileCachePageReadsMerged;
 	int64_t countFileCacheFinds;
 	int64_t countFileCacheReadBytes;
+	int64_t countFileCacheHits;
+	int64_t countFileCacheMisses;
 	int64_t countConnEstablished;
 	int64_t countConnClosedWithError;
 	int64_t countConnClosedWithoutError;
@@ -120,6 +122,8 @@ struct NetworkData {
 		countFileCachePageReadsMerged = getValue(LiteralStringRef("AsyncFile.CountCachePageReadsMerged"));
 		countFileCacheFinds = getValue(LiteralStringRef("AsyncFile.CountCacheFinds"));
 		countFileCacheReadBytes = getValue(LiteralStringRef("AsyncFile.CountCacheReadBytes"));
+		countFileCacheHits = getValue(LiteralStringRef("AsyncFile.CountCacheHits"));
+		countFileCacheMisses = getValue(LiteralStringRef("AsyncFile.CountCacheMisses"));
 	}
 };
 
@@ -127,8 +131,9 @@ struct StatisticsState {
 	SystemStatisticsState *systemState;
 	NetworkData networkState;
 	NetworkMetrics networkMetricsState;
+	int64_t fastAllocationCount;
 
-	StatisticsState() : systemState(NULL) {}
+	StatisticsState() : systemState(NULL), fastAllocationCount(0) {}
 };
 
 void systemMonitor();
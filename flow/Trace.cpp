@@ -22,6 +22,7 @@
 #include "flow/Trace.h"
 #include "flow/FileTraceLogWriter.h"
 #include "flow/XmlTraceLogFormatter.h"
+#include "flow/BinaryTraceLogFormatter.h"
 #include "flow/flow.h"
 #include "flow/DeterministicRandom.h"
 #include <stdlib.h>
@@ -129,6 +130,9 @@ private:
 	std::vector<TraceEventFields> eventBuffer;
 	int loggedLength;
 	int bufferLength;
+	volatile int64_t pendingWriteBytes;  // bytes posted to the writer thread but not yet written to disk
+	int64_t sheddedEventCount;
+	int64_t sheddedEventBytes;
 	bool opened;
 	int64_t preopenOverflowCount;
 	std::string basename;
@@ -264,8 +268,10 @@ public:
 
 		struct WriteBuffer : TypedAction<WriterThread, WriteBuffer> {
 			std::vector<TraceEventFields> events;
+			int64_t bytes;
+			volatile int64_t* pendingWriteBytes;
 
-			WriteBuffer(std::vector<TraceEventFields> events) : events(events) {}
+			WriteBuffer(std::vector<TraceEventFields> events, int64_t bytes, volatile int64_t* pendingWriteBytes) : events(events), bytes(bytes), pendingWriteBytes(pendingWriteBytes) {}
 			virtual double getTimeEstimate() { return .001; }
 		};
 		void action( WriteBuffer& a ) {
@@ -277,16 +283,24 @@ public:
 			if(FLOW_KNOBS->TRACE_SYNC_ENABLED) {
 				logWriter->sync();
 			}
+
+			interlockedExchangeAdd64( a.pendingWriteBytes, -a.bytes );
 		}
 	};
 
-	TraceLog() : bufferLength(0), loggedLength(0), opened(false), preopenOverflowCount(0), barriers(new BarrierList), logTraceEventMetrics(false), formatter(new XmlTraceLogFormatter()) {}
+	TraceLog() : bufferLength(0), loggedLength(0), pendingWriteBytes(0), sheddedEventCount(0), sheddedEventBytes(0), opened(false), preopenOverflowCount(0), barriers(new BarrierList), logTraceEventMetrics(false), formatter(new XmlTraceLogFormatter()) {}
 
 	bool isOpen() const { return opened; }
 
 	void open( std::string const& directory, std::string const& processName, std::string logGroup, std::string const& timestamp, uint64_t rs, uint64_t maxLogsSize, Optional<NetworkAddress> na ) {
 		ASSERT( !writer && !opened );
 
+		if (FLOW_KNOBS->TRACE_FORMAT == "bin") {
+			formatter = Reference<ITraceLogFormatter>(new BinaryTraceLogFormatter());
+		} else if (FLOW_KNOBS->TRACE_FORMAT != "xml") {
+			TraceEvent(SevWarnAlways, "UnknownTraceFormat").detail("Format", FLOW_KNOBS->TRACE_FORMAT);
+		}
+
 		this->directory = directory;
 		this->processName = processName;
 		this->logGroup = logGroup;
@@ -342,7 +356,7 @@ public:
 		}
 	}
 
-	void writeEvent( TraceEventFields fields, std::string trackLatestKey, bool trackError ) {
+	void writeEvent( TraceEventFields fields, std::string trackLatestKey, bool trackError, int severity = SevInfo ) {
 		MutexHolder hold(mutex);
 
 		if(opened) {
@@ -358,9 +372,18 @@ public:
 			return;
 		}
 
-		// FIXME: What if we are using way too much memory for buffer?
-		eventBuffer.push_back(fields);
-		bufferLength += fields.sizeBytes();
+		// Bound the memory held by events the writer thread hasn't gotten to disk yet, so an event
+		// storm against a slow trace disk can't grow the buffer (and eventually run loop latency)
+		// without limit.  SevError events are always retained; lower severities are shed and counted,
+		// and flush() logs the count once the backlog drains.  Tracked events below still update the
+		// latest-event cache so status isn't affected.
+		if(opened && severity < SevError && bufferLength + pendingWriteBytes + fields.sizeBytes() > FLOW_KNOBS->TRACE_LOG_MAX_PENDING_BYTES) {
+			++sheddedEventCount;
+			sheddedEventBytes += fields.sizeBytes();
+		} else {
+			eventBuffer.push_back(fields);
+			bufferLength += fields.sizeBytes();
+		}
 
 		if(trackError) {
 			latestEventCache.setLatestError(fields);
@@ -397,6 +420,19 @@ public:
 	ThreadFuture<Void> flush() {
 		traceEventThrottlerCache->poll();
 
+		int64_t shedCount = 0, shedBytes = 0;
+		{
+			MutexHolder hold(mutex);
+			if (sheddedEventCount && bufferLength + pendingWriteBytes < FLOW_KNOBS->TRACE_LOG_MAX_PENDING_BYTES) {
+				shedCount = sheddedEventCount;
+				shedBytes = sheddedEventBytes;
+				sheddedEventCount = sheddedEventBytes = 0;
+			}
+		}
+		if (shedCount) {
+			TraceEvent(SevWarnAlways, "TraceEventsShed").detail("Count", shedCount).detail("Bytes", shedBytes);
+		}
+
 		MutexHolder hold(mutex);
 		bool roll = false;
 		if (!eventBuffer.size()) return Void(); // SOMEDAY: maybe we still roll the tracefile here?
@@ -404,7 +440,8 @@ public:
 		if (rollsize && bufferLength + loggedLength > rollsize) // SOMEDAY: more conditions to roll
 			roll = true;
 
-		auto a = new WriterThread::WriteBuffer( std::move(eventBuffer) );
+		auto a = new WriterThread::WriteBuffer( std::move(eventBuffer), bufferLength, &pendingWriteBytes );
+		interlockedExchangeAdd64( &pendingWriteBytes, bufferLength );
 		loggedLength += bufferLength;
 		eventBuffer = std::vector<TraceEventFields>();
 		bufferLength = 0;
@@ -450,7 +487,8 @@ public:
 			MutexHolder hold(mutex);
 
 			// Write remaining contents
-			auto a = new WriterThread::WriteBuffer( std::move(eventBuffer) );
+			auto a = new WriterThread::WriteBuffer( std::move(eventBuffer), bufferLength, &pendingWriteBytes );
+			interlockedExchangeAdd64( &pendingWriteBytes, bufferLength );
 			loggedLength += bufferLength;
 			eventBuffer = std::vector<TraceEventFields>();
 			bufferLength = 0;
@@ -741,6 +779,57 @@ TraceEvent& TraceEvent::detailImpl( std::string&& key, std::string&& value, bool
 	return *this;
 }
 
+TraceEvent& TraceEvent::addFieldFixed( const char* key, const char* value, int length ) {
+	init();
+	if (enabled) {
+		if( length > 495 )
+			length = 495;
+
+		fields.addField(std::string(key), std::string(value, length));
+
+		if(fields.sizeBytes() > TRACE_EVENT_MAX_SIZE) {
+			TraceEvent(g_network && g_network->isSimulated() ? SevError : SevWarnAlways, "TraceEventOverflow").detail("TraceFirstBytes", fields.toString().substr(300));
+			enabled = false;
+		}
+	}
+	return *this;
+}
+
+TraceEvent& TraceEvent::detailFixed( const char* key, const char* valueFormat, ... ) {
+	init();
+	if (enabled) {
+		char buf[512];
+		va_list args;
+		va_start(args, valueFormat);
+		int length = vsnprintf(buf, sizeof(buf), valueFormat, args);
+		va_end(args);
+
+		ASSERT(length >= 0);
+		addFieldFixed(key, buf, std::min<int>(length, sizeof(buf)-1));
+	}
+	return *this;
+}
+
+TraceEvent& TraceEvent::detailFixed( const char* key, int64_t value ) {
+	init();
+	if (enabled) {
+		char buf[32];
+		int length = snprintf(buf, sizeof(buf), "%lld", (long long)value);
+		addFieldFixed(key, buf, length);
+	}
+	return *this;
+}
+
+TraceEvent& TraceEvent::detailFixed( const char* key, double value ) {
+	init();
+	if (enabled) {
+		char buf[64];
+		int length = snprintf(buf, sizeof(buf), "%g", value);
+		addFieldFixed(key, buf, length);
+	}
+	return *this;
+}
+
 TraceEvent& TraceEvent::detail( std::string key, std::string value ) {
 	return detailImpl(std::move(key), std::move(value));
 }
@@ -911,7 +1000,7 @@ TraceEvent::~TraceEvent() {
 			}
 
 			TraceEvent::eventCounts[severity/10]++;
-			g_traceLog.writeEvent( fields, trackingKey, severity > SevWarnAlways );
+			g_traceLog.writeEvent( fields, trackingKey, severity > SevWarnAlways, severity );
 
 			if (g_traceLog.isOpen()) {
 				// Log Metrics
@@ -158,7 +158,17 @@ struct TraceEvent {
 	TraceEvent& detailf( std::string key, const char* valueFormat, ... );
 	TraceEvent& detailext( std::string key, const StringRef& value );
 	TraceEvent& detailext( std::string key, const Optional<Standalone<StringRef>>& value );
+
+	// Adds a field, formatting the value into a fixed stack buffer rather than an intermediate
+	// std::string, and does NOT write to the event metric.  For high-frequency periodic events
+	// (counter traces, machine metrics) whose values are numeric this removes the per-field
+	// allocations of detail()/detailf(); short values also land in the field container's
+	// small-string buffer.  Callers relying on event metrics must use detail()/detailf().
+	TraceEvent& detailFixed( const char* key, const char* valueFormat, ... );
+	TraceEvent& detailFixed( const char* key, int64_t value );
+	TraceEvent& detailFixed( const char* key, double value );
 private:
+	TraceEvent& addFieldFixed( const char* key, const char* value, int length );
 	// Private version of detailf that does NOT write to the eventMetric.  This is to be used by other detail methods
 	// which can write field metrics of a more appropriate type than string but use detailf() to add to the TraceEvent.
 	TraceEvent& detailfNoMetric( std::string&& key, const char* valueFormat, ... );
@@ -30,6 +30,7 @@ template<typename T> struct FutureStream;
 #define DESCR
 #define state
 #define UNCANCELLABLE
+#define FLATTEN
 #define choose if(1)
 #define when(x) for(x;;)
 template <class T> T wait( const Future<T>& );
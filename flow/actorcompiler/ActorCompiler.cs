@@ -300,6 +300,12 @@ namespace actorcompiler
         }
         public void Write(TextWriter writer)
         {
+            if (actor.isForwarding)
+            {
+                WriteForwardingFunction(writer);
+                return;
+            }
+
             for (int i = 0; ; i++)
             {
                 className = string.Format("{0}{1}Actor{2}",
@@ -416,6 +422,58 @@ namespace actorcompiler
             Console.WriteLine("\tCompiled ACTOR {0} (line {1})", actor.name, actor.SourceLine);
         }
 
+        /* A FLATTEN actor ends with a single wait whose result is immediately returned, so it doesn't
+         * need a state machine: the future it waits on can be handed straight back to the caller.
+         * Writes a plain function that executes any statements preceding the wait and returns the
+         * waited-on future, eliminating the actor's heap allocation, callback dispatch, and
+         * promise/future pair.  An exception thrown before an actor's first wait becomes a broken
+         * future rather than propagating to the caller, so the statements are wrapped in try/catch to
+         * preserve that.
+         *
+         * Note that in an ordinary actor the parameters are copied into state variables that live
+         * until the actor completes; a flattened actor's parameters only live until the function
+         * returns, so the waited-on callee must keep alive everything it needs.
+         */
+        void WriteForwardingFunction(TextWriter writer)
+        {
+            if (actor.returnType == null)
+                throw new Error(actor.SourceLine, "FLATTEN actor {0} must return Future<T>", actor.name);
+            if (actor.isUncancellable)
+                throw new Error(actor.SourceLine, "FLATTEN actor {0} cannot be UNCANCELLABLE; cancellation passes through to the forwarded future", actor.name);
+
+            var statements = actor.body.statements;
+            WaitStatement waitStmt = statements.Length >= 2 ? statements[statements.Length - 2] as WaitStatement : null;
+            ReturnStatement returnStmt = statements.Length >= 2 ? statements[statements.Length - 1] as ReturnStatement : null;
+            if (waitStmt == null || returnStmt == null || waitStmt.isWaitNext || waitStmt.resultIsState ||
+                    !((returnStmt.expression == waitStmt.result.name && waitStmt.result.type == actor.returnType) ||
+                      (returnStmt.expression == "Void()" && waitStmt.result.type == "Void" && actor.returnType == "Void")))
+                throw new Error(actor.SourceLine, "FLATTEN actor {0} must end with a single wait whose result is immediately returned", actor.name);
+            foreach (var stmt in statements.Take(statements.Length - 2))
+                if (!(stmt is PlainOldCodeStatement))
+                    throw new Error(stmt.FirstSourceLine, "FLATTEN actor {0} may contain only plain statements before its wait", actor.name);
+
+            WriteTemplate(writer);
+            LineNumber(writer, actor.SourceLine);
+            if (actor.isStatic) writer.Write("static ");
+            writer.WriteLine("Future<{0}> {3}{1}( {2} ) {{", actor.returnType, actor.name, string.Join(", ", ParameterList()), actor.nameSpace == null ? "" : actor.nameSpace + "::");
+            writer.WriteLine("\ttry {");
+            foreach (var stmt in statements.Take(statements.Length - 2))
+            {
+                LineNumber(writer, stmt.FirstSourceLine);
+                writer.WriteLine("\t\t{0}", ((PlainOldCodeStatement)stmt).code);
+            }
+            LineNumber(writer, waitStmt.FirstSourceLine);
+            writer.WriteLine("\t\treturn {0};", waitStmt.futureExpression);
+            writer.WriteLine("\t} catch (Error& error) {");
+            writer.WriteLine("\t\treturn Future<{0}>(error);", actor.returnType);
+            writer.WriteLine("\t} catch (...) {");
+            writer.WriteLine("\t\treturn Future<{0}>(unknown_error());", actor.returnType);
+            writer.WriteLine("\t}");
+            writer.WriteLine("}");
+
+            Console.WriteLine("\tCompiled ACTOR {0} as a plain forwarding function (line {1})", actor.name, actor.SourceLine);
+        }
+
         void LineNumber(TextWriter writer, int SourceLine)
         {
             if(SourceLine == 0)
@@ -431,6 +431,13 @@ namespace actorcompiler
                 toks = range(uncancellableKeyword.Position + 1, toks.End);
             }
 
+            var flattenKeyword = toks.First(NonWhitespace);
+            if (flattenKeyword.Value == "FLATTEN")
+            {
+                actor.isForwarding = true;
+                toks = range(flattenKeyword.Position + 1, toks.End);
+            }
+
             // Find the parameter list
             TokenRange paramRange = toks.Last(NonWhitespace)
                 .Assert("Unexpected tokens after actor parameter list.", 
@@ -231,6 +231,8 @@ namespace actorcompiler
         public int SourceLine;
         public bool isStatic = false;
         public bool isUncancellable = false;
+        public bool isForwarding = false;  //< FLATTEN: compiled to a plain function forwarding the future it waits on
+
         public string testCaseParameters = null;
         public string nameSpace = null;
     };
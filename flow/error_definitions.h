@@ -64,6 +64,7 @@ ERROR( external_client_already_loaded, 1040, "External client has already been l
 ERROR( lookup_failed, 1041, "DNS lookup failed" )
 ERROR( proxy_memory_limit_exceeded, 1042, "Proxy commit memory limit exceeded")
 ERROR( shutdown_in_progress, 1043, "Operation no longer supported due to shutdown")
+ERROR( server_overloaded, 1044, "Server is under too much load and cannot process the request now")
 
 ERROR( broken_promise, 1100, "Broken promise" )
 ERROR( operation_cancelled, 1101, "Asynchronous operation cancelled" )
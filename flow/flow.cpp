@@ -19,6 +19,7 @@
  */
 
 #include "flow/flow.h"
+#include "flow/UnitTest.h"
 #include <stdarg.h>
 
 INetwork *g_network = 0;
@@ -26,6 +27,7 @@ IRandom *g_random = 0;
 IRandom *g_nondeterministic_random = 0;
 IRandom *g_debug_random = 0;
 FILE* randLog = 0;
+const char* g_currentActorName = 0;
 uint64_t debug_lastLoadBalanceResultEndpointToken = 0;
 bool noUnseed = false;
 
@@ -212,4 +214,30 @@ bool validationIsEnabled() {
 
 void enableBuggify( bool enabled ) {
 	buggifyActivated = enabled;
-}
\ No newline at end of file
+}
+TEST_CASE("/flow/StringRef/compareKernels") {
+	// compareBytes/commonPrefixLength must agree with memcmp for every length straddling the
+	// 16-byte vector width, including equal strings and differences in the scalar tail.
+	for(int iteration = 0; iteration < 10000; iteration++) {
+		int len = g_random->randomInt(0, 70);
+		std::string a, b;
+		for(int i = 0; i < len; i++) {
+			uint8_t c = g_random->randomInt(0, 3);  // Small alphabet so prefixes collide often
+			a += (char)c;
+			b += (char)(g_random->random01() < 0.9 ? c : g_random->randomInt(0, 256));
+		}
+
+		StringRef aref(a), bref(b);
+		int expected = memcmp(a.data(), b.data(), len);
+		int actual = compareBytes(aref.begin(), bref.begin(), len);
+		ASSERT( (expected < 0) == (actual < 0) && (expected == 0) == (actual == 0) );
+
+		int prefix = commonPrefixLength(aref, bref);
+		ASSERT( prefix <= len );
+		ASSERT( memcmp(a.data(), b.data(), prefix) == 0 );
+		ASSERT( prefix == len || a[prefix] != b[prefix] );
+
+		ASSERT( aref.compare(bref) == -bref.compare(aref) || (aref.compare(bref) == 0 && bref.compare(aref) == 0) );
+	}
+	return Void();
+}
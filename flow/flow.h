@@ -36,6 +36,7 @@
 #include <string>
 #include <utility>
 #include <algorithm>
+#include <typeinfo>
 
 #include "flow/Platform.h"
 #include "flow/FastAlloc.h"
@@ -512,11 +513,17 @@ struct NotifiedQueue : private SingleCallback<T>, FastAllocated<NotifiedQueue<T>
 	// Invariant: SingleCallback<T>::next==this || (queue.empty() && !error.isValid())
 	std::queue<T, Deque<T>> queue;
 	Error error;
+	SAV<Void>* onEmptySAV;  // Set lazily by PromiseStream<T>::onEmpty(), fired when the queue drains
 
-	NotifiedQueue(int futures, int promises) : futures(futures), promises(promises) {
+	NotifiedQueue(int futures, int promises) : futures(futures), promises(promises), onEmptySAV(nullptr) {
 		SingleCallback<T>::next = this;
 	}
 
+	~NotifiedQueue() {
+		if (onEmptySAV)
+			onEmptySAV->delPromiseRef();
+	}
+
 	bool isReady() const { return !queue.empty() || error.isValid(); }
 	bool isError() const { return queue.empty() && error.isValid(); }  // the *next* thing queued is an error
 
@@ -527,6 +534,12 @@ struct NotifiedQueue : private SingleCallback<T>, FastAllocated<NotifiedQueue<T>
 		}
 		auto copy = queue.front();
 		queue.pop();
+		if (onEmptySAV && queue.empty()) {
+			SAV<Void>* hold = onEmptySAV;
+			onEmptySAV = nullptr;
+			hold->send(Void());
+			hold->delPromiseRef();
+		}
 		return copy;
 	}
 
@@ -898,6 +911,17 @@ public:
 	bool operator == (const PromiseStream<T>& rhs) const { return queue == rhs.queue; }
 	bool isEmpty() const { return !queue->isReady(); }
 
+	// Returns when all values sent to the stream have been popped by the consumer.  Producers can
+	// wait on this before sending to bound how far they run ahead of the consumer.
+	Future<Void> onEmpty() const {
+		if (isEmpty())
+			return Void();
+		if (!queue->onEmptySAV)
+			queue->onEmptySAV = new SAV<Void>(0, 1);
+		queue->onEmptySAV->addFutureRef();
+		return Future<Void>(queue->onEmptySAV);
+	}
+
 private:
 	NotifiedQueue<T>* queue;
 };
@@ -928,12 +952,21 @@ struct Actor<void> {
 	//~Actor() { --actorCount; }
 };
 
+// The (mangled) name of the actor most recently resumed on this thread.  Updated on every actor
+// callback, so when the run loop notices a slow task it can attribute the time to an actor by
+// name without any per-actor registration; the name table is just typeid on the actor compiler's
+// generated classes.  Because actors resume each other synchronously this identifies the most
+// recently entered actor, which for a long-running task is ordinarily the one consuming the time.
+extern const char* g_currentActorName;
+
 template <class ActorType, int CallbackNumber, class ValueType>
 struct ActorCallback : Callback<ValueType> {
 	virtual void fire(ValueType const& value) {
+		g_currentActorName = typeid(ActorType).name();
 		static_cast<ActorType*>(this)->a_callback_fire(this, value);
 	}
 	virtual void error(Error e) {
+		g_currentActorName = typeid(ActorType).name();
 		static_cast<ActorType*>(this)->a_callback_error(this, e);
 	}
 };
@@ -941,9 +974,11 @@ struct ActorCallback : Callback<ValueType> {
 template <class ActorType, int CallbackNumber, class ValueType>
 struct ActorSingleCallback : SingleCallback<ValueType> {
 	virtual void fire(ValueType const& value) {
+		g_currentActorName = typeid(ActorType).name();
 		static_cast<ActorType*>(this)->a_callback_fire(this, value);
 	}
 	virtual void error(Error e) {
+		g_currentActorName = typeid(ActorType).name();
 		static_cast<ActorType*>(this)->a_callback_error(this, e);
 	}
 };
@@ -953,5 +988,24 @@ inline Future<Void> delayUntil(double time, int taskID = TaskDefaultDelay) { ret
 inline Future<Void> delayJittered(double seconds, int taskID = TaskDefaultDelay) { return g_network->delay(seconds*(FLOW_KNOBS->DELAY_JITTER_OFFSET + FLOW_KNOBS->DELAY_JITTER_RANGE*g_random->random01()), taskID); }
 inline Future<Void> yield(int taskID = TaskDefaultYield) { return g_network->yield(taskID); }
 inline bool check_yield(int taskID = TaskDefaultYield) { return g_network->check_yield(taskID); }
+
+// Amortizes yield checks over tight iterator loops: only every `interval`th call consults
+// check_yield, and the returned future is already set unless the caller's time slice has
+// expired.  Usage in an actor:
+//     state LoopYield ly;
+//     for( ...; ... ; ... ) {
+//         ...
+//         wait( ly.check() );
+//     }
+struct LoopYield {
+	explicit LoopYield( int interval = 64, int taskID = TaskDefaultYield ) : count(0), interval(interval), taskID(taskID) {}
+	Future<Void> check() {
+		if (++count < interval) return Void();
+		count = 0;
+		return yield(taskID);
+	}
+private:
+	int count, interval, taskID;
+};
 #include "flow/genericactors.actor.h"
 #endif
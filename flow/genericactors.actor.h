@@ -569,14 +569,14 @@ public:
 			p->send(Void());
 	}
 	void trigger( K const& key ) {
-		if( items.count(key) != 0 ) {
-			auto& i = items[key];
+		auto it = items.find(key);
+		if( it != items.end() ) {
 			Promise<Void> trigger;
-			i.change.swap(trigger);
+			it->second.change.swap(trigger);
 			Promise<Void> noDestroy = trigger;  // See explanation of noDestroy in setUnconditional()
 
-			if (i.value == defaultValue)
-				items.erase(key);
+			if (it->second.value == defaultValue)
+				items.erase(it);
 
 			trigger.send(Void());
 		}
@@ -595,6 +595,9 @@ public:
 			return 1;
 		return 0;
 	}
+	bool empty() const {
+		return items.empty();
+	}
 	virtual Future<Void> onChange( K const& k ) {	// throws broken_promise if this is destroyed
 		auto &item = items[k];
 		if (item.value == defaultValue)
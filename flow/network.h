@@ -41,6 +41,10 @@ enum {
 	TaskFailureMonitor = 8700,
 	TaskResolutionMetrics = 8700,
 	TaskClusterController = 8650,
+	// The read version path runs above the commit pipeline on the proxy so that a burst of commit
+	// work does not queue ahead of the (much cheaper) GRV batches and inflate read latency
+	TaskProxyGRVTimer = 8648,
+	TaskProxyGetConsistentReadVersion = 8645,
 	TaskProxyCommitDispatcher = 8640,
 	TaskTLogQueuingMetrics = 8620,
 	TaskTLogPop = 8610,
@@ -54,14 +58,13 @@ enum {
 	TaskProxyCommit = 8540,
 	TaskTLogConfirmRunningReply = 8530,
 	TaskTLogConfirmRunning = 8520,
-	TaskProxyGRVTimer = 8510,
-	TaskProxyGetConsistentReadVersion = 8500,
 	TaskDefaultPromiseEndpoint = 8000,
 	TaskDefaultOnMainThread = 7500,
 	TaskDefaultDelay = 7010,
 	TaskDefaultYield = 7000,
 	TaskDiskRead = 5010,
 	TaskDefaultEndpoint = 5000,
+	TaskLowPriorityRead = 4100,
 	TaskUnknownEndpoint = 4000,
 	TaskMoveKeys = 3550,
 	TaskDataDistributionLaunch = 3530,
@@ -119,6 +122,15 @@ struct NetworkMetrics {
 	int priorityBins[ PRIORITY_BINS ];
 	double secSquaredPriorityBlocked[PRIORITY_BINS];
 
+	// Time spent by ready tasks waiting in the run loop's queue, accumulated per priority band;
+	// reported (as interval deltas) in the NetworkMetrics trace event
+	double queueDelaySum[PRIORITY_BINS];
+	int64_t queueDelayCount[PRIORITY_BINS];
+
+	// Time spent executing tasks, accumulated per priority band, so a saturated run loop can be
+	// attributed to the kind of work consuming it
+	double secPriorityBusy[PRIORITY_BINS];
+
 	double oldestAlternativesFailure;
 	double newestAlternativesFailure;
 	double lastSync;
@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include <set>
+#include <type_traits>
 #include "flow/Error.h"
 #include "flow/Arena.h"
 #include <algorithm>
@@ -39,6 +40,16 @@ struct is_binary_serializable { enum { value = 0 }; };
 
 #define BINARY_SERIALIZABLE( T ) template<> struct is_binary_serializable<T> { enum { value = 1 }; };
 
+// Like BINARY_SERIALIZABLE, but for compound message structs whose whole layout goes on the wire:
+// verifies at compile time that the type is trivially copyable and that its size equals the sum of
+// its serialized fields, so the single copy transmits exactly the bytes that field-by-field
+// serialization would have (see the padding concerns above).  The field size sum is maintained by
+// hand and keeps the assert honest when members are added or reordered.
+#define FIXED_LAYOUT_BINARY_SERIALIZABLE( T, fieldSizeSum ) \
+	static_assert( std::is_trivially_copyable<T>::value, #T " must be trivially copyable to be serialized as a single copy" ); \
+	static_assert( sizeof(T) == (fieldSizeSum), #T " has padding or unaccounted members; serialize it field by field" ); \
+	BINARY_SERIALIZABLE( T )
+
 BINARY_SERIALIZABLE( int8_t );
 BINARY_SERIALIZABLE( uint8_t );
 BINARY_SERIALIZABLE( int16_t );
@@ -565,21 +576,40 @@ struct SendBuffer {
 	SendBuffer* next;
 };
 
-struct PacketBuffer : SendBuffer, FastAllocated<PacketBuffer> {
+struct PacketBuffer : SendBuffer {
 	int reference_count;
-	enum { DATA_SIZE = 4096 - 28 };
+	int size_;  // Bytes of data[], at least DATA_SIZE but more for oversize buffers holding bulk writes
+	enum { HEADER_SIZE = 32, DATA_SIZE = 4096 - 32 };
 	uint8_t data[ DATA_SIZE ];
 
-	PacketBuffer() : reference_count(1) {
-		next = 0;
-		bytes_written = bytes_sent = 0;
-		((SendBuffer*)this)->data = data;
+	// Allocate a PacketBuffer with room for at least the given number of data bytes.  The default (and
+	// minimum) size comes from the fast allocator; larger requests get a single oversize buffer so that a
+	// bulk write occupies one buffer (and one iovec when sent) instead of a long chain of 4K pieces.
+	static PacketBuffer* create(int size = 0) {
 		static_assert( sizeof(PacketBuffer) == 4096, "PacketBuffer size mismatch" );
+		if (size <= DATA_SIZE)
+			return new (FastAllocator<4096>::allocate()) PacketBuffer(DATA_SIZE);
+		return new (new uint8_t[ size + HEADER_SIZE ]) PacketBuffer(size);
 	}
 	PacketBuffer* nextPacketBuffer() { return (PacketBuffer*)next; }
 	void addref() { ++reference_count; }
-	void delref() { if (!--reference_count) delete this; }
-	int bytes_unwritten() const { return DATA_SIZE-bytes_written; }
+	void delref() {
+		if (!--reference_count) {
+			if (size_ == DATA_SIZE)
+				FastAllocator<4096>::release(this);
+			else
+				delete[] (uint8_t*)this;
+		}
+	}
+	int size() const { return size_; }
+	int bytes_unwritten() const { return size_-bytes_written; }
+
+private:
+	explicit PacketBuffer(int size) : reference_count(1), size_(size) {
+		next = 0;
+		bytes_written = bytes_sent = 0;
+		((SendBuffer*)this)->data = data;
+	}
 };
 
 struct PacketWriter {
@@ -606,7 +636,7 @@ struct PacketWriter {
 	}
 	void serializeBytesAcrossBoundary(const void* data, int bytes);
 	void writeAhead( int bytes, struct SplitBuffer* );
-	void nextBuffer();
+	void nextBuffer( int bytesNeeded = 0 );
 	PacketBuffer* finish();
 	int size() { return length; }
 